@@ -12,6 +12,11 @@
 #include <chrono>
 #include <deque>
 
+#include "channel_groups.hpp"
+#include "disturbance_recorder.hpp"
+#include "frequency_tracker.hpp"
+#include "power_quality.hpp"
+
 namespace vts {
 namespace analyzer {
 
@@ -60,6 +65,7 @@ struct AnalysisFrame {
     std::chrono::steady_clock::time_point timestamp;
     std::string streamId;
     std::vector<ChannelAnalysis> channels;
+    std::vector<GroupQuantities> groups;    // Configured channel groups with all channels present
     int sampleRate;
     int samplesPerCycle;
     
@@ -92,6 +98,14 @@ using AnalysisCallback = std::function<void(const AnalysisFrame&)>;
  */
 using WaveformCallback = std::function<void(const std::vector<WaveformData>&)>;
 
+/**
+ * @brief Power-quality callback function
+ * 
+ * Called from the analysis thread with the aggregates and dip/swell
+ * events completed since the previous call
+ */
+using PowerQualityCallback = std::function<void(const std::vector<PqRecord>&, const std::vector<PqEvent>&)>;
+
 /**
  * @brief Ring buffer for sample storage
  */
@@ -149,8 +163,13 @@ private:
 /**
  * @brief Analyzer Engine
  * 
- * Sniffs SV packets, buffers samples, performs FFT-based phasor computation,
- * and streams results via callbacks.
+ * Sniffs SV packets, buffers samples, and streams results via callbacks.
+ * Phasors and harmonics come from a per-channel FrequencyTracker fed on
+ * every sample, so the analysis window follows the signal's frequency
+ * (45-65 Hz) instead of assuming nominal. The same coherent cycles feed a
+ * PowerQualityChannel per channel for IEC 61000-4-30 aggregates and
+ * dip/swell events. An optional DisturbanceRecorder takes the same samples
+ * and writes triggered COMTRADE records from its own thread.
  */
 class AnalyzerEngine {
 public:
@@ -162,9 +181,10 @@ public:
      * 
      * @param streamMac MAC address of SV stream to analyze (e.g., "01:0C:CD:04:00:02")
      * @param sampleRate Expected sample rate in Hz (default 4800)
+     * @param nominalFrequency Frequency the trackers start from (50 or 60 Hz)
      * @return true if started successfully, false otherwise
      */
-    bool start(const std::string& streamMac, int sampleRate = 4800);
+    bool start(const std::string& streamMac, int sampleRate = 4800, double nominalFrequency = 60.0);
     
     /**
      * @brief Stop analysis
@@ -199,6 +219,54 @@ public:
      */
     void setWaveformCallback(WaveformCallback callback);
     
+    /**
+     * @brief Set power-quality callback
+     * 
+     * @param callback Function called with completed PQ aggregates and events
+     */
+    void setPowerQualityCallback(PowerQualityCallback callback);
+    
+    /**
+     * @brief Power-quality settings applied from the next start()
+     * 
+     * nominalFrequency and startTime are filled in by start(). declaredValue
+     * only applies to channels some channel group uses as a voltage.
+     */
+    void setPowerQualityConfig(const PowerQualityConfig& config);
+    
+    /**
+     * @brief Replace the channel groups evaluated with every analysis frame
+     * 
+     * Defaults to one group over the 9-2LE layout (I: Ch0-Ch2, V: Ch4-Ch6).
+     */
+    void setChannelGroups(const std::vector<ChannelGroup>& groups);
+    
+    std::vector<ChannelGroup> getChannelGroups() const;
+    
+    /**
+     * @brief Disturbance recorder settings
+     * 
+     * Applied immediately when running (an open record is written
+     * truncated), otherwise from the next start().
+     * 
+     * @throws std::invalid_argument if the config is rejected
+     */
+    void setRecorderConfig(const RecorderConfig& config);
+    
+    RecorderConfig getRecorderConfig() const;
+    
+    /**
+     * @brief Counters of the active recorder, or of the last one if stopped
+     */
+    RecorderStatus getRecorderStatus() const;
+    
+    /**
+     * @brief Binary inputs and trip flag the recorder records and triggers on
+     * 
+     * Both must outlive the engine; either may be nullptr.
+     */
+    void setRecorderSources(const DigitalInputBank* inputs, const std::atomic<bool>* tripFlag);
+    
     /**
      * @brief Process incoming SV sample
      * 
@@ -221,18 +289,18 @@ public:
 
 private:
     void analysisThread();
-    void performFFT(const std::vector<double>& samples, std::vector<double>& magnitudes, 
-                   std::vector<double>& phases);
-    ChannelAnalysis analyzeChannel(const std::string& channelName, 
-                                   const std::vector<double>& samples);
-    double computeFrequency(const std::vector<double>& samples, int sampleRate);
+    ChannelAnalysis analyzeChannel(const std::string& channelName,
+                                   const FrequencyTracker& tracker, double reference);
     void sendWaveformData();
+    std::unique_ptr<DisturbanceRecorder> makeRecorder();
+    void closeRecorder(std::unique_ptr<DisturbanceRecorder> recorder);
     void setError(const std::string& msg);
     
     // Configuration
     std::string streamMac_;
     int sampleRate_;
     int samplesPerCycle_;
+    double nominalFrequency_;
     
     // State
     std::atomic<bool> running_;
@@ -240,14 +308,35 @@ private:
     
     // Sample buffers (per channel)
     std::map<std::string, std::shared_ptr<RingBuffer<std::pair<double, std::chrono::steady_clock::time_point>>>> channelBuffers_;
-    std::mutex buffersMutex_;
+    std::map<std::string, std::unique_ptr<FrequencyTracker>> trackers_;   // Guarded by buffersMutex_
+    
+    // Power quality, guarded by buffersMutex_
+    PowerQualityConfig pqConfig_;
+    int gridPoints_;
+    std::map<std::string, std::unique_ptr<PowerQualityChannel>> pqChannels_;
+    std::vector<PqRecord> pqRecords_;
+    std::vector<PqEvent> pqEvents_;
+    
+    // Disturbance recorder, guarded by buffersMutex_
+    RecorderConfig recorderConfig_;
+    std::unique_ptr<DisturbanceRecorder> recorder_;
+    std::map<std::string, int> recorderColumns_;
+    RecorderStatus lastRecorderStatus_;
+    const DigitalInputBank* recorderInputs_;
+    const std::atomic<bool>* tripFlag_;
+    mutable std::mutex buffersMutex_;
     
     // Analysis thread
     std::thread analysisThread_;
     
+    // Three-phase groups
+    GroupCalculator groupCalculator_;
+    mutable std::mutex groupsMutex_;
+    
     // Callbacks
     AnalysisCallback analysisCallback_;
     WaveformCallback waveformCallback_;
+    PowerQualityCallback powerQualityCallback_;
     std::mutex callbackMutex_;
     
     // Error handling
@@ -0,0 +1,96 @@
+#ifndef VTS_CHANNEL_GROUPS_HPP
+#define VTS_CHANNEL_GROUPS_HPP
+
+#include <array>
+#include <complex>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vts {
+namespace analyzer {
+
+/**
+ * @brief A three-phase voltage/current set within the analyzed stream
+ *
+ * Channel names are the analyzer's (e.g. "Ch4"). remoteCurrent is
+ * optional; when set, differential and restraint currents are computed
+ * against current.
+ */
+struct ChannelGroup {
+    std::string name;
+    std::array<std::string, 3> voltage;         // A, B, C
+    std::array<std::string, 3> current;         // A, B, C
+    std::array<std::string, 3> remoteCurrent;   // Empty names: no differential
+    std::complex<double> k0{0.0, 0.0};          // Residual compensation (Z0 - Z1) / 3Z1
+
+    bool hasDifferential() const { return !remoteCurrent[0].empty(); }
+};
+
+/**
+ * @brief Quantities derived from one group's phasors (RMS, common reference)
+ */
+struct GroupQuantities {
+    std::string name;
+
+    // Symmetrical components, index 0/1/2 = zero/positive/negative
+    std::array<std::complex<double>, 3> voltageSequence;
+    std::array<std::complex<double>, 3> currentSequence;
+
+    // Complex power S = V * conj(I) per phase, and the three-phase total
+    std::array<std::complex<double>, 3> phasePower;
+    std::complex<double> totalPower;
+    double powerFactor = 0.0;
+
+    // Apparent impedance per loop: AG, BG, CG (with k0), AB, BC, CA.
+    // NaN where the loop current is zero.
+    std::array<std::complex<double>, 6> impedance;
+
+    // Per phase |I + Iremote| and (|I| + |Iremote|) / 2; zero without remoteCurrent
+    std::array<double, 3> differential{};
+    std::array<double, 3> restraint{};
+};
+
+/**
+ * @brief Batched symmetrical-component, power and impedance computation
+ *
+ * setGroups() resolves the configuration once and sizes structure-of-
+ * arrays buffers for every input phasor and output quantity. compute()
+ * gathers the latest channel phasors into those buffers and runs each
+ * formula as one plain loop over all groups, which the compiler
+ * vectorizes; only the final scatter into GroupQuantities is per group.
+ * Groups with a missing channel are left out of the result.
+ */
+class GroupCalculator {
+public:
+    void setGroups(const std::vector<ChannelGroup>& groups);
+    const std::vector<ChannelGroup>& groups() const { return groups_; }
+
+    /**
+     * @brief Compute all groups from phasors keyed by channel name
+     */
+    void compute(const std::map<std::string, std::complex<double>>& phasors,
+                 std::vector<GroupQuantities>& out);
+
+private:
+    // Input slots: VA VB VC IA IB IC RA RB RC
+    static constexpr size_t Inputs = 9;
+
+    std::vector<ChannelGroup> groups_;
+    std::vector<char> present_;
+    std::array<std::vector<double>, Inputs> re_;
+    std::array<std::vector<double>, Inputs> im_;
+    std::array<std::vector<double>, 2> k0_;
+
+    // Outputs, one vector per scalar component
+    std::array<std::vector<double>, 12> seq_;       // V0 V1 V2 I0 I1 I2, re/im interleaved by slot
+    std::array<std::vector<double>, 6> power_;      // Pa Qa Pb Qb Pc Qc
+    std::array<std::vector<double>, 12> z_;         // 6 loops, re/im
+    std::array<std::vector<double>, 6> diff_;       // Id A B C, Ir A B C
+    std::array<std::vector<double>, 4> scratch_;    // Loop voltage/current, re/im
+};
+
+} // namespace analyzer
+} // namespace vts
+
+#endif // VTS_CHANNEL_GROUPS_HPP
@@ -0,0 +1,204 @@
+#ifndef VTS_DISTURBANCE_RECORDER_HPP
+#define VTS_DISTURBANCE_RECORDER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class DigitalInputBank;
+
+namespace vts {
+namespace analyzer {
+
+/**
+ * @brief Condition that starts (or extends) a recording
+ *
+ * Every trigger fires on the edge where its condition becomes true, so a
+ * persisting condition records once.
+ */
+struct RecorderTrigger {
+    enum class Type {
+        OverCurrent,     // One-cycle RMS of channel rises above level
+        UnderCurrent,    // One-cycle RMS of channel falls below level
+        RateOfChange,    // |dx/dt| of channel exceeds level (units per second)
+        GooseTrip,       // Trip flag raised by the GOOSE trip rules
+        DigitalChange    // Binary input changes state
+    };
+    Type type = Type::OverCurrent;
+    std::string channel;         // Analog channel, for the first three types
+    size_t input = 0;            // DigitalChange: input number
+    double level = 0.0;
+};
+
+/**
+ * @brief Disturbance recorder settings
+ */
+struct RecorderConfig {
+    bool enabled = false;
+    std::string directory = "recordings";
+    std::string stationName = "VTS";
+    std::string deviceId = "Analyzer";
+    std::vector<std::string> channels;       // Analog channels; empty records Ch0-Ch7
+    std::vector<size_t> digitalInputs;       // Binary inputs (max 64); DigitalChange inputs are added
+    double preTrigger = 0.1;                 // Seconds kept before the first trigger
+    double postTrigger = 0.4;                // Seconds after the last trigger
+    double maxLength = 2.0;                  // Seconds per record, retriggers included
+    std::vector<RecorderTrigger> triggers;
+};
+
+/**
+ * @brief Recorder counters and recent output
+ */
+struct RecorderStatus {
+    uint64_t triggers = 0;                   // Trigger edges seen
+    uint64_t records = 0;                    // Recordings written
+    uint64_t dropped = 0;                    // Lost to a full queue or ring overrun
+    uint64_t writeErrors = 0;
+    std::vector<std::string> recentFiles;    // .cfg paths, newest last
+    std::string lastError;
+};
+
+/**
+ * @brief Triggered recorder writing COMTRADE from the analyzer sample stream
+ *
+ * sample() is called by one producer thread (the RX thread, through
+ * AnalyzerEngine::processSample) and is wait-free: rows go into a
+ * power-of-two ring of atomics sized for two maximum-length records plus
+ * pre-trigger history, triggers are evaluated in place, and a completed
+ * record is only a (start, trigger, end) descriptor pushed onto a
+ * single-producer queue. A background thread copies each completed record
+ * out of the ring and writes it as binary COMTRADE; rows the producer
+ * overwrote before the copy finished are detected from the ring head and
+ * the record is counted as dropped instead of written torn. Back-to-back
+ * triggers extend the open record up to maxLength, then start a new one;
+ * a full queue drops the record rather than blocking.
+ */
+class DisturbanceRecorder {
+public:
+    /**
+     * @param inputs Binary inputs for digital channels/triggers (optional)
+     * @param tripFlag Flag watched by GooseTrip triggers (optional)
+     * @throws std::invalid_argument if validate() rejects the config
+     */
+    DisturbanceRecorder(const RecorderConfig& config, double sampleRate, double nominalFrequency,
+                        const DigitalInputBank* inputs = nullptr,
+                        const std::atomic<bool>* tripFlag = nullptr);
+
+    ~DisturbanceRecorder();
+
+    DisturbanceRecorder(const DisturbanceRecorder&) = delete;
+    DisturbanceRecorder& operator=(const DisturbanceRecorder&) = delete;
+
+    /**
+     * @brief Check a config without creating a recorder
+     * @throws std::invalid_argument with the reason
+     */
+    static void validate(const RecorderConfig& config, double sampleRate, size_t inputCount);
+
+    /**
+     * @brief Column of an analog channel, -1 if not recorded
+     */
+    int column(const std::string& channel) const;
+
+    /**
+     * @brief Add one analog value (producer thread only)
+     *
+     * Values for one instant arrive in column order; a column at or below
+     * the previous one starts the next row.
+     */
+    void sample(int column, double value);
+
+    /**
+     * @brief Write the open record (truncated) and everything queued, then stop
+     *
+     * The producer must have stopped calling sample(). Also run by the
+     * destructor; later calls do nothing.
+     */
+    void close();
+
+    RecorderStatus status() const;
+    const RecorderConfig& config() const { return config_; }
+
+private:
+    struct Capture {
+        uint64_t start = 0;      // First row
+        uint64_t trigger = 0;    // Row of the first trigger
+        uint64_t end = 0;        // One past the last row
+        double triggerTime = 0.0;
+        size_t reason = 0;       // Index into config_.triggers
+    };
+
+    struct TriggerState {
+        int column = -1;
+        uint64_t bit = 0;
+        bool state = false;
+        bool primed = false;
+    };
+
+    void commitRow();
+    void evaluate(size_t index, bool condition, uint64_t row);
+    void onTrigger(size_t index, uint64_t row);
+    void seal(const Capture& capture);
+    void writerThread();
+    void writeRecord(const Capture& capture, const std::vector<double>& analog,
+                     const std::vector<uint64_t>& digital);
+
+    RecorderConfig config_;
+    double sampleRate_;
+    double nominalFrequency_;
+    const DigitalInputBank* inputs_;
+    const std::atomic<bool>* tripFlag_;
+    size_t columns_;
+    uint64_t preRows_;
+    uint64_t postRows_;
+    uint64_t maxRows_;
+
+    // Ring, written by the producer only
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<std::atomic<float>[]> analog_;
+    std::unique_ptr<std::atomic<uint64_t>[]> digital_;
+    std::atomic<uint64_t> head_;             // Rows committed
+
+    // Producer state
+    std::vector<double> row_;
+    std::vector<double> previous_;
+    std::vector<double> halfSquares_;        // Current half cycle, per column
+    std::vector<double> lastHalfSquares_;
+    int lastColumn_;
+    uint64_t previousDigital_;
+    int halfRows_;
+    int halfCount_;
+    int halves_;
+    std::vector<TriggerState> triggerStates_;
+    bool open_;
+    Capture current_;
+
+    // Completed records, producer -> writer
+    static constexpr size_t QueueCapacity = 32;
+    Capture queue_[QueueCapacity];
+    std::atomic<size_t> queueHead_;          // Next to read
+    std::atomic<size_t> queueTail_;          // Next to write
+
+    // Writer
+    std::thread writer_;
+    std::atomic<bool> stop_;
+    uint64_t sequence_;
+
+    std::atomic<uint64_t> triggerCount_;
+    std::atomic<uint64_t> recordCount_;
+    std::atomic<uint64_t> droppedCount_;
+    std::atomic<uint64_t> errorCount_;
+    std::vector<std::string> recentFiles_;
+    std::string lastError_;
+    mutable std::mutex statusMutex_;
+};
+
+} // namespace analyzer
+} // namespace vts
+
+#endif // VTS_DISTURBANCE_RECORDER_HPP
@@ -0,0 +1,169 @@
+#ifndef VTS_FREQUENCY_TRACKER_HPP
+#define VTS_FREQUENCY_TRACKER_HPP
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace vts {
+namespace analyzer {
+
+/**
+ * @brief Frequency tracker configuration
+ */
+struct FrequencyTrackerConfig {
+    double sampleRate = 4800.0;
+    double nominalFrequency = 60.0;
+    double minFrequency = 45.0;
+    double maxFrequency = 65.0;
+    int pointsPerCycle = 64;      // Resampled grid points per tracked cycle
+    double loopGain = 0.7;        // Fraction of the measured error corrected per cycle
+    double minAmplitude = 1e-6;   // Below this (peak) the frequency is held
+    int interpolatorTaps = 6;     // 6: Lagrange; 8..64 (even): Kaiser-windowed sinc, flat to ~0.4 fs
+};
+
+/**
+ * @brief Frequency-locked resampler with a per-cycle DFT
+ *
+ * Every input sample is pushed as it arrives. A 6-point Lagrange (or,
+ * for content near the input Nyquist, a tabulated windowed-sinc)
+ * interpolator resamples the input onto a grid of pointsPerCycle points
+ * per *tracked* cycle, and each grid point is folded into a DFT (bins
+ * 0..MaxHarmonic) of the current cycle. At the end of every tracked cycle
+ * the window is coherent with the signal, so the bins are free of
+ * leakage, and the fundamental's phase advance since the previous cycle
+ * gives the frequency error:
+ *
+ *   f = f_used * (1 + dphi / 2pi)
+ *
+ * The tracked frequency moves by loopGain of that error (clamped to
+ * [minFrequency, maxFrequency]) and the next cycle is resampled with it.
+ * Cost per input sample is one interpolation and MaxHarmonic + 1 complex
+ * multiply-adds; nothing allocates after construction. Cycles straddling a
+ * step in amplitude hold the frequency rather than measure it.
+ */
+class FrequencyTracker {
+public:
+    static constexpr int MaxHarmonic = 15;
+
+    explicit FrequencyTracker(const FrequencyTrackerConfig& config = FrequencyTrackerConfig());
+
+    void reset();
+
+    /**
+     * @brief Feed one input sample
+     * @return true if a cycle completed (a new spectrum is available)
+     */
+    bool push(double sample);
+
+    /**
+     * @brief Tracked frequency (Hz) used for the current cycle
+     */
+    double frequency() const { return frequency_; }
+
+    /**
+     * @brief Resample at this frequency (clamped) from the next grid point,
+     *        e.g. to follow another channel's tracker; with a loopGain of 0
+     *        it is held there
+     */
+    void setFrequency(double frequency);
+
+    /**
+     * @brief Frequency measured over the last completed cycle
+     */
+    double measuredFrequency() const { return measured_; }
+
+    /**
+     * @brief Last |measured - tracked| was under 0.01 Hz with enough signal
+     */
+    bool locked() const { return locked_; }
+
+    /**
+     * @brief At least one full cycle has been analysed
+     */
+    bool valid() const { return cycles_ > 0; }
+
+    uint64_t cycles() const { return cycles_; }
+
+    /**
+     * @brief Peak phasor of harmonic h (0 = DC) over the last cycle; angle
+     *        is cosine-referenced at the start of that cycle
+     */
+    std::complex<double> harmonic(int h) const { return spectrum_[static_cast<size_t>(h)]; }
+
+    /**
+     * @brief Input sample index (fractional, counted from reset) at which
+     *        the last completed cycle started
+     */
+    double cycleStart() const { return cycleStart_; }
+
+    /**
+     * @brief Grid frequency the last completed cycle was resampled with, so
+     *        it lasted 1 / cycleFrequency() seconds
+     */
+    double cycleFrequency() const { return previousFrequency_; }
+
+    /**
+     * @brief Resampled points of the last completed cycle
+     */
+    const std::vector<double>& cycleGrid() const { return lastGrid_; }
+
+    int pointsPerCycle() const { return points_; }
+
+    /**
+     * @brief harmonic(h) rotated at the measured frequency to another input
+     *        sample index, so channels with unaligned cycles share a reference
+     */
+    std::complex<double> harmonicAt(int h, double sampleIndex) const;
+
+    /**
+     * @brief True RMS over the last resampled cycle
+     */
+    double rms() const { return rms_; }
+
+    const FrequencyTrackerConfig& config() const { return config_; }
+
+private:
+    void emitPoint(double y);
+    void endCycle();
+    double interpolate(double mu) const;
+
+    FrequencyTrackerConfig config_;
+    int points_;
+
+    // Input history for the interpolator
+    int taps_;
+    std::vector<double> history_;
+    uint64_t historyMask_;
+    std::vector<double> kernel_;    // Sinc weights per fractional phase, empty for Lagrange
+    uint64_t inputCount_;
+
+    // Next grid point, in input samples after the newest sample's node taps / 2 - 1
+    double position_;
+    double step_;
+    int gridIndex_;
+
+    std::vector<std::complex<double>> twiddle_;     // e^{-j 2 pi m / points}
+    std::vector<double> grid_;
+    std::vector<double> lastGrid_;
+    std::array<std::complex<double>, MaxHarmonic + 1> accumulator_;
+    std::array<std::complex<double>, MaxHarmonic + 1> spectrum_;
+    double sumSquares_;
+    double rms_;
+    double pendingStart_;       // Start of the cycle being accumulated
+    double cycleStart_;
+
+    double frequency_;          // Tracked, drives the grid
+    double measured_;
+    double previousFrequency_;  // Grid frequency of the previous cycle
+    std::complex<double> previous_;
+    bool havePrevious_;
+    bool locked_;
+    uint64_t cycles_;
+};
+
+} // namespace analyzer
+} // namespace vts
+
+#endif // VTS_FREQUENCY_TRACKER_HPP
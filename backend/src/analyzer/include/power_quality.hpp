@@ -0,0 +1,171 @@
+#ifndef VTS_POWER_QUALITY_HPP
+#define VTS_POWER_QUALITY_HPP
+
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frequency_tracker.hpp"
+
+namespace vts {
+namespace analyzer {
+
+/**
+ * @brief Power-quality settings for one channel
+ */
+struct PowerQualityConfig {
+    double nominalFrequency = 60.0;   // Selects 12-cycle (60 Hz) or 10-cycle (50 Hz) windows
+    int maxOrder = 50;                // Further limited to 0.44 fs, see PowerQualityChannel
+    double startTime = 0.0;           // UTC seconds of input sample 0, aligns 10 min / 2 h blocks
+    double declaredValue = 0.0;       // Udin (RMS); 0 disables dip/swell detection
+    double dipThreshold = 0.90;       // Fractions of declaredValue
+    double swellThreshold = 1.10;
+    double hysteresis = 0.02;
+    bool emitWindows = false;         // Also report every 10/12-cycle window
+};
+
+/**
+ * @brief Aggregation interval of a PQ record (IEC 61000-4-30 class A)
+ */
+enum class PqInterval {
+    Window,      // 10/12 cycles (~200 ms)
+    Short,       // 150/180 cycles (~3 s), resynchronised at each 10 min tick
+    TenMinute,
+    TwoHour
+};
+
+/**
+ * @brief RMS-aggregated measurements over one interval
+ *
+ * harmonics[h] is the harmonic subgroup of order h (index 0 is DC);
+ * interharmonics[h] is the centred subgroup between orders h and h + 1
+ * (IEC 61000-4-7). All values are RMS.
+ */
+struct PqRecord {
+    PqInterval interval = PqInterval::Window;
+    std::string channel;
+    double startTime = 0.0;      // UTC seconds
+    double endTime = 0.0;
+    uint32_t values = 0;         // Windows (or 10 min values for TwoHour) aggregated
+    bool flagged = false;        // A dip or swell overlapped the interval
+    double rms = 0.0;
+    double frequency = 0.0;
+    double thd = 0.0;            // Subgroup THD, % of the fundamental
+    std::vector<double> harmonics;
+    std::vector<double> interharmonics;
+};
+
+/**
+ * @brief Dip or swell detected on half-cycle RMS (Urms(1/2))
+ */
+struct PqEvent {
+    enum class Type { Dip, Swell };
+    Type type = Type::Dip;
+    std::string channel;
+    double startTime = 0.0;      // UTC seconds
+    double duration = 0.0;       // Seconds
+    double extreme = 0.0;        // Residual (dip) or maximum (swell) Urms(1/2)
+};
+
+/**
+ * @brief IEC 61000-4-30 style aggregation for one channel
+ *
+ * Consumes the coherent cycles of a FrequencyTracker (onCycle() after
+ * each push() that completes a cycle), so every 10/12-cycle window is
+ * synchronised to the measured frequency. The tracker should use a
+ * 32-tap interpolator; orders are capped where that stays flat (0.44 fs,
+ * e.g. the 34th at 4800 Hz / 60 Hz). At the end of a window one
+ * radix-2 FFT per cycle position (N FFTs of pointsPerCycle) plus an
+ * N-point combine per bin gives the 5 Hz spectrum; harmonic and
+ * interharmonic subgroups are folded into running sums of squares for
+ * the 150/180-cycle, 10 minute and 2 hour intervals. Cost per window is
+ * fixed and independent of interval length, and memory is one window of
+ * grid points plus three sets of sums; nothing is retained after a
+ * record is emitted.
+ *
+ * Urms(1/2) is refreshed every half cycle from the same grid points. A
+ * dip starts below dipThreshold and ends at dipThreshold + hysteresis; a
+ * swell mirrors it. Windows overlapping an event are flagged, and the
+ * flag carries into every aggregate containing them.
+ */
+class PowerQualityChannel {
+public:
+    /**
+     * @param pointsPerCycle Must match the tracker and be a power of two
+     * @throws std::invalid_argument otherwise
+     */
+    PowerQualityChannel(const std::string& channel, const PowerQualityConfig& config,
+                        double sampleRate, int pointsPerCycle);
+
+    /**
+     * @brief Fold the tracker's last completed cycle in
+     *
+     * Completed records and events are appended to the outputs.
+     */
+    void onCycle(const FrequencyTracker& tracker, std::vector<PqRecord>& records,
+                 std::vector<PqEvent>& events);
+
+    int maxOrder() const { return maxOrder_; }
+    int windowCycles() const { return cycles_; }
+
+private:
+    struct Aggregate {
+        double start = 0.0;
+        double end = 0.0;
+        uint32_t values = 0;
+        bool flagged = false;
+        double rmsSquares = 0.0;
+        double frequencySum = 0.0;
+        std::vector<double> harmonicSquares;
+        std::vector<double> interharmonicSquares;
+
+        void reset(size_t orders);
+        void add(const PqRecord& value);
+        PqRecord result(PqInterval interval, const std::string& channel) const;
+    };
+
+    void endWindow(double endTime, std::vector<PqRecord>& records);
+    void closeTenMinute(std::vector<PqRecord>& records);
+    void halfCycle(double rms, double time, std::vector<PqEvent>& events);
+    void fft(std::vector<std::complex<double>>& data) const;
+
+    std::string channel_;
+    PowerQualityConfig config_;
+    double sampleRate_;
+    int points_;
+    int cycles_;         // N: cycles per window
+    int maxOrder_;
+
+    // Current window
+    std::vector<double> window_;
+    int cycleCount_;
+    double windowStart_;
+    double frequencySum_;
+    bool windowFlagged_;
+
+    // FFT scratch and tables
+    std::vector<std::complex<double>> fftTwiddle_;
+    std::vector<uint32_t> bitReverse_;
+    std::vector<std::vector<std::complex<double>>> columns_;
+    std::vector<std::complex<double>> combineTwiddle_;   // e^{-j 2 pi k / (N * points)}
+    PqRecord windowRecord_;
+
+    // Aggregates
+    Aggregate short_;
+    Aggregate tenMinute_;
+    Aggregate twoHour_;
+
+    // Urms(1/2)
+    double previousHalfSquares_;
+    bool haveHalf_;
+    bool inDip_;
+    bool inSwell_;
+    double eventStart_;
+    double eventExtreme_;
+};
+
+} // namespace analyzer
+} // namespace vts
+
+#endif // VTS_POWER_QUALITY_HPP
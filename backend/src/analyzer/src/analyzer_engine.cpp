@@ -1,4 +1,5 @@
 #include "analyzer_engine.hpp"
+#include "digital_input_bank.hpp"
 #include "logger.hpp"
 #include <cmath>
 #include <algorithm>
@@ -10,7 +11,11 @@ namespace analyzer {
 
 // Constants
 static constexpr double PI = 3.14159265358979323846;
-static constexpr int MAX_HARMONICS = 15;
+static constexpr int MAX_HARMONICS = FrequencyTracker::MaxHarmonic;
+static constexpr double MIN_FREQUENCY = 45.0;
+static constexpr double MAX_FREQUENCY = 65.0;
+static constexpr int INTERPOLATOR_TAPS = 32;        // Flat to 0.44 fs for PQ harmonics
+static constexpr size_t PQ_MAX_PENDING = 1024;      // Undelivered PQ records/events kept
 static constexpr int WAVEFORM_UPDATE_RATE_MS = 16; // ~60 Hz
 static constexpr int ANALYSIS_UPDATE_RATE_MS = 100; // 10 Hz
 
@@ -18,16 +23,25 @@ AnalyzerEngine::AnalyzerEngine()
     : streamMac_(""),
       sampleRate_(4800),
       samplesPerCycle_(80),
+      nominalFrequency_(60.0),
       running_(false),
       stopRequested_(false),
+      gridPoints_(128),
+      recorderInputs_(nullptr),
+      tripFlag_(nullptr),
       lastError_("") {
+    ChannelGroup group;
+    group.name = "default";
+    group.current = {"Ch0", "Ch1", "Ch2"};
+    group.voltage = {"Ch4", "Ch5", "Ch6"};
+    groupCalculator_.setGroups({group});
 }
 
 AnalyzerEngine::~AnalyzerEngine() {
     stop();
 }
 
-bool AnalyzerEngine::start(const std::string& streamMac, int sampleRate) {
+bool AnalyzerEngine::start(const std::string& streamMac, int sampleRate, double nominalFrequency) {
     if (running_.load()) {
         setError("Analyzer already running");
         return false;
@@ -43,14 +57,34 @@ bool AnalyzerEngine::start(const std::string& streamMac, int sampleRate) {
         return false;
     }
     
+    if (!(nominalFrequency >= MIN_FREQUENCY && nominalFrequency <= MAX_FREQUENCY)) {
+        setError("Nominal frequency must be between 45 and 65 Hz");
+        return false;
+    }
+    
     streamMac_ = streamMac;
     sampleRate_ = sampleRate;
-    samplesPerCycle_ = sampleRate / 60; // Assuming 60 Hz
+    nominalFrequency_ = nominalFrequency;
+    samplesPerCycle_ = static_cast<int>(std::lround(sampleRate / nominalFrequency));
     
-    // Clear existing buffers
+    // Power-of-two grid at least as dense as the input, so resampling never aliases
+    gridPoints_ = 64;
+    while (gridPoints_ < samplesPerCycle_) {
+        gridPoints_ *= 2;
+    }
+    
+    // Clear existing buffers and trackers
     {
         std::lock_guard<std::mutex> lock(buffersMutex_);
         channelBuffers_.clear();
+        trackers_.clear();
+        pqChannels_.clear();
+        pqRecords_.clear();
+        pqEvents_.clear();
+        pqConfig_.nominalFrequency = nominalFrequency;
+        pqConfig_.startTime = std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        recorder_ = makeRecorder();
     }
     
     running_.store(true);
@@ -77,6 +111,13 @@ void AnalyzerEngine::stop() {
         analysisThread_.join();
     }
     
+    std::unique_ptr<DisturbanceRecorder> recorder;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        recorder = std::move(recorder_);
+    }
+    closeRecorder(std::move(recorder));
+    
     LOG_INFO("ANALYZER", "Stopped analyzing stream: {}", streamMac_.c_str());
     
     streamMac_.clear();
@@ -100,6 +141,85 @@ void AnalyzerEngine::setWaveformCallback(WaveformCallback callback) {
     waveformCallback_ = callback;
 }
 
+void AnalyzerEngine::setPowerQualityCallback(PowerQualityCallback callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    powerQualityCallback_ = callback;
+}
+
+void AnalyzerEngine::setPowerQualityConfig(const PowerQualityConfig& config) {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    pqConfig_ = config;
+}
+
+void AnalyzerEngine::setChannelGroups(const std::vector<ChannelGroup>& groups) {
+    std::lock_guard<std::mutex> lock(groupsMutex_);
+    groupCalculator_.setGroups(groups);
+}
+
+std::vector<ChannelGroup> AnalyzerEngine::getChannelGroups() const {
+    std::lock_guard<std::mutex> lock(groupsMutex_);
+    return groupCalculator_.groups();
+}
+
+void AnalyzerEngine::setRecorderConfig(const RecorderConfig& config) {
+    std::unique_ptr<DisturbanceRecorder> previous;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        DisturbanceRecorder::validate(config, sampleRate_, recorderInputs_ ? recorderInputs_->size() : 0);
+        recorderConfig_ = config;
+        if (running_.load()) {
+            previous = std::move(recorder_);
+            recorder_ = makeRecorder();
+        }
+    }
+    // Flushing the old recorder may write files; keep it off the sample path
+    closeRecorder(std::move(previous));
+}
+
+RecorderConfig AnalyzerEngine::getRecorderConfig() const {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    return recorderConfig_;
+}
+
+RecorderStatus AnalyzerEngine::getRecorderStatus() const {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    return recorder_ ? recorder_->status() : lastRecorderStatus_;
+}
+
+void AnalyzerEngine::setRecorderSources(const DigitalInputBank* inputs, const std::atomic<bool>* tripFlag) {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    recorderInputs_ = inputs;
+    tripFlag_ = tripFlag;
+}
+
+std::unique_ptr<DisturbanceRecorder> AnalyzerEngine::makeRecorder() {
+    recorderColumns_.clear();
+    if (!recorderConfig_.enabled) {
+        return nullptr;
+    }
+    try {
+        auto recorder = std::make_unique<DisturbanceRecorder>(recorderConfig_, sampleRate_, nominalFrequency_,
+                                                              recorderInputs_, tripFlag_);
+        for (const auto& entry : channelBuffers_) {
+            recorderColumns_[entry.first] = recorder->column(entry.first);
+        }
+        return recorder;
+    } catch (const std::exception& e) {
+        setError(std::string("Disturbance recorder disabled: ") + e.what());
+        return nullptr;
+    }
+}
+
+void AnalyzerEngine::closeRecorder(std::unique_ptr<DisturbanceRecorder> recorder) {
+    if (!recorder) {
+        return;
+    }
+    recorder->close();
+    RecorderStatus status = recorder->status();
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    lastRecorderStatus_ = std::move(status);
+}
+
 void AnalyzerEngine::processSample(const std::string& streamMac, const std::string& channelName,
                                   double value, std::chrono::steady_clock::time_point timestamp) {
     if (!running_.load()) {
@@ -122,11 +242,47 @@ void AnalyzerEngine::processSample(const std::string& streamMac, const std::stri
         channelBuffers_[channelName] = buffer;
         it = channelBuffers_.find(channelName);
         
+        FrequencyTrackerConfig config;
+        config.sampleRate = sampleRate_;
+        config.nominalFrequency = nominalFrequency_;
+        config.minFrequency = MIN_FREQUENCY;
+        config.maxFrequency = MAX_FREQUENCY;
+        config.pointsPerCycle = gridPoints_;
+        config.interpolatorTaps = INTERPOLATOR_TAPS;
+        trackers_[channelName] = std::make_unique<FrequencyTracker>(config);
+        
+        PowerQualityConfig pq = pqConfig_;
+        bool voltage = false;
+        for (const auto& group : getChannelGroups()) {
+            voltage = voltage || std::find(group.voltage.begin(), group.voltage.end(), channelName) != group.voltage.end();
+        }
+        if (!voltage) {
+            pq.declaredValue = 0.0;
+        }
+        pqChannels_[channelName] = std::make_unique<PowerQualityChannel>(channelName, pq, sampleRate_, gridPoints_);
+        recorderColumns_[channelName] = recorder_ ? recorder_->column(channelName) : -1;
+        
         LOG_INFO("ANALYZER", "Created buffer for channel: {} (capacity: {})", channelName.c_str(), capacity);
     }
     
-    // Add sample to buffer
+    // Add sample to buffer; the tracker consumes it immediately
     it->second->push(std::make_pair(value, timestamp));
+    FrequencyTracker& tracker = *trackers_.at(channelName);
+    if (tracker.push(value)) {
+        pqChannels_.at(channelName)->onCycle(tracker, pqRecords_, pqEvents_);
+        
+        // Bounded if nobody drains them: keep the newest
+        if (pqRecords_.size() > PQ_MAX_PENDING) {
+            pqRecords_.erase(pqRecords_.begin(), pqRecords_.end() - static_cast<long>(PQ_MAX_PENDING));
+        }
+        if (pqEvents_.size() > PQ_MAX_PENDING) {
+            pqEvents_.erase(pqEvents_.begin(), pqEvents_.end() - static_cast<long>(PQ_MAX_PENDING));
+        }
+    }
+    
+    if (recorder_) {
+        recorder_->sample(recorderColumns_[channelName], value);
+    }
 }
 
 std::string AnalyzerEngine::getLastError() const {
@@ -145,6 +301,9 @@ void AnalyzerEngine::analysisThread() {
     
     auto lastWaveformUpdate = std::chrono::steady_clock::now();
     auto lastAnalysisUpdate = std::chrono::steady_clock::now();
+    std::map<std::string, std::complex<double>> fundamentals;    // RMS, per channel
+    std::vector<PqRecord> pqRecords;
+    std::vector<PqEvent> pqEvents;
     
     while (!stopRequested_.load()) {
         auto now = std::chrono::steady_clock::now();
@@ -163,33 +322,37 @@ void AnalyzerEngine::analysisThread() {
             now - lastAnalysisUpdate).count();
         
         if (analysisElapsed >= ANALYSIS_UPDATE_RATE_MS) {
-            // Perform FFT-based analysis
+            // Report the last completed tracked cycle of each channel
             AnalysisFrame frame;
             frame.timestamp = now;
             frame.streamId = streamMac_;
             frame.sampleRate = sampleRate_;
             frame.samplesPerCycle = samplesPerCycle_;
+            fundamentals.clear();
             
             {
                 std::lock_guard<std::mutex> lock(buffersMutex_);
                 
-                for (const auto& [channelName, buffer] : channelBuffers_) {
-                    // Need at least one cycle of data
-                    if (buffer->size() >= static_cast<size_t>(samplesPerCycle_)) {
-                        auto samples = buffer->getAll();
-                        
-                        // Extract just the values
-                        std::vector<double> values;
-                        values.reserve(samples.size());
-                        for (const auto& sample : samples) {
-                            values.push_back(sample.first);
-                        }
-                        
-                        // Analyze this channel
-                        ChannelAnalysis analysis = analyzeChannel(channelName, values);
-                        frame.channels.push_back(analysis);
+                // Channels finish cycles at different instants; rotate all
+                // phasors to the latest cycle start so angles are comparable
+                double reference = 0.0;
+                for (const auto& entry : trackers_) {
+                    reference = std::max(reference, entry.second->cycleStart());
+                }
+                for (const auto& [channelName, tracker] : trackers_) {
+                    if (tracker->valid()) {
+                        frame.channels.push_back(analyzeChannel(channelName, *tracker, reference));
+                        fundamentals[channelName] = tracker->harmonicAt(1, reference) / std::sqrt(2.0);
                     }
                 }
+                
+                pqRecords.swap(pqRecords_);
+                pqEvents.swap(pqEvents_);
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(groupsMutex_);
+                groupCalculator_.compute(fundamentals, frame.groups);
             }
             
             // Send analysis results if we have data
@@ -200,6 +363,15 @@ void AnalyzerEngine::analysisThread() {
                 }
             }
             
+            if (!pqRecords.empty() || !pqEvents.empty()) {
+                std::lock_guard<std::mutex> lock(callbackMutex_);
+                if (powerQualityCallback_) {
+                    powerQualityCallback_(pqRecords, pqEvents);
+                }
+            }
+            pqRecords.clear();
+            pqEvents.clear();
+            
             lastAnalysisUpdate = now;
         }
         
@@ -210,125 +382,41 @@ void AnalyzerEngine::analysisThread() {
     LOG_INFO("ANALYZER", "Analysis thread stopped");
 }
 
-void AnalyzerEngine::performFFT(const std::vector<double>& samples, 
-                               std::vector<double>& magnitudes, 
-                               std::vector<double>& phases) {
-    size_t N = samples.size();
-    magnitudes.resize(N / 2 + 1);
-    phases.resize(N / 2 + 1);
-    
-    // Simple DFT implementation (can be replaced with kissfft for performance)
-    for (size_t k = 0; k <= N / 2; k++) {
-        double real = 0.0;
-        double imag = 0.0;
-        
-        for (size_t n = 0; n < N; n++) {
-            double angle = 2.0 * PI * k * n / N;
-            real += samples[n] * std::cos(angle);
-            imag -= samples[n] * std::sin(angle);
-        }
-        
-        // Normalize
-        real /= N;
-        imag /= N;
-        
-        // Convert to magnitude and phase
-        magnitudes[k] = 2.0 * std::sqrt(real * real + imag * imag); // Factor of 2 for single-sided
-        phases[k] = std::atan2(imag, real) * 180.0 / PI; // Convert to degrees
-        
-        // DC component doesn't get doubled
-        if (k == 0) {
-            magnitudes[k] /= 2.0;
-        }
-    }
-}
-
 ChannelAnalysis AnalyzerEngine::analyzeChannel(const std::string& channelName,
-                                              const std::vector<double>& samples) {
+                                              const FrequencyTracker& tracker, double reference) {
     ChannelAnalysis result;
     result.channelName = channelName;
     
-    if (samples.empty()) {
-        return result;
-    }
-    
-    // Use exactly one cycle for analysis
-    size_t analysisSize = std::min(samples.size(), static_cast<size_t>(samplesPerCycle_));
-    std::vector<double> cycleData(samples.end() - analysisSize, samples.end());
-    
-    // Perform FFT
-    std::vector<double> magnitudes, phases;
-    performFFT(cycleData, magnitudes, phases);
+    // Tracker bins are peak phasors over one coherent cycle; report RMS
+    const std::complex<double> fundamental = tracker.harmonicAt(1, reference);
+    double rms = std::abs(fundamental) / std::sqrt(2.0);
+    result.fundamental = PhasorMeasurement(rms, std::arg(fundamental) * 180.0 / PI,
+                                           tracker.measuredFrequency());
     
-    // Extract fundamental (assuming 60 Hz)
-    // Fundamental is at bin 1 for 1-cycle FFT
-    if (magnitudes.size() > 1) {
-        double fundamentalMag = magnitudes[1];
-        double fundamentalPhase = phases[1];
-        
-        // Convert peak to RMS
-        double rms = fundamentalMag / std::sqrt(2.0);
+    // Extract harmonics (2nd through 15th)
+    double sumHarmonicSquared = 0.0;
+    for (int h = 2; h <= MAX_HARMONICS; h++) {
+        const std::complex<double> bin = tracker.harmonicAt(h, reference);
+        HarmonicComponent harmonic;
+        harmonic.order = h;
+        harmonic.magnitude = std::abs(bin) / std::sqrt(2.0); // RMS
+        harmonic.angleDeg = std::arg(bin) * 180.0 / PI;
         
-        result.fundamental = PhasorMeasurement(rms, fundamentalPhase, 60.0);
+        sumHarmonicSquared += harmonic.magnitude * harmonic.magnitude;
         
-        // Compute frequency using zero-crossing method or phase derivative
-        result.fundamental.frequency = computeFrequency(cycleData, sampleRate_);
-        
-        // Extract harmonics (2nd through 15th)
-        double sumHarmonicSquared = 0.0;
-        for (int h = 2; h <= MAX_HARMONICS && h < static_cast<int>(magnitudes.size()); h++) {
-            HarmonicComponent harmonic;
-            harmonic.order = h;
-            harmonic.magnitude = magnitudes[h] / std::sqrt(2.0); // RMS
-            harmonic.angleDeg = phases[h];
-            
-            sumHarmonicSquared += harmonic.magnitude * harmonic.magnitude;
-            
-            result.harmonics.push_back(harmonic);
-        }
-        
-        // Compute total RMS (DC + fundamental + harmonics)
-        double totalRmsSquared = 0.0;
-        for (const auto& mag : magnitudes) {
-            double rmsComponent = mag / std::sqrt(2.0);
-            totalRmsSquared += rmsComponent * rmsComponent;
-        }
-        result.rms = std::sqrt(totalRmsSquared);
-        
-        // Compute THD
-        if (rms > 0.0) {
-            result.thd = 100.0 * std::sqrt(sumHarmonicSquared) / rms;
-        } else {
-            result.thd = 0.0;
-        }
+        result.harmonics.push_back(harmonic);
     }
     
-    return result;
-}
-
-double AnalyzerEngine::computeFrequency(const std::vector<double>& samples, int sampleRate) {
-    if (samples.size() < 3) {
-        return 60.0; // Default
-    }
+    result.rms = tracker.rms();
     
-    // Count zero crossings
-    int crossings = 0;
-    for (size_t i = 1; i < samples.size(); i++) {
-        if ((samples[i-1] < 0 && samples[i] >= 0) || 
-            (samples[i-1] >= 0 && samples[i] < 0)) {
-            crossings++;
-        }
-    }
-    
-    if (crossings < 2) {
-        return 60.0; // Not enough crossings
+    // Compute THD
+    if (rms > 0.0) {
+        result.thd = 100.0 * std::sqrt(sumHarmonicSquared) / rms;
+    } else {
+        result.thd = 0.0;
     }
     
-    // Two crossings per cycle
-    double cycles = crossings / 2.0;
-    double duration = static_cast<double>(samples.size()) / sampleRate;
-    
-    return cycles / duration;
+    return result;
 }
 
 void AnalyzerEngine::sendWaveformData() {
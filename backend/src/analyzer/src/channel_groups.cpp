@@ -0,0 +1,206 @@
+#include "channel_groups.hpp"
+
+#include <cmath>
+
+namespace vts {
+namespace analyzer {
+
+static constexpr double SQRT3_2 = 0.866025403784438646763723170753;
+
+namespace {
+
+// Kernels over n groups. Every array is a distinct buffer; __restrict lets
+// the compiler vectorize without runtime overlap checks.
+
+// Z = V / I. Where I is zero both numerator terms are zero too, so the
+// result is 0 / 0 = NaN without a branch.
+void divide(size_t n, const double* __restrict vr, const double* __restrict vi,
+            const double* __restrict ir, const double* __restrict ii,
+            double* __restrict zr, double* __restrict zi) {
+    for (size_t g = 0; g < n; ++g) {
+        const double den = ir[g] * ir[g] + ii[g] * ii[g];
+        zr[g] = (vr[g] * ir[g] + vi[g] * ii[g]) / den;
+        zi[g] = (vi[g] * ir[g] - vr[g] * ii[g]) / den;
+    }
+}
+
+// D = X - Y
+void subtract(size_t n, const double* __restrict xr, const double* __restrict xi,
+              const double* __restrict yr, const double* __restrict yi,
+              double* __restrict dr, double* __restrict di) {
+    for (size_t g = 0; g < n; ++g) {
+        dr[g] = xr[g] - yr[g];
+        di[g] = xi[g] - yi[g];
+    }
+}
+
+// X0, X1, X2 of phases A, B, C
+void sequence(size_t n, const double* __restrict ar, const double* __restrict ai,
+              const double* __restrict br, const double* __restrict bi,
+              const double* __restrict cr, const double* __restrict ci,
+              double* __restrict x0r, double* __restrict x0i,
+              double* __restrict x1r, double* __restrict x1i,
+              double* __restrict x2r, double* __restrict x2i) {
+    for (size_t g = 0; g < n; ++g) {
+        // a*B, a^2*B, a*C, a^2*C with a = 1 at 120 degrees
+        const double aBr = -0.5 * br[g] - SQRT3_2 * bi[g], aBi = SQRT3_2 * br[g] - 0.5 * bi[g];
+        const double a2Br = -0.5 * br[g] + SQRT3_2 * bi[g], a2Bi = -SQRT3_2 * br[g] - 0.5 * bi[g];
+        const double aCr = -0.5 * cr[g] - SQRT3_2 * ci[g], aCi = SQRT3_2 * cr[g] - 0.5 * ci[g];
+        const double a2Cr = -0.5 * cr[g] + SQRT3_2 * ci[g], a2Ci = -SQRT3_2 * cr[g] - 0.5 * ci[g];
+        x0r[g] = (ar[g] + br[g] + cr[g]) / 3.0;
+        x0i[g] = (ai[g] + bi[g] + ci[g]) / 3.0;
+        x1r[g] = (ar[g] + aBr + a2Cr) / 3.0;
+        x1i[g] = (ai[g] + aBi + a2Ci) / 3.0;
+        x2r[g] = (ar[g] + a2Br + aCr) / 3.0;
+        x2i[g] = (ai[g] + a2Bi + aCi) / 3.0;
+    }
+}
+
+// S = V * conj(I)
+void power(size_t n, const double* __restrict vr, const double* __restrict vi,
+           const double* __restrict ir, const double* __restrict ii,
+           double* __restrict p, double* __restrict q) {
+    for (size_t g = 0; g < n; ++g) {
+        p[g] = vr[g] * ir[g] + vi[g] * ii[g];
+        q[g] = vi[g] * ir[g] - vr[g] * ii[g];
+    }
+}
+
+// Ground loop current I + k0 * 3I0
+void groundLoop(size_t n, const double* __restrict ir, const double* __restrict ii,
+                const double* __restrict i0r, const double* __restrict i0i,
+                const double* __restrict kr, const double* __restrict ki,
+                double* __restrict lr, double* __restrict li) {
+    for (size_t g = 0; g < n; ++g) {
+        const double rr = 3.0 * i0r[g], ri = 3.0 * i0i[g];
+        lr[g] = ir[g] + kr[g] * rr - ki[g] * ri;
+        li[g] = ii[g] + kr[g] * ri + ki[g] * rr;
+    }
+}
+
+// |I + R| and (|I| + |R|) / 2
+void differential(size_t n, const double* __restrict ir, const double* __restrict ii,
+                  const double* __restrict rr, const double* __restrict ri,
+                  double* __restrict operate, double* __restrict restraint) {
+    for (size_t g = 0; g < n; ++g) {
+        const double sr = ir[g] + rr[g], si = ii[g] + ri[g];
+        operate[g] = std::sqrt(sr * sr + si * si);
+        restraint[g] = 0.5 * (std::sqrt(ir[g] * ir[g] + ii[g] * ii[g]) +
+                              std::sqrt(rr[g] * rr[g] + ri[g] * ri[g]));
+    }
+}
+
+} // namespace
+
+void GroupCalculator::setGroups(const std::vector<ChannelGroup>& groups) {
+    groups_ = groups;
+    const size_t n = groups_.size();
+    present_.assign(n, 0);
+    for (auto& v : re_) v.assign(n, 0.0);
+    for (auto& v : im_) v.assign(n, 0.0);
+    for (auto& v : k0_) v.assign(n, 0.0);
+    for (auto& v : seq_) v.assign(n, 0.0);
+    for (auto& v : power_) v.assign(n, 0.0);
+    for (auto& v : z_) v.assign(n, 0.0);
+    for (auto& v : diff_) v.assign(n, 0.0);
+    for (auto& v : scratch_) v.assign(n, 0.0);
+    for (size_t g = 0; g < n; ++g) {
+        k0_[0][g] = groups_[g].k0.real();
+        k0_[1][g] = groups_[g].k0.imag();
+    }
+}
+
+void GroupCalculator::compute(const std::map<std::string, std::complex<double>>& phasors,
+                              std::vector<GroupQuantities>& out) {
+    out.clear();
+    const size_t n = groups_.size();
+    if (n == 0) {
+        return;
+    }
+
+    // Gather; a group with a missing channel computes on zeros and is dropped
+    for (size_t g = 0; g < n; ++g) {
+        const ChannelGroup& group = groups_[g];
+        const std::string* names[Inputs] = {
+            &group.voltage[0], &group.voltage[1], &group.voltage[2],
+            &group.current[0], &group.current[1], &group.current[2],
+            &group.remoteCurrent[0], &group.remoteCurrent[1], &group.remoteCurrent[2]};
+        const size_t used = group.hasDifferential() ? Inputs : 6;
+        bool complete = true;
+        for (size_t slot = 0; slot < Inputs; ++slot) {
+            std::complex<double> value(0.0, 0.0);
+            if (slot < used) {
+                auto it = phasors.find(*names[slot]);
+                if (it == phasors.end()) {
+                    complete = false;
+                } else {
+                    value = it->second;
+                }
+            }
+            re_[slot][g] = value.real();
+            im_[slot][g] = value.imag();
+        }
+        present_[g] = complete ? 1 : 0;
+    }
+
+    // Symmetrical components
+    sequence(n, re_[0].data(), im_[0].data(), re_[1].data(), im_[1].data(), re_[2].data(), im_[2].data(),
+             seq_[0].data(), seq_[1].data(), seq_[2].data(), seq_[3].data(), seq_[4].data(), seq_[5].data());
+    sequence(n, re_[3].data(), im_[3].data(), re_[4].data(), im_[4].data(), re_[5].data(), im_[5].data(),
+             seq_[6].data(), seq_[7].data(), seq_[8].data(), seq_[9].data(), seq_[10].data(), seq_[11].data());
+
+    for (size_t phase = 0; phase < 3; ++phase) {
+        const size_t v = phase, i = 3 + phase;
+        power(n, re_[v].data(), im_[v].data(), re_[i].data(), im_[i].data(),
+              power_[2 * phase].data(), power_[2 * phase + 1].data());
+
+        // Ground loop: V / (I + k0 * 3I0), with I0 from the sequence pass
+        groundLoop(n, re_[i].data(), im_[i].data(), seq_[6].data(), seq_[7].data(),
+                   k0_[0].data(), k0_[1].data(), scratch_[0].data(), scratch_[1].data());
+        divide(n, re_[v].data(), im_[v].data(), scratch_[0].data(), scratch_[1].data(),
+               z_[2 * phase].data(), z_[2 * phase + 1].data());
+
+        // Phase-to-phase loop: (Vx - Vy) / (Ix - Iy)
+        const size_t vNext = (phase + 1) % 3, iNext = 3 + vNext;
+        subtract(n, re_[v].data(), im_[v].data(), re_[vNext].data(), im_[vNext].data(),
+                 scratch_[0].data(), scratch_[1].data());
+        subtract(n, re_[i].data(), im_[i].data(), re_[iNext].data(), im_[iNext].data(),
+                 scratch_[2].data(), scratch_[3].data());
+        divide(n, scratch_[0].data(), scratch_[1].data(), scratch_[2].data(), scratch_[3].data(),
+               z_[6 + 2 * phase].data(), z_[7 + 2 * phase].data());
+
+        // Differential and restraint (zero for groups without remote currents)
+        differential(n, re_[i].data(), im_[i].data(), re_[6 + phase].data(), im_[6 + phase].data(),
+                     diff_[phase].data(), diff_[3 + phase].data());
+    }
+
+    // Scatter
+    for (size_t g = 0; g < n; ++g) {
+        if (!present_[g]) {
+            continue;
+        }
+        GroupQuantities q;
+        q.name = groups_[g].name;
+        for (size_t k = 0; k < 3; ++k) {
+            q.voltageSequence[k] = {seq_[2 * k][g], seq_[2 * k + 1][g]};
+            q.currentSequence[k] = {seq_[6 + 2 * k][g], seq_[7 + 2 * k][g]};
+            q.phasePower[k] = {power_[2 * k][g], power_[2 * k + 1][g]};
+        }
+        q.totalPower = q.phasePower[0] + q.phasePower[1] + q.phasePower[2];
+        const double apparent = std::abs(q.totalPower);
+        q.powerFactor = apparent > 0.0 ? q.totalPower.real() / apparent : 0.0;
+        for (size_t loop = 0; loop < 6; ++loop) {
+            q.impedance[loop] = {z_[2 * loop][g], z_[2 * loop + 1][g]};
+        }
+        if (groups_[g].hasDifferential()) {
+            for (size_t phase = 0; phase < 3; ++phase) {
+                q.differential[phase] = diff_[phase][g];
+                q.restraint[phase] = diff_[3 + phase][g];
+            }
+        }
+        out.push_back(std::move(q));
+    }
+}
+
+} // namespace analyzer
+} // namespace vts
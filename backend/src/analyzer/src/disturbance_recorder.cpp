@@ -0,0 +1,457 @@
+#include "disturbance_recorder.hpp"
+#include "digital_input_bank.hpp"
+#include "comtrade_writer.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+
+namespace vts {
+namespace analyzer {
+
+// Constants
+static constexpr int DEFAULT_CHANNELS = 8;              // Ch0-Ch7 when none are configured
+static constexpr size_t MAX_ANALOG_CHANNELS = 64;
+static constexpr size_t MAX_DIGITAL_CHANNELS = 64;
+static constexpr double MAX_RECORD_SECONDS = 60.0;
+static constexpr size_t MIN_RING_ROWS = 1024;
+static constexpr size_t RECENT_FILES = 16;
+static constexpr int WRITER_POLL_MS = 5;
+
+static std::vector<std::string> effectiveChannels(const RecorderConfig& config) {
+    if (!config.channels.empty()) {
+        return config.channels;
+    }
+    std::vector<std::string> channels;
+    for (int i = 0; i < DEFAULT_CHANNELS; i++) {
+        channels.push_back("Ch" + std::to_string(i));
+    }
+    return channels;
+}
+
+static std::vector<size_t> effectiveInputs(const RecorderConfig& config) {
+    std::vector<size_t> inputs = config.digitalInputs;
+    for (const auto& trigger : config.triggers) {
+        if (trigger.type == RecorderTrigger::Type::DigitalChange &&
+            std::find(inputs.begin(), inputs.end(), trigger.input) == inputs.end()) {
+            inputs.push_back(trigger.input);
+        }
+    }
+    return inputs;
+}
+
+void DisturbanceRecorder::validate(const RecorderConfig& config, double sampleRate, size_t inputCount) {
+    if (!(sampleRate > 0.0)) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+    if (config.directory.empty()) {
+        throw std::invalid_argument("Recording directory cannot be empty");
+    }
+    if (!(config.preTrigger >= 0.0) || !(config.postTrigger > 0.0)) {
+        throw std::invalid_argument("preTrigger must be >= 0 and postTrigger > 0");
+    }
+    if (!(config.maxLength >= config.preTrigger + config.postTrigger) || config.maxLength > MAX_RECORD_SECONDS) {
+        throw std::invalid_argument("maxLength must cover preTrigger + postTrigger and be at most 60 s");
+    }
+
+    // Names end up in comma-separated .cfg lines
+    auto checkName = [](const std::string& name, const char* what) {
+        if (name.empty() || name.find_first_of(",\r\n") != std::string::npos) {
+            throw std::invalid_argument(std::string(what) + " must be non-empty without commas: '" + name + "'");
+        }
+    };
+    checkName(config.stationName, "stationName");
+    checkName(config.deviceId, "deviceId");
+
+    const std::vector<std::string> channels = effectiveChannels(config);
+    if (channels.size() > MAX_ANALOG_CHANNELS) {
+        throw std::invalid_argument("At most 64 analog channels can be recorded");
+    }
+    for (size_t i = 0; i < channels.size(); i++) {
+        checkName(channels[i], "Channel name");
+        if (std::find(channels.begin(), channels.begin() + static_cast<long>(i), channels[i]) != channels.begin() + static_cast<long>(i)) {
+            throw std::invalid_argument("Duplicate channel " + channels[i]);
+        }
+    }
+
+    const std::vector<size_t> inputs = effectiveInputs(config);
+    if (inputs.size() > MAX_DIGITAL_CHANNELS) {
+        throw std::invalid_argument("At most 64 digital inputs can be recorded");
+    }
+    for (size_t input : inputs) {
+        if (inputCount > 0 && input >= inputCount) {
+            throw std::invalid_argument("Digital input " + std::to_string(input) + " out of range");
+        }
+    }
+
+    for (const auto& trigger : config.triggers) {
+        switch (trigger.type) {
+            case RecorderTrigger::Type::OverCurrent:
+            case RecorderTrigger::Type::UnderCurrent:
+            case RecorderTrigger::Type::RateOfChange:
+                if (std::find(channels.begin(), channels.end(), trigger.channel) == channels.end()) {
+                    throw std::invalid_argument("Trigger channel " + trigger.channel + " is not recorded");
+                }
+                if (!(trigger.level > 0.0)) {
+                    throw std::invalid_argument("Trigger level must be positive");
+                }
+                break;
+            case RecorderTrigger::Type::GooseTrip:
+            case RecorderTrigger::Type::DigitalChange:
+                break;
+        }
+    }
+}
+
+DisturbanceRecorder::DisturbanceRecorder(const RecorderConfig& config, double sampleRate, double nominalFrequency,
+                                         const DigitalInputBank* inputs, const std::atomic<bool>* tripFlag)
+    : config_(config),
+      sampleRate_(sampleRate),
+      nominalFrequency_(nominalFrequency),
+      inputs_(inputs),
+      tripFlag_(tripFlag),
+      head_(0),
+      lastColumn_(-1),
+      previousDigital_(0),
+      halfCount_(0),
+      halves_(0),
+      open_(false),
+      queueHead_(0),
+      queueTail_(0),
+      stop_(false),
+      sequence_(0),
+      triggerCount_(0),
+      recordCount_(0),
+      droppedCount_(0),
+      errorCount_(0) {
+    validate(config, sampleRate, inputs ? inputs->size() : 0);
+    config_.channels = effectiveChannels(config);
+    config_.digitalInputs = effectiveInputs(config);
+    columns_ = config_.channels.size();
+
+    preRows_ = static_cast<uint64_t>(std::llround(config.preTrigger * sampleRate));
+    postRows_ = std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(config.postTrigger * sampleRate)));
+    maxRows_ = std::max<uint64_t>(preRows_ + postRows_ + 1,
+                                  static_cast<uint64_t>(std::llround(config.maxLength * sampleRate)));
+
+    // Room for a finished record plus one more before its rows are reused
+    capacity_ = MIN_RING_ROWS;
+    while (capacity_ < 2 * maxRows_) {
+        capacity_ *= 2;
+    }
+    mask_ = capacity_ - 1;
+    analog_ = std::make_unique<std::atomic<float>[]>(capacity_ * columns_);
+    digital_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+
+    row_.assign(columns_, 0.0);
+    previous_.assign(columns_, 0.0);
+    halfSquares_.assign(columns_, 0.0);
+    lastHalfSquares_.assign(columns_, 0.0);
+    halfRows_ = std::max(1, static_cast<int>(std::lround(sampleRate / nominalFrequency / 2.0)));
+
+    for (const auto& trigger : config_.triggers) {
+        TriggerState state;
+        if (trigger.type == RecorderTrigger::Type::DigitalChange) {
+            auto it = std::find(config_.digitalInputs.begin(), config_.digitalInputs.end(), trigger.input);
+            state.bit = uint64_t{1} << (it - config_.digitalInputs.begin());
+        } else {
+            state.column = column(trigger.channel);
+        }
+        triggerStates_.push_back(state);
+    }
+
+    writer_ = std::thread(&DisturbanceRecorder::writerThread, this);
+}
+
+DisturbanceRecorder::~DisturbanceRecorder() {
+    close();
+}
+
+void DisturbanceRecorder::close() {
+    if (open_) {
+        current_.end = std::min(current_.end, head_.load(std::memory_order_relaxed));
+        if (current_.end > current_.start) {
+            seal(current_);
+        }
+        open_ = false;
+    }
+    stop_.store(true, std::memory_order_release);
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+int DisturbanceRecorder::column(const std::string& channel) const {
+    for (size_t i = 0; i < config_.channels.size(); i++) {
+        if (config_.channels[i] == channel) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void DisturbanceRecorder::sample(int column, double value) {
+    if (column < 0 || static_cast<size_t>(column) >= columns_) {
+        return;
+    }
+    if (column <= lastColumn_) {
+        commitRow();
+    }
+    row_[static_cast<size_t>(column)] = value;
+    lastColumn_ = column;
+}
+
+void DisturbanceRecorder::commitRow() {
+    const uint64_t row = head_.load(std::memory_order_relaxed);
+    const size_t slot = static_cast<size_t>(row) & mask_;
+
+    std::atomic<float>* analog = analog_.get() + slot * columns_;
+    for (size_t c = 0; c < columns_; c++) {
+        analog[c].store(static_cast<float>(row_[c]), std::memory_order_relaxed);
+    }
+    uint64_t word = 0;
+    if (inputs_) {
+        for (size_t i = 0; i < config_.digitalInputs.size(); i++) {
+            word |= static_cast<uint64_t>(inputs_->get(config_.digitalInputs[i])) << i;
+        }
+    }
+    digital_[slot].store(word, std::memory_order_relaxed);
+    head_.store(row + 1, std::memory_order_release);
+
+    // One-cycle RMS, refreshed every half cycle
+    for (size_t c = 0; c < columns_; c++) {
+        halfSquares_[c] += row_[c] * row_[c];
+    }
+    const bool halfDone = ++halfCount_ == halfRows_;
+    if (halfDone) {
+        halves_++;
+    }
+
+    for (size_t k = 0; k < triggerStates_.size(); k++) {
+        const RecorderTrigger& trigger = config_.triggers[k];
+        const TriggerState& state = triggerStates_[k];
+        const size_t c = static_cast<size_t>(std::max(state.column, 0));
+        switch (trigger.type) {
+            case RecorderTrigger::Type::OverCurrent:
+            case RecorderTrigger::Type::UnderCurrent:
+                if (halfDone && halves_ >= 2) {
+                    const double rms = std::sqrt((lastHalfSquares_[c] + halfSquares_[c]) / (2.0 * halfRows_));
+                    evaluate(k, trigger.type == RecorderTrigger::Type::OverCurrent ? rms > trigger.level
+                                                                                   : rms < trigger.level, row);
+                }
+                break;
+            case RecorderTrigger::Type::RateOfChange:
+                if (row > 0) {
+                    evaluate(k, std::abs(row_[c] - previous_[c]) * sampleRate_ > trigger.level, row);
+                }
+                break;
+            case RecorderTrigger::Type::GooseTrip:
+                evaluate(k, tripFlag_ && tripFlag_->load(std::memory_order_acquire), row);
+                break;
+            case RecorderTrigger::Type::DigitalChange:
+                if (row > 0) {
+                    evaluate(k, ((word ^ previousDigital_) & state.bit) != 0, row);
+                }
+                break;
+        }
+    }
+
+    if (halfDone) {
+        lastHalfSquares_.swap(halfSquares_);
+        std::fill(halfSquares_.begin(), halfSquares_.end(), 0.0);
+        halfCount_ = 0;
+    }
+    previous_ = row_;
+    previousDigital_ = word;
+
+    if (open_ && row + 1 >= current_.end) {
+        seal(current_);
+        open_ = false;
+    }
+}
+
+void DisturbanceRecorder::evaluate(size_t index, bool condition, uint64_t row) {
+    TriggerState& state = triggerStates_[index];
+    if (!state.primed) {
+        // First evaluation only learns the state: a condition already true at start does not fire
+        state.primed = true;
+        state.state = condition;
+        return;
+    }
+    if (condition && !state.state) {
+        onTrigger(index, row);
+    }
+    state.state = condition;
+}
+
+void DisturbanceRecorder::onTrigger(size_t index, uint64_t row) {
+    triggerCount_.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t end = row + 1 + postRows_;
+
+    if (open_) {
+        if (end <= current_.start + maxRows_) {
+            current_.end = std::max(current_.end, end);
+            return;
+        }
+        // Retriggered past maxLength: close this record, the trigger starts the next
+        seal(current_);
+        open_ = false;
+    }
+
+    current_.start = row >= preRows_ ? row - preRows_ : 0;
+    current_.trigger = row;
+    current_.end = end;
+    current_.triggerTime = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    current_.reason = index;
+    open_ = true;
+}
+
+void DisturbanceRecorder::seal(const Capture& capture) {
+    const size_t tail = queueTail_.load(std::memory_order_relaxed);
+    if (tail - queueHead_.load(std::memory_order_acquire) >= QueueCapacity) {
+        droppedCount_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queue_[tail % QueueCapacity] = capture;
+    queueTail_.store(tail + 1, std::memory_order_release);
+}
+
+void DisturbanceRecorder::writerThread() {
+    struct Copy {
+        Capture capture;
+        std::vector<double> analog;
+        std::vector<uint64_t> digital;
+    };
+    std::vector<Copy> ready;
+
+    while (true) {
+        const bool stopping = stop_.load(std::memory_order_acquire);
+
+        // Copy every finished record out of the ring before any file I/O
+        while (true) {
+            const size_t head = queueHead_.load(std::memory_order_relaxed);
+            if (head == queueTail_.load(std::memory_order_acquire)) {
+                break;
+            }
+            Capture capture = queue_[head % QueueCapacity];
+            const uint64_t rows = head_.load(std::memory_order_acquire);
+            if (rows < capture.end) {
+                if (!stopping) {
+                    break;       // Sealed early by a retrigger; its tail is still arriving
+                }
+                capture.end = rows;
+            }
+
+            Copy copy;
+            copy.capture = capture;
+            const size_t length = static_cast<size_t>(capture.end - capture.start);
+            copy.analog.resize(length * columns_);
+            copy.digital.resize(length);
+            for (size_t r = 0; r < length; r++) {
+                const size_t slot = static_cast<size_t>(capture.start + r) & mask_;
+                const std::atomic<float>* analog = analog_.get() + slot * columns_;
+                for (size_t c = 0; c < columns_; c++) {
+                    copy.analog[r * columns_ + c] = static_cast<double>(analog[c].load(std::memory_order_relaxed));
+                }
+                copy.digital[r] = digital_[slot].load(std::memory_order_relaxed);
+            }
+            queueHead_.store(head + 1, std::memory_order_release);
+
+            // Row h is written into the slot of row h - capacity
+            if (head_.load(std::memory_order_acquire) >= capture.start + capacity_) {
+                droppedCount_.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(statusMutex_);
+                lastError_ = "Recording overwritten before it could be copied";
+                continue;
+            }
+            if (length > 0) {
+                ready.push_back(std::move(copy));
+            }
+        }
+
+        for (const auto& copy : ready) {
+            writeRecord(copy.capture, copy.analog, copy.digital);
+        }
+        ready.clear();
+
+        if (stopping && queueHead_.load() == queueTail_.load()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_POLL_MS));
+    }
+}
+
+void DisturbanceRecorder::writeRecord(const Capture& capture, const std::vector<double>& analog,
+                                      const std::vector<uint64_t>& digital) {
+    io::ComtradeConfig cfg;
+    cfg.stationName = config_.stationName;
+    cfg.recDeviceId = config_.deviceId;
+    for (size_t c = 0; c < columns_; c++) {
+        io::AnalogChannel channel{};
+        channel.index = static_cast<int>(c);
+        channel.name = config_.channels[c];
+        channel.primary = 1.0;
+        channel.secondary = 1.0;
+        channel.ps = 'P';
+        cfg.analogChannels.push_back(channel);
+    }
+    for (size_t i = 0; i < config_.digitalInputs.size(); i++) {
+        io::DigitalChannel channel{};
+        channel.index = static_cast<int>(i);
+        channel.name = "IN" + std::to_string(config_.digitalInputs[i]);
+        cfg.digitalChannels.push_back(channel);
+    }
+    cfg.lineFreq = nominalFrequency_;
+    cfg.sampleRates.push_back({sampleRate_, static_cast<int>(digital.size())});
+
+    const double startTime = capture.triggerTime -
+        static_cast<double>(capture.trigger - capture.start) / sampleRate_;
+    io::ComtradeWriter::formatTimestamp(startTime, cfg.startDate, cfg.startTime);
+    io::ComtradeWriter::formatTimestamp(capture.triggerTime, cfg.triggerDate, cfg.triggerTime);
+
+    // <station>_<yyyymmdd>_<hhmmss>_<ms>_<sequence>, from the trigger time
+    const std::string& d = cfg.triggerDate;   // dd/mm/yyyy
+    const std::string& t = cfg.triggerTime;   // hh:mm:ss.ssssss
+    const std::string name = config_.stationName + "_" + d.substr(6, 4) + d.substr(3, 2) + d.substr(0, 2) + "_" +
+        t.substr(0, 2) + t.substr(3, 2) + t.substr(6, 2) + "_" + t.substr(9, 3) + "_" + std::to_string(++sequence_);
+
+    std::error_code ec;
+    std::filesystem::create_directories(config_.directory, ec);
+    const std::string base = (std::filesystem::path(config_.directory) / name).string();
+
+    io::ComtradeWriter writer;
+    if (ec || !writer.write(base, cfg, analog, digital)) {
+        errorCount_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(statusMutex_);
+        lastError_ = ec ? "Failed to create " + config_.directory + ": " + ec.message() : writer.getLastError();
+        LOG_ERROR("RECORDER", "{}", lastError_.c_str());
+        return;
+    }
+
+    recordCount_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(statusMutex_);
+    recentFiles_.push_back(base + ".cfg");
+    if (recentFiles_.size() > RECENT_FILES) {
+        recentFiles_.erase(recentFiles_.begin());
+    }
+    LOG_INFO("RECORDER", "Wrote {} ({} samples)", recentFiles_.back().c_str(), digital.size());
+}
+
+RecorderStatus DisturbanceRecorder::status() const {
+    RecorderStatus status;
+    status.triggers = triggerCount_.load(std::memory_order_relaxed);
+    status.records = recordCount_.load(std::memory_order_relaxed);
+    status.dropped = droppedCount_.load(std::memory_order_relaxed);
+    status.writeErrors = errorCount_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(statusMutex_);
+    status.recentFiles = recentFiles_;
+    status.lastError = lastError_;
+    return status;
+}
+
+} // namespace analyzer
+} // namespace vts
@@ -0,0 +1,232 @@
+#include "frequency_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vts {
+namespace analyzer {
+
+static constexpr double PI = 3.14159265358979323846;
+static constexpr double LOCK_TOLERANCE_HZ = 0.01;
+// A cycle whose fundamental moved more than this (relative) straddles a
+// step change; its phase is not a frequency measurement
+static constexpr double MAX_AMPLITUDE_STEP = 0.2;
+
+// Interpolation nodes sit at -(taps/2 - 1)..taps/2 around the interval
+// [0, 1) being filled
+static constexpr int LAGRANGE_TAPS = 6;
+static constexpr int MAX_TAPS = 64;
+static constexpr int KERNEL_PHASES = 256;
+static constexpr double KAISER_BETA = 8.0;
+
+namespace {
+
+// Modified Bessel function of the first kind, order 0
+double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 40; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < 1e-17 * sum) {
+            break;
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+FrequencyTracker::FrequencyTracker(const FrequencyTrackerConfig& config)
+    : config_(config) {
+    if (!(config_.sampleRate > 0.0)) {
+        config_.sampleRate = 4800.0;
+    }
+    if (!(config_.minFrequency > 0.0) || config_.maxFrequency < config_.minFrequency) {
+        config_.minFrequency = 45.0;
+        config_.maxFrequency = 65.0;
+    }
+    config_.nominalFrequency = std::min(std::max(config_.nominalFrequency, config_.minFrequency),
+                                        config_.maxFrequency);
+    // Room for every harmonic below the grid's Nyquist
+    points_ = std::max(config_.pointsPerCycle, 2 * MaxHarmonic + 2);
+
+    taps_ = config_.interpolatorTaps;
+    if (taps_ != LAGRANGE_TAPS) {
+        taps_ = std::min(std::max(taps_ + (taps_ & 1), 8), MAX_TAPS);
+        const int half = taps_ / 2;
+        kernel_.resize(static_cast<size_t>((KERNEL_PHASES + 1) * taps_));
+        for (int p = 0; p <= KERNEL_PHASES; ++p) {
+            const double mu = static_cast<double>(p) / KERNEL_PHASES;
+            double* weights = &kernel_[static_cast<size_t>(p * taps_)];
+            double sum = 0.0;
+            for (int i = 0; i < taps_; ++i) {
+                const double x = mu - (i - (half - 1));
+                const double r = x / half;
+                const double sinc = std::fabs(x) < 1e-12 ? 1.0 : std::sin(PI * x) / (PI * x);
+                weights[i] = r * r < 1.0 ? sinc * besselI0(KAISER_BETA * std::sqrt(1.0 - r * r)) : 0.0;
+                sum += weights[i];
+            }
+            for (int i = 0; i < taps_; ++i) {
+                weights[i] /= sum;          // Exact DC gain at every phase
+            }
+        }
+    }
+    size_t history = 8;
+    while (history < static_cast<size_t>(taps_)) {
+        history *= 2;
+    }
+    history_.resize(history);
+    historyMask_ = history - 1;
+
+    twiddle_.resize(static_cast<size_t>(points_));
+    grid_.resize(static_cast<size_t>(points_));
+    lastGrid_.resize(static_cast<size_t>(points_));
+    for (int m = 0; m < points_; ++m) {
+        twiddle_[static_cast<size_t>(m)] = std::polar(1.0, -2.0 * PI * m / points_);
+    }
+    reset();
+}
+
+void FrequencyTracker::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0);
+    inputCount_ = 0;
+    position_ = 0.0;
+    frequency_ = config_.nominalFrequency;
+    measured_ = frequency_;
+    previousFrequency_ = frequency_;
+    step_ = config_.sampleRate / (frequency_ * points_);
+    gridIndex_ = 0;
+    accumulator_.fill({0.0, 0.0});
+    spectrum_.fill({0.0, 0.0});
+    sumSquares_ = 0.0;
+    rms_ = 0.0;
+    std::fill(lastGrid_.begin(), lastGrid_.end(), 0.0);
+    pendingStart_ = 0.0;
+    cycleStart_ = 0.0;
+    previous_ = {0.0, 0.0};
+    havePrevious_ = false;
+    locked_ = false;
+    cycles_ = 0;
+}
+
+void FrequencyTracker::setFrequency(double frequency) {
+    frequency_ = std::min(std::max(frequency, config_.minFrequency), config_.maxFrequency);
+    step_ = config_.sampleRate / (frequency_ * points_);
+}
+
+bool FrequencyTracker::push(double sample) {
+    history_[inputCount_ & historyMask_] = sample;
+    inputCount_++;
+    const uint64_t taps = static_cast<uint64_t>(taps_);
+    if (inputCount_ < taps) {
+        return false;
+    }
+    if (inputCount_ > taps) {
+        position_ -= 1.0;
+    }
+
+    // Grid points falling between the two middle samples of the history
+    const uint64_t before = cycles_;
+    while (position_ < 1.0) {
+        if (gridIndex_ == 0) {
+            // Absolute index of the interpolation point (node 0 is oldest + taps / 2 - 1)
+            pendingStart_ = static_cast<double>(inputCount_ - taps + taps / 2 - 1) + position_;
+        }
+        emitPoint(interpolate(position_));
+        position_ += step_;
+    }
+    return cycles_ != before;
+}
+
+double FrequencyTracker::interpolate(double mu) const {
+    const uint64_t oldest = inputCount_ - static_cast<uint64_t>(taps_);
+    double result = 0.0;
+    if (kernel_.empty()) {
+        // Lagrange weights for nodes x_i = i - 2
+        for (int i = 0; i < LAGRANGE_TAPS; ++i) {
+            double weight = 1.0;
+            for (int j = 0; j < LAGRANGE_TAPS; ++j) {
+                if (j != i) {
+                    weight *= (mu - (j - 2)) / static_cast<double>(i - j);
+                }
+            }
+            result += weight * history_[(oldest + static_cast<uint64_t>(i)) & historyMask_];
+        }
+        return result;
+    }
+
+    // Tabulated sinc, linear between neighbouring phases
+    const double phase = mu * KERNEL_PHASES;
+    const int p = std::min(static_cast<int>(phase), KERNEL_PHASES - 1);
+    const double frac = phase - p;
+    const double* lower = &kernel_[static_cast<size_t>(p * taps_)];
+    const double* upper = lower + taps_;
+    for (int i = 0; i < taps_; ++i) {
+        const double weight = lower[i] + frac * (upper[i] - lower[i]);
+        result += weight * history_[(oldest + static_cast<uint64_t>(i)) & historyMask_];
+    }
+    return result;
+}
+
+std::complex<double> FrequencyTracker::harmonicAt(int h, double sampleIndex) const {
+    const double turns = measured_ * (sampleIndex - cycleStart_) / config_.sampleRate;
+    return spectrum_[static_cast<size_t>(h)] * std::polar(1.0, 2.0 * PI * h * turns);
+}
+
+void FrequencyTracker::emitPoint(double y) {
+    int index = 0;
+    for (int k = 0; k <= MaxHarmonic; ++k) {
+        accumulator_[static_cast<size_t>(k)] += y * twiddle_[static_cast<size_t>(index)];
+        index += gridIndex_;
+        if (index >= points_) {
+            index -= points_;
+        }
+    }
+    sumSquares_ += y * y;
+    grid_[static_cast<size_t>(gridIndex_)] = y;
+
+    if (++gridIndex_ == points_) {
+        endCycle();
+    }
+}
+
+void FrequencyTracker::endCycle() {
+    const double n = static_cast<double>(points_);
+    spectrum_[0] = accumulator_[0] / n;
+    for (int k = 1; k <= MaxHarmonic; ++k) {
+        spectrum_[static_cast<size_t>(k)] = 2.0 * accumulator_[static_cast<size_t>(k)] / n;
+    }
+    rms_ = std::sqrt(sumSquares_ / n);
+    grid_.swap(lastGrid_);
+    cycleStart_ = pendingStart_;
+
+    // The fundamental's phase at the start of this cycle versus the start of
+    // the previous one, which lasted 1 / previousFrequency_
+    const std::complex<double> fundamental = spectrum_[1];
+    const double amplitude = std::abs(fundamental);
+    const bool enough = amplitude > config_.minAmplitude;
+    const bool steady = havePrevious_ &&
+        std::fabs(amplitude - std::abs(previous_)) <= MAX_AMPLITUDE_STEP * std::abs(previous_);
+    if (enough && steady) {
+        const double dphi = std::arg(fundamental * std::conj(previous_));
+        measured_ = previousFrequency_ * (1.0 + dphi / (2.0 * PI));
+        locked_ = std::fabs(measured_ - frequency_) < LOCK_TOLERANCE_HZ;
+        previousFrequency_ = frequency_;
+        frequency_ += config_.loopGain * (measured_ - frequency_);
+        frequency_ = std::min(std::max(frequency_, config_.minFrequency), config_.maxFrequency);
+        step_ = config_.sampleRate / (frequency_ * n);
+    } else {
+        locked_ = false;
+        previousFrequency_ = frequency_;
+    }
+    previous_ = fundamental;
+    havePrevious_ = enough;
+
+    accumulator_.fill({0.0, 0.0});
+    sumSquares_ = 0.0;
+    gridIndex_ = 0;
+    cycles_++;
+}
+
+} // namespace analyzer
+} // namespace vts
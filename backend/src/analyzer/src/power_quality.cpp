@@ -0,0 +1,334 @@
+#include "power_quality.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vts {
+namespace analyzer {
+
+static constexpr double PI = 3.14159265358979323846;
+static constexpr uint32_t SHORT_WINDOWS = 15;          // 150/180 cycles
+static constexpr double TEN_MINUTES = 600.0;
+static constexpr double TWO_HOURS = 7200.0;
+// Fraction of the input rate a 32-tap windowed-sinc tracker keeps flat
+static constexpr double USABLE_BANDWIDTH = 0.44;
+
+namespace {
+
+double slot(double time, double length) {
+    return std::floor(time / length);
+}
+
+double thd(const std::vector<double>& harmonics) {
+    if (harmonics.size() < 2 || !(harmonics[1] > 0.0)) {
+        return 0.0;
+    }
+    double squares = 0.0;
+    for (size_t h = 2; h < harmonics.size(); ++h) {
+        squares += harmonics[h] * harmonics[h];
+    }
+    return 100.0 * std::sqrt(squares) / harmonics[1];
+}
+
+} // namespace
+
+PowerQualityChannel::PowerQualityChannel(const std::string& channel, const PowerQualityConfig& config,
+                                         double sampleRate, int pointsPerCycle)
+    : channel_(channel),
+      config_(config),
+      sampleRate_(sampleRate),
+      points_(pointsPerCycle),
+      cycleCount_(0),
+      windowStart_(0.0),
+      frequencySum_(0.0),
+      windowFlagged_(false),
+      previousHalfSquares_(0.0),
+      haveHalf_(false),
+      inDip_(false),
+      inSwell_(false),
+      eventStart_(0.0),
+      eventExtreme_(0.0) {
+    if (points_ < 32 || (points_ & (points_ - 1)) != 0) {
+        throw std::invalid_argument("PQ needs a power-of-two grid of at least 32 points per cycle");
+    }
+    if (!(sampleRate_ > 0.0) || !(config_.nominalFrequency > 0.0)) {
+        throw std::invalid_argument("PQ needs a positive sample rate and nominal frequency");
+    }
+    cycles_ = config_.nominalFrequency < 55.0 ? 10 : 12;
+
+    // Highest order whose upper interharmonic group stays in the flat band
+    const int bandOrder = static_cast<int>(std::floor(USABLE_BANDWIDTH * sampleRate_ / config_.nominalFrequency - 0.5));
+    maxOrder_ = std::max(1, std::min({config_.maxOrder, bandOrder, points_ / 2 - 1}));
+
+    const size_t m = static_cast<size_t>(points_);
+    const size_t n = static_cast<size_t>(cycles_);
+    window_.assign(n * m, 0.0);
+
+    fftTwiddle_.resize(m / 2);
+    for (size_t k = 0; k < m / 2; ++k) {
+        fftTwiddle_[k] = std::polar(1.0, -2.0 * PI * static_cast<double>(k) / static_cast<double>(m));
+    }
+    bitReverse_.resize(m);
+    unsigned bits = 0;
+    while ((1u << bits) < m) {
+        ++bits;
+    }
+    for (uint32_t i = 0; i < m; ++i) {
+        uint32_t r = 0;
+        for (unsigned b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bitReverse_[i] = r;
+    }
+    columns_.assign(n, std::vector<std::complex<double>>(m));
+    combineTwiddle_.resize(n * m);
+    for (size_t k = 0; k < n * m; ++k) {
+        combineTwiddle_[k] = std::polar(1.0, -2.0 * PI * static_cast<double>(k) / static_cast<double>(n * m));
+    }
+
+    const size_t orders = static_cast<size_t>(maxOrder_) + 1;
+    windowRecord_.interval = PqInterval::Window;
+    windowRecord_.channel = channel_;
+    windowRecord_.values = 1;
+    windowRecord_.harmonics.assign(orders, 0.0);
+    windowRecord_.interharmonics.assign(orders, 0.0);
+    short_.reset(orders);
+    tenMinute_.reset(orders);
+    twoHour_.reset(orders);
+}
+
+void PowerQualityChannel::onCycle(const FrequencyTracker& tracker, std::vector<PqRecord>& records,
+                                  std::vector<PqEvent>& events) {
+    const std::vector<double>& grid = tracker.cycleGrid();
+    const size_t m = static_cast<size_t>(points_);
+    if (grid.size() != m) {
+        return;
+    }
+    const double start = config_.startTime + tracker.cycleStart() / sampleRate_;
+    const double duration = 1.0 / tracker.cycleFrequency();
+
+    // Urms(1/2): one cycle of RMS, refreshed every half cycle
+    double firstHalf = 0.0, secondHalf = 0.0;
+    for (size_t i = 0; i < m / 2; ++i) {
+        firstHalf += grid[i] * grid[i];
+        secondHalf += grid[i + m / 2] * grid[i + m / 2];
+    }
+    if (haveHalf_) {
+        halfCycle(std::sqrt((previousHalfSquares_ + firstHalf) / static_cast<double>(m)),
+                  start + duration / 2.0, events);
+    }
+    halfCycle(std::sqrt((firstHalf + secondHalf) / static_cast<double>(m)), start + duration, events);
+    previousHalfSquares_ = secondHalf;
+    haveHalf_ = true;
+
+    if (cycleCount_ == 0) {
+        windowStart_ = start;
+        frequencySum_ = 0.0;
+    }
+    std::copy(grid.begin(), grid.end(), window_.begin() + static_cast<long>(cycleCount_ * points_));
+    frequencySum_ += tracker.measuredFrequency();
+    if (++cycleCount_ == cycles_) {
+        endWindow(start + duration, records);
+        cycleCount_ = 0;
+        windowFlagged_ = inDip_ || inSwell_;
+    }
+}
+
+void PowerQualityChannel::halfCycle(double rms, double time, std::vector<PqEvent>& events) {
+    if (!(config_.declaredValue > 0.0)) {
+        return;
+    }
+    const double u = config_.declaredValue;
+    auto finish = [&](PqEvent::Type type) {
+        PqEvent event;
+        event.type = type;
+        event.channel = channel_;
+        event.startTime = eventStart_;
+        event.duration = time - eventStart_;
+        event.extreme = eventExtreme_;
+        events.push_back(event);
+        windowFlagged_ = true;
+    };
+
+    if (inDip_) {
+        eventExtreme_ = std::min(eventExtreme_, rms);
+        if (rms >= (config_.dipThreshold + config_.hysteresis) * u) {
+            inDip_ = false;
+            finish(PqEvent::Type::Dip);
+        }
+    } else if (inSwell_) {
+        eventExtreme_ = std::max(eventExtreme_, rms);
+        if (rms <= (config_.swellThreshold - config_.hysteresis) * u) {
+            inSwell_ = false;
+            finish(PqEvent::Type::Swell);
+        }
+    } else if (rms < config_.dipThreshold * u) {
+        inDip_ = true;
+        eventStart_ = time;
+        eventExtreme_ = rms;
+    } else if (rms > config_.swellThreshold * u) {
+        inSwell_ = true;
+        eventStart_ = time;
+        eventExtreme_ = rms;
+    }
+    if (inDip_ || inSwell_) {
+        windowFlagged_ = true;
+    }
+}
+
+void PowerQualityChannel::fft(std::vector<std::complex<double>>& data) const {
+    const size_t m = data.size();
+    for (size_t i = 0; i < m; ++i) {
+        if (i < bitReverse_[i]) {
+            std::swap(data[i], data[bitReverse_[i]]);
+        }
+    }
+    for (size_t half = 1, stride = m / 2; half < m; half *= 2, stride /= 2) {
+        for (size_t begin = 0; begin < m; begin += 2 * half) {
+            for (size_t k = 0; k < half; ++k) {
+                const std::complex<double> t = fftTwiddle_[k * stride] * data[begin + k + half];
+                data[begin + k + half] = data[begin + k] - t;
+                data[begin + k] += t;
+            }
+        }
+    }
+}
+
+void PowerQualityChannel::endWindow(double endTime, std::vector<PqRecord>& records) {
+    const size_t m = static_cast<size_t>(points_);
+    const size_t n = static_cast<size_t>(cycles_);
+    const size_t total = n * m;
+
+    // Decimation in time: column c holds window[c], window[c + N], ...
+    double squares = 0.0;
+    for (size_t c = 0; c < n; ++c) {
+        std::vector<std::complex<double>>& column = columns_[c];
+        for (size_t i = 0; i < m; ++i) {
+            const double y = window_[i * n + c];
+            column[i] = {y, 0.0};
+            squares += y * y;
+        }
+        fft(column);
+    }
+
+    // Bin k (5 Hz apart) = sum_c W^(c k) * column_c[k mod M], as RMS
+    const size_t lastBin = n * static_cast<size_t>(maxOrder_ + 1) - 2;
+    auto binSquared = [&](size_t k) {
+        std::complex<double> sum(0.0, 0.0);
+        for (size_t c = 0; c < n; ++c) {
+            sum += combineTwiddle_[(c * k) % total] * columns_[c][k % m];
+        }
+        const double scale = (k == 0 ? 1.0 : std::sqrt(2.0)) / static_cast<double>(total);
+        return std::norm(sum) * scale * scale;
+    };
+
+    PqRecord& record = windowRecord_;
+    std::fill(record.harmonics.begin(), record.harmonics.end(), 0.0);
+    std::fill(record.interharmonics.begin(), record.interharmonics.end(), 0.0);
+    for (size_t k = 0; k <= lastBin; ++k) {
+        const double c2 = binSquared(k);
+        const size_t order = (k + 1) / n;       // Nearest harmonic below, counting k = N h - 1 as h
+        const size_t offset = k % n;
+        if (k == 0) {
+            record.harmonics[0] = c2;
+        } else if (k == 1) {
+            continue;                           // Next to DC, in no group
+        } else if (offset <= 1 || offset == n - 1) {
+            record.harmonics[order] += c2;      // Harmonic subgroup: N h - 1, N h, N h + 1
+        } else {
+            record.interharmonics[k / n] += c2; // Centred subgroup: N h + 2 .. N h + N - 2
+        }
+    }
+    for (size_t h = 0; h < record.harmonics.size(); ++h) {
+        record.harmonics[h] = std::sqrt(record.harmonics[h]);
+        record.interharmonics[h] = std::sqrt(record.interharmonics[h]);
+    }
+    record.startTime = windowStart_;
+    record.endTime = endTime;
+    record.flagged = windowFlagged_;
+    record.rms = std::sqrt(squares / static_cast<double>(total));
+    record.frequency = frequencySum_ / static_cast<double>(n);
+    record.thd = thd(record.harmonics);
+    if (config_.emitWindows) {
+        records.push_back(record);
+    }
+
+    // 10 min tick: close the partial 150/180-cycle block and the 10 min block
+    if (tenMinute_.values > 0 && slot(record.startTime, TEN_MINUTES) != slot(tenMinute_.start, TEN_MINUTES)) {
+        if (short_.values > 0) {
+            records.push_back(short_.result(PqInterval::Short, channel_));
+            short_.reset(record.harmonics.size());
+        }
+        closeTenMinute(records);
+    }
+
+    short_.add(record);
+    tenMinute_.add(record);
+    if (short_.values == SHORT_WINDOWS) {
+        records.push_back(short_.result(PqInterval::Short, channel_));
+        short_.reset(record.harmonics.size());
+    }
+}
+
+void PowerQualityChannel::closeTenMinute(std::vector<PqRecord>& records) {
+    const PqRecord tenMinute = tenMinute_.result(PqInterval::TenMinute, channel_);
+    records.push_back(tenMinute);
+    tenMinute_.reset(tenMinute.harmonics.size());
+
+    if (twoHour_.values > 0 && slot(tenMinute.startTime, TWO_HOURS) != slot(twoHour_.start, TWO_HOURS)) {
+        records.push_back(twoHour_.result(PqInterval::TwoHour, channel_));
+        twoHour_.reset(tenMinute.harmonics.size());
+    }
+    twoHour_.add(tenMinute);
+}
+
+void PowerQualityChannel::Aggregate::reset(size_t orders) {
+    start = 0.0;
+    end = 0.0;
+    values = 0;
+    flagged = false;
+    rmsSquares = 0.0;
+    frequencySum = 0.0;
+    harmonicSquares.assign(orders, 0.0);
+    interharmonicSquares.assign(orders, 0.0);
+}
+
+void PowerQualityChannel::Aggregate::add(const PqRecord& value) {
+    if (values == 0) {
+        start = value.startTime;
+    }
+    end = value.endTime;
+    values++;
+    flagged = flagged || value.flagged;
+    rmsSquares += value.rms * value.rms;
+    frequencySum += value.frequency;
+    for (size_t h = 0; h < harmonicSquares.size(); ++h) {
+        harmonicSquares[h] += value.harmonics[h] * value.harmonics[h];
+        interharmonicSquares[h] += value.interharmonics[h] * value.interharmonics[h];
+    }
+}
+
+PqRecord PowerQualityChannel::Aggregate::result(PqInterval interval, const std::string& channel) const {
+    PqRecord record;
+    record.interval = interval;
+    record.channel = channel;
+    record.startTime = start;
+    record.endTime = end;
+    record.values = values;
+    record.flagged = flagged;
+    const double count = static_cast<double>(std::max<uint32_t>(values, 1));
+    record.rms = std::sqrt(rmsSquares / count);
+    record.frequency = frequencySum / count;
+    record.harmonics.resize(harmonicSquares.size());
+    record.interharmonics.resize(interharmonicSquares.size());
+    for (size_t h = 0; h < harmonicSquares.size(); ++h) {
+        record.harmonics[h] = std::sqrt(harmonicSquares[h] / count);
+        record.interharmonics[h] = std::sqrt(interharmonicSquares[h] / count);
+    }
+    record.thd = thd(record.harmonics);
+    return record;
+}
+
+} // namespace analyzer
+} // namespace vts
@@ -7,12 +7,22 @@
 #include <string>
 #include <atomic>
 #include <thread>
+#include <mutex>
+#include <functional>
+
+#include "rt_selftest.hpp"
 
 using json = nlohmann::json;
 
 // Forward declarations
 class SVPublisherManager;
+class StreamPhasorWriter;
 class GooseSubscriber;
+class SnifferClass;
+class PcapReplay;
+class LoadGenerator;
+class RelayEmulator;
+class Clock;
 
 namespace vts {
 namespace testers {
@@ -21,6 +31,10 @@ namespace testers {
     class DistanceTester;
     class OvercurrentTester;
     class DifferentialTester;
+    class TestJobExecutor;
+    class TestJobContext;
+    class ResultStore;
+    struct ResultQuery;
 }
 namespace analyzer {
     class AnalyzerEngine;
@@ -46,6 +60,10 @@ public:
     void setGooseSubscriber(std::shared_ptr<GooseSubscriber> subscriber);
     void setAnalyzerEngine(std::shared_ptr<vts::analyzer::AnalyzerEngine> analyzer);
     void setWSServer(class WSServer* wsServer);
+    void setSniffer(std::shared_ptr<SnifferClass> sniffer);
+    void setPcapReplay(std::shared_ptr<PcapReplay> replay);
+    void setLoadGenerator(std::shared_ptr<LoadGenerator> generator);
+    void setRelayEmulator(std::shared_ptr<RelayEmulator> emulator);
     
     // Set tester component references
     void setImpedanceCalculator(std::shared_ptr<vts::testers::ImpedanceCalculator> calculator);
@@ -53,6 +71,14 @@ public:
     void setDistanceTester(std::shared_ptr<vts::testers::DistanceTester> tester);
     void setOvercurrentTester(std::shared_ptr<vts::testers::OvercurrentTester> tester);
     void setDifferentialTester(std::shared_ptr<vts::testers::DifferentialTester> tester);
+    void setTestJobExecutor(std::shared_ptr<vts::testers::TestJobExecutor> executor);
+    void setResultStore(std::shared_ptr<vts::testers::ResultStore> store);
+
+    // Clock the testers run on (virtual time); system clock when unset
+    void setClock(std::shared_ptr<Clock> clock);
+
+    // Cores measured by POST /api/v1/rt/selftest
+    void setRtSelfTestConfig(const RtSelfTestConfig& config);
 
 private:
     // Setup route handlers
@@ -60,6 +86,10 @@ private:
     
     // Health endpoint
     void handleHealth(const httplib::Request& req, httplib::Response& res);
+    void handleTimeStatus(const httplib::Request& req, httplib::Response& res);
+    void handleMetrics(const httplib::Request& req, httplib::Response& res);
+    void handleRtSelfTestGet(const httplib::Request& req, httplib::Response& res);
+    void handleRtSelfTestRun(const httplib::Request& req, httplib::Response& res);
     
     // Stream management endpoints (Module 13)
     void handleGetStreams(const httplib::Request& req, httplib::Response& res);
@@ -68,10 +98,16 @@ private:
     void handleDeleteStream(const httplib::Request& req, httplib::Response& res);
     void handleStartStream(const httplib::Request& req, httplib::Response& res);
     void handleStopStream(const httplib::Request& req, httplib::Response& res);
+    void handleSetImpairment(const httplib::Request& req, httplib::Response& res);
+    void handleGetImpairment(const httplib::Request& req, httplib::Response& res);
+    void handleGetImpairmentEvents(const httplib::Request& req, httplib::Response& res);
+    void handleAttachFaultTransient(const httplib::Request& req, httplib::Response& res);
+    void handleDetachFaultTransient(const httplib::Request& req, httplib::Response& res);
     
     // Phasor endpoints (Module 2)
     void handleUpdatePhasors(const httplib::Request& req, httplib::Response& res);
     void handleUpdateHarmonics(const httplib::Request& req, httplib::Response& res);
+    void handleBulkUpdate(const httplib::Request& req, httplib::Response& res);
     
     // COMTRADE playback endpoints (Module 1)
     void handleComtradePlayback(const httplib::Request& req, httplib::Response& res);
@@ -92,6 +128,10 @@ private:
     void handleAnalyzerSelect(const httplib::Request& req, httplib::Response& res);
     void handleAnalyzerStop(const httplib::Request& req, httplib::Response& res);
     void handleAnalyzerStatus(const httplib::Request& req, httplib::Response& res);
+    void handleGetAnalyzerGroups(const httplib::Request& req, httplib::Response& res);
+    void handleSetAnalyzerGroups(const httplib::Request& req, httplib::Response& res);
+    void handleGetAnalyzerRecorder(const httplib::Request& req, httplib::Response& res);
+    void handleSetAnalyzerRecorder(const httplib::Request& req, httplib::Response& res);
     
     // Impedance injection endpoints (Module 6)
     void handleImpedanceApply(const httplib::Request& req, httplib::Response& res);
@@ -108,9 +148,60 @@ private:
     // Differential test endpoints (Module 11)
     void handleDifferentialRun(const httplib::Request& req, httplib::Response& res);
     
+    // Test job endpoints: the tests above queued on the job executor
+    void handleJobSubmit(const httplib::Request& req, httplib::Response& res);
+    void handleJobList(const httplib::Request& req, httplib::Response& res);
+    void handleJobGet(const httplib::Request& req, httplib::Response& res);
+    void handleJobCancel(const httplib::Request& req, httplib::Response& res);
+    
+    // Test result store endpoints: stored results and trip-time aggregates
+    void handleResultsQuery(const httplib::Request& req, httplib::Response& res);
+    void handleResultsAggregate(const httplib::Request& req, httplib::Response& res);
+    void handleResultsStatus(const httplib::Request& req, httplib::Response& res);
+    
+    // relay, kind, passed, from, to (Unix s) and limit query parameters;
+    // throws std::invalid_argument on a bad value
+    void parseResultQuery(const httplib::Request& req, vts::testers::ResultQuery& query);
+    
+    // Test job builders: parse the request body (throw on bad input) and
+    // return the job, or nullptr if the tester is not set; cancel is set to
+    // the hook that stops the running test
+    using TestJob = std::function<json(vts::testers::TestJobContext&)>;
+    TestJob makeTestJob(const std::string& kind, const json& body, std::function<void()>& cancel);
+    TestJob makeRampJob(const json& body, std::function<void()>& cancel);
+    TestJob makeDistanceJob(const json& body, std::function<void()>& cancel);
+    TestJob makeOvercurrentJob(const json& body, std::function<void()>& cancel);
+    TestJob makeDifferentialJob(const json& body, std::function<void()>& cancel);
+    std::shared_ptr<StreamPhasorWriter> bindTestStream(const std::string& streamId);
+    
+    // Queue a test; wait for /run (its original synchronous response),
+    // otherwise answer 202 with the job ID
+    void runTestJob(const std::string& kind, const httplib::Request& req, httplib::Response& res, bool wait);
+    
+    // Sniffer endpoints
+    void handleSnifferRedundancy(const httplib::Request& req, httplib::Response& res);
+    
+    // pcap replay endpoints
+    void handlePcapReplayStart(const httplib::Request& req, httplib::Response& res);
+    void handlePcapReplayStop(const httplib::Request& req, httplib::Response& res);
+    void handlePcapReplayStatus(const httplib::Request& req, httplib::Response& res);
+    
+    // Load generator endpoints
+    void handleLoadGenStart(const httplib::Request& req, httplib::Response& res);
+    void handleLoadGenStop(const httplib::Request& req, httplib::Response& res);
+    void handleLoadGenStatus(const httplib::Request& req, httplib::Response& res);
+    
+    // Relay emulator endpoints
+    void handleRelaysStart(const httplib::Request& req, httplib::Response& res);
+    void handleRelaysStop(const httplib::Request& req, httplib::Response& res);
+    void handleRelaysStatus(const httplib::Request& req, httplib::Response& res);
+    
     // System/Configuration endpoints
     void handleGetNetworkInterfaces(const httplib::Request& req, httplib::Response& res);
     
+    // Start the sniffer thread if needed (caller holds snifferMutex_)
+    bool ensureSnifferRunning(std::string& error);
+    
     // Utility functions
     void sendJsonResponse(httplib::Response& res, int status, const json& data);
     void sendErrorResponse(httplib::Response& res, int status, const std::string& message);
@@ -127,6 +218,14 @@ private:
     std::shared_ptr<GooseSubscriber> gooseSubscriber_;
     std::shared_ptr<vts::analyzer::AnalyzerEngine> analyzerEngine_;
     class WSServer* wsServer_;
+    std::shared_ptr<SnifferClass> sniffer_;
+    std::mutex snifferMutex_;
+    std::shared_ptr<PcapReplay> pcapReplay_;
+    std::mutex pcapReplayMutex_;
+    std::shared_ptr<LoadGenerator> loadGenerator_;
+    std::mutex loadGenMutex_;
+    std::shared_ptr<RelayEmulator> relayEmulator_;
+    std::mutex relayMutex_;
     
     // Tester component references
     std::shared_ptr<vts::testers::ImpedanceCalculator> impedanceCalculator_;
@@ -134,6 +233,12 @@ private:
     std::shared_ptr<vts::testers::DistanceTester> distanceTester_;
     std::shared_ptr<vts::testers::OvercurrentTester> overcurrentTester_;
     std::shared_ptr<vts::testers::DifferentialTester> differentialTester_;
+    std::shared_ptr<vts::testers::TestJobExecutor> testJobs_;
+    std::shared_ptr<vts::testers::ResultStore> results_;
+    std::shared_ptr<Clock> clock_;
+    RtSelfTestConfig rtSelfTest_;
+    std::mutex rtSelfTestMutex_;            // Guards rtSelfTestJob_
+    uint64_t rtSelfTestJob_ = 0;            // Latest self-test job, one queued or running at a time
 };
 
 #endif // HTTP_SERVER_HPP
@@ -8,7 +8,9 @@
 #include <map>
 #include <thread>
 #include <atomic>
+#include <memory>
 #include <nlohmann/json.hpp>
+#include "phasor_control.hpp"
 
 using json = nlohmann::json;
 using websocketpp::connection_hdl;
@@ -16,12 +18,17 @@ using websocketpp::connection_hdl;
 // WebSocket server type
 using server = websocketpp::server<websocketpp::config::asio>;
 
+class SVPublisherManager;
+
 // Topic subscription types
 enum class Topic {
     ANALYZER_PHASORS,      // Live phasor updates from analyzer
     ANALYZER_WAVEFORMS,    // Live waveform data
     ANALYZER_HARMONICS,    // Harmonics analysis results
+    ANALYZER_GROUPS,       // Sequence components, power and impedance per channel group
+    ANALYZER_PQ,           // Power-quality aggregates and dip/swell events
     SEQUENCE_PROGRESS,     // Test sequence state updates
+    TEST_JOBS,             // Relay test job state and progress
     GOOSE_EVENTS,          // GOOSE message events
     STREAM_STATUS          // SV stream status updates
 };
@@ -46,6 +53,9 @@ public:
     void broadcast(Topic topic, const json& data);
     void broadcastToAll(const json& data);
 
+    // Control channel target (phasor/frequency updates from clients)
+    void setPublisherManager(std::shared_ptr<SVPublisherManager> manager) { svManager_ = std::move(manager); }
+
     // Connection stats
     size_t getConnectionCount() const;
     size_t getSubscriberCount(Topic topic) const;
@@ -60,6 +70,7 @@ private:
     void handleSubscribe(connection_hdl hdl, const json& payload);
     void handleUnsubscribe(connection_hdl hdl, const json& payload);
     void handlePing(connection_hdl hdl);
+    void handleControl(connection_hdl hdl, bool decoded, const std::string& error, uint64_t receivedNs);
 
     // Utility
     Topic stringToTopic(const std::string& topicStr) const;
@@ -73,6 +84,12 @@ private:
     // Connection management
     std::map<connection_hdl, Connection, std::owner_less<connection_hdl>> connections_;
     mutable std::mutex mutex_;
+
+    // Control channel; the batch is scratch for the server thread only
+    std::shared_ptr<SVPublisherManager> svManager_;
+    ControlBatch controlBatch_;
+    std::vector<std::string> unknownStreams_;
+    std::vector<std::string> controlErrors_;
 };
 
 #endif // WS_SERVER_HPP
@@ -2,13 +2,25 @@
 #include "sv_publisher_manager.hpp"
 #include "sequence_engine.hpp"
 #include "analyzer_engine.hpp"
+#include "sniffer.hpp"
+#include "trip_rule_json.hpp"
+#include "Ethernet.hpp"
+#include "pcap_replay.hpp"
+#include "load_generator.hpp"
+#include "relay_emulator.hpp"
 #include "ws_server.hpp"
 #include "impedance_calculator.hpp"
 #include "ramping_tester.hpp"
 #include "distance_tester.hpp"
+#include "fault_transient.hpp"
 #include "overcurrent_tester.hpp"
 #include "differential_tester.hpp"
+#include "test_job_executor.hpp"
+#include "result_store.hpp"
 #include "global_flags.hpp"
+#include "time_source.hpp"
+#include "metrics.hpp"
+#include "thread_health.hpp"
 #include "compat.hpp"
 #ifdef VTS_PLATFORM_MAC
 #include "bpf_macos.hpp"
@@ -17,6 +29,9 @@
 #include <fstream>
 #include <sstream>
 #include <ctime>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
 
 // Using declarations for tester types to avoid namespace clutter
 using vts::testers::RampVariable;
@@ -36,6 +51,12 @@ using vts::testers::OCCurve;
 using vts::testers::DifferentialPoint;
 using vts::testers::DifferentialResult;
 using vts::testers::DifferentialTestConfig;
+using vts::testers::TestJobContext;
+using vts::testers::TestJobInfo;
+using vts::testers::ResultStore;
+using vts::testers::ResultQuery;
+using vts::testers::ResultRecord;
+using vts::testers::ResultAggregate;
 
 HTTPServer::HTTPServer(int port)
     : port_(port), running_(false), wsServer_(nullptr) {
@@ -68,6 +89,22 @@ void HTTPServer::setupRoutes() {
         handleHealth(req, res);
     });
     
+    server_->Get("/api/v1/time", [this](const httplib::Request& req, httplib::Response& res) {
+        handleTimeStatus(req, res);
+    });
+    
+    server_->Get("/api/v1/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+        handleMetrics(req, res);
+    });
+    
+    server_->Get("/api/v1/rt/selftest", [this](const httplib::Request& req, httplib::Response& res) {
+        handleRtSelfTestGet(req, res);
+    });
+    
+    server_->Post("/api/v1/rt/selftest", [this](const httplib::Request& req, httplib::Response& res) {
+        handleRtSelfTestRun(req, res);
+    });
+    
     // Stream management endpoints (Module 13)
     server_->Get("/api/v1/streams", [this](const httplib::Request& req, httplib::Response& res) {
         handleGetStreams(req, res);
@@ -93,7 +130,32 @@ void HTTPServer::setupRoutes() {
         handleStopStream(req, res);
     });
     
+    server_->Put("/api/v1/streams/:id/impairment", [this](const httplib::Request& req, httplib::Response& res) {
+        handleSetImpairment(req, res);
+    });
+    
+    server_->Get("/api/v1/streams/:id/impairment", [this](const httplib::Request& req, httplib::Response& res) {
+        handleGetImpairment(req, res);
+    });
+    
+    server_->Get("/api/v1/streams/:id/impairment/events", [this](const httplib::Request& req, httplib::Response& res) {
+        handleGetImpairmentEvents(req, res);
+    });
+    
+    server_->Post("/api/v1/streams/:id/fault-transient", [this](const httplib::Request& req, httplib::Response& res) {
+        handleAttachFaultTransient(req, res);
+    });
+    
+    server_->Delete("/api/v1/streams/:id/fault-transient", [this](const httplib::Request& req, httplib::Response& res) {
+        handleDetachFaultTransient(req, res);
+    });
+    
     // Phasor endpoints (Module 2)
+    // Before /phasors/:streamId, which would take "bulk" as a stream id
+    server_->Post("/api/v1/phasors/bulk", [this](const httplib::Request& req, httplib::Response& res) {
+        handleBulkUpdate(req, res);
+    });
+    
     server_->Post("/api/v1/phasors/:streamId", [this](const httplib::Request& req, httplib::Response& res) {
         handleUpdatePhasors(req, res);
     });
@@ -154,6 +216,22 @@ void HTTPServer::setupRoutes() {
         handleAnalyzerStatus(req, res);
     });
     
+    server_->Get("/api/v1/analyzer/groups", [this](const httplib::Request& req, httplib::Response& res) {
+        handleGetAnalyzerGroups(req, res);
+    });
+    
+    server_->Put("/api/v1/analyzer/groups", [this](const httplib::Request& req, httplib::Response& res) {
+        handleSetAnalyzerGroups(req, res);
+    });
+    
+    server_->Get("/api/v1/analyzer/recorder", [this](const httplib::Request& req, httplib::Response& res) {
+        handleGetAnalyzerRecorder(req, res);
+    });
+    
+    server_->Put("/api/v1/analyzer/recorder", [this](const httplib::Request& req, httplib::Response& res) {
+        handleSetAnalyzerRecorder(req, res);
+    });
+    
     // Impedance injection endpoint (Module 6)
     server_->Post("/api/v1/impedance/apply", [this](const httplib::Request& req, httplib::Response& res) {
         handleImpedanceApply(req, res);
@@ -179,6 +257,81 @@ void HTTPServer::setupRoutes() {
         handleDifferentialRun(req, res);
     });
     
+    // Test jobs: the same tests queued on the job executor, results by ID
+    server_->Post(R"(/api/v1/jobs/(ramp|distance|overcurrent|differential))",
+                  [this](const httplib::Request& req, httplib::Response& res) {
+        handleJobSubmit(req, res);
+    });
+    
+    server_->Get("/api/v1/jobs", [this](const httplib::Request& req, httplib::Response& res) {
+        handleJobList(req, res);
+    });
+    
+    server_->Get(R"(/api/v1/jobs/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+        handleJobGet(req, res);
+    });
+    
+    server_->Delete(R"(/api/v1/jobs/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+        handleJobCancel(req, res);
+    });
+    
+    // Stored test results: records, trip-time aggregates, store status
+    server_->Get("/api/v1/results", [this](const httplib::Request& req, httplib::Response& res) {
+        handleResultsQuery(req, res);
+    });
+    
+    server_->Get("/api/v1/results/aggregate", [this](const httplib::Request& req, httplib::Response& res) {
+        handleResultsAggregate(req, res);
+    });
+    
+    server_->Get("/api/v1/results/status", [this](const httplib::Request& req, httplib::Response& res) {
+        handleResultsStatus(req, res);
+    });
+    
+    // Sniffer endpoints
+    server_->Get("/api/v1/sniffer/redundancy", [this](const httplib::Request& req, httplib::Response& res) {
+        handleSnifferRedundancy(req, res);
+    });
+    
+    // pcap replay endpoints
+    server_->Post("/api/v1/pcap/replay", [this](const httplib::Request& req, httplib::Response& res) {
+        handlePcapReplayStart(req, res);
+    });
+    
+    server_->Post("/api/v1/pcap/replay/stop", [this](const httplib::Request& req, httplib::Response& res) {
+        handlePcapReplayStop(req, res);
+    });
+    
+    server_->Get("/api/v1/pcap/replay/status", [this](const httplib::Request& req, httplib::Response& res) {
+        handlePcapReplayStatus(req, res);
+    });
+    
+    // Load generator endpoints
+    server_->Post("/api/v1/loadgen/start", [this](const httplib::Request& req, httplib::Response& res) {
+        handleLoadGenStart(req, res);
+    });
+    
+    server_->Post("/api/v1/loadgen/stop", [this](const httplib::Request& req, httplib::Response& res) {
+        handleLoadGenStop(req, res);
+    });
+    
+    server_->Get("/api/v1/loadgen/status", [this](const httplib::Request& req, httplib::Response& res) {
+        handleLoadGenStatus(req, res);
+    });
+    
+    // Relay emulator
+    server_->Post("/api/v1/relays/start", [this](const httplib::Request& req, httplib::Response& res) {
+        handleRelaysStart(req, res);
+    });
+    
+    server_->Post("/api/v1/relays/stop", [this](const httplib::Request& req, httplib::Response& res) {
+        handleRelaysStop(req, res);
+    });
+    
+    server_->Get("/api/v1/relays/status", [this](const httplib::Request& req, httplib::Response& res) {
+        handleRelaysStatus(req, res);
+    });
+    
     // System/Configuration endpoints
     server_->Get("/api/v1/system/network-interfaces", [this](const httplib::Request& req, httplib::Response& res) {
         handleGetNetworkInterfaces(req, res);
@@ -239,6 +392,22 @@ void HTTPServer::setWSServer(WSServer* wsServer) {
     wsServer_ = wsServer;
 }
 
+void HTTPServer::setSniffer(std::shared_ptr<SnifferClass> sniffer) {
+    sniffer_ = sniffer;
+}
+
+void HTTPServer::setPcapReplay(std::shared_ptr<PcapReplay> replay) {
+    pcapReplay_ = replay;
+}
+
+void HTTPServer::setLoadGenerator(std::shared_ptr<LoadGenerator> generator) {
+    loadGenerator_ = generator;
+}
+
+void HTTPServer::setRelayEmulator(std::shared_ptr<RelayEmulator> emulator) {
+    relayEmulator_ = emulator;
+}
+
 void HTTPServer::setImpedanceCalculator(std::shared_ptr<vts::testers::ImpedanceCalculator> calculator) {
     impedanceCalculator_ = calculator;
 }
@@ -259,6 +428,23 @@ void HTTPServer::setDifferentialTester(std::shared_ptr<vts::testers::Differentia
     differentialTester_ = tester;
 }
 
+void HTTPServer::setTestJobExecutor(std::shared_ptr<vts::testers::TestJobExecutor> executor) {
+    testJobs_ = executor;
+}
+
+void HTTPServer::setResultStore(std::shared_ptr<vts::testers::ResultStore> store) {
+    results_ = store;
+}
+
+void HTTPServer::setClock(std::shared_ptr<Clock> clock) {
+    clock_ = clock;
+}
+
+void HTTPServer::setRtSelfTestConfig(const RtSelfTestConfig& config) {
+    std::lock_guard<std::mutex> lock(rtSelfTestMutex_);
+    rtSelfTest_ = config;
+}
+
 // Health endpoint
 void HTTPServer::handleHealth(const httplib::Request& /*req*/, httplib::Response& res) {
     json response = {
@@ -269,6 +455,115 @@ void HTTPServer::handleHealth(const httplib::Request& /*req*/, httplib::Response
     sendJsonResponse(res, 200, response);
 }
 
+// Reference time the SV streams and transient replays are aligned to
+void HTTPServer::handleTimeStatus(const httplib::Request& /*req*/, httplib::Response& res) {
+    const TimeSourceStatus status = systemTimeSource()->status();
+    sendJsonResponse(res, 200, {
+        {"reference", status.reference},
+        {"state", TimeSource::stateToString(status.state)},
+        {"smpSynch", static_cast<int>(status.state)},
+        {"offsetNs", status.offsetNs},
+        {"driftPpm", status.driftPpm},
+        {"bracketNs", status.bracketNs},
+        {"refreshes", status.refreshes},
+        {"steps", status.steps},
+        {"failures", status.failures}
+    });
+}
+
+// Process counters plus the health of each registered RT thread
+void HTTPServer::handleMetrics(const httplib::Request& /*req*/, httplib::Response& res) {
+    json response = json::parse(Metrics::toJson());
+    response["threadHealth"] = ThreadHealth::toJson();
+    sendJsonResponse(res, 200, response);
+}
+
+// Last RT self-test (startup or POST), with per-rate verdicts
+void HTTPServer::handleRtSelfTestGet(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    auto report = svManager_->getRtReport();
+    if (!report) {
+        sendErrorResponse(res, 404, "No RT self-test has run");
+        return;
+    }
+    sendJsonResponse(res, 200, report->toJson());
+}
+
+// Blocks for the run; the result becomes what stream sample rates are checked against
+void HTTPServer::handleRtSelfTestRun(const httplib::Request& req, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    if (!testJobs_) {
+        sendErrorResponse(res, 503, "Test job executor not initialized");
+        return;
+    }
+    
+    uint64_t durationMs = RtSelfTest_DurationNs / 1000000;
+    try {
+        if (!req.body.empty()) {
+            json body = json::parse(req.body);
+            durationMs = body.value("durationMs", durationMs);
+        }
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        return;
+    }
+    if (durationMs == 0 || durationMs > RtSelfTest_MaxDurationNs / 1000000) {
+        sendErrorResponse(res, 400, "durationMs must be 1.." + std::to_string(RtSelfTest_MaxDurationNs / 1000000));
+        return;
+    }
+    
+    // Cyclictest-style load only means something on a quiet machine and the
+    // wall clock: refuse while streams publish or the testers run on virtual time
+    if (clock_ && clock_->isVirtual()) {
+        sendErrorResponse(res, 409, "RT self-test is not available under virtual time");
+        return;
+    }
+    if (svManager_->runningStreams() > 0) {
+        sendErrorResponse(res, 409, "Stop all streams before running the RT self-test");
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(rtSelfTestMutex_);
+    TestJobInfo previous;
+    if (rtSelfTestJob_ != 0 && testJobs_->get(rtSelfTestJob_, previous) && !previous.finished()) {
+        sendErrorResponse(res, 409, "An RT self-test is already queued or running");
+        return;
+    }
+    
+    RtSelfTestConfig config = rtSelfTest_;
+    config.durationNs = durationMs * 1000000;
+    auto manager = svManager_;
+    TestJob job = [config, manager](TestJobContext&) -> json {
+        // Jobs ahead in the queue may have started streams since the request
+        if (manager->runningStreams() > 0) {
+            throw std::runtime_error("Streams started before the RT self-test ran");
+        }
+        auto report = std::make_shared<const RtSelfTestReport>(runRtSelfTest(config));
+        manager->setRtReport(report);
+        return report->toJson();
+    };
+    
+    std::string error;
+    const uint64_t id = testJobs_->submit("rt-selftest", std::move(job), error);
+    if (id == 0) {
+        sendErrorResponse(res, 429, "Failed to queue RT self-test: " + error);
+        return;
+    }
+    rtSelfTestJob_ = id;
+    
+    sendJsonResponse(res, 202, {
+        {"jobId", id},
+        {"state", "QUEUED"},
+        {"location", "/api/v1/jobs/" + std::to_string(id)}
+    });
+}
+
 // Stream management endpoints
 void HTTPServer::handleGetStreams(const httplib::Request& /*req*/, httplib::Response& res) {
     if (!svManager_) {
@@ -303,6 +598,8 @@ void HTTPServer::handleCreateStream(const httplib::Request& req, httplib::Respon
         sendJsonResponse(res, 201, response);
     } catch (const json::exception& e) {
         sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, std::string("Failed to create stream: ") + e.what());
     } catch (const std::exception& e) {
         sendErrorResponse(res, 500, std::string("Failed to create stream: ") + e.what());
     }
@@ -327,6 +624,8 @@ void HTTPServer::handleUpdateStream(const httplib::Request& req, httplib::Respon
         sendJsonResponse(res, 200, response);
     } catch (const json::exception& e) {
         sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, std::string("Failed to update stream: ") + e.what());
     } catch (const std::exception& e) {
         sendErrorResponse(res, 500, std::string("Failed to update stream: ") + e.what());
     }
@@ -395,6 +694,178 @@ void HTTPServer::handleStopStream(const httplib::Request& req, httplib::Response
     }
 }
 
+void HTTPServer::handleSetImpairment(const httplib::Request& req, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    
+    std::string streamId = req.path_params.at("id");
+    
+    try {
+        json body = json::parse(req.body);
+        json response = svManager_->setImpairment(streamId, body);
+        response["id"] = streamId;
+        sendJsonResponse(res, 200, response);
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+    } catch (const std::exception& e) {
+        sendErrorResponse(res, 404, e.what());
+    }
+}
+
+void HTTPServer::handleGetImpairment(const httplib::Request& req, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    
+    std::string streamId = req.path_params.at("id");
+    
+    try {
+        json response = svManager_->getImpairment(streamId);
+        response["id"] = streamId;
+        sendJsonResponse(res, 200, response);
+    } catch (const std::exception& e) {
+        sendErrorResponse(res, 404, e.what());
+    }
+}
+
+void HTTPServer::handleGetImpairmentEvents(const httplib::Request& req, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    
+    std::string streamId = req.path_params.at("id");
+    
+    uint64_t since = 0;
+    size_t max = 256;
+    try {
+        if (req.has_param("since")) {
+            since = std::stoull(req.get_param_value("since"));
+        }
+        if (req.has_param("max")) {
+            max = std::min<size_t>(std::stoul(req.get_param_value("max")), Impairment_EventCapacity);
+        }
+    } catch (const std::exception&) {
+        sendErrorResponse(res, 400, "'since' and 'max' must be non-negative integers");
+        return;
+    }
+    
+    try {
+        json response = svManager_->getImpairmentEvents(streamId, since, max);
+        response["id"] = streamId;
+        sendJsonResponse(res, 200, response);
+    } catch (const std::exception& e) {
+        sendErrorResponse(res, 404, e.what());
+    }
+}
+
+void HTTPServer::handleAttachFaultTransient(const httplib::Request& req, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    
+    std::string streamId = req.path_params.at("id");
+    
+    try {
+        json body = json::parse(req.body);
+        json stream = svManager_->getStream(streamId);
+        
+        vts::testers::FaultTransientConfig config;
+        config.faultType = vts::testers::ImpedanceCalculator::parseFaultType(body.value("faultType", "AG"));
+        config.faultZ.R = body.value("R", 0.0);
+        config.faultZ.X = body.value("X", 0.0);
+        if (body.contains("source")) {
+            const json& src = body["source"];
+            config.source.RS1 = src.value("RS1", config.source.RS1);
+            config.source.XS1 = src.value("XS1", config.source.XS1);
+            config.source.RS0 = src.value("RS0", config.source.RS0);
+            config.source.XS0 = src.value("XS0", config.source.XS0);
+            config.source.Vprefault = src.value("Vprefault", config.source.Vprefault);
+        }
+        // Waveform follows the stream unless told otherwise
+        config.frequency = body.value("frequency", stream.value("nominalFreq", config.frequency));
+        config.sampleRate = body.value("sampleRate", stream.value("sampleRate", config.sampleRate));
+        config.prefaultDuration = body.value("prefaultDuration", config.prefaultDuration);
+        config.faultDuration = body.value("faultDuration", config.faultDuration);
+        config.inceptionAngle = body.value("inceptionAngle", config.inceptionAngle);
+        config.xOverR = body.value("xOverR", config.xOverR);
+        if (body.contains("loadCurrent")) {
+            const json& load = body["loadCurrent"];
+            config.loadCurrent = std::polar(load.value("magnitude", 0.0),
+                                            load.value("angle", 0.0) * M_PI / 180.0);
+        }
+        if (body.contains("ct")) {
+            const json& ct = body["ct"];
+            config.ct.enabled = ct.value("enabled", true);
+            config.ct.ratio = ct.value("ratio", config.ct.ratio);
+            config.ct.burdenOhm = ct.value("burdenOhm", config.ct.burdenOhm);
+            config.ct.kneeVoltage = ct.value("kneeVoltage", config.ct.kneeVoltage);
+            config.ct.kneeCurrent = ct.value("kneeCurrent", config.ct.kneeCurrent);
+            config.ct.saturatedSlope = ct.value("saturatedSlope", config.ct.saturatedSlope);
+            config.ct.remanence = ct.value("remanence", config.ct.remanence);
+        }
+        if (body.contains("cvt")) {
+            const json& cvt = body["cvt"];
+            config.cvt.enabled = cvt.value("enabled", true);
+            config.cvt.amplitude = cvt.value("amplitude", config.cvt.amplitude);
+            config.cvt.decayMs = cvt.value("decayMs", config.cvt.decayMs);
+            config.cvt.ringHz = cvt.value("ringHz", config.cvt.ringHz);
+        }
+        // Published in secondary units: the CT model's ratio unless given;
+        // the VT ratio has no sensible default, so the generator rejects it unset
+        config.ctRatio = body.value("ctRatio", config.ct.enabled ? config.ct.ratio : config.ctRatio);
+        config.vtRatio = body.value("vtRatio", config.vtRatio);
+        
+        auto generator = std::make_shared<vts::testers::FaultTransientGenerator>(config);
+        svManager_->setSampleSource(streamId, generator);
+        
+        const PhasorState& state = generator->faultState();
+        auto phasor = [](std::complex<double> p) {
+            return json{{"magnitude", std::abs(p)}, {"angle", std::arg(p) * 180.0 / M_PI}};
+        };
+        json response = {
+            {"id", streamId},
+            {"faultType", vts::testers::ImpedanceCalculator::faultTypeToString(config.faultType)},
+            {"timeConstantMs", generator->timeConstant() * 1000.0},
+            {"inceptionSample", generator->inceptionSample()},
+            {"totalSamples", generator->totalSamples()},
+            {"fault", {
+                {"voltage", {{"A", phasor(state.voltage.A)}, {"B", phasor(state.voltage.B)}, {"C", phasor(state.voltage.C)}}},
+                {"current", {{"A", phasor(state.current.A)}, {"B", phasor(state.current.B)}, {"C", phasor(state.current.C)}}}
+            }}
+        };
+        sendJsonResponse(res, 200, response);
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+    } catch (const std::exception& e) {
+        sendErrorResponse(res, 404, e.what());
+    }
+}
+
+void HTTPServer::handleDetachFaultTransient(const httplib::Request& req, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    
+    std::string streamId = req.path_params.at("id");
+    
+    try {
+        svManager_->setSampleSource(streamId, nullptr);
+        sendJsonResponse(res, 200, {{"id", streamId}, {"detached", true}});
+    } catch (const std::exception& e) {
+        sendErrorResponse(res, 404, e.what());
+    }
+}
+
 // Phasor endpoints
 void HTTPServer::handleUpdatePhasors(const httplib::Request& req, httplib::Response& res) {
     if (!svManager_) {
@@ -436,6 +907,32 @@ void HTTPServer::handleUpdateHarmonics(const httplib::Request& req, httplib::Res
     }
 }
 
+void HTTPServer::handleBulkUpdate(const httplib::Request& req, httplib::Response& res) {
+    if (!svManager_) {
+        sendErrorResponse(res, 503, "Publisher manager not initialized");
+        return;
+    }
+    
+    try {
+        // Parsed and validated before the manager lock is taken
+        json body = json::parse(req.body);
+        BulkUpdate update = SVPublisherManager::parseBulkUpdate(body);
+        const uint64_t version = svManager_->applyBulk(update);
+        
+        json streams = json::array();
+        for (const auto& entry : update.streams) {
+            streams.push_back({{"id", entry.streamId}, {"smpCnt", entry.appliedSmpCnt}});
+        }
+        sendJsonResponse(res, 200, {{"version", version}, {"streams", streams}});
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+    } catch (const std::exception& e) {
+        sendErrorResponse(res, 404, e.what());
+    }
+}
+
 // COMTRADE playback endpoint
 void HTTPServer::handleComtradePlayback(const httplib::Request& /*req*/, httplib::Response& res) {
     // TODO: Handle multipart/form-data file upload
@@ -667,38 +1164,676 @@ void HTTPServer::handleSequenceResume(const httplib::Request& /*req*/, httplib::
 }
 
 // GOOSE endpoints
-void HTTPServer::handleGooseGetSubscriptions(const httplib::Request& /*req*/, httplib::Response& res) {
-    // TODO: Return actual GOOSE subscriptions from GOOSE engine
-    // For now, return empty array to prevent 404 errors in frontend
-    sendJsonResponse(res, 200, {{"subscriptions", json::array()}});
-}
+namespace {
 
-void HTTPServer::handleGooseScan(const httplib::Request& /*req*/, httplib::Response& res) {
-    // TODO: Scan for GOOSE messages
-    sendJsonResponse(res, 200, {{"entries", json::array()}});
+std::string formatMac(const uint8_t* mac) {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return std::string(buf);
 }
 
-void HTTPServer::handleGooseConfig(const httplib::Request& req, httplib::Response& res) {
+} // namespace
+
+bool HTTPServer::ensureSnifferRunning(std::string& error) {
+    if (sniffer_->threadStarted) {
+        return true;
+    }
     try {
-        json body = json::parse(req.body);
-        
-        // TODO: Configure GOOSE subscription
-        
-        sendJsonResponse(res, 200, {{"message", "GOOSE configured"}});
-    } catch (const json::exception& e) {
-        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        sniffer_->startThread(sniffer_->currentConfig()->goInfo);
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
     }
+    return true;
 }
 
-// Analyzer endpoint
-void HTTPServer::handleAnalyzerSelect(const httplib::Request& req, httplib::Response& res) {
-    if (!analyzerEngine_) {
-        sendErrorResponse(res, 503, "Analyzer engine not available");
+void HTTPServer::handleGooseGetSubscriptions(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!sniffer_) {
+        sendJsonResponse(res, 200, {{"subscriptions", json::array()}});
         return;
     }
+    
+    auto config = sniffer_->currentConfig();
+    json subscriptions = json::array();
+    for (const auto& info : config->goInfo) {
+        json inputs = json::array();
+        for (const auto& input : info.input) {
+            inputs.push_back(input);
+        }
+        subscriptions.push_back({
+            {"goCbRef", info.goCbRef},
+            {"macDst", info.mac_dst.size() == 6 ? formatMac(info.mac_dst.data()) : std::string()},
+            {"inputs", inputs}
+        });
+    }
+    sendJsonResponse(res, 200, {{"subscriptions", subscriptions}});
+}
 
+void HTTPServer::handleGooseScan(const httplib::Request& req, httplib::Response& res) {
+    if (!sniffer_) {
+        sendErrorResponse(res, 503, "Sniffer not available");
+        return;
+    }
+    
+    bool enable = true;
+    bool clear = false;
+    std::string type = "all";
     try {
-        json body = json::parse(req.body);
+        if (!req.body.empty()) {
+            json body = json::parse(req.body);
+            enable = body.value("enable", true);
+            clear = body.value("clear", false);
+            type = body.value("type", std::string("all"));
+        }
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        return;
+    }
+    if (type != "all" && type != "goose" && type != "sv") {
+        sendErrorResponse(res, 400, "type must be one of: all, goose, sv");
+        return;
+    }
+    
+    auto& discovery = *sniffer_->discovery;
+    if (clear) {
+        discovery.clear();
+    }
+    discovery.setEnabled(enable);
+    
+    if (enable) {
+        std::lock_guard<std::mutex> lock(snifferMutex_);
+        std::string error;
+        if (!ensureSnifferRunning(error)) {
+            discovery.setEnabled(false);
+            sendErrorResponse(res, 500, "Failed to start sniffer: " + error);
+            return;
+        }
+    }
+    
+    // Read the table while capture keeps running
+    const uint64_t nowNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    json entries = json::array();
+    for (const auto& stream : discovery.snapshot()) {
+        const bool isGoose = stream.type == vts::sniffer::DiscoveredStream::Type::GOOSE;
+        if ((type == "goose" && !isGoose) || (type == "sv" && isGoose)) {
+            continue;
+        }
+        json entry = {
+            {"type", isGoose ? "goose" : "sv"},
+            {"srcMac", formatMac(stream.srcMac.data())},
+            {"dstMac", formatMac(stream.dstMac.data())},
+            {"appId", stream.appId},
+            {"vlanId", stream.vlanId >= 0 ? json(stream.vlanId) : json(nullptr)},
+            {isGoose ? "goCbRef" : "svID", stream.id},
+            {"confRev", stream.confRev},
+            {"frames", stream.frames},
+            {"frameRate", stream.frameRate},
+            {"lastSeenMs", nowNs > stream.lastSeenNs ? (nowNs - stream.lastSeenNs) / 1000000 : 0}
+        };
+        if (isGoose) {
+            entry["numDatSetEntries"] = stream.channels;
+        } else {
+            entry["noAsdu"] = stream.noAsdu;
+            entry["channels"] = stream.channels;
+            entry["sampleRate"] = stream.frameRate * stream.noAsdu;
+        }
+        entries.push_back(entry);
+    }
+    
+    sendJsonResponse(res, 200, {
+        {"scanning", discovery.enabled()},
+        {"entries", entries},
+        {"overflow", discovery.overflow()}
+    });
+}
+
+void HTTPServer::handleGooseConfig(const httplib::Request& req, httplib::Response& res) {
+    if (!sniffer_) {
+        sendErrorResponse(res, 503, "Sniffer not available");
+        return;
+    }
+    
+    std::vector<Goose_info> subscriptions;
+    std::shared_ptr<const vts::sniffer::TripRuleEvaluator> tripRules;
+    bool hasTripRules = false;
+    try {
+        json body = json::parse(req.body);
+        
+        if (!body.contains("subscriptions") || !body["subscriptions"].is_array()) {
+            sendErrorResponse(res, 400, "Missing subscriptions array");
+            return;
+        }
+        
+        Ethernet macParser("00:00:00:00:00:00", "00:00:00:00:00:00");
+        for (const auto& sub : body["subscriptions"]) {
+            Goose_info info;
+            info.goCbRef = sub.at("goCbRef").get<std::string>();
+            auto mac = macParser.macStrToBytes(sub.at("macDst").get<std::string>());
+            info.mac_dst.assign(mac.begin(), mac.end());
+            for (const auto& input : sub.value("inputs", json::array())) {
+                auto pair = input.get<std::vector<uint32_t>>();
+                if (pair.size() != 2) {
+                    sendErrorResponse(res, 400, "Each input must be [digitalInput, dataIndex]");
+                    return;
+                }
+                if (pair[0] >= DigitalInput_Count || pair[1] >= Sniffer_MaxGooseEntries) {
+                    sendErrorResponse(res, 400, "digitalInput must be < " + std::to_string(DigitalInput_Count) +
+                                      " and dataIndex < " + std::to_string(Sniffer_MaxGooseEntries));
+                    return;
+                }
+                info.input.push_back({static_cast<uint16_t>(pair[0]), static_cast<uint16_t>(pair[1])});
+            }
+            subscriptions.push_back(std::move(info));
+        }
+        
+        // Optional; an empty array disables the rules, absent keeps the current set
+        if (body.contains("tripRules")) {
+            tripRules = vts::sniffer::tripRulesFromJson(body["tripRules"]);
+            hasTripRules = true;
+        }
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        return;
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    }
+    
+    // A running sniffer picks the new snapshot up at its next frame
+    const size_t count = subscriptions.size();
+    uint64_t version = sniffer_->setSubscriptions(std::move(subscriptions));
+    if (hasTripRules) {
+        version = sniffer_->setTripRules(std::move(tripRules));
+    }
+    const auto config = sniffer_->config.load();
+    const size_t ruleCount = config->tripRules ? config->tripRules->getRuleNames().size() : 0;
+    
+    sendJsonResponse(res, 200, {
+        {"message", "GOOSE configured"},
+        {"subscriptions", count},
+        {"tripRules", ruleCount},
+        {"configVersion", version}
+    });
+}
+
+// Sniffer endpoints
+void HTTPServer::handleSnifferRedundancy(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!sniffer_) {
+        sendErrorResponse(res, 503, "Sniffer not available");
+        return;
+    }
+    
+    const auto& filter = sniffer_->redundancy;
+    auto lanJson = [&filter](uint8_t lan) {
+        auto stats = filter.lanStats(lan);
+        return json{
+            {"received", stats.received},
+            {"duplicates", stats.duplicates},
+            {"resets", stats.resets}
+        };
+    };
+    
+    sendJsonResponse(res, 200, {
+        {"lanA", lanJson(0)},
+        {"lanB", lanJson(1)},
+        {"sources", filter.sourceCount()},
+        {"untracked", filter.untracked()},
+        {"windowFrames", vts::sniffer::DuplicateFilter::Window}
+    });
+}
+
+// pcap replay endpoints
+void HTTPServer::handlePcapReplayStart(const httplib::Request& req, httplib::Response& res) {
+    if (!pcapReplay_) {
+        sendErrorResponse(res, 503, "pcap replay not available");
+        return;
+    }
+    
+    PcapReplayConfig config;
+    try {
+        json body = json::parse(req.body);
+        
+        if (!body.contains("file") || !body["file"].is_string()) {
+            sendErrorResponse(res, 400, "Missing file field");
+            return;
+        }
+        config.path = body["file"].get<std::string>();
+        config.speed = body.value("speed", 1.0);
+        config.loop = body.value("loop", false);
+        config.loopCount = body.value("loopCount", 0u);
+        config.batchWindowNs = static_cast<uint32_t>(body.value("batchWindowUs", PcapReplay_BatchWindowNs / 1000u) * 1000u);
+        
+        if (config.speed <= 0.0 || config.speed > 1000.0) {
+            sendErrorResponse(res, 400, "speed must be in (0, 1000]");
+            return;
+        }
+        
+        if (body.contains("rewrite")) {
+            const json& rewrite = body["rewrite"];
+            Ethernet macParser("00:00:00:00:00:00", "00:00:00:00:00:00");
+            if (rewrite.contains("dstMac")) {
+                config.rewriteDstMac = true;
+                config.dstMac = macParser.macStrToBytes(rewrite["dstMac"].get<std::string>());
+            }
+            if (rewrite.contains("srcMac")) {
+                config.rewriteSrcMac = true;
+                config.srcMac = macParser.macStrToBytes(rewrite["srcMac"].get<std::string>());
+            }
+            config.appId = rewrite.value("appId", -1);
+            config.vlanId = rewrite.value("vlanId", -1);
+            config.vlanPriority = rewrite.value("vlanPriority", -1);
+            config.stripVlan = rewrite.value("stripVlan", false);
+            if (config.appId > 0xFFFF || config.vlanId > 4095 || config.vlanPriority > 7) {
+                sendErrorResponse(res, 400, "appId must be <= 0xFFFF, vlanId <= 4095, vlanPriority <= 7");
+                return;
+            }
+            if (config.stripVlan && config.vlanId >= 0) {
+                sendErrorResponse(res, 400, "stripVlan and vlanId are mutually exclusive");
+                return;
+            }
+        }
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        return;
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(pcapReplayMutex_);
+    std::string error;
+    if (!pcapReplay_->start(config, error)) {
+        sendErrorResponse(res, 400, "Failed to start replay: " + error);
+        return;
+    }
+    
+    sendJsonResponse(res, 200, {
+        {"message", "Replay started"},
+        {"file", config.path},
+        {"speed", config.speed},
+        {"loop", config.loop}
+    });
+}
+
+void HTTPServer::handlePcapReplayStop(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!pcapReplay_) {
+        sendErrorResponse(res, 503, "pcap replay not available");
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(pcapReplayMutex_);
+    pcapReplay_->stop();
+    sendJsonResponse(res, 200, {{"message", "Replay stopped"}});
+}
+
+void HTTPServer::handlePcapReplayStatus(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!pcapReplay_) {
+        sendErrorResponse(res, 503, "pcap replay not available");
+        return;
+    }
+    
+    const PcapReplayStats stats = pcapReplay_->getStats();
+    sendJsonResponse(res, 200, {
+        {"running", stats.running},
+        {"error", stats.error},
+        {"framesSent", stats.framesSent},
+        {"framesSkipped", stats.framesSkipped},
+        {"bytesSent", stats.bytesSent},
+        {"sendErrors", stats.sendErrors},
+        {"batches", stats.batches},
+        {"loopsCompleted", stats.loopsCompleted},
+        {"timingErrorNs", {
+            {"p50", stats.errorP50Ns},
+            {"p90", stats.errorP90Ns},
+            {"p99", stats.errorP99Ns},
+            {"p999", stats.errorP999Ns},
+            {"min", stats.errorMinNs},
+            {"max", stats.errorMaxNs},
+            {"mean", stats.errorMeanNs}
+        }}
+    });
+}
+
+// Load generator endpoints
+void HTTPServer::handleLoadGenStart(const httplib::Request& req, httplib::Response& res) {
+    if (!loadGenerator_) {
+        sendErrorResponse(res, 503, "Load generator not available");
+        return;
+    }
+    
+    LoadGenConfig config;
+    try {
+        json body = json::parse(req.body);
+        Ethernet macParser("00:00:00:00:00:00", "00:00:00:00:00:00");
+        
+        for (const auto& item : body.value("sv", json::array())) {
+            LoadGenSvGroup group;
+            group.count = item.value("count", 1u);
+            group.sampleRate = item.value("sampleRate", group.sampleRate);
+            const uint32_t noAsdu = item.value("noAsdu", 1u);
+            if (noAsdu < 1 || noAsdu > 8) {
+                sendErrorResponse(res, 400, "SV noAsdu must be 1..8");
+                return;
+            }
+            group.noAsdu = static_cast<uint8_t>(noAsdu);
+            group.nominalFreq = item.value("nominalFreq", group.nominalFreq);
+            group.currentA = item.value("currentA", group.currentA);
+            group.voltageV = item.value("voltageV", group.voltageV);
+            group.baseAppId = static_cast<uint16_t>(item.value("appId", 0x4000u) & 0xFFFFu);
+            if (item.contains("dstMac")) {
+                group.baseDstMac = macParser.macStrToBytes(item["dstMac"].get<std::string>());
+            }
+            group.svIdPrefix = item.value("svIdPrefix", group.svIdPrefix);
+            config.sv.push_back(group);
+        }
+        
+        for (const auto& item : body.value("goose", json::array())) {
+            LoadGenGooseGroup group;
+            group.count = item.value("count", 1u);
+            group.rateHz = item.value("rateHz", group.rateHz);
+            group.dataEntries = item.value("entries", group.dataEntries);
+            group.stateChange = item.value("stateChange", false);
+            group.baseAppId = static_cast<uint16_t>(item.value("appId", 0x0001u) & 0xFFFFu);
+            if (item.contains("dstMac")) {
+                group.baseDstMac = macParser.macStrToBytes(item["dstMac"].get<std::string>());
+            }
+            group.gocbRefPrefix = item.value("gocbRefPrefix", group.gocbRefPrefix);
+            config.goose.push_back(group);
+        }
+        
+        if (body.contains("srcMac")) {
+            config.srcMac = macParser.macStrToBytes(body["srcMac"].get<std::string>());
+        }
+        const uint32_t vlanId = body.value("vlanId", 0u);
+        const uint32_t vlanPriority = body.value("vlanPriority", 4u);
+        if (vlanId > 4095 || vlanPriority > 7) {
+            sendErrorResponse(res, 400, "vlanId must be <= 4095, vlanPriority <= 7");
+            return;
+        }
+        config.vlanId = static_cast<uint16_t>(vlanId);
+        config.vlanPriority = static_cast<uint8_t>(vlanPriority);
+        config.cpus = body.value("cpus", std::vector<int>());
+        config.durationS = body.value("durationS", 0.0);
+        config.batchWindowNs = static_cast<uint32_t>(body.value("batchWindowUs", LoadGen_BatchWindowNs / 1000u) * 1000u);
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        return;
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(loadGenMutex_);
+    std::string error;
+    if (!loadGenerator_->start(config, error)) {
+        sendErrorResponse(res, 400, "Failed to start load generator: " + error);
+        return;
+    }
+    
+    const LoadGenStats stats = loadGenerator_->getStats();
+    sendJsonResponse(res, 200, {
+        {"message", "Load generator started"},
+        {"streams", stats.streams.size()},
+        {"threads", stats.threads},
+        {"targetFramesPerSecond", stats.targetFramesPerSecond}
+    });
+}
+
+void HTTPServer::handleLoadGenStop(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!loadGenerator_) {
+        sendErrorResponse(res, 503, "Load generator not available");
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(loadGenMutex_);
+    loadGenerator_->stop();
+    sendJsonResponse(res, 200, {{"message", "Load generator stopped"}});
+}
+
+void HTTPServer::handleLoadGenStatus(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!loadGenerator_) {
+        sendErrorResponse(res, 503, "Load generator not available");
+        return;
+    }
+    
+    const LoadGenStats stats = loadGenerator_->getStats();
+    json streams = json::array();
+    for (const auto& stream : stats.streams) {
+        streams.push_back({
+            {"name", stream.name},
+            {"type", stream.kind == LoadStreamKind::SV ? "SV" : "GOOSE"},
+            {"appId", stream.appId},
+            {"thread", stream.thread},
+            {"targetFramesPerSecond", stream.targetFramesPerSecond},
+            {"framesSent", stream.framesSent},
+            {"bytesSent", stream.bytesSent},
+            {"sendErrors", stream.sendErrors},
+            {"framesPerSecond", stream.framesPerSecond},
+            {"bitsPerSecond", stream.bitsPerSecond},
+            {"timingErrorNs", {
+                {"p50", stream.errorP50Ns},
+                {"p99", stream.errorP99Ns},
+                {"max", stream.errorMaxNs},
+                {"mean", stream.errorMeanNs}
+            }}
+        });
+    }
+    
+    sendJsonResponse(res, 200, {
+        {"running", stats.running},
+        {"error", stats.error},
+        {"elapsedS", stats.elapsedS},
+        {"threads", stats.threads},
+        {"framesSent", stats.framesSent},
+        {"sendErrors", stats.sendErrors},
+        {"targetFramesPerSecond", stats.targetFramesPerSecond},
+        {"framesPerSecond", stats.framesPerSecond},
+        {"bitsPerSecond", stats.bitsPerSecond},
+        {"wireBitsPerSecond", stats.wireBitsPerSecond},
+        {"streams", streams}
+    });
+}
+
+// Relay emulator endpoints
+void HTTPServer::handleRelaysStart(const httplib::Request& req, httplib::Response& res) {
+    if (!relayEmulator_) {
+        sendErrorResponse(res, 503, "Relay emulator not available");
+        return;
+    }
+    
+    std::vector<RelayConfig> relays;
+    try {
+        json body = json::parse(req.body);
+        Ethernet macParser("00:00:00:00:00:00", "00:00:00:00:00:00");
+        auto channels = [](const json& item, const char* key, std::array<uint8_t, 3>& target) {
+            if (!item.contains(key)) return;
+            const std::vector<unsigned> indices = item[key].get<std::vector<unsigned>>();
+            if (indices.size() != 3) {
+                throw std::invalid_argument(std::string(key) + " must list three seqData indices");
+            }
+            for (size_t k = 0; k < 3; ++k) {
+                target[k] = static_cast<uint8_t>(std::min(indices[k], 255u));
+            }
+        };
+        
+        for (const auto& item : body.value("relays", json::array())) {
+            RelayConfig config;
+            config.name = item.value("name", "Relay" + std::to_string(relays.size() + 1));
+            if (item.contains("svDstMac")) {
+                config.svDstMac = macParser.macStrToBytes(item["svDstMac"].get<std::string>());
+            }
+            config.svAppId = static_cast<uint16_t>(item.value("svAppId", 0x4000u) & 0xFFFFu);
+            config.sampleRate = item.value("sampleRate", config.sampleRate);
+            config.nominalFrequency = item.value("nominalFrequency", config.nominalFrequency);
+            channels(item, "currentChannels", config.currentChannels);
+            channels(item, "voltageChannels", config.voltageChannels);
+            config.currentScale = item.value("currentScale", config.currentScale);
+            config.voltageScale = item.value("voltageScale", config.voltageScale);
+            
+            if (item.contains("overcurrent")) {
+                const json& oc = item["overcurrent"];
+                config.overcurrent.enabled = true;
+                config.overcurrent.settings.pickupCurrent = oc.value("pickupCurrent", 1.0);
+                config.overcurrent.settings.TMS = oc.value("TMS", 0.1);
+                config.overcurrent.settings.curve = vts::testers::OvercurrentTester::parseCurve(
+                    oc.value("curve", "STANDARD_INVERSE"));
+                config.overcurrent.instantaneousPickup = oc.value("instantaneousPickup", 0.0);
+                config.overcurrent.instantaneousDelay = oc.value("instantaneousDelay", 0.0);
+            }
+            
+            if (item.contains("distance")) {
+                const json& distance = item["distance"];
+                config.distance.enabled = true;
+                for (const auto& entry : distance.value("zones", json::array())) {
+                    RelayDistanceZone zone;
+                    const std::string shape = entry.value("shape", "mho");
+                    if (shape == "quad" || shape == "quadrilateral") {
+                        zone.shape = RelayDistanceZone::Shape::Quadrilateral;
+                    } else if (shape != "mho") {
+                        throw std::invalid_argument("Unknown zone shape: " + shape);
+                    }
+                    zone.reach = entry.value("reach", zone.reach);
+                    zone.angle = entry.value("angle", zone.angle);
+                    zone.resistiveReach = entry.value("resistiveReach", zone.resistiveReach);
+                    zone.delay = entry.value("delay", zone.delay);
+                    config.distance.zones.push_back(zone);
+                }
+                if (distance.contains("k0")) {
+                    config.distance.k0 = std::polar(distance["k0"].value("magnitude", 0.0),
+                                                    distance["k0"].value("angle", 0.0) * M_PI / 180.0);
+                }
+                config.distance.minCurrent = distance.value("minCurrent", config.distance.minCurrent);
+            }
+            
+            if (item.contains("differential")) {
+                const json& differential = item["differential"];
+                config.differential.enabled = true;
+                config.differential.remoteDstMac = macParser.macStrToBytes(
+                    differential.at("remoteDstMac").get<std::string>());
+                config.differential.remoteAppId = static_cast<uint16_t>(
+                    differential.value("remoteAppId", 0x4001u) & 0xFFFFu);
+                config.differential.pickup = differential.value("pickup", config.differential.pickup);
+                config.differential.slope1 = differential.value("slope1", config.differential.slope1);
+                config.differential.breakpoint = differential.value("breakpoint", config.differential.breakpoint);
+                config.differential.slope2 = differential.value("slope2", config.differential.slope2);
+                config.differential.delay = differential.value("delay", config.differential.delay);
+            }
+            
+            config.outputDelay = item.value("outputDelayMs", config.outputDelay * 1000.0) / 1000.0;
+            if (item.contains("gooseDstMac")) {
+                config.gooseDstMac = macParser.macStrToBytes(item["gooseDstMac"].get<std::string>());
+            }
+            if (item.contains("srcMac")) {
+                config.srcMac = macParser.macStrToBytes(item["srcMac"].get<std::string>());
+            }
+            config.gooseAppId = static_cast<uint16_t>(item.value("gooseAppId", 0x0001u) & 0xFFFFu);
+            config.gocbRef = item.value("gocbRef", "");
+            const uint32_t vlanId = item.value("vlanId", 0u);
+            const uint32_t vlanPriority = item.value("vlanPriority", 4u);
+            if (vlanId > 4095 || vlanPriority > 7) {
+                sendErrorResponse(res, 400, "vlanId must be <= 4095, vlanPriority <= 7");
+                return;
+            }
+            config.vlanId = static_cast<uint16_t>(vlanId);
+            config.vlanPriority = static_cast<uint8_t>(vlanPriority);
+            relays.push_back(config);
+        }
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        return;
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(relayMutex_);
+    std::string error;
+    if (!relayEmulator_->start(relays, error)) {
+        sendErrorResponse(res, 400, "Failed to start relay emulator: " + error);
+        return;
+    }
+    
+    const RelayEmulatorStats stats = relayEmulator_->getStats();
+    sendJsonResponse(res, 200, {
+        {"message", "Relay emulator started"},
+        {"relays", stats.relays.size()},
+        {"loopback", stats.loopback}
+    });
+}
+
+void HTTPServer::handleRelaysStop(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!relayEmulator_) {
+        sendErrorResponse(res, 503, "Relay emulator not available");
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(relayMutex_);
+    relayEmulator_->stop();
+    sendJsonResponse(res, 200, {{"message", "Relay emulator stopped"}});
+}
+
+void HTTPServer::handleRelaysStatus(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!relayEmulator_) {
+        sendErrorResponse(res, 503, "Relay emulator not available");
+        return;
+    }
+    
+    const RelayEmulatorStats stats = relayEmulator_->getStats();
+    json relays = json::array();
+    for (const auto& relay : stats.relays) {
+        relays.push_back({
+            {"name", relay.name},
+            {"frames", relay.frames},
+            {"evaluations", relay.evaluations},
+            {"trips", relay.trips},
+            {"gooseSent", relay.gooseSent},
+            {"tripped", relay.tripped},
+            {"operated", {
+                {"overcurrent", relay.overcurrent},
+                {"distance", relay.distance},
+                {"differential", relay.differential}
+            }},
+            {"frequency", relay.frequency},
+            {"current", relay.current},
+            {"lastOperateTime", relay.lastOperateTime},
+            {"outputLatencyNs", {
+                {"p50", relay.outputP50Ns},
+                {"p99", relay.outputP99Ns},
+                {"max", relay.outputMaxNs}
+            }}
+        });
+    }
+    
+    sendJsonResponse(res, 200, {
+        {"running", stats.running},
+        {"loopback", stats.loopback},
+        {"elapsedS", stats.elapsedS},
+        {"framesReceived", stats.framesReceived},
+        {"framesProcessed", stats.framesProcessed},
+        {"sampleGaps", stats.sampleGaps},
+        {"gooseSent", stats.gooseSent},
+        {"sendErrors", stats.sendErrors},
+        {"framesPerSecond", stats.framesPerSecond},
+        {"processingNs", {
+            {"p50", stats.processingP50Ns},
+            {"p99", stats.processingP99Ns},
+            {"max", stats.processingMaxNs}
+        }},
+        {"relays", relays}
+    });
+}
+
+// Analyzer endpoint
+void HTTPServer::handleAnalyzerSelect(const httplib::Request& req, httplib::Response& res) {
+    if (!analyzerEngine_) {
+        sendErrorResponse(res, 503, "Analyzer engine not available");
+        return;
+    }
+
+    try {
+        json body = json::parse(req.body);
         
         // Validate required fields
         if (!body.contains("streamMac")) {
@@ -713,6 +1848,8 @@ void HTTPServer::handleAnalyzerSelect(const httplib::Request& req, httplib::Resp
         
         std::string streamMac = body["streamMac"];
         int sampleRate = body["sampleRate"];
+        double nominalFrequency = body.value("nominalFrequency", 60.0);
+        double declaredVoltage = body.value("declaredVoltage", 0.0);
         
         // Validate MAC address format
         if (streamMac.length() != 17) {
@@ -726,14 +1863,40 @@ void HTTPServer::handleAnalyzerSelect(const httplib::Request& req, httplib::Resp
             return;
         }
         
-        // Start analyzer
-        bool success = analyzerEngine_->start(streamMac, sampleRate);
+        if (!(nominalFrequency >= 45.0 && nominalFrequency <= 65.0)) {
+            sendErrorResponse(res, 400, "nominalFrequency must be between 45 and 65 Hz");
+            return;
+        }
+        
+        if (!(declaredVoltage >= 0.0)) {
+            sendErrorResponse(res, 400, "declaredVoltage must not be negative");
+            return;
+        }
+        
+        std::array<uint8_t, 6> macBytes;
+        try {
+            macBytes = Ethernet("00:00:00:00:00:00", "00:00:00:00:00:00").macStrToBytes(streamMac);
+        } catch (const std::invalid_argument& e) {
+            sendErrorResponse(res, 400, e.what());
+            return;
+        }
+        
+        // Start analyzer; dips/swells are detected only with a declared voltage
+        vts::analyzer::PowerQualityConfig pqConfig;
+        pqConfig.declaredValue = declaredVoltage;
+        analyzerEngine_->setPowerQualityConfig(pqConfig);
+        bool success = analyzerEngine_->start(streamMac, sampleRate, nominalFrequency);
         
         if (success) {
+            if (sniffer_) {
+                sniffer_->setAnalyzerStream(macBytes, streamMac);
+            }
             sendJsonResponse(res, 200, {
                 {"message", "Analyzer started"},
                 {"streamMac", streamMac},
-                {"sampleRate", sampleRate}
+                {"sampleRate", sampleRate},
+                {"nominalFrequency", nominalFrequency},
+                {"declaredVoltage", declaredVoltage}
             });
         } else {
             sendErrorResponse(res, 500, analyzerEngine_->getLastError());
@@ -750,6 +1913,9 @@ void HTTPServer::handleAnalyzerStop(const httplib::Request& /*req*/, httplib::Re
         return;
     }
     
+    if (sniffer_) {
+        sniffer_->clearAnalyzerStream();
+    }
     analyzerEngine_->stop();
     
     sendJsonResponse(res, 200, {
@@ -762,14 +1928,198 @@ void HTTPServer::handleAnalyzerStatus(const httplib::Request& /*req*/, httplib::
         sendErrorResponse(res, 503, "Analyzer engine not available");
         return;
     }
-    
-    bool running = analyzerEngine_->isRunning();
-    std::string streamMac = analyzerEngine_->getStreamMac();
-    
-    sendJsonResponse(res, 200, {
-        {"running", running},
-        {"streamMac", streamMac}
-    });
+    
+    bool running = analyzerEngine_->isRunning();
+    std::string streamMac = analyzerEngine_->getStreamMac();
+    
+    sendJsonResponse(res, 200, {
+        {"running", running},
+        {"streamMac", streamMac}
+    });
+}
+
+void HTTPServer::handleGetAnalyzerGroups(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!analyzerEngine_) {
+        sendErrorResponse(res, 503, "Analyzer engine not available");
+        return;
+    }
+    
+    json groups = json::array();
+    for (const auto& group : analyzerEngine_->getChannelGroups()) {
+        json entry = {
+            {"name", group.name},
+            {"voltage", group.voltage},
+            {"current", group.current},
+            {"k0", {{"magnitude", std::abs(group.k0)}, {"angle", std::arg(group.k0) * 180.0 / M_PI}}}
+        };
+        if (group.hasDifferential()) {
+            entry["remoteCurrent"] = group.remoteCurrent;
+        }
+        groups.push_back(entry);
+    }
+    sendJsonResponse(res, 200, {{"groups", groups}});
+}
+
+void HTTPServer::handleSetAnalyzerGroups(const httplib::Request& req, httplib::Response& res) {
+    if (!analyzerEngine_) {
+        sendErrorResponse(res, 503, "Analyzer engine not available");
+        return;
+    }
+    
+    try {
+        json body = json::parse(req.body);
+        if (!body.contains("groups") || !body["groups"].is_array()) {
+            sendErrorResponse(res, 400, "Missing groups array");
+            return;
+        }
+        
+        std::vector<vts::analyzer::ChannelGroup> groups;
+        for (const auto& entry : body["groups"]) {
+            vts::analyzer::ChannelGroup group;
+            group.name = entry.at("name").get<std::string>();
+            group.voltage = entry.at("voltage").get<std::array<std::string, 3>>();
+            group.current = entry.at("current").get<std::array<std::string, 3>>();
+            if (entry.contains("remoteCurrent")) {
+                group.remoteCurrent = entry["remoteCurrent"].get<std::array<std::string, 3>>();
+            }
+            if (entry.contains("k0")) {
+                group.k0 = std::polar(entry["k0"].value("magnitude", 0.0),
+                                      entry["k0"].value("angle", 0.0) * M_PI / 180.0);
+            }
+            for (const auto* names : {&group.voltage, &group.current}) {
+                for (const auto& name : *names) {
+                    if (name.empty()) {
+                        throw std::invalid_argument("Group " + group.name + " has an empty channel name");
+                    }
+                }
+            }
+            groups.push_back(std::move(group));
+        }
+        
+        analyzerEngine_->setChannelGroups(groups);
+        sendJsonResponse(res, 200, {
+            {"message", "Analyzer groups updated"},
+            {"count", groups.size()}
+        });
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+    }
+}
+
+
+static const std::pair<vts::analyzer::RecorderTrigger::Type, const char*> RECORDER_TRIGGER_NAMES[] = {
+    {vts::analyzer::RecorderTrigger::Type::OverCurrent, "overCurrent"},
+    {vts::analyzer::RecorderTrigger::Type::UnderCurrent, "underCurrent"},
+    {vts::analyzer::RecorderTrigger::Type::RateOfChange, "rateOfChange"},
+    {vts::analyzer::RecorderTrigger::Type::GooseTrip, "gooseTrip"},
+    {vts::analyzer::RecorderTrigger::Type::DigitalChange, "digitalChange"},
+};
+
+void HTTPServer::handleGetAnalyzerRecorder(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!analyzerEngine_) {
+        sendErrorResponse(res, 503, "Analyzer engine not available");
+        return;
+    }
+    
+    const vts::analyzer::RecorderConfig config = analyzerEngine_->getRecorderConfig();
+    const vts::analyzer::RecorderStatus status = analyzerEngine_->getRecorderStatus();
+    
+    json triggers = json::array();
+    for (const auto& trigger : config.triggers) {
+        json entry = {{"level", trigger.level}};
+        for (const auto& [type, name] : RECORDER_TRIGGER_NAMES) {
+            if (type == trigger.type) {
+                entry["type"] = name;
+            }
+        }
+        if (trigger.type == vts::analyzer::RecorderTrigger::Type::DigitalChange) {
+            entry["input"] = trigger.input;
+        } else if (trigger.type != vts::analyzer::RecorderTrigger::Type::GooseTrip) {
+            entry["channel"] = trigger.channel;
+        }
+        triggers.push_back(entry);
+    }
+    
+    sendJsonResponse(res, 200, {
+        {"enabled", config.enabled},
+        {"directory", config.directory},
+        {"stationName", config.stationName},
+        {"deviceId", config.deviceId},
+        {"channels", config.channels},
+        {"digitalInputs", config.digitalInputs},
+        {"preTrigger", config.preTrigger},
+        {"postTrigger", config.postTrigger},
+        {"maxLength", config.maxLength},
+        {"triggers", triggers},
+        {"status", {
+            {"triggers", status.triggers},
+            {"records", status.records},
+            {"dropped", status.dropped},
+            {"writeErrors", status.writeErrors},
+            {"recentFiles", status.recentFiles},
+            {"lastError", status.lastError}
+        }}
+    });
+}
+
+void HTTPServer::handleSetAnalyzerRecorder(const httplib::Request& req, httplib::Response& res) {
+    if (!analyzerEngine_) {
+        sendErrorResponse(res, 503, "Analyzer engine not available");
+        return;
+    }
+    
+    try {
+        json body = json::parse(req.body);
+        
+        vts::analyzer::RecorderConfig config;
+        config.enabled = body.value("enabled", true);
+        config.directory = body.value("directory", config.directory);
+        config.stationName = body.value("stationName", config.stationName);
+        config.deviceId = body.value("deviceId", config.deviceId);
+        config.channels = body.value("channels", config.channels);
+        config.digitalInputs = body.value("digitalInputs", config.digitalInputs);
+        config.preTrigger = body.value("preTrigger", config.preTrigger);
+        config.postTrigger = body.value("postTrigger", config.postTrigger);
+        config.maxLength = body.value("maxLength", config.maxLength);
+        
+        // Recordings stay under the working directory
+        const std::filesystem::path directory(config.directory);
+        if (directory.is_absolute() || std::find(directory.begin(), directory.end(), "..") != directory.end()) {
+            sendErrorResponse(res, 400, "directory must be a relative path without '..'");
+            return;
+        }
+        
+        for (const auto& entry : body.value("triggers", json::array())) {
+            vts::analyzer::RecorderTrigger trigger;
+            const std::string type = entry.at("type").get<std::string>();
+            bool known = false;
+            for (const auto& [value, name] : RECORDER_TRIGGER_NAMES) {
+                if (type == name) {
+                    trigger.type = value;
+                    known = true;
+                }
+            }
+            if (!known) {
+                throw std::invalid_argument("Unknown trigger type: " + type);
+            }
+            trigger.channel = entry.value("channel", "");
+            trigger.input = entry.value("input", size_t{0});
+            trigger.level = entry.value("level", 0.0);
+            config.triggers.push_back(trigger);
+        }
+        
+        analyzerEngine_->setRecorderConfig(config);
+        sendJsonResponse(res, 200, {
+            {"message", config.enabled ? "Disturbance recorder configured" : "Disturbance recorder disabled"},
+            {"triggers", config.triggers.size()}
+        });
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+    }
 }
 
 
@@ -859,10 +2209,29 @@ void HTTPServer::handleImpedanceApply(const httplib::Request& req, httplib::Resp
     }
 }
 
-// Ramping test endpoint
-void HTTPServer::handleRampRun(const httplib::Request& req, httplib::Response& res) {
-    if (!rampingTester_) {
-        sendErrorResponse(res, 503, "Ramping tester not initialized");
+// Relay test jobs: the /run endpoints and POST /api/v1/jobs/<kind> share
+// the parsing below; the test itself always runs on the job executor
+HTTPServer::TestJob HTTPServer::makeTestJob(const std::string& kind, const json& body,
+                                        std::function<void()>& cancel) {
+    if (kind == "ramp") return makeRampJob(body, cancel);
+    if (kind == "distance") return makeDistanceJob(body, cancel);
+    if (kind == "overcurrent") return makeOvercurrentJob(body, cancel);
+    if (kind == "differential") return makeDifferentialJob(body, cancel);
+    throw std::invalid_argument("Unknown test kind: " + kind);
+}
+
+// Writer for the stream a test drives; unbound (setters do nothing) without one
+std::shared_ptr<StreamPhasorWriter> HTTPServer::bindTestStream(const std::string& streamId) {
+    if (streamId.empty()) {
+        return std::make_shared<StreamPhasorWriter>();
+    }
+    return std::make_shared<StreamPhasorWriter>(svManager_->bindPhasorWriter(streamId));
+}
+
+void HTTPServer::runTestJob(const std::string& kind, const httplib::Request& req, httplib::Response& res,
+                            bool wait) {
+    if (!testJobs_) {
+        sendErrorResponse(res, 503, "Test job executor not initialized");
         return;
     }
     
@@ -871,71 +2240,124 @@ void HTTPServer::handleRampRun(const httplib::Request& req, httplib::Response& r
         return;
     }
     
+    TestJob job;
+    std::function<void()> cancel;
     try {
         json body = json::parse(req.body);
-        
-        // Parse configuration
-        RampConfig config;
-        config.variable = rampingTester_->parseVariable(body.value("variable", "VOLTAGE_3PH"));
-        config.startValue = body.value("startValue", 0.0);
-        config.endValue = body.value("endValue", 150.0);
-        config.stepSize = body.value("stepSize", 0.1);
-        config.stepDuration = body.value("stepDuration", 0.05);
-        config.monitorTrip = body.value("monitorTrip", true);
-        config.streamId = body.value("streamId", "");
-        
-        // Set up callbacks
-        rampingTester_->setTripFlagGetter([]() {
+        job = makeTestJob(kind, body, cancel);
+    } catch (const json::exception& e) {
+        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
+        return;
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    } catch (const std::runtime_error& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    }
+    if (!job) {
+        sendErrorResponse(res, 503, kind + " tester not initialized");
+        return;
+    }
+    
+    std::string error;
+    const uint64_t id = testJobs_->submit(kind, std::move(job), error, std::move(cancel));
+    if (id == 0) {
+        sendErrorResponse(res, 429, "Failed to queue test: " + error);
+        return;
+    }
+    
+    if (!wait) {
+        sendJsonResponse(res, 202, {
+            {"jobId", id},
+            {"state", "QUEUED"},
+            {"location", "/api/v1/jobs/" + std::to_string(id)}
+        });
+        return;
+    }
+    
+    // Blocking /run endpoints: same response as before the job executor
+    TestJobInfo info;
+    if (!testJobs_->wait(id, info)) {
+        // Retired (or never known) before it could be read back
+        sendErrorResponse(res, 404, "Job not found: " + std::to_string(id));
+        return;
+    }
+    if (info.state == vts::testers::TestJobState::FAILED) {
+        sendErrorResponse(res, 500, kind + " test failed: " + info.error);
+        return;
+    }
+    json response = info.result.is_null() ? json::object() : info.result;
+    response["jobId"] = id;
+    sendJsonResponse(res, 200, response);
+}
+
+// Ramping test endpoint
+void HTTPServer::handleRampRun(const httplib::Request& req, httplib::Response& res) {
+    runTestJob("ramp", req, res, true);
+}
+
+HTTPServer::TestJob HTTPServer::makeRampJob(const json& body, std::function<void()>& cancel) {
+    if (!rampingTester_) {
+        return nullptr;
+    }
+    
+    // Parse configuration
+    RampConfig config;
+    config.variable = rampingTester_->parseVariable(body.value("variable", "VOLTAGE_3PH"));
+    config.startValue = body.value("startValue", 0.0);
+    config.endValue = body.value("endValue", 150.0);
+    config.stepSize = body.value("stepSize", 0.1);
+    config.stepDuration = body.value("stepDuration", 0.05);
+    config.monitorTrip = body.value("monitorTrip", true);
+    config.streamId = body.value("streamId", "");
+    const std::string relay = body.value("relay", "");
+    
+    auto tester = rampingTester_;
+    auto writer = bindTestStream(config.streamId);
+    auto store = results_;
+    auto clock = clock_;
+    cancel = [tester]() { tester->stop(); };
+    
+    return [tester, writer, store, clock, relay, config](TestJobContext& job) -> json {
+        tester->setClock(clock);
+        tester->setTripFlagGetter([]() {
             return vts::isTripFlagSet();
         });
         
-        rampingTester_->setValueSetter([this, config](RampVariable var, double value) {
-            if (config.streamId.empty()) return;
-            
-            // Update stream based on variable type
-            json update;
+        tester->setValueSetter([writer](RampVariable var, double value) {
+            const uint16_t V = StreamPhasorWriter::VoltageA;
+            const uint16_t I = StreamPhasorWriter::CurrentA;
             switch (var) {
-                case RampVariable::VOLTAGE_A:
-                    update["voltage"]["A"]["magnitude"] = value;
-                    break;
-                case RampVariable::VOLTAGE_B:
-                    update["voltage"]["B"]["magnitude"] = value;
-                    break;
-                case RampVariable::VOLTAGE_C:
-                    update["voltage"]["C"]["magnitude"] = value;
-                    break;
+                case RampVariable::VOLTAGE_A: writer->setMagnitude(V, value); break;
+                case RampVariable::VOLTAGE_B: writer->setMagnitude(V + 1, value); break;
+                case RampVariable::VOLTAGE_C: writer->setMagnitude(V + 2, value); break;
                 case RampVariable::VOLTAGE_3PH:
-                    update["voltage"]["A"]["magnitude"] = value;
-                    update["voltage"]["B"]["magnitude"] = value;
-                    update["voltage"]["C"]["magnitude"] = value;
-                    break;
-                case RampVariable::CURRENT_A:
-                    update["current"]["A"]["magnitude"] = value;
-                    break;
-                case RampVariable::CURRENT_B:
-                    update["current"]["B"]["magnitude"] = value;
-                    break;
-                case RampVariable::CURRENT_C:
-                    update["current"]["C"]["magnitude"] = value;
+                    for (uint16_t k = 0; k < 3; ++k) writer->setMagnitude(static_cast<uint16_t>(V + k), value);
                     break;
+                case RampVariable::CURRENT_A: writer->setMagnitude(I, value); break;
+                case RampVariable::CURRENT_B: writer->setMagnitude(I + 1, value); break;
+                case RampVariable::CURRENT_C: writer->setMagnitude(I + 2, value); break;
                 case RampVariable::CURRENT_3PH:
-                    update["current"]["A"]["magnitude"] = value;
-                    update["current"]["B"]["magnitude"] = value;
-                    update["current"]["C"]["magnitude"] = value;
-                    break;
-                case RampVariable::FREQUENCY:
-                    update["frequency"] = value;
+                    for (uint16_t k = 0; k < 3; ++k) writer->setMagnitude(static_cast<uint16_t>(I + k), value);
                     break;
+                case RampVariable::FREQUENCY: writer->setFrequency(value); break;
             }
-            
-            svManager_->updateStream(config.streamId, update);
+            writer->commit();
         });
         
         // Run the ramp test
-        RampResult result = rampingTester_->run(config);
+        RampResult result = tester->run(config, [&job, tester](double value, double progress, bool tripFlag) {
+            if (job.cancelled()) {
+                tester->stop();
+            }
+            job.progress(progress / 100.0, "value " + std::to_string(value) + (tripFlag ? ", tripped" : ""));
+        });
+        if (store && !job.cancelled()) {
+            store->append(relay, job.id(), result);
+        }
         
-        // Return results
-        json response = {
+        return {
             {"pickupValue", result.pickupValue},
             {"dropoffValue", result.dropoffValue},
             {"resetRatio", result.resetRatio},
@@ -944,90 +2366,88 @@ void HTTPServer::handleRampRun(const httplib::Request& req, httplib::Response& r
             {"completed", result.completed},
             {"error", result.error}
         };
-        
-        sendJsonResponse(res, 200, response);
-        
-    } catch (const json::exception& e) {
-        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
-    } catch (const std::exception& e) {
-        sendErrorResponse(res, 500, std::string("Ramping test failed: ") + e.what());
-    }
+    };
 }
 
 // Distance relay test endpoint
 void HTTPServer::handleDistanceRun(const httplib::Request& req, httplib::Response& res) {
-    if (!distanceTester_) {
-        sendErrorResponse(res, 503, "Distance tester not initialized");
-        return;
+    runTestJob("distance", req, res, true);
+}
+
+HTTPServer::TestJob HTTPServer::makeDistanceJob(const json& body, std::function<void()>& cancel) {
+    if (!distanceTester_ || !impedanceCalculator_) {
+        return nullptr;
     }
     
-    if (!svManager_) {
-        sendErrorResponse(res, 503, "SV publisher manager not initialized");
-        return;
+    // Parse test configuration
+    DistanceTestConfig config;
+    
+    // Parse source impedance
+    if (body.contains("source")) {
+        auto source = body["source"];
+        config.source.RS1 = source.value("RS1", 1.0);
+        config.source.XS1 = source.value("XS1", 10.0);
+        config.source.RS0 = source.value("RS0", 3.0);
+        config.source.XS0 = source.value("XS0", 30.0);
+        config.source.Vprefault = source.value("Vprefault", 66395.0);
     }
     
-    try {
-        json body = json::parse(req.body);
-        
-        // Parse test configuration
-        DistanceTestConfig config;
-        
-        // Parse source impedance
-        if (body.contains("source")) {
-            auto source = body["source"];
-            config.source.RS1 = source.value("RS1", 1.0);
-            config.source.XS1 = source.value("XS1", 10.0);
-            config.source.RS0 = source.value("RS0", 3.0);
-            config.source.XS0 = source.value("XS0", 30.0);
-            config.source.Vprefault = source.value("Vprefault", 66395.0);
-        }
-        
-        // Parse test points
-        if (body.contains("points") && body["points"].is_array()) {
-            for (const auto& pt : body["points"]) {
-                DistancePoint point;
-                point.R = pt.value("R", 0.0);
-                point.X = pt.value("X", 0.0);
-                point.faultType = impedanceCalculator_->parseFaultType(pt.value("faultType", "ABC"));
-                point.expectedTime = pt.value("expectedTime", 0.0);
-                point.label = pt.value("label", "");
-                config.points.push_back(point);
-            }
+    // Parse test points
+    if (body.contains("points") && body["points"].is_array()) {
+        for (const auto& pt : body["points"]) {
+            DistancePoint point;
+            point.R = pt.value("R", 0.0);
+            point.X = pt.value("X", 0.0);
+            point.faultType = impedanceCalculator_->parseFaultType(pt.value("faultType", "ABC"));
+            point.expectedTime = pt.value("expectedTime", 0.0);
+            point.label = pt.value("label", "");
+            config.points.push_back(point);
         }
-        
-        // Parse timing parameters
-        config.prefaultDuration = body.value("prefaultDuration", 1.0);
-        config.faultDuration = body.value("faultDuration", 5.0);
-        config.timeTolerance = body.value("timeTolerance", 0.05);
-        config.stopOnFirstFailure = body.value("stopOnFirstFailure", false);
-        config.streamId = body.value("streamId", "");
-        
-        // Set up callbacks
-        distanceTester_->setTripFlagGetter([]() {
+    }
+    
+    // Parse timing parameters
+    config.prefaultDuration = body.value("prefaultDuration", 1.0);
+    config.faultDuration = body.value("faultDuration", 5.0);
+    config.timeTolerance = body.value("timeTolerance", 0.05);
+    config.stopOnFirstFailure = body.value("stopOnFirstFailure", false);
+    config.streamId = body.value("streamId", "");
+    const std::string relay = body.value("relay", "");
+    
+    auto tester = distanceTester_;
+    auto writer = bindTestStream(config.streamId);
+    auto store = results_;
+    auto clock = clock_;
+    cancel = [tester]() { tester->stop(); };
+    
+    return [tester, writer, store, clock, relay, config](TestJobContext& job) -> json {
+        tester->setClock(clock);
+        tester->setTripFlagGetter([]() {
             return vts::isTripFlagSet();
         });
         
-        distanceTester_->setPhasorSetter([this, config](const PhasorState& state) {
-            if (config.streamId.empty()) return;
-            
-            json update = {
-                {"voltage", {
-                    {"A", {{"magnitude", std::abs(state.voltage.A)}, {"angle", std::arg(state.voltage.A) * 180.0 / M_PI}}},
-                    {"B", {{"magnitude", std::abs(state.voltage.B)}, {"angle", std::arg(state.voltage.B) * 180.0 / M_PI}}},
-                    {"C", {{"magnitude", std::abs(state.voltage.C)}, {"angle", std::arg(state.voltage.C) * 180.0 / M_PI}}}
-                }},
-                {"current", {
-                    {"A", {{"magnitude", std::abs(state.current.A)}, {"angle", std::arg(state.current.A) * 180.0 / M_PI}}},
-                    {"B", {{"magnitude", std::abs(state.current.B)}, {"angle", std::arg(state.current.B) * 180.0 / M_PI}}},
-                    {"C", {{"magnitude", std::abs(state.current.C)}, {"angle", std::arg(state.current.C) * 180.0 / M_PI}}}
-                }}
-            };
-            
-            svManager_->updateStream(config.streamId, update);
+        tester->setPhasorSetter([writer](const PhasorState& state) {
+            const std::complex<double> voltage[3] = {state.voltage.A, state.voltage.B, state.voltage.C};
+            const std::complex<double> current[3] = {state.current.A, state.current.B, state.current.C};
+            for (uint16_t k = 0; k < 3; ++k) {
+                writer->setPhasor(static_cast<uint16_t>(StreamPhasorWriter::VoltageA + k),
+                                  std::abs(voltage[k]), std::arg(voltage[k]) * 180.0 / M_PI);
+                writer->setPhasor(static_cast<uint16_t>(StreamPhasorWriter::CurrentA + k),
+                                  std::abs(current[k]), std::arg(current[k]) * 180.0 / M_PI);
+            }
+            writer->commit();
         });
         
         // Run the distance test
-        auto results = distanceTester_->run(config);
+        auto results = tester->run(config, [&job, tester](int index, int total, const DistancePoint& point) {
+            if (job.cancelled()) {
+                tester->stop();
+            }
+            job.progress(static_cast<double>(index) / total,
+                         "Point " + std::to_string(index + 1) + "/" + std::to_string(total) + " " + point.label);
+        });
+        if (store && !job.cancelled()) {
+            store->append(relay, job.id(), results);
+        }
         
         // Format results
         json resultsJson = json::array();
@@ -1042,86 +2462,84 @@ void HTTPServer::handleDistanceRun(const httplib::Request& req, httplib::Respons
             });
         }
         
-        json response = {
+        return {
             {"results", resultsJson},
             {"totalPoints", results.size()},
             {"passed", std::all_of(results.begin(), results.end(), 
                 [](const DistanceResult& r) { return r.passed; })}
         };
-        
-        sendJsonResponse(res, 200, response);
-        
-    } catch (const json::exception& e) {
-        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
-    } catch (const std::exception& e) {
-        sendErrorResponse(res, 500, std::string("Distance test failed: ") + e.what());
-    }
+    };
 }
 
 // Overcurrent test endpoint
 void HTTPServer::handleOvercurrentRun(const httplib::Request& req, httplib::Response& res) {
+    runTestJob("overcurrent", req, res, true);
+}
+
+HTTPServer::TestJob HTTPServer::makeOvercurrentJob(const json& body, std::function<void()>& cancel) {
     if (!overcurrentTester_) {
-        sendErrorResponse(res, 503, "Overcurrent tester not initialized");
-        return;
+        return nullptr;
     }
     
-    if (!svManager_) {
-        sendErrorResponse(res, 503, "SV publisher manager not initialized");
-        return;
+    // Parse overcurrent settings
+    OCTestConfig config;
+    
+    if (body.contains("settings")) {
+        auto settings = body["settings"];
+        config.settings.pickupCurrent = settings.value("pickupCurrent", 100.0);
+        config.settings.TMS = settings.value("TMS", 0.1);
+        config.settings.curve = overcurrentTester_->parseCurve(settings.value("curve", "STANDARD_INVERSE"));
     }
     
-    try {
-        json body = json::parse(req.body);
-        
-        // Parse overcurrent settings
-        OCTestConfig config;
-        
-        if (body.contains("settings")) {
-            auto settings = body["settings"];
-            config.settings.pickupCurrent = settings.value("pickupCurrent", 100.0);
-            config.settings.TMS = settings.value("TMS", 0.1);
-            config.settings.curve = overcurrentTester_->parseCurve(settings.value("curve", "STANDARD_INVERSE"));
-        }
-        
-        // Parse test points
-        if (body.contains("points") && body["points"].is_array()) {
-            for (const auto& pt : body["points"]) {
-                OCPoint point;
-                point.currentMultiple = pt.value("currentMultiple", 2.0);
-                point.expectedTime = pt.value("expectedTime", 0.0);
-                point.label = pt.value("label", "");
-                config.points.push_back(point);
-            }
+    // Parse test points
+    if (body.contains("points") && body["points"].is_array()) {
+        for (const auto& pt : body["points"]) {
+            OCPoint point;
+            point.currentMultiple = pt.value("currentMultiple", 2.0);
+            point.expectedTime = pt.value("expectedTime", 0.0);
+            point.label = pt.value("label", "");
+            config.points.push_back(point);
         }
-        
-        // Parse tolerance
-        config.timeTolerance = body.value("timeTolerance", 5.0);
-        config.toleranceIsPercent = body.value("toleranceIsPercent", true);
-        config.maxTestDuration = body.value("maxTestDuration", 60.0);
-        config.stopOnFirstFailure = body.value("stopOnFirstFailure", false);
-        config.streamId = body.value("streamId", "");
-        
-        // Set up callbacks
-        overcurrentTester_->setTripFlagGetter([]() {
+    }
+    
+    // Parse tolerance
+    config.timeTolerance = body.value("timeTolerance", 5.0);
+    config.toleranceIsPercent = body.value("toleranceIsPercent", true);
+    config.maxTestDuration = body.value("maxTestDuration", 60.0);
+    config.stopOnFirstFailure = body.value("stopOnFirstFailure", false);
+    config.streamId = body.value("streamId", "");
+    const std::string relay = body.value("relay", "");
+    
+    auto tester = overcurrentTester_;
+    auto writer = bindTestStream(config.streamId);
+    auto store = results_;
+    auto clock = clock_;
+    cancel = [tester]() { tester->stop(); };
+    
+    return [tester, writer, store, clock, relay, config](TestJobContext& job) -> json {
+        tester->setClock(clock);
+        tester->setTripFlagGetter([]() {
             return vts::isTripFlagSet();
         });
         
-        overcurrentTester_->setCurrentSetter([this, config](double current) {
-            if (config.streamId.empty()) return;
-            
-            json update = {
-                {"current", {
-                    {"A", {{"magnitude", current}}},
-                    {"B", {{"magnitude", current}}},
-                    {"C", {{"magnitude", current}}}
-                }}
-            };
-            
-            svManager_->updateStream(config.streamId, update);
+        tester->setCurrentSetter([writer](double current) {
+            for (uint16_t k = 0; k < 3; ++k) {
+                writer->setMagnitude(static_cast<uint16_t>(StreamPhasorWriter::CurrentA + k), current);
+            }
+            writer->commit();
         });
         
         // Run the overcurrent test
-        auto results = overcurrentTester_->run(config);
+        auto results = tester->run(config, [&job, tester](int index, int total, const OCPoint& point) {
+            if (job.cancelled()) {
+                tester->stop();
+            }
+            job.progress(static_cast<double>(index) / total,
+                         "Point " + std::to_string(index + 1) + "/" + std::to_string(total) + " " + point.label);
+        });
+        if (store && !job.cancelled()) {
+            store->append(relay, job.id(), results);
+        }
         
         // Format results
         json resultsJson = json::array();
@@ -1137,7 +2555,7 @@ void HTTPServer::handleOvercurrentRun(const httplib::Request& req, httplib::Resp
             });
         }
         
-        json response = {
+        return {
             {"results", resultsJson},
             {"totalPoints", results.size()},
             {"passed", std::all_of(results.begin(), results.end(), 
@@ -1145,91 +2563,80 @@ void HTTPServer::handleOvercurrentRun(const httplib::Request& req, httplib::Resp
             {"settings", {
                 {"pickupCurrent", config.settings.pickupCurrent},
                 {"TMS", config.settings.TMS},
-                {"curve", overcurrentTester_->curveToString(config.settings.curve)}
+                {"curve", tester->curveToString(config.settings.curve)}
             }}
         };
-        
-        sendJsonResponse(res, 200, response);
-        
-    } catch (const json::exception& e) {
-        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
-    } catch (const std::exception& e) {
-        sendErrorResponse(res, 500, std::string("Overcurrent test failed: ") + e.what());
-    }
+    };
 }
 
 // Differential test endpoint
 void HTTPServer::handleDifferentialRun(const httplib::Request& req, httplib::Response& res) {
+    runTestJob("differential", req, res, true);
+}
+
+HTTPServer::TestJob HTTPServer::makeDifferentialJob(const json& body, std::function<void()>& cancel) {
     if (!differentialTester_) {
-        sendErrorResponse(res, 503, "Differential tester not initialized");
-        return;
+        return nullptr;
     }
     
-    if (!svManager_) {
-        sendErrorResponse(res, 503, "SV publisher manager not initialized");
-        return;
+    // Parse differential test configuration
+    DifferentialTestConfig config;
+    
+    // Parse test points
+    if (body.contains("points") && body["points"].is_array()) {
+        for (const auto& pt : body["points"]) {
+            DifferentialPoint point;
+            point.Ir = pt.value("Ir", 0.0);
+            point.Id = pt.value("Id", 0.0);
+            point.expectedTime = pt.value("expectedTime", 0.0);
+            point.label = pt.value("label", "");
+            config.points.push_back(point);
+        }
     }
     
-    try {
-        json body = json::parse(req.body);
-        
-        // Parse differential test configuration
-        DifferentialTestConfig config;
-        
-        // Parse test points
-        if (body.contains("points") && body["points"].is_array()) {
-            for (const auto& pt : body["points"]) {
-                DifferentialPoint point;
-                point.Ir = pt.value("Ir", 0.0);
-                point.Id = pt.value("Id", 0.0);
-                point.expectedTime = pt.value("expectedTime", 0.0);
-                point.label = pt.value("label", "");
-                config.points.push_back(point);
-            }
-        }
-        
-        // Parse configuration
-        config.timeTolerance = body.value("timeTolerance", 0.05);
-        config.maxTestDuration = body.value("maxTestDuration", 5.0);
-        config.stopOnFirstFailure = body.value("stopOnFirstFailure", false);
-        config.stream1Id = body.value("stream1Id", "");
-        config.stream2Id = body.value("stream2Id", "");
-        
-        // Set up callbacks
-        differentialTester_->setTripFlagGetter([]() {
+    // Parse configuration
+    config.timeTolerance = body.value("timeTolerance", 0.05);
+    config.maxTestDuration = body.value("maxTestDuration", 5.0);
+    config.stopOnFirstFailure = body.value("stopOnFirstFailure", false);
+    config.stream1Id = body.value("stream1Id", "");
+    config.stream2Id = body.value("stream2Id", "");
+    const std::string relay = body.value("relay", "");
+    
+    auto tester = differentialTester_;
+    auto side1 = bindTestStream(config.stream1Id);
+    auto side2 = bindTestStream(config.stream2Id);
+    auto store = results_;
+    auto clock = clock_;
+    cancel = [tester]() { tester->stop(); };
+    
+    return [tester, side1, side2, store, clock, relay, config](TestJobContext& job) -> json {
+        tester->setClock(clock);
+        tester->setTripFlagGetter([]() {
             return vts::isTripFlagSet();
         });
         
-        differentialTester_->setSide1CurrentSetter([this, config](double current) {
-            if (config.stream1Id.empty()) return;
-            
-            json update = {
-                {"current", {
-                    {"A", {{"magnitude", current}}},
-                    {"B", {{"magnitude", current}}},
-                    {"C", {{"magnitude", current}}}
-                }}
-            };
-            
-            svManager_->updateStream(config.stream1Id, update);
-        });
-        
-        differentialTester_->setSide2CurrentSetter([this, config](double current) {
-            if (config.stream2Id.empty()) return;
-            
-            json update = {
-                {"current", {
-                    {"A", {{"magnitude", current}}},
-                    {"B", {{"magnitude", current}}},
-                    {"C", {{"magnitude", current}}}
-                }}
+        auto currentSetter = [](std::shared_ptr<StreamPhasorWriter> writer) {
+            return [writer](double current) {
+                for (uint16_t k = 0; k < 3; ++k) {
+                    writer->setMagnitude(static_cast<uint16_t>(StreamPhasorWriter::CurrentA + k), current);
+                }
+                writer->commit();
             };
-            
-            svManager_->updateStream(config.stream2Id, update);
-        });
+        };
+        tester->setSide1CurrentSetter(currentSetter(side1));
+        tester->setSide2CurrentSetter(currentSetter(side2));
         
         // Run the differential test
-        auto results = differentialTester_->run(config);
+        auto results = tester->run(config, [&job, tester](int index, int total, const DifferentialPoint& point) {
+            if (job.cancelled()) {
+                tester->stop();
+            }
+            job.progress(static_cast<double>(index) / total,
+                         "Point " + std::to_string(index + 1) + "/" + std::to_string(total) + " " + point.label);
+        });
+        if (store && !job.cancelled()) {
+            store->append(relay, job.id(), results);
+        }
         
         // Format results
         json resultsJson = json::array();
@@ -1247,20 +2654,174 @@ void HTTPServer::handleDifferentialRun(const httplib::Request& req, httplib::Res
             });
         }
         
-        json response = {
+        return {
             {"results", resultsJson},
             {"totalPoints", results.size()},
             {"passed", std::all_of(results.begin(), results.end(), 
                 [](const DifferentialResult& r) { return r.passed; })}
         };
-        
-        sendJsonResponse(res, 200, response);
-        
-    } catch (const json::exception& e) {
-        sendErrorResponse(res, 400, std::string("Invalid JSON: ") + e.what());
-    } catch (const std::exception& e) {
-        sendErrorResponse(res, 500, std::string("Differential test failed: ") + e.what());
+    };
+}
+
+// Test job endpoints
+void HTTPServer::handleJobSubmit(const httplib::Request& req, httplib::Response& res) {
+    runTestJob(req.matches[1], req, res, false);
+}
+
+void HTTPServer::handleJobList(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!testJobs_) {
+        sendErrorResponse(res, 503, "Test job executor not initialized");
+        return;
+    }
+    
+    json jobs = json::array();
+    for (const TestJobInfo& info : testJobs_->list()) {
+        jobs.push_back(info.toJson(false));
+    }
+    sendJsonResponse(res, 200, {
+        {"jobs", jobs},
+        {"queued", testJobs_->queued()}
+    });
+}
+
+void HTTPServer::handleJobGet(const httplib::Request& req, httplib::Response& res) {
+    if (!testJobs_) {
+        sendErrorResponse(res, 503, "Test job executor not initialized");
+        return;
+    }
+    
+    TestJobInfo info;
+    if (!testJobs_->get(std::stoull(req.matches[1]), info)) {
+        sendErrorResponse(res, 404, "Job not found: " + std::string(req.matches[1]));
+        return;
+    }
+    sendJsonResponse(res, 200, info.toJson());
+}
+
+void HTTPServer::handleJobCancel(const httplib::Request& req, httplib::Response& res) {
+    if (!testJobs_) {
+        sendErrorResponse(res, 503, "Test job executor not initialized");
+        return;
+    }
+    
+    const uint64_t id = std::stoull(req.matches[1]);
+    if (!testJobs_->cancel(id)) {
+        TestJobInfo info;
+        if (!testJobs_->get(id, info)) {
+            sendErrorResponse(res, 404, "Job not found: " + std::string(req.matches[1]));
+        } else {
+            sendErrorResponse(res, 409, "Job already " + vts::testers::TestJobExecutor::stateToString(info.state));
+        }
+        return;
+    }
+    sendJsonResponse(res, 200, {{"message", "Job cancelled"}, {"jobId", id}});
+}
+
+void HTTPServer::parseResultQuery(const httplib::Request& req, ResultQuery& query) {
+    query.relay = req.get_param_value("relay");
+    if (req.has_param("kind")) {
+        vts::testers::ResultKind kind;
+        if (!ResultStore::parseKind(req.get_param_value("kind"), kind)) {
+            throw std::invalid_argument("Unknown kind: " + req.get_param_value("kind"));
+        }
+        query.kind = static_cast<int>(kind);
+    }
+    if (req.has_param("passed")) {
+        const std::string passed = req.get_param_value("passed");
+        if (passed != "true" && passed != "false") {
+            throw std::invalid_argument("'passed' must be true or false");
+        }
+        query.passed = passed == "true" ? 1 : 0;
+    }
+    
+    auto unixNs = [&req](const char* name) {
+        try {
+            return static_cast<int64_t>(std::llround(std::stod(req.get_param_value(name)) * 1e9));
+        } catch (const std::exception&) {
+            throw std::invalid_argument(std::string("'") + name + "' must be a Unix time in seconds");
+        }
+    };
+    if (req.has_param("from")) {
+        query.fromNs = unixNs("from");
+    }
+    if (req.has_param("to")) {
+        query.toNs = unixNs("to");
+    }
+    if (req.has_param("limit")) {
+        try {
+            query.limit = std::min<size_t>(std::stoul(req.get_param_value("limit")), ResultStore_MaxLimit);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("'limit' must be a non-negative integer");
+        }
+    }
+}
+
+// Stored results matching the query, newest first
+void HTTPServer::handleResultsQuery(const httplib::Request& req, httplib::Response& res) {
+    if (!results_) {
+        sendErrorResponse(res, 503, "Result store not initialized");
+        return;
+    }
+    
+    ResultQuery query;
+    try {
+        parseResultQuery(req, query);
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    }
+    
+    uint64_t total = 0;
+    json records = json::array();
+    for (const ResultRecord& record : results_->query(query, total)) {
+        records.push_back(record.toJson());
+    }
+    sendJsonResponse(res, 200, {
+        {"total", total},
+        {"returned", records.size()},
+        {"records", records}
+    });
+}
+
+// Trip-time distribution per relay and test kind over the matching results
+void HTTPServer::handleResultsAggregate(const httplib::Request& req, httplib::Response& res) {
+    if (!results_) {
+        sendErrorResponse(res, 503, "Result store not initialized");
+        return;
+    }
+    
+    ResultQuery query;
+    double binWidth = ResultStore_HistogramBinS;
+    try {
+        parseResultQuery(req, query);
+        if (req.has_param("binWidth")) {
+            try {
+                binWidth = std::stod(req.get_param_value("binWidth"));
+            } catch (const std::exception&) {
+                binWidth = 0.0;
+            }
+            if (!(binWidth > 0.0)) {
+                throw std::invalid_argument("'binWidth' must be a positive number of seconds");
+            }
+        }
+    } catch (const std::invalid_argument& e) {
+        sendErrorResponse(res, 400, e.what());
+        return;
+    }
+    
+    json groups = json::array();
+    for (const ResultAggregate& group : results_->aggregate(query, binWidth)) {
+        groups.push_back(group.toJson());
+    }
+    sendJsonResponse(res, 200, {{"groups", groups}});
+}
+
+void HTTPServer::handleResultsStatus(const httplib::Request& /*req*/, httplib::Response& res) {
+    if (!results_) {
+        sendErrorResponse(res, 503, "Result store not initialized");
+        return;
     }
+    sendJsonResponse(res, 200, results_->status().toJson());
 }
 
 // Utility functions
@@ -1,11 +1,22 @@
 #include "ws_server.hpp"
+#include "sv_publisher_manager.hpp"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 
 using websocketpp::lib::placeholders::_1;
 using websocketpp::lib::placeholders::_2;
 using websocketpp::lib::bind;
 
+namespace {
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
 WSServer::WSServer(int port)
     : port_(port), running_(false) {
     
@@ -21,6 +32,11 @@ WSServer::WSServer(int port)
     server_.set_close_handler(bind(&WSServer::onClose, this, _1));
     server_.set_message_handler(bind(&WSServer::onMessage, this, _1, _2));
     
+    // Control messages are small and latency-bound: no Nagle batching
+    server_.set_socket_init_handler([](connection_hdl, websocketpp::lib::asio::ip::tcp::socket& socket) {
+        socket.set_option(websocketpp::lib::asio::ip::tcp::no_delay(true));
+    });
+    
     // Allow connection reuse
     server_.set_reuse_addr(true);
 }
@@ -103,7 +119,10 @@ void WSServer::onOpen(connection_hdl hdl) {
                 "analyzer/phasors",
                 "analyzer/waveforms",
                 "analyzer/harmonics",
+                "analyzer/groups",
+                "analyzer/pq",
                 "sequence/progress",
+                "tests/jobs",
                 "goose/events",
                 "stream/status"
             }}
@@ -126,11 +145,27 @@ void WSServer::onClose(connection_hdl hdl) {
 }
 
 void WSServer::onMessage(connection_hdl hdl, server::message_ptr msg) {
+    const uint64_t receivedNs = steadyNowNs();
+    
+    // Binary frames are control messages and skip JSON parsing entirely
+    if (msg->get_opcode() == websocketpp::frame::opcode::binary) {
+        const std::string& payload = msg->get_payload();
+        std::string error;
+        const bool decoded = decodeControlBinary(reinterpret_cast<const uint8_t*>(payload.data()),
+                                                 payload.size(), controlBatch_, error);
+        handleControl(hdl, decoded, error, receivedNs);
+        return;
+    }
+    
     try {
         json payload = json::parse(msg->get_payload());
         std::string msgType = payload.value("type", "");
         
-        if (msgType == "subscribe") {
+        if (msgType == "control") {
+            std::string error;
+            const bool decoded = decodeControlJson(payload, controlBatch_, error);
+            handleControl(hdl, decoded, error, receivedNs);
+        } else if (msgType == "subscribe") {
             handleSubscribe(hdl, payload);
         } else if (msgType == "unsubscribe") {
             handleUnsubscribe(hdl, payload);
@@ -228,6 +263,35 @@ void WSServer::handlePing(connection_hdl hdl) {
     }
 }
 
+void WSServer::handleControl(connection_hdl hdl, bool decoded, const std::string& error, uint64_t receivedNs) {
+    size_t posted = 0;
+    unknownStreams_.clear();
+    controlErrors_.clear();
+    if (decoded && svManager_) {
+        posted = svManager_->postControl(controlBatch_, receivedNs, &unknownStreams_, &controlErrors_);
+        // Silent on success unless asked: the reply would cost more than the update
+        if (unknownStreams_.empty() && controlErrors_.empty() && !controlBatch_.ack) {
+            return;
+        }
+    }
+    
+    json response;
+    if (!svManager_) {
+        response = {{"type", "error"}, {"message", "Control channel not available"}};
+    } else if (!decoded) {
+        response = {{"type", "error"}, {"message", "Invalid control message: " + error}};
+    } else {
+        response = {{"type", "control-ack"}, {"posted", posted}, {"unknown", unknownStreams_},
+                    {"errors", controlErrors_}};
+    }
+    
+    try {
+        server_.send(hdl, response.dump(), websocketpp::frame::opcode::text);
+    } catch (const std::exception& e) {
+        std::cerr << "Error sending control reply: " << e.what() << std::endl;
+    }
+}
+
 void WSServer::broadcast(Topic topic, const json& data) {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -292,7 +356,10 @@ Topic WSServer::stringToTopic(const std::string& topicStr) const {
     if (topicStr == "analyzer/phasors") return Topic::ANALYZER_PHASORS;
     if (topicStr == "analyzer/waveforms") return Topic::ANALYZER_WAVEFORMS;
     if (topicStr == "analyzer/harmonics") return Topic::ANALYZER_HARMONICS;
+    if (topicStr == "analyzer/groups") return Topic::ANALYZER_GROUPS;
+    if (topicStr == "analyzer/pq") return Topic::ANALYZER_PQ;
     if (topicStr == "sequence/progress") return Topic::SEQUENCE_PROGRESS;
+    if (topicStr == "tests/jobs") return Topic::TEST_JOBS;
     if (topicStr == "goose/events") return Topic::GOOSE_EVENTS;
     if (topicStr == "stream/status") return Topic::STREAM_STATUS;
     
@@ -305,7 +372,10 @@ std::string WSServer::topicToString(Topic topic) const {
         case Topic::ANALYZER_PHASORS: return "analyzer/phasors";
         case Topic::ANALYZER_WAVEFORMS: return "analyzer/waveforms";
         case Topic::ANALYZER_HARMONICS: return "analyzer/harmonics";
+        case Topic::ANALYZER_GROUPS: return "analyzer/groups";
+        case Topic::ANALYZER_PQ: return "analyzer/pq";
         case Topic::SEQUENCE_PROGRESS: return "sequence/progress";
+        case Topic::TEST_JOBS: return "tests/jobs";
         case Topic::GOOSE_EVENTS: return "goose/events";
         case Topic::STREAM_STATUS: return "stream/status";
         default: return "unknown";
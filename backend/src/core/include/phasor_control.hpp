@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief New magnitude and/or angle for one channel of a stream
+ */
+struct PhasorDelta {
+    enum : uint8_t { Magnitude = 0x01, Angle = 0x02 };
+
+    uint16_t channel = 0;
+    uint8_t fields = 0;         // Which of the values below apply
+    double magnitude = 0.0;
+    double angle = 0.0;         // Degrees
+};
+
+/**
+ * @brief Everything one control message asks of one stream
+ */
+struct StreamControlUpdate {
+    std::string streamId;
+    std::vector<PhasorDelta> deltas;
+    bool hasFrequency = false;
+    double frequency = 0.0;
+    double rocof = 0.0;         // Hz/s, 0 = step
+};
+
+/**
+ * @brief Decoded control message, reused across messages
+ *
+ * clear() keeps the updates (and their delta vectors) allocated, so a
+ * steady stream of similar messages decodes without allocating.
+ */
+struct ControlBatch {
+    std::vector<StreamControlUpdate> updates;
+    size_t count = 0;           // Valid entries of updates
+    bool ack = false;           // Client wants a reply even on success
+
+    void clear() {
+        count = 0;
+        ack = false;
+    }
+
+    StreamControlUpdate& add() {
+        if (count == updates.size()) {
+            updates.emplace_back();
+        }
+        StreamControlUpdate& update = updates[count++];
+        update.streamId.clear();
+        update.deltas.clear();
+        update.hasFrequency = false;
+        update.frequency = 0.0;
+        update.rocof = 0.0;
+        return update;
+    }
+};
+
+/**
+ * @brief Decode a binary control message (all fields little-endian)
+ *
+ *   u8[2] 'V' 'C'   u8 version (1)   u8 flags (bit 0: ack)   u16 streams
+ *   per stream:
+ *     u8 idLength, id bytes   u8 flags (bit 0: frequency)   u16 deltas
+ *     [f64 frequency, f64 rocof]
+ *     per delta: u8 channel, u8 fields, f32 magnitude, f32 angle
+ *
+ * @return false with `error` set on a malformed message; `batch` is then
+ *         partially filled and must not be applied
+ */
+bool decodeControlBinary(const uint8_t* data, size_t length, ControlBatch& batch, std::string& error);
+
+/**
+ * @brief Decode a JSON control message
+ *
+ *   {"type": "control", "ack": false, "streams": [
+ *     {"id": "...", "freq": 50.2, "rocof": 1.0,
+ *      "phasors": [{"ch": 0, "mag": 100.0, "angle": -120.0}, {"name": "V-A", "angle": 0}]}]}
+ *
+ * Channels are addressed by index ("ch") or 9-2LE name ("name").
+ */
+bool decodeControlJson(const nlohmann::json& message, ControlBatch& batch, std::string& error);
+
+/**
+ * @brief Index of a 9-2LE channel name (I-A .. V-N), -1 if unknown
+ */
+int channelIndexByName(const std::string& name);
+
+/**
+ * @brief Encode the binary form (client side and tests)
+ */
+std::vector<uint8_t> encodeControlBinary(const StreamControlUpdate* updates, size_t count, bool ack = false);
@@ -2,8 +2,14 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include "compat.hpp"  // Must include first for platform detection
+#include "clock.hpp"
+#include "frame_loopback.hpp"
+#include "phase_oscillator.hpp"
+#include "phasor_control.hpp"
+#include "time_source.hpp"
 
 #ifdef __APPLE__
 #include "bpf_macos.hpp"
@@ -33,6 +39,28 @@ struct SVConfig {
     std::string filePath; // for COMTRADE/CSV
 };
 
+class ImpairmentStage;
+struct ControlChannel;
+
+/**
+ * @brief Per-sample waveform that replaces phasor synthesis while attached
+ *
+ * Values are in the same units as Phasor::magnitude (instantaneous, not
+ * RMS), in the stream's channel order: amperes for the first four channels
+ * of each group of eight and volts for the rest, published with the 9-2LE
+ * scaling (1 mA, 10 mV per LSB).
+ */
+class SampleSource {
+public:
+    virtual ~SampleSource() = default;
+
+    /**
+     * @brief Write the next sample of every channel
+     * @return false once the waveform has ended (nothing written)
+     */
+    virtual bool next(double* out, size_t channels) = 0;
+};
+
 struct Phasor {
     double magnitude;
     double angle;
@@ -40,7 +68,17 @@ struct Phasor {
 
 class SVPublisherInstance {
 public:
-    SVPublisherInstance(const std::string& id, const SVConfig& config);
+    // With a loopback, frames go to it and no raw socket is opened; the clock
+    // times the impairment stage (wall clock when null). With a time source,
+    // tick() sends every sample due on the reference, smpCnt 0 on its whole
+    // second and smpSynch its sync state. Without one, a virtual clock is
+    // paced the same way with smpSynch 0, so a stream sends sampleRate frames
+    // per virtual second whatever the tick period; on the wall clock, one
+    // sample per tick, smpSynch 0
+    SVPublisherInstance(const std::string& id, const SVConfig& config,
+                        std::shared_ptr<FrameLoopback> loopback = nullptr,
+                        std::shared_ptr<Clock> clock = nullptr,
+                        std::shared_ptr<TimeSource> timeSource = nullptr);
     ~SVPublisherInstance();
 
     // Delete copy constructor and copy assignment (instance owns resources)
@@ -60,17 +98,47 @@ public:
     const SVConfig& getConfig() const { return config_; }
     void setConfig(const SVConfig& config);
 
-    // Phasor updates (for manual mode)
+    // Phasor updates (for manual mode); angle changes step the phase, the
+    // waveform is otherwise continuous
     void setPhasors(const std::vector<Phasor>& phasors);
     const std::vector<Phasor>& getPhasors() const { return phasors_; }
 
+    // Control-channel updates, callable from any thread without a lock:
+    // merged into the latest pending state and applied by the next tick(),
+    // so a burst of updates costs the publisher one change per tick. Deltas
+    // only address the stream's existing channels (setPhasors() changes
+    // the count): with any beyond it nothing is posted, the reason goes to
+    // error and false is returned
+    bool postControl(const StreamControlUpdate& update, uint64_t receivedNs, std::string* error = nullptr);
+    int64_t lastControlLatencyNs() const;   // Receipt to apply, -1 before the first
+
+    // Time-domain waveform (e.g. a fault transient); nullptr returns to the
+    // phasors, as does the source running out
+    void setSampleSource(std::shared_ptr<SampleSource> source);
+    bool hasSampleSource() const { return sampleSource_ != nullptr; }
+
+    // Signal frequency: jumps (rocof 0) or ramps at rocof Hz/s, phase-continuous
+    void setFrequency(double hz, double rocofHzPerS = 0.0);
+    double getFrequency() const;
+
     // Harmonics (for manual mode)
-    void setHarmonics(const nlohmann::json& harmonics);
+    void setHarmonics(nlohmann::json harmonics);
     const nlohmann::json& getHarmonics() const { return harmonics_; }
 
+    // Bulk snapshot this stream last switched to (0 = none)
+    void setSnapshotVersion(uint64_t version) { snapshotVersion_ = version; }
+    uint64_t getSnapshotVersion() const { return snapshotVersion_; }
+    uint32_t getSampleCounter() const { return sampleCounter_; }
+    uint8_t getSmpSynch() const { return smpSynch_; }
+    uint64_t getRealignments() const { return realignments_; }
+
     // Tick function
     void tick();
 
+    // Network impairment between frame building and the socket
+    ImpairmentStage& impairment() { return *impairment_; }
+    const ImpairmentStage& impairment() const { return *impairment_; }
+
     // Serialization
     nlohmann::json toJson() const;
 
@@ -83,6 +151,19 @@ private:
     std::vector<Phasor> phasors_;
     nlohmann::json harmonics_;
     uint32_t sampleCounter_;
+    uint64_t snapshotVersion_ = 0;
+    std::vector<PhaseOscillator> oscillators_;  // One per phasor, at magnitude 1
+    std::unique_ptr<ImpairmentStage> impairment_;
+    std::shared_ptr<SampleSource> sampleSource_;
+    std::vector<double> sourceValues_;  // One tick of sampleSource_, kept across ticks
+    std::unique_ptr<ControlChannel> control_;
+    std::shared_ptr<FrameLoopback> loopback_;
+    std::shared_ptr<Clock> clock_;
+    std::shared_ptr<TimeSource> timeSource_;
+    uint64_t nextSample_ = 0;           // Reference sample index: second * rate + smpCnt
+    bool aligned_ = false;              // nextSample_ follows the reference
+    uint64_t realignments_ = 0;         // Fell behind/ahead past SV_MaxCatchUpMs
+    uint8_t smpSynch_ = 0;
     
 #ifdef __APPLE__
     vts::platform::BPFSocket* bpfSocket_;  // BPF socket for macOS
@@ -93,7 +174,13 @@ private:
     int rawSocket_;  // Linux raw socket fd, BPF fd on macOS, or Npcap handle on Windows
 
     void sendSVPacket();
-    std::vector<int16_t> generateSamples();
+    void sendDueSamples();
+    void alignOscillators(uint32_t smpCnt);
+    void transmit(const uint8_t* frame, size_t length);
+    std::vector<int32_t> generateSamples();
+    void resetOscillators();
+    void applyPhasors(const std::vector<Phasor>& phasors);
+    void applyControl();
     void initRawSocket();
     void closeRawSocket();
 };
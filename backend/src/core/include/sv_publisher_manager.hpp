@@ -5,6 +5,58 @@
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include "sv_publisher_instance.hpp"
+#include "rcu_cell.hpp"
+#include "rt_selftest.hpp"
+
+/**
+ * @brief One stream's share of a bulk update, parsed and validated off-lock
+ */
+struct StreamBulkUpdate {
+    std::string streamId;
+    bool hasPhasors = false;            // "phasors": full replacement
+    std::vector<Phasor> phasors;        // Also scratch for merging `channels`
+    std::vector<PhasorDelta> channels;  // "channels": changes by 9-2LE name
+    bool hasFrequency = false;
+    double frequency = 0.0;
+    double rocof = 0.0;
+    bool hasHarmonics = false;
+    nlohmann::json harmonics;
+    uint32_t appliedSmpCnt = 0;         // Set by applyBulk: first sample with the new values
+};
+
+struct BulkUpdate {
+    std::vector<StreamBulkUpdate> streams;
+};
+
+/**
+ * @brief Phasor writer bound to one stream, for tester value setters
+ *
+ * The stream is looked up once, when the test is set up; each commit()
+ * posts the staged channel changes on the stream's control channel, the
+ * same lock-free path as WebSocket control, applied on the next tick.
+ * Channels are in 9-2LE order (I-A .. I-N, then V-A .. V-N).
+ */
+class StreamPhasorWriter {
+public:
+    static constexpr uint16_t CurrentA = 0;
+    static constexpr uint16_t VoltageA = 4;
+
+    StreamPhasorWriter() = default;
+    explicit StreamPhasorWriter(std::shared_ptr<SVPublisherInstance> instance);
+
+    bool bound() const { return instance_ != nullptr; }
+
+    void setMagnitude(uint16_t channel, double magnitude);
+    void setPhasor(uint16_t channel, double magnitude, double angleDeg);
+    void setFrequency(double hz);
+
+    // Post everything staged since the last commit (nothing when unbound)
+    void commit();
+
+private:
+    std::shared_ptr<SVPublisherInstance> instance_;
+    StreamControlUpdate update_;
+};
 
 class SVPublisherManager {
 public:
@@ -23,6 +75,7 @@ public:
     void stopStream(const std::string& streamId);
     void startAll();
     void stopAll();
+    size_t runningStreams() const;
 
     // Updates
     void updatePhasors(const std::string& streamId, const nlohmann::json& phasorData);
@@ -32,16 +85,71 @@ public:
     void updateStreamPhasors(const std::string& streamId, double freq, 
                             const std::map<std::string, std::pair<double, double>>& channels);
 
+    // Bulk update of many streams. parseBulkUpdate() needs no lock and throws
+    // std::invalid_argument on any bad entry. applyBulk() checks every id
+    // (std::runtime_error, nothing applied) and then applies all streams in
+    // one critical section, i.e. between two tick rounds, so they all change
+    // on the same sample. Returns the snapshot version
+    static BulkUpdate parseBulkUpdate(const nlohmann::json& body);
+    uint64_t applyBulk(BulkUpdate& update);
+
+    // WebSocket control channel: never takes the manager mutex, so slider
+    // updates do not queue behind HTTP requests or the tick loop. Returns the
+    // number of updates posted; ids with no stream go to `unknown`, updates
+    // refused by their stream (channel out of range) to `errors`
+    size_t postControl(const ControlBatch& batch, uint64_t receivedNs,
+                       std::vector<std::string>* unknown = nullptr,
+                       std::vector<std::string>* errors = nullptr);
+
+    // Time-domain waveform in place of the phasors (nullptr detaches)
+    void setSampleSource(const std::string& streamId, std::shared_ptr<SampleSource> source);
+
+    // Network impairment (profile JSON as in impairment_json.hpp)
+    nlohmann::json setImpairment(const std::string& streamId, const nlohmann::json& profile);
+    nlohmann::json getImpairment(const std::string& streamId) const;
+    nlohmann::json getImpairmentEvents(const std::string& streamId, uint64_t since, size_t max) const;
+
+    // Virtual-time runs: publisher clock and a loopback in place of the NIC,
+    // used by streams created afterwards (nullptr restores the defaults)
+    void setClock(std::shared_ptr<Clock> clock);
+    void setLoopback(std::shared_ptr<FrameLoopback> loopback);
+
+    // Reference time for streams created afterwards: samples paced on it,
+    // smpCnt aligned to its second; tickAll() keeps it cross-timestamped.
+    // Real time only: the reference maps CLOCK_MONOTONIC, not a virtual clock
+    void setTimeSource(std::shared_ptr<TimeSource> source);
+
+    // RT self-test result that stream sample rates are checked against in
+    // createStream()/updateStream(): a rate the host cannot sustain is logged,
+    // or with enforcement refused (std::invalid_argument). No report, no check
+    void setRtReport(std::shared_ptr<const RtSelfTestReport> report);
+    std::shared_ptr<const RtSelfTestReport> getRtReport() const;
+    void setRtEnforce(bool enforce);
+
     // High-resolution tick
     void tickAll();
 
     // Getters
     std::shared_ptr<SVPublisherInstance> getInstance(const std::string& streamId);
 
+    // Writer bound to an existing stream; throws std::runtime_error if unknown
+    StreamPhasorWriter bindPhasorWriter(const std::string& streamId);
+
 private:
     std::map<std::string, std::shared_ptr<SVPublisherInstance>> streams_;
     mutable std::mutex mutex_;
+    uint64_t bulkVersion_ = 0;
+    std::shared_ptr<Clock> clock_;
+    std::shared_ptr<FrameLoopback> loopback_;
+    std::shared_ptr<TimeSource> timeSource_;
+    std::shared_ptr<const RtSelfTestReport> rtReport_;
+    bool rtEnforce_ = false;
+
+    // Read-mostly copy of the stream map for the control channel
+    using StreamDirectory = std::map<std::string, std::weak_ptr<SVPublisherInstance>>;
+    RcuCell<StreamDirectory> directory_;
 
     std::string generateId() const;
     SVConfig parseConfig(const nlohmann::json& json) const;
+    void checkSampleRate(uint32_t sampleRate) const;
 };
@@ -0,0 +1,286 @@
+#include "phasor_control.hpp"
+#include "general_definition.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t Version = 1;
+constexpr uint8_t FlagAck = 0x01;
+constexpr uint8_t FlagFrequency = 0x01;
+
+const char* const ChannelNames[] = {"I-A", "I-B", "I-C", "I-N", "V-A", "V-B", "V-C", "V-N"};
+
+// Bounds-checked little-endian reader
+class Cursor {
+public:
+    Cursor(const uint8_t* data, size_t length) : data_(data), left_(length) {}
+
+    bool u8(uint8_t& v) {
+        if (left_ < 1) return false;
+        v = *data_;
+        skip(1);
+        return true;
+    }
+
+    bool u16(uint16_t& v) {
+        if (left_ < 2) return false;
+        v = static_cast<uint16_t>(data_[0] | data_[1] << 8);
+        skip(2);
+        return true;
+    }
+
+    bool f32(double& v) {
+        uint32_t bits;
+        if (!raw(bits, 4)) return false;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        v = static_cast<double>(f);
+        return true;
+    }
+
+    bool f64(double& v) {
+        uint64_t bits;
+        if (!raw(bits, 8)) return false;
+        std::memcpy(&v, &bits, sizeof(v));
+        return true;
+    }
+
+    bool bytes(std::string& out, size_t n) {
+        if (left_ < n) return false;
+        out.assign(reinterpret_cast<const char*>(data_), n);
+        skip(n);
+        return true;
+    }
+
+    size_t left() const { return left_; }
+
+private:
+    template <typename T>
+    bool raw(T& v, size_t n) {
+        if (left_ < n) return false;
+        v = 0;
+        for (size_t i = 0; i < n; ++i) {
+            v |= static_cast<T>(data_[i]) << (8 * i);
+        }
+        skip(n);
+        return true;
+    }
+
+    void skip(size_t n) {
+        data_ += n;
+        left_ -= n;
+    }
+
+    const uint8_t* data_;
+    size_t left_;
+};
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T bits, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+}
+
+bool checkDelta(const PhasorDelta& delta, std::string& error) {
+    if (delta.channel >= Control_MaxChannels) {
+        error = "Channel out of range: " + std::to_string(delta.channel);
+        return false;
+    }
+    if (delta.fields == 0) {
+        error = "Delta for channel " + std::to_string(delta.channel) + " sets nothing";
+        return false;
+    }
+    if (!std::isfinite(delta.magnitude) || !std::isfinite(delta.angle)) {
+        error = "Non-finite value for channel " + std::to_string(delta.channel);
+        return false;
+    }
+    return true;
+}
+
+bool checkFrequency(const StreamControlUpdate& update, std::string& error) {
+    if (update.hasFrequency && (!(update.frequency > 0.0) || !std::isfinite(update.frequency) ||
+                                !std::isfinite(update.rocof))) {
+        error = "Invalid frequency for stream " + update.streamId;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int channelIndexByName(const std::string& name) {
+    for (size_t i = 0; i < sizeof(ChannelNames) / sizeof(ChannelNames[0]); ++i) {
+        if (name == ChannelNames[i]) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool decodeControlBinary(const uint8_t* data, size_t length, ControlBatch& batch, std::string& error) {
+    batch.clear();
+    Cursor in(data, length);
+
+    uint8_t magic0, magic1, version, flags;
+    uint16_t streams;
+    if (!in.u8(magic0) || !in.u8(magic1) || magic0 != 'V' || magic1 != 'C') {
+        error = "Not a control message";
+        return false;
+    }
+    if (!in.u8(version) || version != Version) {
+        error = "Unsupported control message version";
+        return false;
+    }
+    if (!in.u8(flags) || !in.u16(streams)) {
+        error = "Truncated control header";
+        return false;
+    }
+    batch.ack = (flags & FlagAck) != 0;
+
+    for (uint16_t s = 0; s < streams; ++s) {
+        StreamControlUpdate& update = batch.add();
+        uint8_t idLength, streamFlags;
+        uint16_t deltas;
+        if (!in.u8(idLength) || !in.bytes(update.streamId, idLength) ||
+            !in.u8(streamFlags) || !in.u16(deltas)) {
+            error = "Truncated stream header";
+            return false;
+        }
+        if (streamFlags & FlagFrequency) {
+            update.hasFrequency = true;
+            if (!in.f64(update.frequency) || !in.f64(update.rocof)) {
+                error = "Truncated frequency";
+                return false;
+            }
+            if (!checkFrequency(update, error)) {
+                return false;
+            }
+        }
+        if (in.left() < static_cast<size_t>(deltas) * 10) {
+            error = "Truncated deltas for stream " + update.streamId;
+            return false;
+        }
+        update.deltas.resize(deltas);
+        for (PhasorDelta& delta : update.deltas) {
+            uint8_t channel = 0;
+            if (!in.u8(channel) || !in.u8(delta.fields) ||
+                !in.f32(delta.magnitude) || !in.f32(delta.angle)) {
+                error = "Truncated deltas for stream " + update.streamId;
+                return false;
+            }
+            delta.channel = channel;
+            delta.fields &= PhasorDelta::Magnitude | PhasorDelta::Angle;
+            if (!checkDelta(delta, error)) {
+                return false;
+            }
+        }
+    }
+    if (in.left() != 0) {
+        error = "Trailing bytes after control message";
+        return false;
+    }
+    return true;
+}
+
+bool decodeControlJson(const nlohmann::json& message, ControlBatch& batch, std::string& error) {
+    batch.clear();
+    batch.ack = message.value("ack", false);
+
+    auto streams = message.find("streams");
+    if (streams == message.end() || !streams->is_array()) {
+        error = "Control message needs a \"streams\" array";
+        return false;
+    }
+
+    for (const auto& entry : *streams) {
+        StreamControlUpdate& update = batch.add();
+        update.streamId = entry.value("id", "");
+        if (update.streamId.empty()) {
+            error = "Stream entry without \"id\"";
+            return false;
+        }
+        if (entry.contains("freq")) {
+            update.hasFrequency = true;
+            update.frequency = entry["freq"].get<double>();
+            update.rocof = entry.value("rocof", 0.0);
+            if (!checkFrequency(update, error)) {
+                return false;
+            }
+        }
+
+        auto phasors = entry.find("phasors");
+        if (phasors == entry.end()) {
+            continue;
+        }
+        if (!phasors->is_array()) {
+            error = "\"phasors\" must be an array";
+            return false;
+        }
+        for (const auto& p : *phasors) {
+            PhasorDelta delta;
+            if (p.contains("name")) {
+                const int index = channelIndexByName(p["name"].get<std::string>());
+                if (index < 0) {
+                    error = "Unknown channel: " + p["name"].get<std::string>();
+                    return false;
+                }
+                delta.channel = static_cast<uint16_t>(index);
+            } else {
+                const int64_t ch = p.value("ch", int64_t{-1});
+                if (ch < 0 || ch >= static_cast<int64_t>(Control_MaxChannels)) {
+                    error = "Channel out of range: " + std::to_string(ch);
+                    return false;
+                }
+                delta.channel = static_cast<uint16_t>(ch);
+            }
+            if (p.contains("mag")) {
+                delta.fields |= PhasorDelta::Magnitude;
+                delta.magnitude = p["mag"].get<double>();
+            }
+            if (p.contains("angle")) {
+                delta.fields |= PhasorDelta::Angle;
+                delta.angle = p["angle"].get<double>();
+            }
+            if (!checkDelta(delta, error)) {
+                return false;
+            }
+            update.deltas.push_back(delta);
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> encodeControlBinary(const StreamControlUpdate* updates, size_t count, bool ack) {
+    std::vector<uint8_t> out = {'V', 'C', Version, static_cast<uint8_t>(ack ? FlagAck : 0)};
+    put(out, static_cast<uint16_t>(count), 2);
+    for (size_t s = 0; s < count; ++s) {
+        const StreamControlUpdate& update = updates[s];
+        const size_t idLength = std::min<size_t>(update.streamId.size(), 255);
+        out.push_back(static_cast<uint8_t>(idLength));
+        out.insert(out.end(), update.streamId.begin(), update.streamId.begin() + static_cast<long>(idLength));
+        out.push_back(update.hasFrequency ? FlagFrequency : 0);
+        put(out, static_cast<uint16_t>(update.deltas.size()), 2);
+        if (update.hasFrequency) {
+            uint64_t bits;
+            std::memcpy(&bits, &update.frequency, sizeof(bits));
+            put(out, bits, 8);
+            std::memcpy(&bits, &update.rocof, sizeof(bits));
+            put(out, bits, 8);
+        }
+        for (const PhasorDelta& delta : update.deltas) {
+            out.push_back(static_cast<uint8_t>(delta.channel));
+            out.push_back(delta.fields);
+            uint32_t bits;
+            float f = static_cast<float>(delta.magnitude);
+            std::memcpy(&bits, &f, sizeof(bits));
+            put(out, bits, 4);
+            f = static_cast<float>(delta.angle);
+            std::memcpy(&bits, &f, sizeof(bits));
+            put(out, bits, 4);
+        }
+    }
+    return out;
+}
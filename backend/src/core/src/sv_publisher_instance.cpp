@@ -1,4 +1,13 @@
 #include "sv_publisher_instance.hpp"
+#include "BER_Codec.hpp"
+#include "SV_FrameLayout.hpp"
+#include "general_definition.hpp"
+#include "impairment_stage.hpp"
+#include "rcu_cell.hpp"
+#include "thread_health.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <cmath>
 #include <stdexcept>
@@ -26,13 +35,51 @@
 constexpr uint16_t ETHERTYPE_8021Q = 0x8100;
 constexpr uint16_t ETHERTYPE_SV = 0x88BA;
 constexpr size_t MAX_SV_FRAME_SIZE = 1518;
-constexpr int16_t SCALE_FACTOR = 3276; // ~10% of int16 max for ±10V
 
-SVPublisherInstance::SVPublisherInstance(const std::string& id, const SVConfig& config)
+namespace {
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Reference time of a sample index (whole seconds of samples plus the rest)
+uint64_t sampleTimeNs(uint64_t index, uint64_t rate) {
+    return index / rate * 1000000000u + index % rate * 1000000000u / rate;
+}
+
+} // namespace
+
+// Desired state posted by control clients; frequency changes are events, so
+// they carry a sequence number and apply once
+struct PhasorControl {
+    std::vector<Phasor> phasors;
+    double frequency = 0.0;
+    double rocof = 0.0;
+    uint64_t frequencySeq = 0;
+    uint64_t postedNs = 0;
+};
+
+struct ControlChannel {
+    RcuCell<PhasorControl> cell;
+    RcuCell<PhasorControl>::Reader reader{cell};    // Publisher thread only
+    uint64_t appliedFrequencySeq = 0;
+    std::atomic<int64_t> lastLatencyNs{-1};
+};
+
+SVPublisherInstance::SVPublisherInstance(const std::string& id, const SVConfig& config,
+                                         std::shared_ptr<FrameLoopback> loopback,
+                                         std::shared_ptr<Clock> clock,
+                                         std::shared_ptr<TimeSource> timeSource)
     : id_(id)
     , config_(config)
     , running_(false)
     , sampleCounter_(0)
+    , impairment_(new ImpairmentStage())
+    , control_(new ControlChannel())
+    , loopback_(std::move(loopback))
+    , clock_(clock ? std::move(clock) : systemClock())
+    , timeSource_(std::move(timeSource))
 #ifdef __APPLE__
     , bpfSocket_(nullptr)
 #endif
@@ -47,8 +94,12 @@ SVPublisherInstance::SVPublisherInstance(const std::string& id, const SVConfig&
     }
     
     harmonics_ = nlohmann::json::array();
+    resetOscillators();
+    control_->cell.update([this](PhasorControl& c) { c.phasors = phasors_; });
     
-    initRawSocket();
+    if (!loopback_) {
+        initRawSocket();
+    }
 }
 
 SVPublisherInstance::~SVPublisherInstance() {
@@ -64,6 +115,19 @@ SVPublisherInstance::SVPublisherInstance(SVPublisherInstance&& other) noexcept
     , phasors_(std::move(other.phasors_))
     , harmonics_(std::move(other.harmonics_))
     , sampleCounter_(other.sampleCounter_)
+    , snapshotVersion_(other.snapshotVersion_)
+    , oscillators_(std::move(other.oscillators_))
+    , impairment_(std::move(other.impairment_))
+    , sampleSource_(std::move(other.sampleSource_))
+    , sourceValues_(std::move(other.sourceValues_))
+    , control_(std::move(other.control_))
+    , loopback_(std::move(other.loopback_))
+    , clock_(std::move(other.clock_))
+    , timeSource_(std::move(other.timeSource_))
+    , nextSample_(other.nextSample_)
+    , aligned_(other.aligned_)
+    , realignments_(other.realignments_)
+    , smpSynch_(other.smpSynch_)
 #ifdef __APPLE__
     , bpfSocket_(other.bpfSocket_)
 #endif
@@ -96,6 +160,19 @@ SVPublisherInstance& SVPublisherInstance::operator=(SVPublisherInstance&& other)
         phasors_ = std::move(other.phasors_);
         harmonics_ = std::move(other.harmonics_);
         sampleCounter_ = other.sampleCounter_;
+        snapshotVersion_ = other.snapshotVersion_;
+        oscillators_ = std::move(other.oscillators_);
+        impairment_ = std::move(other.impairment_);
+        sampleSource_ = std::move(other.sampleSource_);
+        sourceValues_ = std::move(other.sourceValues_);
+        control_ = std::move(other.control_);
+        loopback_ = std::move(other.loopback_);
+        clock_ = std::move(other.clock_);
+        timeSource_ = std::move(other.timeSource_);
+        nextSample_ = other.nextSample_;
+        aligned_ = other.aligned_;
+        realignments_ = other.realignments_;
+        smpSynch_ = other.smpSynch_;
         
 #ifdef __APPLE__
         bpfSocket_ = other.bpfSocket_;
@@ -201,6 +278,8 @@ void SVPublisherInstance::closeRawSocket() {
 void SVPublisherInstance::start() {
     running_ = true;
     sampleCounter_ = 0;
+    aligned_ = false;
+    resetOscillators();
 }
 
 void SVPublisherInstance::stop() {
@@ -208,35 +287,162 @@ void SVPublisherInstance::stop() {
 }
 
 void SVPublisherInstance::setConfig(const SVConfig& config) {
+    const bool rateChanged = config.sampleRate != config_.sampleRate;
+    const bool freqChanged = config.nominalFreq != config_.nominalFreq;
     config_ = config;
+    for (auto& osc : oscillators_) {
+        if (rateChanged) {
+            osc.setSampleRate(config_.sampleRate);
+        }
+        if (freqChanged) {
+            osc.setFrequency(config_.nominalFreq);
+        }
+    }
 }
 
 void SVPublisherInstance::setPhasors(const std::vector<Phasor>& phasors) {
+    applyPhasors(phasors);
+    // Later control deltas merge on top of this state, not a stale one
+    control_->cell.update([&phasors](PhasorControl& c) {
+        c.phasors = phasors;
+        c.postedNs = 0;
+    });
+}
+
+void SVPublisherInstance::applyPhasors(const std::vector<Phasor>& phasors) {
+    for (size_t i = 0; i < phasors.size(); ++i) {
+        if (i < oscillators_.size()) {
+            oscillators_[i].shiftPhase((phasors[i].angle - phasors_[i].angle) * M_PI / 180.0);
+        } else if (!oscillators_.empty()) {
+            // New channel: in step with channel 0, offset by the angle difference
+            PhaseOscillator osc = oscillators_[0];
+            osc.shiftPhase((phasors[i].angle - phasors[0].angle) * M_PI / 180.0);
+            oscillators_.push_back(osc);
+        } else {
+            oscillators_.emplace_back(config_.sampleRate, config_.nominalFreq, phasors[i].angle * M_PI / 180.0);
+        }
+    }
+    oscillators_.resize(phasors.size());
     phasors_ = phasors;
 }
 
-void SVPublisherInstance::setHarmonics(const nlohmann::json& harmonics) {
-    harmonics_ = harmonics;
+void SVPublisherInstance::setFrequency(double hz, double rocofHzPerS) {
+    for (auto& osc : oscillators_) {
+        osc.rampTo(hz, rocofHzPerS);
+    }
+    if (oscillators_.empty()) {
+        config_.nominalFreq = hz;
+    }
+}
+
+bool SVPublisherInstance::postControl(const StreamControlUpdate& update, uint64_t receivedNs, std::string* error) {
+    // The pending state holds the stream's channel set; a stray index must
+    // not widen the published frame
+    const size_t channels = control_->cell.load()->phasors.size();
+    for (const PhasorDelta& delta : update.deltas) {
+        if (delta.channel >= channels) {
+            if (error) {
+                *error = "channel " + std::to_string(delta.channel) + " out of range (" +
+                         std::to_string(channels) + " channels)";
+            }
+            return false;
+        }
+    }
+    control_->cell.update([&update, receivedNs](PhasorControl& c) {
+        for (const PhasorDelta& delta : update.deltas) {
+            if (delta.channel >= c.phasors.size()) {
+                continue;   // setPhasors() narrowed the stream since the check
+            }
+            if (delta.fields & PhasorDelta::Magnitude) {
+                c.phasors[delta.channel].magnitude = delta.magnitude;
+            }
+            if (delta.fields & PhasorDelta::Angle) {
+                c.phasors[delta.channel].angle = delta.angle;
+            }
+        }
+        if (update.hasFrequency) {
+            c.frequency = update.frequency;
+            c.rocof = update.rocof;
+            c.frequencySeq++;
+        }
+        c.postedNs = receivedNs;
+    });
+    return true;
+}
+
+int64_t SVPublisherInstance::lastControlLatencyNs() const {
+    return control_->lastLatencyNs.load(std::memory_order_relaxed);
+}
+
+void SVPublisherInstance::applyControl() {
+    ControlChannel& channel = *control_;
+    if (channel.cell.version() == channel.reader.version()) {
+        return;
+    }
+    const PhasorControl& control = channel.reader.get();
+    if (control.frequencySeq != channel.appliedFrequencySeq) {
+        setFrequency(control.frequency, control.rocof);
+        channel.appliedFrequencySeq = control.frequencySeq;
+    }
+    applyPhasors(control.phasors);
+    if (control.postedNs != 0) {
+        channel.lastLatencyNs.store(static_cast<int64_t>(steadyNowNs() - control.postedNs),
+                                    std::memory_order_relaxed);
+    }
+}
+
+double SVPublisherInstance::getFrequency() const {
+    return oscillators_.empty() ? config_.nominalFreq : oscillators_[0].frequency();
+}
+
+void SVPublisherInstance::setHarmonics(nlohmann::json harmonics) {
+    harmonics_ = std::move(harmonics);
+}
+
+void SVPublisherInstance::resetOscillators() {
+    oscillators_.clear();
+    oscillators_.reserve(phasors_.size());
+    for (const auto& phasor : phasors_) {
+        oscillators_.emplace_back(config_.sampleRate, config_.nominalFreq, phasor.angle * M_PI / 180.0);
+    }
+}
+
+void SVPublisherInstance::setSampleSource(std::shared_ptr<SampleSource> source) {
+    sampleSource_ = std::move(source);
+    if (sampleSource_) {
+        sourceValues_.resize(phasors_.size());
+    }
 }
 
-std::vector<int16_t> SVPublisherInstance::generateSamples() {
-    std::vector<int16_t> samples;
+std::vector<int32_t> SVPublisherInstance::generateSamples() {
+    std::vector<int32_t> samples;
+    
+    if (sampleSource_) {
+        sourceValues_.resize(phasors_.size());  // No-op unless the channel count changed
+        if (sampleSource_->next(sourceValues_.data(), sourceValues_.size())) {
+            // Oscillators keep running so the phasors resume in phase
+            for (auto& osc : oscillators_) {
+                osc.advance();
+            }
+            samples.reserve(sourceValues_.size());
+            for (size_t i = 0; i < sourceValues_.size(); ++i) {
+                samples.push_back(sv92le_encode(sourceValues_[i], i));
+            }
+            return samples;
+        }
+        sampleSource_.reset();
+    }
     
     if (config_.dataSource == DataSource::MANUAL) {
-        // Generate samples from phasors using synthesis
-        // For now, simple fundamental generation
-        double t = static_cast<double>(sampleCounter_) / config_.sampleRate;
-        
-        for (const auto& phasor : phasors_) {
-            // Convert phasor to instantaneous value
-            // v(t) = √2 * V * sin(2πft + φ)
-            double omega = 2.0 * M_PI * config_.nominalFreq;
-            double phase = omega * t + (phasor.angle * M_PI / 180.0);
-            double value = std::sqrt(2.0) * phasor.magnitude * std::sin(phase);
+        // v = sqrt(2) * V * sin(phase); each channel's oscillator carries
+        // omega*t + angle and advances by one rotation per sample
+        samples.reserve(phasors_.size());
+        for (size_t i = 0; i < phasors_.size(); ++i) {
+            double value = std::sqrt(2.0) * phasors_[i].magnitude * oscillators_[i].sine();
+            oscillators_[i].advance();
             
-            // Scale to int16 range
-            int16_t scaled = static_cast<int16_t>(value * SCALE_FACTOR);
-            samples.push_back(scaled);
+            // 9-2LE scaling: 1 mA / 10 mV per LSB
+            samples.push_back(sv92le_encode(value, i));
         }
     } else if (config_.dataSource == DataSource::COMTRADE) {
         // TODO: Read from COMTRADE file
@@ -250,89 +456,86 @@ std::vector<int16_t> SVPublisherInstance::generateSamples() {
 }
 
 void SVPublisherInstance::sendSVPacket() {
-    if (rawSocket_ < 0) {
+    if (rawSocket_ < 0 && !loopback_) {
         return;
     }
     
     // Generate samples for this tick
-    std::vector<int16_t> samples = generateSamples();
+    std::vector<int32_t> samples = generateSamples();
     
     // Build Ethernet + VLAN + SV frame
     uint8_t frame[MAX_SV_FRAME_SIZE];
-    size_t offset = 0;
     
     // Ethernet header
+    uint8_t macs[12];
     // Destination MAC
     sscanf(config_.macDst.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
-           &frame[0], &frame[1], &frame[2], &frame[3], &frame[4], &frame[5]);
-    offset += 6;
+           &macs[0], &macs[1], &macs[2], &macs[3], &macs[4], &macs[5]);
     
     // Source MAC
     sscanf(config_.macSrc.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
-           &frame[6], &frame[7], &frame[8], &frame[9], &frame[10], &frame[11]);
-    offset += 6;
+           &macs[6], &macs[7], &macs[8], &macs[9], &macs[10], &macs[11]);
     
-    // VLAN tag
-    uint16_t vlanTag = htons(ETHERTYPE_8021Q);
-    memcpy(&frame[offset], &vlanTag, 2);
-    offset += 2;
+    BERWriter w(frame, sizeof(frame));
+    w.putBytes(macs, sizeof(macs));
     
-    // VLAN TCI (Priority + VLAN ID)
-    uint16_t tci = static_cast<uint16_t>((config_.vlanPrio << 13) | (config_.vlanId & 0x0FFF));
-    tci = htons(tci);
-    memcpy(&frame[offset], &tci, 2);
-    offset += 2;
+    // VLAN tag + TCI (Priority + VLAN ID)
+    w.putU16(ETHERTYPE_8021Q);
+    w.putU16(static_cast<uint16_t>((config_.vlanPrio << 13) | (config_.vlanId & 0x0FFF)));
     
     // EtherType for SV
-    uint16_t svType = htons(ETHERTYPE_SV);
-    memcpy(&frame[offset], &svType, 2);
-    offset += 2;
+    w.putU16(ETHERTYPE_SV);
+    
+    // SV APDU: content sizes first so every length prefix is exact
+    const size_t seqDataSize = samples.size() * 8;
+    const size_t asduSize = berTLVSize(config_.svId.size())  // svID
+                          + berTLVSize(2)                    // smpCnt
+                          + berTLVSize(4)                    // confRev
+                          + berTLVSize(1)                    // smpSynch
+                          + berTLVSize(seqDataSize);         // seqData
+    const size_t seqAsduSize = berTLVSize(asduSize);
+    const size_t savPduSize = berTLVSize(1) + berTLVSize(seqAsduSize);
     
-    // SV APDU (simplified - real implementation needs proper ASN.1 encoding)
-    // APPID
     uint16_t appId = static_cast<uint16_t>(std::stoul(config_.appId, nullptr, 16));
-    appId = htons(appId);
-    memcpy(&frame[offset], &appId, 2);
-    offset += 2;
-    
-    // Length (placeholder)
-    uint16_t length = htons(static_cast<uint16_t>(samples.size() * 8 + 20));
-    memcpy(&frame[offset], &length, 2);
-    offset += 2;
-    
-    // Reserved fields
-    frame[offset++] = 0x80;
-    frame[offset++] = 0x00;
-    
-    // svID (simplified)
-    uint8_t svIdLen = static_cast<uint8_t>(config_.svId.length());
-    frame[offset++] = svIdLen;
-    memcpy(&frame[offset], config_.svId.c_str(), svIdLen);
-    offset += svIdLen;
-    
-    // smpCnt
-    uint16_t smpCnt = htons(static_cast<uint16_t>(sampleCounter_ % config_.sampleRate));
-    memcpy(&frame[offset], &smpCnt, 2);
-    offset += 2;
-    
-    // confRev
-    uint32_t confRev = htonl(1);
-    memcpy(&frame[offset], &confRev, 4);
-    offset += 4;
-    
-    // smpSynch
-    frame[offset++] = 0x01; // Synced to external clock
-    
-    // Sample values (each as INT32Q with quality)
-    for (int16_t sample : samples) {
-        uint32_t value = htonl(static_cast<uint32_t>(static_cast<int32_t>(sample)));
-        memcpy(&frame[offset], &value, 4);
-        offset += 4;
-        
-        // Quality (0 = good)
-        uint32_t quality = 0;
-        memcpy(&frame[offset], &quality, 4);
-        offset += 4;
+    w.putU16(appId);
+    w.putU16(static_cast<uint16_t>(8 + berTLVSize(savPduSize)));  // APPID..end of APDU
+    w.putU16(0);                                                   // Reserved 1
+    w.putU16(0);                                                   // Reserved 2
+    
+    w.putHeader(0x60, savPduSize);
+    w.putU8TLV(0x80, 1);                                           // noASDU
+    w.putHeader(0xA2, seqAsduSize);
+    w.putHeader(0x30, asduSize);
+    w.putTLV(0x80, config_.svId.data(), config_.svId.size());
+    w.putU16TLV(0x82, static_cast<uint16_t>(sampleCounter_ % config_.sampleRate));
+    w.putU32TLV(0x83, 1);                                          // confRev
+    w.putU8TLV(0x85, smpSynch_);                                   // smpSynch: 0 none, 1 local, 2 global
+    
+    // Sample values (each as INT32Q with quality 0 = good)
+    w.putHeader(0x87, seqDataSize);
+    for (int32_t sample : samples) {
+        w.putU32(static_cast<uint32_t>(sample));
+        w.putU32(0);
+    }
+    
+    if (!w.ok()) {
+        return;  // Frame does not fit MAX_SV_FRAME_SIZE
+    }
+    const size_t offset = w.size();
+    
+    if (impairment_->idle()) {
+        transmit(frame, offset);
+        return;
+    }
+    impairment_->submit(frame, offset, clock_->nowNs(), [this](const uint8_t* data, size_t length) {
+        transmit(data, length);
+    });
+}
+
+void SVPublisherInstance::transmit(const uint8_t* frame, size_t length) {
+    if (loopback_) {
+        loopback_->send(frame, length);
+        return;
     }
     
     // Send frame (platform-specific)
@@ -343,8 +546,8 @@ void SVPublisherInstance::sendSVPacket() {
     sa.sll_protocol = htons(ETH_P_ALL);
     sa.sll_ifindex = 0; // Use first available interface
     
-    ssize_t sent = sendto(rawSocket_, frame, offset, 0, 
-                          reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa));
+    ssize_t sent = sendto(rawSocket_, frame, length, 0, 
+                          reinterpret_cast<const struct sockaddr*>(&sa), sizeof(sa));
     
     if (sent < 0) {
         // Ignore send errors - they happen if no interface is available
@@ -352,7 +555,7 @@ void SVPublisherInstance::sendSVPacket() {
 #elif defined(__APPLE__)
     // On macOS, use BPF write() to send raw Ethernet frame
     if (bpfSocket_ != nullptr && bpfSocket_->isOpen()) {
-        ssize_t sent = bpfSocket_->write(frame, offset);
+        ssize_t sent = bpfSocket_->write(frame, length);
         
         if (sent < 0) {
             // Ignore send errors - they happen if interface is down or permissions issue
@@ -362,7 +565,7 @@ void SVPublisherInstance::sendSVPacket() {
 #elif defined(_WIN32)
     // On Windows, use Npcap write() to send raw Ethernet frame
     if (npcapSocket_ != nullptr && npcapSocket_->isOpen()) {
-        ssize_t sent = npcapSocket_->write(frame, offset);
+        ssize_t sent = npcapSocket_->write(frame, length);
         
         if (sent < 0) {
             // Ignore send errors - they happen if interface is down or permissions issue
@@ -373,14 +576,86 @@ void SVPublisherInstance::sendSVPacket() {
 }
 
 void SVPublisherInstance::tick() {
+    if (control_) {
+        applyControl();
+    }
+
+    // Delayed frames still go out after stop()
+    if (impairment_ && !impairment_->idle() && (rawSocket_ >= 0 || loopback_)) {
+        impairment_->poll(clock_->nowNs(), [this](const uint8_t* data, size_t length) {
+            transmit(data, length);
+        });
+    }
+
     if (!running_) {
         return;
     }
     
+    // A virtual clock's tick period has nothing to do with the sample rate,
+    // so virtual runs are paced against the clock like a reference
+    if (timeSource_ || clock_->isVirtual()) {
+        sendDueSamples();
+        return;
+    }
     sendSVPacket();
     sampleCounter_++;
 }
 
+void SVPublisherInstance::sendDueSamples() {
+    const uint64_t rate = config_.sampleRate;
+    if (rate == 0) {
+        return;
+    }
+    // Without a time source the clock itself is the (unsynchronized) reference
+    const uint64_t now = clock_->nowNs();
+    const int64_t reference = timeSource_ ? timeSource_->toReference(now) : static_cast<int64_t>(now);
+    if (reference < 0) {
+        return;
+    }
+    
+    // Index of the sample due now: whole seconds of samples plus the samples
+    // into this second, so smpCnt (index % rate) is 0 on the second
+    const uint64_t ns = static_cast<uint64_t>(reference);
+    const uint64_t due = ns / 1000000000u * rate + ns % 1000000000u * rate / 1000000000u;
+    
+    const uint64_t maxLag = std::max<uint64_t>(1, rate * SV_MaxCatchUpMs / 1000);
+    if (timeSource_ && aligned_ && nextSample_ <= due) {
+        // Late against the tick that should have sent the oldest pending sample
+        const int64_t late = static_cast<int64_t>(ns - sampleTimeNs(nextSample_, rate)) -
+                             static_cast<int64_t>(SV_TickPeriodNs);
+        if (late >= ThreadHealth_LateNs) {
+            ThreadHealth::recordMiss(late);
+        }
+    }
+    if (!aligned_ || due > nextSample_ + maxLag || nextSample_ > due + maxLag) {
+        if (aligned_) {
+            realignments_++;        // Stalled, or the reference stepped
+        }
+        nextSample_ = due;
+        aligned_ = true;
+        alignOscillators(static_cast<uint32_t>(due % rate));
+    }
+    
+    smpSynch_ = timeSource_ ? timeSource_->smpSynch() : 0;
+    while (nextSample_ <= due) {
+        sampleCounter_ = static_cast<uint32_t>(nextSample_ % rate);
+        sendSVPacket();
+        nextSample_++;
+    }
+    sampleCounter_ = static_cast<uint32_t>(nextSample_ % rate);
+}
+
+// Phases as if every channel had run since the reference second began at
+// its phasor angle, so angles are referred to the second like a merging
+// unit locked to PPS
+void SVPublisherInstance::alignOscillators(uint32_t smpCnt) {
+    const double elapsed = static_cast<double>(smpCnt) / config_.sampleRate;
+    for (size_t i = 0; i < oscillators_.size() && i < phasors_.size(); ++i) {
+        const double turns = oscillators_[i].frequency() * elapsed;
+        oscillators_[i].setPhase(phasors_[i].angle * M_PI / 180.0 + 2.0 * M_PI * (turns - std::floor(turns)));
+    }
+}
+
 nlohmann::json SVPublisherInstance::toJson() const {
     nlohmann::json j;
     j["id"] = id_;
@@ -394,6 +669,11 @@ nlohmann::json SVPublisherInstance::toJson() const {
     j["nominalFreq"] = config_.nominalFreq;
     j["sampleRate"] = config_.sampleRate;
     j["running"] = running_;
+    j["controlLatencyNs"] = lastControlLatencyNs();
+    j["snapshotVersion"] = snapshotVersion_;
+    j["smpSynch"] = smpSynch_;
+    j["timeAligned"] = timeSource_ != nullptr;
+    j["realignments"] = realignments_;
     
     // Data source
     switch (config_.dataSource) {
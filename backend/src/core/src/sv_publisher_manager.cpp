@@ -1,8 +1,15 @@
 #include "sv_publisher_manager.hpp"
+#include "impairment_json.hpp"
+#include "general_definition.hpp"
+#include "logger.hpp"
+#include <algorithm>
 #include <random>
 #include <sstream>
 #include <iomanip>
 #include <stdexcept>
+#include <cmath>
+#include <set>
+#include <chrono>
 
 SVPublisherManager::SVPublisherManager() {
 }
@@ -78,10 +85,12 @@ std::string SVPublisherManager::createStream(const nlohmann::json& config) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     SVConfig svConfig = parseConfig(config);
+    checkSampleRate(svConfig.sampleRate);
     std::string id = generateId();
     
-    auto instance = std::make_shared<SVPublisherInstance>(id, svConfig);
+    auto instance = std::make_shared<SVPublisherInstance>(id, svConfig, loopback_, clock_, timeSource_);
     streams_[id] = instance;
+    directory_.update([&](StreamDirectory& d) { d[id] = instance; });
     
     return id;
 }
@@ -95,6 +104,7 @@ void SVPublisherManager::updateStream(const std::string& streamId, const nlohman
     }
     
     SVConfig svConfig = parseConfig(config);
+    checkSampleRate(svConfig.sampleRate);
     it->second->setConfig(svConfig);
 }
 
@@ -108,6 +118,7 @@ void SVPublisherManager::deleteStream(const std::string& streamId) {
     
     it->second->stop();
     streams_.erase(it);
+    directory_.update([&](StreamDirectory& d) { d.erase(streamId); });
 }
 
 nlohmann::json SVPublisherManager::listStreams() const {
@@ -171,6 +182,18 @@ void SVPublisherManager::stopAll() {
     }
 }
 
+size_t SVPublisherManager::runningStreams() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    size_t count = 0;
+    for (const auto& pair : streams_) {
+        if (pair.second->isRunning()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
 void SVPublisherManager::updatePhasors(const std::string& streamId, const nlohmann::json& phasorData) {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -179,7 +202,8 @@ void SVPublisherManager::updatePhasors(const std::string& streamId, const nlohma
         throw std::runtime_error("Stream not found: " + streamId);
     }
     
-    // Parse phasor data
+    // Parse phasor data: either a "phasors" array in channel order or, from
+    // the sequence engine, a "channels" object keyed by 9-2LE channel name
     std::vector<Phasor> phasors;
     if (phasorData.contains("phasors") && phasorData["phasors"].is_array()) {
         for (const auto& p : phasorData["phasors"]) {
@@ -188,9 +212,30 @@ void SVPublisherManager::updatePhasors(const std::string& streamId, const nlohma
             phasor.angle = p.value("angle", 0.0);
             phasors.push_back(phasor);
         }
+    } else if (phasorData.contains("channels") && phasorData["channels"].is_object()) {
+        static const char* const channelOrder[] = {"I-A", "I-B", "I-C", "I-N", "V-A", "V-B", "V-C", "V-N"};
+        phasors = it->second->getPhasors();
+        for (size_t i = 0; i < sizeof(channelOrder) / sizeof(channelOrder[0]); ++i) {
+            auto ch = phasorData["channels"].find(channelOrder[i]);
+            if (ch == phasorData["channels"].end()) {
+                continue;
+            }
+            if (phasors.size() <= i) {
+                phasors.resize(i + 1, {0.0, 0.0});
+            }
+            phasors[i].magnitude = ch->value("mag", 0.0);
+            phasors[i].angle = ch->value("angleDeg", 0.0);
+        }
     }
     
-    it->second->setPhasors(phasors);
+    // Frequency (and optional ROCOF ramp) first, so new angles are applied
+    // on top of a continuous phase
+    if (phasorData.contains("freq")) {
+        it->second->setFrequency(phasorData["freq"].get<double>(), phasorData.value("rocof", 0.0));
+    }
+    if (!phasors.empty() || phasorData.contains("phasors")) {
+        it->second->setPhasors(phasors);
+    }
 }
 
 void SVPublisherManager::updateHarmonics(const std::string& streamId, const nlohmann::json& harmonicsData) {
@@ -204,9 +249,306 @@ void SVPublisherManager::updateHarmonics(const std::string& streamId, const nloh
     it->second->setHarmonics(harmonicsData);
 }
 
+void SVPublisherManager::setSampleSource(const std::string& streamId, std::shared_ptr<SampleSource> source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        throw std::runtime_error("Stream not found: " + streamId);
+    }
+    
+    it->second->setSampleSource(std::move(source));
+}
+
+nlohmann::json SVPublisherManager::setImpairment(const std::string& streamId, const nlohmann::json& profile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        throw std::runtime_error("Stream not found: " + streamId);
+    }
+    
+    ImpairmentProfile parsed;
+    try {
+        parsed = profile.get<ImpairmentProfile>();
+    } catch (const nlohmann::json::exception& e) {
+        throw std::invalid_argument(std::string("Invalid impairment profile: ") + e.what());
+    }
+    
+    std::string error;
+    if (!it->second->impairment().setProfile(parsed, error)) {
+        throw std::invalid_argument("Invalid impairment profile: " + error);
+    }
+    
+    nlohmann::json result;
+    result["profile"] = parsed;
+    result["version"] = it->second->impairment().profileVersion();
+    return result;
+}
+
+nlohmann::json SVPublisherManager::getImpairment(const std::string& streamId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        throw std::runtime_error("Stream not found: " + streamId);
+    }
+    
+    const ImpairmentStage& stage = it->second->impairment();
+    nlohmann::json result;
+    result["profile"] = stage.profile();
+    result["version"] = stage.profileVersion();
+    result["counters"] = stage.counters();
+    result["eventHead"] = stage.eventHead();
+    return result;
+}
+
+nlohmann::json SVPublisherManager::getImpairmentEvents(const std::string& streamId, uint64_t since, size_t max) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        throw std::runtime_error("Stream not found: " + streamId);
+    }
+    
+    return impairmentEventsJson(it->second->impairment(), since, max);
+}
+
+BulkUpdate SVPublisherManager::parseBulkUpdate(const nlohmann::json& body) {
+    auto streams = body.find("streams");
+    if (streams == body.end() || !streams->is_array() || streams->empty()) {
+        throw std::invalid_argument("Bulk update needs a non-empty \"streams\" array");
+    }
+    
+    auto finite = [](const nlohmann::json& v, const std::string& what) {
+        if (!v.is_number() || !std::isfinite(v.get<double>())) {
+            throw std::invalid_argument(what + " must be a finite number");
+        }
+        return v.get<double>();
+    };
+    
+    BulkUpdate update;
+    update.streams.resize(streams->size());
+    std::set<std::string> seen;
+    for (size_t i = 0; i < streams->size(); ++i) {
+        const nlohmann::json& entry = (*streams)[i];
+        StreamBulkUpdate& out = update.streams[i];
+        out.streamId = entry.value("id", "");
+        if (out.streamId.empty()) {
+            throw std::invalid_argument("Bulk entry " + std::to_string(i) + " has no \"id\"");
+        }
+        if (!seen.insert(out.streamId).second) {
+            throw std::invalid_argument("Stream listed twice: " + out.streamId);
+        }
+        const std::string where = "Stream " + out.streamId + ": ";
+        
+        // Room for a merge with the live phasors, so applyBulk() does not allocate
+        out.phasors.reserve(Control_MaxChannels);
+        if (entry.contains("phasors")) {
+            const nlohmann::json& phasors = entry["phasors"];
+            if (!phasors.is_array() || phasors.size() > Control_MaxChannels) {
+                throw std::invalid_argument(where + "\"phasors\" must be an array of at most " +
+                                            std::to_string(Control_MaxChannels));
+            }
+            out.hasPhasors = true;
+            for (const auto& p : phasors) {
+                Phasor phasor;
+                phasor.magnitude = finite(p.value("magnitude", nlohmann::json(0.0)), where + "magnitude");
+                phasor.angle = finite(p.value("angle", nlohmann::json(0.0)), where + "angle");
+                if (phasor.magnitude < 0.0) {
+                    throw std::invalid_argument(where + "magnitude must be >= 0");
+                }
+                out.phasors.push_back(phasor);
+            }
+        } else if (entry.contains("channels")) {
+            const nlohmann::json& channels = entry["channels"];
+            if (!channels.is_object()) {
+                throw std::invalid_argument(where + "\"channels\" must be an object");
+            }
+            for (auto ch = channels.begin(); ch != channels.end(); ++ch) {
+                const int index = channelIndexByName(ch.key());
+                if (index < 0) {
+                    throw std::invalid_argument(where + "unknown channel " + ch.key());
+                }
+                PhasorDelta delta;
+                delta.channel = static_cast<uint16_t>(index);
+                delta.fields = static_cast<uint8_t>(PhasorDelta::Magnitude | PhasorDelta::Angle);
+                delta.magnitude = finite(ch->value("mag", nlohmann::json(0.0)), where + ch.key() + " mag");
+                delta.angle = finite(ch->value("angleDeg", nlohmann::json(0.0)), where + ch.key() + " angleDeg");
+                if (delta.magnitude < 0.0) {
+                    throw std::invalid_argument(where + ch.key() + " mag must be >= 0");
+                }
+                out.channels.push_back(delta);
+            }
+        }
+        
+        if (entry.contains("freq")) {
+            out.hasFrequency = true;
+            out.frequency = finite(entry["freq"], where + "freq");
+            out.rocof = finite(entry.value("rocof", nlohmann::json(0.0)), where + "rocof");
+            if (out.frequency <= 0.0) {
+                throw std::invalid_argument(where + "freq must be > 0");
+            }
+        }
+        
+        if (entry.contains("harmonics")) {
+            const nlohmann::json& harmonics = entry["harmonics"];
+            if (!harmonics.is_array() && !harmonics.is_object()) {
+                throw std::invalid_argument(where + "\"harmonics\" must be an array or object");
+            }
+            out.hasHarmonics = true;
+            out.harmonics = harmonics;
+        }
+        
+        if (!out.hasPhasors && out.channels.empty() && !out.hasFrequency && !out.hasHarmonics) {
+            throw std::invalid_argument(where + "nothing to update");
+        }
+    }
+    return update;
+}
+
+uint64_t SVPublisherManager::applyBulk(BulkUpdate& update) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // All or nothing: resolve every stream before touching any
+    std::vector<SVPublisherInstance*> targets;
+    targets.reserve(update.streams.size());
+    for (const auto& entry : update.streams) {
+        auto it = streams_.find(entry.streamId);
+        if (it == streams_.end()) {
+            throw std::runtime_error("Stream not found: " + entry.streamId);
+        }
+        // A delta only changes an existing channel; "phasors" sets the count
+        const size_t channels = it->second->getPhasors().size();
+        for (const PhasorDelta& delta : entry.channels) {
+            if (!entry.hasPhasors && delta.channel >= channels) {
+                throw std::invalid_argument("Stream " + entry.streamId + ": channel " +
+                                            std::to_string(delta.channel) + " out of range (" +
+                                            std::to_string(channels) + " channels)");
+            }
+        }
+        targets.push_back(it->second.get());
+    }
+    
+    // tickAll() holds the same mutex, so no frame goes out until every
+    // stream has switched
+    const uint64_t version = ++bulkVersion_;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        SVPublisherInstance& instance = *targets[i];
+        StreamBulkUpdate& entry = update.streams[i];
+        
+        if (entry.hasFrequency) {
+            instance.setFrequency(entry.frequency, entry.rocof);
+        }
+        if (!entry.hasPhasors && !entry.channels.empty()) {
+            entry.phasors = instance.getPhasors();
+            for (const PhasorDelta& delta : entry.channels) {
+                entry.phasors[delta.channel] = {delta.magnitude, delta.angle};
+            }
+        }
+        if (entry.hasPhasors || !entry.channels.empty()) {
+            instance.setPhasors(entry.phasors);
+        }
+        if (entry.hasHarmonics) {
+            instance.setHarmonics(std::move(entry.harmonics));
+        }
+        instance.setSnapshotVersion(version);
+        const uint32_t rate = instance.getConfig().sampleRate;
+        entry.appliedSmpCnt = rate ? instance.getSampleCounter() % rate : instance.getSampleCounter();
+    }
+    return version;
+}
+
+size_t SVPublisherManager::postControl(const ControlBatch& batch, uint64_t receivedNs,
+                                       std::vector<std::string>* unknown,
+                                       std::vector<std::string>* errors) {
+    const std::shared_ptr<const StreamDirectory> directory = directory_.load();
+    
+    size_t posted = 0;
+    for (size_t i = 0; i < batch.count; ++i) {
+        const StreamControlUpdate& update = batch.updates[i];
+        auto it = directory->find(update.streamId);
+        std::shared_ptr<SVPublisherInstance> instance;
+        if (it != directory->end()) {
+            instance = it->second.lock();
+        }
+        if (!instance) {
+            if (unknown) {
+                unknown->push_back(update.streamId);
+            }
+            continue;
+        }
+        std::string error;
+        if (!instance->postControl(update, receivedNs, &error)) {
+            if (errors) {
+                errors->push_back("Stream " + update.streamId + ": " + error);
+            }
+            continue;
+        }
+        posted++;
+    }
+    return posted;
+}
+
+void SVPublisherManager::setClock(std::shared_ptr<Clock> clock) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clock_ = std::move(clock);
+}
+
+void SVPublisherManager::setLoopback(std::shared_ptr<FrameLoopback> loopback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loopback_ = std::move(loopback);
+}
+
+void SVPublisherManager::setTimeSource(std::shared_ptr<TimeSource> source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timeSource_ = std::move(source);
+}
+
+void SVPublisherManager::setRtReport(std::shared_ptr<const RtSelfTestReport> report) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rtReport_ = std::move(report);
+}
+
+std::shared_ptr<const RtSelfTestReport> SVPublisherManager::getRtReport() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rtReport_;
+}
+
+void SVPublisherManager::setRtEnforce(bool enforce) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rtEnforce_ = enforce;
+}
+
+// Caller holds mutex_
+void SVPublisherManager::checkSampleRate(uint32_t sampleRate) const {
+    if (!rtReport_) {
+        return;
+    }
+    const RateVerdict verdict = rtReport_->verdict(sampleRate);
+    if (verdict == RateVerdict::Ok) {
+        return;
+    }
+    const long long worstUs = static_cast<long long>(rtReport_->worstNs("publisher") / 1000);
+    const long long tickUs = static_cast<long long>(rtReport_->tickNs / 1000);
+    if (verdict == RateVerdict::Unsustainable && rtEnforce_) {
+        throw std::invalid_argument("Sample rate " + std::to_string(sampleRate) +
+                                    " Hz not sustainable on this host: publisher woke up to " +
+                                    std::to_string(worstUs) + " us past its " + std::to_string(tickUs) +
+                                    " us tick, over the " + std::to_string(SV_MaxCatchUpMs) +
+                                    " ms catch-up budget");
+    }
+    LOG_WARN("SV", "Sample rate %u Hz is %s on this host (publisher woke up to %lld us past its %lld us tick)",
+             sampleRate, verdict == RateVerdict::Marginal ? "marginal" : "not sustainable", worstUs, tickUs);
+}
+
 void SVPublisherManager::tickAll() {
     std::lock_guard<std::mutex> lock(mutex_);
     
+    if (timeSource_) {
+        timeSource_->refresh(systemClock()->nowNs());
+    }
+    
     for (auto& pair : streams_) {
         pair.second->tick();
     }
@@ -251,3 +593,50 @@ std::shared_ptr<SVPublisherInstance> SVPublisherManager::getInstance(const std::
     
     return it->second;
 }
+
+StreamPhasorWriter SVPublisherManager::bindPhasorWriter(const std::string& streamId) {
+    std::shared_ptr<SVPublisherInstance> instance = getInstance(streamId);
+    if (!instance) {
+        throw std::runtime_error("Stream not found: " + streamId);
+    }
+    return StreamPhasorWriter(std::move(instance));
+}
+
+StreamPhasorWriter::StreamPhasorWriter(std::shared_ptr<SVPublisherInstance> instance)
+    : instance_(std::move(instance)) {
+    update_.streamId = instance_ ? instance_->getId() : std::string();
+    update_.deltas.reserve(8);
+}
+
+void StreamPhasorWriter::setMagnitude(uint16_t channel, double magnitude) {
+    PhasorDelta delta;
+    delta.channel = channel;
+    delta.fields = PhasorDelta::Magnitude;
+    delta.magnitude = magnitude;
+    update_.deltas.push_back(delta);
+}
+
+void StreamPhasorWriter::setPhasor(uint16_t channel, double magnitude, double angleDeg) {
+    PhasorDelta delta;
+    delta.channel = channel;
+    delta.fields = static_cast<uint8_t>(PhasorDelta::Magnitude | PhasorDelta::Angle);
+    delta.magnitude = magnitude;
+    delta.angle = angleDeg;
+    update_.deltas.push_back(delta);
+}
+
+void StreamPhasorWriter::setFrequency(double hz) {
+    update_.hasFrequency = true;
+    update_.frequency = hz;
+    update_.rocof = 0.0;
+}
+
+void StreamPhasorWriter::commit() {
+    if (instance_ && (!update_.deltas.empty() || update_.hasFrequency)) {
+        const uint64_t nowNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        instance_->postControl(update_, nowNs);
+    }
+    update_.deltas.clear();
+    update_.hasFrequency = false;
+}
@@ -0,0 +1,69 @@
+#ifndef VTS_IO_COMTRADE_WRITER_HPP
+#define VTS_IO_COMTRADE_WRITER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "comtrade_parser.hpp"
+
+namespace vts {
+namespace io {
+
+/**
+ * @brief COMTRADE file writer
+ *
+ * Writes IEEE C37.111-1999 binary COMTRADE (.cfg + .dat) readable by
+ * ComtradeParser. Analog values are stored as 16-bit integers with a
+ * per-channel multiplier chosen from the channel's peak, so the full
+ * range is used without clipping; b is always 0.
+ */
+class ComtradeWriter {
+public:
+    /**
+     * @brief Write one recording
+     *
+     * Used from config: stationName, recDeviceId, analogChannels (name,
+     * phase, ccbm, units, skew, primary, secondary, ps), digitalChannels
+     * (name, phase, ccbm, normalState), lineFreq, sampleRates[0].rate,
+     * startDate/startTime and triggerDate/triggerTime. Scaling, counts,
+     * format and sample totals are derived.
+     *
+     * @param basePath Path without extension; .cfg and .dat are appended
+     * @param config Channel and header information
+     * @param analog Row-major samples, numAnalogChannels values per row
+     * @param digital One word per row, bit i = digital channel i (max 64)
+     * @return true if both files were written
+     */
+    bool write(const std::string& basePath, const ComtradeConfig& config,
+               const std::vector<double>& analog, const std::vector<uint64_t>& digital);
+
+    /**
+     * @brief Get last error message
+     * @return Error description
+     */
+    std::string getLastError() const { return lastError_; }
+
+    /**
+     * @brief Format a UTC time as COMTRADE date and time fields
+     *
+     * @param utcSeconds Seconds since the Unix epoch
+     * @param date Output, dd/mm/yyyy
+     * @param time Output, hh:mm:ss.ssssss
+     */
+    static void formatTimestamp(double utcSeconds, std::string& date, std::string& time);
+
+private:
+    bool writeCfg(const std::string& path, const ComtradeConfig& config,
+                  const std::vector<double>& multipliers, size_t rows);
+    bool writeDat(const std::string& path, size_t analogCount, size_t digitalCount,
+                  const std::vector<double>& multipliers, double sampleRate,
+                  const std::vector<double>& analog, const std::vector<uint64_t>& digital);
+
+    std::string lastError_;
+};
+
+} // namespace io
+} // namespace vts
+
+#endif // VTS_IO_COMTRADE_WRITER_HPP
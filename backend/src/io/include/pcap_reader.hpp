@@ -0,0 +1,121 @@
+#ifndef VTS_IO_PCAP_READER_HPP
+#define VTS_IO_PCAP_READER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace vts {
+namespace io {
+
+/**
+ * @brief One captured frame, pointing into the mapped file
+ */
+struct PcapPacket {
+    const uint8_t* data;        // Frame bytes (valid while the reader stays open)
+    uint32_t capturedLength;    // Bytes available at data
+    uint32_t originalLength;    // Length on the wire
+    uint64_t timestampNs;       // Capture time since the epoch
+    uint16_t linkType;          // LINKTYPE_* of the capturing interface
+
+    PcapPacket() : data(nullptr), capturedLength(0), originalLength(0), timestampNs(0), linkType(0) {}
+};
+
+/**
+ * @brief Streaming pcap / pcapng reader over a memory-mapped file
+ *
+ * Supports classic pcap (micro- and nanosecond, either byte order) and
+ * pcapng (multiple sections and interfaces, if_tsresol, enhanced and simple
+ * packet blocks). Packets are returned in file order without copying.
+ */
+class PcapReader {
+public:
+    static constexpr uint16_t LinkTypeEthernet = 1;
+
+    enum class Format {
+        NONE,
+        PCAP,
+        PCAPNG
+    };
+
+    PcapReader();
+    ~PcapReader();
+
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+    /**
+     * @brief Map a capture file and read its header
+     * @param path File path
+     * @return true if the file is a pcap or pcapng capture
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the file; packets returned earlier become invalid
+     */
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    Format format() const { return format_; }
+    size_t fileSize() const { return size_; }
+
+    /**
+     * @brief Read the next packet
+     * @param packet Filled on success
+     * @return false at end of file or on a malformed record (see getLastError())
+     */
+    bool next(PcapPacket& packet);
+
+    /**
+     * @brief Restart from the first packet
+     */
+    void rewind();
+
+    /**
+     * @brief Get last error message
+     * @return Error description, empty after a clean end of file
+     */
+    std::string getLastError() const { return lastError_; }
+
+private:
+    struct Interface {
+        uint16_t linkType;
+        bool binaryResolution;  // if_tsresol MSB: 2^-n instead of 10^-n
+        uint8_t resolution;     // n
+    };
+
+    bool parseFileHeader();
+    bool nextPcap(PcapPacket& packet);
+    bool nextPcapNg(PcapPacket& packet);
+    bool parseSectionHeader(size_t offset);
+    void parseInterfaceBlock(const uint8_t* body, size_t length);
+
+    uint16_t read16(const uint8_t* p) const;
+    uint32_t read32(const uint8_t* p) const;
+    static uint64_t unitsToNs(uint64_t units, bool binary, uint8_t resolution);
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+    size_t firstRecord_;
+    Format format_;
+    bool bigEndian_;
+
+    // Classic pcap
+    bool nanosecond_;
+    uint16_t linkType_;
+
+    // pcapng: interfaces of the current section
+    std::vector<Interface> interfaces_;
+    uint64_t lastTimestampNs_;
+
+    std::vector<uint8_t> buffer_;   // Fallback storage where mmap is unavailable
+    std::string lastError_;
+};
+
+} // namespace io
+} // namespace vts
+
+#endif // VTS_IO_PCAP_READER_HPP
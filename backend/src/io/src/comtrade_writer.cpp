@@ -0,0 +1,186 @@
+#include "comtrade_writer.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+
+namespace vts {
+namespace io {
+
+static constexpr double INT16_FULL_SCALE = 32767.0;
+static constexpr size_t MAX_DIGITAL_CHANNELS = 64;
+
+static void putLe16(char* dst, uint16_t value) {
+    dst[0] = static_cast<char>(value & 0xFF);
+    dst[1] = static_cast<char>(value >> 8);
+}
+
+static void putLe32(char* dst, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        dst[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void ComtradeWriter::formatTimestamp(double utcSeconds, std::string& date, std::string& time) {
+    double whole = std::floor(utcSeconds);
+    long micros = std::lround((utcSeconds - whole) * 1e6);
+    if (micros >= 1000000) {
+        whole += 1.0;
+        micros -= 1000000;
+    }
+    std::time_t seconds = static_cast<std::time_t>(whole);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02d/%02d/%04d", utc.tm_mday, utc.tm_mon + 1, utc.tm_year + 1900);
+    date = buffer;
+    std::snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d.%06ld", utc.tm_hour, utc.tm_min, utc.tm_sec, micros);
+    time = buffer;
+}
+
+bool ComtradeWriter::write(const std::string& basePath, const ComtradeConfig& config,
+                           const std::vector<double>& analog, const std::vector<uint64_t>& digital) {
+    lastError_.clear();
+
+    const size_t analogCount = config.analogChannels.size();
+    const size_t digitalCount = config.digitalChannels.size();
+    if (analogCount == 0) {
+        lastError_ = "At least one analog channel is required";
+        return false;
+    }
+    if (digitalCount > MAX_DIGITAL_CHANNELS) {
+        lastError_ = "At most 64 digital channels are supported";
+        return false;
+    }
+    if (config.sampleRates.empty() || !(config.sampleRates[0].rate > 0.0)) {
+        lastError_ = "Sample rate must be positive";
+        return false;
+    }
+    if (analog.size() % analogCount != 0) {
+        lastError_ = "Analog data is not a whole number of rows";
+        return false;
+    }
+    const size_t rows = analog.size() / analogCount;
+    if (digitalCount > 0 && digital.size() != rows) {
+        lastError_ = "Digital data must have one word per row";
+        return false;
+    }
+
+    // Per-channel multiplier from the peak, so the int16 range is fully used
+    std::vector<double> peaks(analogCount, 0.0);
+    for (size_t r = 0; r < rows; r++) {
+        const double* row = analog.data() + r * analogCount;
+        for (size_t c = 0; c < analogCount; c++) {
+            peaks[c] = std::max(peaks[c], std::abs(row[c]));
+        }
+    }
+    std::vector<double> multipliers(analogCount);
+    for (size_t c = 0; c < analogCount; c++) {
+        multipliers[c] = peaks[c] > 0.0 && std::isfinite(peaks[c]) ? peaks[c] / INT16_FULL_SCALE : 1.0;
+    }
+
+    // Data first: a reader that finds the .cfg finds complete data
+    if (!writeDat(basePath + ".dat", analogCount, digitalCount, multipliers,
+                  config.sampleRates[0].rate, analog, digital)) {
+        return false;
+    }
+    return writeCfg(basePath + ".cfg", config, multipliers, rows);
+}
+
+bool ComtradeWriter::writeCfg(const std::string& path, const ComtradeConfig& config,
+                              const std::vector<double>& multipliers, size_t rows) {
+    std::ostringstream cfg;
+    cfg << std::setprecision(12);
+
+    const size_t analogCount = config.analogChannels.size();
+    const size_t digitalCount = config.digitalChannels.size();
+    cfg << config.stationName << "," << config.recDeviceId << ",1999\r\n";
+    cfg << (analogCount + digitalCount) << "," << analogCount << "A," << digitalCount << "D\r\n";
+
+    for (size_t c = 0; c < analogCount; c++) {
+        const AnalogChannel& ch = config.analogChannels[c];
+        cfg << (c + 1) << "," << ch.name << "," << ch.phase << "," << ch.ccbm << "," << ch.units << ","
+            << multipliers[c] << ",0," << ch.skew << ","
+            << -INT16_FULL_SCALE << "," << INT16_FULL_SCALE << ","
+            << (ch.primary > 0.0 ? ch.primary : 1.0) << ","
+            << (ch.secondary > 0.0 ? ch.secondary : 1.0) << ","
+            << (ch.ps == 'S' ? 'S' : 'P') << "\r\n";
+    }
+    for (size_t d = 0; d < digitalCount; d++) {
+        const DigitalChannel& ch = config.digitalChannels[d];
+        cfg << (d + 1) << "," << ch.name << "," << ch.phase << "," << ch.ccbm << ","
+            << (ch.normalState != 0 ? 1 : 0) << "\r\n";
+    }
+
+    cfg << config.lineFreq << "\r\n";
+    cfg << "1\r\n";
+    cfg << config.sampleRates[0].rate << "," << rows << "\r\n";
+    cfg << config.startDate << "," << config.startTime << "\r\n";
+    cfg << config.triggerDate << "," << config.triggerTime << "\r\n";
+    cfg << "BINARY\r\n";
+    cfg << "1\r\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        lastError_ = "Failed to open .cfg file: " + path;
+        return false;
+    }
+    const std::string text = cfg.str();
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    if (!file) {
+        lastError_ = "Failed to write .cfg file: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool ComtradeWriter::writeDat(const std::string& path, size_t analogCount, size_t digitalCount,
+                              const std::vector<double>& multipliers, double sampleRate,
+                              const std::vector<double>& analog, const std::vector<uint64_t>& digital) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        lastError_ = "Failed to open .dat file: " + path;
+        return false;
+    }
+
+    // Sample number, timestamp (us), int16 per analog, 16-bit words of digitals; little-endian
+    const size_t digitalWords = (digitalCount + 15) / 16;
+    const size_t recordSize = 8 + analogCount * 2 + digitalWords * 2;
+    const size_t rows = analog.size() / analogCount;
+    std::vector<char> record(recordSize);
+
+    for (size_t r = 0; r < rows; r++) {
+        putLe32(record.data(), static_cast<uint32_t>(r + 1));
+        putLe32(record.data() + 4, static_cast<uint32_t>(std::llround(static_cast<double>(r) * 1e6 / sampleRate)));
+
+        const double* row = analog.data() + r * analogCount;
+        for (size_t c = 0; c < analogCount; c++) {
+            double scaled = std::round(row[c] / multipliers[c]);
+            scaled = std::isfinite(scaled) ? std::clamp(scaled, -INT16_FULL_SCALE, INT16_FULL_SCALE) : 0.0;
+            putLe16(record.data() + 8 + c * 2, static_cast<uint16_t>(static_cast<int16_t>(scaled)));
+        }
+        for (size_t w = 0; w < digitalWords; w++) {
+            putLe16(record.data() + 8 + analogCount * 2 + w * 2,
+                    static_cast<uint16_t>((digital[r] >> (16 * w)) & 0xFFFF));
+        }
+        file.write(record.data(), static_cast<std::streamsize>(recordSize));
+    }
+
+    if (!file) {
+        lastError_ = "Failed to write .dat file: " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace io
+} // namespace vts
@@ -0,0 +1,340 @@
+#include "pcap_reader.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vts {
+namespace io {
+
+namespace {
+
+constexpr uint32_t PcapNgSectionHeader = 0x0A0D0D0A;
+constexpr uint32_t PcapNgInterfaceDescription = 0x00000001;
+constexpr uint32_t PcapNgSimplePacket = 0x00000003;
+constexpr uint32_t PcapNgEnhancedPacket = 0x00000006;
+constexpr uint16_t PcapNgOptionEnd = 0;
+constexpr uint16_t PcapNgOptionTsResol = 9;
+
+constexpr size_t PcapFileHeaderSize = 24;
+constexpr size_t PcapRecordHeaderSize = 16;
+
+size_t pad4(size_t n) {
+    return (n + 3) & ~static_cast<size_t>(3);
+}
+
+} // namespace
+
+PcapReader::PcapReader()
+    : data_(nullptr), size_(0), offset_(0), firstRecord_(0), format_(Format::NONE),
+      bigEndian_(false), nanosecond_(false), linkType_(0), lastTimestampNs_(0) {
+}
+
+PcapReader::~PcapReader() {
+    close();
+}
+
+void PcapReader::close() {
+#ifndef _WIN32
+    if (data_ != nullptr && buffer_.empty()) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+    buffer_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    offset_ = 0;
+    firstRecord_ = 0;
+    format_ = Format::NONE;
+    interfaces_.clear();
+    lastTimestampNs_ = 0;
+}
+
+bool PcapReader::open(const std::string& path) {
+    close();
+    lastError_.clear();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        lastError_ = "Cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        lastError_ = "Empty or unreadable file: " + path;
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        lastError_ = "mmap failed for " + path + ": " + std::strerror(errno);
+        size_ = 0;
+        return false;
+    }
+    madvise(mapped, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const uint8_t*>(mapped);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        lastError_ = "Cannot open " + path;
+        return false;
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (buffer_.empty()) {
+        lastError_ = "Empty file: " + path;
+        return false;
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+
+    if (!parseFileHeader()) {
+        std::string error = lastError_;
+        close();
+        lastError_ = error;
+        return false;
+    }
+    return true;
+}
+
+void PcapReader::rewind() {
+    offset_ = firstRecord_;
+    lastTimestampNs_ = 0;
+    if (format_ == Format::PCAPNG) {
+        // Interfaces are re-read from the first section
+        interfaces_.clear();
+        offset_ = 0;
+    }
+}
+
+bool PcapReader::next(PcapPacket& packet) {
+    if (data_ == nullptr) {
+        lastError_ = "No file open";
+        return false;
+    }
+    lastError_.clear();
+    return format_ == Format::PCAP ? nextPcap(packet) : nextPcapNg(packet);
+}
+
+uint16_t PcapReader::read16(const uint8_t* p) const {
+    return bigEndian_ ? static_cast<uint16_t>(p[0] << 8 | p[1])
+                      : static_cast<uint16_t>(p[1] << 8 | p[0]);
+}
+
+uint32_t PcapReader::read32(const uint8_t* p) const {
+    return bigEndian_
+        ? (static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+           static_cast<uint32_t>(p[2]) << 8 | p[3])
+        : (static_cast<uint32_t>(p[3]) << 24 | static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[1]) << 8 | p[0]);
+}
+
+uint64_t PcapReader::unitsToNs(uint64_t units, bool binary, uint8_t resolution) {
+    if (binary) {
+        // 2^-resolution seconds per unit
+        const uint64_t seconds = resolution >= 64 ? 0 : units >> resolution;
+        uint64_t fraction = resolution >= 64 ? units : units & ((uint64_t{1} << resolution) - 1);
+        uint8_t shift = resolution;
+        if (shift > 30) {
+            fraction >>= (shift - 30);
+            shift = 30;
+        }
+        return seconds * 1000000000ull + ((fraction * 1000000000ull) >> shift);
+    }
+    uint64_t ns = units;
+    for (uint8_t r = resolution; r < 9; ++r) ns *= 10;
+    for (uint8_t r = 9; r < resolution; ++r) ns /= 10;
+    return ns;
+}
+
+bool PcapReader::parseFileHeader() {
+    if (size_ < 12) {
+        lastError_ = "File too short for a capture header";
+        return false;
+    }
+
+    const uint8_t* p = data_;
+    // Classic pcap magic in file byte order
+    static const uint8_t leMicro[4] = {0xD4, 0xC3, 0xB2, 0xA1};
+    static const uint8_t beMicro[4] = {0xA1, 0xB2, 0xC3, 0xD4};
+    static const uint8_t leNano[4] = {0x4D, 0x3C, 0xB2, 0xA1};
+    static const uint8_t beNano[4] = {0xA1, 0xB2, 0x3C, 0x4D};
+
+    const bool isLeMicro = std::memcmp(p, leMicro, 4) == 0;
+    const bool isBeMicro = std::memcmp(p, beMicro, 4) == 0;
+    const bool isLeNano = std::memcmp(p, leNano, 4) == 0;
+    const bool isBeNano = std::memcmp(p, beNano, 4) == 0;
+    if (isLeMicro || isBeMicro || isLeNano || isBeNano) {
+        if (size_ < PcapFileHeaderSize) {
+            lastError_ = "Truncated pcap file header";
+            return false;
+        }
+        format_ = Format::PCAP;
+        bigEndian_ = isBeMicro || isBeNano;
+        nanosecond_ = isLeNano || isBeNano;
+        linkType_ = read16(p + 20);
+        firstRecord_ = offset_ = PcapFileHeaderSize;
+        return true;
+    }
+
+    uint32_t blockType;
+    std::memcpy(&blockType, p, 4);
+    if (blockType == PcapNgSectionHeader) {
+        format_ = Format::PCAPNG;
+        firstRecord_ = offset_ = 0;
+        return true;
+    }
+
+    lastError_ = "Not a pcap or pcapng file";
+    return false;
+}
+
+bool PcapReader::nextPcap(PcapPacket& packet) {
+    if (offset_ == size_) {
+        return false;
+    }
+    if (size_ - offset_ < PcapRecordHeaderSize) {
+        lastError_ = "Truncated record header at offset " + std::to_string(offset_);
+        return false;
+    }
+    const uint8_t* rec = data_ + offset_;
+    const uint32_t seconds = read32(rec);
+    const uint32_t fraction = read32(rec + 4);
+    const uint32_t capLen = read32(rec + 8);
+    const uint32_t origLen = read32(rec + 12);
+    if (capLen > size_ - offset_ - PcapRecordHeaderSize) {
+        lastError_ = "Truncated record at offset " + std::to_string(offset_);
+        return false;
+    }
+
+    packet.data = rec + PcapRecordHeaderSize;
+    packet.capturedLength = capLen;
+    packet.originalLength = origLen;
+    packet.timestampNs = static_cast<uint64_t>(seconds) * 1000000000ull +
+                         (nanosecond_ ? fraction : static_cast<uint64_t>(fraction) * 1000ull);
+    packet.linkType = linkType_;
+    offset_ += PcapRecordHeaderSize + capLen;
+    return true;
+}
+
+bool PcapReader::parseSectionHeader(size_t offset) {
+    static const uint8_t leMagic[4] = {0x4D, 0x3C, 0x2B, 0x1A};
+    static const uint8_t beMagic[4] = {0x1A, 0x2B, 0x3C, 0x4D};
+    if (std::memcmp(data_ + offset + 8, leMagic, 4) == 0) {
+        bigEndian_ = false;
+    } else if (std::memcmp(data_ + offset + 8, beMagic, 4) == 0) {
+        bigEndian_ = true;
+    } else {
+        lastError_ = "Bad pcapng byte-order magic at offset " + std::to_string(offset);
+        return false;
+    }
+    interfaces_.clear();
+    return true;
+}
+
+void PcapReader::parseInterfaceBlock(const uint8_t* body, size_t length) {
+    Interface iface;
+    iface.linkType = length >= 2 ? read16(body) : 0;
+    iface.binaryResolution = false;
+    iface.resolution = 6;
+
+    size_t pos = 8;  // LinkType, Reserved, SnapLen
+    while (pos + 4 <= length) {
+        const uint16_t code = read16(body + pos);
+        const uint16_t optLen = read16(body + pos + 2);
+        pos += 4;
+        if (code == PcapNgOptionEnd || pos + optLen > length) {
+            break;
+        }
+        if (code == PcapNgOptionTsResol && optLen >= 1) {
+            iface.binaryResolution = (body[pos] & 0x80) != 0;
+            iface.resolution = static_cast<uint8_t>(body[pos] & 0x7F);
+        }
+        pos += pad4(optLen);
+    }
+    interfaces_.push_back(iface);
+}
+
+bool PcapReader::nextPcapNg(PcapPacket& packet) {
+    while (offset_ < size_) {
+        if (size_ - offset_ < 12) {
+            lastError_ = "Truncated block at offset " + std::to_string(offset_);
+            return false;
+        }
+
+        uint32_t blockType;
+        std::memcpy(&blockType, data_ + offset_, 4);
+        if (blockType == PcapNgSectionHeader) {
+            // Byte order is only known after the magic; the type reads the same either way
+            if (size_ - offset_ < 28 || !parseSectionHeader(offset_)) {
+                if (lastError_.empty()) lastError_ = "Truncated section header at offset " + std::to_string(offset_);
+                return false;
+            }
+        } else {
+            blockType = read32(data_ + offset_);
+        }
+
+        const uint32_t blockLength = read32(data_ + offset_ + 4);
+        if (blockLength < 12 || blockLength % 4 != 0 || blockLength > size_ - offset_) {
+            lastError_ = "Bad block length " + std::to_string(blockLength) + " at offset " + std::to_string(offset_);
+            return false;
+        }
+
+        const uint8_t* body = data_ + offset_ + 8;
+        const size_t bodyLength = blockLength - 12;
+        offset_ += blockLength;
+
+        if (blockType == PcapNgInterfaceDescription) {
+            parseInterfaceBlock(body, bodyLength);
+        } else if (blockType == PcapNgEnhancedPacket) {
+            if (bodyLength < 20) {
+                lastError_ = "Truncated enhanced packet block";
+                return false;
+            }
+            const uint32_t ifId = read32(body);
+            const uint64_t units = static_cast<uint64_t>(read32(body + 4)) << 32 | read32(body + 8);
+            const uint32_t capLen = read32(body + 12);
+            if (ifId >= interfaces_.size() || capLen > bodyLength - 20) {
+                lastError_ = "Enhanced packet block with unknown interface or bad length";
+                return false;
+            }
+            const Interface& iface = interfaces_[ifId];
+            packet.data = body + 20;
+            packet.capturedLength = capLen;
+            packet.originalLength = read32(body + 16);
+            packet.timestampNs = unitsToNs(units, iface.binaryResolution, iface.resolution);
+            packet.linkType = iface.linkType;
+            lastTimestampNs_ = packet.timestampNs;
+            return true;
+        } else if (blockType == PcapNgSimplePacket) {
+            if (bodyLength < 4 || interfaces_.empty()) {
+                lastError_ = "Simple packet block without interface";
+                return false;
+            }
+            const uint32_t origLen = read32(body);
+            packet.data = body + 4;
+            packet.originalLength = origLen;
+            packet.capturedLength = static_cast<uint32_t>(std::min<size_t>(origLen, bodyLength - 4));
+            packet.timestampNs = lastTimestampNs_;  // SPB carries no timestamp
+            packet.linkType = interfaces_[0].linkType;
+            return true;
+        }
+        // Other blocks (statistics, name resolution, custom) are skipped
+    }
+    return false;
+}
+
+} // namespace io
+} // namespace vts
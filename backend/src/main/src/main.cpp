@@ -13,11 +13,27 @@
 #include "sv_sender.hpp"
 
 #include "tests.hpp"
+#include "pcap_replay.hpp"
+#include "load_generator.hpp"
+#include "relay_emulator.hpp"
+#include "impedance_calculator.hpp"
+#include "ramping_tester.hpp"
+#include "distance_tester.hpp"
+#include "overcurrent_tester.hpp"
+#include "differential_tester.hpp"
+#include "test_job_executor.hpp"
+#include "result_store.hpp"
 #include "http_server.hpp"
 #include "ws_server.hpp"
 #include "sv_publisher_manager.hpp"
 #include "sequence_engine.hpp"
 #include "analyzer_engine.hpp"
+#include "global_flags.hpp"
+#include "clock.hpp"
+#include "frame_loopback.hpp"
+#include "time_source.hpp"
+#include "rt_selftest.hpp"
+#include "thread_health.hpp"
 #include <time.h>
 #include <filesystem>
 #include <stdexcept>
@@ -696,10 +712,48 @@ struct AppConfig {
     bool no_net = false;      // Disable network operations
     bool selftest = false;    // Run self-test and exit
     bool help = false;        // Show help message
+    bool virtual_time = false; // Virtual clock and in-process loopback instead of the NIC
     LogLevel log_level = LogLevel::INFO;  // Default log level
     std::string log_file;     // Optional log file (empty = console only)
+    std::string ptp_device;   // PTP hardware clock for reference time (empty = CLOCK_TAI)
+    bool rt_selftest = false; // Measure wakeup latency on the RT cores and exit
+    bool rt_enforce = false;  // Refuse sample rates the RT self-test finds unsustainable
+    std::vector<int> publisher_cpus;  // SV tick loop cores (empty = unpinned)
+    std::vector<int> sniffer_cpus;    // Sniffer RX thread cores (empty = unpinned)
+    std::string results_dir = "results";  // Test result store (empty = memory only)
 };
 
+// Core list from an option or environment variable; a malformed one is ignored
+void parseCpuOption(const char* name, const std::string& value, std::vector<int>& cpus) {
+    if (parseCpuList(value, cpus)) {
+        std::cout << "[CONFIG] " << name << "=" << value << std::endl;
+    } else {
+        std::cerr << "Warning: Invalid core list for " << name << ": " << value << std::endl;
+    }
+}
+
+// Per-thread latency and per-rate verdicts of an RT self-test
+void logRtSelfTest(const RtSelfTestReport& report) {
+    for (const RtSelfTestThread& t : report.threads) {
+        const std::string where = t.cpu >= 0 ? "CPU " + std::to_string(t.cpu) : "any CPU";
+        LOG_INFO("RT", "Self-test %s thread on %s: %llu wakeups, max %lld us, p99.9 %lld us, %llu overruns%s",
+                 t.role.c_str(), where.c_str(),
+                 static_cast<unsigned long long>(t.latency.count()),
+                 static_cast<long long>(t.latency.max() / 1000),
+                 static_cast<long long>(t.latency.percentile(0.999) / 1000),
+                 static_cast<unsigned long long>(t.overruns),
+                 t.realtime ? "" : " (no SCHED_FIFO)");
+    }
+    for (const auto& rate : report.toJson()["rates"]) {
+        const std::string verdict = rate["verdict"];
+        if (verdict == "OK") {
+            LOG_INFO("RT", "Self-test: %u Hz %s", rate["sampleRate"].get<unsigned>(), verdict.c_str());
+        } else {
+            LOG_WARN("RT", "Self-test: %u Hz %s", rate["sampleRate"].get<unsigned>(), verdict.c_str());
+        }
+    }
+}
+
 // Parse log level from string
 LogLevel parseLogLevel(const std::string& level) {
     if (level == "DEBUG") return LogLevel::DEBUG;
@@ -721,12 +775,46 @@ AppConfig parseArgs(int argc, char* argv[]) {
         std::cout << "[CONFIG] VTS_NO_NET environment variable set - network operations disabled" << std::endl;
     }
     
+    const char* env_virtual_time = std::getenv("VTS_VIRTUAL_TIME");
+    if (env_virtual_time && (std::string(env_virtual_time) == "1" || std::string(env_virtual_time) == "true")) {
+        config.virtual_time = true;
+        std::cout << "[CONFIG] VTS_VIRTUAL_TIME environment variable set - virtual-time mode" << std::endl;
+    }
+    
     const char* env_log_level = std::getenv("VTS_LOG_LEVEL");
     if (env_log_level) {
         config.log_level = parseLogLevel(env_log_level);
         std::cout << "[CONFIG] VTS_LOG_LEVEL=" << env_log_level << std::endl;
     }
     
+    const char* env_ptp_device = std::getenv("VTS_PTP_DEVICE");
+    if (env_ptp_device) {
+        config.ptp_device = env_ptp_device;
+        std::cout << "[CONFIG] VTS_PTP_DEVICE=" << env_ptp_device << std::endl;
+    }
+    
+    const char* env_rt_enforce = std::getenv("VTS_RT_ENFORCE");
+    if (env_rt_enforce && (std::string(env_rt_enforce) == "1" || std::string(env_rt_enforce) == "true")) {
+        config.rt_enforce = true;
+        std::cout << "[CONFIG] VTS_RT_ENFORCE set - unsustainable sample rates are refused" << std::endl;
+    }
+    
+    const char* env_publisher_cpus = std::getenv("VTS_PUBLISHER_CPUS");
+    if (env_publisher_cpus) {
+        parseCpuOption("VTS_PUBLISHER_CPUS", env_publisher_cpus, config.publisher_cpus);
+    }
+    
+    const char* env_sniffer_cpus = std::getenv("VTS_SNIFFER_CPUS");
+    if (env_sniffer_cpus) {
+        parseCpuOption("VTS_SNIFFER_CPUS", env_sniffer_cpus, config.sniffer_cpus);
+    }
+    
+    const char* env_results_dir = std::getenv("VTS_RESULTS_DIR");
+    if (env_results_dir) {
+        config.results_dir = env_results_dir;
+        std::cout << "[CONFIG] VTS_RESULTS_DIR=" << env_results_dir << std::endl;
+    }
+    
     const char* env_log_file = std::getenv("VTS_LOG_FILE");
     if (env_log_file) {
         config.log_file = env_log_file;
@@ -751,11 +839,30 @@ AppConfig parseArgs(int argc, char* argv[]) {
         } else if (arg == "--selftest") {
             config.selftest = true;
             std::cout << "[CONFIG] --selftest flag specified" << std::endl;
+        } else if (arg == "--rt-selftest") {
+            config.rt_selftest = true;
+            std::cout << "[CONFIG] --rt-selftest flag specified" << std::endl;
+        } else if (arg == "--rt-enforce") {
+            config.rt_enforce = true;
+            std::cout << "[CONFIG] --rt-enforce flag specified" << std::endl;
+        } else if (arg == "--publisher-cpus" && i + 1 < argc) {
+            parseCpuOption("--publisher-cpus", argv[++i], config.publisher_cpus);
+        } else if (arg == "--sniffer-cpus" && i + 1 < argc) {
+            parseCpuOption("--sniffer-cpus", argv[++i], config.sniffer_cpus);
+        } else if (arg == "--virtual-time") {
+            config.virtual_time = true;
+            std::cout << "[CONFIG] --virtual-time flag specified" << std::endl;
         } else if (arg == "--help" || arg == "-h") {
             config.help = true;
         } else if (arg == "--log-level" && i + 1 < argc) {
             config.log_level = parseLogLevel(argv[++i]);
             std::cout << "[CONFIG] --log-level=" << argv[i] << std::endl;
+        } else if (arg == "--ptp-device" && i + 1 < argc) {
+            config.ptp_device = argv[++i];
+            std::cout << "[CONFIG] --ptp-device=" << config.ptp_device << std::endl;
+        } else if (arg == "--results-dir" && i + 1 < argc) {
+            config.results_dir = argv[++i];
+            std::cout << "[CONFIG] --results-dir=" << config.results_dir << std::endl;
         } else if (arg == "--log-file" && i + 1 < argc) {
             config.log_file = argv[++i];
             std::cout << "[CONFIG] --log-file=" << config.log_file << std::endl;
@@ -776,12 +883,26 @@ void printHelp(const char* progName) {
     std::cout << "  --no-net                Disable network operations (safe mode)\n";
     std::cout << "  --enable-net            Enable network operations (override macOS default)\n";
     std::cout << "  --selftest              Run self-test and exit (instantiate modules without I/O)\n";
+    std::cout << "  --rt-selftest           Measure wakeup latency on the RT cores, print the report and exit\n";
+    std::cout << "                          (exit code 1 if 4800 Hz cannot be sustained)\n";
+    std::cout << "  --rt-enforce            Refuse SV sample rates the startup RT self-test finds unsustainable\n";
+    std::cout << "  --publisher-cpus <list> Pin the SV tick loop to these cores (e.g. 2,3 or 2-3)\n";
+    std::cout << "  --sniffer-cpus <list>   Pin the sniffer RX thread to these cores\n";
+    std::cout << "  --virtual-time          Run faster than real time: virtual clock, frames looped back in-process\n";
     std::cout << "  --log-level <level>     Set log level: DEBUG, INFO, WARN, ERROR, NONE (default: INFO)\n";
-    std::cout << "  --log-file <path>       Write logs to file (in addition to console)\n\n";
+    std::cout << "  --log-file <path>       Write logs to file (in addition to console)\n";
+    std::cout << "  --ptp-device <path>     Align SV sample timing to a PTP hardware clock (e.g. /dev/ptp0)\n";
+    std::cout << "  --results-dir <path>    Keep relay test results here (default: results; \"\" = memory only)\n\n";
     std::cout << "Environment Variables:\n";
     std::cout << "  VTS_NO_NET=1            Disable network operations\n";
+    std::cout << "  VTS_VIRTUAL_TIME=1      Same as --virtual-time\n";
     std::cout << "  VTS_LOG_LEVEL=<level>   Set log level (DEBUG, INFO, WARN, ERROR, NONE)\n";
     std::cout << "  VTS_LOG_FILE=<path>     Write logs to file\n";
+    std::cout << "  VTS_PTP_DEVICE=<path>   Same as --ptp-device\n";
+    std::cout << "  VTS_RT_ENFORCE=1        Same as --rt-enforce\n";
+    std::cout << "  VTS_PUBLISHER_CPUS=<list> Same as --publisher-cpus\n";
+    std::cout << "  VTS_SNIFFER_CPUS=<list> Same as --sniffer-cpus\n";
+    std::cout << "  VTS_RESULTS_DIR=<path>  Same as --results-dir\n";
     std::cout << "  IF_NAME=<iface>         Override network interface name\n\n";
     std::cout << "Platform: " << vts::platform::get_platform_info() << "\n";
     std::cout << "Network support: " << (vts::platform::network_operations_supported() ? "Yes" : "No") << "\n";
@@ -802,6 +923,7 @@ int main(int argc, char* argv[]){
     // Phase 12: Initialize logger and metrics
     Logger::init(config.log_level, config.log_file);
     Metrics::init();
+    ThreadHealth::start();
     
     LOG_INFO("MAIN", "==================================================");
     LOG_INFO("MAIN", "Virtual TestSet - IEC 61850 GOOSE/SV Test System");
@@ -876,6 +998,21 @@ int main(int argc, char* argv[]){
         return 0;
     }
     
+    // RT self-test mode: the publisher and sniffer cores' wakeup latency
+    RtSelfTestConfig rtSelfTest;
+    rtSelfTest.publisherCpus = config.publisher_cpus;
+    rtSelfTest.snifferCpus = config.sniffer_cpus;
+    if (config.rt_selftest) {
+        LOG_INFO("RT", "Running RT self-test for %llu s...",
+                 static_cast<unsigned long long>(rtSelfTest.durationNs / 1000000000ULL));
+        const RtSelfTestReport report = runRtSelfTest(rtSelfTest);
+        logRtSelfTest(report);
+        std::cout << report.toJson().dump(2) << std::endl;
+        Metrics::printSummary();
+        Logger::shutdown();
+        return report.verdict(4800) == RateVerdict::Unsustainable ? 1 : 0;
+    }
+    
     // Phase 11: Check if network operations are allowed
     if (config.no_net) {
         LOG_INFO("NET", "Network operations disabled (--no-net mode)");
@@ -891,13 +1028,56 @@ int main(int argc, char* argv[]){
     // TCPServer server(8080);
     // server.start();
     
+    // Virtual time: every timed module runs on one VirtualClock and frames
+    // loop back to the sniffer in-process, so runs are CPU-bound and repeatable
+    std::shared_ptr<Clock> clock = systemClock();
+    std::shared_ptr<FrameLoopback> loopback;
+    if (config.virtual_time) {
+        clock = std::make_shared<VirtualClock>();
+        loopback = std::make_shared<FrameLoopback>();
+        LOG_INFO("MAIN", "Virtual-time mode: publisher frames are looped back, not sent to the NIC");
+    }
+    
     // Initialize HTTP server and SV Publisher Manager
     LOG_INFO("HTTP", "Initializing HTTP API server and SV Publisher Manager...");
     auto svManager = std::make_shared<SVPublisherManager>();
+    svManager->setClock(clock);
+    svManager->setLoopback(loopback);
+    
+    // Reference time: streams pace samples on it with smpCnt 0 on its second
+    // (CLOCK_TAI stands in without a PHC); virtual runs pace on the virtual clock
+    if (!config.virtual_time) {
+        std::shared_ptr<TimeSource> timeSource;
+        if (!config.ptp_device.empty()) {
+            std::string error;
+            timeSource = TimeSource::openPhc(config.ptp_device, error);
+            if (!timeSource) {
+                LOG_WARN("TIME", "PTP clock unavailable (%s), using CLOCK_TAI", error.c_str());
+            }
+        }
+        if (!timeSource) {
+            timeSource = TimeSource::systemTai();
+        }
+        setSystemTimeSource(timeSource);
+        svManager->setTimeSource(timeSource);
+        LOG_INFO("TIME", "Reference time: %s, smpSynch %u", timeSource->status().reference.c_str(),
+                 static_cast<unsigned>(timeSource->smpSynch()));
+    }
+    
+    // Short RT self-test: stream sample rates are checked against it
+    // (meaningless under a virtual clock)
+    svManager->setRtEnforce(config.rt_enforce);
+    if (!config.virtual_time) {
+        rtSelfTest.durationNs = RtSelfTest_StartupNs;
+        auto report = std::make_shared<const RtSelfTestReport>(runRtSelfTest(rtSelfTest));
+        logRtSelfTest(*report);
+        svManager->setRtReport(report);
+    }
     
     // Initialize Sequence Engine
     LOG_INFO("SEQ", "Initializing Sequence Engine...");
     auto sequenceEngine = std::make_shared<vts::sequence::SequenceEngine>();
+    sequenceEngine->setClock(clock);
     
     // Initialize Analyzer Engine
     LOG_INFO("ANALYZER", "Initializing Analyzer Engine...");
@@ -906,16 +1086,52 @@ int main(int argc, char* argv[]){
     // Initialize Sniffer for network packet capture
     LOG_INFO("SNIFFER", "Initializing network packet sniffer...");
     auto sniffer = std::make_shared<SnifferClass>();
+    sniffer->cpus = config.sniffer_cpus;
+    if (loopback) {
+        sniffer->injectOnly = true;
+        loopback->attach([sniffer](const uint8_t* frame, size_t length) {
+            sniffer->injectFrame(frame, length);
+        });
+    }
     
     HTTPServer httpServer(8081);  // Use different port than TCP server
     httpServer.setSVPublisherManager(svManager);
     httpServer.setSequenceEngine(sequenceEngine);
     httpServer.setAnalyzerEngine(analyzerEngine);
+    httpServer.setSniffer(sniffer);
+    httpServer.setPcapReplay(std::make_shared<PcapReplay>());
+    httpServer.setLoadGenerator(std::make_shared<LoadGenerator>());
+    auto relayEmulator = std::make_shared<RelayEmulator>(clock);
+    if (loopback) {
+        relayEmulator->setLoopback(loopback);
+    }
+    httpServer.setRelayEmulator(relayEmulator);
+    
+    // Relay testers, run one at a time by the test job executor
+    httpServer.setImpedanceCalculator(std::make_shared<vts::testers::ImpedanceCalculator>());
+    httpServer.setRampingTester(std::make_shared<vts::testers::RampingTester>());
+    httpServer.setDistanceTester(std::make_shared<vts::testers::DistanceTester>());
+    httpServer.setOvercurrentTester(std::make_shared<vts::testers::OvercurrentTester>());
+    httpServer.setDifferentialTester(std::make_shared<vts::testers::DifferentialTester>());
+    auto testJobs = std::make_shared<vts::testers::TestJobExecutor>();
+    httpServer.setTestJobExecutor(testJobs);
+    httpServer.setClock(clock);
+    
+    // Every finished test is kept, per relay, for GET /api/v1/results
+    auto resultStore = std::make_shared<vts::testers::ResultStore>(config.results_dir);
+    const vts::testers::ResultStoreStatus resultStatus = resultStore->status();
+    LOG_INFO("MAIN", "Result store: %llu results from %llu relays in %s",
+             static_cast<unsigned long long>(resultStatus.records),
+             static_cast<unsigned long long>(resultStatus.relays),
+             resultStatus.path.empty() ? "memory" : resultStatus.path.c_str());
+    httpServer.setResultStore(resultStore);
+    httpServer.setRtSelfTestConfig(rtSelfTest);
     
     // Initialize WebSocket server
     LOG_INFO("WS", "Initializing WebSocket server...");
     auto wsServer = std::make_shared<WSServer>(8082);  // WebSocket on port 8082
     httpServer.setWSServer(wsServer.get());
+    wsServer->setPublisherManager(svManager);
     
     // Wire sequence engine callbacks
     sequenceEngine->setProgressCallback([wsServer](size_t currentState, size_t totalStates,
@@ -932,6 +1148,13 @@ int main(int argc, char* argv[]){
         wsServer->broadcast(Topic::SEQUENCE_PROGRESS, progress);
     });
     
+    testJobs->setListener([wsServer](const vts::testers::TestJobInfo& job) {
+        nlohmann::json update = job.toJson(job.finished());
+        update["type"] = "testJob";
+        
+        wsServer->broadcast(Topic::TEST_JOBS, update);
+    });
+    
     sequenceEngine->setPhasorUpdateCallback([svManager](const std::string& streamId,
                                                          const vts::sequence::StreamPhasorState& state) {
         // Convert sequence phasor state to SV manager format
@@ -979,6 +1202,93 @@ int main(int argc, char* argv[]){
         analysisData["channels"] = channels;
         
         wsServer->broadcast(Topic::ANALYZER_PHASORS, analysisData);
+        
+        if (frame.groups.empty()) {
+            return;
+        }
+        auto polar = [](std::complex<double> z) {
+            constexpr double degrees = 180.0 / 3.14159265358979323846;
+            return nlohmann::json{{"magnitude", std::abs(z)}, {"angleDeg", std::arg(z) * degrees}};
+        };
+        auto rect = [](std::complex<double> z) {
+            return nlohmann::json{{"r", z.real()}, {"x", z.imag()}};
+        };
+        static const char* const sequenceNames[] = {"zero", "positive", "negative"};
+        static const char* const phaseNames[] = {"A", "B", "C"};
+        static const char* const loopNames[] = {"AG", "BG", "CG", "AB", "BC", "CA"};
+        
+        nlohmann::json groups = nlohmann::json::array();
+        for (const auto& g : frame.groups) {
+            nlohmann::json groupData;
+            groupData["name"] = g.name;
+            for (size_t k = 0; k < 3; ++k) {
+                groupData["voltageSequence"][sequenceNames[k]] = polar(g.voltageSequence[k]);
+                groupData["currentSequence"][sequenceNames[k]] = polar(g.currentSequence[k]);
+                groupData["power"][phaseNames[k]] = {
+                    {"p", g.phasePower[k].real()},
+                    {"q", g.phasePower[k].imag()},
+                    {"s", std::abs(g.phasePower[k])}
+                };
+                groupData["differential"][phaseNames[k]] = {
+                    {"operate", g.differential[k]},
+                    {"restraint", g.restraint[k]}
+                };
+            }
+            groupData["power"]["total"] = {
+                {"p", g.totalPower.real()},
+                {"q", g.totalPower.imag()},
+                {"s", std::abs(g.totalPower)},
+                {"pf", g.powerFactor}
+            };
+            for (size_t loop = 0; loop < 6; ++loop) {
+                groupData["impedance"][loopNames[loop]] = rect(g.impedance[loop]);
+            }
+            groups.push_back(groupData);
+        }
+        
+        wsServer->broadcast(Topic::ANALYZER_GROUPS, {
+            {"timestamp", analysisData["timestamp"]},
+            {"streamId", frame.streamId},
+            {"groups", groups}
+        });
+    });
+    
+    analyzerEngine->setPowerQualityCallback([wsServer](const std::vector<vts::analyzer::PqRecord>& records,
+                                                       const std::vector<vts::analyzer::PqEvent>& events) {
+        static const char* const intervalNames[] = {"window", "150/180-cycle", "10min", "2h"};
+        
+        nlohmann::json recordData = nlohmann::json::array();
+        for (const auto& r : records) {
+            recordData.push_back({
+                {"interval", intervalNames[static_cast<int>(r.interval)]},
+                {"channel", r.channel},
+                {"start", r.startTime},
+                {"end", r.endTime},
+                {"values", r.values},
+                {"flagged", r.flagged},
+                {"rms", r.rms},
+                {"frequency", r.frequency},
+                {"thd", r.thd},
+                {"harmonics", r.harmonics},
+                {"interharmonics", r.interharmonics}
+            });
+        }
+        
+        nlohmann::json eventData = nlohmann::json::array();
+        for (const auto& e : events) {
+            eventData.push_back({
+                {"type", e.type == vts::analyzer::PqEvent::Type::Dip ? "dip" : "swell"},
+                {"channel", e.channel},
+                {"start", e.startTime},
+                {"duration", e.duration},
+                {"extreme", e.extreme}
+            });
+        }
+        
+        wsServer->broadcast(Topic::ANALYZER_PQ, {
+            {"records", recordData},
+            {"events", eventData}
+        });
     });
     
     analyzerEngine->setWaveformCallback([wsServer](const std::vector<vts::analyzer::WaveformData>& waveforms) {
@@ -1000,6 +1310,11 @@ int main(int argc, char* argv[]){
     sniffer->setAnalyzerEngine(analyzerEngine);
     sniffer->setWebSocketServer(wsServer);
     
+    // GOOSE-mapped binary inputs, shared by the sniffer and the disturbance recorder
+    auto digitalInputs = std::make_shared<DigitalInputBank>();
+    sniffer->digitalInput = digitalInputs.get();
+    analyzerEngine->setRecorderSources(digitalInputs.get(), &vts::GLOBAL_TRIP_FLAG);
+    
     LOG_INFO("SNIFFER", "Analyzer engine wired to sniffer for live SV processing");
     
     // Start both servers
@@ -1013,17 +1328,26 @@ int main(int argc, char* argv[]){
 
     // Main tick loop for SV publishers
     LOG_INFO("SV", "Starting SV publisher tick loop...");
+    ClockParticipant tickParticipant(*clock);
+    ThreadHealth::Scope tickHealth("publisher");
+    if (!config.virtual_time) {
+        if (!config.publisher_cpus.empty()) {
+            rt_set_affinity(config.publisher_cpus);
+        }
+        rt_set_realtime(SV_TickThreadPriority);
+    }
     while (true) {
         svManager->tickAll();
         
-        // Sleep for 100 microseconds between ticks
-        // This gives ~10kHz tick rate which is more than sufficient for 4800 samples/sec
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        // Sleep for 100 microseconds between ticks; streams send every
+        // sample due by then, so the tick rate need not match any sample rate
+        clock->sleepFor(std::chrono::nanoseconds(SV_TickPeriodNs));
     }
     
     // Cleanup (unreachable in current implementation - would need signal handler)
     wsServer->stop();
     httpServer.stop();
+    ThreadHealth::stop();
     Metrics::printSummary();
     Logger::shutdown();
 
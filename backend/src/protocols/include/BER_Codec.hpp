@@ -0,0 +1,245 @@
+#ifndef BER_CODEC_HPP
+#define BER_CODEC_HPP
+
+// ============================================================================
+// Zero-allocation BER (ITU-T X.690) writer and reader
+// ============================================================================
+// Both classes work on caller-provided memory and never touch the heap.
+//
+// Writing uses two passes: the caller first adds up content sizes with
+// berTLVSize(), then writes each TLV with its exact length prefix, so no
+// temporary buffer or back-patching is needed.
+//
+//   size_t asdu = berTLVSize(svID.size()) + berTLVSize(2) + ...;
+//   BERWriter w(buf, sizeof(buf));
+//   w.putHeader(0x30, asdu);
+//   w.putTLV(0x80, svID.data(), svID.size());
+//   ...
+//   if (!w.ok()) { /* buffer too small */ }
+//
+// Reading uses a cursor over a byte range. Every accessor bounds-checks and
+// returns false on truncated or malformed input; a nested TLV is opened as a
+// sub-reader limited to its content.
+//
+//   BERReader r(frame + offset, frameSize - offset);
+//   uint8_t tag; BERReader pdu;
+//   if (!r.readTLV(tag, pdu) || tag != 0x60) return;
+// ============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Encoded size of a length field (short form, 0x81, 0x82, 0x83 or 0x84 long form)
+constexpr size_t berLengthSize(size_t length) {
+    return length <= 0x7F ? 1
+         : length <= 0xFF ? 2
+         : length <= 0xFFFF ? 3
+         : length <= 0xFFFFFF ? 4
+         : 5;
+}
+
+// Encoded size of a complete single-byte-tag TLV with `contentLength` bytes of value
+constexpr size_t berTLVSize(size_t contentLength) {
+    return 1 + berLengthSize(contentLength) + contentLength;
+}
+
+class BERWriter {
+public:
+    BERWriter(uint8_t* buffer, size_t capacity)
+        : buf_(buffer), cap_(capacity), pos_(0), overflow_(false) {}
+
+    // False once any write did not fit; nothing past capacity is written
+    bool ok() const { return !overflow_; }
+    size_t size() const { return pos_; }
+    uint8_t* data() const { return buf_; }
+
+    void putByte(uint8_t value) {
+        if (!reserve(1)) return;
+        buf_[pos_++] = value;
+    }
+
+    void putBytes(const void* src, size_t len) {
+        if (!reserve(len)) return;
+        if (len > 0) {
+            std::memcpy(buf_ + pos_, src, len);
+        }
+        pos_ += len;
+    }
+
+    void putZeros(size_t len) {
+        if (!reserve(len)) return;
+        std::memset(buf_ + pos_, 0, len);
+        pos_ += len;
+    }
+
+    void putU16(uint16_t value) {
+        if (!reserve(2)) return;
+        buf_[pos_++] = static_cast<uint8_t>(value >> 8);
+        buf_[pos_++] = static_cast<uint8_t>(value & 0xFF);
+    }
+
+    void putU32(uint32_t value) {
+        if (!reserve(4)) return;
+        buf_[pos_++] = static_cast<uint8_t>(value >> 24);
+        buf_[pos_++] = static_cast<uint8_t>((value >> 16) & 0xFF);
+        buf_[pos_++] = static_cast<uint8_t>((value >> 8) & 0xFF);
+        buf_[pos_++] = static_cast<uint8_t>(value & 0xFF);
+    }
+
+    void putLength(size_t length) {
+        const size_t n = berLengthSize(length);
+        if (!reserve(n)) return;
+        if (n == 1) {
+            buf_[pos_++] = static_cast<uint8_t>(length);
+            return;
+        }
+        buf_[pos_++] = static_cast<uint8_t>(0x80 | (n - 1));
+        for (size_t i = n - 1; i > 0; --i) {
+            buf_[pos_++] = static_cast<uint8_t>((length >> ((i - 1) * 8)) & 0xFF);
+        }
+    }
+
+    // Tag and length of a TLV whose content the caller writes next
+    void putHeader(uint8_t tag, size_t contentLength) {
+        putByte(tag);
+        putLength(contentLength);
+    }
+
+    void putTLV(uint8_t tag, const void* value, size_t len) {
+        putHeader(tag, len);
+        putBytes(value, len);
+    }
+
+    void putU8TLV(uint8_t tag, uint8_t value) {
+        putHeader(tag, 1);
+        putByte(value);
+    }
+
+    void putU16TLV(uint8_t tag, uint16_t value) {
+        putHeader(tag, 2);
+        putU16(value);
+    }
+
+    void putU32TLV(uint8_t tag, uint32_t value) {
+        putHeader(tag, 4);
+        putU32(value);
+    }
+
+    void putBoolTLV(uint8_t tag, bool value) {
+        putU8TLV(tag, value ? 0xFF : 0x00);
+    }
+
+private:
+    bool reserve(size_t len) {
+        if (overflow_ || len > cap_ - pos_) {
+            overflow_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    uint8_t* buf_;
+    size_t cap_;
+    size_t pos_;
+    bool overflow_;
+};
+
+class BERReader {
+public:
+    BERReader() : data_(nullptr), size_(0), pos_(0) {}
+    BERReader(const uint8_t* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+    size_t remaining() const { return size_ - pos_; }
+    size_t offset() const { return pos_; }
+    bool empty() const { return pos_ >= size_; }
+    const uint8_t* current() const { return data_ + pos_; }
+
+    bool peek(uint8_t& value) const {
+        if (empty()) return false;
+        value = data_[pos_];
+        return true;
+    }
+
+    bool readU8(uint8_t& value) {
+        if (!peek(value)) return false;
+        ++pos_;
+        return true;
+    }
+
+    bool readU16(uint16_t& value) {
+        if (remaining() < 2) return false;
+        value = static_cast<uint16_t>((data_[pos_] << 8) | data_[pos_ + 1]);
+        pos_ += 2;
+        return true;
+    }
+
+    bool readU32(uint32_t& value) {
+        if (remaining() < 4) return false;
+        value = (static_cast<uint32_t>(data_[pos_]) << 24) |
+                (static_cast<uint32_t>(data_[pos_ + 1]) << 16) |
+                (static_cast<uint32_t>(data_[pos_ + 2]) << 8) |
+                static_cast<uint32_t>(data_[pos_ + 3]);
+        pos_ += 4;
+        return true;
+    }
+
+    bool skip(size_t len) {
+        if (remaining() < len) return false;
+        pos_ += len;
+        return true;
+    }
+
+    // Definite-form length, up to 4 length octets
+    bool readLength(size_t& length) {
+        uint8_t first;
+        if (!readU8(first)) return false;
+        if ((first & 0x80) == 0) {
+            length = first;
+            return true;
+        }
+        const size_t n = first & 0x7F;
+        if (n == 0 || n > 4 || remaining() < n) return false;  // indefinite or oversized
+        length = 0;
+        for (size_t i = 0; i < n; ++i) {
+            length = (length << 8) | data_[pos_++];
+        }
+        return true;
+    }
+
+    // Tag and length; the cursor is left at the start of the content
+    bool readHeader(uint8_t& tag, size_t& length) {
+        size_t start = pos_;
+        if (!readU8(tag) || !readLength(length) || remaining() < length) {
+            pos_ = start;
+            return false;
+        }
+        return true;
+    }
+
+    // Whole TLV; `value` covers the content and the cursor moves past it
+    bool readTLV(uint8_t& tag, BERReader& value) {
+        size_t length;
+        if (!readHeader(tag, length)) return false;
+        value = BERReader(data_ + pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+    // Big-endian unsigned INTEGER content of up to 4 bytes
+    bool readUnsigned(uint32_t& value) {
+        if (remaining() == 0 || remaining() > 4) return false;
+        value = 0;
+        while (!empty()) {
+            value = (value << 8) | data_[pos_++];
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+#endif // BER_CODEC_HPP
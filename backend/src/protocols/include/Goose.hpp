@@ -8,9 +8,10 @@
 #include <inttypes.h>
 #include <cstring>
 #include <stdexcept>
+#include <climits>
 
 #include "IEC61850_Types.hpp"
-#include "BER_Encoding.hpp"
+#include "BER_Codec.hpp"
 
 
 class Goose {
@@ -33,10 +34,10 @@ public:
     std::vector<Data> allData;
 
     mutable std::vector<uint8_t> encoded;
+    // Field name -> offset of the field value from the start of the encoded
+    // buffer (EtherType). Filled by getEncoded().
     mutable std::unordered_map<std::string, size_t> indices;
 
-    int offSet;
-
         Goose(const std::string& /*srcMAC*/, const std::string& /*dstMAC*/, uint16_t appID,
               uint16_t /*vlan_id*/, const std::string& gocbRef, uint32_t timeAllowedToLive,
               const std::string& datSet, const std::string& /*goID*/, UtcTime t, uint32_t stNum,
@@ -44,183 +45,138 @@ public:
               const std::vector<Data>& allData)
         : appID(appID), gocbRef(gocbRef), timeAllowedtoLive(static_cast<int32_t>(timeAllowedToLive)), datSet(datSet),
           t(t), stNum(static_cast<int32_t>(stNum)), sqNum(static_cast<int32_t>(sqNum)), 
-          confRev(static_cast<int32_t>(confRev)), numDatSetEntries(0), allData(allData), offSet(0) {}
+          confRev(static_cast<int32_t>(confRev)), numDatSetEntries(0), allData(allData) {}
 
     int getParamPos(const std::string& param) const {
         auto it = indices.find(param);
         if (it != indices.end()) {
-            return static_cast<int>(it->second + static_cast<size_t>(this->offSet));
+            return static_cast<int>(it->second);
         }
         return -1;
     }
 
-    std::vector<uint8_t> getEncoded() {
-        encoded.clear();  // Clear previous encoding
-        encoded.reserve(2048);
-
-        std::vector<uint8_t> pduEncoded = this->getPduEncoded();
+    // Exact size of the frame from the EtherType onwards
+    size_t encodedSize() const {
+        return 10 + berTLVSize(pduContentSize());
+    }
 
-        uint16_t pduSize = static_cast<uint16_t>(pduEncoded.size());
-        uint16_t length = 8 + 2 + pduSize;
-        offSet = 14;
+    // Encode into caller memory without allocating. Returns the number of
+    // bytes written, or 0 if `capacity` is too small.
+    size_t encodeTo(uint8_t* buffer, size_t capacity) {
+        BERWriter w(buffer, capacity);
+        write(w, false);
+        return w.ok() ? w.size() : 0;
+    }
 
-    numDatSetEntries = static_cast<int32_t>(allData.size());
+    std::vector<uint8_t> getEncoded() {
+        encoded.assign(encodedSize(), 0);
+        indices.clear();
 
-        if (pduSize > 0xff) {
-            length += 2;
-            offSet += 2;
-        } else if (pduSize > 0x80) {
-            length += 1;
-            offSet += 1;
-        }
+        BERWriter w(encoded.data(), encoded.size());
+        write(w, true);
+        return encoded;
+    }
 
-        // EtherType
-        encoded.push_back(0x88);
-        encoded.push_back(0xb8);
-
-        // APPID
-        encoded.push_back((appID >> 8) & 0xFF);
-        encoded.push_back(appID & 0xFF);
-
-        // Length 
-        encoded.push_back((length >> 8) & 0xFF);
-        encoded.push_back(length & 0xFF);
-
-        // Reserved 1
-        encoded.push_back((reserved1 >> 8) & 0xFF);
-        encoded.push_back(reserved1 & 0xFF);
-
-        // Reserved 2
-        encoded.push_back((reserved2 >> 8) & 0xFF);
-        encoded.push_back(reserved2 & 0xFF);
-
-        // PDU
-        encoded.push_back(0x61);
-        if (pduSize > 0xff) {
-            encoded.push_back(0x82);
-            encoded.push_back((pduSize >> 8) & 0xFF);
-            encoded.push_back(pduSize & 0xFF);
-        } else if (pduSize > 0x80) {
-            encoded.push_back(0x81);
-            encoded.push_back(pduSize & 0xFF);
-        } else {
-            encoded.push_back(pduSize & 0xFF);
+private:
+    size_t allDataContentSize() const {
+        size_t size = 0;
+        for (const auto& data : allData) {
+            size += data.encodedSize();
         }
-        encoded.insert(encoded.end(), pduEncoded.begin(), pduEncoded.end());
+        return size;
+    }
 
-        return encoded;
+    size_t pduContentSize() const {
+        size_t size = berTLVSize(gocbRef.size());
+        size += berTLVSize(4);                                   // timeAllowedtoLive
+        size += berTLVSize(datSet.size());
+        if (goID) size += berTLVSize(goID->size());
+        size += berTLVSize(8);                                   // t
+        size += berTLVSize(4) * 2;                               // stNum, sqNum
+        size += berTLVSize(1);                                   // simulation
+        size += berTLVSize(4);                                   // confRev
+        size += berTLVSize(1);                                   // ndsCom
+        size += berTLVSize(4);                                   // numDatSetEntries
+        size += berTLVSize(allDataContentSize());
+        return size;
     }
 
-private:
-    std::vector<uint8_t> getPduEncoded() {
-        std::vector<uint8_t> _encoded;
-        indices.clear(); 
+    void mark(bool record, const char* name, const BERWriter& w) const {
+        if (record) {
+            indices[name] = w.size();
+        }
+    }
 
-    this->numDatSetEntries = static_cast<int32_t>(allData.size());
-        
+    void write(BERWriter& w, bool record) {
         // Guard against dataset overflow (32-bit signed integer max)
-        if (this->numDatSetEntries > INT32_MAX) {
+        if (allData.size() > static_cast<size_t>(INT32_MAX)) {
             throw std::runtime_error("numDatSetEntries exceeds maximum allowed value");
         }
+        this->numDatSetEntries = static_cast<int32_t>(allData.size());
 
-        // gocbRef
-        indices["gocbRef"] = _encoded.size();
-        _encoded.push_back(0x80); // Tag [0] VisibleString
-        auto gocbRefLen = encodeBERLength(gocbRef.size());
-        _encoded.insert(_encoded.end(), gocbRefLen.begin(), gocbRefLen.end());
-        _encoded.insert(_encoded.end(), gocbRef.begin(), gocbRef.end());
-
-        // timeAllowedtoLive
-        indices["timeAllowedtoLive"] = _encoded.size();
-        _encoded.push_back(0x81); // Tag [1] INTEGER
-        _encoded.push_back(4);
-        for (int i = 3; i >= 0; --i) {
-            _encoded.push_back((timeAllowedtoLive >> (i * 8)) & 0xFF);
-        }
+        const size_t pduSize = pduContentSize();
+
+        // Header: EtherType, APPID, Length (APPID..end of PDU), Reserved 1/2
+        w.putU16(0x88b8);
+        w.putU16(appID);
+        w.putU16(static_cast<uint16_t>(8 + berTLVSize(pduSize)));
+        w.putU16(reserved1);
+        w.putU16(reserved2);
+
+        // goosePdu
+        w.putHeader(0x61, pduSize);
+
+        w.putHeader(0x80, gocbRef.size());                       // [0] VisibleString
+        mark(record, "gocbRef", w);
+        w.putBytes(gocbRef.data(), gocbRef.size());
+
+        w.putHeader(0x81, 4);                                    // [1] INTEGER
+        mark(record, "timeAllowedtoLive", w);
+        w.putU32(static_cast<uint32_t>(timeAllowedtoLive));
 
-        // datSet
-        indices["datSet"] = _encoded.size();
-        _encoded.push_back(0x82); // Tag [2] VisibleString
-        auto datSetLen = encodeBERLength(datSet.size());
-        _encoded.insert(_encoded.end(), datSetLen.begin(), datSetLen.end());
-        _encoded.insert(_encoded.end(), datSet.begin(), datSet.end());
+        w.putHeader(0x82, datSet.size());                        // [2] VisibleString
+        mark(record, "datSet", w);
+        w.putBytes(datSet.data(), datSet.size());
 
-        // goID
         if (goID) {
-            indices["goID"] = _encoded.size();
-            _encoded.push_back(0x83); // Tag [3] VisibleString OPTIONAL
-            auto goIDLen = encodeBERLength(goID->size());
-            _encoded.insert(_encoded.end(), goIDLen.begin(), goIDLen.end());
-            _encoded.insert(_encoded.end(), goID->begin(), goID->end());
+            w.putHeader(0x83, goID->size());                     // [3] VisibleString OPTIONAL
+            mark(record, "goID", w);
+            w.putBytes(goID->data(), goID->size());
         }
 
-        // t
-        indices["t"] = _encoded.size();
-        _encoded.push_back(0x84); // Tag [4] UtcTime
-        auto tEncoded = t.getEncoded();
-        auto tLen = encodeBERLength(tEncoded.size());
-        _encoded.insert(_encoded.end(), tLen.begin(), tLen.end());
-        _encoded.insert(_encoded.end(), tEncoded.begin(), tEncoded.end());
-
-        // stNum
-        indices["stNum"] = _encoded.size();
-        _encoded.push_back(0x85); // Tag [5] INTEGER (stNum)
-        _encoded.push_back(4);
-        for (int i = 3; i >= 0; --i) {
-            _encoded.push_back((stNum >> (i * 8)) & 0xFF);
-        }
+        w.putHeader(0x84, 8);                                    // [4] UtcTime
+        mark(record, "t", w);
+        t.encodeTo(w);
 
-        // sqNum
-        indices["sqNum"] = _encoded.size();
-        _encoded.push_back(0x86); // Tag [6] INTEGER (sqNum)
-        _encoded.push_back(4);
-        for (int i = 3; i >= 0; --i) {
-            _encoded.push_back((sqNum >> (i * 8)) & 0xFF);
-        }
+        w.putHeader(0x85, 4);                                    // [5] INTEGER (stNum)
+        mark(record, "stNum", w);
+        w.putU32(static_cast<uint32_t>(stNum));
 
-        // Simulation
-        indices["simulation"] = _encoded.size();
-        _encoded.push_back(0x87); // Tag [7] BOOLEAN (simulation)
-        _encoded.push_back(1);
-        _encoded.push_back(simulation ? 0xFF : 0x00);
-
-        // confRev
-        indices["confRev"] = _encoded.size();
-        _encoded.push_back(0x88); // Tag [8] INTEGER (confRev)
-        _encoded.push_back(4);
-        for (int i = 3; i >= 0; --i) {
-            _encoded.push_back((confRev >> (i * 8)) & 0xFF);
-        }
+        w.putHeader(0x86, 4);                                    // [6] INTEGER (sqNum)
+        mark(record, "sqNum", w);
+        w.putU32(static_cast<uint32_t>(sqNum));
 
+        w.putHeader(0x87, 1);                                    // [7] BOOLEAN (simulation)
+        mark(record, "simulation", w);
+        w.putByte(simulation ? 0xFF : 0x00);
 
-        // ndscom
-        indices["ndsCom"] = _encoded.size();
-        _encoded.push_back(0x89); // Tag [9] BOOLEAN (ndsCom)
-        _encoded.push_back(1);
-        _encoded.push_back(ndsCom ? 0xFF : 0x00);
+        w.putHeader(0x88, 4);                                    // [8] INTEGER (confRev)
+        mark(record, "confRev", w);
+        w.putU32(static_cast<uint32_t>(confRev));
 
-        // numDatSetEntries
-        indices["numDatSetEntries"] = _encoded.size();
-        _encoded.push_back(0x8A); // Tag [10] INTEGER (numDatSetEntries)
-        _encoded.push_back(4);
-        for (int i = 3; i >= 0; --i) {
-            _encoded.push_back((numDatSetEntries >> (i * 8)) & 0xFF);
-        }
+        w.putHeader(0x89, 1);                                    // [9] BOOLEAN (ndsCom)
+        mark(record, "ndsCom", w);
+        w.putByte(ndsCom ? 0xFF : 0x00);
+
+        w.putHeader(0x8A, 4);                                    // [10] INTEGER (numDatSetEntries)
+        mark(record, "numDatSetEntries", w);
+        w.putU32(static_cast<uint32_t>(numDatSetEntries));
 
-        // Encode allData
-        indices["allData"] = _encoded.size();
-        _encoded.push_back(0xab); // Tag [11] SEQUENCE OF Data
-        std::vector<uint8_t> allDataEncoded;
+        w.putHeader(0xAB, allDataContentSize());                 // [11] SEQUENCE OF Data
+        mark(record, "allData", w);
         for (const auto& data : allData) {
-            auto dataEncoded = data.getEncoded();
-            allDataEncoded.insert(allDataEncoded.end(), dataEncoded.begin(), dataEncoded.end());
+            data.encodeTo(w);
         }
-        // Use BER encoding for length (handles >255 case)
-        auto lengthBytes = encodeBERLength(allDataEncoded.size());
-        _encoded.insert(_encoded.end(), lengthBytes.begin(), lengthBytes.end());
-        _encoded.insert(_encoded.end(), allDataEncoded.begin(), allDataEncoded.end());
-
-        return _encoded;
     }
 };
 
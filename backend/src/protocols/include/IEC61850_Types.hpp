@@ -6,6 +6,7 @@
 #include <optional>
 #include <inttypes.h>
 #include <cstring>
+#include "BER_Codec.hpp"
 
 
 
@@ -15,9 +16,7 @@ public:
     uint32_t fraction;
     uint8_t defined;
 public:
-    UtcTime(){
-        defined = 0;
-    }
+    UtcTime() : seconds(0), fraction(0), defined(0) {}
 
     UtcTime(uint32_t seconds, uint32_t fraction) : seconds(seconds) {
         this->fraction = static_cast<uint32_t>((static_cast<uint64_t>(fraction) * (1LL << 32)) / 1000000000LL);
@@ -34,6 +33,11 @@ public:
         }
         return encoded;
     }
+    // 8 bytes: seconds, fraction (both big-endian)
+    void encodeTo(BERWriter& w) const {
+        w.putU32(seconds);
+        w.putU32(fraction);
+    }
     static std::vector<uint8_t> staticGetEncoded(uint32_t seconds, uint32_t fraction) {
         fraction = static_cast<uint32_t>((static_cast<uint64_t>(fraction) * (1LL << 32)) / 1000000000LL);
         std::vector<uint8_t> encoded(8);
@@ -53,6 +57,8 @@ class FloatingPoint {
     std::string value;
 public:
     FloatingPoint(const std::string& val) : value(val) {}
+    size_t size() const { return value.size(); }
+    const char* data() const { return value.data(); }
     std::vector<uint8_t> getEncoded() const {
         std::vector<uint8_t> encoded;
         encoded.insert(encoded.end(), value.begin(), value.end());
@@ -64,6 +70,8 @@ class TimeOfDay {
     std::string value;
 public:
     TimeOfDay(const std::string& val) : value(val) {}
+    size_t size() const { return value.size(); }
+    const char* data() const { return value.data(); }
     std::vector<uint8_t> getEncoded() const {
         std::vector<uint8_t> encoded;
         encoded.insert(encoded.end(), value.begin(), value.end());
@@ -164,138 +172,148 @@ public:
         }
     }
 
-    std::vector<uint8_t> getEncoded() const {
-        std::vector<uint8_t> encoded;
+    // Size of the complete TLV (0 when the value for `type` is not set)
+    size_t encodedSize() const {
+        size_t content = 0;
+        if (!contentSize(content)) return 0;
+        return berTLVSize(content);
+    }
+
+    // Writes tag, exact length and value. Array and Structure carry the
+    // length of their encoded members.
+    void encodeTo(BERWriter& w) const {
+        size_t content = 0;
+        if (!contentSize(content)) return;
 
         switch (type) {
             case Type::Array:
-                // Encode array
-                if (!array.has_value()) break;
-                encoded.push_back(0xA1);
-                for (const auto& item : array.value()) {
-                    std::vector<uint8_t> itemEncoded = item.getEncoded();
-                    encoded.insert(encoded.end(), itemEncoded.begin(), itemEncoded.end());
-                }
+                w.putHeader(0xA1, content);
+                for (const auto& item : array.value()) item.encodeTo(w);
                 break;
             case Type::Structure:
-                // Encode structure
-                if (!structure.has_value()) break;
-                encoded.push_back(0xA2);
-                for (const auto& item : structure.value()) {
-                    std::vector<uint8_t> itemEncoded = item.getEncoded();
-                    encoded.insert(encoded.end(), itemEncoded.begin(), itemEncoded.end());
-                }
+                w.putHeader(0xA2, content);
+                for (const auto& item : structure.value()) item.encodeTo(w);
                 break;
             case Type::Boolean:
-                if (!boolean.has_value()) break;
-                encoded.push_back(0x83);
-                encoded.push_back(1);
-                encoded.push_back(boolean.value() ? 0xFF : 0x00);
+                w.putBoolTLV(0x83, boolean.value());
                 break;
             case Type::BitString:
-                if (!this->bitString.has_value()) break;
-                encoded.push_back(0x84);
-                encoded.push_back(static_cast<uint8_t>(this->bitString.value().size()));
-                encoded.insert(encoded.end(), this->bitString.value().begin(), this->bitString.value().end());
+                w.putTLV(0x84, bitString.value().data(), content);
                 break;
             case Type::Integer:
-                if (!this->integer.has_value()) break;
-                encoded.push_back(0x85);
-                encoded.push_back(4);
-                encoded.push_back((this->integer.value() >> 24) & 0xFF);
-                encoded.push_back((this->integer.value() >> 16) & 0xFF);
-                encoded.push_back((this->integer.value() >> 8) & 0xFF);
-                encoded.push_back(this->integer.value() & 0xFF);
+                w.putU32TLV(0x85, static_cast<uint32_t>(integer.value()));
                 break;
             case Type::Unsigned:
-                if (!this->unsignedInt.has_value()) break;
-                encoded.push_back(0x86);
-                encoded.push_back(4);
-                encoded.push_back((this->unsignedInt.value() >> 24) & 0xFF);
-                encoded.push_back((this->unsignedInt.value() >> 16) & 0xFF);
-                encoded.push_back((this->unsignedInt.value() >> 8) & 0xFF);
-                encoded.push_back(this->unsignedInt.value() & 0xFF);
+                w.putU32TLV(0x86, unsignedInt.value());
                 break;
             case Type::FloatingPoint:
-                if (!this->floatingPoint.has_value()) break;
-                encoded.push_back(0x87);
-                {
-                    std::vector<uint8_t> fpEncoded = this->floatingPoint.value().getEncoded();
-                    encoded.push_back(static_cast<uint8_t>(fpEncoded.size()));
-                    encoded.insert(encoded.end(), fpEncoded.begin(), fpEncoded.end());
-                }
+                w.putTLV(0x87, floatingPoint.value().data(), content);
                 break;
             case Type::Real:
                 // IEC 61850-7-2: Real is encoded as 64-bit IEEE 754 double (8 bytes)
-                if (!this->real.has_value()) break;
-                encoded.push_back(0x88);
-                encoded.push_back(8);  // Length: 8 bytes for double
-                {
-                    std::vector<uint8_t> realEncoded(8);  // Changed from 4 to 8
-                    memcpy(realEncoded.data(), &this->real.value(), 8);  // Copy full 8 bytes
-                    encoded.insert(encoded.end(), realEncoded.begin(), realEncoded.end());
-                }
+                w.putTLV(0x88, &real.value(), 8);
                 break;
             case Type::OctetString:
-                if (!this->octetString.has_value()) break;
-                encoded.push_back(0x89);
-                encoded.push_back(static_cast<uint8_t>(this->octetString.value().size()));
-                encoded.insert(encoded.end(), this->octetString.value().begin(), this->octetString.value().end());
+                w.putTLV(0x89, octetString.value().data(), content);
                 break;
             case Type::VisibleString:
-                if (!this->visibleString.has_value()) break;
-                encoded.push_back(0x8A);
-                encoded.push_back(static_cast<uint8_t>(this->visibleString.value().size()));
-                encoded.insert(encoded.end(), this->visibleString.value().begin(), this->visibleString.value().end());
+                w.putTLV(0x8A, visibleString.value().data(), content);
                 break;
             case Type::BinaryTime:
-                if (!this->binaryTime.has_value()) break;
-                encoded.push_back(0x8B);
-                {
-                    std::vector<uint8_t> btEncoded = this->binaryTime.value().getEncoded();
-                    encoded.push_back(static_cast<uint8_t>(btEncoded.size()));
-                    encoded.insert(encoded.end(), btEncoded.begin(), btEncoded.end());
-                }
+                w.putTLV(0x8B, binaryTime.value().data(), content);
                 break;
             case Type::Bcd:
-                if (!this->bcd.has_value()) break;
-                encoded.push_back(0x8C);
-                encoded.push_back(4);
-                encoded.push_back((this->bcd.value() >> 24) & 0xFF);
-                encoded.push_back((this->bcd.value() >> 16) & 0xFF);
-                encoded.push_back((this->bcd.value() >> 8) & 0xFF);
-                encoded.push_back(this->bcd.value() & 0xFF);
+                w.putU32TLV(0x8C, static_cast<uint32_t>(bcd.value()));
                 break;
             case Type::BooleanArray:
-                if (!this->booleanArray.has_value()) break;
-                encoded.push_back(0x8D);
-                encoded.push_back(static_cast<uint8_t>(this->booleanArray.value().size()));
-                encoded.insert(encoded.end(), this->booleanArray.value().begin(), this->booleanArray.value().end());
+                w.putTLV(0x8D, booleanArray.value().data(), content);
                 break;
             case Type::ObjId:
-                if (!this->objId.has_value()) break;
-                encoded.push_back(0x8E);
-                encoded.push_back(static_cast<uint8_t>(this->objId.value().size()));
-                encoded.insert(encoded.end(), this->objId.value().begin(), this->objId.value().end());
+                w.putTLV(0x8E, objId.value().data(), content);
                 break;
             case Type::MmsString:
-                if (!this->mmsString.has_value()) break;
-                encoded.push_back(0x8F);
-                encoded.push_back(static_cast<uint8_t>(this->mmsString.value().size()));
-                encoded.insert(encoded.end(), this->mmsString.value().begin(), this->mmsString.value().end());
+                w.putTLV(0x8F, mmsString.value().data(), content);
                 break;
             case Type::UtcTime:
-                if (!this->utcTime.has_value()) break;
-                encoded.push_back(0x90);
-                {
-                    std::vector<uint8_t> utcEncoded = this->utcTime.value().getEncoded();
-                    encoded.push_back(static_cast<uint8_t>(utcEncoded.size()));
-                    encoded.insert(encoded.end(), utcEncoded.begin(), utcEncoded.end());
-                }
+                w.putHeader(0x90, 8);
+                utcTime.value().encodeTo(w);
                 break;
         }
+    }
+
+    std::vector<uint8_t> getEncoded() const {
+        std::vector<uint8_t> encoded(encodedSize());
+        BERWriter w(encoded.data(), encoded.size());
+        encodeTo(w);
         return encoded;
     }
+
+private:
+    bool contentSize(size_t& size) const {
+        switch (type) {
+            case Type::Array:
+                if (!array.has_value()) return false;
+                size = 0;
+                for (const auto& item : array.value()) size += item.encodedSize();
+                return true;
+            case Type::Structure:
+                if (!structure.has_value()) return false;
+                size = 0;
+                for (const auto& item : structure.value()) size += item.encodedSize();
+                return true;
+            case Type::Boolean:
+                size = 1;
+                return boolean.has_value();
+            case Type::BitString:
+                if (!bitString.has_value()) return false;
+                size = bitString.value().size();
+                return true;
+            case Type::Integer:
+                size = 4;
+                return integer.has_value();
+            case Type::Unsigned:
+                size = 4;
+                return unsignedInt.has_value();
+            case Type::FloatingPoint:
+                if (!floatingPoint.has_value()) return false;
+                size = floatingPoint.value().size();
+                return true;
+            case Type::Real:
+                size = 8;
+                return real.has_value();
+            case Type::OctetString:
+                if (!octetString.has_value()) return false;
+                size = octetString.value().size();
+                return true;
+            case Type::VisibleString:
+                if (!visibleString.has_value()) return false;
+                size = visibleString.value().size();
+                return true;
+            case Type::BinaryTime:
+                if (!binaryTime.has_value()) return false;
+                size = binaryTime.value().size();
+                return true;
+            case Type::Bcd:
+                size = 4;
+                return bcd.has_value();
+            case Type::BooleanArray:
+                if (!booleanArray.has_value()) return false;
+                size = booleanArray.value().size();
+                return true;
+            case Type::ObjId:
+                if (!objId.has_value()) return false;
+                size = objId.value().size();
+                return true;
+            case Type::MmsString:
+                if (!mmsString.has_value()) return false;
+                size = mmsString.value().size();
+                return true;
+            case Type::UtcTime:
+                size = 8;
+                return utcTime.has_value();
+        }
+        return false;
+    }
 };
 
 #endif // IEC61850_TYPES_HPP
\ No newline at end of file
@@ -10,5 +10,6 @@
 #include "Virtual_LAN.hpp"
 #include "IEC61850_Types.hpp"
 #include "BER_Encoding.hpp"
+#include "BER_Codec.hpp"
 
 #endif // PROTOCOLS_HPP
@@ -0,0 +1,92 @@
+#ifndef SV_FRAMELAYOUT_HPP
+#define SV_FRAMELAYOUT_HPP
+
+// ============================================================================
+// Compile-time SV frame layouts for the IEC 61850-9-2LE profiles
+// ============================================================================
+// A 9-2LE ASDU carries no optional fields, so everything after svID has a
+// fixed shape:
+//
+//   82 02 [smpCnt] 83 04 [confRev] 85 01 [smpSynch] 87 LL [seqData...]
+//
+// Given the offset of the first smpCnt value and the ASDU stride (both depend
+// only on svID length and are measured once at config time), every field the
+// publisher patches per frame is at a constant distance. With the ASDU and
+// channel counts as template parameters the patch loops unroll completely.
+//
+// matches() checks the positions recorded by SampledValue::getEncoded()
+// against the constexpr layout, so a frame with optional fields (refrTm,
+// smpRate, datSet, ...) is never patched through the fixed path.
+// ============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include "BER_Codec.hpp"
+
+template <uint8_t NoAsdu, uint8_t NoChannels>
+struct SvFixedLayout {
+    static_assert(NoAsdu > 0 && NoChannels > 0, "empty SV layout");
+
+    static constexpr uint8_t noAsdu = NoAsdu;
+    static constexpr uint8_t noChannels = NoChannels;
+
+    // INT32 value + Quality per channel
+    static constexpr size_t seqDataSize = static_cast<size_t>(NoChannels) * 8;
+
+    // smpCnt value -> seqData value: smpCnt(2), confRev TLV, smpSynch TLV, seqData tag+length
+    static constexpr size_t smpCntToSeqData = 2 + berTLVSize(4) + berTLVSize(1) + 1 + berLengthSize(seqDataSize);
+
+    static constexpr size_t channelOffset(size_t channel) {
+        return smpCntToSeqData + channel * 8;
+    }
+
+    // True when the recorded value offsets follow this layout. `stride` is the
+    // distance between consecutive ASDUs (0 for a single ASDU).
+    static bool matches(const uint32_t* smpCnt_pos, const uint32_t* data_pos, size_t count,
+                        size_t frameSize, uint32_t& stride) {
+        if (count != NoAsdu) return false;
+        stride = NoAsdu > 1 ? smpCnt_pos[1] - smpCnt_pos[0] : 0;
+        for (size_t num = 0; num < NoAsdu; ++num) {
+            if (smpCnt_pos[num] != smpCnt_pos[0] + num * stride) return false;
+            if (data_pos[num] != smpCnt_pos[num] + smpCntToSeqData) return false;
+        }
+        return data_pos[NoAsdu - 1] + seqDataSize <= frameSize;
+    }
+
+    // Patch one ASDU starting at its smpCnt value. `channels[cn]` is the
+    // sample row of channel cn, or nullptr to keep the template value.
+    static void writeAsdu(uint8_t* asdu, uint16_t smpCnt, const int32_t* const* channels, size_t idx) {
+        asdu[0] = static_cast<uint8_t>(smpCnt >> 8);
+        asdu[1] = static_cast<uint8_t>(smpCnt & 0xFF);
+        for (size_t cn = 0; cn < NoChannels; ++cn) {
+            if (channels[cn] == nullptr) continue;
+            const uint32_t value = static_cast<uint32_t>(channels[cn][idx]);
+            uint8_t* slot = asdu + channelOffset(cn);
+            slot[0] = static_cast<uint8_t>(value >> 24);
+            slot[1] = static_cast<uint8_t>((value >> 16) & 0xFF);
+            slot[2] = static_cast<uint8_t>((value >> 8) & 0xFF);
+            slot[3] = static_cast<uint8_t>(value & 0xFF);
+        }
+    }
+};
+
+// 9-2LE: 80 samples/cycle with one ASDU per frame, 256 samples/cycle with eight
+using SvLayout_92LE_80 = SvFixedLayout<1, 8>;
+using SvLayout_92LE_256 = SvFixedLayout<8, 8>;
+
+// 9-2LE value scaling and channel order (Ia, Ib, Ic, In, Va, Vb, Vc, Vn)
+constexpr double SV92LE_CountsPerAmp = 1000.0;     // 1 mA per LSB
+constexpr double SV92LE_CountsPerVolt = 100.0;     // 10 mV per LSB
+constexpr size_t SV92LE_CurrentChannels = 4;
+
+// INT32 seqData value of an instantaneous channel value; currents are the
+// first four channels of each group of eight. Saturates instead of wrapping.
+inline int32_t sv92le_encode(double value, size_t channel) {
+    const double scaled = value * (channel % 8 < SV92LE_CurrentChannels ? SV92LE_CountsPerAmp : SV92LE_CountsPerVolt);
+    if (!(scaled > -2147483648.0)) return INT32_MIN;
+    if (scaled >= 2147483647.0) return INT32_MAX;
+    return static_cast<int32_t>(scaled);
+}
+
+#endif // SV_FRAMELAYOUT_HPP
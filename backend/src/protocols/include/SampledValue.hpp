@@ -7,6 +7,7 @@
 #include <inttypes.h>
 #include <cstring>
 #include "IEC61850_Types.hpp"
+#include "BER_Codec.hpp"
 
 
 class SampledValue {
@@ -32,12 +33,12 @@ public:
     uint16_t smpMod;     //0x88 - OPTIONAL
 
     mutable std::vector<uint8_t> encoded;
+    // Per ASDU: field name -> offset of the field value from the start of the
+    // encoded buffer (EtherType). Filled by getEncoded().
     mutable std::vector<std::unordered_map<std::string, size_t>> indices;
-    int offSet;
-    int asduSize;
 
     SampledValue(uint16_t appID, uint8_t noAsdu, const std::string &svID, uint16_t smpCnt, uint32_t confRev, uint8_t smpSynch, uint16_t smpMod)
-        : appID(appID), noAsdu(noAsdu), svID(svID), smpCnt(smpCnt), confRev(confRev), smpSynch(smpSynch), smpMod(smpMod), offSet(0), asduSize(0) {
+        : appID(appID), noAsdu(noAsdu), security(0), svID(svID), smpCnt(smpCnt), confRev(confRev), smpSynch(smpSynch), smpRate(0), smpMod(smpMod) {
         
         this->indices.resize(noAsdu);
     }
@@ -49,226 +50,134 @@ public:
         }
         auto it = indices[static_cast<size_t>(asduIndex)].find(param);
         if (it != indices[static_cast<size_t>(asduIndex)].end()) {
-            size_t offset = it->second + static_cast<size_t>(this->offSet) + 
-                           static_cast<size_t>(asduIndex) * static_cast<size_t>(this->asduSize);
-            return static_cast<int>(offset);
+            return static_cast<int>(it->second);
         }
         return -1;
     }
 
-    std::vector<uint8_t> getEncoded(uint8_t noChannel) {
-        encoded.clear();  // Clear previous encoding
-        encoded.reserve(2048);
-        this->offSet = 0;
-
-        std::vector<uint8_t> savPduEncoded = this->getSavPduEncoded(noChannel);
-
-        uint16_t savPduSize = static_cast<uint16_t>(savPduEncoded.size());
-        uint16_t length = 8 + 2 + savPduSize;
-        this->offSet = 9;
-
-        if (savPduSize > 0xff) {
-            length += 2;
-            offSet += 2;
-        } else if (savPduSize > 0x80) {
-            length += 1;
-            offSet += 1;
-        }
+    // Exact size of the frame from the EtherType onwards
+    size_t encodedSize(uint8_t noChannel) const {
+        return 10 + berTLVSize(savPduContentSize(noChannel));
+    }
 
-        // EtherType
-        encoded.push_back(0x88);
-        encoded.push_back(0xba);
-
-        // APPID
-        encoded.push_back((appID >> 8) & 0xFF);
-        encoded.push_back(appID & 0xFF);
-
-        // Length 
-        encoded.push_back((length >> 8) & 0xFF);
-        encoded.push_back(length & 0xFF);
-
-        // Reserved 1
-        encoded.push_back((reserved1 >> 8) & 0xFF);
-        encoded.push_back(reserved1 & 0xFF);
-
-        // Reserved 2
-        encoded.push_back((reserved2 >> 8) & 0xFF);
-        encoded.push_back(reserved2 & 0xFF);
-
-        // PDU
-        encoded.push_back(0x60);
-        if (savPduSize > 0xff) {
-            encoded.push_back(0x82);
-            encoded.push_back((savPduSize >> 8) & 0xFF);
-            encoded.push_back(savPduSize & 0xFF);
-        } else if (savPduSize > 0x80) {
-            encoded.push_back(0x81);
-            encoded.push_back(savPduSize & 0xFF);
-        } else {
-            encoded.push_back(savPduSize & 0xFF);
-        }
-        offSet += encoded.size();
-        encoded.insert(encoded.end(), savPduEncoded.begin(), savPduEncoded.end());
+    // Encode into caller memory without allocating. Returns the number of
+    // bytes written, or 0 if `capacity` is too small.
+    size_t encodeTo(uint8_t* buffer, size_t capacity, uint8_t noChannel) const {
+        BERWriter w(buffer, capacity);
+        write(w, noChannel, false);
+        return w.ok() ? w.size() : 0;
+    }
 
+    std::vector<uint8_t> getEncoded(uint8_t noChannel) {
+        encoded.assign(encodedSize(noChannel), 0);
+        indices.assign(noAsdu, {});
+
+        BERWriter w(encoded.data(), encoded.size());
+        write(w, noChannel, true);
         return encoded;
     }
 
 private:
 
-    std::vector<uint8_t> getAsduEncoded(uint8_t noChannel, int asdu) {
-        std::vector<uint8_t> _encoded;
-
-        // svID
-        indices[static_cast<size_t>(asdu)]["svID"] = _encoded.size();
-        _encoded.push_back(0x80); // Tag [0] VisibleString
-        _encoded.push_back(static_cast<uint8_t>(svID.size()));
-        _encoded.insert(_encoded.end(), svID.begin(), svID.end());
-
-        // datSet
-        if (!datSet.empty()) {
-            indices[static_cast<size_t>(asdu)]["datSet"] = _encoded.size();
-            _encoded.push_back(0x81); // Tag [1] VisibleString
-            _encoded.push_back(static_cast<uint8_t>(datSet.size()));
-            _encoded.insert(_encoded.end(), datSet.begin(), datSet.end());
-        }
-
-        // smpCnt
-        indices[static_cast<size_t>(asdu)]["smpCnt"] = _encoded.size();
-        _encoded.push_back(0x82); // Tag [2] INTEGER
-        _encoded.push_back(2);
-        _encoded.push_back((smpCnt >> 8) & 0xFF);
-        _encoded.push_back(smpCnt & 0xFF);
-
-        // confRev
-        indices[static_cast<size_t>(asdu)]["confRev"] = _encoded.size();
-        _encoded.push_back(0x83); // Tag [3] INTEGER
-        _encoded.push_back(4);
-        _encoded.push_back((confRev >> 24) & 0xFF);
-        _encoded.push_back((confRev >> 16) & 0xFF);
-        _encoded.push_back((confRev >> 8) & 0xFF);
-        _encoded.push_back(confRev & 0xFF);
-
-        // refrTm
-        if (refrTm.defined) {
-            indices[static_cast<size_t>(asdu)]["refrTm"] = _encoded.size();
-            _encoded.push_back(0x84); // Tag [4] UtcTime
-            auto refrTmEncoded = refrTm.getEncoded();
-            _encoded.push_back(static_cast<uint8_t>(refrTmEncoded.size()));
-            _encoded.insert(_encoded.end(), refrTmEncoded.begin(), refrTmEncoded.end());
-        }
-
-        // smpSynch
-        indices[static_cast<size_t>(asdu)]["smpSynch"] = _encoded.size();
-        _encoded.push_back(0x85); // Tag [5] BOOLEAN
-        _encoded.push_back(1);
-        _encoded.push_back(smpSynch);
-
-        // smpRate
-        if (smpRate) {
-            indices[static_cast<size_t>(asdu)]["smpRate"] = _encoded.size();
-            _encoded.push_back(0x86); // Tag [6] INTEGER
-            _encoded.push_back(2);
-            _encoded.push_back((smpRate >> 8) & 0xFF);
-            _encoded.push_back(smpRate & 0xFF);
-        }
-
-        // seqData
-        indices[static_cast<size_t>(asdu)]["seqData"] = _encoded.size();
-        _encoded.push_back(0x87); // Tag [7] SEQUENCE OF Data
-        _encoded.push_back(noChannel*8);
-        for (int channel =0;channel<noChannel;channel++){
-            // For each channel, add 8 bytes of data
-            for (int i = 3; i >= 0; --i) {
-                _encoded.push_back(0);
-                _encoded.push_back(0);
-            }
-        }
-
-        // smpMod
-        if (smpMod) {
-            indices[static_cast<size_t>(asdu)]["smpMod"] = _encoded.size();
-            _encoded.push_back(0x88); // Tag [8] INTEGER
-            _encoded.push_back(2);
-            _encoded.push_back((smpMod >> 8) & 0xFF);
-            _encoded.push_back(smpMod & 0xFF);
-        }
+    size_t asduContentSize(uint8_t noChannel) const {
+        size_t size = berTLVSize(svID.size());
+        if (!datSet.empty()) size += berTLVSize(datSet.size());
+        size += berTLVSize(2);                       // smpCnt
+        size += berTLVSize(4);                       // confRev
+        if (refrTm.defined) size += berTLVSize(8);   // refrTm
+        size += berTLVSize(1);                       // smpSynch
+        if (smpRate) size += berTLVSize(2);          // smpRate
+        size += berTLVSize(static_cast<size_t>(noChannel) * 8);  // seqData
+        if (smpMod) size += berTLVSize(2);           // smpMod
+        return size;
+    }
 
-        return _encoded;
+    size_t seqAsduContentSize(uint8_t noChannel) const {
+        return static_cast<size_t>(noAsdu) * berTLVSize(asduContentSize(noChannel));
     }
 
-    std::vector<uint8_t> getSeqAsduEncoded(uint8_t noChannel){
-        std::vector<uint8_t> _encoded;
-
-        for (int asdu = 0; asdu < this->noAsdu; asdu++){
-            std::vector<uint8_t> asduEncoded = this->getAsduEncoded(noChannel, asdu);
-            uint32_t asduSizeLocal = static_cast<uint32_t>(asduEncoded.size());
-
-            _encoded.push_back(0x30); // Tag [0] SEQUENCE OF ASDU
-            if (asduSizeLocal > 0xff) {
-                _encoded.push_back(0x82);
-                _encoded.push_back((asduSizeLocal >> 8) & 0xFF);
-                _encoded.push_back(asduSizeLocal & 0xFF);
-            } else if (asduSizeLocal > 0x80) {
-                _encoded.push_back(0x81);
-                _encoded.push_back(asduSizeLocal & 0xFF);
-            } else {
-                _encoded.push_back(asduSizeLocal & 0xFF);
-            }
-            _encoded.insert(_encoded.end(), asduEncoded.begin(), asduEncoded.end());
+    size_t savPduContentSize(uint8_t noChannel) const {
+        size_t size = berTLVSize(1);                 // noAsdu
+        if (security) size += berTLVSize(1);
+        size += berTLVSize(seqAsduContentSize(noChannel));
+        return size;
+    }
 
-            if (asdu == 0){
-                this->asduSize = static_cast<int>(_encoded.size());
-            }
+    void mark(bool record, int asdu, const char* name, const BERWriter& w) const {
+        if (record) {
+            indices[static_cast<size_t>(asdu)][name] = w.size();
         }
-
-        return _encoded;
     }
 
-    std::vector<uint8_t> getSavPduEncoded(uint8_t noChannel) {
-        std::vector<uint8_t> _encoded;
-        indices.clear();
-
-        // SEQ ASDU
-        std::vector<uint8_t> seqAsduEncoded = this->getSeqAsduEncoded(noChannel);
-    uint32_t seqAsduSize = static_cast<uint32_t>(seqAsduEncoded.size());
+    void write(BERWriter& w, uint8_t noChannel, bool record) const {
+        const size_t savPduSize = savPduContentSize(noChannel);
+        const size_t asduSize = asduContentSize(noChannel);
 
-        // noAsdu
-        _encoded.push_back(0x80); // Tag [0] INTEGER
-        _encoded.push_back(1);
-        _encoded.push_back(noAsdu);
+        // Header: EtherType, APPID, Length (APPID..end of PDU), Reserved 1/2
+        w.putU16(0x88ba);
+        w.putU16(appID);
+        w.putU16(static_cast<uint16_t>(8 + berTLVSize(savPduSize)));
+        w.putU16(reserved1);
+        w.putU16(reserved2);
 
-        // security
+        // SAVPDU
+        w.putHeader(0x60, savPduSize);
+        w.putU8TLV(0x80, noAsdu);                    // noAsdu
         if (security) {
-            _encoded.push_back(0x81); // Tag [1] BOOLEAN
-            _encoded.push_back(1);
-            _encoded.push_back(security ? 0xFF : 0x00);
+            w.putBoolTLV(0x81, true);                // security
         }
+        w.putHeader(0xA2, seqAsduContentSize(noChannel));  // SEQUENCE OF ASDU
 
-        this->offSet += _encoded.size();
-
-        //seqAsdu
-        _encoded.push_back(0xA2); // Tag [2] SEQUENCE OF ASDU
-        if (seqAsduSize > 0xff) {
-            _encoded.push_back(0x82);
-            _encoded.push_back((seqAsduSize >> 8) & 0xFF);
-            _encoded.push_back(seqAsduSize & 0xFF);
-        } else if (seqAsduSize > 0x80) {
-            _encoded.push_back(0x81);
-            _encoded.push_back(seqAsduSize & 0xFF);
-        } else {
-            _encoded.push_back(seqAsduSize & 0xFF);
-        }
-        _encoded.insert(_encoded.end(), seqAsduEncoded.begin(), seqAsduEncoded.end());
+        for (int asdu = 0; asdu < this->noAsdu; asdu++) {
+            w.putHeader(0x30, asduSize);
 
-        return _encoded;
-    }
-};
+            w.putHeader(0x80, svID.size());          // [0] VisibleString
+            mark(record, asdu, "svID", w);
+            w.putBytes(svID.data(), svID.size());
 
+            if (!datSet.empty()) {
+                w.putHeader(0x81, datSet.size());    // [1] VisibleString
+                mark(record, asdu, "datSet", w);
+                w.putBytes(datSet.data(), datSet.size());
+            }
 
+            w.putHeader(0x82, 2);                    // [2] INTEGER
+            mark(record, asdu, "smpCnt", w);
+            w.putU16(smpCnt);
 
+            w.putHeader(0x83, 4);                    // [3] INTEGER
+            mark(record, asdu, "confRev", w);
+            w.putU32(confRev);
 
+            if (refrTm.defined) {
+                w.putHeader(0x84, 8);                // [4] UtcTime
+                mark(record, asdu, "refrTm", w);
+                w.putU32(refrTm.seconds);
+                w.putU32(refrTm.fraction);
+            }
+
+            w.putHeader(0x85, 1);                    // [5] BOOLEAN
+            mark(record, asdu, "smpSynch", w);
+            w.putByte(smpSynch);
+
+            if (smpRate) {
+                w.putHeader(0x86, 2);                // [6] INTEGER
+                mark(record, asdu, "smpRate", w);
+                w.putU16(smpRate);
+            }
 
+            w.putHeader(0x87, static_cast<size_t>(noChannel) * 8);  // [7] SEQUENCE OF Data
+            mark(record, asdu, "seqData", w);
+            w.putZeros(static_cast<size_t>(noChannel) * 8);
 
+            if (smpMod) {
+                w.putHeader(0x88, 2);                // [8] INTEGER
+                mark(record, asdu, "smpMod", w);
+                w.putU16(smpMod);
+            }
+        }
+    }
+};
 
 #endif // SAMPLEDVALUE_HPP
 
@@ -10,6 +10,8 @@
 #include <functional>
 #include <chrono>
 
+class Clock;
+
 namespace vts {
 namespace sequence {
 
@@ -184,6 +186,17 @@ public:
      * @return Last error message, empty if no error
      */
     std::string getLastError() const;
+    
+    /**
+     * @brief Set the time source for state durations and polling
+     * 
+     * Takes effect on the next start(); the sequence thread attaches to it
+     * for the whole run, so a VirtualClock runs the sequence in lockstep with
+     * the publisher tick loop.
+     * 
+     * @param clock Time source, nullptr for wall-clock time
+     */
+    void setClock(std::shared_ptr<Clock> clock);
 
 private:
     void sequenceThread();
@@ -202,6 +215,7 @@ private:
     std::atomic<bool> pauseRequested_;
     
     // Timing
+    std::shared_ptr<Clock> clock_;
     std::chrono::steady_clock::time_point sequenceStartTime_;
     std::chrono::steady_clock::time_point stateStartTime_;
     
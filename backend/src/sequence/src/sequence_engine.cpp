@@ -1,7 +1,9 @@
 #include "sequence_engine.hpp"
+#include "clock.hpp"
 #include "global_flags.hpp"
 #include "logger.hpp"
 
+#include <algorithm>
 #include <sstream>
 
 namespace vts {
@@ -12,6 +14,7 @@ SequenceEngine::SequenceEngine()
     , currentStateIndex_(-1)
     , stopRequested_(false)
     , pauseRequested_(false)
+    , clock_(systemClock())
 {
 }
 
@@ -114,7 +117,7 @@ double SequenceEngine::getStateElapsedTime() const {
         return 0.0;
     }
     
-    auto now = std::chrono::steady_clock::now();
+    auto now = clock_->now();
     auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
         now - stateStartTime_
     );
@@ -128,7 +131,7 @@ double SequenceEngine::getTotalElapsedTime() const {
         return 0.0;
     }
     
-    auto now = std::chrono::steady_clock::now();
+    auto now = clock_->now();
     auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
         now - sequenceStartTime_
     );
@@ -148,8 +151,13 @@ std::string SequenceEngine::getLastError() const {
     return lastError_;
 }
 
+void SequenceEngine::setClock(std::shared_ptr<Clock> clock) {
+    clock_ = clock ? std::move(clock) : systemClock();
+}
+
 void SequenceEngine::sequenceThread() {
-    sequenceStartTime_ = std::chrono::steady_clock::now();
+    ClockParticipant participant(*clock_);
+    sequenceStartTime_ = clock_->now();
     
     try {
         // Execute each state in sequence
@@ -163,7 +171,7 @@ void SequenceEngine::sequenceThread() {
             
             // Wait for resume if paused
             while (pauseRequested_.load()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                clock_->sleepFor(std::chrono::milliseconds(100));
                 if (stopRequested_.load()) {
                     reportProgress("Sequence stopped while paused");
                     status_.store(SequenceStatus::STOPPED);
@@ -175,7 +183,7 @@ void SequenceEngine::sequenceThread() {
             
             // Update current state index
             currentStateIndex_.store(static_cast<int>(i));
-            stateStartTime_ = std::chrono::steady_clock::now();
+            stateStartTime_ = clock_->now();
             
             // Report state transition
             std::ostringstream oss;
@@ -238,8 +246,8 @@ void SequenceEngine::applyState(const SequenceState& state) {
 }
 
 bool SequenceEngine::waitForTransition(const SequenceState& state) {
-    const double pollIntervalMs = 50.0;  // 50ms poll interval
-    auto stateStart = std::chrono::steady_clock::now();
+    const auto pollInterval = std::chrono::milliseconds(50);
+    auto stateStart = clock_->now();
     auto stateDuration = std::chrono::microseconds(
         static_cast<int64_t>(state.durationSec * 1000000.0)
     );
@@ -254,14 +262,14 @@ bool SequenceEngine::waitForTransition(const SequenceState& state) {
             
             // Wait for resume if paused
             while (pauseRequested_.load()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                clock_->sleepFor(std::chrono::milliseconds(100));
                 if (stopRequested_.load()) {
                     return false;
                 }
             }
             
             // Check if duration expired
-            auto now = std::chrono::steady_clock::now();
+            auto now = clock_->now();
             auto elapsed = now - stateStart;
             
             if (elapsed >= stateDuration) {
@@ -269,10 +277,8 @@ bool SequenceEngine::waitForTransition(const SequenceState& state) {
                 return true;
             }
             
-            // Sleep for poll interval
-            std::this_thread::sleep_for(std::chrono::milliseconds(
-                static_cast<int>(pollIntervalMs)
-            ));
+            // Sleep for poll interval, or until the state expires
+            clock_->sleepUntil(std::min(now + pollInterval, stateStart + stateDuration));
         }
         
     } else if (state.transition.type == TransitionType::GOOSE_TRIP) {
@@ -287,7 +293,7 @@ bool SequenceEngine::waitForTransition(const SequenceState& state) {
             
             // Wait for resume if paused
             while (pauseRequested_.load()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                clock_->sleepFor(std::chrono::milliseconds(100));
                 if (stopRequested_.load()) {
                     return false;
                 }
@@ -301,7 +307,7 @@ bool SequenceEngine::waitForTransition(const SequenceState& state) {
             }
             
             // Check if duration expired (timeout)
-            auto now = std::chrono::steady_clock::now();
+            auto now = clock_->now();
             auto elapsed = now - stateStart;
             
             if (elapsed >= stateDuration) {
@@ -310,10 +316,8 @@ bool SequenceEngine::waitForTransition(const SequenceState& state) {
                 return true;
             }
             
-            // Sleep for poll interval
-            std::this_thread::sleep_for(std::chrono::milliseconds(
-                static_cast<int>(pollIntervalMs)
-            ));
+            // Sleep for poll interval, or until the state expires
+            clock_->sleepUntil(std::min(now + pollInterval, stateStart + stateDuration));
         }
     }
     
@@ -0,0 +1,121 @@
+#ifndef VTS_REDUNDANCY_FILTER_HPP
+#define VTS_REDUNDANCY_FILTER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "general_definition.hpp"
+
+namespace vts {
+namespace sniffer {
+
+constexpr uint16_t EtherType_HSR = 0x892F;
+constexpr uint16_t PRP_Suffix = 0x88FB;
+
+/**
+ * @brief IEC 62439-3 redundancy information of a received frame
+ */
+struct RedundancyTag {
+    enum class Kind : uint8_t { None, PRP, HSR };
+
+    Kind kind = Kind::None;
+    uint16_t seqNr = 0;
+    uint8_t lan = 0;              // 0 = LAN A, 1 = LAN B
+    size_t etherTypeOffset = 12;  // Offset of the payload EtherType (after VLAN/HSR tags)
+    size_t payloadEnd = 0;        // Frame length without the PRP trailer
+};
+
+/**
+ * @brief Locate the payload EtherType and any PRP trailer (RCT) or HSR tag
+ *
+ * A PRP trailer is only accepted when its suffix, LAN id and LSDU size are
+ * consistent with the frame, so untagged frames that happen to end in 0x88FB
+ * are not misread.
+ *
+ * @return false if the frame is too short to carry an EtherType
+ */
+bool parseRedundancyTag(const uint8_t* frame, size_t frameSize, RedundancyTag& tag);
+
+/**
+ * @brief Per-LAN counters of the duplicate filter
+ */
+struct RedundancyLanStats {
+    uint64_t received;     // Tagged frames seen on this LAN
+    uint64_t duplicates;   // Discarded as duplicates
+    uint64_t resets;       // Sequence jumped outside the window, source restarted
+};
+
+/**
+ * @brief PRP/HSR duplicate discard (IEC 62439-3 "drop window")
+ *
+ * One sliding window per source MAC, shared by both LANs: bit (seqNr mod
+ * Window) is set when a sequence number has been accepted, so the copy
+ * arriving on the other LAN finds it set and is dropped. Sources live in a
+ * fixed open-addressing table, so accept() never allocates and costs O(1)
+ * (advancing the window clears at most Window bits, amortised one per frame).
+ *
+ * accept() runs on the sniffer thread only; statistics may be read from any
+ * thread.
+ */
+class DuplicateFilter {
+public:
+    static constexpr size_t Window = Sniffer_RedundancyWindow;
+    static constexpr size_t MaxSources = Sniffer_RedundancySources;
+
+    static_assert(Window >= 64 && (Window & (Window - 1)) == 0 && Window <= 32768,
+                  "window must be a power of two between 64 and 32768");
+    static_assert((MaxSources & (MaxSources - 1)) == 0, "source table must be a power of two");
+
+    DuplicateFilter() { reset(); }
+
+    /**
+     * @brief Decide whether a tagged frame is the first copy
+     *
+     * @param srcMac Source MAC address (6 bytes)
+     * @param seqNr Sequence number from the RCT/HSR tag
+     * @param lan 0 for LAN A, 1 for LAN B
+     * @return true to process the frame, false to discard it
+     */
+    bool accept(const uint8_t* srcMac, uint16_t seqNr, uint8_t lan);
+
+    /**
+     * @brief Forget all sources and zero the counters (not concurrent with accept)
+     */
+    void reset();
+
+    RedundancyLanStats lanStats(uint8_t lan) const;
+
+    /** @brief Frames passed unfiltered because the source table was full */
+    uint64_t untracked() const { return untracked_.load(std::memory_order_relaxed); }
+
+    size_t sourceCount() const { return sourceCount_.load(std::memory_order_relaxed); }
+
+private:
+    struct Source {
+        uint8_t mac[6];
+        bool used;
+        uint16_t highest;
+        std::array<uint64_t, Window / 64> seen;
+    };
+
+    struct LanCounters {
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<uint64_t> resets{0};
+    };
+
+    Source* findSource(const uint8_t* mac, bool& added);
+    static void restart(Source& src, uint16_t seqNr);
+
+    std::array<Source, MaxSources> sources_;
+    std::atomic<size_t> sourceCount_{0};
+    std::array<LanCounters, 2> lans_;
+    std::atomic<uint64_t> untracked_{0};
+};
+
+} // namespace sniffer
+} // namespace vts
+
+#endif // VTS_REDUNDANCY_FILTER_HPP
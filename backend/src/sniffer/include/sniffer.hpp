@@ -9,11 +9,17 @@
 #include <atomic>
 #include <array>
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 #include "general_definition.hpp"
 #include "raw_socket_platform.hpp"
 #include "thread_pool.hpp"
+#include "rcu_cell.hpp"
+#include "digital_input_bank.hpp"
 #include "trip_rule_evaluator.hpp"
+#include "redundancy_filter.hpp"
+#include "stream_discovery.hpp"
 
 // Forward declarations
 class WSServer;
@@ -29,7 +35,24 @@ namespace analyzer {
 struct Goose_info{
     std::string goCbRef;
     std::vector<uint8_t> mac_dst;
-    std::vector<std::vector<uint8_t>> input;  // {Digital Input POS, GOOSE data pos}
+    std::vector<std::array<uint16_t, 2>> input;  // {Digital Input POS, GOOSE data pos}
+};
+
+/**
+ * @brief Immutable sniffer configuration snapshot
+ *
+ * Published through SnifferClass::config and picked up by the RX thread
+ * between frames; never modified after publication.
+ */
+struct SnifferConfig {
+    std::vector<Goose_info> goInfo;                         // GOOSE subscriptions
+    std::vector<std::array<uint8_t, 6>> registeredMACs;     // Destination MACs of goInfo
+
+    bool analyzerSelected = false;                          // Forward one SV stream to the analyzer
+    std::array<uint8_t, 6> analyzerMac{};                   // Source MAC of that stream
+    std::string analyzerStream;                             // Stream key passed to the analyzer
+
+    std::shared_ptr<const vts::sniffer::TripRuleEvaluator> tripRules;  // Evaluated on GOOSE updates
 };
 
 void* SnifferThread(void* arg);
@@ -41,16 +64,30 @@ public:
     int noThreads;
     int noTasks;
     int priority;
+    std::vector<int> cpus;      // RX thread affinity (empty = unpinned)
 
     pthread_t thd;
     bool threadStarted;
 
     RawSocket socket;
-    std::array<std::atomic<uint8_t>, 16>* digitalInput;
-    std::vector<Goose_info> goInfo;
+    DigitalInputBank* digitalInput;
+
+    // Virtual-time runs: frames arrive only through injectFrame() and
+    // startThread() publishes the subscriptions without starting the RX thread
+    bool injectOnly;
+
+    // Subscriptions, analyzer selection and trip rules, swapped without
+    // restarting the RX thread
+    RcuCell<SnifferConfig> config;
     
-    // Trip rule evaluator for GOOSE-based trip conditions
+    // GOOSE data points seen by the RX thread, evaluated against config trip rules
     std::unique_ptr<vts::sniffer::TripRuleEvaluator> tripEvaluator;
+
+    // PRP/HSR duplicate discard, applied before SV/GOOSE decode
+    vts::sniffer::DuplicateFilter redundancy;
+
+    // Passive publisher table, filled while discovery->enabled()
+    std::unique_ptr<vts::sniffer::StreamDiscovery> discovery;
     
     // WebSocket server for event emission (weak_ptr to avoid ownership issues)
     std::weak_ptr<WSServer> wsServer;
@@ -58,8 +95,9 @@ public:
     // Analyzer engine for SV stream analysis (weak_ptr to avoid ownership issues)
     std::weak_ptr<vts::analyzer::AnalyzerEngine> analyzerEngine;
 
-    SnifferClass() : running(false), stop(false), threadStarted(false) {
+    SnifferClass() : running(false), stop(false), threadStarted(false), digitalInput(nullptr), injectOnly(false) {
         tripEvaluator = std::make_unique<vts::sniffer::TripRuleEvaluator>();
+        discovery = std::make_unique<vts::sniffer::StreamDiscovery>();
     }
     
     ~SnifferClass(){
@@ -69,12 +107,15 @@ public:
     void init(){
     }
 
+    // Publish the subscriptions and start the RX thread if it is not running.
+    // A running thread keeps capturing and switches at the next frame.
     void startThread(std::vector<Goose_info> gooseInfo){
-        if (threadStarted) {
-            throw std::runtime_error("Sniffer thread already started");
+        setSubscriptions(std::move(gooseInfo));
+        if (threadStarted || injectOnly) {
+            return;
         }
 
-        this->goInfo = gooseInfo;
+        this->redundancy.reset();
         this->noThreads = Sniffer_NoThreads;
         this->noTasks = Sniffer_NoTasks;
         this->priority = Sniffer_ThreadPriority;
@@ -100,6 +141,83 @@ public:
         threadStarted = false;
     }
     
+    /**
+     * @brief Process one frame as if it had been received
+     * 
+     * Runs the RX path on the calling thread, which takes the RX thread's
+     * place, so it is only valid with injectOnly set (e.g. as a
+     * FrameLoopback receiver).
+     * 
+     * @param frame Ethernet frame
+     * @param length Frame length; frames over Sniffer_RxSize are dropped
+     */
+    void injectFrame(const uint8_t* frame, size_t length);
+    
+    /**
+     * @brief Current configuration snapshot
+     */
+    std::shared_ptr<const SnifferConfig> currentConfig() const {
+        return config.load();
+    }
+    
+    /**
+     * @brief Publish new GOOSE subscriptions
+     * 
+     * @param gooseInfo Subscriptions; entries without a 6-byte MAC are kept but never matched
+     * @return Published configuration version
+     */
+    uint64_t setSubscriptions(std::vector<Goose_info> gooseInfo) {
+        return config.update([&gooseInfo](SnifferConfig& cfg) {
+            cfg.goInfo = std::move(gooseInfo);
+            cfg.registeredMACs.clear();
+            for (const auto& info : cfg.goInfo) {
+                if (info.mac_dst.size() != 6) continue;
+                std::array<uint8_t, 6> mac;
+                std::copy(info.mac_dst.begin(), info.mac_dst.end(), mac.begin());
+                cfg.registeredMACs.push_back(mac);
+            }
+        });
+    }
+    
+    /**
+     * @brief Forward the SV stream with this source MAC to the analyzer
+     * 
+     * @param mac Source MAC of the stream
+     * @param stream Stream key the analyzer was started with
+     * @return Published configuration version
+     */
+    uint64_t setAnalyzerStream(const std::array<uint8_t, 6>& mac, const std::string& stream) {
+        return config.update([&](SnifferConfig& cfg) {
+            cfg.analyzerSelected = true;
+            cfg.analyzerMac = mac;
+            cfg.analyzerStream = stream;
+        });
+    }
+    
+    /**
+     * @brief Stop forwarding SV samples to the analyzer
+     * 
+     * @return Published configuration version
+     */
+    uint64_t clearAnalyzerStream() {
+        return config.update([](SnifferConfig& cfg) {
+            cfg.analyzerSelected = false;
+            cfg.analyzerStream.clear();
+        });
+    }
+    
+    /**
+     * @brief Publish a trip rule set
+     * 
+     * @param rules Rules to evaluate on every GOOSE update, nullptr to disable
+     * @return Published configuration version
+     */
+    uint64_t setTripRules(std::shared_ptr<const vts::sniffer::TripRuleEvaluator> rules) {
+        return config.update([&rules](SnifferConfig& cfg) {
+            cfg.tripRules = std::move(rules);
+        });
+    }
+    
     /**
      * @brief Set the WebSocket server for GOOSE event emission
      * 
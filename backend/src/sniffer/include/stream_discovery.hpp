@@ -0,0 +1,132 @@
+#ifndef VTS_STREAM_DISCOVERY_HPP
+#define VTS_STREAM_DISCOVERY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "general_definition.hpp"
+#include "redundancy_filter.hpp"
+
+namespace vts {
+namespace sniffer {
+
+/**
+ * @brief One SV or GOOSE publisher seen on the wire
+ */
+struct DiscoveredStream {
+    enum class Type : uint8_t { SV, GOOSE };
+
+    Type type = Type::SV;
+    std::array<uint8_t, 6> srcMac{};
+    std::array<uint8_t, 6> dstMac{};
+    uint16_t appId = 0;
+    int32_t vlanId = -1;          // -1 when untagged
+    std::string id;               // svID or goCbRef
+    uint32_t confRev = 0;
+    uint32_t channels = 0;        // SV: seqData entries; GOOSE: numDatSetEntries
+    uint32_t noAsdu = 0;          // SV only
+    uint64_t frames = 0;
+    double frameRate = 0.0;       // Frames/s between first and last sighting
+    uint64_t lastSeenNs = 0;      // steady_clock time of the last frame
+};
+
+/**
+ * @brief Passive table of SV/GOOSE publishers, keyed by (src MAC, dst MAC, APPID, VLAN)
+ *
+ * observe() runs on the sniffer thread. For a known stream it only reads the
+ * Ethernet/VLAN/APPID header and bumps two counters; the payload (svID or
+ * goCbRef, confRev, channel count) is decoded on first sighting and again
+ * every Sniffer_DiscoveryRefreshFrames frames.
+ *
+ * The table is a fixed open-addressing array with a single writer. Each slot
+ * is guarded by a sequence counter, so snapshot() can be called from any
+ * thread while capture continues, without locks on either side. clear() is a
+ * request the writer honours on its next frame.
+ */
+class StreamDiscovery {
+public:
+    static constexpr size_t Capacity = Sniffer_DiscoveryCapacity;
+    static constexpr size_t MaxIdLength = 136;
+
+    static_assert((Capacity & (Capacity - 1)) == 0, "discovery table must be a power of two");
+
+    StreamDiscovery() = default;
+    StreamDiscovery(const StreamDiscovery&) = delete;
+    StreamDiscovery& operator=(const StreamDiscovery&) = delete;
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_release); }
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Record one frame (sniffer thread only)
+     *
+     * @param frame Frame starting at the destination MAC
+     * @param frameSize Length without any PRP trailer
+     * @param tag Offsets from parseRedundancyTag()
+     * @param nowNs steady_clock time in nanoseconds
+     */
+    void observe(const uint8_t* frame, size_t frameSize, const RedundancyTag& tag, uint64_t nowNs);
+
+    /**
+     * @brief Consistent copy of every stream (any thread)
+     */
+    std::vector<DiscoveredStream> snapshot() const;
+
+    /**
+     * @brief Drop all entries; applied by the writer before its next frame
+     */
+    void clear() { clearRequested_.store(true, std::memory_order_release); }
+
+    /** @brief Frames from new streams that did not fit in the table */
+    uint64_t overflow() const { return overflow_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t IdWords = MaxIdLength / 8;
+    static constexpr uint64_t TypeGoose = uint64_t{1} << 13;
+    static constexpr uint64_t VlanTagged = uint64_t{1} << 12;
+
+    // All fields are atomics so readers racing the writer stay well-defined;
+    // `seq` is odd while the identity/payload fields are being rewritten.
+    struct Slot {
+        std::atomic<uint32_t> seq{0};
+        std::atomic<bool> used{false};
+        std::atomic<uint64_t> keyHi{0};     // src MAC << 16 | APPID
+        std::atomic<uint64_t> keyLo{0};     // dst MAC << 16 | type/VLAN
+        std::atomic<uint32_t> idLength{0};
+        std::array<std::atomic<uint64_t>, IdWords> id{};
+        std::atomic<uint32_t> confRev{0};
+        std::atomic<uint32_t> channels{0};
+        std::atomic<uint32_t> noAsdu{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> firstSeenNs{0};
+        std::atomic<uint64_t> lastSeenNs{0};
+    };
+
+    struct Payload {
+        const uint8_t* id = nullptr;
+        size_t idLength = 0;
+        uint32_t confRev = 0;
+        uint32_t channels = 0;
+        uint32_t noAsdu = 0;
+    };
+
+    static bool decodeSV(const uint8_t* pdu, size_t size, Payload& out);
+    static bool decodeGOOSE(const uint8_t* pdu, size_t size, Payload& out);
+
+    void writePayload(Slot& slot, const Payload& payload);
+    void applyClear();
+
+    std::array<Slot, Capacity> slots_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> clearRequested_{false};
+    std::atomic<uint64_t> overflow_{0};
+};
+
+} // namespace sniffer
+} // namespace vts
+
+#endif // VTS_STREAM_DISCOVERY_HPP
@@ -175,6 +175,16 @@ public:
      */
     TripRuleResult evaluate();
     
+    /**
+     * @brief Evaluate all enabled rules against externally held data points
+     *
+     * Lets an immutable, shared rule set be evaluated by a thread that keeps
+     * its own data points.
+     * @param dataPoints Map of path to data point
+     * @return Result with first triggered rule (if any)
+     */
+    TripRuleResult evaluate(const std::map<std::string, GooseDataPoint>& dataPoints) const;
+    
     /**
      * @brief Get all current data points
      * @return Map of path to data point
@@ -0,0 +1,48 @@
+#ifndef VTS_TRIP_RULE_JSON_HPP
+#define VTS_TRIP_RULE_JSON_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "trip_rule_evaluator.hpp"
+
+namespace vts {
+namespace sniffer {
+
+/**
+ * @brief Rule set from a JSON array of {"name", "expression", "enabled"?}
+ *
+ * Data points are named "<goCbRef>/data<index>" after the subscribed
+ * control block and the allData entry, e.g. "R1/LLN0$GO$Trip/data0 == true".
+ * @return The parsed rules, nullptr for an empty array (rules disabled)
+ * @throws std::invalid_argument if an expression does not parse,
+ *         nlohmann::json::exception on missing keys or wrong types
+ */
+inline std::shared_ptr<const TripRuleEvaluator> tripRulesFromJson(const nlohmann::json& rules) {
+    if (!rules.is_array()) {
+        throw std::invalid_argument("tripRules must be an array");
+    }
+    if (rules.empty()) {
+        return nullptr;
+    }
+
+    auto evaluator = std::make_shared<TripRuleEvaluator>();
+    for (const auto& rule : rules) {
+        const std::string name = rule.at("name").get<std::string>();
+        if (!evaluator->addRule(name, rule.at("expression").get<std::string>())) {
+            throw std::invalid_argument("Trip rule " + name + ": " + evaluator->getLastError());
+        }
+        if (!rule.value("enabled", true)) {
+            evaluator->setRuleEnabled(name, false);
+        }
+    }
+    return evaluator;
+}
+
+} // namespace sniffer
+} // namespace vts
+
+#endif // VTS_TRIP_RULE_JSON_HPP
@@ -0,0 +1,169 @@
+#include "redundancy_filter.hpp"
+
+#include <cstring>
+
+namespace vts {
+namespace sniffer {
+
+namespace {
+
+inline uint16_t loadBE16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline void setBit(std::array<uint64_t, DuplicateFilter::Window / 64>& bits, uint16_t seqNr) {
+    const size_t bit = seqNr & (DuplicateFilter::Window - 1);
+    bits[bit >> 6] |= uint64_t{1} << (bit & 63);
+}
+
+inline void clearBit(std::array<uint64_t, DuplicateFilter::Window / 64>& bits, uint16_t seqNr) {
+    const size_t bit = seqNr & (DuplicateFilter::Window - 1);
+    bits[bit >> 6] &= ~(uint64_t{1} << (bit & 63));
+}
+
+inline bool testBit(const std::array<uint64_t, DuplicateFilter::Window / 64>& bits, uint16_t seqNr) {
+    const size_t bit = seqNr & (DuplicateFilter::Window - 1);
+    return (bits[bit >> 6] >> (bit & 63)) & 1u;
+}
+
+} // namespace
+
+bool parseRedundancyTag(const uint8_t* frame, size_t frameSize, RedundancyTag& tag) {
+    tag = RedundancyTag();
+    if (frameSize < 14) return false;
+
+    size_t off = 12;
+    size_t vlanLen = 0;
+    if (loadBE16(frame + off) == 0x8100) {
+        if (frameSize < 18) return false;
+        off += 4;
+        vlanLen = 4;
+    }
+    tag.payloadEnd = frameSize;
+
+    // HSR: [0x892F][PathId:4 | LSDU size:12][SeqNr] then the payload EtherType
+    if (loadBE16(frame + off) == EtherType_HSR) {
+        if (frameSize < off + 8) return false;
+        tag.kind = RedundancyTag::Kind::HSR;
+        tag.lan = static_cast<uint8_t>((frame[off + 2] >> 4) & 0x01);
+        tag.seqNr = loadBE16(frame + off + 4);
+        tag.etherTypeOffset = off + 6;
+        return true;
+    }
+    tag.etherTypeOffset = off;
+
+    // PRP: [SeqNr][LanId:4 | LSDU size:12][0x88FB] at the end of the frame.
+    // LSDU size covers everything after the source MAC and VLAN tag.
+    if (frameSize >= off + 2 + 6) {
+        const uint8_t* rct = frame + frameSize - 6;
+        const uint8_t lanId = static_cast<uint8_t>(rct[2] >> 4);
+        const size_t lsduSize = static_cast<size_t>(((rct[2] & 0x0F) << 8) | rct[3]);
+        if (loadBE16(rct + 4) == PRP_Suffix && (lanId == 0xA || lanId == 0xB) &&
+            lsduSize == frameSize - 12 - vlanLen) {
+            tag.kind = RedundancyTag::Kind::PRP;
+            tag.lan = lanId == 0xA ? 0 : 1;
+            tag.seqNr = loadBE16(rct);
+            tag.payloadEnd = frameSize - 6;
+        }
+    }
+    return true;
+}
+
+void DuplicateFilter::reset() {
+    for (auto& src : sources_) {
+        src.used = false;
+    }
+    sourceCount_.store(0, std::memory_order_relaxed);
+    for (auto& lan : lans_) {
+        lan.received.store(0, std::memory_order_relaxed);
+        lan.duplicates.store(0, std::memory_order_relaxed);
+        lan.resets.store(0, std::memory_order_relaxed);
+    }
+    untracked_.store(0, std::memory_order_relaxed);
+}
+
+RedundancyLanStats DuplicateFilter::lanStats(uint8_t lan) const {
+    const LanCounters& c = lans_[lan & 1];
+    return RedundancyLanStats{
+        c.received.load(std::memory_order_relaxed),
+        c.duplicates.load(std::memory_order_relaxed),
+        c.resets.load(std::memory_order_relaxed)
+    };
+}
+
+DuplicateFilter::Source* DuplicateFilter::findSource(const uint8_t* mac, bool& added) {
+    // FNV-1a over the MAC, linear probing
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 6; ++i) {
+        hash = (hash ^ mac[i]) * 16777619u;
+    }
+    for (size_t probe = 0; probe < MaxSources; ++probe) {
+        Source& src = sources_[(hash + probe) & (MaxSources - 1)];
+        if (!src.used) {
+            std::memcpy(src.mac, mac, 6);
+            src.used = true;
+            added = true;
+            sourceCount_.fetch_add(1, std::memory_order_relaxed);
+            return &src;
+        }
+        if (std::memcmp(src.mac, mac, 6) == 0) {
+            return &src;
+        }
+    }
+    return nullptr;
+}
+
+void DuplicateFilter::restart(Source& src, uint16_t seqNr) {
+    src.seen.fill(0);
+    src.highest = seqNr;
+    setBit(src.seen, seqNr);
+}
+
+bool DuplicateFilter::accept(const uint8_t* srcMac, uint16_t seqNr, uint8_t lan) {
+    LanCounters& counters = lans_[lan & 1];
+    counters.received.fetch_add(1, std::memory_order_relaxed);
+
+    bool added = false;
+    Source* src = findSource(srcMac, added);
+    if (src == nullptr) {
+        untracked_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (added) {
+        restart(*src, seqNr);
+        return true;
+    }
+
+    // Sequence numbers wrap at 16 bits; the signed distance orders them
+    const int16_t delta = static_cast<int16_t>(static_cast<uint16_t>(seqNr - src->highest));
+
+    if (delta > 0) {
+        if (static_cast<size_t>(delta) >= Window) {
+            src->seen.fill(0);
+        } else {
+            for (uint16_t s = static_cast<uint16_t>(src->highest + 1); s != seqNr; ++s) {
+                clearBit(src->seen, s);
+            }
+        }
+        src->highest = seqNr;
+        setBit(src->seen, seqNr);
+        return true;
+    }
+
+    if (static_cast<size_t>(-static_cast<int32_t>(delta)) >= Window) {
+        // Too old to be a duplicate we could have seen: the sender restarted
+        counters.resets.fetch_add(1, std::memory_order_relaxed);
+        restart(*src, seqNr);
+        return true;
+    }
+
+    if (testBit(src->seen, seqNr)) {
+        counters.duplicates.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    setBit(src->seen, seqNr);
+    return true;
+}
+
+} // namespace sniffer
+} // namespace vts
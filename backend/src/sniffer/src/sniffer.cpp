@@ -5,7 +5,9 @@
 #include "rt_utils.hpp"
 #include "logger.hpp"
 #include "metrics.hpp"
+#include "thread_health.hpp"
 #include "global_flags.hpp"
+#include "BER_Codec.hpp"
 
 #include <chrono>
 #include <vector>
@@ -42,7 +44,6 @@
 #endif
 
 // Globals removed - moved into SnifferThread as local variables
-// std::vector<std::vector<uint8_t>> registeredMACs;
 // SnifferClass* sniffer;
 
 int debug_count=0;
@@ -51,163 +52,113 @@ struct task_arg{
     uint8_t* pkt;
     ssize_t pkt_len;
     SnifferClass* sniffer; // Add context
-    std::vector<std::vector<uint8_t>>* registeredMACs; // Add context
+    const SnifferConfig* config; // Snapshot valid for this frame
 };
 
-void process_GOOSE_packet(uint8_t* frame, ssize_t frameSize, int i, SnifferClass* sniffer){
+void process_GOOSE_packet(uint8_t* frame, ssize_t frameSize, int i, SnifferClass* sniffer, const SnifferConfig& cfg){
 
-    // Validate minimum GOOSE header size
-    if (i + 14 > frameSize) {
+    if (i + 10 > frameSize) {
         LOG_ERROR("GOOSE", "Truncated header (frameSize=%zd, position=%d)", frameSize, i);
         METRIC_PARSE_ERROR();
         return;
     }
 
-    // frame[i:i+2] // APPID
-    // frame[i+2:i+4] // Length
-    // frame[i+4:i+8] // Reserved 1 and 2
-    // frame[i+9] // GOOSE TAG
-    // frame[i+10] // GOOSE Length
-
-    // Parse BER length with bounds checking
-    uint16_t length = 0;
-    if (frame[i+11] == 0x82){
-        if (i + 14 > frameSize) {
-            LOG_ERROR("GOOSE", "Truncated 0x82 length field (frameSize=%zd, position=%d)", frameSize, i);
-            METRIC_PARSE_ERROR();
-            return;
-        }
-        length = static_cast<uint16_t>((frame[i+12] << 8) | frame[i+13]);
-        i += 14;
-    }else if (frame[i+11] == 0x81){
-        if (i + 13 > frameSize) {
-            LOG_ERROR("GOOSE", "Truncated 0x81 length field (frameSize=%zd, position=%d)", frameSize, i);
-            METRIC_PARSE_ERROR();
-            return;
-        }
-        length = frame[i+12];
-        i += 13;
-    }else{
-        length = frame[i+11];
-        i += 12;
-    }
-
-    // Validate length against remaining frame
-    if (i + length > frameSize) {
-        LOG_ERROR("GOOSE", "PDU length exceeds frame size (length=%u, frameSize=%zd, position=%d)", 
-                  length, frameSize, i);
+    // EtherType (2), APPID (2), Length (2), Reserved 1 and 2 (4), then goosePdu
+    BERReader reader(frame + i + 10, static_cast<size_t>(frameSize - i - 10));
+    BERReader pdu;
+    uint8_t tag;
+    if (!reader.readTLV(tag, pdu) || tag != 0x61) {
+        LOG_ERROR("GOOSE", "Invalid or truncated goosePdu (frameSize=%zd, position=%d)", frameSize, i);
         METRIC_PARSE_ERROR();
         return;
     }
 
-    int j = 0, goIdx = -1;
-    while (j < length){
-        // Bounds check for TLV access
-        if (i + j + 1 >= frameSize) {
-            LOG_ERROR("GOOSE", "TLV truncated (frameSize=%zd, position=%d)", frameSize, i + j);
-            METRIC_PARSE_ERROR();
-            return;
-        }
-
-        uint8_t tag = frame[i+j];
-        uint8_t tlv_len = frame[i+j+1];
-
-        // Validate TLV data is within bounds
-        if (i + j + 2 + tlv_len > frameSize) {
-            LOG_ERROR("GOOSE", "TLV data exceeds frame (frameSize=%zd, position=%d, tlv_len=%u)", 
-                      frameSize, i + j, tlv_len);
+    int goIdx = -1;
+    BERReader field, allData;
+    bool hasAllData = false;
+    while (!pdu.empty()){
+        if (!pdu.readTLV(tag, field)) {
+            LOG_ERROR("GOOSE", "TLV truncated (frameSize=%zd, position=%zu)", frameSize, pdu.offset());
             METRIC_PARSE_ERROR();
             return;
         }
 
         if (tag == 0x80){
-            for (size_t idx = 0; idx < sniffer->goInfo.size(); idx++)
-            if (tlv_len <= sniffer->goInfo[idx].goCbRef.size() &&
-                memcmp(&frame[i+j+2], sniffer->goInfo[idx].goCbRef.data(), tlv_len) == 0){
-                goIdx = static_cast<int>(idx);
-                break;
+            for (size_t idx = 0; idx < cfg.goInfo.size(); idx++){
+                const std::string& ref = cfg.goInfo[idx].goCbRef;
+                if (field.remaining() == ref.size() && memcmp(field.current(), ref.data(), ref.size()) == 0){
+                    goIdx = static_cast<int>(idx);
+                    break;
+                }
             }
+            if (goIdx == -1) return;
         }
 
         if (tag == 0xab){
+            allData = field;
+            hasAllData = true;
             break;
         }
-
-        j += tlv_len + 2;
     }
-    
+
     if (goIdx == -1) return;
-    i += j;
-    
-    // Parse allData with bounds checking
-    if (i + 1 >= frameSize) {
-        LOG_ERROR("GOOSE", "allData truncated (frameSize=%zd, position=%d)", frameSize, i);
+    if (!hasAllData) {
+        LOG_ERROR("GOOSE", "allData missing (frameSize=%zd)", frameSize);
         METRIC_PARSE_ERROR();
         return;
     }
-    
-    std::vector<uint8_t> boolDat;
-    j = 2;
-    length = frame[i+1];
-    
-    if (i + length > frameSize) {
-        LOG_ERROR("GOOSE", "allData length exceeds frame (length=%u, frameSize=%zd, position=%d)", 
-                  length, frameSize, i);
-        METRIC_PARSE_ERROR();
-        return;
-    }
-    
-    while (j < length){
-        if (i + j + 1 >= frameSize) break;
-        
-        uint8_t tag = frame[i+j];
-        uint8_t tlv_len = frame[i+j+1];
-        
-        if (i + j + 2 + tlv_len > frameSize) break;
-        
+
+    // Boolean view of allData: the value byte for BOOLEAN entries, 0 otherwise
+    std::array<uint8_t, Sniffer_MaxGooseEntries> boolDat;
+    size_t noEntries = 0;
+    BERReader entry;
+    while (!allData.empty() && noEntries < boolDat.size()){
+        if (!allData.readTLV(tag, entry)) break;
+        uint8_t value = 0;
         if (tag == 0x83){
-            boolDat.push_back(frame[i+j+2]);
-        }else{
-            boolDat.push_back(0);
+            entry.peek(value);
         }
-        j += tlv_len + 2;
+        boolDat[noEntries++] = value;
     }
     
-    for (const auto& dat : sniffer->goInfo[static_cast<size_t>(goIdx)].input){
-        if (dat[0] >= boolDat.size()){
-            LOG_ERROR("GOOSE", "Data index out of range (dat[0]=%u, boolDat.size=%zu)", 
-                      dat[0], boolDat.size());
+    DigitalInputBank* inputs = sniffer->digitalInput;
+    const uint64_t rxTimeNs = DigitalInputBank::nowNs();
+    for (const auto& dat : cfg.goInfo[static_cast<size_t>(goIdx)].input){
+        if (inputs == nullptr) break;
+        if (dat[0] >= inputs->size()){
+            LOG_ERROR("GOOSE", "Data index out of range (dat[0]=%u, digitalInput.size=%zu)", 
+                      dat[0], inputs->size());
             METRIC_PARSE_ERROR();
             return;
         }
-        if (dat[1] >= boolDat.size()) {
+        if (dat[1] >= noEntries) {
             LOG_ERROR("GOOSE", "GOOSE data index out of range (dat[1]=%u, boolDat.size=%zu)", 
-                      dat[1], boolDat.size());
+                      dat[1], noEntries);
             METRIC_PARSE_ERROR();
             return;
         }
-        (*sniffer->digitalInput)[dat[0]].store(boolDat[dat[1]], std::memory_order_release);
+        inputs->set(dat[0], boolDat[dat[1]] != 0, rxTimeNs);
     }
     
     // Successfully received and parsed GOOSE packet
     METRIC_RECV_FRAME();
     
     // Trip rule evaluation
-    if (sniffer->tripEvaluator) {
+    if (sniffer->tripEvaluator && cfg.tripRules) {
         // Update trip evaluator with GOOSE data points
         // For now, we update based on the goCbRef and boolean values
         // In a full implementation, we would extract all data points from the GOOSE message
         
-        std::string goCbRef = sniffer->goInfo[static_cast<size_t>(goIdx)].goCbRef;
+        const std::string& goCbRef = cfg.goInfo[static_cast<size_t>(goIdx)].goCbRef;
         
         // Update data points for each boolean value in the GOOSE message
-        for (size_t idx = 0; idx < boolDat.size(); idx++) {
+        for (size_t idx = 0; idx < noEntries; idx++) {
             std::string dataPath = goCbRef + "/data" + std::to_string(idx);
             sniffer->tripEvaluator->updateDataPoint(dataPath, static_cast<bool>(boolDat[idx]));
         }
         
-        // Evaluate trip rules
-        auto result = sniffer->tripEvaluator->evaluate();
+        // Evaluate the published trip rules
+        auto result = cfg.tripRules->evaluate(sniffer->tripEvaluator->getDataPoints());
         
         if (result.triggered) {
             LOG_INFO("GOOSE", "Trip rule triggered: %s - %s", 
@@ -229,198 +180,151 @@ void process_GOOSE_packet(uint8_t* frame, ssize_t frameSize, int i, SnifferClass
     // std::cout << "GOOSE Received: "<< (boolDat[0] != 0) << std::endl;
 }
 
-void process_SV_packet(uint8_t* frame, ssize_t frameSize, int i, SnifferClass* sniffer) {
+void process_SV_packet(uint8_t* frame, ssize_t frameSize, int i, SnifferClass* sniffer, const SnifferConfig& cfg) {
+    // Check if this is the stream we're analyzing
+    if (!cfg.analyzerSelected || memcmp(frame + 6, cfg.analyzerMac.data(), 6) != 0) {
+        return;  // Not the target stream
+    }
+    
     // Check if analyzer is available
     auto analyzer = sniffer->analyzerEngine.lock();
     if (!analyzer || !analyzer->isRunning()) {
         return;  // Analyzer not running, skip processing
     }
-    
-    // Extract source MAC address
-    char macStr[18];
-    snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X",
-             frame[6], frame[7], frame[8], frame[9], frame[10], frame[11]);
-    std::string streamMac(macStr);
-    
-    // Check if this is the stream we're analyzing
-    if (streamMac != analyzer->getStreamMac()) {
-        return;  // Not the target stream
-    }
+    const std::string& streamMac = cfg.analyzerStream;
     
     // Validate minimum SV packet size
-    if (i + 8 > frameSize) {
+    if (i + 10 > frameSize) {
         LOG_ERROR("SV", "Truncated SV header (frameSize=%zd, position=%d)", frameSize, i);
         return;
     }
     
-    // Skip to SAVPDU (0x60)
-    i += 8;  // Skip AppID (2) + Length (2) + Reserved1 (2) + Reserved2 (2)
-    
-    if (i >= frameSize || frame[i] != 0x60) {
-        LOG_ERROR("SV", "Invalid SAVPDU tag (expected 0x60, got 0x%02X)", frame[i]);
+    // Skip EtherType (2) + AppID (2) + Length (2) + Reserved1 (2) + Reserved2 (2)
+    BERReader reader(frame + i + 10, static_cast<size_t>(frameSize - i - 10));
+    BERReader savPdu;
+    uint8_t tag;
+    if (!reader.readTLV(tag, savPdu) || tag != 0x60) {
+        LOG_ERROR("SV", "Invalid or truncated SAVPDU");
         return;
     }
     
-    i++;  // Skip tag
-    
-    // Parse SAVPDU length
-    int savpduLength = 0;
-    if (i >= frameSize) return;
+    // noASDU (0x80)
+    BERReader field;
+    uint32_t noAsdu = 0;
+    if (!savPdu.readTLV(tag, field) || tag != 0x80 || !field.readUnsigned(noAsdu)) return;
     
-    if (frame[i] == 0x82) {
-        if (i + 3 > frameSize) return;
-        savpduLength = (frame[i+1] << 8) | frame[i+2];
-        i += 3;
-    } else if (frame[i] == 0x81) {
-        if (i + 2 > frameSize) return;
-        savpduLength = frame[i+1];
-        i += 2;
-    } else {
-        savpduLength = frame[i];
-        i++;
-    }
-    
-    if (i + savpduLength > frameSize) {
-        LOG_ERROR("SV", "SAVPDU length exceeds frame size");
-        return;
-    }
+    // Skip security if present (0x81), then SEQUENCE OF ASDU (0xA2)
+    if (!savPdu.readTLV(tag, field)) return;
+    if (tag == 0x81 && !savPdu.readTLV(tag, field)) return;
+    if (tag != 0xA2) return;
+    BERReader seqAsdu = field;
     
-    // Parse noASDU (0x80)
-    if (i >= frameSize || frame[i] != 0x80) return;
-    i++;
-    if (i >= frameSize) return;
-    int noAsdu = frame[i];
-    i++;
-    
-    // Skip security if present (0x81)
-    if (i < frameSize && frame[i] == 0x81) {
-        i++; // tag
-        if (i >= frameSize) return;
-        int secLen = frame[i];
-        i += 1 + secLen;
-    }
+    auto timestamp = std::chrono::steady_clock::now();
     
     // Process each ASDU
-    for (int asduIdx = 0; asduIdx < noAsdu && i < frameSize; asduIdx++) {
-        // Parse ASDU (0x30)
-        if (i >= frameSize || frame[i] != 0x30) break;
-        i++;
-        
-        // Parse ASDU length
-        if (i >= frameSize) break;
-        int asduLen = 0;
-        if (frame[i] == 0x82) {
-            if (i + 3 > frameSize) break;
-            asduLen = (frame[i+1] << 8) | frame[i+2];
-            i += 3;
-        } else if (frame[i] == 0x81) {
-            if (i + 2 > frameSize) break;
-            asduLen = frame[i+1];
-            i += 2;
-        } else {
-            asduLen = frame[i];
-            i++;
-        }
-        
-        int asduEnd = i + asduLen;
+    BERReader asdu;
+    for (uint32_t asduIdx = 0; asduIdx < noAsdu && !seqAsdu.empty(); asduIdx++) {
+        if (!seqAsdu.readTLV(tag, asdu) || tag != 0x30) break;
         
         // Parse ASDU fields to find seqData
-        while (i < asduEnd && i < frameSize) {
-            uint8_t tag = frame[i++];
-            if (i >= frameSize) break;
-            
-            int fieldLen = 0;
-            if (frame[i] == 0x82) {
-                if (i + 3 > frameSize) break;
-                fieldLen = (frame[i+1] << 8) | frame[i+2];
-                i += 3;
-            } else if (frame[i] == 0x81) {
-                if (i + 2 > frameSize) break;
-                fieldLen = frame[i+1];
-                i += 2;
-            } else {
-                fieldLen = frame[i];
-                i++;
-            }
+        while (asdu.readTLV(tag, field)) {
+            if (tag != 0x87) continue;
             
-            if (tag == 0x87) {
-                // This is seqData - contains the actual sample values
-                // Each sample is typically 4 or 8 bytes (int32 or int64)
-                int numSamples = fieldLen / 8;  // Assuming 8-byte samples (int32 value + int32 quality)
+            // seqData: INT32 value + 4-byte quality per channel
+            int32_t rawValue;
+            uint32_t value32, quality;
+            for (int sampleIdx = 0; field.remaining() >= 8; sampleIdx++) {
+                field.readU32(value32);
+                field.readU32(quality);
+                rawValue = static_cast<int32_t>(value32);
                 
-                auto timestamp = std::chrono::steady_clock::now();
+                // Convert to floating point (assuming some scaling factor)
+                // Typical IEC 61850-9-2 scaling: value / 100 for voltage/current
+                double value = static_cast<double>(rawValue) / 100.0;
                 
-                for (int sampleIdx = 0; sampleIdx < numSamples && i + 8 <= frameSize; sampleIdx++) {
-                    // Parse Int32 value (4 bytes, big-endian)
-                    int32_t rawValue = static_cast<int32_t>(
-                        (static_cast<uint32_t>(frame[i]) << 24) |
-                        (static_cast<uint32_t>(frame[i+1]) << 16) |
-                        (static_cast<uint32_t>(frame[i+2]) << 8) |
-                        static_cast<uint32_t>(frame[i+3])
-                    );
-                    
-                    // Skip quality (4 bytes)
-                    i += 8;
-                    
-                    // Convert to floating point (assuming some scaling factor)
-                    // Typical IEC 61850-9-2 scaling: value / 100 for voltage/current
-                    double value = static_cast<double>(rawValue) / 100.0;
-                    
-                    // Generate channel name (e.g., "Ch0", "Ch1", etc.)
-                    char channelName[16];
-                    snprintf(channelName, sizeof(channelName), "Ch%d", sampleIdx);
-                    
-                    // Send to analyzer
-                    analyzer->processSample(streamMac, std::string(channelName), value, timestamp);
-                }
+                // Generate channel name (e.g., "Ch0", "Ch1", etc.)
+                char channelName[16];
+                snprintf(channelName, sizeof(channelName), "Ch%d", sampleIdx);
                 
-                break;  // Found seqData, done with this ASDU
-            } else {
-                // Skip other fields
-                i += fieldLen;
+                // Send to analyzer
+                analyzer->processSample(streamMac, std::string(channelName), value, timestamp);
             }
+            
+            break;  // Found seqData, done with this ASDU
         }
     }
 }
 
 void process_pkt(task_arg* arg) {
 
-    // Todo: Chech for PRP Packets, do not duplicate the data from them
-
     uint8_t* frame = arg->pkt;
     ssize_t frameSize = arg->pkt_len;
-    std::vector<std::vector<uint8_t>>* registeredMACs = arg->registeredMACs;
+    const SnifferConfig& cfg = *arg->config;
     SnifferClass* sniffer = arg->sniffer;
 
     // -------- Process the frame -------- //
 
-    // Check if the mac exist in the registeredMACs
+    if (frameSize < 14) return;
+
+    // Skip Ethernet, VLAN and HSR tags; drop the second copy of PRP/HSR frames
+    vts::sniffer::RedundancyTag rtag;
+    if (!vts::sniffer::parseRedundancyTag(frame, static_cast<size_t>(frameSize), rtag)) return;
+    if (rtag.kind != vts::sniffer::RedundancyTag::Kind::None){
+        if (!sniffer->redundancy.accept(frame + 6, rtag.seqNr, rtag.lan)) return;
+        frameSize = static_cast<ssize_t>(rtag.payloadEnd);
+    }
+
+    // Discovery sees every publisher, not only the subscribed ones
+    if (sniffer->discovery->enabled()){
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        sniffer->discovery->observe(frame, static_cast<size_t>(frameSize), rtag,
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()));
+    }
+
+    // Check if the mac exist in the registeredMACs or is the analyzed SV stream
     int mac_found = 0;
-    for (size_t i=0; i<registeredMACs->size(); i++){
-        if (memcmp(frame, (*registeredMACs)[i].data(), 6) == 0){ // For SV
+    for (const auto& mac : cfg.registeredMACs){
+        if (memcmp(frame, mac.data(), 6) == 0){ // For SV
             mac_found = 1;
             break;
         }
-        if (memcmp(frame+6, (*registeredMACs)[i].data(), 6) == 0){ // For GOOSE
+        if (memcmp(frame+6, mac.data(), 6) == 0){ // For GOOSE
             mac_found = 1;
             break;
         }
     }
+    if (!mac_found && cfg.analyzerSelected && memcmp(frame+6, cfg.analyzerMac.data(), 6) == 0){
+        mac_found = 1;
+    }
     if (!mac_found) return;
 
-    // uint16_t smpCount;
-    // int j = 0; // unused variable removed
-    int i = (frame[12] == 0x81 && frame[13] == 0x00) ? 16 : 12; // Skip Ethernet and vLAN
+    int i = static_cast<int>(rtag.etherTypeOffset);
+    if (i + 2 > frameSize) return;
 
     if ((frame[i] == 0x88 && frame[i+1] == 0xba)){ // Check if packet is SV
-        process_SV_packet(frame, frameSize, i, sniffer);
+        process_SV_packet(frame, frameSize, i, sniffer, cfg);
         return;
     }else if ((frame[i] == 0x88 && frame[i+1] == 0xb8)){
-        process_GOOSE_packet(frame, frameSize, i, sniffer);
+        process_GOOSE_packet(frame, frameSize, i, sniffer, cfg);
     }else return;
 
 }
 
+void SnifferClass::injectFrame(const uint8_t* frame, size_t length) {
+    if (length > static_cast<size_t>(Sniffer_RxSize)) return;
+
+    uint8_t buffer[Sniffer_RxSize];
+    memcpy(buffer, frame, length);
+    std::shared_ptr<const SnifferConfig> cfg = config.load();
+
+    task_arg task;
+    task.pkt = buffer;
+    task.pkt_len = static_cast<ssize_t>(length);
+    task.sniffer = this;
+    task.config = cfg.get();
+    process_pkt(&task);
+}
+
 void* SnifferThread(void* arg){
 
     using namespace std::chrono;
@@ -432,19 +336,17 @@ void* SnifferThread(void* arg){
     
     // Set real-time priority (high priority for packet capture)
     rt_set_realtime(Sniffer_ThreadPriority);  // Default: 80 (configured in general_definition.hpp)
+    ThreadHealth::Scope health("sniffer");
     
-    // Optional: Set CPU affinity to isolate sniffer thread
-    // Example: bind to CPUs 2-3 for dedicated packet processing
-    // rt_set_affinity({2, 3});
+    // Isolate the sniffer on its configured cores (--sniffer-cpus)
+    if (!sniffer_conf->cpus.empty()) {
+        rt_set_affinity(sniffer_conf->cpus);
+    }
     
     sniffer_conf->running.store(true, std::memory_order_release);
 
-    // Create local MACs list instead of global
-    std::vector<std::vector<uint8_t>> registeredMACs;
-    for (auto mac : sniffer_conf->goInfo){
-        registeredMACs.push_back(mac.mac_dst);
-    }
-
+    // Configuration is re-read between frames; a publish takes effect on the next one
+    RcuCell<SnifferConfig>::Reader config(sniffer_conf->config);
 
 #ifdef __linux__
     RawSocket* raw_socket = &sniffer_conf->socket;
@@ -478,7 +380,7 @@ void* SnifferThread(void* arg){
         task.pkt = args_buff[idx_task];
         task.pkt_len = rx_bytes;
         task.sniffer = sniffer_conf;
-        task.registeredMACs = &registeredMACs;
+        task.config = &config.get();
         process_pkt(&task);
         ++idx_task;
         if (idx_task > Sniffer_NoTasks)  idx_task = 0;
@@ -0,0 +1,258 @@
+#include "stream_discovery.hpp"
+#include "BER_Codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vts {
+namespace sniffer {
+
+namespace {
+
+inline uint16_t loadBE16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint64_t loadMac48(const uint8_t* p) {
+    uint64_t mac = 0;
+    for (int i = 0; i < 6; ++i) {
+        mac = (mac << 8) | p[i];
+    }
+    return mac;
+}
+
+inline void storeMac48(uint64_t mac, std::array<uint8_t, 6>& out) {
+    for (int i = 5; i >= 0; --i) {
+        out[static_cast<size_t>(i)] = static_cast<uint8_t>(mac & 0xFF);
+        mac >>= 8;
+    }
+}
+
+inline size_t slotHash(uint64_t keyHi, uint64_t keyLo) {
+    uint64_t h = keyHi * 0x9E3779B97F4A7C15ull ^ keyLo;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 32;
+    return static_cast<size_t>(h);
+}
+
+} // namespace
+
+bool StreamDiscovery::decodeSV(const uint8_t* pdu, size_t size, Payload& out) {
+    BERReader reader(pdu, size);
+    BERReader savPdu, field, seqAsdu, asdu;
+    uint8_t tag;
+    if (!reader.readTLV(tag, savPdu) || tag != 0x60) return false;
+    if (!savPdu.readTLV(tag, field) || tag != 0x80 || !field.readUnsigned(out.noAsdu)) return false;
+    if (!savPdu.readTLV(tag, field)) return false;
+    if (tag == 0x81 && !savPdu.readTLV(tag, field)) return false;
+    if (tag != 0xA2) return false;
+    seqAsdu = field;
+    if (!seqAsdu.readTLV(tag, asdu) || tag != 0x30) return false;
+
+    while (asdu.readTLV(tag, field)) {
+        switch (tag) {
+            case 0x80:
+                out.id = field.current();
+                out.idLength = field.remaining();
+                break;
+            case 0x83:
+                field.readUnsigned(out.confRev);
+                break;
+            case 0x87:
+                out.channels = static_cast<uint32_t>(field.remaining() / 8);
+                return true;
+            default:
+                break;
+        }
+    }
+    return out.id != nullptr;
+}
+
+bool StreamDiscovery::decodeGOOSE(const uint8_t* pdu, size_t size, Payload& out) {
+    BERReader reader(pdu, size);
+    BERReader goosePdu, field;
+    uint8_t tag;
+    if (!reader.readTLV(tag, goosePdu) || tag != 0x61) return false;
+
+    while (goosePdu.readTLV(tag, field)) {
+        switch (tag) {
+            case 0x80:
+                out.id = field.current();
+                out.idLength = field.remaining();
+                break;
+            case 0x88:
+                field.readUnsigned(out.confRev);
+                break;
+            case 0x8A:
+                field.readUnsigned(out.channels);
+                return true;
+            default:
+                break;
+        }
+    }
+    return out.id != nullptr;
+}
+
+void StreamDiscovery::writePayload(Slot& slot, const Payload& payload) {
+    const size_t length = std::min(payload.idLength, MaxIdLength);
+    for (size_t w = 0; w < IdWords; ++w) {
+        uint64_t word = 0;
+        if (w * 8 < length) {
+            std::memcpy(&word, payload.id + w * 8, std::min<size_t>(8, length - w * 8));
+        }
+        slot.id[w].store(word, std::memory_order_relaxed);
+    }
+    slot.idLength.store(static_cast<uint32_t>(length), std::memory_order_relaxed);
+    slot.confRev.store(payload.confRev, std::memory_order_relaxed);
+    slot.channels.store(payload.channels, std::memory_order_relaxed);
+    slot.noAsdu.store(payload.noAsdu, std::memory_order_relaxed);
+}
+
+void StreamDiscovery::applyClear() {
+    for (auto& slot : slots_) {
+        if (!slot.used.load(std::memory_order_relaxed)) continue;
+        const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.used.store(false, std::memory_order_relaxed);
+        slot.frames.store(0, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+    overflow_.store(0, std::memory_order_relaxed);
+}
+
+void StreamDiscovery::observe(const uint8_t* frame, size_t frameSize, const RedundancyTag& tag, uint64_t nowNs) {
+    if (clearRequested_.load(std::memory_order_relaxed) &&
+        clearRequested_.exchange(false, std::memory_order_acq_rel)) {
+        applyClear();
+    }
+
+    // EtherType (2), APPID (2), Length (2), Reserved (4), then the PDU
+    const size_t off = tag.etherTypeOffset;
+    if (frameSize < off + 10) return;
+
+    const uint16_t etherType = loadBE16(frame + off);
+    bool goose;
+    if (etherType == 0x88BA) {
+        goose = false;
+    } else if (etherType == 0x88B8) {
+        goose = true;
+    } else {
+        return;
+    }
+
+    uint64_t vlan = 0;
+    if (loadBE16(frame + 12) == 0x8100) {
+        vlan = VlanTagged | (loadBE16(frame + 14) & 0x0FFF);
+    }
+    const uint64_t keyHi = (loadMac48(frame + 6) << 16) | loadBE16(frame + off + 2);
+    const uint64_t keyLo = (loadMac48(frame) << 16) | (goose ? TypeGoose : 0) | vlan;
+
+    const size_t hash = slotHash(keyHi, keyLo);
+    for (size_t probe = 0; probe < Capacity; ++probe) {
+        Slot& slot = slots_[(hash + probe) & (Capacity - 1)];
+
+        if (!slot.used.load(std::memory_order_relaxed)) {
+            Payload payload;
+            if (goose) {
+                decodeGOOSE(frame + off + 10, frameSize - off - 10, payload);
+            } else {
+                decodeSV(frame + off + 10, frameSize - off - 10, payload);
+            }
+
+            const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+            slot.seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.keyHi.store(keyHi, std::memory_order_relaxed);
+            slot.keyLo.store(keyLo, std::memory_order_relaxed);
+            writePayload(slot, payload);
+            slot.frames.store(1, std::memory_order_relaxed);
+            slot.firstSeenNs.store(nowNs, std::memory_order_relaxed);
+            slot.lastSeenNs.store(nowNs, std::memory_order_relaxed);
+            slot.used.store(true, std::memory_order_relaxed);
+            slot.seq.store(seq + 2, std::memory_order_release);
+            return;
+        }
+
+        if (slot.keyHi.load(std::memory_order_relaxed) != keyHi ||
+            slot.keyLo.load(std::memory_order_relaxed) != keyLo) {
+            continue;
+        }
+
+        // Known stream: header peek only, payload re-read periodically
+        const uint64_t frames = slot.frames.load(std::memory_order_relaxed) + 1;
+        slot.frames.store(frames, std::memory_order_relaxed);
+        slot.lastSeenNs.store(nowNs, std::memory_order_relaxed);
+
+        if (frames % Sniffer_DiscoveryRefreshFrames == 0) {
+            Payload payload;
+            bool ok = goose ? decodeGOOSE(frame + off + 10, frameSize - off - 10, payload)
+                            : decodeSV(frame + off + 10, frameSize - off - 10, payload);
+            if (ok) {
+                const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+                slot.seq.store(seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                writePayload(slot, payload);
+                slot.seq.store(seq + 2, std::memory_order_release);
+            }
+        }
+        return;
+    }
+
+    overflow_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<DiscoveredStream> StreamDiscovery::snapshot() const {
+    std::vector<DiscoveredStream> streams;
+    if (clearRequested_.load(std::memory_order_acquire)) {
+        return streams;
+    }
+
+    for (const auto& slot : slots_) {
+        // Retry a few times if the writer is rewriting this slot
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            const uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq & 1u) continue;
+            if (!slot.used.load(std::memory_order_relaxed)) break;
+
+            DiscoveredStream stream;
+            const uint64_t keyHi = slot.keyHi.load(std::memory_order_relaxed);
+            const uint64_t keyLo = slot.keyLo.load(std::memory_order_relaxed);
+            const size_t idLength = std::min<size_t>(slot.idLength.load(std::memory_order_relaxed), MaxIdLength);
+            char id[MaxIdLength];
+            for (size_t w = 0; w < IdWords; ++w) {
+                const uint64_t word = slot.id[w].load(std::memory_order_relaxed);
+                std::memcpy(id + w * 8, &word, 8);
+            }
+            stream.confRev = slot.confRev.load(std::memory_order_relaxed);
+            stream.channels = slot.channels.load(std::memory_order_relaxed);
+            stream.noAsdu = slot.noAsdu.load(std::memory_order_relaxed);
+            const uint64_t firstSeen = slot.firstSeenNs.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) continue;
+
+            stream.type = (keyLo & TypeGoose) ? DiscoveredStream::Type::GOOSE : DiscoveredStream::Type::SV;
+            storeMac48(keyHi >> 16, stream.srcMac);
+            storeMac48(keyLo >> 16, stream.dstMac);
+            stream.appId = static_cast<uint16_t>(keyHi & 0xFFFF);
+            stream.vlanId = (keyLo & VlanTagged) ? static_cast<int32_t>(keyLo & 0x0FFF) : -1;
+            stream.id.assign(id, idLength);
+
+            // Counters are updated outside the sequence lock
+            stream.frames = slot.frames.load(std::memory_order_relaxed);
+            stream.lastSeenNs = slot.lastSeenNs.load(std::memory_order_relaxed);
+            if (stream.frames > 1 && stream.lastSeenNs > firstSeen) {
+                stream.frameRate = static_cast<double>(stream.frames - 1) * 1e9 /
+                                   static_cast<double>(stream.lastSeenNs - firstSeen);
+            }
+            streams.push_back(std::move(stream));
+            break;
+        }
+    }
+    return streams;
+}
+
+} // namespace sniffer
+} // namespace vts
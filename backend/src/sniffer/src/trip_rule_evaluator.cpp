@@ -168,6 +168,10 @@ void TripRuleEvaluator::updateDataPoint(const std::string& path, double value) {
 }
 
 TripRuleResult TripRuleEvaluator::evaluate() {
+    return evaluate(dataPoints_);
+}
+
+TripRuleResult TripRuleEvaluator::evaluate(const std::map<std::string, GooseDataPoint>& dataPoints) const {
     TripRuleResult result;
     
     auto now = std::chrono::system_clock::now();
@@ -185,7 +189,7 @@ TripRuleResult TripRuleEvaluator::evaluate() {
         }
         
         try {
-            if (rule.ast->evaluate(dataPoints_)) {
+            if (rule.ast->evaluate(dataPoints)) {
                 result.triggered = true;
                 result.ruleName = rule.name;
                 result.message = "Trip rule triggered: " + rule.expression;
@@ -242,7 +246,8 @@ std::string TripRuleEvaluator::parseIdentifier(const std::string& expr, size_t&
     std::string id;
     while (pos < expr.length()) {
         char c = expr[pos];
-        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '/' || c == '.') {
+        // '$' for MMS-style control block references such as "IED/LLN0$GO$Trip"
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '/' || c == '.' || c == '$') {
             id += c;
             pos++;
         } else {
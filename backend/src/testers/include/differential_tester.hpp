@@ -1,8 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
+
+#include "clock.hpp"
 
 namespace vts {
 namespace testers {
@@ -85,6 +89,12 @@ public:
      */
     void setTripFlagGetter(std::function<bool()> getter);
     
+    /**
+     * @brief Set the time source for hold, step and trip timing
+     * @param clock Time source, nullptr for wall-clock time; run() attaches to it
+     */
+    void setClock(std::shared_ptr<Clock> clock);
+    
     /**
      * @brief Set the current setter function for side 1
      */
@@ -105,9 +115,10 @@ public:
     static void calculateSideCurrents(double Ir, double Id, double& Is1, double& Is2);
 
 private:
-    bool running_;
-    bool stopRequested_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stopRequested_;        // Set by stop() from another thread
     
+    std::shared_ptr<Clock> clock_;
     std::function<bool()> tripFlagGetter_;
     std::function<void(double)> side1CurrentSetter_;
     std::function<void(double)> side2CurrentSetter_;
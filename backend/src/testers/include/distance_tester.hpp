@@ -2,8 +2,12 @@
 
 #include "impedance_calculator.hpp"
 #include <vector>
+#include <atomic>
 #include <string>
 #include <functional>
+#include <memory>
+
+#include "clock.hpp"
 
 namespace vts {
 namespace testers {
@@ -90,6 +94,12 @@ public:
      */
     void setTripFlagGetter(std::function<bool()> getter);
     
+    /**
+     * @brief Set the time source for hold, step and trip timing
+     * @param clock Time source, nullptr for wall-clock time; run() attaches to it
+     */
+    void setClock(std::shared_ptr<Clock> clock);
+    
     /**
      * @brief Set the phasor setter function
      * @param setter Function to set three-phase phasors
@@ -98,11 +108,12 @@ public:
 
 private:
     // Internal state
-    bool running_;
-    bool stopRequested_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stopRequested_;        // Set by stop() from another thread
     ImpedanceCalculator impedanceCalc_;
     
     // Callback functions
+    std::shared_ptr<Clock> clock_;
     std::function<bool()> tripFlagGetter_;
     std::function<void(const PhasorState&)> phasorSetter_;
     
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "impedance_calculator.hpp"
+#include "phase_oscillator.hpp"
+#include "sv_publisher_instance.hpp"
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace vts {
+namespace testers {
+
+/**
+ * @brief Current transformer saturation model (secondary quantities)
+ *
+ * Flux in the core is the integral of the burden voltage; above the knee
+ * flux the magnetizing inductance collapses and the secondary current
+ * departs from the primary current.
+ */
+struct CtSaturationModel {
+    bool enabled = false;
+    double ratio = 240.0;          // Primary / secondary turns (1200:5)
+    double burdenOhm = 2.0;        // Total secondary loop resistance (Ω)
+    double kneeVoltage = 400.0;    // Secondary RMS voltage at the knee (V)
+    double kneeCurrent = 0.05;     // Excitation current at the knee (A)
+    double saturatedSlope = 1e-3;  // Saturated / unsaturated inductance
+    double remanence = 0.0;        // Initial flux, per unit of knee flux (-1..1)
+};
+
+/**
+ * @brief Capacitor voltage transformer subsidence transient
+ *
+ * Simplified: after inception the output carries the instantaneous
+ * pre/post voltage difference, decaying as a damped oscillation, on top
+ * of the post-fault voltage.
+ */
+struct CvtTransientModel {
+    bool enabled = false;
+    double amplitude = 1.0;        // Fraction of the voltage step that rings
+    double decayMs = 15.0;         // Envelope time constant
+    double ringHz = 20.0;          // Oscillation frequency (0 = pure decay)
+};
+
+/**
+ * @brief Fault transient definition
+ */
+struct FaultTransientConfig {
+    FaultType faultType = FaultType::AG;
+    FaultImpedance faultZ{0.0, 0.0};
+    SourceImpedance source{1.0, 10.0, 3.0, 30.0, 66395.0};
+    double frequency = 60.0;       // Hz
+    double sampleRate = 4800.0;    // Samples/s
+    double prefaultDuration = 0.1; // Seconds before inception
+    double faultDuration = 0.0;    // Seconds after inception, 0 = until detached
+    double inceptionAngle = 0.0;   // Phase A voltage angle at inception (deg)
+    double xOverR = 0.0;           // DC decay X/R, 0 = from the fault loop
+    std::complex<double> loadCurrent{0.0, 0.0};  // Pre-fault phase A current (A)
+    double ctRatio = 0.0;          // next() divides currents by this (secondary units); required
+    double vtRatio = 0.0;          // next() divides voltages by this; required
+    CtSaturationModel ct;
+    CvtTransientModel cvt;
+};
+
+/**
+ * @brief Time-domain fault waveform from ImpedanceCalculator phasors
+ *
+ * Produces pre-fault and fault voltages/currents per sample. Currents are
+ * continuous at inception; the difference between the pre-fault and fault
+ * steady states at that instant decays with the loop's X/R time constant
+ * (DC offset, largest for inception at a voltage zero). CT saturation and
+ * CVT transients are optional.
+ *
+ * Samples are built a block at a time: the steady-state sinusoids come from
+ * one PhaseOscillator, and the exponential and damped-oscillation envelopes
+ * are a per-block exp() times a precomputed power table, so the inner loops
+ * are plain multiply-adds over contiguous arrays. Only the CT flux recursion
+ * is sequential.
+ *
+ * Channel order is 9-2LE: Ia, Ib, Ic, In, Va, Vb, Vc, Vn (neutral = residual).
+ * generate() and render() give instantaneous amperes/volts in primary
+ * units; next() gives them in secondary units through the CT/VT ratios.
+ */
+class FaultTransientGenerator : public SampleSource {
+public:
+    static constexpr size_t Channels = 8;
+
+    /**
+     * @throws std::invalid_argument on a non-positive rate, frequency,
+     *         duration, a CT/VT ratio left unset, or a CT model without a knee
+     */
+    explicit FaultTransientGenerator(const FaultTransientConfig& config);
+
+    /**
+     * @brief Back to the first sample (CT flux back to remanence)
+     */
+    void reset();
+
+    /**
+     * @brief Write up to `samples` interleaved frames (Channels values each)
+     * @return Frames written; fewer once faultDuration is reached
+     */
+    size_t generate(double* out, size_t samples);
+
+    /**
+     * @brief Whole waveform (needs faultDuration > 0), interleaved
+     */
+    std::vector<double> render();
+
+    // SampleSource: values divided by ctRatio/vtRatio, extra channels are
+    // zeroed, missing ones dropped
+    bool next(double* out, size_t channels) override;
+
+    const PhasorState& prefaultState() const { return prefault_; }
+    const PhasorState& faultState() const { return fault_; }
+    double timeConstant() const { return tau_; }
+    uint64_t inceptionSample() const { return inception_; }
+    uint64_t totalSamples() const { return total_; }    // 0 = unbounded
+    uint64_t position() const { return position_; }
+
+private:
+    void generateBlock(double* out, size_t count);
+    static std::complex<double> loopImpedance(const FaultTransientConfig& config);
+
+    FaultTransientConfig config_;
+    PhasorState prefault_;
+    PhasorState fault_;
+    double dt_;
+    double tau_;
+    uint64_t inception_;
+    uint64_t total_;
+    uint64_t position_;
+
+    PhaseOscillator reference_;                 // Phase A pre-fault voltage angle
+    std::array<std::complex<double>, 6> preCoef_;   // Ia..Ic, Va..Vc as (sin, cos) weights
+    std::array<std::complex<double>, 6> faultCoef_;
+    std::array<double, 6> step_;                // Pre minus fault value at inception
+
+    std::vector<double> dcPow_;                 // exp(-k dt / tau)
+    std::vector<std::complex<double>> cvtPow_;  // Damped rotor powers
+    std::array<double, 3> flux_;                // CT core flux per phase (V s)
+    double kneeFlux_;
+    double lm_;
+    double lsat_;
+
+    std::vector<double> sin_, cos_;             // Block scratch
+    std::vector<double> planar_;                // Block, one row per channel
+    std::vector<double> block_;                 // Buffer behind next()
+    std::array<double, Channels> secondary_;    // Primary to next() units per channel
+    size_t blockPos_;
+    size_t blockLen_;
+};
+
+} // namespace testers
+} // namespace vts
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <functional>
+#include <memory>
+
+#include "clock.hpp"
 #include <chrono>
 
 namespace vts {
@@ -95,6 +99,12 @@ public:
      */
     void setTripFlagGetter(std::function<bool()> getter);
     
+    /**
+     * @brief Set the time source for hold, step and trip timing
+     * @param clock Time source, nullptr for wall-clock time; run() attaches to it
+     */
+    void setClock(std::shared_ptr<Clock> clock);
+    
     /**
      * @brief Set the value setter function
      * @param setter Function to set the ramp variable value
@@ -117,10 +127,11 @@ public:
 
 private:
     // Internal state
-    bool running_;
-    bool stopRequested_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stopRequested_;        // Set by stop() from another thread
     
     // Callback functions
+    std::shared_ptr<Clock> clock_;
     std::function<bool()> tripFlagGetter_;
     std::function<void(RampVariable, double)> valueSetter_;
     
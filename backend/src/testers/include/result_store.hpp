@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "general_definition.hpp"
+
+namespace vts {
+namespace testers {
+
+struct RampResult;
+struct DistanceResult;
+struct OCResult;
+struct DifferentialResult;
+
+/**
+ * @brief Test that produced a stored result
+ */
+enum class ResultKind : uint8_t {
+    RAMP,
+    DISTANCE,
+    OVERCURRENT,
+    DIFFERENTIAL,
+    TRANSIENT       // COMTRADE/CSV transient replay
+};
+
+constexpr size_t ResultKindCount = 5;
+
+/**
+ * @brief One stored result: a test point, a ramp or a transient replay
+ *
+ * x and y hold the test point: R/X (distance), Ir/Id (differential),
+ * current multiple/actual current (overcurrent), pickup/dropoff value
+ * (ramp); unused for transients.
+ */
+struct ResultRecord {
+    uint64_t seq = 0;                   // Position in the store, set by append
+    int64_t timeNs = 0;                 // Unix time (ns); 0 = set by append
+    uint64_t jobId = 0;                 // Test job, 0 if not run as one
+    std::string relay;                  // Relay under test, "" if not named
+    ResultKind kind = ResultKind::RAMP;
+    bool passed = false;
+    bool tripped = false;
+    double tripTime = 0.0;              // Measured trip (ramp: pickup) time (s)
+    double expectedTime = 0.0;          // 0 if none was given
+    double x = 0.0;
+    double y = 0.0;
+
+    nlohmann::json toJson() const;
+};
+
+/**
+ * @brief Selects stored results; every field left at its default matches all
+ */
+struct ResultQuery {
+    std::string relay;
+    int kind = -1;                      // ResultKind, -1 = any
+    int passed = -1;                    // 0/1, -1 = either
+    int64_t fromNs = std::numeric_limits<int64_t>::min();     // Inclusive
+    int64_t toNs = std::numeric_limits<int64_t>::max();       // Exclusive
+    size_t limit = ResultStore_DefaultLimit;                  // query() only
+};
+
+/**
+ * @brief Trip-time distribution of one relay and test kind
+ */
+struct ResultAggregate {
+    std::string relay;
+    ResultKind kind = ResultKind::RAMP;
+    uint64_t runs = 0;
+    uint64_t passed = 0;
+    uint64_t tripped = 0;
+
+    // Over tripped runs only
+    double minTripTime = 0.0;
+    double maxTripTime = 0.0;
+    double meanTripTime = 0.0;
+    double stddevTripTime = 0.0;
+    double p50TripTime = 0.0;
+    double p90TripTime = 0.0;
+    double p99TripTime = 0.0;
+    double binWidth = 0.0;              // Histogram bin (s); bin 0 starts at minTripTime
+    std::vector<uint64_t> histogram;
+
+    nlohmann::json toJson() const;
+};
+
+/**
+ * @brief Store counters
+ */
+struct ResultStoreStatus {
+    std::string path;                   // "" when held in memory only
+    uint64_t records = 0;
+    uint64_t relays = 0;
+    uint64_t pending = 0;               // Appended, not yet on disk
+    uint64_t blocksWritten = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t writeErrors = 0;
+    uint64_t recoveredBytes = 0;        // Torn tail cut off at open
+    std::string lastError;
+
+    nlohmann::json toJson() const;
+};
+
+/**
+ * @brief Append-only store of relay test results with indexed queries
+ *
+ * Results are held as columns (time, job, relay, kind, flags, trip time,
+ * expected time, test point) in append order, which is time order: append
+ * stamps records that carry no time and never lets time go backwards. Each
+ * (relay, kind, passed) combination keeps the rows it matches, so a query
+ * only visits the lists it selects and finds its time range in each by
+ * binary search; nothing else is scanned.
+ *
+ * append() only updates the columns and indexes under the lock. A writer
+ * thread appends new rows to results.vtr in the store directory as blocks
+ * of columns (relay names first used in the block, then each column for
+ * every row) behind a header with the row count and a CRC-32, in host
+ * byte order. Opening the store reads every block back; a torn or corrupt
+ * tail from a crash is cut off.
+ */
+class ResultStore {
+public:
+    /**
+     * @param directory Created if missing; "" keeps results in memory only.
+     *        A directory or file that cannot be used is reported in status()
+     *        and the store carries on in memory.
+     */
+    explicit ResultStore(const std::string& directory);
+    ~ResultStore();
+
+    ResultStore(const ResultStore&) = delete;
+    ResultStore& operator=(const ResultStore&) = delete;
+
+    /**
+     * @brief Add results; returns at once, the writer saves them
+     */
+    void append(std::vector<ResultRecord> records);
+
+    // Tester results, one record per ramp or test point
+    void append(const std::string& relay, uint64_t jobId, const RampResult& result);
+    void append(const std::string& relay, uint64_t jobId, const std::vector<DistanceResult>& results);
+    void append(const std::string& relay, uint64_t jobId, const std::vector<OCResult>& results);
+    void append(const std::string& relay, uint64_t jobId, const std::vector<DifferentialResult>& results);
+
+    /**
+     * @brief Matching records, newest first, at most query.limit
+     * @param total Set to the number matching without the limit
+     */
+    std::vector<ResultRecord> query(const ResultQuery& query, uint64_t& total) const;
+
+    /**
+     * @brief Trip-time distributions of the matching records per relay and kind
+     * @param binWidth Histogram bin (s); widened so at most
+     *        ResultStore_MaxHistogramBins bins are returned
+     */
+    std::vector<ResultAggregate> aggregate(const ResultQuery& query, double binWidth) const;
+
+    /**
+     * @brief Block until everything appended so far is on disk (or failed)
+     */
+    void flush();
+
+    ResultStoreStatus status() const;
+
+    static std::string kindToString(ResultKind kind);
+
+    /**
+     * @return false if the name is not a kind
+     */
+    static bool parseKind(const std::string& name, ResultKind& kind);
+
+private:
+    // Rows of one relay per (kind, passed), in row order
+    using Postings = std::array<std::vector<uint32_t>, ResultKindCount * 2>;
+
+    void load();
+    void addRow(const ResultRecord& record, uint32_t relay);
+    uint32_t relayId(const std::string& name);
+    void selectLists(const ResultQuery& query, std::vector<const std::vector<uint32_t>*>& lists,
+                     std::vector<std::pair<size_t, size_t>>& ranges) const;
+    void collectGroups(const ResultQuery& query, std::vector<ResultAggregate>& groups,
+                       std::vector<std::vector<double>>& times) const;
+    ResultRecord row(uint32_t index) const;
+    void writerThread();
+
+    mutable std::mutex mutex_;
+
+    // Columns, one entry per row
+    std::vector<int64_t> time_;
+    std::vector<uint64_t> job_;
+    std::vector<uint32_t> relay_;
+    std::vector<uint8_t> kind_;
+    std::vector<uint8_t> flags_;
+    std::vector<double> tripTime_;
+    std::vector<double> expectedTime_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+
+    // Indexes
+    std::vector<std::string> relayNames_;
+    std::unordered_map<std::string, uint32_t> relayIds_;
+    std::vector<Postings> postings_;    // By relay ID
+
+    // Writer: rows and relay names below these are on disk
+    std::string path_;
+    std::FILE* file_;
+    size_t writtenRows_;
+    size_t writtenRelays_;
+    bool writing_;
+    bool stopping_;
+    std::condition_variable pendingChanged_;
+    std::condition_variable flushed_;
+    std::thread writer_;
+
+    uint64_t blocksWritten_;
+    uint64_t bytesWritten_;
+    uint64_t writeErrors_;
+    uint64_t recoveredBytes_;
+    std::string lastError_;
+};
+
+} // namespace testers
+} // namespace vts
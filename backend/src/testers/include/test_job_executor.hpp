@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "general_definition.hpp"
+
+namespace vts {
+namespace testers {
+
+/**
+ * @brief Test job lifecycle
+ */
+enum class TestJobState {
+    QUEUED,
+    RUNNING,
+    COMPLETED,      // Ran to the end; the result says whether the relay passed
+    FAILED,         // Threw; error holds the reason
+    CANCELLED       // Cancelled while queued or running
+};
+
+/**
+ * @brief Snapshot of one job
+ */
+struct TestJobInfo {
+    uint64_t id = 0;
+    std::string kind;                   // "ramp", "distance", ...
+    TestJobState state = TestJobState::QUEUED;
+    double progress = 0.0;              // 0..1
+    std::string message;                // Latest progress note
+    std::string error;
+    nlohmann::json result;              // Set on COMPLETED (partial results on CANCELLED)
+    double submittedAt = 0.0;           // Unix time (s)
+    double startedAt = 0.0;             // 0 until it runs
+    double finishedAt = 0.0;            // 0 until it ends
+
+    bool finished() const {
+        return state == TestJobState::COMPLETED || state == TestJobState::FAILED ||
+               state == TestJobState::CANCELLED;
+    }
+
+    nlohmann::json toJson(bool includeResult = true) const;
+};
+
+class TestJobExecutor;
+
+/**
+ * @brief Handed to a running job for progress reports and cancellation
+ */
+class TestJobContext {
+public:
+    uint64_t id() const { return id_; }
+
+    /**
+     * @brief Report progress (fraction clamped to 0..1); listeners are told
+     */
+    void progress(double fraction, const std::string& message = "");
+
+    bool cancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+private:
+    friend class TestJobExecutor;
+    TestJobContext(TestJobExecutor& executor, uint64_t id) : executor_(executor), id_(id) {}
+
+    TestJobExecutor& executor_;
+    uint64_t id_;
+    std::atomic<bool> cancelled_{false};
+};
+
+/**
+ * @brief Job body: returns the result, throws to fail the job
+ */
+using TestJobFunction = std::function<nlohmann::json(TestJobContext&)>;
+
+/**
+ * @brief Called on every state change and progress report, from the
+ *        executor thread (or the submitting/cancelling thread for jobs that
+ *        never ran); must not call back into the executor
+ */
+using TestJobListener = std::function<void(const TestJobInfo&)>;
+
+/**
+ * @brief Runs relay test jobs one at a time on a dedicated thread
+ *
+ * The testers share the trip flag and the SV streams they drive, so jobs
+ * are serialized in submission order rather than run concurrently. submit()
+ * returns at once with the job ID; state, progress and the result are read
+ * back by ID, and the listener (the WebSocket broadcast) sees every change.
+ * Up to TestJobs_MaxQueued jobs wait; the newest TestJobs_MaxRetained
+ * finished jobs are kept.
+ */
+class TestJobExecutor {
+public:
+    TestJobExecutor();
+    ~TestJobExecutor();
+
+    TestJobExecutor(const TestJobExecutor&) = delete;
+    TestJobExecutor& operator=(const TestJobExecutor&) = delete;
+
+    void setListener(TestJobListener listener);
+
+    /**
+     * @brief Queue a job
+     * @param cancel Called to interrupt the job while it runs, e.g. the
+     *        tester's stop(); it runs under the executor's lock, so it must
+     *        only flag the job to stop
+     * @return The job ID, or 0 with the reason in error when the queue is full
+     */
+    uint64_t submit(const std::string& kind, TestJobFunction job, std::string& error,
+                    std::function<void()> cancel = nullptr);
+
+    /**
+     * @brief Cancel a queued or running job
+     * @return false if there is no such job or it has already finished
+     */
+    bool cancel(uint64_t id);
+
+    /**
+     * @brief Block until the job has finished
+     * @return false if there is no such job
+     */
+    bool wait(uint64_t id, TestJobInfo& info);
+
+    bool get(uint64_t id, TestJobInfo& info) const;
+    std::vector<TestJobInfo> list() const;
+    size_t queued() const;
+
+    /**
+     * @brief Cancel everything and join the thread (also done on destruction)
+     */
+    void shutdown();
+
+    static std::string stateToString(TestJobState state);
+
+private:
+    friend class TestJobContext;
+
+    struct Job {
+        TestJobInfo info;
+        TestJobFunction function;
+        std::function<void()> cancel;
+        std::unique_ptr<TestJobContext> context;
+    };
+
+    void run();
+    void execute(Job& job);
+    void reportProgress(uint64_t id, double fraction, const std::string& message);
+    void finish(Job& job, TestJobState state);
+    void notify(const TestJobInfo& info);
+    void retire();
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<uint64_t, std::shared_ptr<Job>> jobs_;
+    std::deque<uint64_t> queue_;
+    std::deque<uint64_t> finished_;         // Oldest first, for retirement
+    uint64_t nextId_;
+    bool stopping_;
+
+    std::mutex listenerMutex_;
+    TestJobListener listener_;
+
+    std::thread thread_;
+};
+
+} // namespace testers
+} // namespace vts
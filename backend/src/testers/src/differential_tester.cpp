@@ -7,7 +7,7 @@ namespace vts {
 namespace testers {
 
 DifferentialTester::DifferentialTester()
-    : running_(false), stopRequested_(false) {
+    : running_(false), stopRequested_(false), clock_(systemClock()) {
 }
 
 DifferentialTester::~DifferentialTester() {
@@ -18,6 +18,10 @@ void DifferentialTester::setTripFlagGetter(std::function<bool()> getter) {
     tripFlagGetter_ = getter;
 }
 
+void DifferentialTester::setClock(std::shared_ptr<Clock> clock) {
+    clock_ = clock ? std::move(clock) : systemClock();
+}
+
 void DifferentialTester::setSide1CurrentSetter(std::function<void(double)> setter) {
     side1CurrentSetter_ = setter;
 }
@@ -49,27 +53,27 @@ void DifferentialTester::calculateSideCurrents(double Ir, double Id, double& Is1
 
 bool DifferentialTester::waitWithStopCheck(double duration) {
     auto durationMs = std::chrono::milliseconds(static_cast<long long>(duration * 1000.0));
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock_->now();
     auto end = start + durationMs;
     
-    while (std::chrono::steady_clock::now() < end) {
+    while (clock_->now() < end) {
         if (stopRequested_) {
             return false;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        clock_->sleepFor(std::chrono::milliseconds(10));
     }
     
     return true;
 }
 
 bool DifferentialTester::monitorTrip(double maxDuration, double& tripTime) {
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock_->now();
     auto maxDurationMs = std::chrono::milliseconds(static_cast<long long>(maxDuration * 1000.0));
     auto end = start + maxDurationMs;
     
     bool initialTripState = tripFlagGetter_();
     
-    while (std::chrono::steady_clock::now() < end) {
+    while (clock_->now() < end) {
         if (stopRequested_) {
             return false;
         }
@@ -78,12 +82,12 @@ bool DifferentialTester::monitorTrip(double maxDuration, double& tripTime) {
         
         // Detect trip (0 → 1 transition)
         if (!initialTripState && currentTripState) {
-            auto now = std::chrono::steady_clock::now();
+            auto now = clock_->now();
             tripTime = std::chrono::duration<double>(now - start).count();
             return true;
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        clock_->sleepFor(std::chrono::milliseconds(1));
     }
     
     return false;
@@ -181,6 +185,7 @@ std::vector<DifferentialResult> DifferentialTester::run(const DifferentialTestCo
     
     running_ = true;
     stopRequested_ = false;
+    ClockParticipant participant(*clock_);
     
     // Test each point
     for (size_t i = 0; i < config.points.size(); ++i) {
@@ -7,7 +7,7 @@ namespace vts {
 namespace testers {
 
 DistanceTester::DistanceTester()
-    : running_(false), stopRequested_(false) {
+    : running_(false), stopRequested_(false), clock_(systemClock()) {
 }
 
 DistanceTester::~DistanceTester() {
@@ -18,6 +18,10 @@ void DistanceTester::setTripFlagGetter(std::function<bool()> getter) {
     tripFlagGetter_ = getter;
 }
 
+void DistanceTester::setClock(std::shared_ptr<Clock> clock) {
+    clock_ = clock ? std::move(clock) : systemClock();
+}
+
 void DistanceTester::setPhasorSetter(std::function<void(const PhasorState&)> setter) {
     phasorSetter_ = setter;
 }
@@ -32,27 +36,27 @@ bool DistanceTester::isRunning() const {
 
 bool DistanceTester::waitWithStopCheck(double duration) {
     auto durationMs = std::chrono::milliseconds(static_cast<long long>(duration * 1000.0));
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock_->now();
     auto end = start + durationMs;
     
-    while (std::chrono::steady_clock::now() < end) {
+    while (clock_->now() < end) {
         if (stopRequested_) {
             return false;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        clock_->sleepFor(std::chrono::milliseconds(10));
     }
     
     return true;
 }
 
 bool DistanceTester::monitorTrip(double maxDuration, double& tripTime) {
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock_->now();
     auto maxDurationMs = std::chrono::milliseconds(static_cast<long long>(maxDuration * 1000.0));
     auto end = start + maxDurationMs;
     
     bool initialTripState = tripFlagGetter_();
     
-    while (std::chrono::steady_clock::now() < end) {
+    while (clock_->now() < end) {
         if (stopRequested_) {
             return false;
         }
@@ -61,12 +65,12 @@ bool DistanceTester::monitorTrip(double maxDuration, double& tripTime) {
         
         // Detect trip (0 → 1 transition)
         if (!initialTripState && currentTripState) {
-            auto now = std::chrono::steady_clock::now();
+            auto now = clock_->now();
             tripTime = std::chrono::duration<double>(now - start).count();
             return true;
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        clock_->sleepFor(std::chrono::milliseconds(1));
     }
     
     // Timeout
@@ -187,6 +191,7 @@ std::vector<DistanceResult> DistanceTester::run(const DistanceTestConfig& config
     
     running_ = true;
     stopRequested_ = false;
+    ClockParticipant participant(*clock_);
     
     // Test each point
     for (size_t i = 0; i < config.points.size(); ++i) {
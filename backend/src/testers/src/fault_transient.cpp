@@ -0,0 +1,272 @@
+#include "fault_transient.hpp"
+#include "general_definition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vts {
+namespace testers {
+
+namespace {
+
+constexpr double TwoPi = 2.0 * M_PI;
+const std::complex<double> Alpha(-0.5, 0.866025403784439);
+
+// (sin, cos) weights of sqrt(2) * |p| * sin(theta + arg p)
+std::complex<double> weights(std::complex<double> p) {
+    return std::sqrt(2.0) * p;
+}
+
+double valueAt(std::complex<double> w, double s, double c) {
+    return w.real() * s + w.imag() * c;
+}
+
+} // namespace
+
+FaultTransientGenerator::FaultTransientGenerator(const FaultTransientConfig& config)
+    : config_(config), dt_(0.0), tau_(0.0), inception_(0), total_(0), position_(0),
+      kneeFlux_(0.0), lm_(0.0), lsat_(0.0), blockPos_(0), blockLen_(0) {
+    if (!(config_.sampleRate > 0.0) || !(config_.frequency > 0.0)) {
+        throw std::invalid_argument("Fault transient: sampleRate and frequency must be > 0");
+    }
+    if (config_.prefaultDuration < 0.0 || config_.faultDuration < 0.0) {
+        throw std::invalid_argument("Fault transient: durations must be >= 0");
+    }
+    if (config_.ct.enabled && (!(config_.ct.ratio > 0.0) || !(config_.ct.burdenOhm > 0.0) ||
+                               !(config_.ct.kneeVoltage > 0.0) || !(config_.ct.kneeCurrent > 0.0) ||
+                               !(config_.ct.saturatedSlope > 0.0) || config_.ct.saturatedSlope > 1.0 ||
+                               std::fabs(config_.ct.remanence) > 1.0)) {
+        throw std::invalid_argument("Fault transient: invalid CT model");
+    }
+    if (config_.cvt.enabled && (!(config_.cvt.decayMs > 0.0) || config_.cvt.ringHz < 0.0)) {
+        throw std::invalid_argument("Fault transient: invalid CVT model");
+    }
+    if (!(config_.ctRatio > 0.0) || !(config_.vtRatio > 0.0)) {
+        throw std::invalid_argument("Fault transient: ctRatio and vtRatio must be set and > 0");
+    }
+    for (size_t c = 0; c < Channels; ++c) {
+        secondary_[c] = 1.0 / (c < 4 ? config_.ctRatio : config_.vtRatio);
+    }
+
+    const double omega = TwoPi * config_.frequency;
+    dt_ = 1.0 / config_.sampleRate;
+
+    ImpedanceCalculator calculator;
+    fault_ = calculator.calculateFault(config_.faultType, config_.faultZ, config_.source);
+
+    const std::complex<double> v(config_.source.Vprefault, 0.0);
+    prefault_.voltage = {v, v * Alpha * Alpha, v * Alpha};
+    prefault_.current = {config_.loadCurrent, config_.loadCurrent * Alpha * Alpha, config_.loadCurrent * Alpha};
+    prefault_.neutral = {0.0, 0.0, 0.0};
+
+    // DC offset time constant of the fault loop
+    if (config_.xOverR > 0.0) {
+        tau_ = config_.xOverR / omega;
+    } else {
+        const std::complex<double> z = loopImpedance(config_);
+        if (z.imag() > 0.0) {
+            tau_ = z.imag() / (omega * std::max(z.real(), 1e-6 * std::abs(z)));
+        }
+    }
+
+    inception_ = static_cast<uint64_t>(std::llround(config_.prefaultDuration * config_.sampleRate));
+    if (config_.faultDuration > 0.0) {
+        total_ = inception_ + static_cast<uint64_t>(std::llround(config_.faultDuration * config_.sampleRate));
+    }
+
+    const std::array<std::complex<double>, 6> pre = {
+        prefault_.current.A, prefault_.current.B, prefault_.current.C,
+        prefault_.voltage.A, prefault_.voltage.B, prefault_.voltage.C};
+    const std::array<std::complex<double>, 6> flt = {
+        fault_.current.A, fault_.current.B, fault_.current.C,
+        fault_.voltage.A, fault_.voltage.B, fault_.voltage.C};
+    const double inceptionRad = config_.inceptionAngle * M_PI / 180.0;
+    for (size_t i = 0; i < 6; ++i) {
+        preCoef_[i] = weights(pre[i]);
+        faultCoef_[i] = weights(flt[i]);
+        step_[i] = valueAt(preCoef_[i], std::sin(inceptionRad), std::cos(inceptionRad)) -
+                   valueAt(faultCoef_[i], std::sin(inceptionRad), std::cos(inceptionRad));
+    }
+
+    // Envelope power tables: block value = exp(at block start) * table[k]
+    dcPow_.resize(FaultTransient_BlockSamples);
+    cvtPow_.resize(FaultTransient_BlockSamples);
+    const std::complex<double> cvtRate(-1.0 / (config_.cvt.decayMs * 1e-3), TwoPi * config_.cvt.ringHz);
+    for (size_t k = 0; k < FaultTransient_BlockSamples; ++k) {
+        const double t = static_cast<double>(k) * dt_;
+        dcPow_[k] = tau_ > 0.0 ? std::exp(-t / tau_) : 0.0;
+        cvtPow_[k] = config_.cvt.enabled ? std::exp(cvtRate * t) : std::complex<double>(0.0, 0.0);
+    }
+
+    if (config_.ct.enabled) {
+        kneeFlux_ = std::sqrt(2.0) * config_.ct.kneeVoltage / omega;
+        lm_ = kneeFlux_ / config_.ct.kneeCurrent;
+        lsat_ = lm_ * config_.ct.saturatedSlope;
+    }
+
+    planar_.resize(FaultTransient_BlockSamples * Channels);
+    sin_.resize(FaultTransient_BlockSamples);
+    cos_.resize(FaultTransient_BlockSamples);
+    block_.resize(FaultTransient_BlockSamples * Channels);
+    reset();
+}
+
+std::complex<double> FaultTransientGenerator::loopImpedance(const FaultTransientConfig& config) {
+    const std::complex<double> z1(config.source.RS1, config.source.XS1);
+    const std::complex<double> z0(config.source.RS0, config.source.XS0);
+    const std::complex<double> zf(config.faultZ.R, config.faultZ.X);
+    switch (config.faultType) {
+        case FaultType::AG:
+        case FaultType::BG:
+        case FaultType::CG:
+            return 2.0 * z1 + z0 + 3.0 * zf;
+        case FaultType::AB:
+        case FaultType::BC:
+        case FaultType::CA:
+            return 2.0 * z1 + zf;
+        case FaultType::ABG:
+        case FaultType::BCG:
+        case FaultType::CAG: {
+            const std::complex<double> z0Branch = z0 + 3.0 * zf;
+            return z1 + (z1 * z0Branch) / (z1 + z0Branch);
+        }
+        case FaultType::ABC:
+        default:
+            return z1 + zf;
+    }
+}
+
+void FaultTransientGenerator::reset() {
+    const double omega = TwoPi * config_.frequency;
+    const double startPhase = config_.inceptionAngle * M_PI / 180.0 -
+                              omega * static_cast<double>(inception_) * dt_;
+    reference_ = PhaseOscillator(config_.sampleRate, config_.frequency, startPhase);
+    flux_.fill(config_.ct.remanence * kneeFlux_);
+    position_ = 0;
+    blockPos_ = 0;
+    blockLen_ = 0;
+}
+
+size_t FaultTransientGenerator::generate(double* out, size_t samples) {
+    size_t n = samples;
+    if (total_ > 0) {
+        n = static_cast<size_t>(std::min<uint64_t>(n, total_ - position_));
+    }
+    for (size_t done = 0; done < n; ) {
+        const size_t count = std::min(n - done, FaultTransient_BlockSamples);
+        generateBlock(out + done * Channels, count);
+        done += count;
+    }
+    return n;
+}
+
+void FaultTransientGenerator::generateBlock(double* out, size_t count) {
+    for (size_t k = 0; k < count; ++k) {
+        sin_[k] = reference_.sine();
+        cos_[k] = reference_.cosine();
+        reference_.advance();
+    }
+
+    // Samples before `split` are pre-fault
+    const size_t split = position_ >= inception_ ? 0
+        : static_cast<size_t>(std::min<uint64_t>(inception_ - position_, count));
+    const double sinceInception = position_ + split >= inception_
+        ? static_cast<double>(position_ + split - inception_) * dt_ : 0.0;
+    const double dc0 = tau_ > 0.0 ? std::exp(-sinceInception / tau_) : 0.0;
+    const std::complex<double> cvt0 = config_.cvt.enabled
+        ? std::exp(std::complex<double>(-1.0 / (config_.cvt.decayMs * 1e-3), TwoPi * config_.cvt.ringHz) * sinceInception)
+        : std::complex<double>(0.0, 0.0);
+
+    // Planar, one contiguous row per channel
+    static constexpr size_t Row[6] = {0, 1, 2, 4, 5, 6};
+    for (size_t i = 0; i < 6; ++i) {
+        double* const dst = planar_.data() + Row[i] * FaultTransient_BlockSamples;
+        const std::complex<double> pre = preCoef_[i];
+        const std::complex<double> flt = faultCoef_[i];
+        for (size_t k = 0; k < split; ++k) {
+            dst[k] = pre.real() * sin_[k] + pre.imag() * cos_[k];
+        }
+        if (i < 3) {
+            const double a = step_[i] * dc0;
+            const double* env = dcPow_.data();
+            for (size_t k = split; k < count; ++k) {
+                dst[k] = flt.real() * sin_[k] + flt.imag() * cos_[k] + a * env[k - split];
+            }
+        } else {
+            const std::complex<double> a = config_.cvt.amplitude * step_[i] * cvt0;
+            const std::complex<double>* env = cvtPow_.data();
+            for (size_t k = split; k < count; ++k) {
+                const std::complex<double> e = env[k - split];
+                dst[k] = flt.real() * sin_[k] + flt.imag() * cos_[k] + a.real() * e.real() - a.imag() * e.imag();
+            }
+        }
+    }
+
+    if (config_.ct.enabled) {
+        // Backward Euler on d(flux)/dt = Rb * (i1 - im(flux)), im piecewise linear
+        const double h = dt_ * config_.ct.burdenOhm;
+        const double ratio = config_.ct.ratio;
+        const double satOffset = kneeFlux_ * (1.0 / lsat_ - 1.0 / lm_);
+        for (size_t p = 0; p < 3; ++p) {
+            double* const row = planar_.data() + p * FaultTransient_BlockSamples;
+            double flux = flux_[p];
+            for (size_t k = 0; k < count; ++k) {
+                const double i1 = row[k] / ratio;
+                double next = (flux + h * i1) / (1.0 + h / lm_);
+                double im;
+                if (std::fabs(next) <= kneeFlux_) {
+                    im = next / lm_;
+                } else {
+                    const double sign = next > 0.0 ? 1.0 : -1.0;
+                    next = (flux + h * (i1 + sign * satOffset)) / (1.0 + h / lsat_);
+                    im = sign * kneeFlux_ / lm_ + (next - sign * kneeFlux_) / lsat_;
+                }
+                flux = next;
+                row[k] = (i1 - im) * ratio;
+            }
+            flux_[p] = flux;
+        }
+    }
+
+    for (size_t k = 0; k < count; ++k) {
+        double* frame = out + k * Channels;
+        for (size_t c = 0; c < 3; ++c) {
+            frame[c] = planar_[c * FaultTransient_BlockSamples + k];
+            frame[c + 4] = planar_[(c + 4) * FaultTransient_BlockSamples + k];
+        }
+        frame[3] = frame[0] + frame[1] + frame[2];
+        frame[7] = frame[4] + frame[5] + frame[6];
+    }
+
+    position_ += count;
+}
+
+std::vector<double> FaultTransientGenerator::render() {
+    if (total_ == 0) {
+        return {};
+    }
+    reset();
+    std::vector<double> out(static_cast<size_t>(total_) * Channels);
+    generate(out.data(), static_cast<size_t>(total_));
+    return out;
+}
+
+bool FaultTransientGenerator::next(double* out, size_t channels) {
+    if (blockPos_ == blockLen_) {
+        blockLen_ = generate(block_.data(), FaultTransient_BlockSamples);
+        blockPos_ = 0;
+        if (blockLen_ == 0) {
+            return false;
+        }
+    }
+    const double* frame = block_.data() + blockPos_ * Channels;
+    for (size_t c = 0; c < channels; ++c) {
+        out[c] = c < Channels ? frame[c] * secondary_[c] : 0.0;
+    }
+    blockPos_++;
+    return true;
+}
+
+} // namespace testers
+} // namespace vts
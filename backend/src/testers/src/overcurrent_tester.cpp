@@ -8,7 +8,7 @@ namespace vts {
 namespace testers {
 
 OvercurrentTester::OvercurrentTester()
-    : running_(false), stopRequested_(false) {
+    : running_(false), stopRequested_(false), clock_(systemClock()) {
 }
 
 OvercurrentTester::~OvercurrentTester() {
@@ -19,6 +19,10 @@ void OvercurrentTester::setTripFlagGetter(std::function<bool()> getter) {
     tripFlagGetter_ = getter;
 }
 
+void OvercurrentTester::setClock(std::shared_ptr<Clock> clock) {
+    clock_ = clock ? std::move(clock) : systemClock();
+}
+
 void OvercurrentTester::setCurrentSetter(std::function<void(double)> setter) {
     currentSetter_ = setter;
 }
@@ -128,27 +132,27 @@ double OvercurrentTester::calculateTripTime(const OCSettings& settings, double c
 
 bool OvercurrentTester::waitWithStopCheck(double duration) {
     auto durationMs = std::chrono::milliseconds(static_cast<long long>(duration * 1000.0));
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock_->now();
     auto end = start + durationMs;
     
-    while (std::chrono::steady_clock::now() < end) {
+    while (clock_->now() < end) {
         if (stopRequested_) {
             return false;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        clock_->sleepFor(std::chrono::milliseconds(10));
     }
     
     return true;
 }
 
 bool OvercurrentTester::monitorTrip(double maxDuration, double& tripTime) {
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock_->now();
     auto maxDurationMs = std::chrono::milliseconds(static_cast<long long>(maxDuration * 1000.0));
     auto end = start + maxDurationMs;
     
     bool initialTripState = tripFlagGetter_();
     
-    while (std::chrono::steady_clock::now() < end) {
+    while (clock_->now() < end) {
         if (stopRequested_) {
             return false;
         }
@@ -157,12 +161,12 @@ bool OvercurrentTester::monitorTrip(double maxDuration, double& tripTime) {
         
         // Detect trip (0 → 1 transition)
         if (!initialTripState && currentTripState) {
-            auto now = std::chrono::steady_clock::now();
+            auto now = clock_->now();
             tripTime = std::chrono::duration<double>(now - start).count();
             return true;
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        clock_->sleepFor(std::chrono::milliseconds(1));
     }
     
     return false;
@@ -254,6 +258,7 @@ std::vector<OCResult> OvercurrentTester::run(const OCTestConfig& config,
     
     running_ = true;
     stopRequested_ = false;
+    ClockParticipant participant(*clock_);
     
     // Test each point
     for (size_t i = 0; i < config.points.size(); ++i) {
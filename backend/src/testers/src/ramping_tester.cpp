@@ -7,7 +7,7 @@ namespace vts {
 namespace testers {
 
 RampingTester::RampingTester() 
-    : running_(false), stopRequested_(false) {
+    : running_(false), stopRequested_(false), clock_(systemClock()) {
 }
 
 RampingTester::~RampingTester() {
@@ -18,6 +18,10 @@ void RampingTester::setTripFlagGetter(std::function<bool()> getter) {
     tripFlagGetter_ = getter;
 }
 
+void RampingTester::setClock(std::shared_ptr<Clock> clock) {
+    clock_ = clock ? std::move(clock) : systemClock();
+}
+
 void RampingTester::setValueSetter(std::function<void(RampVariable, double)> setter) {
     valueSetter_ = setter;
 }
@@ -60,14 +64,14 @@ std::string RampingTester::variableToString(RampVariable var) {
 }
 
 bool RampingTester::waitWithStopCheck(std::chrono::milliseconds duration) {
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock_->now();
     auto end = start + duration;
     
-    while (std::chrono::steady_clock::now() < end) {
+    while (clock_->now() < end) {
         if (stopRequested_) {
             return false;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        clock_->sleepFor(std::chrono::milliseconds(10));
     }
     
     return true;
@@ -117,7 +121,7 @@ RampResult RampingTester::executeRamp(const RampConfig& config,
     }
     
     // Start timing
-    auto testStart = std::chrono::steady_clock::now();
+    auto testStart = clock_->now();
     
     // State tracking
     bool prevTripFlag = false;
@@ -159,7 +163,7 @@ RampResult RampingTester::executeRamp(const RampConfig& config,
             if (!prevTripFlag && currentTripFlag && !pickupDetected) {
                 pickupDetected = true;
                 result.pickupValue = currentValue;
-                auto now = std::chrono::steady_clock::now();
+                auto now = clock_->now();
                 result.pickupTime = std::chrono::duration<double>(now - testStart).count();
             }
             
@@ -167,7 +171,7 @@ RampResult RampingTester::executeRamp(const RampConfig& config,
             if (prevTripFlag && !currentTripFlag && !dropoffDetected) {
                 dropoffDetected = true;
                 result.dropoffValue = currentValue;
-                auto now = std::chrono::steady_clock::now();
+                auto now = clock_->now();
                 result.dropoffTime = std::chrono::duration<double>(now - testStart).count();
             }
             
@@ -194,7 +198,7 @@ RampResult RampingTester::executeRamp(const RampConfig& config,
     }
     
     // Calculate total duration
-    auto testEnd = std::chrono::steady_clock::now();
+    auto testEnd = clock_->now();
     result.totalDuration = std::chrono::duration<double>(testEnd - testStart).count();
     
     // Calculate reset ratio if both pickup and dropoff detected
@@ -217,6 +221,7 @@ RampResult RampingTester::run(const RampConfig& config,
     
     running_ = true;
     stopRequested_ = false;
+    ClockParticipant participant(*clock_);
     
     RampResult result = executeRamp(config, progressCallback);
     
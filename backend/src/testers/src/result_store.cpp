@@ -0,0 +1,734 @@
+#include "result_store.hpp"
+#include "ramping_tester.hpp"
+#include "distance_tester.hpp"
+#include "overcurrent_tester.hpp"
+#include "differential_tester.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+namespace vts {
+namespace testers {
+
+namespace {
+
+const char* const FileName = "results.vtr";
+const char FileMagic[8] = {'V', 'T', 'S', 'R', 'E', 'S', '0', '1'};
+constexpr uint32_t BlockMagic = 0x4b4c4252;     // "RBLK"
+constexpr size_t BlockHeaderSize = 5 * sizeof(uint32_t);
+
+// Row flags
+constexpr uint8_t FlagPassed = 0x01;
+constexpr uint8_t FlagTripped = 0x02;
+
+int64_t unixNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& out, const T& value) {
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+void putColumn(std::vector<uint8_t>& out, const std::vector<T>& column, size_t first, size_t count) {
+    const size_t at = out.size();
+    out.resize(at + count * sizeof(T));
+    std::memcpy(out.data() + at, column.data() + first, count * sizeof(T));
+}
+
+// Bounds-checked reads from a loaded block
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t length) : data_(data), length_(length), at_(0) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (length_ - at_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data_ + at_, sizeof(T));
+        at_ += sizeof(T);
+        return true;
+    }
+
+    bool getBytes(std::string& value, size_t length) {
+        if (length_ - at_ < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(data_ + at_), length);
+        at_ += length;
+        return true;
+    }
+
+    // Column of count values; nullptr if the block is too short
+    const uint8_t* column(size_t count, size_t size) {
+        if ((length_ - at_) / size < count) {
+            return nullptr;
+        }
+        const uint8_t* start = data_ + at_;
+        at_ += count * size;
+        return start;
+    }
+
+    bool done() const { return at_ == length_; }
+
+private:
+    const uint8_t* data_;
+    size_t length_;
+    size_t at_;
+};
+
+template <typename T>
+T read(const uint8_t* column, size_t index) {
+    T value;
+    std::memcpy(&value, column + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+// Nearest-rank percentile of sorted values
+double percentile(const std::vector<double>& sorted, double q) {
+    const size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+} // namespace
+
+nlohmann::json ResultRecord::toJson() const {
+    nlohmann::json j = {
+        {"seq", seq},
+        {"time", static_cast<double>(timeNs) * 1e-9},
+        {"jobId", jobId},
+        {"relay", relay},
+        {"kind", ResultStore::kindToString(kind)},
+        {"passed", passed},
+        {"tripped", tripped},
+        {"tripTime", tripTime},
+        {"expectedTime", expectedTime}
+    };
+    switch (kind) {
+        case ResultKind::RAMP:
+            j["pickupValue"] = x;
+            j["dropoffValue"] = y;
+            break;
+        case ResultKind::DISTANCE:
+            j["R"] = x;
+            j["X"] = y;
+            break;
+        case ResultKind::OVERCURRENT:
+            j["currentMultiple"] = x;
+            j["actualCurrent"] = y;
+            break;
+        case ResultKind::DIFFERENTIAL:
+            j["Ir"] = x;
+            j["Id"] = y;
+            break;
+        case ResultKind::TRANSIENT:
+            break;
+    }
+    return j;
+}
+
+nlohmann::json ResultAggregate::toJson() const {
+    nlohmann::json j = {
+        {"relay", relay},
+        {"kind", ResultStore::kindToString(kind)},
+        {"runs", runs},
+        {"passed", passed},
+        {"failed", runs - passed},
+        {"tripped", tripped},
+        {"tripTime", nullptr}
+    };
+    if (tripped > 0) {
+        j["tripTime"] = {
+            {"min", minTripTime},
+            {"max", maxTripTime},
+            {"mean", meanTripTime},
+            {"stddev", stddevTripTime},
+            {"p50", p50TripTime},
+            {"p90", p90TripTime},
+            {"p99", p99TripTime},
+            {"binWidth", binWidth},
+            {"histogram", histogram}
+        };
+    }
+    return j;
+}
+
+nlohmann::json ResultStoreStatus::toJson() const {
+    return {
+        {"path", path},
+        {"persistent", !path.empty()},
+        {"records", records},
+        {"relays", relays},
+        {"pending", pending},
+        {"blocksWritten", blocksWritten},
+        {"bytesWritten", bytesWritten},
+        {"writeErrors", writeErrors},
+        {"recoveredBytes", recoveredBytes},
+        {"lastError", lastError}
+    };
+}
+
+ResultStore::ResultStore(const std::string& directory)
+    : file_(nullptr), writtenRows_(0), writtenRelays_(0), writing_(false), stopping_(false),
+      blocksWritten_(0), bytesWritten_(0), writeErrors_(0), recoveredBytes_(0) {
+    if (directory.empty()) {
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    path_ = (std::filesystem::path(directory) / FileName).string();
+    load();
+    if (file_) {
+        writer_ = std::thread(&ResultStore::writerThread, this);
+    }
+}
+
+ResultStore::~ResultStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    pendingChanged_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();         // Drains what is pending first
+    }
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+// Replay every intact block, cut off a torn tail, reopen for appending
+void ResultStore::load() {
+    std::vector<uint8_t> data;
+    if (std::FILE* in = std::fopen(path_.c_str(), "rb")) {
+        uint8_t buffer[65536];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            data.insert(data.end(), buffer, buffer + n);
+        }
+        std::fclose(in);
+    }
+
+    size_t good = 0;
+    if (data.size() >= sizeof(FileMagic)) {
+        if (std::memcmp(data.data(), FileMagic, sizeof(FileMagic)) != 0) {
+            lastError_ = path_ + " is not a result store; results are kept in memory only";
+            LOG_ERROR("RESULTS", "%s", lastError_.c_str());
+            return;
+        }
+        good = sizeof(FileMagic);
+    }
+
+    while (good > 0 && data.size() - good >= BlockHeaderSize) {
+        Reader header(data.data() + good, BlockHeaderSize);
+        uint32_t magic = 0, rows = 0, names = 0, length = 0, crc = 0;
+        header.get(magic);
+        header.get(rows);
+        header.get(names);
+        header.get(length);
+        header.get(crc);
+        if (magic != BlockMagic || data.size() - good - BlockHeaderSize < length) {
+            break;
+        }
+        const uint8_t* payload = data.data() + good + BlockHeaderSize;
+        if (crc32(payload, length, crc32(data.data() + good, BlockHeaderSize - sizeof(uint32_t))) != crc) {
+            break;
+        }
+
+        Reader block(payload, length);
+        std::vector<std::string> added;
+        bool valid = true;
+        for (uint32_t i = 0; i < names && valid; ++i) {
+            uint32_t id = 0;
+            uint16_t size = 0;
+            std::string name;
+            valid = block.get(id) && block.get(size) && block.getBytes(name, size) &&
+                    id == relayNames_.size() + added.size();
+            added.push_back(name);
+        }
+        const uint8_t* time = block.column(rows, sizeof(int64_t));
+        const uint8_t* job = block.column(rows, sizeof(uint64_t));
+        const uint8_t* relay = block.column(rows, sizeof(uint32_t));
+        const uint8_t* kind = block.column(rows, sizeof(uint8_t));
+        const uint8_t* flags = block.column(rows, sizeof(uint8_t));
+        const uint8_t* tripTime = block.column(rows, sizeof(double));
+        const uint8_t* expectedTime = block.column(rows, sizeof(double));
+        const uint8_t* x = block.column(rows, sizeof(double));
+        const uint8_t* y = block.column(rows, sizeof(double));
+        if (!valid || !y || !block.done()) {
+            break;
+        }
+        const size_t relayCount = relayNames_.size() + added.size();
+        for (uint32_t r = 0; r < rows && valid; ++r) {
+            valid = read<uint32_t>(relay, r) < relayCount && kind[r] < ResultKindCount;
+        }
+        if (!valid) {
+            break;
+        }
+
+        for (const std::string& name : added) {
+            relayId(name);
+        }
+        for (uint32_t r = 0; r < rows; ++r) {
+            ResultRecord record;
+            record.timeNs = std::max(read<int64_t>(time, r), time_.empty() ? INT64_MIN : time_.back());
+            record.jobId = read<uint64_t>(job, r);
+            record.kind = static_cast<ResultKind>(kind[r]);
+            record.passed = (flags[r] & FlagPassed) != 0;
+            record.tripped = (flags[r] & FlagTripped) != 0;
+            record.tripTime = read<double>(tripTime, r);
+            record.expectedTime = read<double>(expectedTime, r);
+            record.x = read<double>(x, r);
+            record.y = read<double>(y, r);
+            addRow(record, read<uint32_t>(relay, r));
+        }
+        good += BlockHeaderSize + length;
+        blocksWritten_++;
+    }
+    writtenRows_ = time_.size();
+    writtenRelays_ = relayNames_.size();
+
+    // A crash mid-write leaves a partial block; appending after it would
+    // hide every later block from the next load
+    std::error_code ec;
+    if (good == 0) {
+        recoveredBytes_ = data.size();      // Torn file header; rewritten below
+    } else if (good < data.size()) {
+        recoveredBytes_ = data.size() - good;
+        std::filesystem::resize_file(path_, good, ec);
+        LOG_WARN("RESULTS", "Cut %llu bytes of torn or corrupt data from %s",
+                 static_cast<unsigned long long>(recoveredBytes_), path_.c_str());
+    }
+    if (ec) {
+        lastError_ = "Failed to truncate " + path_ + ": " + ec.message();
+    } else {
+        file_ = std::fopen(path_.c_str(), good > 0 ? "ab" : "wb");
+        if (file_ && good == 0 &&
+            (std::fwrite(FileMagic, 1, sizeof(FileMagic), file_) != sizeof(FileMagic) || std::fflush(file_) != 0)) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        if (!file_) {
+            lastError_ = "Failed to open " + path_ + ": " + std::strerror(errno);
+        }
+    }
+    if (!file_) {
+        LOG_ERROR("RESULTS", "%s; results are kept in memory only", lastError_.c_str());
+    }
+}
+
+void ResultStore::append(std::vector<ResultRecord> records) {
+    if (records.empty()) {
+        return;
+    }
+    const int64_t now = unixNowNs();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (ResultRecord& record : records) {
+            if (record.timeNs == 0) {
+                record.timeNs = now;
+            }
+            if (!time_.empty() && record.timeNs < time_.back()) {
+                record.timeNs = time_.back();   // Wall clock stepped back
+            }
+            addRow(record, relayId(record.relay));
+        }
+    }
+    pendingChanged_.notify_all();
+}
+
+void ResultStore::append(const std::string& relay, uint64_t jobId, const RampResult& result) {
+    ResultRecord record;
+    record.jobId = jobId;
+    record.relay = relay;
+    record.kind = ResultKind::RAMP;
+    record.passed = result.completed && result.error.empty();
+    record.tripped = result.pickupTime > 0.0;
+    record.tripTime = result.pickupTime;
+    record.x = result.pickupValue;
+    record.y = result.dropoffValue;
+    append(std::vector<ResultRecord>{record});
+}
+
+void ResultStore::append(const std::string& relay, uint64_t jobId, const std::vector<DistanceResult>& results) {
+    std::vector<ResultRecord> records;
+    for (const DistanceResult& result : results) {
+        ResultRecord record;
+        record.jobId = jobId;
+        record.relay = relay;
+        record.kind = ResultKind::DISTANCE;
+        record.passed = result.passed;
+        record.tripped = result.tripped;
+        record.tripTime = result.tripTime;
+        record.x = result.R;
+        record.y = result.X;
+        records.push_back(record);
+    }
+    append(std::move(records));
+}
+
+void ResultStore::append(const std::string& relay, uint64_t jobId, const std::vector<OCResult>& results) {
+    std::vector<ResultRecord> records;
+    for (const OCResult& result : results) {
+        ResultRecord record;
+        record.jobId = jobId;
+        record.relay = relay;
+        record.kind = ResultKind::OVERCURRENT;
+        record.passed = result.passed;
+        record.tripped = result.tripped;
+        record.tripTime = result.measuredTime;
+        record.expectedTime = result.expectedTime;
+        record.x = result.currentMultiple;
+        record.y = result.actualCurrent;
+        records.push_back(record);
+    }
+    append(std::move(records));
+}
+
+void ResultStore::append(const std::string& relay, uint64_t jobId, const std::vector<DifferentialResult>& results) {
+    std::vector<ResultRecord> records;
+    for (const DifferentialResult& result : results) {
+        ResultRecord record;
+        record.jobId = jobId;
+        record.relay = relay;
+        record.kind = ResultKind::DIFFERENTIAL;
+        record.passed = result.passed;
+        record.tripped = result.tripped;
+        record.tripTime = result.tripTime;
+        record.expectedTime = result.expectedTime;
+        record.x = result.Ir;
+        record.y = result.Id;
+        records.push_back(record);
+    }
+    append(std::move(records));
+}
+
+// Caller holds mutex_; time is already in order
+void ResultStore::addRow(const ResultRecord& record, uint32_t relay) {
+    const uint32_t index = static_cast<uint32_t>(time_.size());
+    time_.push_back(record.timeNs);
+    job_.push_back(record.jobId);
+    relay_.push_back(relay);
+    kind_.push_back(static_cast<uint8_t>(record.kind));
+    flags_.push_back(static_cast<uint8_t>((record.passed ? FlagPassed : 0) | (record.tripped ? FlagTripped : 0)));
+    tripTime_.push_back(record.tripTime);
+    expectedTime_.push_back(record.expectedTime);
+    x_.push_back(record.x);
+    y_.push_back(record.y);
+    postings_[relay][static_cast<size_t>(record.kind) * 2 + (record.passed ? 1 : 0)].push_back(index);
+}
+
+// Caller holds mutex_
+uint32_t ResultStore::relayId(const std::string& name) {
+    auto it = relayIds_.find(name);
+    if (it != relayIds_.end()) {
+        return it->second;
+    }
+    const uint32_t id = static_cast<uint32_t>(relayNames_.size());
+    relayNames_.push_back(name);
+    relayIds_.emplace(name, id);
+    postings_.emplace_back();
+    return id;
+}
+
+// Caller holds mutex_. The lists the query selects, with the part of each
+// inside its time range
+void ResultStore::selectLists(const ResultQuery& query, std::vector<const std::vector<uint32_t>*>& lists,
+                              std::vector<std::pair<size_t, size_t>>& ranges) const {
+    uint32_t firstRelay = 0;
+    uint32_t endRelay = static_cast<uint32_t>(relayNames_.size());
+    if (!query.relay.empty()) {
+        auto it = relayIds_.find(query.relay);
+        if (it == relayIds_.end()) {
+            return;
+        }
+        firstRelay = it->second;
+        endRelay = it->second + 1;
+    }
+    const size_t firstKind = query.kind >= 0 ? static_cast<size_t>(query.kind) : 0;
+    const size_t endKind = query.kind >= 0 ? firstKind + 1 : ResultKindCount;
+
+    auto before = [this](uint32_t row, int64_t t) { return time_[row] < t; };
+    for (uint32_t r = firstRelay; r < endRelay; ++r) {
+        for (size_t k = firstKind; k < endKind && k < ResultKindCount; ++k) {
+            for (int p = 0; p < 2; ++p) {
+                if (query.passed >= 0 && query.passed != p) {
+                    continue;
+                }
+                const std::vector<uint32_t>& list = postings_[r][k * 2 + static_cast<size_t>(p)];
+                const size_t lo = static_cast<size_t>(
+                    std::lower_bound(list.begin(), list.end(), query.fromNs, before) - list.begin());
+                const size_t hi = static_cast<size_t>(
+                    std::lower_bound(list.begin() + static_cast<std::ptrdiff_t>(lo), list.end(),
+                                     query.toNs, before) - list.begin());
+                if (lo < hi) {
+                    lists.push_back(&list);
+                    ranges.emplace_back(lo, hi);
+                }
+            }
+        }
+    }
+}
+
+// Caller holds mutex_
+ResultRecord ResultStore::row(uint32_t index) const {
+    ResultRecord record;
+    record.seq = index;
+    record.timeNs = time_[index];
+    record.jobId = job_[index];
+    record.relay = relayNames_[relay_[index]];
+    record.kind = static_cast<ResultKind>(kind_[index]);
+    record.passed = (flags_[index] & FlagPassed) != 0;
+    record.tripped = (flags_[index] & FlagTripped) != 0;
+    record.tripTime = tripTime_[index];
+    record.expectedTime = expectedTime_[index];
+    record.x = x_[index];
+    record.y = y_[index];
+    return record;
+}
+
+std::vector<ResultRecord> ResultStore::query(const ResultQuery& query, uint64_t& total) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const std::vector<uint32_t>*> lists;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    selectLists(query, lists, ranges);
+
+    total = 0;
+    for (const auto& range : ranges) {
+        total += range.second - range.first;
+    }
+
+    // Merge the lists from their newest end
+    std::vector<ResultRecord> records;
+    while (records.size() < query.limit) {
+        size_t newest = lists.size();
+        for (size_t i = 0; i < lists.size(); ++i) {
+            if (ranges[i].first < ranges[i].second &&
+                (newest == lists.size() ||
+                 (*lists[i])[ranges[i].second - 1] > (*lists[newest])[ranges[newest].second - 1])) {
+                newest = i;
+            }
+        }
+        if (newest == lists.size()) {
+            break;
+        }
+        records.push_back(row((*lists[newest])[--ranges[newest].second]));
+    }
+    return records;
+}
+
+// Run counts and trip times per (relay, kind) group; only this part needs
+// the lock, so sorting and binning never hold up a tester's append()
+void ResultStore::collectGroups(const ResultQuery& query, std::vector<ResultAggregate>& groups,
+                                std::vector<std::vector<double>>& times) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const std::vector<uint32_t>*> lists;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    selectLists(query, lists, ranges);
+
+    // Lists come grouped by relay, then kind
+    for (size_t i = 0; i < lists.size(); ++i) {
+        const uint32_t first = (*lists[i])[ranges[i].first];
+        const std::string& relay = relayNames_[relay_[first]];
+        const ResultKind kind = static_cast<ResultKind>(kind_[first]);
+        if (groups.empty() || groups.back().relay != relay || groups.back().kind != kind) {
+            groups.emplace_back();
+            groups.back().relay = relay;
+            groups.back().kind = kind;
+            times.emplace_back();
+        }
+        ResultAggregate& group = groups.back();
+        for (size_t j = ranges[i].first; j < ranges[i].second; ++j) {
+            const uint32_t index = (*lists[i])[j];
+            group.runs++;
+            if (flags_[index] & FlagPassed) {
+                group.passed++;
+            }
+            if (flags_[index] & FlagTripped) {
+                group.tripped++;
+                times.back().push_back(tripTime_[index]);
+            }
+        }
+    }
+}
+
+std::vector<ResultAggregate> ResultStore::aggregate(const ResultQuery& query, double binWidth) const {
+    std::vector<ResultAggregate> groups;
+    std::vector<std::vector<double>> times;
+    collectGroups(query, groups, times);
+
+    for (size_t g = 0; g < groups.size(); ++g) {
+        std::vector<double>& t = times[g];
+        if (t.empty()) {
+            continue;
+        }
+        ResultAggregate& group = groups[g];
+        std::sort(t.begin(), t.end());
+        const double n = static_cast<double>(t.size());
+        double sum = 0.0;
+        for (double v : t) {
+            sum += v;
+        }
+        double squares = 0.0;
+        for (double v : t) {
+            squares += (v - sum / n) * (v - sum / n);
+        }
+        group.minTripTime = t.front();
+        group.maxTripTime = t.back();
+        group.meanTripTime = sum / n;
+        group.stddevTripTime = std::sqrt(squares / n);
+        group.p50TripTime = percentile(t, 0.50);
+        group.p90TripTime = percentile(t, 0.90);
+        group.p99TripTime = percentile(t, 0.99);
+
+        const double span = group.maxTripTime - group.minTripTime;
+        group.binWidth = std::max(binWidth > 0.0 ? binWidth : ResultStore_HistogramBinS,
+                                  span / static_cast<double>(ResultStore_MaxHistogramBins));
+        const size_t bins = std::min(ResultStore_MaxHistogramBins,
+                                     static_cast<size_t>(span / group.binWidth) + 1);
+        group.histogram.assign(bins, 0);
+        for (double v : t) {
+            group.histogram[std::min(bins - 1, static_cast<size_t>((v - group.minTripTime) / group.binWidth))]++;
+        }
+    }
+    return groups;
+}
+
+void ResultStore::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushed_.wait(lock, [this] { return !file_ || (writtenRows_ == time_.size() && !writing_); });
+}
+
+ResultStoreStatus ResultStore::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResultStoreStatus s;
+    s.path = file_ ? path_ : "";
+    s.records = time_.size();
+    s.relays = relayNames_.size();
+    s.pending = file_ ? time_.size() - writtenRows_ : 0;
+    s.blocksWritten = blocksWritten_;
+    s.bytesWritten = bytesWritten_;
+    s.writeErrors = writeErrors_;
+    s.recoveredBytes = recoveredBytes_;
+    s.lastError = lastError_;
+    return s;
+}
+
+// Append new rows as blocks; the file is only touched outside the lock
+void ResultStore::writerThread() {
+    std::vector<uint8_t> block;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        pendingChanged_.wait(lock, [this] { return stopping_ || (file_ && writtenRows_ < time_.size()); });
+        if (!file_ || writtenRows_ == time_.size()) {
+            if (stopping_) {
+                break;
+            }
+            continue;
+        }
+
+        const size_t first = writtenRows_;
+        const size_t rows = std::min(time_.size() - first, ResultStore_MaxBlockRows);
+        const size_t relays = relayNames_.size();
+        block.assign(BlockHeaderSize, 0);
+        for (size_t id = writtenRelays_; id < relays; ++id) {
+            const std::string& name = relayNames_[id];
+            const uint16_t size = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+            put(block, static_cast<uint32_t>(id));
+            put(block, size);
+            block.insert(block.end(), name.begin(), name.begin() + size);
+        }
+        putColumn(block, time_, first, rows);
+        putColumn(block, job_, first, rows);
+        putColumn(block, relay_, first, rows);
+        putColumn(block, kind_, first, rows);
+        putColumn(block, flags_, first, rows);
+        putColumn(block, tripTime_, first, rows);
+        putColumn(block, expectedTime_, first, rows);
+        putColumn(block, x_, first, rows);
+        putColumn(block, y_, first, rows);
+        const uint32_t header[4] = {BlockMagic, static_cast<uint32_t>(rows),
+                                    static_cast<uint32_t>(relays - writtenRelays_),
+                                    static_cast<uint32_t>(block.size() - BlockHeaderSize)};
+        std::memcpy(block.data(), header, sizeof(header));
+        const uint32_t crc = crc32(block.data() + BlockHeaderSize, block.size() - BlockHeaderSize,
+                                   crc32(block.data(), sizeof(header)));
+        std::memcpy(block.data() + sizeof(header), &crc, sizeof(crc));
+
+        writing_ = true;
+        std::FILE* file = file_;
+        lock.unlock();
+        const bool ok = std::fwrite(block.data(), 1, block.size(), file) == block.size() &&
+                        std::fflush(file) == 0;
+        const int error = errno;
+        lock.lock();
+        writing_ = false;
+
+        if (ok) {
+            writtenRows_ = first + rows;
+            writtenRelays_ = relays;
+            blocksWritten_++;
+            bytesWritten_ += block.size();
+        } else {
+            // Later blocks would follow a torn one; the next open cuts it off
+            writeErrors_++;
+            lastError_ = "Failed to write " + path_ + ": " + std::strerror(error);
+            LOG_ERROR("RESULTS", "%s; results are kept in memory only", lastError_.c_str());
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        flushed_.notify_all();
+    }
+}
+
+std::string ResultStore::kindToString(ResultKind kind) {
+    switch (kind) {
+        case ResultKind::RAMP: return "ramp";
+        case ResultKind::DISTANCE: return "distance";
+        case ResultKind::OVERCURRENT: return "overcurrent";
+        case ResultKind::DIFFERENTIAL: return "differential";
+        case ResultKind::TRANSIENT: return "transient";
+    }
+    return "unknown";
+}
+
+bool ResultStore::parseKind(const std::string& name, ResultKind& kind) {
+    for (size_t k = 0; k < ResultKindCount; ++k) {
+        if (kindToString(static_cast<ResultKind>(k)) == name) {
+            kind = static_cast<ResultKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace testers
+} // namespace vts
@@ -0,0 +1,295 @@
+#include "test_job_executor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace vts {
+namespace testers {
+
+namespace {
+
+double unixNow() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+nlohmann::json TestJobInfo::toJson(bool includeResult) const {
+    nlohmann::json j = {
+        {"id", id},
+        {"kind", kind},
+        {"state", TestJobExecutor::stateToString(state)},
+        {"progress", progress},
+        {"message", message},
+        {"error", error},
+        {"submittedAt", submittedAt},
+        {"startedAt", startedAt},
+        {"finishedAt", finishedAt}
+    };
+    if (includeResult && !result.is_null()) {
+        j["result"] = result;
+    }
+    return j;
+}
+
+void TestJobContext::progress(double fraction, const std::string& message) {
+    executor_.reportProgress(id_, std::min(std::max(fraction, 0.0), 1.0), message);
+}
+
+TestJobExecutor::TestJobExecutor()
+    : nextId_(1), stopping_(false) {
+    thread_ = std::thread(&TestJobExecutor::run, this);
+}
+
+TestJobExecutor::~TestJobExecutor() {
+    shutdown();
+}
+
+void TestJobExecutor::setListener(TestJobListener listener) {
+    std::lock_guard<std::mutex> lock(listenerMutex_);
+    listener_ = std::move(listener);
+}
+
+uint64_t TestJobExecutor::submit(const std::string& kind, TestJobFunction job, std::string& error,
+                                 std::function<void()> cancel) {
+    if (!job) {
+        error = "empty job";
+        return 0;
+    }
+
+    TestJobInfo info;
+    std::unique_lock<std::mutex> listenerLock;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            error = "job executor is shutting down";
+            return 0;
+        }
+        if (queue_.size() >= TestJobs_MaxQueued) {
+            error = "job queue is full (" + std::to_string(TestJobs_MaxQueued) + " waiting)";
+            return 0;
+        }
+
+        auto entry = std::make_shared<Job>();
+        entry->info.id = nextId_++;
+        entry->info.kind = kind;
+        entry->info.submittedAt = unixNow();
+        entry->function = std::move(job);
+        entry->cancel = std::move(cancel);
+        entry->context.reset(new TestJobContext(*this, entry->info.id));
+        jobs_[entry->info.id] = entry;
+        queue_.push_back(entry->info.id);
+        info = entry->info;
+        // Taken before the worker can see the job, so QUEUED is reported
+        // ahead of RUNNING
+        listenerLock = std::unique_lock<std::mutex>(listenerMutex_);
+    }
+    changed_.notify_all();
+    if (listener_) {
+        listener_(info);
+    }
+    return info.id;
+}
+
+bool TestJobExecutor::cancel(uint64_t id) {
+    TestJobInfo info;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end() || it->second->info.finished()) {
+            return false;
+        }
+        Job& job = *it->second;
+        job.context->cancelled_.store(true, std::memory_order_release);
+        if (job.info.state == TestJobState::RUNNING) {
+            // Under the lock, so it cannot reach a job started after this one;
+            // the job finishes as CANCELLED once its function returns
+            if (job.cancel) {
+                job.cancel();
+            }
+            return true;
+        }
+        queue_.erase(std::remove(queue_.begin(), queue_.end(), id), queue_.end());
+        finish(job, TestJobState::CANCELLED);
+        info = job.info;
+    }
+    changed_.notify_all();
+    notify(info);
+    return true;
+}
+
+bool TestJobExecutor::wait(uint64_t id, TestJobInfo& info) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    // Held across the wait: the job may be retired as soon as it finishes
+    const std::shared_ptr<Job> job = it->second;
+    changed_.wait(lock, [&job] { return job->info.finished(); });
+    info = job->info;
+    return true;
+}
+
+bool TestJobExecutor::get(uint64_t id, TestJobInfo& info) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    info = it->second->info;
+    return true;
+}
+
+std::vector<TestJobInfo> TestJobExecutor::list() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TestJobInfo> infos;
+    infos.reserve(jobs_.size());
+    for (const auto& entry : jobs_) {
+        infos.push_back(entry.second->info);
+    }
+    return infos;
+}
+
+size_t TestJobExecutor::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void TestJobExecutor::shutdown() {
+    std::vector<TestJobInfo> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {                   // Not on the destructor's call after an explicit one
+            stopping_ = true;
+            for (uint64_t id : queue_) {
+                Job& job = *jobs_[id];
+                job.context->cancelled_.store(true, std::memory_order_release);
+                finish(job, TestJobState::CANCELLED);
+                cancelled.push_back(job.info);
+            }
+            queue_.clear();
+            for (const auto& entry : jobs_) {
+                Job& job = *entry.second;
+                if (job.info.state == TestJobState::RUNNING) {
+                    job.context->cancelled_.store(true, std::memory_order_release);
+                    if (job.cancel) {
+                        job.cancel();
+                    }
+                }
+            }
+        }
+    }
+    changed_.notify_all();
+    for (const TestJobInfo& info : cancelled) {
+        notify(info);
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::string TestJobExecutor::stateToString(TestJobState state) {
+    switch (state) {
+        case TestJobState::QUEUED: return "QUEUED";
+        case TestJobState::RUNNING: return "RUNNING";
+        case TestJobState::COMPLETED: return "COMPLETED";
+        case TestJobState::FAILED: return "FAILED";
+        case TestJobState::CANCELLED: return "CANCELLED";
+    }
+    return "UNKNOWN";
+}
+
+void TestJobExecutor::run() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        TestJobInfo info;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = jobs_[queue_.front()];
+            queue_.pop_front();
+            job->info.state = TestJobState::RUNNING;
+            job->info.startedAt = unixNow();
+            info = job->info;
+        }
+        notify(info);
+        execute(*job);
+    }
+}
+
+void TestJobExecutor::execute(Job& job) {
+    nlohmann::json result;
+    TestJobState state = TestJobState::COMPLETED;
+    std::string error;
+    try {
+        result = job.function(*job.context);
+        if (job.context->cancelled()) {
+            state = TestJobState::CANCELLED;
+        }
+    } catch (const std::exception& e) {
+        state = TestJobState::FAILED;
+        error = e.what();
+    } catch (...) {
+        state = TestJobState::FAILED;
+        error = "unknown error";
+    }
+
+    TestJobInfo info;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job.info.result = std::move(result);
+        job.info.error = error;
+        finish(job, state);
+        info = job.info;
+    }
+    changed_.notify_all();
+    notify(info);
+}
+
+void TestJobExecutor::reportProgress(uint64_t id, double fraction, const std::string& message) {
+    TestJobInfo info;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end() || it->second->info.state != TestJobState::RUNNING) {
+            return;
+        }
+        it->second->info.progress = fraction;
+        it->second->info.message = message;
+        info = it->second->info;
+    }
+    notify(info);
+}
+
+// Caller holds mutex_
+void TestJobExecutor::finish(Job& job, TestJobState state) {
+    job.info.state = state;
+    job.info.finishedAt = unixNow();
+    if (state == TestJobState::COMPLETED) {
+        job.info.progress = 1.0;
+    }
+    finished_.push_back(job.info.id);
+    retire();
+}
+
+// Caller holds mutex_
+void TestJobExecutor::retire() {
+    while (finished_.size() > TestJobs_MaxRetained) {
+        jobs_.erase(finished_.front());
+        finished_.pop_front();
+    }
+}
+
+void TestJobExecutor::notify(const TestJobInfo& info) {
+    std::lock_guard<std::mutex> lock(listenerMutex_);
+    if (listener_) {
+        listener_(info);
+    }
+}
+
+} // namespace testers
+} // namespace vts
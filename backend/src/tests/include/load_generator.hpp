@@ -0,0 +1,230 @@
+#ifndef LOAD_GENERATOR_HPP
+#define LOAD_GENERATOR_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "general_definition.hpp"
+#include "latency_histogram.hpp"
+
+/**
+ * @brief A block of identical 9-2LE SV streams
+ *
+ * Stream i of the group uses APPID baseAppId + i, destination MAC
+ * baseDstMac + i (last two bytes) and svID "<svIdPrefix><i>". Channels are
+ * Ia, Ib, Ic, In, Va, Vb, Vc, Vn with the 9-2LE scaling (1 mA, 10 mV per LSB).
+ */
+struct LoadGenSvGroup {
+    uint32_t count = 1;
+    uint32_t sampleRate = 4800;             // Samples per second per stream
+    uint8_t noAsdu = 1;                     // ASDUs per frame (1..8)
+    double nominalFreq = 60.0;
+    double currentA = 1.0;                  // RMS per phase
+    double voltageV = 63.5;                 // RMS phase-neutral
+    uint16_t baseAppId = 0x4000;
+    std::array<uint8_t, 6> baseDstMac{{0x01, 0x0C, 0xCD, 0x04, 0x00, 0x00}};
+    std::string svIdPrefix = "LoadSV";
+};
+
+/**
+ * @brief A block of identical GOOSE publishers
+ *
+ * Every message either repeats the state (sqNum++) or, with stateChange,
+ * toggles the first dataset boolean as a new state (stNum++, sqNum = 0).
+ */
+struct LoadGenGooseGroup {
+    uint32_t count = 1;
+    double rateHz = 1000.0;                 // Messages per second per stream
+    uint32_t dataEntries = 8;               // BOOLEAN dataset members
+    bool stateChange = false;
+    uint16_t baseAppId = 0x0001;
+    std::array<uint8_t, 6> baseDstMac{{0x01, 0x0C, 0xCD, 0x01, 0x00, 0x00}};
+    std::string gocbRefPrefix = "LoadGen/LLN0$GO$gcb";
+};
+
+struct LoadGenConfig {
+    std::vector<LoadGenSvGroup> sv;
+    std::vector<LoadGenGooseGroup> goose;
+    std::array<uint8_t, 6> srcMac{{0x02, 0x00, 0x00, 0x00, 0x00, 0x01}};
+    uint16_t vlanId = 0;
+    uint8_t vlanPriority = 4;
+    std::vector<int> cpus;                  // One TX thread pinned per CPU; empty = one unpinned thread
+    double durationS = 0.0;                 // 0 = until stopped
+    uint32_t batchWindowNs = LoadGen_BatchWindowNs;
+    uint32_t spinNs = LoadGen_SpinNs;
+};
+
+enum class LoadStreamKind { SV, GOOSE };
+
+/**
+ * @brief Achieved rate and timing of one generated stream
+ *
+ * Timing error is send time minus scheduled time.
+ */
+struct LoadGenStreamStats {
+    std::string name;
+    LoadStreamKind kind = LoadStreamKind::SV;
+    uint16_t appId = 0;
+    uint32_t thread = 0;
+    double targetFramesPerSecond = 0.0;
+    uint64_t framesSent = 0;
+    uint64_t bytesSent = 0;
+    uint64_t sendErrors = 0;
+    double framesPerSecond = 0.0;
+    double bitsPerSecond = 0.0;
+    int64_t errorP50Ns = 0;
+    int64_t errorP99Ns = 0;
+    int64_t errorMaxNs = 0;
+    double errorMeanNs = 0.0;
+};
+
+struct LoadGenStats {
+    bool running = false;
+    std::string error;
+    double elapsedS = 0.0;
+    uint32_t threads = 0;
+    uint64_t framesSent = 0;
+    uint64_t sendErrors = 0;
+    double targetFramesPerSecond = 0.0;
+    double framesPerSecond = 0.0;
+    double bitsPerSecond = 0.0;             // Frame bytes only
+    double wireBitsPerSecond = 0.0;         // Plus preamble, FCS and inter-frame gap
+    std::vector<LoadGenStreamStats> streams;
+};
+
+/**
+ * @brief Process-bus load generator: many SV/GOOSE streams from a compact spec
+ *
+ * All frame templates live in one cache-line aligned arena, one slot per
+ * stream, and are patched in place (smpCnt/samples, or stNum/sqNum/t) just
+ * before they are sent. Streams are dealt round-robin to one TX thread per
+ * configured CPU; each thread keeps its streams on a single timeline ordered
+ * by absolute deadline, staggered within each stream's period so they
+ * interleave instead of bursting together. Frames due within the batch window
+ * go out in one sendmmsg().
+ */
+class LoadGenerator {
+public:
+    LoadGenerator();
+    ~LoadGenerator();
+
+    LoadGenerator(const LoadGenerator&) = delete;
+    LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+    /**
+     * @brief Validate the spec and build every stream's frame template
+     * @param config Stream groups and TX settings
+     * @param error Set on failure
+     * @return true if the streams were built (called by start())
+     */
+    bool prepare(const LoadGenConfig& config, std::string& error);
+
+    /**
+     * @brief Build the streams and start the TX threads (Linux only)
+     */
+    bool start(const LoadGenConfig& config, std::string& error);
+
+    /**
+     * @brief Stop and join all TX threads
+     */
+    void stop();
+
+    bool isRunning() const { return activeThreads_.load(std::memory_order_acquire) > 0; }
+
+    /**
+     * @brief Totals and per-stream rates/timing (updated every publish interval)
+     */
+    LoadGenStats getStats() const;
+
+    size_t streamCount() const { return streams_.size(); }
+
+    /**
+     * @brief Patch stream `stream`'s template for its frame number `frameIndex`
+     * @return Frame bytes (inside the arena) and length through `length`
+     */
+    const uint8_t* renderFrame(size_t stream, uint64_t frameIndex, size_t& length);
+
+    /**
+     * @brief Time of frame n from the stream start, for a period of num/den seconds
+     *
+     * Exact integer arithmetic, so deadlines never drift at rates like
+     * 14400 frames/s whose period is not a whole number of nanoseconds.
+     */
+    static uint64_t frameOffsetNs(uint64_t frameIndex, uint64_t periodNum, uint64_t periodDen) {
+        const uint64_t units = frameIndex * periodNum;
+        return (units / periodDen) * 1000000000ull + ((units % periodDen) * 1000000000ull) / periodDen;
+    }
+
+private:
+    struct Stream {
+        LoadStreamKind kind;
+        std::string name;
+        uint16_t appId;
+        size_t offset;                      // Template slot in the arena
+        size_t length;
+        uint64_t periodNum;                 // Frame period = periodNum / periodDen seconds
+        uint64_t periodDen;
+        uint64_t phaseNs;                   // Stagger on its thread's timeline
+        uint32_t thread;
+
+        // SV: first smpCnt value, distance between ASDUs, sample table
+        uint32_t smpCntPos;
+        uint32_t asduStride;
+        uint8_t noAsdu;
+        uint32_t sampleRate;
+        size_t table;
+
+        // GOOSE: patched field values, state counters
+        uint32_t tPos;
+        uint32_t stNumPos;
+        uint32_t sqNumPos;
+        uint32_t statePos;                  // Value byte of the first BOOLEAN
+        bool stateChange;
+    };
+
+    struct Counters {
+        uint64_t framesSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t sendErrors = 0;
+        LatencyHistogram histogram{-static_cast<int64_t>(LoadGen_BatchWindowNs) - 1000, LoadGen_HistogramMaxNs, 1000};
+    };
+
+    struct Worker {
+        LoadGenerator* owner;
+        uint32_t index;
+        int cpu;
+        std::vector<size_t> streams;
+        pthread_t thread;
+        bool started;
+        std::vector<Counters> published;    // Guarded by statsMutex_
+        uint64_t publishedNs;
+    };
+
+    static void* threadEntry(void* arg);
+    void run(Worker& worker);
+    bool addSvGroup(const LoadGenSvGroup& group, std::vector<std::vector<uint8_t>>& frames, std::string& error);
+    bool addGooseGroup(const LoadGenGooseGroup& group, std::vector<std::vector<uint8_t>>& frames, std::string& error);
+    uint8_t* slot(const Stream& stream) { return arena_.data() + arenaBase_ + stream.offset; }
+
+    LoadGenConfig config_;
+    std::vector<Stream> streams_;
+    std::vector<uint8_t> arena_;
+    size_t arenaBase_;                      // First 64-byte aligned byte of arena_
+    std::vector<std::vector<int32_t>> tables_;  // Per SV group: 8 channels x sampleRate, channel-major
+
+    std::vector<Worker> workers_;
+    std::atomic<bool> stop_;
+    std::atomic<uint32_t> activeThreads_;
+    uint64_t startNs_;
+
+    mutable std::mutex statsMutex_;
+    std::string error_;
+};
+
+#endif // LOAD_GENERATOR_HPP
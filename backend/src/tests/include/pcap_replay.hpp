@@ -0,0 +1,143 @@
+#ifndef PCAP_REPLAY_HPP
+#define PCAP_REPLAY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <pthread.h>
+
+#include "general_definition.hpp"
+#include "latency_histogram.hpp"
+#include "pcap_reader.hpp"
+
+/**
+ * @brief pcap/pcapng replay settings
+ */
+struct PcapReplayConfig {
+    std::string path;                       // Capture file
+    double speed = 1.0;                     // Time scale: 2.0 replays twice as fast
+    bool loop = false;                      // Restart at end of file
+    uint32_t loopCount = 0;                 // Passes when looping, 0 = until stopped
+
+    // Rewrites, applied to every Ethernet frame
+    bool rewriteDstMac = false;
+    std::array<uint8_t, 6> dstMac{};
+    bool rewriteSrcMac = false;
+    std::array<uint8_t, 6> srcMac{};
+    int32_t appId = -1;                     // SV/GOOSE APPID, -1 = keep
+    int32_t vlanId = -1;                    // Set or insert an 802.1Q tag, -1 = keep
+    int32_t vlanPriority = -1;              // With vlanId, -1 = keep (0 when inserting)
+    bool stripVlan = false;                 // Remove the outer 802.1Q tag
+
+    uint32_t batchWindowNs = PcapReplay_BatchWindowNs;
+    uint32_t spinNs = PcapReplay_SpinNs;
+
+    bool rewrites() const {
+        return rewriteDstMac || rewriteSrcMac || appId >= 0 || vlanId >= 0 || stripVlan;
+    }
+};
+
+/**
+ * @brief Replay progress and achieved timing
+ *
+ * Timing error is send time minus scheduled time; frames sent early as
+ * part of a batch have a negative error.
+ */
+struct PcapReplayStats {
+    bool running = false;
+    std::string error;
+    uint64_t framesSent = 0;
+    uint64_t framesSkipped = 0;             // Non-Ethernet, truncated or oversized records
+    uint64_t bytesSent = 0;
+    uint64_t sendErrors = 0;
+    uint64_t batches = 0;
+    uint32_t loopsCompleted = 0;
+    int64_t errorP50Ns = 0;
+    int64_t errorP90Ns = 0;
+    int64_t errorP99Ns = 0;
+    int64_t errorP999Ns = 0;
+    int64_t errorMinNs = 0;
+    int64_t errorMaxNs = 0;
+    double errorMeanNs = 0.0;
+};
+
+/**
+ * @brief Replays a capture file to the wire at its original inter-frame timing
+ *
+ * The file is streamed through PcapReader's mapping. Every frame gets an
+ * absolute CLOCK_MONOTONIC deadline (start + capture offset / speed), so
+ * sleep jitter never accumulates. The thread sleeps until shortly before a
+ * deadline, spins the rest, then sends that frame and every frame due within
+ * the batch window in one sendmmsg(). Unmodified frames are sent straight
+ * from the mapping; rewritten ones go through a per-batch buffer.
+ */
+class PcapReplay {
+public:
+    PcapReplay();
+    ~PcapReplay();
+
+    PcapReplay(const PcapReplay&) = delete;
+    PcapReplay& operator=(const PcapReplay&) = delete;
+
+    /**
+     * @brief Open the file and start the TX thread
+     * @param config Replay settings
+     * @param error Set on failure
+     * @return true if the replay started
+     */
+    bool start(const PcapReplayConfig& config, std::string& error);
+
+    /**
+     * @brief Stop the replay and join the TX thread
+     */
+    void stop();
+
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Counters and timing percentiles (updated every 100 ms and at the end)
+     */
+    PcapReplayStats getStats() const;
+
+    /**
+     * @brief Apply the configured rewrites to one Ethernet frame
+     * @param config Rewrite settings
+     * @param in Captured frame
+     * @param length Captured length
+     * @param out Destination, at least length + 4 bytes
+     * @return Length written to out, 0 if the frame is too short
+     */
+    static size_t rewriteFrame(const PcapReplayConfig& config, const uint8_t* in, size_t length, uint8_t* out);
+
+    /**
+     * @brief Deadline offset of a frame from the replay start
+     * @param captureOffsetNs Frame time minus first frame time
+     * @param speed Time scale (> 0)
+     */
+    static uint64_t scheduleOffset(uint64_t captureOffsetNs, double speed) {
+        return static_cast<uint64_t>(static_cast<double>(captureOffsetNs) / speed);
+    }
+
+private:
+    static void* threadEntry(void* arg);
+    void run();
+    void publish(const LatencyHistogram& histogram, const PcapReplayStats& counters);
+
+    PcapReplayConfig config_;
+    vts::io::PcapReader reader_;
+
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_;
+    pthread_t thread_;
+    bool threadStarted_;
+
+    mutable std::mutex statsMutex_;
+    PcapReplayStats stats_;
+    LatencyHistogram histogram_;
+};
+
+#endif // PCAP_REPLAY_HPP
@@ -0,0 +1,323 @@
+#ifndef RELAY_EMULATOR_HPP
+#define RELAY_EMULATOR_HPP
+
+#include <array>
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <pthread.h>
+
+#include "general_definition.hpp"
+#include "latency_histogram.hpp"
+#include "clock.hpp"
+#include "frame_loopback.hpp"
+#include "frequency_tracker.hpp"
+#include "overcurrent_tester.hpp"
+#include "SV_FrameLayout.hpp"
+
+class RawSocket;
+
+/**
+ * @brief 50/51 phase overcurrent element
+ *
+ * The 51 stage integrates 1 / t(M) of the curve over time, so a constant
+ * current operates after exactly the curve time and a varying one after the
+ * accumulated equivalent; it resets as soon as the current falls below
+ * pickup.
+ */
+struct RelayOvercurrent {
+    bool enabled = false;
+    vts::testers::OCSettings settings{1.0, 0.1, vts::testers::OCCurve::STANDARD_INVERSE};   // 51
+    double instantaneousPickup = 0.0;       // 50 (A RMS), 0 = off
+    double instantaneousDelay = 0.0;        // 50 definite time (s)
+};
+
+/**
+ * @brief One distance zone on the R-X plane (secondary ohms)
+ *
+ * Mho: circle through the origin with the reach at the line angle as its
+ * diameter. Quadrilateral: X from 0 to the reach's reactance, R within
+ * resistiveReach of the line through the origin at the line angle.
+ */
+struct RelayDistanceZone {
+    enum class Shape { Mho, Quadrilateral };
+    Shape shape = Shape::Mho;
+    double reach = 10.0;                    // |Z| along the line angle
+    double angle = 75.0;                    // Line angle (degrees)
+    double resistiveReach = 5.0;            // Quadrilateral half-width in R
+    double delay = 0.0;                     // Zone time (s)
+};
+
+/**
+ * @brief 21 element: every zone sees all six loops (AG BG CG AB BC CA)
+ *
+ * A zone operates once it has measured inside on two consecutive cycles
+ * and its delay has run.
+ */
+struct RelayDistance {
+    bool enabled = false;
+    std::vector<RelayDistanceZone> zones;
+    std::complex<double> k0{0.0, 0.0};      // Residual compensation (Z0 - Z1) / 3Z1
+    double minCurrent = 0.1;                // Loops with less current (A RMS) are not measured
+};
+
+/**
+ * @brief 87 percentage-differential element against a second SV stream
+ *
+ * Per phase Id = |I1 + I2| and Ir = |I1 - I2| / 2 (the DifferentialTester
+ * convention); operates when Id exceeds max(pickup, slope1 * Ir) up to the
+ * breakpoint and slope2 above it. The two streams are aligned by smpCnt.
+ */
+struct RelayDifferential {
+    bool enabled = false;
+    std::array<uint8_t, 6> remoteDstMac{};  // Remote end's SV stream
+    uint16_t remoteAppId = 0x4001;
+    double pickup = 0.2;                    // Id> (A RMS)
+    double slope1 = 0.25;
+    double breakpoint = 2.0;                // Ir where slope2 takes over (A)
+    double slope2 = 0.5;
+    double delay = 0.0;                     // s
+};
+
+/**
+ * @brief One emulated relay: its SV inputs, elements and trip GOOSE
+ *
+ * The relay publishes a GOOSE whose dataset is four BOOLEANs: general trip,
+ * 50/51, 21 and 87 operated. A new state goes out outputDelay after the
+ * element decision (the emulated output contact / GOOSE publishing time).
+ */
+struct RelayConfig {
+    std::string name;
+
+    // Subscribed 9-2LE stream and channel mapping
+    std::array<uint8_t, 6> svDstMac{{0x01, 0x0C, 0xCD, 0x04, 0x00, 0x01}};
+    uint16_t svAppId = 0x4000;
+    double sampleRate = 4800.0;
+    double nominalFrequency = 60.0;
+    std::array<uint8_t, 3> currentChannels{{0, 1, 2}};  // seqData index of Ia Ib Ic
+    std::array<uint8_t, 3> voltageChannels{{4, 5, 6}};  // Va Vb Vc
+    double currentScale = 1.0 / SV92LE_CountsPerAmp;    // A per LSB, as SVPublisherInstance emits
+    double voltageScale = 1.0 / SV92LE_CountsPerVolt;   // V per LSB
+
+    RelayOvercurrent overcurrent;
+    RelayDistance distance;
+    RelayDifferential differential;
+
+    // Trip GOOSE
+    double outputDelay = 0.004;             // s
+    std::array<uint8_t, 6> gooseDstMac{{0x01, 0x0C, 0xCD, 0x01, 0x00, 0x01}};
+    std::array<uint8_t, 6> srcMac{{0x02, 0x00, 0x00, 0x00, 0x01, 0x01}};
+    uint16_t gooseAppId = 0x0001;
+    std::string gocbRef;                    // Empty: "<name>/LLN0$GO$Trip"
+    uint16_t vlanId = 0;
+    uint8_t vlanPriority = 4;
+};
+
+/**
+ * @brief State and timing of one emulated relay
+ *
+ * Operate time runs on the relay's sample clock from the first element
+ * pickup to the trip decision. Output latency is clock time from that
+ * decision to the trip GOOSE leaving, the output delay included.
+ */
+struct RelayStats {
+    std::string name;
+    uint64_t frames = 0;
+    uint64_t evaluations = 0;               // One per tracked cycle
+    uint64_t trips = 0;
+    uint64_t gooseSent = 0;
+    bool tripped = false;
+    bool overcurrent = false;
+    bool distance = false;
+    bool differential = false;
+    double frequency = 0.0;
+    std::array<double, 3> current{};        // A RMS, last evaluation
+    double lastOperateTime = 0.0;           // s, 0 before the first trip
+    int64_t outputP50Ns = 0;
+    int64_t outputP99Ns = 0;
+    int64_t outputMaxNs = 0;
+};
+
+struct RelayEmulatorStats {
+    bool running = false;
+    bool loopback = false;                  // In-process frames instead of a raw socket
+    double elapsedS = 0.0;
+    uint64_t framesReceived = 0;            // SV frames seen
+    uint64_t framesProcessed = 0;           // Subscribed SV frames
+    uint64_t sampleGaps = 0;                // smpCnt discontinuities
+    uint64_t gooseSent = 0;
+    uint64_t sendErrors = 0;
+    double framesPerSecond = 0.0;
+    int64_t processingP50Ns = 0;            // Per subscribed frame, all its relays
+    int64_t processingP99Ns = 0;
+    int64_t processingMaxNs = 0;
+    std::vector<RelayStats> relays;
+};
+
+/**
+ * @brief In-process protection relays closing the loop on our own SV output
+ *
+ * Relays subscribe to SV streams by (destination MAC, APPID). Each
+ * subscribed channel is tracked once, however many relays read it, by the
+ * analyzer's FrequencyTracker; the stream's first channel (a relay's phase A
+ * voltage, or current without a 21 element) sets the frequency the others
+ * are resampled at. Every relay evaluates its elements once per tracked
+ * cycle of its phase A current, in its stream's sample time.
+ * Nothing allocates per frame: streams are found through a hash of the
+ * subscription key and trip GOOSE frames are pre-encoded templates patched
+ * in place.
+ *
+ * Frames come either from a FrameLoopback (setLoopback(), for virtual-time
+ * runs: GOOSE goes back through the same loopback) or from an RX thread on
+ * the raw socket interface, typically a veth peer of the publisher's
+ * interface, which also sends the GOOSE. A trip's output delay is measured
+ * on the clock and released when the next frame arrives or, on the raw
+ * socket, after at most RelayEmu_RxTimeoutUs.
+ */
+class RelayEmulator {
+public:
+    explicit RelayEmulator(std::shared_ptr<Clock> clock = systemClock());
+    ~RelayEmulator();
+
+    RelayEmulator(const RelayEmulator&) = delete;
+    RelayEmulator& operator=(const RelayEmulator&) = delete;
+
+    /**
+     * @brief Check one relay's settings
+     * @return false with the reason in error
+     */
+    static bool validate(const RelayConfig& config, std::string& error);
+
+    /**
+     * @brief Take frames from (and send GOOSE to) this loopback from now on
+     *
+     * Call once, before start(); the loopback stays attached for the
+     * emulator's lifetime and frames are ignored while stopped.
+     */
+    void setLoopback(std::shared_ptr<FrameLoopback> loopback);
+
+    /**
+     * @brief Build the relays and start receiving
+     *
+     * Without a loopback an RX thread is started on the raw socket (Linux
+     * only). A running emulator is stopped first.
+     */
+    bool start(const std::vector<RelayConfig>& relays, std::string& error);
+
+    void stop();
+
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Process one received Ethernet frame (RX thread or loopback)
+     */
+    void receive(const uint8_t* frame, size_t length);
+
+    /**
+     * @brief Send trip GOOSE whose output delay has elapsed
+     */
+    void poll();
+
+    RelayEmulatorStats getStats() const;
+
+private:
+    // One tracked channel of a subscribed stream
+    struct Channel {
+        uint8_t index;                      // seqData position
+        vts::analyzer::FrequencyTracker tracker;
+        std::vector<size_t> evaluate;       // Relays whose phase A current this is
+        bool completed;                     // Cycle ended on the last row
+    };
+
+    struct Stream {
+        uint64_t key;
+        double sampleRate;
+        std::vector<Channel> channels;
+        uint64_t samples;                   // Pushed since start
+        int32_t origin;                     // smpCnt of the first sample, -1 before it
+        int32_t lastSmpCnt;
+        uint64_t frames;
+    };
+
+    // Position of a relay input: stream and channel within it
+    struct Input {
+        size_t stream;
+        size_t channel;
+    };
+
+    struct Relay {
+        RelayConfig config;
+        std::array<Input, 3> current;
+        std::array<Input, 3> voltage;
+        std::array<Input, 3> remote;
+
+        // Element state, on the relay's sample clock (s)
+        double lastEvaluation;
+        double overcurrentSince;            // 51 pickup time, < 0 when dropped out
+        double integral;                    // 51 progress since then, 1 = operate
+        double instantaneousSince;          // 50 pickup time, < 0 when dropped out
+        std::vector<double> zoneSince;
+        double differentialSince;
+        double pickupSince;                 // First pickup of any element
+        uint8_t state;                      // Bits 0-2: 50/51, 21, 87 operated; bit 3: trip
+
+        // Trip GOOSE template and output queue
+        std::vector<uint8_t> goose;
+        size_t tPos;
+        size_t stNumPos;
+        size_t sqNumPos;
+        size_t dataPos;                     // First BOOLEAN value byte
+        uint32_t stNum;
+        bool pending;                       // state not yet published
+        Clock::time_point decided;
+        Clock::time_point due;
+
+        RelayStats stats;
+        LatencyHistogram output{0, RelayEmu_OutputHistogramMaxNs, 10000};
+    };
+
+    static uint64_t streamKey(const uint8_t* mac, uint16_t appId);
+    Input subscribe(uint64_t key, double sampleRate, double nominalFrequency, uint8_t index, std::string& error);
+    bool build(const std::vector<RelayConfig>& relays, std::string& error);
+    void processFrame(Stream& stream, const uint8_t* pdu, size_t length);
+    void processRow(Stream& stream, uint32_t smpCnt, const uint8_t* seqData, size_t channels);
+    std::complex<double> phasor(const Input& input, size_t reference, double atSample) const;
+    void evaluate(size_t relay, double atSample);
+    void release(Clock::time_point now);
+    void sendGoose(Relay& relay, Clock::time_point now);
+    void transmit(const uint8_t* frame, size_t length);
+
+    static void* threadEntry(void* arg);
+    void run();
+
+    std::shared_ptr<Clock> clock_;
+    std::shared_ptr<FrameLoopback> loopback_;
+
+    // RX state, guarded by rxMutex_ (uncontended except for start/stop/getStats)
+    mutable std::mutex rxMutex_;
+    std::vector<Stream> streams_;
+    std::unordered_map<uint64_t, size_t> streamIndex_;
+    std::vector<Relay> relays_;
+    uint64_t framesReceived_;
+    uint64_t framesProcessed_;
+    uint64_t sampleGaps_;
+    uint64_t gooseSent_;
+    uint64_t sendErrors_;
+    size_t pending_;                        // Relays with a GOOSE waiting for its output delay
+    LatencyHistogram processing_{0, RelayEmu_ProcessingHistogramMaxNs, 100};
+    uint64_t startNs_;                      // Wall time of start(), for throughput
+    std::unique_ptr<RawSocket> socket_;     // Without a loopback
+
+    pthread_t thread_;
+    bool threadStarted_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_;
+};
+
+#endif // RELAY_EMULATOR_HPP
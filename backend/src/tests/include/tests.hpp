@@ -21,11 +21,13 @@ struct Sv_packet{
     uint8_t noAsdu;
     uint8_t noChannels;
     uint16_t smpRate;
+    uint32_t asdu_stride = 0;       // Distance between ASDUs (fixed layouts only)
+    sv_patch_fn patch = nullptr;    // Set by select_sv_patch(); nullptr = generic
 };
 
 class Tests_Class{
 public:
-    std::array<std::atomic<uint8_t>, 16> digital_input;
+    DigitalInputBank digital_input;
     std::vector<std::unique_ptr<transient_config>> transient_tests;
     RawSocket raw_socket;
     SnifferClass sniffer;
@@ -37,9 +39,6 @@ private:
 public:
 
     Tests_Class(){
-        for(size_t i = 0; i < digital_input.size(); ++i) {
-            digital_input[i].store(0, std::memory_order_relaxed);
-        }
         sniffer.digitalInput = &digital_input;
     }
 
@@ -54,9 +53,7 @@ public:
 
     void start_transient_test(std::vector<std::unique_ptr<transient_config>>&& configs){
 
-        if(sniffer.running.load(std::memory_order_acquire)){
-            sniffer.stopThread();
-        }
+        // Publishes the subscriptions; an already running sniffer keeps capturing
         std::vector<Goose_info> goInput = get_goose_input_config("files/goose_input_config.json");
         sniffer.startThread(goInput);
 
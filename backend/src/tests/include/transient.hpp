@@ -8,6 +8,8 @@
 #include "sv_sender.hpp"
 #include <pthread.h>
 #include "raw_socket_platform.hpp"
+#include "digital_input_bank.hpp"
+#include "impairment_stage.hpp"
 #include <string>
 
 #include <nlohmann/json.hpp>
@@ -17,11 +19,18 @@
 
 using json = nlohmann::json;
 
+struct Sv_packet;
+
+// Per-frame patch: writes smpCnt and seqData of every ASDU, advances idx and
+// smpCount, returns 1 when the record wrapped to its start
+typedef int (*sv_patch_fn)(std::vector<std::vector<int32_t>>* buffer, Sv_packet* pkt_info, int& idx, int& smpCount);
+
 struct transient_config{
 
     std::string fileName;
     uint8_t loop_flag;
     uint8_t interval_flag;
+    uint8_t prerender;      // Render every frame before start (finite replay only)
     double interval;
     uint64_t start_time;
     uint32_t timed_start;
@@ -38,7 +47,8 @@ struct transient_config{
     SampledValue_Config sv_config;
 
     RawSocket* socket;
-    std::array<std::atomic<uint8_t>, 16>* digital_input;
+    DigitalInputBank* digital_input;
+    ImpairmentStage impairment;     // Optional "impairment" profile from the config
     
 
     std::atomic<bool> stop;
@@ -47,10 +57,14 @@ struct transient_config{
     pthread_t thd;
     bool threadStarted;
     
-    transient_config() : stop(false), running(false), error(false), threadStarted(false) {}
+    transient_config() : prerender(0), stop(false), running(false), error(false), threadStarted(false) {}
 };
 
 void* run_transient_test(void* arg);
 
+// Pick the patch routine for a frame template: a compile-time 9-2LE layout
+// when the ASDU/channel counts and recorded offsets match one, else generic
+void select_sv_patch(Sv_packet* pkt_info);
+
 #endif // TRANSIENT_HPP
 
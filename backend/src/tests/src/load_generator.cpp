@@ -0,0 +1,537 @@
+#include "load_generator.hpp"
+#include "raw_socket_platform.hpp"
+#include "rt_utils.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "SampledValue.hpp"
+#include "Goose.hpp"
+#include "SV_FrameLayout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+constexpr size_t SlotAlign = 64;            // Templates start on their own cache line
+constexpr size_t SvChannels = 8;
+constexpr double WireOverheadBytes = 24.0;  // Preamble + SFD, FCS, inter-frame gap
+constexpr uint64_t PublishIntervalNs = 250000000;   // Stats snapshot period
+constexpr uint64_t MaxSleepNs = 100000000;          // Re-check stop at least this often
+
+// Any 8-channel 9-2LE ASDU has the same smpCnt -> seqData distance
+using SvAsdu = SvLayout_92LE_80;
+
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>((v >> 16) & 0xFF);
+    p[2] = static_cast<uint8_t>((v >> 8) & 0xFF);
+    p[3] = static_cast<uint8_t>(v & 0xFF);
+}
+
+std::array<uint8_t, 6> offsetMac(const std::array<uint8_t, 6>& base, uint32_t index) {
+    std::array<uint8_t, 6> mac = base;
+    const uint32_t low = ((static_cast<uint32_t>(base[4]) << 8 | base[5]) + index) & 0xFFFF;
+    mac[4] = static_cast<uint8_t>(low >> 8);
+    mac[5] = static_cast<uint8_t>(low & 0xFF);
+    return mac;
+}
+
+// Ethernet + 802.1Q header shared by both stream kinds
+std::vector<uint8_t> frameHeader(const std::array<uint8_t, 6>& dst, const LoadGenConfig& config) {
+    std::vector<uint8_t> frame(dst.begin(), dst.end());
+    frame.insert(frame.end(), config.srcMac.begin(), config.srcMac.end());
+    const uint16_t tci = static_cast<uint16_t>((config.vlanPriority & 0x7) << 13 | (config.vlanId & 0x0FFF));
+    frame.insert(frame.end(), {0x81, 0x00, static_cast<uint8_t>(tci >> 8), static_cast<uint8_t>(tci & 0xFF)});
+    return frame;
+}
+
+} // namespace
+
+LoadGenerator::LoadGenerator()
+    : arenaBase_(0), stop_(false), activeThreads_(0), startNs_(0) {
+}
+
+LoadGenerator::~LoadGenerator() {
+    stop();
+}
+
+bool LoadGenerator::addSvGroup(const LoadGenSvGroup& group, std::vector<std::vector<uint8_t>>& frames, std::string& error) {
+    if (group.noAsdu < 1 || group.noAsdu > 8) {
+        error = "SV noAsdu must be 1..8";
+        return false;
+    }
+    if (group.sampleRate < group.noAsdu || group.sampleRate > 1000000 || group.sampleRate % group.noAsdu != 0) {
+        error = "SV sampleRate must be a multiple of noAsdu, up to 1 MHz";
+        return false;
+    }
+    if (!(group.nominalFreq > 0.0) || group.nominalFreq * 2.0 >= group.sampleRate) {
+        error = "SV nominalFreq must be positive and below half the sample rate";
+        return false;
+    }
+
+    // One second of samples: smpCnt wraps at sampleRate, so the table is
+    // indexed by smpCnt directly
+    const size_t table = tables_.size();
+    tables_.emplace_back(SvChannels * group.sampleRate);
+    std::vector<int32_t>& samples = tables_.back();
+    const double iPeak = group.currentA * std::sqrt(2.0) * SV92LE_CountsPerAmp;
+    const double vPeak = group.voltageV * std::sqrt(2.0) * SV92LE_CountsPerVolt;
+    const double shift = 2.0 * M_PI / 3.0;
+    for (uint32_t s = 0; s < group.sampleRate; ++s) {
+        const double wt = 2.0 * M_PI * group.nominalFreq * s / group.sampleRate;
+        const double values[SvChannels] = {
+            iPeak * std::sin(wt - 0.5), iPeak * std::sin(wt - 0.5 - shift), iPeak * std::sin(wt - 0.5 + shift), 0.0,
+            vPeak * std::sin(wt),       vPeak * std::sin(wt - shift),       vPeak * std::sin(wt + shift),       0.0
+        };
+        for (size_t ch = 0; ch < SvChannels; ++ch) {
+            samples[ch * group.sampleRate + s] = static_cast<int32_t>(std::lround(values[ch]));
+        }
+    }
+
+    for (uint32_t i = 0; i < group.count; ++i) {
+        Stream stream{};
+        stream.kind = LoadStreamKind::SV;
+        stream.appId = static_cast<uint16_t>(group.baseAppId + i);
+        stream.name = group.svIdPrefix + std::to_string(i);
+        stream.periodNum = group.noAsdu;
+        stream.periodDen = group.sampleRate;
+        stream.noAsdu = group.noAsdu;
+        stream.sampleRate = group.sampleRate;
+        stream.table = table;
+
+        std::vector<uint8_t> frame = frameHeader(offsetMac(group.baseDstMac, i), config_);
+        const size_t svStart = frame.size();
+        SampledValue sv(stream.appId, group.noAsdu, stream.name, 0, 1, 0x01, 0);
+        std::vector<uint8_t> encoded = sv.getEncoded(static_cast<uint8_t>(SvChannels));
+        frame.insert(frame.end(), encoded.begin(), encoded.end());
+
+        // Same shape check as SvFixedLayout::matches(), for any ASDU count
+        const int first = sv.getParamPos(0, "smpCnt");
+        const int second = group.noAsdu > 1 ? sv.getParamPos(1, "smpCnt") : first;
+        if (first < 0 || second < first) {
+            error = "SV template has no smpCnt";
+            return false;
+        }
+        stream.smpCntPos = static_cast<uint32_t>(svStart) + static_cast<uint32_t>(first);
+        stream.asduStride = static_cast<uint32_t>(second - first);
+        for (int a = 0; a < group.noAsdu; ++a) {
+            if (sv.getParamPos(a, "smpCnt") != first + a * static_cast<int>(stream.asduStride) ||
+                sv.getParamPos(a, "seqData") != sv.getParamPos(a, "smpCnt") + static_cast<int>(SvAsdu::smpCntToSeqData)) {
+                error = "SV template does not follow the 9-2LE layout";
+                return false;
+            }
+        }
+
+        stream.length = frame.size();
+        streams_.push_back(std::move(stream));
+        frames.push_back(std::move(frame));
+    }
+    return true;
+}
+
+bool LoadGenerator::addGooseGroup(const LoadGenGooseGroup& group, std::vector<std::vector<uint8_t>>& frames, std::string& error) {
+    if (!(group.rateHz > 0.0) || group.rateHz > 100000.0) {
+        error = "GOOSE rateHz must be in (0, 100000]";
+        return false;
+    }
+    if (group.dataEntries < 1 || group.dataEntries > 256) {
+        error = "GOOSE dataEntries must be 1..256";
+        return false;
+    }
+
+    // Period as a rational in milliHertz
+    const uint64_t rateMilliHz = static_cast<uint64_t>(std::llround(group.rateHz * 1000.0));
+    const uint32_t tal = static_cast<uint32_t>(std::max(10.0, std::ceil(3000.0 / group.rateHz)));
+
+    std::vector<Data> dataset;
+    for (uint32_t d = 0; d < group.dataEntries; ++d) {
+        dataset.emplace_back(Data::Type::Boolean);
+    }
+
+    for (uint32_t i = 0; i < group.count; ++i) {
+        Stream stream{};
+        stream.kind = LoadStreamKind::GOOSE;
+        stream.appId = static_cast<uint16_t>(group.baseAppId + i);
+        stream.name = group.gocbRefPrefix + std::to_string(i);
+        stream.periodNum = 1000;
+        stream.periodDen = std::max<uint64_t>(1, rateMilliHz);
+        stream.stateChange = group.stateChange;
+
+        std::vector<uint8_t> frame = frameHeader(offsetMac(group.baseDstMac, i), config_);
+        const size_t gooseStart = frame.size();
+        Goose goose("", "", stream.appId, config_.vlanId, stream.name, tal, stream.name + "$DataSet",
+                    stream.name, UtcTime(0, 0), 1, 0, false, 1, false, 0, dataset);
+        std::vector<uint8_t> encoded = goose.getEncoded();
+        frame.insert(frame.end(), encoded.begin(), encoded.end());
+
+        const int t = goose.getParamPos("t");
+        const int stNum = goose.getParamPos("stNum");
+        const int sqNum = goose.getParamPos("sqNum");
+        const int allData = goose.getParamPos("allData");
+        if (t < 0 || stNum < 0 || sqNum < 0 || allData < 0) {
+            error = "GOOSE template is missing a patched field";
+            return false;
+        }
+        stream.tPos = static_cast<uint32_t>(gooseStart) + static_cast<uint32_t>(t);
+        stream.stNumPos = static_cast<uint32_t>(gooseStart) + static_cast<uint32_t>(stNum);
+        stream.sqNumPos = static_cast<uint32_t>(gooseStart) + static_cast<uint32_t>(sqNum);
+        stream.statePos = static_cast<uint32_t>(gooseStart) + static_cast<uint32_t>(allData) + 2;  // 83 01 <value>
+
+        stream.length = frame.size();
+        streams_.push_back(std::move(stream));
+        frames.push_back(std::move(frame));
+    }
+    return true;
+}
+
+bool LoadGenerator::prepare(const LoadGenConfig& config, std::string& error) {
+    if (isRunning()) {
+        error = "load generator is running";
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    error_.clear();
+    config_ = config;
+    streams_.clear();
+    tables_.clear();
+
+    size_t total = 0;
+    for (const auto& group : config.sv) total += group.count;
+    for (const auto& group : config.goose) total += group.count;
+    if (total == 0) {
+        error = "no streams configured";
+        return false;
+    }
+    if (total > LoadGen_MaxStreams) {
+        error = "at most " + std::to_string(LoadGen_MaxStreams) + " streams";
+        return false;
+    }
+    if (config.cpus.size() > LoadGen_MaxThreads) {
+        error = "at most " + std::to_string(LoadGen_MaxThreads) + " TX threads";
+        return false;
+    }
+    if (config.vlanId > 4095 || config.vlanPriority > 7) {
+        error = "vlanId must be <= 4095, vlanPriority <= 7";
+        return false;
+    }
+
+    std::vector<std::vector<uint8_t>> frames;
+    frames.reserve(total);
+    for (const auto& group : config.sv) {
+        if (!addSvGroup(group, frames, error)) return false;
+    }
+    for (const auto& group : config.goose) {
+        if (!addGooseGroup(group, frames, error)) return false;
+    }
+
+    // Pack the templates into cache-line slots of one aligned arena
+    size_t arenaSize = 0;
+    for (auto& stream : streams_) {
+        stream.offset = arenaSize;
+        arenaSize += (stream.length + SlotAlign - 1) / SlotAlign * SlotAlign;
+    }
+    arena_.assign(arenaSize + SlotAlign, 0);
+    const uintptr_t address = reinterpret_cast<uintptr_t>(arena_.data());
+    arenaBase_ = (SlotAlign - address % SlotAlign) % SlotAlign;
+    for (size_t i = 0; i < streams_.size(); ++i) {
+        std::memcpy(slot(streams_[i]), frames[i].data(), frames[i].size());
+    }
+
+    // Deal streams to threads, then stagger each thread's streams across
+    // their own period so the timeline interleaves them evenly
+    const size_t threads = std::max<size_t>(1, config.cpus.size());
+    workers_.clear();
+    workers_.resize(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers_[t].owner = this;
+        workers_[t].index = static_cast<uint32_t>(t);
+        workers_[t].cpu = config.cpus.empty() ? -1 : config.cpus[t];
+        workers_[t].started = false;
+        workers_[t].publishedNs = 0;
+    }
+    for (size_t i = 0; i < streams_.size(); ++i) {
+        streams_[i].thread = static_cast<uint32_t>(i % threads);
+        workers_[i % threads].streams.push_back(i);
+    }
+    for (auto& worker : workers_) {
+        const size_t count = worker.streams.size();
+        for (size_t k = 0; k < count; ++k) {
+            Stream& stream = streams_[worker.streams[k]];
+            stream.phaseNs = frameOffsetNs(1, stream.periodNum, stream.periodDen) * k / count;
+        }
+        worker.published.assign(count, Counters());
+    }
+    return true;
+}
+
+const uint8_t* LoadGenerator::renderFrame(size_t index, uint64_t frameIndex, size_t& length) {
+    const Stream& stream = streams_[index];
+    uint8_t* frame = slot(stream);
+    length = stream.length;
+
+    if (stream.kind == LoadStreamKind::SV) {
+        const std::vector<int32_t>& table = tables_[stream.table];
+        const int32_t* channels[SvChannels];
+        for (size_t ch = 0; ch < SvChannels; ++ch) {
+            channels[ch] = table.data() + ch * stream.sampleRate;
+        }
+        const uint64_t firstSample = frameIndex * stream.noAsdu;
+        for (uint8_t a = 0; a < stream.noAsdu; ++a) {
+            const size_t smpCnt = static_cast<size_t>((firstSample + a) % stream.sampleRate);
+            SvAsdu::writeAsdu(frame + stream.smpCntPos + a * stream.asduStride,
+                              static_cast<uint16_t>(smpCnt), channels, smpCnt);
+        }
+        return frame;
+    }
+
+    // GOOSE: each message is either a new state or a retransmission of state 1
+    uint32_t stNum = 1;
+    uint32_t sqNum = static_cast<uint32_t>(frameIndex);
+    if (stream.stateChange) {
+        stNum = static_cast<uint32_t>(frameIndex + 1);
+        sqNum = 0;
+        frame[stream.statePos] = (frameIndex & 1) ? 0xFF : 0x00;
+    }
+    if (stream.stateChange || frameIndex == 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        putU32(frame + stream.tPos, static_cast<uint32_t>(now.tv_sec));
+        putU32(frame + stream.tPos + 4, static_cast<uint32_t>((static_cast<uint64_t>(now.tv_nsec) << 32) / 1000000000ull));
+    }
+    putU32(frame + stream.stNumPos, stNum);
+    putU32(frame + stream.sqNumPos, sqNum);
+    return frame;
+}
+
+bool LoadGenerator::start(const LoadGenConfig& config, std::string& error) {
+    stop();
+#ifndef __linux__
+    (void)config;
+    error = "load generator requires Linux raw sockets";
+    return false;
+#else
+    if (!prepare(config, error)) {
+        return false;
+    }
+
+    stop_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        startNs_ = monotonicNs() + LoadGen_StartDelayNs;
+    }
+    for (auto& worker : workers_) {
+        activeThreads_.fetch_add(1, std::memory_order_acq_rel);
+        int ret = pthread_create(&worker.thread, nullptr, &LoadGenerator::threadEntry, &worker);
+        if (ret != 0) {
+            error = "Failed to create TX thread: " + std::string(strerror(ret));
+            activeThreads_.fetch_sub(1, std::memory_order_acq_rel);
+            stop();
+            return false;
+        }
+        worker.started = true;
+    }
+    LOG_INFO("LOADGEN", "Started %zu streams on %zu TX threads", streams_.size(), workers_.size());
+    return true;
+#endif
+}
+
+void LoadGenerator::stop() {
+    stop_.store(true, std::memory_order_release);
+    for (auto& worker : workers_) {
+        if (worker.started) {
+            pthread_join(worker.thread, nullptr);
+            worker.started = false;
+        }
+    }
+}
+
+LoadGenStats LoadGenerator::getStats() const {
+    LoadGenStats stats;
+    stats.running = isRunning();
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats.threads = static_cast<uint32_t>(workers_.size());
+    stats.error = error_;
+    uint64_t elapsedNs = 0;
+    for (const auto& worker : workers_) {
+        const double seconds = worker.publishedNs > startNs_ ? static_cast<double>(worker.publishedNs - startNs_) / 1e9 : 0.0;
+        elapsedNs = std::max(elapsedNs, worker.publishedNs > startNs_ ? worker.publishedNs - startNs_ : 0);
+        for (size_t k = 0; k < worker.streams.size(); ++k) {
+            const Stream& stream = streams_[worker.streams[k]];
+            const Counters& counters = worker.published[k];
+            LoadGenStreamStats s;
+            s.name = stream.name;
+            s.kind = stream.kind;
+            s.appId = stream.appId;
+            s.thread = worker.index;
+            s.targetFramesPerSecond = static_cast<double>(stream.periodDen) / static_cast<double>(stream.periodNum);
+            s.framesSent = counters.framesSent;
+            s.bytesSent = counters.bytesSent;
+            s.sendErrors = counters.sendErrors;
+            if (seconds > 0.0) {
+                s.framesPerSecond = static_cast<double>(counters.framesSent) / seconds;
+                s.bitsPerSecond = static_cast<double>(counters.bytesSent) * 8.0 / seconds;
+            }
+            s.errorP50Ns = counters.histogram.percentile(0.50);
+            s.errorP99Ns = counters.histogram.percentile(0.99);
+            s.errorMaxNs = counters.histogram.max();
+            s.errorMeanNs = counters.histogram.mean();
+
+            stats.framesSent += s.framesSent;
+            stats.sendErrors += s.sendErrors;
+            stats.targetFramesPerSecond += s.targetFramesPerSecond;
+            stats.framesPerSecond += s.framesPerSecond;
+            stats.bitsPerSecond += s.bitsPerSecond;
+            stats.wireBitsPerSecond += s.bitsPerSecond + s.framesPerSecond * WireOverheadBytes * 8.0;
+            stats.streams.push_back(std::move(s));
+        }
+    }
+    stats.elapsedS = static_cast<double>(elapsedNs) / 1e9;
+    return stats;
+}
+
+void* LoadGenerator::threadEntry(void* arg) {
+    Worker* worker = static_cast<Worker*>(arg);
+    worker->owner->run(*worker);
+    return nullptr;
+}
+
+void LoadGenerator::run(Worker& worker) {
+#ifdef __linux__
+    rt_set_realtime(LoadGen_ThreadPriority);
+    if (worker.cpu >= 0) {
+        rt_set_affinity({worker.cpu});
+    }
+
+    const size_t count = worker.streams.size();
+    std::vector<Counters> counters(count);
+    std::unique_ptr<RawSocket> socket;
+    try {
+        socket = std::make_unique<RawSocket>();
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        error_ = e.what();
+        activeThreads_.fetch_sub(1, std::memory_order_acq_rel);
+        return;
+    }
+
+    // Timeline: (deadline, local stream index), earliest first
+    using Entry = std::pair<uint64_t, size_t>;
+    std::vector<Entry> storage;
+    storage.reserve(count);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> timeline(std::greater<Entry>(), std::move(storage));
+    std::vector<uint64_t> frameIndex(count, 0);
+    auto deadlineOf = [&](size_t k) {
+        const Stream& stream = streams_[worker.streams[k]];
+        return startNs_ + stream.phaseNs + frameOffsetNs(frameIndex[k], stream.periodNum, stream.periodDen);
+    };
+    for (size_t k = 0; k < count; ++k) {
+        timeline.push({deadlineOf(k), k});
+    }
+
+    const uint64_t endNs = config_.durationS > 0.0
+        ? startNs_ + static_cast<uint64_t>(config_.durationS * 1e9) : UINT64_MAX;
+    struct mmsghdr msgs[LoadGen_MaxBatch];
+    struct iovec iovs[LoadGen_MaxBatch];
+    size_t batch[LoadGen_MaxBatch];
+    uint64_t deadlines[LoadGen_MaxBatch];
+    uint64_t lastPublish = monotonicNs();
+
+    auto publish = [&](uint64_t now) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        worker.published = counters;
+        worker.publishedNs = now;
+    };
+
+    while (!stop_.load(std::memory_order_acquire) && !timeline.empty()) {
+        const uint64_t deadline = timeline.top().first;
+        if (deadline >= endNs) break;
+
+        // Sleep to just before the deadline, then spin
+        uint64_t now = monotonicNs();
+        while (now < deadline && !stop_.load(std::memory_order_acquire)) {
+            if (deadline - now > config_.spinNs) {
+                rt_sleep_abs(std::min(deadline - config_.spinNs, now + MaxSleepNs));
+            }
+            now = monotonicNs();
+        }
+        if (stop_.load(std::memory_order_acquire)) break;
+
+        // Everything due within the batch window goes out together. A stream
+        // is re-queued only after the send, so its slot is never in a batch twice.
+        size_t n = 0;
+        while (n < LoadGen_MaxBatch && !timeline.empty() &&
+               timeline.top().first <= deadline + config_.batchWindowNs) {
+            const Entry entry = timeline.top();
+            timeline.pop();
+            size_t length = 0;
+            const uint8_t* frame = renderFrame(worker.streams[entry.second], frameIndex[entry.second], length);
+            iovs[n].iov_base = const_cast<uint8_t*>(frame);
+            iovs[n].iov_len = length;
+            batch[n] = entry.second;
+            deadlines[n] = entry.first;
+            n++;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &socket->bind_addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(socket->bind_addr);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const uint64_t sendNs = monotonicNs();
+        size_t done = 0;
+        while (done < n) {
+            int sent = sendmmsg(socket->socket_id, msgs + done, static_cast<unsigned int>(n - done), 0);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                for (size_t i = done; i < n; i++) {
+                    counters[batch[i]].sendErrors++;
+                }
+                break;
+            }
+            for (size_t i = done; i < done + static_cast<size_t>(sent); i++) {
+                counters[batch[i]].framesSent++;
+                counters[batch[i]].bytesSent += iovs[i].iov_len;
+                METRIC_SENT_FRAME();
+            }
+            done += static_cast<size_t>(sent);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            const size_t k = batch[i];
+            counters[k].histogram.record(static_cast<int64_t>(sendNs) - static_cast<int64_t>(deadlines[i]));
+            frameIndex[k]++;
+            timeline.push({deadlineOf(k), k});
+        }
+
+        if (sendNs - lastPublish >= PublishIntervalNs) {
+            publish(sendNs);
+            lastPublish = sendNs;
+        }
+    }
+
+    publish(std::min(monotonicNs(), endNs));
+    LOG_INFO("LOADGEN", "TX thread %u finished", worker.index);
+#else
+    (void)worker;
+#endif
+    activeThreads_.fetch_sub(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,333 @@
+#include "pcap_replay.hpp"
+#include "raw_socket_platform.hpp"
+#include "rt_utils.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "thread_health.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+constexpr uint64_t PublishIntervalNs = 100000000;   // Stats snapshot period
+constexpr uint64_t MaxSleepNs = 100000000;          // Re-check stop at least this often
+
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool isVlanTpid(const uint8_t* p) {
+    return (p[0] == 0x81 && p[1] == 0x00) || (p[0] == 0x88 && p[1] == 0xA8);
+}
+
+bool isIec61850EtherType(const uint8_t* p) {
+    return p[0] == 0x88 && (p[1] == 0xBA || p[1] == 0xB8 || p[1] == 0xB9);
+}
+
+} // namespace
+
+PcapReplay::PcapReplay()
+    : running_(false), stop_(false), thread_(), threadStarted_(false),
+      histogram_(-static_cast<int64_t>(PcapReplay_BatchWindowNs) - 1000, 10000000, 1000) {
+}
+
+PcapReplay::~PcapReplay() {
+    stop();
+}
+
+size_t PcapReplay::rewriteFrame(const PcapReplayConfig& config, const uint8_t* in, size_t length, uint8_t* out) {
+    if (length < 14) {
+        return 0;
+    }
+
+    std::memcpy(out, config.rewriteDstMac ? config.dstMac.data() : in, 6);
+    std::memcpy(out + 6, config.rewriteSrcMac ? config.srcMac.data() : in + 6, 6);
+
+    const bool tagged = length >= 18 && isVlanTpid(in + 12);
+    size_t inPos = 12;
+    size_t outPos = 12;
+
+    if (config.stripVlan && tagged) {
+        inPos = 16;
+    } else if (config.vlanId >= 0) {
+        uint16_t tci = 0;
+        if (tagged) {
+            tci = static_cast<uint16_t>(in[14] << 8 | in[15]);
+            out[12] = in[12];
+            out[13] = in[13];
+            inPos = 16;
+        } else {
+            out[12] = 0x81;
+            out[13] = 0x00;
+        }
+        if (config.vlanPriority >= 0) {
+            tci = static_cast<uint16_t>((tci & 0x1FFF) | (config.vlanPriority & 0x7) << 13);
+        }
+        tci = static_cast<uint16_t>((tci & 0xF000) | (config.vlanId & 0x0FFF));
+        out[14] = static_cast<uint8_t>(tci >> 8);
+        out[15] = static_cast<uint8_t>(tci & 0xFF);
+        outPos = 16;
+    }
+
+    std::memcpy(out + outPos, in + inPos, length - inPos);
+    const size_t outLength = outPos + (length - inPos);
+
+    if (config.appId >= 0) {
+        size_t etherType = 12;
+        while (etherType + 4 <= outLength && isVlanTpid(out + etherType)) {
+            etherType += 4;
+        }
+        if (etherType + 4 <= outLength && isIec61850EtherType(out + etherType)) {
+            out[etherType + 2] = static_cast<uint8_t>((config.appId >> 8) & 0xFF);
+            out[etherType + 3] = static_cast<uint8_t>(config.appId & 0xFF);
+        }
+    }
+    return outLength;
+}
+
+bool PcapReplay::start(const PcapReplayConfig& config, std::string& error) {
+    if (threadStarted_) {
+        stop();
+    }
+    if (!(config.speed > 0.0)) {
+        error = "speed must be greater than 0";
+        return false;
+    }
+#ifndef __linux__
+    (void)config;
+    error = "pcap replay requires Linux raw sockets";
+    return false;
+#else
+    if (!reader_.open(config.path)) {
+        error = reader_.getLastError();
+        return false;
+    }
+
+    config_ = config;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_ = PcapReplayStats();
+        stats_.running = true;
+        histogram_.reset();
+    }
+    stop_.store(false, std::memory_order_release);
+    running_.store(true, std::memory_order_release);
+
+    int ret = pthread_create(&thread_, nullptr, &PcapReplay::threadEntry, this);
+    if (ret != 0) {
+        running_.store(false, std::memory_order_release);
+        error = "Failed to create replay thread: " + std::string(strerror(ret));
+        return false;
+    }
+    threadStarted_ = true;
+    return true;
+#endif
+}
+
+void PcapReplay::stop() {
+    if (!threadStarted_) {
+        return;
+    }
+    stop_.store(true, std::memory_order_release);
+    pthread_join(thread_, nullptr);
+    threadStarted_ = false;
+}
+
+PcapReplayStats PcapReplay::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    PcapReplayStats stats = stats_;
+    stats.running = running_.load(std::memory_order_acquire);
+    stats.errorP50Ns = histogram_.percentile(0.50);
+    stats.errorP90Ns = histogram_.percentile(0.90);
+    stats.errorP99Ns = histogram_.percentile(0.99);
+    stats.errorP999Ns = histogram_.percentile(0.999);
+    stats.errorMinNs = histogram_.min();
+    stats.errorMaxNs = histogram_.max();
+    stats.errorMeanNs = histogram_.mean();
+    return stats;
+}
+
+void PcapReplay::publish(const LatencyHistogram& histogram, const PcapReplayStats& counters) {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    histogram_ = histogram;
+    stats_ = counters;
+}
+
+void* PcapReplay::threadEntry(void* arg) {
+    static_cast<PcapReplay*>(arg)->run();
+    return nullptr;
+}
+
+void PcapReplay::run() {
+#ifdef __linux__
+    LOG_INFO("PCAP", "Replay thread starting: %s (speed %.3f, loop %d)",
+             config_.path.c_str(), config_.speed, config_.loop ? 1 : 0);
+    rt_set_realtime(PcapReplay_ThreadPriority);
+    ThreadHealth::Scope health("pcap-replay");
+
+    PcapReplayStats counters;
+    counters.running = true;
+    LatencyHistogram histogram = histogram_;
+
+    std::unique_ptr<RawSocket> socket;
+    try {
+        socket = std::make_unique<RawSocket>();
+    } catch (const std::exception& e) {
+        counters.error = e.what();
+        counters.running = false;
+        publish(histogram, counters);
+        running_.store(false, std::memory_order_release);
+        return;
+    }
+
+    const bool rewrite = config_.rewrites();
+    std::vector<uint8_t> txBuffer(PcapReplay_MaxBatch * PcapReplay_MaxFrameSize);
+    struct mmsghdr msgs[PcapReplay_MaxBatch];
+    struct iovec iovs[PcapReplay_MaxBatch];
+    uint64_t deadlines[PcapReplay_MaxBatch];
+
+    // Next replayable Ethernet frame; other records are counted and skipped
+    vts::io::PcapPacket pending;
+    auto nextFrame = [&]() {
+        while (reader_.next(pending)) {
+            if (pending.linkType != vts::io::PcapReader::LinkTypeEthernet ||
+                pending.capturedLength < pending.originalLength ||
+                pending.capturedLength < 14 ||
+                pending.capturedLength + 4 > PcapReplay_MaxFrameSize) {
+                counters.framesSkipped++;
+                continue;
+            }
+            return true;
+        }
+        return false;
+    };
+
+    bool havePending = nextFrame();
+    if (!havePending) {
+        counters.error = reader_.getLastError().empty() ? "No replayable Ethernet frames" : reader_.getLastError();
+    }
+
+    const uint64_t firstTs = havePending ? pending.timestampNs : 0;
+    uint64_t lastTs = firstTs;
+    uint64_t passFrames = 0;
+    uint64_t loopOffset = 0;
+    const uint64_t startNs = monotonicNs() + PcapReplay_StartDelayNs;
+    uint64_t lastPublish = monotonicNs();
+
+    auto deadlineOf = [&](const vts::io::PcapPacket& pkt) {
+        const uint64_t offset = pkt.timestampNs > firstTs ? pkt.timestampNs - firstTs : 0;
+        return startNs + loopOffset + scheduleOffset(offset, config_.speed);
+    };
+
+    while (!stop_.load(std::memory_order_acquire)) {
+        if (!havePending) {
+            if (!reader_.getLastError().empty()) {
+                counters.error = reader_.getLastError();
+                break;
+            }
+            if (passFrames == 0) break;
+            counters.loopsCompleted++;
+            if (!config_.loop || (config_.loopCount != 0 && counters.loopsCompleted >= config_.loopCount)) {
+                break;
+            }
+            // Next pass starts one mean frame gap after the last frame
+            const uint64_t span = lastTs - firstTs;
+            const uint64_t gap = passFrames > 1 ? span / (passFrames - 1) : 1000000;
+            loopOffset += scheduleOffset(span + gap, config_.speed);
+            reader_.rewind();
+            passFrames = 0;
+            lastTs = firstTs;
+            havePending = nextFrame();
+            continue;
+        }
+
+        // Sleep to just before the deadline, then spin
+        const uint64_t deadline = deadlineOf(pending);
+        uint64_t now = monotonicNs();
+        while (now < deadline && !stop_.load(std::memory_order_acquire)) {
+            const uint64_t remaining = deadline - now;
+            if (remaining > config_.spinNs) {
+                rt_sleep_abs(std::min(deadline - config_.spinNs, now + MaxSleepNs));
+            }
+            now = monotonicNs();
+        }
+        if (stop_.load(std::memory_order_acquire)) break;
+
+        // Everything due within the batch window goes out with this frame
+        size_t count = 0;
+        uint64_t due = deadline;
+        do {
+            uint8_t* frame = const_cast<uint8_t*>(pending.data);
+            size_t length = pending.capturedLength;
+            if (rewrite) {
+                uint8_t* slot = txBuffer.data() + count * PcapReplay_MaxFrameSize;
+                length = rewriteFrame(config_, pending.data, length, slot);
+                frame = slot;
+            }
+            iovs[count].iov_base = frame;
+            iovs[count].iov_len = length;
+            deadlines[count] = due;
+            count++;
+
+            lastTs = std::max(lastTs, pending.timestampNs);
+            passFrames++;
+            havePending = nextFrame();
+            if (!havePending) break;
+            due = deadlineOf(pending);
+        } while (count < PcapReplay_MaxBatch && due <= deadline + config_.batchWindowNs);
+
+        for (size_t i = 0; i < count; i++) {
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &socket->bind_addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(socket->bind_addr);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const uint64_t sendNs = monotonicNs();
+        size_t done = 0;
+        while (done < count) {
+            int sent = sendmmsg(socket->socket_id, msgs + done, static_cast<unsigned int>(count - done), 0);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                counters.sendErrors += count - done;
+                break;
+            }
+            for (size_t i = done; i < done + static_cast<size_t>(sent); i++) {
+                counters.framesSent++;
+                counters.bytesSent += iovs[i].iov_len;
+                METRIC_SENT_FRAME();
+            }
+            done += static_cast<size_t>(sent);
+        }
+        for (size_t i = 0; i < count; i++) {
+            histogram.record(static_cast<int64_t>(sendNs) - static_cast<int64_t>(deadlines[i]));
+        }
+        const int64_t late = static_cast<int64_t>(sendNs) - static_cast<int64_t>(deadlines[0]);
+        if (late >= ThreadHealth_LateNs) {
+            ThreadHealth::recordMiss(late);
+        }
+        counters.batches++;
+
+        if (sendNs - lastPublish >= PublishIntervalNs) {
+            publish(histogram, counters);
+            lastPublish = sendNs;
+        }
+    }
+
+    counters.running = false;
+    publish(histogram, counters);
+    LOG_INFO("PCAP", "Replay finished: %llu frames, %u passes, p99 error %lld ns",
+             static_cast<unsigned long long>(counters.framesSent), counters.loopsCompleted,
+             static_cast<long long>(histogram.percentile(0.99)));
+#endif
+    running_.store(false, std::memory_order_release);
+}
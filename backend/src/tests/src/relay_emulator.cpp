@@ -0,0 +1,763 @@
+#include "relay_emulator.hpp"
+#include "raw_socket_platform.hpp"
+#include "rt_utils.hpp"
+#include "logger.hpp"
+#include "byte_order.hpp"
+#include "redundancy_filter.hpp"
+#include "BER_Codec.hpp"
+#include "Goose.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+constexpr double Sqrt2 = 1.4142135623730951;
+constexpr double Pi = 3.14159265358979323846;
+constexpr double TimeEpsilon = 1e-9;
+
+constexpr uint8_t OvercurrentBit = 0x01;
+constexpr uint8_t DistanceBit = 0x02;
+constexpr uint8_t DifferentialBit = 0x04;
+constexpr uint8_t TripBit = 0x08;
+
+constexpr size_t GooseEntries = 4;          // Trip, 50/51, 21, 87
+constexpr size_t MaxChannel = 63;
+constexpr size_t MaxZones = 8;
+
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+int64_t toNs(Clock::duration interval) {
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+}
+
+bool insideZone(const RelayDistanceZone& zone, std::complex<double> z) {
+    const double angle = zone.angle * Pi / 180.0;
+    if (zone.shape == RelayDistanceZone::Shape::Mho) {
+        return std::abs(z - std::polar(zone.reach / 2.0, angle)) <= zone.reach / 2.0;
+    }
+    const double x = z.imag();
+    if (x < 0.0 || x > zone.reach * std::sin(angle)) {
+        return false;
+    }
+    return std::abs(z.real() - x * std::cos(angle) / std::sin(angle)) <= zone.resistiveReach;
+}
+
+double differentialThreshold(const RelayDifferential& element, double restraint) {
+    const double biased = restraint <= element.breakpoint
+        ? element.slope1 * restraint
+        : element.slope1 * element.breakpoint + element.slope2 * (restraint - element.breakpoint);
+    return std::max(element.pickup, biased);
+}
+
+// Definite-time stage: starts timing on pickup, operates once `delay` has run
+bool definiteTime(bool picked, double now, double delay, double& since) {
+    if (!picked) {
+        since = -1.0;
+        return false;
+    }
+    if (since < 0.0) {
+        since = now;
+    }
+    return now - since >= delay - TimeEpsilon;
+}
+
+} // namespace
+
+RelayEmulator::RelayEmulator(std::shared_ptr<Clock> clock)
+    : clock_(clock ? std::move(clock) : systemClock()),
+      framesReceived_(0), framesProcessed_(0), sampleGaps_(0), gooseSent_(0), sendErrors_(0),
+      pending_(0), startNs_(0), thread_(), threadStarted_(false), running_(false), stop_(false) {
+}
+
+RelayEmulator::~RelayEmulator() {
+    stop();
+}
+
+bool RelayEmulator::validate(const RelayConfig& config, std::string& error) {
+    if (config.name.empty()) {
+        error = "relay name is empty";
+        return false;
+    }
+    const std::string prefix = config.name + ": ";
+    if (!(config.sampleRate > 0.0) || config.sampleRate > 100000.0) {
+        error = prefix + "sampleRate must be in (0, 100000]";
+        return false;
+    }
+    if (!(config.nominalFrequency >= 45.0 && config.nominalFrequency <= 65.0)) {
+        error = prefix + "nominalFrequency must be in [45, 65]";
+        return false;
+    }
+    for (size_t k = 0; k < 3; ++k) {
+        if (config.currentChannels[k] > MaxChannel || config.voltageChannels[k] > MaxChannel) {
+            error = prefix + "channel indexes must be <= 63";
+            return false;
+        }
+    }
+    if (!(config.currentScale > 0.0) || !std::isfinite(config.currentScale) ||
+        !(config.voltageScale > 0.0) || !std::isfinite(config.voltageScale)) {
+        error = prefix + "currentScale and voltageScale must be positive";
+        return false;
+    }
+    if (!config.overcurrent.enabled && !config.distance.enabled && !config.differential.enabled) {
+        error = prefix + "no protection element enabled";
+        return false;
+    }
+
+    const RelayOvercurrent& oc = config.overcurrent;
+    if (oc.enabled) {
+        if (!(oc.settings.pickupCurrent > 0.0) || !(oc.settings.TMS >= 0.0) ||
+            !(oc.instantaneousPickup >= 0.0) || !(oc.instantaneousDelay >= 0.0)) {
+            error = prefix + "overcurrent pickups, TMS and delay must be non-negative (pickup > 0)";
+            return false;
+        }
+    }
+
+    const RelayDistance& distance = config.distance;
+    if (distance.enabled) {
+        if (distance.zones.empty() || distance.zones.size() > MaxZones) {
+            error = prefix + "distance needs 1..8 zones";
+            return false;
+        }
+        if (!(distance.minCurrent > 0.0) || !std::isfinite(distance.k0.real()) || !std::isfinite(distance.k0.imag())) {
+            error = prefix + "distance minCurrent must be positive and k0 finite";
+            return false;
+        }
+        for (const RelayDistanceZone& zone : distance.zones) {
+            if (!(zone.reach > 0.0) || !(zone.angle > 0.0 && zone.angle <= 90.0) || !(zone.delay >= 0.0)) {
+                error = prefix + "zone reach must be positive, angle in (0, 90] and delay non-negative";
+                return false;
+            }
+            if (zone.shape == RelayDistanceZone::Shape::Quadrilateral && !(zone.resistiveReach > 0.0)) {
+                error = prefix + "quadrilateral zones need a positive resistiveReach";
+                return false;
+            }
+        }
+    }
+
+    const RelayDifferential& differential = config.differential;
+    if (differential.enabled) {
+        if (!(differential.pickup > 0.0) || !(differential.slope1 >= 0.0) || !(differential.slope2 >= 0.0) ||
+            !(differential.breakpoint >= 0.0) || !(differential.delay >= 0.0)) {
+            error = prefix + "differential pickup must be positive, slopes, breakpoint and delay non-negative";
+            return false;
+        }
+        if (streamKey(differential.remoteDstMac.data(), differential.remoteAppId) ==
+            streamKey(config.svDstMac.data(), config.svAppId)) {
+            error = prefix + "differential remote stream is the local stream";
+            return false;
+        }
+    }
+
+    if (!(config.outputDelay >= 0.0 && config.outputDelay <= 1.0)) {
+        error = prefix + "outputDelay must be in [0, 1] s";
+        return false;
+    }
+    if (config.vlanId > 4095 || config.vlanPriority > 7) {
+        error = prefix + "vlanId must be <= 4095, vlanPriority <= 7";
+        return false;
+    }
+    return true;
+}
+
+void RelayEmulator::setLoopback(std::shared_ptr<FrameLoopback> loopback) {
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    loopback_ = std::move(loopback);
+    if (loopback_) {
+        loopback_->attach([this](const uint8_t* frame, size_t length) {
+            receive(frame, length);
+        });
+    }
+}
+
+uint64_t RelayEmulator::streamKey(const uint8_t* mac, uint16_t appId) {
+    uint64_t key = 0;
+    for (size_t i = 0; i < 6; ++i) {
+        key = key << 8 | mac[i];
+    }
+    return key << 16 | appId;
+}
+
+RelayEmulator::Input RelayEmulator::subscribe(uint64_t key, double sampleRate, double nominalFrequency,
+                                              uint8_t index, std::string& error) {
+    auto found = streamIndex_.find(key);
+    if (found == streamIndex_.end()) {
+        Stream stream;
+        stream.key = key;
+        stream.sampleRate = sampleRate;
+        stream.samples = 0;
+        stream.origin = -1;
+        stream.lastSmpCnt = -1;
+        stream.frames = 0;
+        found = streamIndex_.emplace(key, streams_.size()).first;
+        streams_.push_back(std::move(stream));
+    }
+    Stream& stream = streams_[found->second];
+    if (stream.sampleRate != sampleRate) {
+        error = "relays reading one stream must agree on its sampleRate";
+    }
+
+    for (size_t c = 0; c < stream.channels.size(); ++c) {
+        if (stream.channels[c].index == index) {
+            return Input{found->second, c};
+        }
+    }
+    vts::analyzer::FrequencyTrackerConfig trackerConfig;
+    trackerConfig.sampleRate = sampleRate;
+    trackerConfig.nominalFrequency = nominalFrequency;
+    if (!stream.channels.empty()) {
+        trackerConfig.loopGain = 0.0;       // Follows the first channel
+    }
+    stream.channels.push_back(Channel{index, vts::analyzer::FrequencyTracker(trackerConfig), {}, false});
+    return Input{found->second, stream.channels.size() - 1};
+}
+
+bool RelayEmulator::build(const std::vector<RelayConfig>& relays, std::string& error) {
+    streams_.clear();
+    streamIndex_.clear();
+    relays_.clear();
+    relays_.reserve(relays.size());
+
+    std::string mismatch;
+    for (const RelayConfig& config : relays) {
+        if (!validate(config, error)) {
+            return false;
+        }
+        Relay relay;
+        relay.config = config;
+        if (relay.config.gocbRef.empty()) {
+            relay.config.gocbRef = config.name + "/LLN0$GO$Trip";
+        }
+
+        const uint64_t local = streamKey(config.svDstMac.data(), config.svAppId);
+        // Voltages first: a new stream tracks frequency on its first channel
+        for (size_t k = 0; k < 3; ++k) {
+            if (config.distance.enabled) {
+                relay.voltage[k] = subscribe(local, config.sampleRate, config.nominalFrequency,
+                                             config.voltageChannels[k], mismatch);
+            }
+            relay.current[k] = subscribe(local, config.sampleRate, config.nominalFrequency,
+                                         config.currentChannels[k], mismatch);
+            if (!config.distance.enabled) {
+                relay.voltage[k] = relay.current[k];
+            }
+            relay.remote[k] = relay.current[k];
+            if (config.differential.enabled) {
+                relay.remote[k] = subscribe(streamKey(config.differential.remoteDstMac.data(),
+                                                      config.differential.remoteAppId),
+                                            config.sampleRate, config.nominalFrequency,
+                                            config.currentChannels[k], mismatch);
+            }
+        }
+        if (!mismatch.empty()) {
+            error = config.name + ": " + mismatch;
+            return false;
+        }
+        streams_[relay.current[0].stream].channels[relay.current[0].channel].evaluate.push_back(relays_.size());
+
+        relay.lastEvaluation = 0.0;
+        relay.overcurrentSince = -1.0;
+        relay.integral = 0.0;
+        relay.instantaneousSince = -1.0;
+        relay.zoneSince.assign(config.distance.zones.size(), -1.0);
+        relay.differentialSince = -1.0;
+        relay.pickupSince = -1.0;
+        relay.state = 0;
+        relay.stNum = 1;
+        relay.pending = false;
+        relay.stats.name = config.name;
+
+        // Ethernet + 802.1Q header, then the GOOSE APDU with an all-false dataset
+        std::vector<uint8_t>& frame = relay.goose;
+        frame.assign(config.gooseDstMac.begin(), config.gooseDstMac.end());
+        frame.insert(frame.end(), config.srcMac.begin(), config.srcMac.end());
+        const uint16_t tci = static_cast<uint16_t>((config.vlanPriority & 0x7) << 13 | (config.vlanId & 0x0FFF));
+        frame.insert(frame.end(), {0x81, 0x00, static_cast<uint8_t>(tci >> 8), static_cast<uint8_t>(tci & 0xFF)});
+        const size_t gooseStart = frame.size();
+
+        const std::vector<Data> dataset(GooseEntries, Data(Data::Type::Boolean));
+        Goose goose("", "", config.gooseAppId, config.vlanId, relay.config.gocbRef, 2000,
+                    config.name + "/LLN0$Trip", relay.config.gocbRef, UtcTime(0, 0), relay.stNum, 0,
+                    false, 1, false, 0, dataset);
+        const std::vector<uint8_t> encoded = goose.getEncoded();
+        frame.insert(frame.end(), encoded.begin(), encoded.end());
+
+        const int t = goose.getParamPos("t");
+        const int stNum = goose.getParamPos("stNum");
+        const int sqNum = goose.getParamPos("sqNum");
+        const int allData = goose.getParamPos("allData");
+        if (t < 0 || stNum < 0 || sqNum < 0 || allData < 0) {
+            error = config.name + ": GOOSE template is missing a patched field";
+            return false;
+        }
+        relay.tPos = gooseStart + static_cast<size_t>(t);
+        relay.stNumPos = gooseStart + static_cast<size_t>(stNum);
+        relay.sqNumPos = gooseStart + static_cast<size_t>(sqNum);
+        relay.dataPos = gooseStart + static_cast<size_t>(allData) + 2;     // 83 01 <value>
+
+        relays_.push_back(std::move(relay));
+    }
+    return true;
+}
+
+bool RelayEmulator::start(const std::vector<RelayConfig>& relays, std::string& error) {
+    stop();
+    if (relays.empty() || relays.size() > RelayEmu_MaxRelays) {
+        error = "relay count must be 1.." + std::to_string(RelayEmu_MaxRelays);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    if (!build(relays, error)) {
+        relays_.clear();
+        streams_.clear();
+        streamIndex_.clear();
+        return false;
+    }
+    framesReceived_ = 0;
+    framesProcessed_ = 0;
+    sampleGaps_ = 0;
+    gooseSent_ = 0;
+    sendErrors_ = 0;
+    pending_ = 0;
+    processing_.reset();
+    startNs_ = monotonicNs();
+
+    if (!loopback_) {
+#ifdef __linux__
+        try {
+            socket_ = std::make_unique<RawSocket>();
+        } catch (const std::exception& e) {
+            error = e.what();
+            return false;
+        }
+        // Only the configured interface (a veth peer of the publisher's, say)
+        if (bind(socket_->socket_id, reinterpret_cast<const sockaddr*>(&socket_->bind_addr),
+                 sizeof(socket_->bind_addr)) != 0) {
+            error = "Failed to bind relay emulator socket: " + std::string(strerror(errno));
+            socket_.reset();
+            return false;
+        }
+#else
+        error = "relay emulator needs a loopback or Linux raw sockets";
+        return false;
+#endif
+    }
+
+    stop_.store(false, std::memory_order_release);
+    running_.store(true, std::memory_order_release);
+    if (!loopback_) {
+        int ret = pthread_create(&thread_, nullptr, &RelayEmulator::threadEntry, this);
+        if (ret != 0) {
+            running_.store(false, std::memory_order_release);
+            socket_.reset();
+            error = "Failed to create relay emulator thread: " + std::string(strerror(ret));
+            return false;
+        }
+        threadStarted_ = true;
+    }
+    LOG_INFO("RELAY", "Emulating %zu relays on %zu SV streams (%s)", relays_.size(), streams_.size(),
+             loopback_ ? "loopback" : "raw socket");
+    return true;
+}
+
+void RelayEmulator::stop() {
+    running_.store(false, std::memory_order_release);
+    stop_.store(true, std::memory_order_release);
+    if (threadStarted_) {
+        pthread_join(thread_, nullptr);
+        threadStarted_ = false;
+    }
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    socket_.reset();
+}
+
+void* RelayEmulator::threadEntry(void* arg) {
+    static_cast<RelayEmulator*>(arg)->run();
+    return nullptr;
+}
+
+void RelayEmulator::run() {
+#ifdef __linux__
+    rt_set_realtime(RelayEmu_ThreadPriority);
+
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = RelayEmu_RxTimeoutUs;
+    if (setsockopt(socket_->socket_id, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == -1) {
+        LOG_WARN("RELAY", "Failed to set SO_RCVTIMEO: %s", strerror(errno));
+    }
+
+    uint8_t buffer[Sniffer_RxSize];
+    while (!stop_.load(std::memory_order_acquire)) {
+        const ssize_t received = recv(socket_->socket_id, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            receive(buffer, static_cast<size_t>(received));
+        } else {
+            poll();
+        }
+    }
+#endif
+}
+
+void RelayEmulator::receive(const uint8_t* frame, size_t length) {
+    if (!running_.load(std::memory_order_acquire) || length < 14) {
+        return;
+    }
+
+    // Only LAN A copies of PRP/HSR frames, so no sample is pushed twice
+    vts::sniffer::RedundancyTag tag;
+    if (!vts::sniffer::parseRedundancyTag(frame, length, tag) || tag.lan != 0) {
+        return;
+    }
+    const size_t end = tag.kind != vts::sniffer::RedundancyTag::Kind::None ? tag.payloadEnd : length;
+    const size_t i = tag.etherTypeOffset;
+
+    // Everything but SV returns before locking: our own trip GOOSE comes back
+    // through a loopback on this thread while rxMutex_ is held
+    if (i + 10 > end || frame[i] != 0x88 || frame[i + 1] != 0xBA) {
+        return;
+    }
+    const uint16_t appId = static_cast<uint16_t>(frame[i + 2] << 8 | frame[i + 3]);
+    const uint64_t key = streamKey(frame, appId);
+
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    ++framesReceived_;
+    auto found = streamIndex_.find(key);
+    if (found != streamIndex_.end()) {
+        const uint64_t begin = monotonicNs();
+        Stream& stream = streams_[found->second];
+        ++stream.frames;
+        processFrame(stream, frame + i + 10, end - i - 10);
+        ++framesProcessed_;
+        processing_.record(static_cast<int64_t>(monotonicNs() - begin));
+    }
+    if (pending_ > 0) {
+        release(clock_->now());
+    }
+}
+
+void RelayEmulator::processFrame(Stream& stream, const uint8_t* pdu, size_t length) {
+    BERReader reader(pdu, length);
+    BERReader savPdu;
+    uint8_t tag;
+    if (!reader.readTLV(tag, savPdu) || tag != 0x60) return;
+
+    BERReader field;
+    uint32_t noAsdu = 0;
+    if (!savPdu.readTLV(tag, field) || tag != 0x80 || !field.readUnsigned(noAsdu)) return;
+    if (!savPdu.readTLV(tag, field)) return;
+    if (tag == 0x81 && !savPdu.readTLV(tag, field)) return;
+    if (tag != 0xA2) return;
+    BERReader seqAsdu = field;
+
+    BERReader asdu;
+    for (uint32_t a = 0; a < noAsdu && !seqAsdu.empty(); ++a) {
+        if (!seqAsdu.readTLV(tag, asdu) || tag != 0x30) return;
+        uint32_t smpCnt = 0;
+        bool haveSmpCnt = false;
+        while (asdu.readTLV(tag, field)) {
+            if (tag == 0x82) {
+                haveSmpCnt = field.readUnsigned(smpCnt);
+            } else if (tag == 0x87) {
+                if (haveSmpCnt) {
+                    processRow(stream, smpCnt, field.current(), field.remaining() / 8);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void RelayEmulator::processRow(Stream& stream, uint32_t smpCnt, const uint8_t* seqData, size_t channels) {
+    const int32_t count = static_cast<int32_t>(smpCnt);
+    if (stream.origin < 0) {
+        stream.origin = count;
+    } else {
+        const int32_t wrap = static_cast<int32_t>(std::lround(stream.sampleRate));
+        if (count != stream.lastSmpCnt + 1 && !(count == 0 && stream.lastSmpCnt == wrap - 1)) {
+            ++sampleGaps_;
+        }
+    }
+    stream.lastSmpCnt = count;
+    ++stream.samples;
+
+    for (Channel& channel : stream.channels) {
+        const double value = channel.index < channels
+            ? static_cast<double>(static_cast<int32_t>(load_be32(seqData + channel.index * 8)))
+            : 0.0;
+        channel.completed = channel.tracker.push(value);
+    }
+    // One frequency per stream, so a phase step on one channel (a fault)
+    // cannot pull that channel's window off the others
+    const Channel& reference = stream.channels.front();
+    if (reference.completed) {
+        for (size_t c = 1; c < stream.channels.size(); ++c) {
+            stream.channels[c].tracker.setFrequency(reference.tracker.frequency());
+        }
+    }
+    // Every channel has this row before any relay looks at them
+    for (const Channel& channel : stream.channels) {
+        if (!channel.completed) continue;
+        const double end = channel.tracker.cycleStart() +
+                           stream.sampleRate / channel.tracker.cycleFrequency();
+        for (size_t relay : channel.evaluate) {
+            evaluate(relay, end);
+        }
+    }
+}
+
+std::complex<double> RelayEmulator::phasor(const Input& input, size_t reference, double atSample) const {
+    const Stream& stream = streams_[input.stream];
+    const vts::analyzer::FrequencyTracker& tracker = stream.channels[input.channel].tracker;
+    if (!tracker.valid()) {
+        return {0.0, 0.0};
+    }
+    if (input.stream != reference) {
+        // Same instant in the other stream's samples, through smpCnt
+        const Stream& local = streams_[reference];
+        const int32_t wrap = static_cast<int32_t>(std::lround(stream.sampleRate));
+        int32_t offset = (local.origin - stream.origin) % wrap;
+        if (offset >= wrap / 2) offset -= wrap;
+        if (offset < -wrap / 2) offset += wrap;
+        atSample += offset;
+    }
+    return tracker.harmonicAt(1, atSample);
+}
+
+void RelayEmulator::evaluate(size_t index, double atSample) {
+    Relay& relay = relays_[index];
+    const RelayConfig& config = relay.config;
+    const size_t local = relay.current[0].stream;
+    const double now = atSample / config.sampleRate;
+    const double dt = now - relay.lastEvaluation;
+    relay.lastEvaluation = now;
+    ++relay.stats.evaluations;
+
+    // RMS phasors in amperes/volts, all referred to the end of this cycle
+    const double currentScale = config.currentScale / Sqrt2;
+    std::array<std::complex<double>, 3> current;
+    double largest = 0.0;
+    for (size_t k = 0; k < 3; ++k) {
+        current[k] = phasor(relay.current[k], local, atSample) * currentScale;
+        relay.stats.current[k] = std::abs(current[k]);
+        largest = std::max(largest, relay.stats.current[k]);
+    }
+    relay.stats.frequency = streams_[local].channels.front().tracker.measuredFrequency();
+
+    bool picked = false;
+    uint8_t operated = 0;
+
+    const RelayOvercurrent& oc = config.overcurrent;
+    if (oc.enabled) {
+        // 51: integrate 1 / t(M) from the evaluation that first saw pickup
+        const double multiple = largest / oc.settings.pickupCurrent;
+        if (multiple > 1.0) {
+            picked = true;
+            const double curve = vts::testers::OvercurrentTester::calculateTripTime(oc.settings, multiple);
+            if (relay.overcurrentSince < 0.0) {
+                relay.overcurrentSince = now;
+                relay.integral = 0.0;
+            } else if (curve > 0.0) {
+                relay.integral += dt / curve;
+            }
+            if (curve <= 0.0 || relay.integral >= 1.0 - TimeEpsilon) {
+                operated |= OvercurrentBit;
+            }
+        } else {
+            relay.overcurrentSince = -1.0;
+            relay.integral = 0.0;
+        }
+
+        // 50
+        const bool instantaneous = oc.instantaneousPickup > 0.0 && largest > oc.instantaneousPickup;
+        picked = picked || instantaneous;
+        if (definiteTime(instantaneous, now, oc.instantaneousDelay, relay.instantaneousSince)) {
+            operated |= OvercurrentBit;
+        }
+    }
+
+    const RelayDistance& distance = config.distance;
+    if (distance.enabled) {
+        const double voltageScale = config.voltageScale / Sqrt2;
+        std::array<std::complex<double>, 3> voltage;
+        for (size_t k = 0; k < 3; ++k) {
+            voltage[k] = phasor(relay.voltage[k], local, atSample) * voltageScale;
+        }
+        const std::complex<double> residual = current[0] + current[1] + current[2];
+
+        // AG BG CG with residual compensation, then AB BC CA
+        std::array<std::complex<double>, 6> loopVoltage;
+        std::array<std::complex<double>, 6> loopCurrent;
+        for (size_t k = 0; k < 3; ++k) {
+            const size_t next = (k + 1) % 3;
+            loopVoltage[k] = voltage[k];
+            loopCurrent[k] = current[k] + distance.k0 * residual;
+            loopVoltage[k + 3] = voltage[k] - voltage[next];
+            loopCurrent[k + 3] = current[k] - current[next];
+        }
+
+        for (size_t z = 0; z < distance.zones.size(); ++z) {
+            bool inside = false;
+            for (size_t loop = 0; loop < 6 && !inside; ++loop) {
+                if (std::abs(loopCurrent[loop]) < distance.minCurrent) continue;
+                inside = insideZone(distance.zones[z], loopVoltage[loop] / loopCurrent[loop]);
+            }
+            picked = picked || inside;
+            // At least two cycles inside: the one straddling fault inception
+            // mixes pre-fault and fault samples and can land anywhere
+            const double delay = std::max(distance.zones[z].delay, dt);
+            if (definiteTime(inside, now, delay, relay.zoneSince[z])) {
+                operated |= DistanceBit;
+            }
+        }
+    }
+
+    const RelayDifferential& differential = config.differential;
+    if (differential.enabled) {
+        // Blocked until the remote end has delivered a full cycle, as on channel loss
+        bool tripping = false;
+        bool remoteValid = true;
+        for (const Input& input : relay.remote) {
+            remoteValid = remoteValid && streams_[input.stream].channels[input.channel].tracker.valid();
+        }
+        for (size_t k = 0; remoteValid && k < 3; ++k) {
+            const std::complex<double> remote = phasor(relay.remote[k], local, atSample) * currentScale;
+            const double operate = std::abs(current[k] + remote);
+            const double restraint = std::abs(current[k] - remote) / 2.0;
+            tripping = tripping || operate > differentialThreshold(differential, restraint);
+        }
+        picked = picked || tripping;
+        if (definiteTime(tripping, now, differential.delay, relay.differentialSince)) {
+            operated |= DifferentialBit;
+        }
+    }
+
+    if (!picked) {
+        relay.pickupSince = -1.0;
+    } else if (relay.pickupSince < 0.0) {
+        relay.pickupSince = now;
+    }
+
+    const uint8_t state = static_cast<uint8_t>(operated | (operated ? TripBit : 0));
+    if (state == relay.state) {
+        return;
+    }
+    if ((state & TripBit) && !(relay.state & TripBit)) {
+        ++relay.stats.trips;
+        relay.stats.lastOperateTime = now - relay.pickupSince;
+    }
+    relay.state = state;
+    relay.stats.tripped = (state & TripBit) != 0;
+    relay.stats.overcurrent = (state & OvercurrentBit) != 0;
+    relay.stats.distance = (state & DistanceBit) != 0;
+    relay.stats.differential = (state & DifferentialBit) != 0;
+
+    // A change while one is waiting goes out with it, carrying the newest state
+    if (!relay.pending) {
+        relay.pending = true;
+        relay.decided = clock_->now();
+        relay.due = relay.decided + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(config.outputDelay));
+        ++pending_;
+        if (config.outputDelay == 0.0) {
+            release(relay.decided);
+        }
+    }
+}
+
+void RelayEmulator::poll() {
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    if (pending_ > 0) {
+        release(clock_->now());
+    }
+}
+
+void RelayEmulator::release(Clock::time_point now) {
+    for (Relay& relay : relays_) {
+        if (relay.pending && relay.due <= now) {
+            relay.pending = false;
+            --pending_;
+            sendGoose(relay, now);
+        }
+    }
+}
+
+void RelayEmulator::sendGoose(Relay& relay, Clock::time_point now) {
+    uint8_t* frame = relay.goose.data();
+    static constexpr uint8_t Bits[GooseEntries] = {TripBit, OvercurrentBit, DistanceBit, DifferentialBit};
+    for (size_t k = 0; k < GooseEntries; ++k) {
+        frame[relay.dataPos + 3 * k] = (relay.state & Bits[k]) ? 0xFF : 0x00;
+    }
+
+    struct timespec utc;
+    clock_gettime(CLOCK_REALTIME, &utc);
+    store_be32(frame + relay.tPos, static_cast<uint32_t>(utc.tv_sec));
+    store_be32(frame + relay.tPos + 4, static_cast<uint32_t>((static_cast<uint64_t>(utc.tv_nsec) << 32) / 1000000000ull));
+    store_be32(frame + relay.stNumPos, ++relay.stNum);
+    store_be32(frame + relay.sqNumPos, 0);
+
+    transmit(frame, relay.goose.size());
+    ++relay.stats.gooseSent;
+    relay.output.record(toNs(now - relay.decided));
+}
+
+void RelayEmulator::transmit(const uint8_t* frame, size_t length) {
+    ++gooseSent_;
+    if (loopback_) {
+        loopback_->send(frame, length);
+        return;
+    }
+#ifdef __linux__
+    if (socket_ && sendto(socket_->socket_id, frame, length, 0,
+                          reinterpret_cast<const sockaddr*>(&socket_->bind_addr),
+                          sizeof(socket_->bind_addr)) < 0) {
+        ++sendErrors_;
+    }
+#endif
+}
+
+RelayEmulatorStats RelayEmulator::getStats() const {
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    RelayEmulatorStats stats;
+    stats.running = running_.load(std::memory_order_acquire);
+    stats.loopback = loopback_ != nullptr;
+    stats.framesReceived = framesReceived_;
+    stats.framesProcessed = framesProcessed_;
+    stats.sampleGaps = sampleGaps_;
+    stats.gooseSent = gooseSent_;
+    stats.sendErrors = sendErrors_;
+    if (startNs_ != 0) {
+        stats.elapsedS = static_cast<double>(monotonicNs() - startNs_) / 1e9;
+    }
+    if (stats.elapsedS > 0.0) {
+        stats.framesPerSecond = static_cast<double>(framesProcessed_) / stats.elapsedS;
+    }
+    stats.processingP50Ns = processing_.percentile(0.50);
+    stats.processingP99Ns = processing_.percentile(0.99);
+    stats.processingMaxNs = processing_.max();
+
+    for (const Relay& relay : relays_) {
+        RelayStats entry = relay.stats;
+        entry.frames = streams_[relay.current[0].stream].frames;
+        entry.outputP50Ns = relay.output.percentile(0.50);
+        entry.outputP99Ns = relay.output.percentile(0.99);
+        entry.outputMaxNs = relay.output.max();
+        stats.relays.push_back(std::move(entry));
+    }
+    return stats;
+}
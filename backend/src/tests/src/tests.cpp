@@ -1,6 +1,7 @@
 
 
 #include "tests.hpp"
+#include "impairment_json.hpp"
 
 #include <nlohmann/json.hpp>
 #include <utility>
@@ -89,11 +90,18 @@ void from_json(const json& j, transient_config& cfg) {
     j.at("timed_start").get_to(cfg.timed_start);
     j.at("start_time").get_to(cfg.start_time);
     j.at("sv_config").get_to(cfg.sv_config);
+    cfg.prerender = j.value("prerender", uint8_t(0));
     
     // Range validation
     if (cfg.file_data_fs == 0) {
         throw std::invalid_argument("transient_config: file_data_fs must be > 0");
     }
+    if (j.contains("impairment")) {
+        std::string error;
+        if (!cfg.impairment.setProfile(j.at("impairment").get<ImpairmentProfile>(), error)) {
+            throw std::invalid_argument("transient_config: impairment: " + error);
+        }
+    }
     // Note: scale is a vector, would need element-wise validation if needed
 }
 
@@ -154,6 +162,7 @@ std::vector<std::unique_ptr<transient_config>> get_transient_test_config(const s
                 cfg->fileName = "files/" + test_entry.at("fileName").get<std::string>();
                 cfg->loop_flag = test_entry.value("loop_flag", uint8_t(0));
                 cfg->interval_flag = test_entry.value("interval_flag", uint8_t(0));
+                cfg->prerender = test_entry.value("prerender", uint8_t(0));
                 cfg->interval = test_entry.value("interval", 0.0);
                 cfg->start_time = test_entry.value("start_time", uint64_t(0));
                 cfg->timed_start = test_entry.value("timed_start", uint32_t(0));
@@ -187,6 +196,14 @@ std::vector<std::unique_ptr<transient_config>> get_transient_test_config(const s
                     cfg->sv_config.noChannels = sv.value("noChannels", uint16_t(0));
                 }
                 
+                if (test_entry.contains("impairment")) {
+                    std::string error;
+                    if (!cfg->impairment.setProfile(test_entry.at("impairment").get<ImpairmentProfile>(), error)) {
+                        cfg->error_msg = "impairment: " + error;
+                        cfg->fileloaded = 0;
+                    }
+                }
+                
                 transient_configs.push_back(std::move(cfg));
             }
         }
@@ -255,6 +272,9 @@ Sv_packet get_sampledValue_pkt_info(SampledValue_Config& svConf){
         }
     }
 
+    // Fixed 9-2LE layouts get an unrolled patch routine
+    select_sv_patch(&packetInfo);
+
     return packetInfo;
 }
 
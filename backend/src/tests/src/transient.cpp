@@ -8,11 +8,33 @@
 #include "rt_utils.hpp"
 #include "logger.hpp"
 #include "metrics.hpp"
+#include "thread_health.hpp"
+#include "byte_order.hpp"
+#include "SV_FrameLayout.hpp"
+#include "general_definition.hpp"
+#include "time_source.hpp"
 #include <time.h>
+#include <unistd.h>
+#include <stdlib.h>
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
+// Every frame of a finite record rendered back to back in one page-aligned
+// block. The timed loop only moves iov_base and sends.
+struct prerendered_frames{
+    uint8_t* data = nullptr;
+    size_t frame_size = 0;
+    size_t count = 0;
+
+    prerendered_frames() = default;
+    prerendered_frames(const prerendered_frames&) = delete;
+    prerendered_frames& operator=(const prerendered_frames&) = delete;
+    ~prerendered_frames(){ free(data); }
+};
+
 struct transient_plan{
     void (*_execute)(transient_plan* plan);
     void execute(){
@@ -20,8 +42,10 @@ struct transient_plan{
     }
 
     std::vector<std::vector<int32_t>>* buffer;
+    prerendered_frames* frames;
     Sv_packet* sv_info;
     RawSocket* socket;
+    ImpairmentStage* impairment;
 
     uint8_t loop_flag;
     uint8_t interval_flag;
@@ -31,7 +55,8 @@ struct transient_plan{
 
     double interval;
     std::atomic<bool>* stop;
-    std::array<std::atomic<uint8_t>, 16>* digital_input;
+    DigitalInputBank* digital_input;
+    DigitalInputMask trip_mask;     // Inputs that end the replay
 
     struct timespec real_time_started, real_time_ended;
     double time_started, time_ended;
@@ -103,85 +128,320 @@ std::vector<std::vector<int32_t>> getTransientData(transient_config* conf){
     return res;
 }
 
-int updatePkt(std::vector<std::vector<int32_t>>* buffer, Sv_packet* pkt_info, int& idx, int& smpCount){
+// Sample rows of the channels that carry data (nullptr for the rest) and the
+// shortest of their lengths, i.e. where the record wraps
+static size_t recordChannels(std::vector<std::vector<int32_t>>* buffer, size_t noChannels, const int32_t** channels){
+
+    size_t length = 0;
+    bool has_data = false;
+    for (size_t cn = 0; cn < noChannels; cn++){
+        if (cn >= buffer->size() || (*buffer)[cn].empty()){
+            channels[cn] = nullptr;
+            continue;
+        }
+        channels[cn] = (*buffer)[cn].data();
+        length = has_data ? std::min(length, (*buffer)[cn].size()) : (*buffer)[cn].size();
+        has_data = true;
+    }
+    return length;
+}
+
+// Advance to the next sample; wraps smpCount at the sample rate and idx at the
+// end of the record. Returns true on record wrap.
+static inline bool advanceSample(size_t length, uint16_t smpRate, int& idx, int& smpCount){
+
+    idx = idx + 1;
+    smpCount = smpCount + 1;
+
+    // Wrap at sample rate (typically 4800) or enforce 16-bit wrap at 65536
+    if (smpCount >= smpRate){
+        smpCount = 0;
+    }
+    if (length > 0 && static_cast<size_t>(idx) >= length){
+        idx = 0;
+        return true;
+    }
+    return false;
+}
+
+// Runtime-generic patch for any ASDU/channel count and field layout
+static int updatePktGeneric(std::vector<std::vector<int32_t>>* buffer, Sv_packet* pkt_info, int& idx, int& smpCount){
+
+    // noChannels is a uint8_t, so the row pointers always fit on the stack
+    const size_t noChannels = pkt_info->noChannels;
+    const int32_t* channels[std::numeric_limits<uint8_t>::max()];
+    const size_t length = recordChannels(buffer, noChannels, channels);
 
     int restartbuffer = 0;
-    for (int num = 0; num < pkt_info->noAsdu; num++){
+    for (size_t num = 0; num < pkt_info->noAsdu; num++){
 
         // Ensure smpCount is within 16-bit range
-        uint16_t safe_smpCount = static_cast<uint16_t>(smpCount);
-        pkt_info->base_pkt[pkt_info->smpCnt_pos[static_cast<size_t>(num)]] = (safe_smpCount >> 8) & 0xFF;
-        pkt_info->base_pkt[pkt_info->smpCnt_pos[static_cast<size_t>(num)]+1] = safe_smpCount & 0xFF;
-
-        for (int cn = 0; cn < pkt_info->noChannels; cn++){
-            if ((*buffer)[static_cast<size_t>(cn)].empty()) continue;
-            size_t data_base = pkt_info->data_pos[static_cast<size_t>(num)];
-            size_t cn_offset = static_cast<size_t>(cn) * 8;
-            int32_t value = (*buffer)[static_cast<size_t>(cn)][static_cast<size_t>(idx)];
-            pkt_info->base_pkt[data_base + cn_offset] = static_cast<uint8_t>((value >> 24) & 0xFF);
-            pkt_info->base_pkt[data_base + cn_offset + 1] = static_cast<uint8_t>((value >> 16) & 0xFF);
-            pkt_info->base_pkt[data_base + cn_offset + 2] = static_cast<uint8_t>((value >> 8) & 0xFF);
-            pkt_info->base_pkt[data_base + cn_offset + 3] = static_cast<uint8_t>(value & 0xFF);
-            restartbuffer = -cn;
-        }
-        idx = idx + 1;
-        smpCount = smpCount + 1;
+        store_be16(&pkt_info->base_pkt[pkt_info->smpCnt_pos[num]], static_cast<uint16_t>(smpCount));
 
-        // Wrap at sample rate (typically 4800) or enforce 16-bit wrap at 65536
-        if (smpCount >= pkt_info->smpRate){
-            smpCount = 0;
+        uint8_t* seq = &pkt_info->base_pkt[pkt_info->data_pos[num]];
+        for (size_t cn = 0; cn < noChannels; cn++){
+            if (channels[cn] == nullptr) continue;
+            store_be32(seq + cn * 8, static_cast<uint32_t>(channels[cn][idx]));
         }
-        if (restartbuffer < 0 && static_cast<size_t>(idx) >= (*buffer)[static_cast<size_t>(-restartbuffer)].size()){
-            idx = 0;
+        if (advanceSample(length, pkt_info->smpRate, idx, smpCount)){
             restartbuffer = 1;
         }
     }
-    return restartbuffer > 0;
+    return restartbuffer;
 }
 
-void simple_replay(transient_plan* plan){
+// Patch for a compile-time layout: offsets are constexpr relative to the
+// first smpCnt, and the ASDU/channel loops unroll
+template <typename Layout>
+static int updatePktFixed(std::vector<std::vector<int32_t>>* buffer, Sv_packet* pkt_info, int& idx, int& smpCount){
 
-    Timer timer;
-    struct timespec t_ini, t_end, t0, t1;
+    const int32_t* channels[Layout::noChannels];
+    const size_t length = recordChannels(buffer, Layout::noChannels, channels);
 
-    long waitPeriod = static_cast<long>(1e9/plan->sv_info->smpRate);
+    uint8_t* asdu = pkt_info->base_pkt.data() + pkt_info->smpCnt_pos[0];
+    int restartbuffer = 0;
+    for (size_t num = 0; num < Layout::noAsdu; num++){
+        Layout::writeAsdu(asdu, static_cast<uint16_t>(smpCount), channels, static_cast<size_t>(idx));
+        asdu += pkt_info->asdu_stride;
+        if (advanceSample(length, pkt_info->smpRate, idx, smpCount)){
+            restartbuffer = 1;
+        }
+    }
+    return restartbuffer;
+}
+
+struct sv_layout_entry{
+    const char* name;
+    uint8_t noAsdu;
+    uint8_t noChannels;
+    bool (*matches)(const uint32_t* smpCnt_pos, const uint32_t* data_pos, size_t count, size_t frameSize, uint32_t& stride);
+    sv_patch_fn patch;
+};
+
+static const sv_layout_entry sv_layouts[] = {
+    {"9-2LE 80 spc",  SvLayout_92LE_80::noAsdu,  SvLayout_92LE_80::noChannels,  &SvLayout_92LE_80::matches,  &updatePktFixed<SvLayout_92LE_80>},
+    {"9-2LE 256 spc", SvLayout_92LE_256::noAsdu, SvLayout_92LE_256::noChannels, &SvLayout_92LE_256::matches, &updatePktFixed<SvLayout_92LE_256>},
+};
+
+void select_sv_patch(Sv_packet* pkt_info){
+
+    pkt_info->patch = &updatePktGeneric;
+    pkt_info->asdu_stride = 0;
+
+    if (pkt_info->smpCnt_pos.size() != pkt_info->noAsdu || pkt_info->data_pos.size() != pkt_info->noAsdu){
+        return;
+    }
+    for (const auto& layout : sv_layouts){
+        uint32_t stride = 0;
+        if (layout.noAsdu == pkt_info->noAsdu && layout.noChannels == pkt_info->noChannels &&
+            layout.matches(pkt_info->smpCnt_pos.data(), pkt_info->data_pos.data(), pkt_info->noAsdu,
+                           pkt_info->base_pkt.size(), stride)){
+            pkt_info->patch = layout.patch;
+            pkt_info->asdu_stride = stride;
+            LOG_INFO("TEST", "SV frame uses fixed %s layout", layout.name);
+            return;
+        }
+    }
+}
+
+int updatePkt(std::vector<std::vector<int32_t>>* buffer, Sv_packet* pkt_info, int& idx, int& smpCount){
+    if (pkt_info->patch == nullptr){
+        return updatePktGeneric(buffer, pkt_info, idx, smpCount);
+    }
+    return pkt_info->patch(buffer, pkt_info, idx, smpCount);
+}
+
+// Render the whole record with the same field layout updatePkt patches, so the
+// replay loop has no per-sample work left. Returns false (and leaves `frames`
+// empty) when the record cannot be pre-rendered; the caller falls back to
+// on-the-fly patching.
+bool prerenderFrames(std::vector<std::vector<int32_t>>* buffer, Sv_packet* pkt_info, prerendered_frames* frames){
+
+    const size_t noAsdu = pkt_info->noAsdu;
+    const size_t noChannels = pkt_info->noChannels;
+    const size_t frame_size = pkt_info->base_pkt.size();
+
+    if (noAsdu == 0 || pkt_info->data_pos.size() < noAsdu || pkt_info->smpCnt_pos.size() < noAsdu){
+        return false;
+    }
+    for (size_t num = 0; num < noAsdu; num++){
+        if (pkt_info->data_pos[num] + noChannels * 8 > frame_size || pkt_info->smpCnt_pos[num] + 2 > frame_size){
+            return false;
+        }
+    }
+
+    size_t n_samples = 0;
+    bool has_data = false;
+    for (size_t cn = 0; cn < noChannels && cn < buffer->size(); cn++){
+        if ((*buffer)[cn].empty()) continue;
+        n_samples = has_data ? std::min(n_samples, (*buffer)[cn].size()) : (*buffer)[cn].size();
+        has_data = true;
+    }
+    const size_t count = n_samples / noAsdu;
+    if (!has_data || count == 0){
+        return false;
+    }
+
+    const size_t total = count * frame_size;
+    if (total > Transient_MaxPrerenderBytes){
+        LOG_WARN("TEST", "Pre-render needs %zu bytes (limit %zu), using on-the-fly replay", total, Transient_MaxPrerenderBytes);
+        return false;
+    }
+
+    long page = sysconf(_SC_PAGESIZE);
+    size_t align = page > 0 ? static_cast<size_t>(page) : 4096;
+    size_t alloc_size = (total + align - 1) / align * align;
+    void* mem = nullptr;
+    if (posix_memalign(&mem, align, alloc_size) != 0){
+        LOG_WARN("TEST", "Pre-render allocation of %zu bytes failed, using on-the-fly replay", alloc_size);
+        return false;
+    }
+
+    frames->data = static_cast<uint8_t*>(mem);
+    frames->frame_size = frame_size;
+    frames->count = count;
+
+    std::vector<int32_t> row(noChannels);
+    uint8_t* frame = frames->data;
+    size_t idx = 0;
+    int smpCount = 0;
+    for (size_t f = 0; f < count; f++){
+        std::memcpy(frame, pkt_info->base_pkt.data(), frame_size);
+        for (size_t num = 0; num < noAsdu; num++){
+            store_be16(frame + pkt_info->smpCnt_pos[num], static_cast<uint16_t>(smpCount));
+
+            uint8_t* seq = frame + pkt_info->data_pos[num];
+            for (size_t cn = 0; cn < noChannels; cn++){
+                // Channels without data keep the template value, as in updatePkt
+                row[cn] = (cn < buffer->size() && !(*buffer)[cn].empty())
+                    ? (*buffer)[cn][idx]
+                    : static_cast<int32_t>(load_be32(seq + cn * 8));
+            }
+            pack_seqdata_be32(seq, row.data(), noChannels);
+
+            idx++;
+            smpCount++;
+            if (smpCount >= pkt_info->smpRate){
+                smpCount = 0;
+            }
+        }
+        frame += frame_size;
+    }
+
+    LOG_INFO("TEST", "Pre-rendered %zu frames (%zu bytes)", count, total);
+    return true;
+}
+
+// CLOCK_MONOTONIC instant of the next whole reference second at least
+// Transient_StartLeadNs away: smpCnt 0 of the replay goes out on it
+static struct timespec nextReferenceSecond(){
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t nowNs = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+
+    std::shared_ptr<TimeSource> source = systemTimeSource();
+    source->refresh(nowNs);
+    const uint64_t at = source->nextSecond(nowNs, Transient_StartLeadNs);
+
+    struct timespec t_ini;
+    t_ini.tv_sec = static_cast<time_t>(at / 1000000000ull);
+    t_ini.tv_nsec = static_cast<long>(at % 1000000000ull);
+    return t_ini;
+}
 
+// First send instant: next whole second, or the configured start time
+struct timespec replayStartTime(transient_plan* plan){
+
+    struct timespec t_ini;
     clock_gettime(CLOCK_MONOTONIC, &t_ini);
 
     if (!plan->timedStart){
-        if (t_ini.tv_nsec > static_cast<long>(5e8)){
-            t_ini.tv_sec += 2;
-        }else{
-            t_ini.tv_sec += 1;
-        }
-        t_ini.tv_nsec = 0;
+        t_ini = nextReferenceSecond();
     }else{
         if (t_ini.tv_sec < plan->start_time.tv_sec){
             t_ini.tv_sec = plan->start_time.tv_sec;
             t_ini.tv_nsec = plan->start_time.tv_nsec;
         }
     }
+    return t_ini;
+}
+
+static inline uint64_t monotonicNs(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Send one frame through the socket's msghdr; iov is restored afterwards
+// because the replay loops keep their current frame there
+static void sendRaw(transient_plan* plan, const uint8_t* frame, size_t length){
+#ifdef __linux__
+    void* base = plan->socket->iov.iov_base;
+    const size_t len = plan->socket->iov.iov_len;
+    plan->socket->iov.iov_base = const_cast<uint8_t*>(frame);
+    plan->socket->iov.iov_len = length;
+    ssize_t sizeSented = sendmsg(plan->socket->socket_id, &plan->socket->msg_hdr, 0);
+    plan->socket->iov.iov_base = base;
+    plan->socket->iov.iov_len = len;
+    if (sizeSented > 0) {
+        METRIC_SENT_FRAME();
+    }
+#else
+    // macOS: Raw sockets not supported, skip packet sending
+    (void)plan;
+    (void)frame;
+    (void)length;
+#endif
+}
+
+// Release due delayed frames, then hand the current frame (socket iov) to the
+// impairment stage; with no profile set this is a plain send, without the
+// clock read
+static inline void sendFrame(transient_plan* plan){
+    if (plan->impairment->idle()){
+        sendRaw(plan, static_cast<const uint8_t*>(plan->socket->iov.iov_base), plan->socket->iov.iov_len);
+        return;
+    }
+    auto send = [plan](const uint8_t* frame, size_t length){ sendRaw(plan, frame, length); };
+    const uint64_t nowNs = monotonicNs();
+    plan->impairment->poll(nowNs, send);
+    plan->impairment->submit(static_cast<const uint8_t*>(plan->socket->iov.iov_base),
+                             plan->socket->iov.iov_len, nowNs, send);
+}
+
+// Frames still held by the impairment stage go out at their deadlines after
+// the last sample, unless the replay was stopped
+static void drainDelayed(transient_plan* plan){
+    uint64_t deadline;
+    while ((deadline = plan->impairment->nextDeadline()) != UINT64_MAX &&
+           !plan->stop->load(std::memory_order_acquire)){
+        rt_sleep_abs(deadline);
+        plan->impairment->poll(monotonicNs(), [plan](const uint8_t* frame, size_t length){
+            sendRaw(plan, frame, length);
+        });
+    }
+}
+
+void simple_replay(transient_plan* plan){
+
+    Timer timer;
+    struct timespec t_ini, t_end, t0, t1;
+
+    long waitPeriod = static_cast<long>(1e9/plan->sv_info->smpRate);
+
+    t_ini = replayStartTime(plan);
 
     int buffer_idx = 0;
     int smpCount = 0;
-    ssize_t sizeSented = 0;
     long nPkts = 0;
     
     updatePkt(plan->buffer, plan->sv_info, buffer_idx, smpCount);
     timer.start_period(t_ini);
     timer.wait_period(waitPeriod);
     clock_gettime(CLOCK_MONOTONIC, &t0);
-    while ((!plan->stop->load(std::memory_order_acquire)) && ((*plan->digital_input)[0].load(std::memory_order_acquire) == 0)){
-#ifdef __linux__
-        sizeSented = sendmsg(plan->socket->socket_id, &plan->socket->msg_hdr, 0);
-#else
-        // macOS: Raw sockets not supported, skip packet sending
-        sizeSented = 0;
-        (void)plan; // Suppress unused warning
-#endif
-        if (sizeSented > 0) {
-            METRIC_SENT_FRAME();
-        }
+    while ((!plan->stop->load(std::memory_order_acquire)) && !plan->digital_input->any(plan->trip_mask)){
+        sendFrame(plan);
         if (updatePkt(plan->buffer, plan->sv_info, buffer_idx, smpCount)){
             break;
         }
@@ -191,6 +451,7 @@ void simple_replay(transient_plan* plan){
     }
     clock_gettime(CLOCK_MONOTONIC, &t1);
     clock_gettime(CLOCK_MONOTONIC, &t_end);
+    drainDelayed(plan);
     plan->real_time_started = t_ini;
     plan->real_time_ended = t_end;
     plan->time_started = t0.tv_sec + t0.tv_nsec * 1e-9;
@@ -198,27 +459,53 @@ void simple_replay(transient_plan* plan){
     return;
 }
 
-void loop_replay(transient_plan* plan){
+void prerendered_replay(transient_plan* plan){
 
     Timer timer;
     struct timespec t_ini, t_end, t0, t1;
 
     long waitPeriod = static_cast<long>(1e9/plan->sv_info->smpRate);
 
-    clock_gettime(CLOCK_REALTIME, &t_end);
-    clock_gettime(CLOCK_MONOTONIC, &t_ini);
+    t_ini = replayStartTime(plan);
 
-    if (t_end.tv_nsec > static_cast<long>(5e8)){
-        t_ini.tv_sec += 2;
-    }else{
-        t_ini.tv_sec += 1;
+    const size_t frame_size = plan->frames->frame_size;
+    uint8_t* frame = plan->frames->data;
+    uint8_t* const frames_end = frame + plan->frames->count * frame_size;
+
+    plan->socket->iov.iov_len = frame_size;
+
+    timer.start_period(t_ini);
+    timer.wait_period(waitPeriod);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while ((!plan->stop->load(std::memory_order_acquire)) && !plan->digital_input->any(plan->trip_mask)){
+        plan->socket->iov.iov_base = frame;
+        sendFrame(plan);
+        frame += frame_size;
+        if (frame >= frames_end){
+            break;
+        }
+        timer.wait_period(waitPeriod);
     }
-    t_ini.tv_nsec = (t_ini.tv_nsec - t_end.tv_nsec);
-    if (t_ini.tv_nsec < 0) t_ini.tv_nsec = static_cast<long>(1e9) - t_ini.tv_nsec;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    drainDelayed(plan);
+    plan->real_time_started = t_ini;
+    plan->real_time_ended = t_end;
+    plan->time_started = t0.tv_sec + t0.tv_nsec * 1e-9;
+    plan->time_ended = t1.tv_sec + t1.tv_nsec * 1e-9;
+}
+
+void loop_replay(transient_plan* plan){
+
+    Timer timer;
+    struct timespec t_ini, t0, t1;
+
+    long waitPeriod = static_cast<long>(1e9/plan->sv_info->smpRate);
+
+    t_ini = nextReferenceSecond();
 
     int buffer_idx = 0;
     int smpCount = 0;
-    ssize_t sizeSented = 0;
 
     int n_stop = 0;
     (void)n_stop; // Currently unused
@@ -227,16 +514,8 @@ void loop_replay(transient_plan* plan){
     timer.start_period(t_ini);
     timer.wait_period(waitPeriod);
     clock_gettime(CLOCK_MONOTONIC, &t0);
-    while ((!plan->stop->load(std::memory_order_acquire)) && ((*plan->digital_input)[0].load(std::memory_order_acquire) == 0)){
-#ifdef __linux__
-        sizeSented = sendmsg(plan->socket->socket_id, &plan->socket->msg_hdr, 0);
-#else
-        sizeSented = 0;
-        (void)plan;
-#endif
-        if (sizeSented > 0) {
-            METRIC_SENT_FRAME();
-        }
+    while ((!plan->stop->load(std::memory_order_acquire)) && !plan->digital_input->any(plan->trip_mask)){
+        sendFrame(plan);
         updatePkt(plan->buffer, plan->sv_info, buffer_idx, smpCount);
         timer.wait_period(waitPeriod);
     }
@@ -252,18 +531,21 @@ void interval_replay(transient_plan* plan){
 }
 
 
-transient_plan create_plan(transient_config* conf, std::vector<std::vector<int32_t>>* data, Sv_packet* sv_info, RawSocket *socket){
+transient_plan create_plan(transient_config* conf, std::vector<std::vector<int32_t>>* data, prerendered_frames* frames, Sv_packet* sv_info, RawSocket *socket){
     
     transient_plan plan;
     plan.buffer = data;
+    plan.frames = frames;
     plan.loop_flag = conf->loop_flag;
     plan.interval_flag = conf->interval_flag;
     plan.interval = conf->interval;
     plan.stop = &conf->stop;
     plan.sv_info = sv_info;
     plan.socket = socket;
+    plan.impairment = &conf->impairment;
     // digital_input is already a pointer in transient_config, so just assign it
     plan.digital_input = conf->digital_input;
+    plan.trip_mask = DigitalInputMask{Transient_TripInput};
 
     plan.timedStart = static_cast<int32_t>(conf->timed_start);
     plan.start_time.tv_sec = static_cast<time_t>(conf->start_time / 1e9);
@@ -273,6 +555,8 @@ transient_plan create_plan(transient_config* conf, std::vector<std::vector<int32
         plan._execute = &loop_replay;
     } else if (plan.interval_flag){
         plan._execute = &interval_replay;
+    } else if (frames != nullptr && frames->count > 0){
+        plan._execute = &prerendered_replay;
     } else {
         plan._execute = &simple_replay;
     }
@@ -290,6 +574,7 @@ void* run_transient_test(void* arg){
     
     // Set real-time priority (slightly lower than sniffer for protection logic)
     rt_set_realtime(Protection_ThreadPriority);  // Default: 90 (configured in general_definition.hpp)
+    ThreadHealth::Scope health("transient-replay");  // Timer reports its missed periods
     
     // Optional: Set CPU affinity to isolate transient thread
     // Example: bind to CPU 4 for dedicated protection processing
@@ -298,15 +583,30 @@ void* run_transient_test(void* arg){
     conf->running.store(true, std::memory_order_release);
 
     //Only for test - initialize digital input
-    (*conf->digital_input)[0].store(0, std::memory_order_relaxed);
+    conf->digital_input->set(Transient_TripInput, false);
+    uint64_t eventCursor = conf->digital_input->eventHead();
 
     std::vector<std::vector<int32_t>> buffer = getTransientData(conf);
     if (buffer.empty()){
         conf->running.store(false, std::memory_order_release);
         return nullptr;
     }
+    // smpSynch reports the reference the replay is aligned to, not a setting
+    conf->sv_config.smpSynch = systemTimeSource()->smpSynch();
     Sv_packet sv_info = get_sampledValue_pkt_info(conf->sv_config);
-    transient_plan plan = create_plan(conf, &buffer, &sv_info, conf->socket);
+
+    // Finite replays can be rendered up front; the sample buffer is no longer
+    // needed afterwards.
+    prerendered_frames frames;
+    if (conf->prerender && !conf->loop_flag && !conf->interval_flag){
+        if (prerenderFrames(&buffer, &sv_info, &frames)){
+            std::vector<std::vector<int32_t>>().swap(buffer);
+        } else {
+            LOG_WARN("TEST", "Pre-render not possible for %s, patching frames on the fly", conf->fileName.c_str());
+        }
+    }
+
+    transient_plan plan = create_plan(conf, &buffer, &frames, &sv_info, conf->socket);
 
     plan.socket->iov.iov_base = (void*)sv_info.base_pkt.data();
     plan.socket->iov.iov_len = sv_info.base_pkt.size();
@@ -318,6 +618,24 @@ void* run_transient_test(void* arg){
     // std::cout << "" << plan.time_ended - plan.time_started << std::endl;
 
     conf->trip_time = plan.time_ended - plan.time_started;
+
+    // The loop only notices the trip at the next sample; use the time the
+    // sniffer actually saw the input change
+    DigitalInputEvent events[64];
+    size_t n;
+    bool tripFound = false;
+    while (!tripFound && (n = conf->digital_input->readEvents(eventCursor, events, 64)) > 0){
+        for (size_t e = 0; e < n; e++){
+            if (events[e].index == Transient_TripInput && events[e].value){
+                double tripAt = static_cast<double>(events[e].timestampNs) * 1e-9;
+                if (tripAt >= plan.time_started && tripAt <= plan.time_ended){
+                    conf->trip_time = tripAt - plan.time_started;
+                }
+                tripFound = true;
+                break;
+            }
+        }
+    }
     conf->time_started = plan.real_time_started;
     conf->time_ended = plan.real_time_started;
 
@@ -0,0 +1,65 @@
+#ifndef BYTE_ORDER_HPP
+#define BYTE_ORDER_HPP
+
+// ============================================================================
+// Big-endian store helpers and seqData packing kernels
+// ============================================================================
+// IEC 61850-9-2 seqData is a run of 8-byte slots per channel:
+//   [INT32 value (BE)] [Quality (BE)]
+// pack_seqdata_be32() writes the value half of `count` consecutive slots from
+// a contiguous int32 row and leaves the quality words untouched. An SSSE3
+// kernel handles four channels per iteration; the scalar tail (and non-x86
+// builds) use bswap.
+// ============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+inline void store_be16(uint8_t* dst, uint16_t value) {
+    dst[0] = static_cast<uint8_t>(value >> 8);
+    dst[1] = static_cast<uint8_t>(value & 0xFF);
+}
+
+inline void store_be32(uint8_t* dst, uint32_t value) {
+    uint32_t swapped = __builtin_bswap32(value);
+    std::memcpy(dst, &swapped, sizeof(swapped));
+}
+
+inline uint32_t load_be32(const uint8_t* src) {
+    uint32_t raw;
+    std::memcpy(&raw, src, sizeof(raw));
+    return __builtin_bswap32(raw);
+}
+
+inline void pack_seqdata_be32(uint8_t* dst, const int32_t* values, size_t count) {
+    size_t i = 0;
+#if defined(__SSSE3__)
+    const __m128i bswap_mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                             11, 10, 9, 8, 15, 14, 13, 12);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        v = _mm_shuffle_epi8(v, bswap_mask);
+
+        uint8_t* slot = dst + i * 8;
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slot));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slot + 16));
+
+        // Gather the existing quality words next to the swapped values:
+        // lo = [v0 q0 v1 q1], hi = [v2 q2 v3 q3] (32-bit lanes)
+        __m128i q01 = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 3, 3, 1));
+        __m128i q23 = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 0, 0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(slot), _mm_unpacklo_epi32(v, q01));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(slot + 16), _mm_unpackhi_epi32(v, q23));
+    }
+#endif
+    for (; i < count; ++i) {
+        store_be32(dst + i * 8, static_cast<uint32_t>(values[i]));
+    }
+}
+
+#endif // BYTE_ORDER_HPP
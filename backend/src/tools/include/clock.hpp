@@ -0,0 +1,125 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Time source for sequence, tester and publisher timing
+ *
+ * Time points share std::chrono::steady_clock's type, so code written
+ * against steady_clock only swaps now()/sleep calls for the clock's.
+ * SteadyClock is wall time (CLOCK_MONOTONIC on Linux); VirtualClock runs
+ * as fast as its threads allow.
+ */
+class Clock {
+public:
+    using duration = std::chrono::steady_clock::duration;
+    using time_point = std::chrono::steady_clock::time_point;
+
+    virtual ~Clock() = default;
+
+    virtual time_point now() const = 0;
+    virtual void sleepUntil(time_point deadline) = 0;
+
+    template <typename Rep, typename Period>
+    void sleepFor(std::chrono::duration<Rep, Period> interval) {
+        sleepUntil(now() + std::chrono::duration_cast<duration>(interval));
+    }
+
+    uint64_t nowNs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now().time_since_epoch()).count());
+    }
+
+    // Calling thread takes part in (leaves) virtual time; no-ops in real time
+    virtual void attach() {}
+    virtual void detach() {}
+
+    virtual bool isVirtual() const { return false; }
+};
+
+/**
+ * @brief Wall-clock time: steady_clock and std::this_thread sleeps
+ */
+class SteadyClock : public Clock {
+public:
+    time_point now() const override;
+    void sleepUntil(time_point deadline) override;
+};
+
+/**
+ * @brief Shared SteadyClock, the default of every clock user
+ */
+std::shared_ptr<Clock> systemClock();
+
+/**
+ * @brief Discrete-event time for faster-than-real-time runs
+ *
+ * Time only moves when every attached thread is asleep in sleepUntil(): it
+ * then jumps to the earliest pending deadline and wakes the threads due at
+ * it. Attached threads therefore run in lockstep and see the same virtual
+ * instants on every run, however long their work between sleeps takes.
+ * A thread that sleeps without attaching does not hold time still; with no
+ * attached threads its sleep returns at once. advance() drives time from
+ * outside (tests, single-stepping).
+ *
+ * Attach only threads whose every wait is a sleep on this clock: an attached
+ * thread blocked on anything else (a join, an unrelated condition variable)
+ * stops time for all.
+ */
+class VirtualClock : public Clock {
+public:
+    explicit VirtualClock(time_point start = time_point{});
+
+    VirtualClock(const VirtualClock&) = delete;
+    VirtualClock& operator=(const VirtualClock&) = delete;
+
+    time_point now() const override;
+    void sleepUntil(time_point deadline) override;
+
+    void attach() override;
+    void detach() override;
+    bool isVirtual() const override { return true; }
+
+    /**
+     * @brief Move time forward and release every sleeper due by then
+     */
+    void advance(duration interval);
+
+    size_t participants() const;
+    size_t sleepers() const;
+
+private:
+    void releaseLocked(int64_t nowNs);
+    void stepLocked();
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    int64_t nowNs_;
+    size_t participants_;                       // Attached threads
+    size_t sleepingParticipants_;               // Of which asleep and not yet released
+    std::multimap<int64_t, bool> sleepers_;     // Deadline -> sleeper is attached
+};
+
+/**
+ * @brief Attaches the calling thread to a clock for its scope
+ */
+class ClockParticipant {
+public:
+    explicit ClockParticipant(Clock& clock) : clock_(clock) { clock_.attach(); }
+    ~ClockParticipant() { clock_.detach(); }
+
+    ClockParticipant(const ClockParticipant&) = delete;
+    ClockParticipant& operator=(const ClockParticipant&) = delete;
+
+private:
+    Clock& clock_;
+};
+
+#endif // CLOCK_HPP
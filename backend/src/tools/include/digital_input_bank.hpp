@@ -0,0 +1,131 @@
+#ifndef DIGITAL_INPUT_BANK_HPP
+#define DIGITAL_INPUT_BANK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "general_definition.hpp"
+
+/**
+ * @brief One binary input transition
+ */
+struct DigitalInputEvent {
+    uint64_t timestampNs;   // CLOCK_MONOTONIC time the writer saw the change
+    uint32_t index;         // Input number
+    bool value;             // New state
+};
+
+/**
+ * @brief Set of inputs, stored as (word index, bit mask) pairs sorted by word
+ */
+class DigitalInputMask {
+public:
+    DigitalInputMask() = default;
+    DigitalInputMask(std::initializer_list<size_t> inputs);
+
+    DigitalInputMask& add(size_t input);
+
+    bool empty() const { return words_.empty(); }
+    const std::vector<std::pair<size_t, uint64_t>>& words() const { return words_; }
+
+private:
+    std::vector<std::pair<size_t, uint64_t>> words_;
+};
+
+/**
+ * @brief Binary input bank for GOOSE-mapped signals
+ *
+ * Inputs are packed 64 per atomic word; each word carries a version counter
+ * bumped on every change, so a reader can tell whether a word moved since it
+ * last looked. Consumers either test a mask (one load per word) or drain the
+ * timestamped change events from a lock-free ring.
+ *
+ * Any thread may call set(); every transition is recorded exactly once.
+ */
+class DigitalInputBank {
+public:
+    static constexpr size_t WordBits = 64;
+
+    explicit DigitalInputBank(size_t inputs = DigitalInput_Count,
+                              size_t eventCapacity = DigitalInput_EventCapacity);
+
+    DigitalInputBank(const DigitalInputBank&) = delete;
+    DigitalInputBank& operator=(const DigitalInputBank&) = delete;
+
+    size_t size() const { return inputs_; }
+    size_t wordCount() const { return words_; }
+
+    /**
+     * @brief Set one input
+     * @param input Input number (< size())
+     * @param value New state
+     * @param timestampNs Event time, CLOCK_MONOTONIC nanoseconds
+     * @return true if the state changed
+     */
+    bool set(size_t input, bool value, uint64_t timestampNs);
+    bool set(size_t input, bool value) { return set(input, value, nowNs()); }
+
+    bool get(size_t input) const {
+        return (bits_[input / WordBits].load(std::memory_order_acquire) >> (input % WordBits)) & 1u;
+    }
+
+    uint64_t word(size_t w) const { return bits_[w].load(std::memory_order_acquire); }
+    uint32_t wordVersion(size_t w) const { return versions_[w].load(std::memory_order_acquire); }
+
+    bool any(const DigitalInputMask& mask) const;
+    bool all(const DigitalInputMask& mask) const;
+
+    /**
+     * @brief Reset every input to 0, recording an event for each that was set
+     */
+    void clear();
+
+    /**
+     * @brief Cursor of the next event to be written
+     */
+    uint64_t eventHead() const { return head_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy events from cursor onwards and advance the cursor
+     *
+     * Events overwritten before they were read are skipped and counted.
+     * @param cursor In: first event to read; out: next event to read
+     * @param out Destination array
+     * @param max Capacity of out
+     * @param lost Incremented by the number of skipped events (optional)
+     * @return Number of events copied
+     */
+    size_t readEvents(uint64_t& cursor, DigitalInputEvent* out, size_t max, uint64_t* lost = nullptr) const;
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    struct EventSlot {
+        std::atomic<uint64_t> seq{0};       // 2*ticket+1 while writing, 2*ticket+2 when complete
+        std::atomic<uint64_t> timestampNs{0};
+        std::atomic<uint32_t> index{0};
+        std::atomic<uint8_t> value{0};
+    };
+
+    void pushEvent(uint32_t input, bool value, uint64_t timestampNs);
+
+    size_t inputs_;
+    size_t words_;
+    std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+    std::unique_ptr<std::atomic<uint32_t>[]> versions_;
+
+    size_t eventMask_;
+    std::unique_ptr<EventSlot[]> events_;
+    std::atomic<uint64_t> head_;
+};
+
+#endif // DIGITAL_INPUT_BANK_HPP
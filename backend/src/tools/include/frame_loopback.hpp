@@ -0,0 +1,36 @@
+#ifndef FRAME_LOOPBACK_HPP
+#define FRAME_LOOPBACK_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief In-process stand-in for the NIC in virtual-time runs
+ *
+ * Publishers hand their frames to send() instead of a socket and every
+ * attached receiver gets each frame synchronously on the sending thread, so
+ * a frame arrives at the virtual instant it was sent and the run does not
+ * depend on the network or on privileges to open raw sockets. A receiver
+ * may itself send (a relay emulator answering SV with GOOSE); that frame
+ * reaches every receiver before the outer send() returns.
+ */
+class FrameLoopback {
+public:
+    using Receiver = std::function<void(const uint8_t* frame, size_t length)>;
+
+    void attach(Receiver receiver);
+    void send(const uint8_t* frame, size_t length);
+
+    uint64_t framesSent() const { return framesSent_.load(std::memory_order_relaxed); }
+
+private:
+    std::recursive_mutex mutex_;
+    std::vector<Receiver> receivers_;
+    std::atomic<uint64_t> framesSent_{0};
+};
+
+#endif // FRAME_LOOPBACK_HPP
@@ -2,6 +2,8 @@
 #define GENERAL_DEFINITION_HPP
 
 #include <cstdlib>
+#include <cstdint>
+#include <cstddef>
 #include <string>
 
 // Phase 6: Replace #define with constexpr for type safety and debuggability
@@ -16,9 +18,148 @@ constexpr int Sniffer_NoThreads = 1;
 constexpr int Sniffer_NoTasks = 12;
 constexpr int Sniffer_ThreadPriority = 80;
 constexpr int Sniffer_RxSize = 2048;
+constexpr int Sniffer_MaxGooseEntries = 512;   // allData entries decoded per GOOSE frame
+
+// PRP/HSR duplicate discard: sequence window per source (power of two;
+// 1024 frames = ~71 ms at 14.4 kHz) and number of tracked sources
+constexpr size_t Sniffer_RedundancyWindow = 1024;
+constexpr size_t Sniffer_RedundancySources = 64;
+
+// Passive SV/GOOSE discovery: table size (power of two) and how often a known
+// stream's payload is re-read to pick up svID/confRev/channel changes
+constexpr size_t Sniffer_DiscoveryCapacity = 256;
+constexpr uint64_t Sniffer_DiscoveryRefreshFrames = 4096;
+
+// Binary input bank fed by GOOSE subscriptions: number of inputs and size of
+// the change event ring (power of two)
+constexpr size_t DigitalInput_Count = 4096;
+constexpr size_t DigitalInput_EventCapacity = 4096;
+constexpr size_t Transient_TripInput = 0;     // Input that stops a transient replay
 
 constexpr int Protection_ThreadPriority = 90;
 
+// pcap replay: TX thread priority, frames per sendmmsg() batch, largest
+// replayable frame, frames due within BatchWindow of the first are sent
+// together, last SpinNs of each wait are busy-polled, first frame goes out
+// StartDelay after start
+constexpr int PcapReplay_ThreadPriority = 85;
+constexpr size_t PcapReplay_MaxBatch = 32;
+constexpr size_t PcapReplay_MaxFrameSize = 2048;
+constexpr uint32_t PcapReplay_BatchWindowNs = 5000;
+constexpr uint32_t PcapReplay_SpinNs = 20000;
+constexpr uint64_t PcapReplay_StartDelayNs = 10000000;
+
+// Load generator: TX thread priority, stream and thread caps, frames per
+// sendmmsg() batch, batch window and spin as for pcap replay, first frames
+// go out StartDelay after start, per-stream timing histogram upper bound
+constexpr int LoadGen_ThreadPriority = 85;
+constexpr size_t LoadGen_MaxStreams = 1024;
+constexpr size_t LoadGen_MaxThreads = 16;
+constexpr size_t LoadGen_MaxBatch = 64;
+constexpr uint32_t LoadGen_BatchWindowNs = 5000;
+constexpr uint32_t LoadGen_SpinNs = 20000;
+constexpr uint64_t LoadGen_StartDelayNs = 10000000;
+constexpr int64_t LoadGen_HistogramMaxNs = 500000;
+
+// Relay emulator: RX thread priority, relay cap, receive timeout (bounds how
+// late a delayed trip GOOSE goes out while no frames arrive), trip output and
+// per-frame processing histogram upper bounds
+constexpr int RelayEmu_ThreadPriority = 80;
+constexpr size_t RelayEmu_MaxRelays = 256;
+constexpr int RelayEmu_RxTimeoutUs = 200;
+constexpr int64_t RelayEmu_OutputHistogramMaxNs = 100000000;
+constexpr int64_t RelayEmu_ProcessingHistogramMaxNs = 1000000;
+
+// Test job executor: jobs waiting to run (submits beyond are refused) and
+// finished jobs kept for GET /api/v1/jobs/<id>, oldest dropped first
+constexpr size_t TestJobs_MaxQueued = 16;
+constexpr size_t TestJobs_MaxRetained = 64;
+
+// Test result store: records a query returns unless asked for fewer and the
+// most it returns, most rows the writer puts in one on-disk block, default
+// trip-time histogram bin (s) and the most bins an aggregate returns
+constexpr size_t ResultStore_DefaultLimit = 100;
+constexpr size_t ResultStore_MaxLimit = 10000;
+constexpr size_t ResultStore_MaxBlockRows = 4096;
+constexpr double ResultStore_HistogramBinS = 0.005;
+constexpr size_t ResultStore_MaxHistogramBins = 1000;
+
+// Reference time: cross-timestamp period, clock reads per cross-timestamp
+// (the narrowest monotonic bracket wins), weight of each new rate estimate,
+// offset error taken as a clock step and how long time counts as
+// unsynchronized after one. A PHC is locked once its offset has followed the
+// rate estimate within TimeSource_LockNs for TimeSource_LockRefreshes
+// cross-timestamps in a row while a servo steers it; the servo counts as
+// gone after TimeSource_ServoIdleRefreshes without a frequency change
+constexpr uint64_t TimeSource_RefreshNs = 1000000000;
+constexpr int TimeSource_CrossSamples = 5;
+constexpr double TimeSource_RateGain = 0.5;
+constexpr int64_t TimeSource_StepNs = 1000000;
+constexpr uint64_t TimeSource_SettleNs = 3000000000;
+constexpr int64_t TimeSource_LockNs = 10000;
+constexpr int TimeSource_LockRefreshes = 3;
+constexpr int TimeSource_ServoIdleRefreshes = 5;
+
+// SV publisher on a reference clock: samples it may fall behind (or run
+// ahead) before it realigns smpCnt to the reference second instead of
+// catching up
+constexpr uint32_t SV_MaxCatchUpMs = 20;
+
+// SV tick loop (publisher thread) priority and period. A sample can wait up
+// to one tick for the loop, so it is only a deadline miss once it is more
+// than ThreadHealth_LateNs past that
+constexpr int SV_TickThreadPriority = 85;
+constexpr uint64_t SV_TickPeriodNs = 100000;
+
+// RT self-test: sniffer wakeup period (the 14.4 kHz frame interval, the
+// tightest arrival cadence served), run length at startup and for
+// --rt-selftest, longest run the API accepts, and histogram width and bucket
+// size. Publisher threads are measured on SV_TickPeriodNs
+constexpr uint64_t RtSelfTest_PeriodNs = 69444;
+constexpr uint64_t RtSelfTest_StartupNs = 1000000000;
+constexpr uint64_t RtSelfTest_DurationNs = 10000000000;
+constexpr uint64_t RtSelfTest_MaxDurationNs = 60000000000;
+constexpr int64_t RtSelfTest_HistogramMaxNs = 1000000;
+constexpr int64_t RtSelfTest_HistogramResolutionNs = 1000;
+
+// RT thread health monitor: /proc sampling period, lateness that counts as a
+// deadline miss where a loop's own period is not the deadline (pcap replay,
+// the SV tick loop), runqueue wait within one period taken as CPU
+// contention, and sampling intervals with misses kept per thread
+constexpr uint64_t ThreadHealth_PeriodNs = 1000000000;
+constexpr int64_t ThreadHealth_LateNs = 100000;
+constexpr uint64_t ThreadHealth_RunqueueWaitNs = 100000;
+constexpr size_t ThreadHealth_History = 16;
+
+// Impairment stage: delayed frames held per stage, largest impairable frame,
+// timing wheel slots and slot width (one rotation ~10 ms, longer delays wrap),
+// event ring size (power of two) and the largest delay a profile may ask for
+constexpr size_t Impairment_PoolFrames = 1024;
+constexpr size_t Impairment_MaxFrameSize = 1536;
+constexpr size_t Impairment_WheelSlots = 1024;
+constexpr uint64_t Impairment_WheelTickNs = 10000;
+constexpr size_t Impairment_EventCapacity = 4096;
+constexpr uint64_t Impairment_MaxDelayNs = 1000000000;
+
+// Phase oscillator: samples between rebuilding the recursive rotor from the
+// exact fixed-point phase (bounds rotor drift to ~1e-13)
+constexpr uint32_t Oscillator_RenormInterval = 256;
+
+// Fault transient synthesis: samples generated per block (envelope tables
+// are this long)
+constexpr size_t FaultTransient_BlockSamples = 256;
+
+// WebSocket control channel: highest channel index a phasor delta may
+// address (bounds the resize a single message can cause)
+constexpr size_t Control_MaxChannels = 64;
+
+// Upper bound for a pre-rendered transient replay (all frames held in RAM)
+constexpr size_t Transient_MaxPrerenderBytes = 256u * 1024u * 1024u;
+
+// Least time between arming a transient replay and its first frame, which
+// goes out on the next whole second of reference time after that
+constexpr uint64_t Transient_StartLeadNs = 500000000;
+
 constexpr int PORT = 8080;
 constexpr int MAX_CLIENTS = 10;
 
@@ -0,0 +1,87 @@
+#ifndef IMPAIRMENT_JSON_HPP
+#define IMPAIRMENT_JSON_HPP
+
+#include <nlohmann/json.hpp>
+
+#include "impairment_stage.hpp"
+
+/**
+ * @brief JSON form of an impairment profile; omitted keys keep their defaults.
+ *        Throws nlohmann::json::exception on wrong types; ranges are checked
+ *        by ImpairmentProfile::validate()
+ */
+inline void from_json(const nlohmann::json& j, ImpairmentProfile& p) {
+    p.lossProbability = j.value("lossProbability", p.lossProbability);
+    p.lossBurst = j.value("lossBurst", p.lossBurst);
+    p.duplicateProbability = j.value("duplicateProbability", p.duplicateProbability);
+    p.reorderProbability = j.value("reorderProbability", p.reorderProbability);
+    p.reorderDelayNs = j.value("reorderDelayNs", p.reorderDelayNs);
+    p.delayNs = j.value("delayNs", p.delayNs);
+    p.jitterNs = j.value("jitterNs", p.jitterNs);
+    p.smpCntJumpProbability = j.value("smpCntJumpProbability", p.smpCntJumpProbability);
+    p.smpCntJump = j.value("smpCntJump", p.smpCntJump);
+    p.seed = j.value("seed", p.seed);
+}
+
+inline void to_json(nlohmann::json& j, const ImpairmentProfile& p) {
+    j = nlohmann::json{
+        {"lossProbability", p.lossProbability},
+        {"lossBurst", p.lossBurst},
+        {"duplicateProbability", p.duplicateProbability},
+        {"reorderProbability", p.reorderProbability},
+        {"reorderDelayNs", p.reorderDelayNs},
+        {"delayNs", p.delayNs},
+        {"jitterNs", p.jitterNs},
+        {"smpCntJumpProbability", p.smpCntJumpProbability},
+        {"smpCntJump", p.smpCntJump},
+        {"seed", p.seed},
+        {"active", p.active()}
+    };
+}
+
+inline void to_json(nlohmann::json& j, const ImpairmentCounters& c) {
+    j = nlohmann::json{
+        {"submitted", c.submitted},
+        {"sent", c.sent},
+        {"dropped", c.dropped},
+        {"duplicated", c.duplicated},
+        {"reordered", c.reordered},
+        {"delayed", c.delayed},
+        {"smpCntJumps", c.smpCntJumps},
+        {"overflows", c.overflows},
+        {"pending", c.pending}
+    };
+}
+
+inline void to_json(nlohmann::json& j, const ImpairmentEvent& e) {
+    j = nlohmann::json{
+        {"timestampNs", e.timestampNs},
+        {"frame", e.frame},
+        {"type", impairmentEventName(e.type)},
+        {"value", e.value}
+    };
+    if (e.smpCnt >= 0) {
+        j["smpCnt"] = e.smpCnt;
+    }
+}
+
+/**
+ * @brief Stage state plus the events from cursor onwards (cursor is advanced)
+ */
+inline nlohmann::json impairmentEventsJson(const ImpairmentStage& stage, uint64_t& cursor, size_t max) {
+    std::vector<ImpairmentEvent> events(max);
+    uint64_t lost = 0;
+    const size_t n = stage.readEvents(cursor, events.data(), max, &lost);
+    nlohmann::json list = nlohmann::json::array();
+    for (size_t i = 0; i < n; ++i) {
+        list.push_back(events[i]);
+    }
+    return nlohmann::json{
+        {"events", list},
+        {"next", cursor},
+        {"lost", lost},
+        {"counters", stage.counters()}
+    };
+}
+
+#endif // IMPAIRMENT_JSON_HPP
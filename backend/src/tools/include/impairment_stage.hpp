@@ -0,0 +1,241 @@
+#ifndef IMPAIRMENT_STAGE_HPP
+#define IMPAIRMENT_STAGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "general_definition.hpp"
+#include "rcu_cell.hpp"
+
+/**
+ * @brief What to do to published frames; all probabilities are per frame
+ */
+struct ImpairmentProfile {
+    double lossProbability = 0.0;
+    uint32_t lossBurst = 1;                 // Consecutive frames dropped per loss event
+    double duplicateProbability = 0.0;      // Send the frame twice
+    double reorderProbability = 0.0;        // Hold the frame back by reorderDelayNs
+    uint64_t reorderDelayNs = 500000;
+    uint64_t delayNs = 0;                   // Added to every frame
+    uint64_t jitterNs = 0;                  // Uniform 0..jitterNs on top of delayNs
+    double smpCntJumpProbability = 0.0;     // SV only: shift this frame's smpCnt
+    int32_t smpCntJump = 1;
+    uint64_t seed = 1;                      // Same seed + same frames = same impairments
+
+    bool active() const {
+        return lossProbability > 0.0 || duplicateProbability > 0.0 || reorderProbability > 0.0 ||
+               delayNs > 0 || jitterNs > 0 || smpCntJumpProbability > 0.0;
+    }
+
+    /**
+     * @brief Check ranges
+     * @return Empty string if valid, else the reason
+     */
+    std::string validate() const;
+};
+
+enum class ImpairmentEventType : uint8_t {
+    Profile,        // New profile took effect (value = version)
+    Drop,           // value = frames left in the burst
+    Duplicate,
+    Reorder,        // value = extra delay in ns
+    SmpCntJump,     // value = applied shift
+    Overflow        // Delay pool full, frame dropped
+};
+
+const char* impairmentEventName(ImpairmentEventType type);
+
+/**
+ * @brief One injected impairment, for correlation with relay records
+ */
+struct ImpairmentEvent {
+    uint64_t timestampNs;                   // CLOCK_REALTIME
+    uint64_t frame;                         // Submission number, counting frames the stage was not idle() for
+    int32_t smpCnt;                         // First smpCnt of an SV frame, -1 otherwise
+    ImpairmentEventType type;
+    int64_t value;
+};
+
+// Frames submitted while idle() go straight out and are not counted
+struct ImpairmentCounters {
+    uint64_t submitted = 0;
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+    uint64_t duplicated = 0;
+    uint64_t reordered = 0;
+    uint64_t delayed = 0;
+    uint64_t smpCntJumps = 0;
+    uint64_t overflows = 0;
+    uint64_t pending = 0;
+};
+
+/**
+ * @brief Frame impairment between generation and transmission
+ *
+ * A publisher hands every frame to submit() instead of sending it, and calls
+ * poll() on each tick to release delayed frames. Loss, duplication, smpCnt
+ * shifts and the per-frame delay are drawn from a seeded splitmix64
+ * generator, so a profile replays the same impairment pattern every run.
+ * Delayed frames are copied into a preallocated pool and parked on a hashed
+ * timing wheel (Impairment_WheelTickNs slots, sorted within a slot); they go
+ * out on the first poll() at or after their deadline, so delay resolution is
+ * the caller's tick. With jitter, frames may overtake each other.
+ *
+ * The profile lives in an RcuCell: setProfile() may be called from any
+ * thread and takes effect on the next submit(). With an inactive profile and
+ * nothing pending the stage is idle(): submit() then costs one version load
+ * before calling send and is not counted, and callers skip poll() and the
+ * clock read behind nowNs. submit()/poll() belong to the publishing thread;
+ * events and counters may be read from anywhere.
+ */
+class ImpairmentStage {
+public:
+    explicit ImpairmentStage(size_t poolFrames = Impairment_PoolFrames,
+                             size_t eventCapacity = Impairment_EventCapacity);
+
+    ImpairmentStage(const ImpairmentStage&) = delete;
+    ImpairmentStage& operator=(const ImpairmentStage&) = delete;
+
+    /**
+     * @brief Switch profile (validated; returns false and sets error if invalid)
+     */
+    bool setProfile(const ImpairmentProfile& profile, std::string& error);
+    ImpairmentProfile profile() const { return *profile_.load(); }
+    uint64_t profileVersion() const { return profile_.version(); }
+
+    /**
+     * @brief Impair one frame; send(const uint8_t*, size_t) is called for
+     *        every copy that goes out now
+     * @param nowNs CLOCK_MONOTONIC time of the submission
+     */
+    template <typename Send>
+    void submit(const uint8_t* frame, size_t length, uint64_t nowNs, Send&& send) {
+        if (idle()) {
+            send(frame, length);
+            return;
+        }
+        const ImpairmentProfile& profile = refresh();
+        if (!active_) {
+            send(frame, length);    // Switched to an inactive profile
+            return;
+        }
+        const Verdict verdict = impair(profile, frame, length, nowNs);
+        for (uint32_t i = 0; i < verdict.copies; ++i) {
+            send(verdict.data, length);
+        }
+    }
+
+    /**
+     * @brief Frames go straight to send: inactive profile, nothing pending
+     *        and no profile switch waiting (one version load)
+     *
+     * Publishing thread only, like submit().
+     */
+    bool idle() const { return !active_ && profile_.version() == reader_.version(); }
+
+    /**
+     * @brief Send every delayed frame whose deadline is at or before nowNs
+     */
+    template <typename Send>
+    void poll(uint64_t nowNs, Send&& send) {
+        if (pending_ == 0) {
+            return;
+        }
+        int32_t entry;
+        while ((entry = popDue(nowNs)) >= 0) {
+            send(entryData(entry), entries_[static_cast<size_t>(entry)].length);
+            release(entry);
+        }
+    }
+
+    /**
+     * @brief Deadline of the earliest delayed frame, UINT64_MAX if none
+     */
+    uint64_t nextDeadline() const;
+
+    ImpairmentCounters counters() const;
+
+    /**
+     * @brief Cursor of the next event to be written
+     */
+    uint64_t eventHead() const { return head_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy events from cursor onwards and advance the cursor
+     * @param lost Incremented by events overwritten before they were read (optional)
+     * @return Number of events copied
+     */
+    size_t readEvents(uint64_t& cursor, ImpairmentEvent* out, size_t max, uint64_t* lost = nullptr) const;
+
+    /**
+     * @brief Offset of the first smpCnt value in an SV frame, 0 if not SV
+     * @param offsets Filled with the smpCnt offset of every ASDU (optional)
+     */
+    static size_t findSmpCnt(const uint8_t* frame, size_t length, std::vector<size_t>* offsets = nullptr);
+
+private:
+    struct Verdict {
+        const uint8_t* data;
+        uint32_t copies;
+    };
+
+    struct Entry {
+        uint64_t deadlineNs;
+        size_t length;
+        int32_t next;                       // Next entry in the wheel slot or free list
+    };
+
+    struct EventSlot {
+        std::atomic<uint64_t> seq{0};       // 2*ticket+1 while writing, 2*ticket+2 when complete
+        std::atomic<uint64_t> timestampNs{0};
+        std::atomic<uint64_t> frame{0};
+        std::atomic<int32_t> smpCnt{0};
+        std::atomic<uint8_t> type{0};
+        std::atomic<int64_t> value{0};
+    };
+
+    const ImpairmentProfile& refresh();
+    Verdict impair(const ImpairmentProfile& profile, const uint8_t* frame, size_t length, uint64_t nowNs);
+    bool schedule(const uint8_t* frame, size_t length, uint64_t deadlineNs);
+    int32_t popDue(uint64_t nowNs);
+    void release(int32_t entry);
+    uint8_t* entryData(int32_t entry) { return pool_.data() + static_cast<size_t>(entry) * Impairment_MaxFrameSize; }
+    void pushEvent(ImpairmentEventType type, uint64_t frame, int32_t smpCnt, int64_t value);
+    uint64_t nextRandom();
+    double uniform() { return static_cast<double>(nextRandom() >> 11) * (1.0 / 9007199254740992.0); }
+
+    RcuCell<ImpairmentProfile> profile_;
+    RcuCell<ImpairmentProfile>::Reader reader_;
+    bool active_;
+    uint64_t rng_;
+    uint32_t burstLeft_;
+
+    std::vector<uint8_t> pool_;
+    std::vector<Entry> entries_;
+    int32_t free_;
+    std::vector<int32_t> wheel_;            // Slot heads, sorted by deadline
+    uint64_t scanTick_;
+    size_t pending_;
+    std::vector<uint8_t> scratch_;          // Patched copy sent without delay
+    std::vector<size_t> smpCntOffsets_;
+
+    std::atomic<uint64_t> submitted_;
+    std::atomic<uint64_t> sent_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> duplicated_;
+    std::atomic<uint64_t> reordered_;
+    std::atomic<uint64_t> delayed_;
+    std::atomic<uint64_t> smpCntJumps_;
+    std::atomic<uint64_t> overflows_;
+    std::atomic<uint64_t> pendingCount_;
+
+    size_t eventMask_;
+    std::unique_ptr<EventSlot[]> events_;
+    std::atomic<uint64_t> head_;
+};
+
+#endif // IMPAIRMENT_STAGE_HPP
@@ -0,0 +1,86 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Fixed-bucket histogram of signed timing errors in nanoseconds
+ *
+ * Buckets are `resolutionNs` wide between minNs and maxNs; samples outside
+ * the range are clamped to the edge buckets but min()/max() stay exact.
+ * Recording is O(1) and allocation-free, so it can run on an RT thread.
+ * Not thread-safe: copy it out from the owning thread to report.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram(int64_t minNs = -1000000, int64_t maxNs = 10000000, int64_t resolutionNs = 1000)
+        : minNs_(minNs), resolutionNs_(resolutionNs > 0 ? resolutionNs : 1),
+          buckets_(static_cast<size_t>((maxNs - minNs) / resolutionNs_) + 1, 0) {
+        reset();
+    }
+
+    void reset() {
+        std::fill(buckets_.begin(), buckets_.end(), 0);
+        count_ = 0;
+        sumNs_ = 0;
+        min_ = std::numeric_limits<int64_t>::max();
+        max_ = std::numeric_limits<int64_t>::min();
+    }
+
+    void record(int64_t ns) {
+        int64_t idx = (ns - minNs_) / resolutionNs_;
+        idx = std::max<int64_t>(0, std::min<int64_t>(idx, static_cast<int64_t>(buckets_.size()) - 1));
+        ++buckets_[static_cast<size_t>(idx)];
+        ++count_;
+        sumNs_ += ns;
+        min_ = std::min(min_, ns);
+        max_ = std::max(max_, ns);
+    }
+
+    uint64_t count() const { return count_; }
+    int64_t min() const { return count_ ? min_ : 0; }
+    int64_t max() const { return count_ ? max_ : 0; }
+    double mean() const { return count_ ? static_cast<double>(sumNs_) / static_cast<double>(count_) : 0.0; }
+
+    // Raw buckets, for reports; the first and last also hold clamped samples
+    size_t bucketCount() const { return buckets_.size(); }
+    uint64_t bucket(size_t i) const { return buckets_[i]; }
+    int64_t bucketLowerNs(size_t i) const { return minNs_ + static_cast<int64_t>(i) * resolutionNs_; }
+
+    /**
+     * @brief Value below which the fraction q of samples fall
+     * @param q Quantile in [0, 1]
+     * @return Upper edge of the matching bucket, clamped to [min(), max()];
+     *         max() when it falls in the overflow bucket
+     */
+    int64_t percentile(double q) const {
+        if (count_ == 0) return 0;
+        q = std::max(0.0, std::min(q, 1.0));
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(count_) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+            seen += buckets_[i];
+            if (seen >= rank) {
+                if (i + 1 == buckets_.size()) return max_;  // Overflow bucket
+                const int64_t upper = minNs_ + static_cast<int64_t>(i + 1) * resolutionNs_;
+                return std::max(min_, std::min(upper, max_));
+            }
+        }
+        return max_;
+    }
+
+private:
+    int64_t minNs_;
+    int64_t resolutionNs_;
+    std::vector<uint64_t> buckets_;
+    uint64_t count_;
+    int64_t sumNs_;
+    int64_t min_;
+    int64_t max_;
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
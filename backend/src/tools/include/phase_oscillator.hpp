@@ -0,0 +1,166 @@
+#ifndef PHASE_OSCILLATOR_HPP
+#define PHASE_OSCILLATOR_HPP
+
+#include <cmath>
+#include <cstdint>
+
+#include "general_definition.hpp"
+
+/**
+ * @brief Phase-continuous sine source for sample synthesis
+ *
+ * The phase is kept twice: as a 64-bit fixed-point accumulator (turns *
+ * 2^64, wraps exactly, so precision does not degrade however long the run)
+ * and as a unit rotor (cos, sin) advanced by one complex multiply per
+ * sample. Every Oscillator_RenormInterval samples the rotor is rebuilt from
+ * the accumulator, which bounds the rounding drift of the recursion.
+ *
+ * Frequency changes and linear ramps (ROCOF) only change the per-sample
+ * step, never the phase, so the waveform stays continuous across them.
+ * Not thread-safe; owned by the thread producing samples.
+ */
+class PhaseOscillator {
+public:
+    explicit PhaseOscillator(double sampleRate = 4800.0, double frequency = 50.0, double phaseRad = 0.0)
+        : sampleRate_(sampleRate > 0.0 ? sampleRate : 1.0), phase_(0), stepTurns_(0.0),
+          targetTurns_(0.0), rampTurns_(0.0), sinceRenorm_(0) {
+        setStep(frequency / sampleRate_);
+        setPhase(phaseRad);
+    }
+
+    /**
+     * @brief Restart at the given phase (radians); frequency is kept
+     */
+    void setPhase(double phaseRad) {
+        phase_ = toFixed(phaseRad / TwoPi);
+        renormalize();
+    }
+
+    /**
+     * @brief Step the phase by deltaRad without touching the frequency
+     */
+    void shiftPhase(double deltaRad) {
+        phase_ += toFixed(deltaRad / TwoPi);
+        renormalize();
+    }
+
+    /**
+     * @brief Change frequency from the next sample on, cancelling any ramp
+     */
+    void setFrequency(double hz) {
+        rampTurns_ = 0.0;
+        setStep(hz / sampleRate_);
+    }
+
+    /**
+     * @brief Move linearly to hz at rocofHzPerS (magnitude; sign is implied),
+     *        then hold. A zero rate jumps like setFrequency()
+     */
+    void rampTo(double hz, double rocofHzPerS) {
+        const double target = hz / sampleRate_;
+        const double rate = std::fabs(rocofHzPerS) / (sampleRate_ * sampleRate_);
+        if (rate <= 0.0 || target == stepTurns_) {
+            setFrequency(hz);
+            return;
+        }
+        targetTurns_ = target;
+        rampTurns_ = target > stepTurns_ ? rate : -rate;
+        rampRe_ = std::cos(TwoPi * rampTurns_);
+        rampIm_ = std::sin(TwoPi * rampTurns_);
+    }
+
+    /**
+     * @brief New sample rate; the frequency in Hz and the phase are kept
+     */
+    void setSampleRate(double sampleRate) {
+        if (sampleRate <= 0.0) return;
+        const double hz = frequency();
+        const double target = targetTurns_ * sampleRate_;
+        const double rocof = rampTurns_ * sampleRate_ * sampleRate_;
+        sampleRate_ = sampleRate;
+        setFrequency(hz);
+        if (rocof != 0.0) rampTo(target, rocof);
+    }
+
+    double frequency() const { return stepTurns_ * sampleRate_; }
+    double sampleRate() const { return sampleRate_; }
+    bool ramping() const { return rampTurns_ != 0.0; }
+
+    /**
+     * @brief Current phase in radians, [0, 2*pi)
+     */
+    double phase() const { return static_cast<double>(phase_) * (TwoPi / TwoTo64); }
+    uint64_t phaseFixed() const { return phase_; }
+
+    double cosine() const { return re_; }
+    double sine() const { return im_; }
+
+    /**
+     * @brief Advance one sample
+     */
+    void advance() {
+        const double re = re_ * stepRe_ - im_ * stepIm_;
+        im_ = re_ * stepIm_ + im_ * stepRe_;
+        re_ = re;
+        phase_ += stepFixed_;
+
+        if (rampTurns_ != 0.0) {
+            stepTurns_ += rampTurns_;
+            if ((rampTurns_ > 0.0) == (stepTurns_ >= targetTurns_)) {
+                rampTurns_ = 0.0;
+                setStep(targetTurns_);
+            } else {
+                const double sre = stepRe_ * rampRe_ - stepIm_ * rampIm_;
+                stepIm_ = stepRe_ * rampIm_ + stepIm_ * rampRe_;
+                stepRe_ = sre;
+                stepFixed_ = toFixed(stepTurns_);
+            }
+        }
+
+        if (++sinceRenorm_ >= Oscillator_RenormInterval) {
+            renormalize();
+        }
+    }
+
+private:
+    static constexpr double TwoPi = 6.283185307179586476925286766559;
+    static constexpr double TwoTo64 = 18446744073709551616.0;
+
+    // Wrap turns into [0, 1) and scale to 2^64 (two's complement wrap for negatives)
+    static uint64_t toFixed(double turns) {
+        turns -= std::floor(turns);
+        const double scaled = turns * TwoTo64;
+        return scaled >= TwoTo64 ? 0 : static_cast<uint64_t>(scaled);
+    }
+
+    void setStep(double turns) {
+        stepTurns_ = turns;
+        stepFixed_ = toFixed(turns);
+        stepRe_ = std::cos(TwoPi * turns);
+        stepIm_ = std::sin(TwoPi * turns);
+    }
+
+    void renormalize() {
+        const double angle = phase();
+        re_ = std::cos(angle);
+        im_ = std::sin(angle);
+        if (rampTurns_ != 0.0) {
+            stepRe_ = std::cos(TwoPi * stepTurns_);
+            stepIm_ = std::sin(TwoPi * stepTurns_);
+        }
+        sinceRenorm_ = 0;
+    }
+
+    double sampleRate_;
+    uint64_t phase_;                    // Turns * 2^64
+    uint64_t stepFixed_ = 0;
+    double stepTurns_;                  // Frequency / sample rate
+    double targetTurns_;
+    double rampTurns_;                  // Per-sample change of stepTurns_, 0 when not ramping
+    double re_ = 1.0, im_ = 0.0;        // Rotor at the current phase
+    double stepRe_ = 1.0, stepIm_ = 0.0;
+    double rampRe_ = 1.0, rampIm_ = 0.0;
+    uint32_t sinceRenorm_;
+};
+
+#endif // PHASE_OSCILLATOR_HPP
@@ -0,0 +1,138 @@
+#ifndef RCU_CELL_HPP
+#define RCU_CELL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Read-copy-update holder for configuration read by a real-time thread.
+ *
+ * Writers build a new immutable T and publish it; readers keep using the
+ * snapshot they hold until they refresh between work items, so a reader
+ * never sees a half-updated configuration and never takes a lock.
+ *
+ * Replaced snapshots are retired to the writer side and freed by a later
+ * publish() or reclaim() once no reader still holds them, so the reader
+ * thread never runs a destructor.
+ *
+ * @tparam T Configuration type, copied on update()
+ */
+template <typename T>
+class RcuCell {
+public:
+    RcuCell() : current_(std::make_shared<const T>()), version_(1) {}
+
+    explicit RcuCell(T initial)
+        : current_(std::make_shared<const T>(std::move(initial))), version_(1) {}
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    /**
+     * @brief Current snapshot (never null)
+     */
+    std::shared_ptr<const T> load() const {
+        return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Version of the current snapshot, incremented by every publish
+     */
+    uint64_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Replace the snapshot
+     * @return Version of the published snapshot
+     */
+    uint64_t publish(std::shared_ptr<const T> next) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return publishLocked(std::move(next));
+    }
+
+    /**
+     * @brief Copy the current snapshot, apply fn to the copy and publish it
+     *
+     * Concurrent updates are serialized, so none of them is lost.
+     *
+     * @param fn Callable taking T&
+     * @return Version of the published snapshot
+     */
+    template <typename Fn>
+    uint64_t update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto next = std::make_shared<T>(*load());
+        fn(*next);
+        return publishLocked(std::move(next));
+    }
+
+    /**
+     * @brief Free retired snapshots no reader holds anymore
+     * @return Number of snapshots still held by a reader
+     */
+    size_t reclaim() {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return reclaimLocked();
+    }
+
+    /**
+     * @brief Per-thread cached view of an RcuCell
+     *
+     * get() costs one atomic load while the version is unchanged. A Reader
+     * must only be used by one thread.
+     */
+    class Reader {
+    public:
+        explicit Reader(const RcuCell& cell) : cell_(cell), seen_(0) {}
+
+        const T& get() {
+            const uint64_t v = cell_.version();
+            if (v != seen_) {
+                snapshot_ = cell_.load();
+                seen_ = v;
+            }
+            return *snapshot_;
+        }
+
+        uint64_t version() const { return seen_; }
+
+    private:
+        const RcuCell& cell_;
+        std::shared_ptr<const T> snapshot_;
+        uint64_t seen_;
+    };
+
+private:
+    uint64_t publishLocked(std::shared_ptr<const T> next) {
+        auto previous = std::atomic_exchange_explicit(&current_, std::move(next), std::memory_order_acq_rel);
+        retired_.push_back(std::move(previous));
+        const uint64_t v = version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        reclaimLocked();
+        return v;
+    }
+
+    size_t reclaimLocked() {
+        // A retired snapshot is no longer reachable through current_, so a
+        // use count of one cannot grow again
+        size_t kept = 0;
+        for (auto& snapshot : retired_) {
+            if (snapshot.use_count() > 1) {
+                retired_[kept++] = std::move(snapshot);
+            }
+        }
+        retired_.resize(kept);
+        return kept;
+    }
+
+    std::shared_ptr<const T> current_;
+    std::atomic<uint64_t> version_;
+    std::mutex writeMutex_;
+    std::vector<std::shared_ptr<const T>> retired_;
+};
+
+#endif // RCU_CELL_HPP
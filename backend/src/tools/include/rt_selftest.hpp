@@ -0,0 +1,86 @@
+#ifndef RT_SELFTEST_HPP
+#define RT_SELFTEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "general_definition.hpp"
+#include "latency_histogram.hpp"
+
+/**
+ * @brief Whether the publisher tick loop keeps a sample rate's deadlines
+ *
+ * The tick loop sends every sample due since its last wakeup, so a late
+ * wakeup delays samples rather than losing them until the backlog passes
+ * SV_MaxCatchUpMs, where the stream realigns.
+ */
+enum class RateVerdict : uint8_t {
+    Ok,                 // Worst oversleep under ThreadHealth_LateNs: no deadline misses
+    Marginal,           // Samples went out late but were caught up
+    Unsustainable       // The backlog passed the catch-up budget: the stream realigns
+};
+
+struct RtSelfTestConfig {
+    std::vector<int> publisherCpus;     // Empty: one unpinned thread
+    std::vector<int> snifferCpus;
+    uint64_t durationNs = RtSelfTest_DurationNs;
+    uint64_t tickNs = SV_TickPeriodNs;          // Publisher threads: relative sleep per tick
+    uint64_t periodNs = RtSelfTest_PeriodNs;    // Sniffer threads: absolute wakeup period
+};
+
+struct RtSelfTestThread {
+    std::string role;                   // "publisher" or "sniffer"
+    int cpu = -1;                       // -1: unpinned
+    bool pinned = false;
+    bool realtime = false;              // SCHED_FIFO granted
+    uint64_t periodNs = 0;              // Tick (publisher) or wakeup period (sniffer)
+    uint64_t overruns = 0;              // Wakeups a whole period or more late
+    LatencyHistogram latency{0, RtSelfTest_HistogramMaxNs, RtSelfTest_HistogramResolutionNs};
+};
+
+struct RtSelfTestReport {
+    uint64_t tickNs = 0;
+    uint64_t periodNs = 0;
+    uint64_t durationNs = 0;
+    double finishedAt = 0.0;            // Unix seconds
+    std::vector<RtSelfTestThread> threads;
+
+    // Largest wakeup latency of the role's threads (of all threads if none has it)
+    int64_t worstNs(const std::string& role) const;
+
+    // Judged on the publisher threads' worst oversleep and the measured tick
+    RateVerdict verdict(uint32_t sampleRate) const;
+
+    nlohmann::json toJson() const;
+};
+
+/**
+ * @brief Measure wakeup latency on the given cores
+ *
+ * cyclictest in-process: one thread per configured core (one unpinned
+ * thread for a role with none), each pinned and at its role's SCHED_FIFO
+ * priority. Publisher threads wait as the SV tick loop does, a relative
+ * sleepFor(tickNs) on the system clock, and record how far past the tick
+ * they woke; sniffer threads wake every periodNs through Timer
+ * (clock_nanosleep with TIMER_ABSTIME) and record how late they woke. All
+ * threads run at once, as publisher and sniffer do. Blocks for durationNs.
+ */
+RtSelfTestReport runRtSelfTest(const RtSelfTestConfig& config);
+
+/**
+ * @brief Verdict for a publisher oversleeping by up to worstNs past tickNs
+ *
+ * A sample due just after a wakeup waits tickNs + worstNs for the next one.
+ */
+RateVerdict rateVerdict(int64_t worstNs, uint32_t sampleRate, uint64_t tickNs = SV_TickPeriodNs);
+std::string rateVerdictToString(RateVerdict verdict);
+
+/**
+ * @brief Parse a core list such as "2,3" or "2-5,8"
+ * @return false on a malformed list (cpus left unchanged)
+ */
+bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+
+#endif // RT_SELFTEST_HPP
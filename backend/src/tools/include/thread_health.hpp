@@ -0,0 +1,84 @@
+#ifndef THREAD_HEALTH_HPP
+#define THREAD_HEALTH_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Scheduler counters of one thread, cumulative since it started
+ */
+struct ThreadCounters {
+    uint64_t runNs = 0;                 // On a CPU (schedstat)
+    uint64_t runqueueWaitNs = 0;        // Runnable but waiting for a CPU (schedstat)
+    uint64_t timeslices = 0;            // Times scheduled in (schedstat)
+    uint64_t voluntarySwitches = 0;     // Blocked or slept (status)
+    uint64_t involuntarySwitches = 0;   // Preempted (status)
+    uint64_t minorFaults = 0;           // (stat)
+    uint64_t majorFaults = 0;           // Waited on I/O for a page (stat)
+    int cpu = -1;                       // Last ran on (stat)
+};
+
+/**
+ * @brief Read /proc/self/task/<tid>/{schedstat,stat,status}
+ * @return false if the thread is gone or /proc is unavailable (non-Linux)
+ */
+bool readThreadCounters(int tid, ThreadCounters& counters);
+
+/**
+ * @brief Health of the registered RT threads (sniffer, replays, publisher)
+ *
+ * A thread registers itself with a Scope for as long as it runs. Its loops
+ * report deadline misses through recordMiss(): a thread-local slot and two
+ * relaxed atomics, so it is safe on the RT path. A background thread (start())
+ * reads each registered thread's /proc counters every ThreadHealth_PeriodNs
+ * and sets the misses of each interval against the preemptions, page faults
+ * and runqueue wait seen in the same interval.
+ *
+ * The counters come from /proc rather than getrusage(RUSAGE_THREAD), which
+ * only reports on the calling thread; status carries the same context
+ * switch counts. Sampling costs a few file reads per thread per period.
+ */
+class ThreadHealth {
+public:
+    struct Entry;
+
+    /**
+     * @brief Registers the calling thread until destroyed
+     *
+     * A later registration under the same name replaces the entry once this
+     * one has ended, so restarted threads keep one row.
+     */
+    class Scope {
+    public:
+        explicit Scope(const std::string& name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::shared_ptr<Entry> entry_;
+    };
+
+    /**
+     * @brief Count a deadline missed by latenessNs on the calling thread
+     *
+     * No-op on threads that are not registered.
+     */
+    static void recordMiss(int64_t latenessNs);
+
+    // Background sampler; stop() joins it
+    static void start();
+    static void stop();
+
+    // One sampling pass, as the background thread does
+    static void sample();
+
+    // Per-thread counters, last interval and miss correlation
+    static nlohmann::json toJson();
+
+    ThreadHealth() = delete;
+};
+
+#endif // THREAD_HEALTH_HPP
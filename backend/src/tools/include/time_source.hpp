@@ -0,0 +1,172 @@
+#ifndef TIME_SOURCE_HPP
+#define TIME_SOURCE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "general_definition.hpp"
+#include "rcu_cell.hpp"
+
+/**
+ * @brief How well the reference follows grid time, valued as 9-2 smpSynch
+ */
+enum class SyncState : uint8_t {
+    None = 0,           // Free-running, unreadable, or settling after a step
+    Local = 1,          // Host clock synchronized by its own service (NTP/PTP)
+    Global = 2          // PTP hardware clock locked by its servo
+};
+
+struct TimeSourceStatus {
+    std::string reference;              // "phc:/dev/ptp0", "CLOCK_TAI", "none"
+    SyncState state = SyncState::None;
+    int64_t offsetNs = 0;               // Reference minus CLOCK_MONOTONIC
+    double driftPpm = 0.0;              // Reference rate against CLOCK_MONOTONIC
+    int64_t bracketNs = 0;              // Last cross-timestamp's monotonic read window
+    uint64_t refreshes = 0;
+    uint64_t steps = 0;                 // Reference jumps seen
+    uint64_t failures = 0;              // Unreadable reference
+};
+
+/**
+ * @brief Lock evidence for a PTP hardware clock
+ *
+ * A free-running PHC reads back as well as a locked one, so reading it is
+ * no evidence of sync. It counts as locked while a servo (ptp4l, phc2sys)
+ * steers it, seen as its frequency adjustment changing within the last
+ * TimeSource_ServoIdleRefreshes cross-timestamps, and its offset has
+ * followed the rate estimate within TimeSource_LockNs for
+ * TimeSource_LockRefreshes cross-timestamps in a row.
+ */
+class PhcLockDetector {
+public:
+    /**
+     * @param frequency The PHC's frequency adjustment (timex.freq)
+     * @param residualNs Offset error left after the rate estimate;
+     *        INT64_MAX when there is none yet
+     * @return Global while locked, None otherwise
+     */
+    SyncState update(long frequency, int64_t residualNs);
+
+    // Forget all evidence (unreadable clock, step)
+    void reset();
+
+    bool locked() const;
+
+private:
+    bool haveFrequency_ = false;
+    long frequency_ = 0;
+    int sinceAdjust_ = TimeSource_ServoIdleRefreshes;   // Cross-timestamps since it last changed
+    int stable_ = 0;                                    // Residuals within TimeSource_LockNs in a row
+};
+
+/**
+ * @brief Reference (grid) time mapped onto CLOCK_MONOTONIC
+ *
+ * The reference is a PTP hardware clock (/dev/ptpN, kept on grid time by
+ * ptp4l) or, as a local stand-in, CLOCK_TAI. It is only read when
+ * refresh() cross-timestamps it, at most every TimeSource_RefreshNs: a few
+ * monotonic/reference/monotonic reads, the narrowest bracket kept. The
+ * offset and rate found are published as an immutable mapping (RcuCell),
+ * so toReference() costs readers a snapshot load and no clock read.
+ *
+ * An offset error beyond TimeSource_StepNs is a step of the reference
+ * (servo stepping the PHC, host clock set): the mapping restarts from the
+ * new offset and the state reads None for TimeSource_SettleNs. CLOCK_TAI is
+ * Local while the kernel reports the host clock synchronized and None
+ * otherwise; a PHC is Global while PhcLockDetector finds it locked and None
+ * otherwise.
+ */
+class TimeSource {
+public:
+    /**
+     * @brief No reference: CLOCK_MONOTONIC itself, never synchronized
+     */
+    TimeSource();
+    ~TimeSource();
+
+    TimeSource(const TimeSource&) = delete;
+    TimeSource& operator=(const TimeSource&) = delete;
+
+    /**
+     * @brief PTP hardware clock (Linux only)
+     * @return nullptr with the reason in error if the device cannot be read
+     */
+    static std::shared_ptr<TimeSource> openPhc(const std::string& device, std::string& error);
+
+    /**
+     * @brief CLOCK_TAI (the system clock where there is none)
+     */
+    static std::shared_ptr<TimeSource> systemTai();
+
+    /**
+     * @brief Cross-timestamp if the last one is older than the refresh period
+     *
+     * Cheap otherwise; callable from any thread.
+     * @return true if a cross-timestamp was taken
+     */
+    bool refresh(uint64_t monotonicNs);
+
+    /**
+     * @brief Cross-timestamp now
+     */
+    void update();
+
+    int64_t toReference(uint64_t monotonicNs) const;
+    uint64_t toMonotonic(int64_t referenceNs) const;
+
+    /**
+     * @brief Monotonic time of the first whole reference second at least
+     *        minLeadNs after monotonicNs
+     */
+    uint64_t nextSecond(uint64_t monotonicNs, uint64_t minLeadNs) const;
+
+    SyncState state() const;
+    uint8_t smpSynch() const { return static_cast<uint8_t>(state()); }
+
+    TimeSourceStatus status() const;
+
+    static std::string stateToString(SyncState state);
+
+private:
+    enum class Kind { None, Phc, Tai };
+
+    // reference = refAnchor + (mono - monoAnchor) * (1 + rate)
+    struct Mapping {
+        uint64_t monoAnchor = 0;
+        int64_t refAnchor = 0;
+        double rate = 0.0;
+        SyncState state = SyncState::None;
+        uint64_t settleUntil = 0;       // Monotonic ns, after a step
+        int64_t bracketNs = 0;
+    };
+
+    TimeSource(Kind kind, int fd, std::string name);
+
+    void updateLocked();
+    bool crossTimestamp(uint64_t& monotonicNs, int64_t& referenceNs, int64_t& bracketNs) const;
+    SyncState referenceState(int64_t residualNs);
+    static int64_t project(const Mapping& mapping, uint64_t monotonicNs);
+
+    Kind kind_;
+    int fd_;                            // PHC descriptor, -1 otherwise
+    std::string name_;
+
+    RcuCell<Mapping> mapping_;
+    std::atomic<uint64_t> lastRefreshNs_;
+    mutable std::mutex updateMutex_;    // One cross-timestamp at a time; guards the counters
+    uint64_t steps_;
+    uint64_t refreshes_;
+    uint64_t failures_;
+    PhcLockDetector phcLock_;
+};
+
+/**
+ * @brief Process-wide reference, CLOCK_TAI until main installs another
+ */
+std::shared_ptr<TimeSource> systemTimeSource();
+void setSystemTimeSource(std::shared_ptr<TimeSource> source);
+
+#endif // TIME_SOURCE_HPP
@@ -4,11 +4,16 @@
 #include <time.h>
 #include <iostream>
 #include <cerrno>
+#include <chrono>
+
+#include "clock.hpp"
+#include "thread_health.hpp"
 
 
 class Timer{
 public:
     struct timespec next_period;
+    Clock* clock = nullptr;   // CLOCK_MONOTONIC when null; set for virtual time
 
     void increment_period(long period_ns) {
         next_period.tv_nsec += period_ns;
@@ -19,7 +24,13 @@ public:
     }
 
     void start_period(long period_ns) {
-        clock_gettime(CLOCK_MONOTONIC, &next_period);
+        if (clock) {
+            const uint64_t now = clock->nowNs();
+            next_period.tv_sec = static_cast<time_t>(now / 1000000000ULL);
+            next_period.tv_nsec = static_cast<long>(now % 1000000000ULL);
+        } else {
+            clock_gettime(CLOCK_MONOTONIC, &next_period);
+        }
         increment_period(period_ns);
     }
 
@@ -29,6 +40,12 @@ public:
     }
 
     void wait_period(long period_ns) {
+        if (clock) {
+            clock->sleepUntil(Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+                std::chrono::seconds(next_period.tv_sec) + std::chrono::nanoseconds(next_period.tv_nsec))));
+            increment_period(period_ns);
+            return;
+        }
 #ifdef __linux__
         int ret;
         do {
@@ -38,6 +55,15 @@ public:
         if(ret != 0 && ret != EINTR){
             std::cerr << "Error in clock_nanosleep: " << ret << std::endl;
         }
+
+        // Woken a whole period late: this sample goes out after the next was due
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const int64_t late = static_cast<int64_t>(now.tv_sec - next_period.tv_sec) * 1000000000LL +
+                             (now.tv_nsec - next_period.tv_nsec);
+        if (late >= period_ns) {
+            ThreadHealth::recordMiss(late);
+        }
 #else
         // macOS: Use nanosleep as a fallback (not real-time, but functional)
         struct timespec now;
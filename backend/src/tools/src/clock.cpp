@@ -0,0 +1,128 @@
+#include "clock.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Virtual clocks the current thread is attached to, with nesting depth
+struct Attachment {
+    const VirtualClock* clock;
+    int depth;
+};
+
+thread_local std::vector<Attachment> t_attachments;
+
+std::vector<Attachment>::iterator findAttachment(const VirtualClock* clock) {
+    for (auto it = t_attachments.begin(); it != t_attachments.end(); ++it) {
+        if (it->clock == clock) {
+            return it;
+        }
+    }
+    return t_attachments.end();
+}
+
+int64_t toNs(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+} // namespace
+
+Clock::time_point SteadyClock::now() const {
+    return std::chrono::steady_clock::now();
+}
+
+void SteadyClock::sleepUntil(time_point deadline) {
+    std::this_thread::sleep_until(deadline);
+}
+
+std::shared_ptr<Clock> systemClock() {
+    static const std::shared_ptr<Clock> clock = std::make_shared<SteadyClock>();
+    return clock;
+}
+
+VirtualClock::VirtualClock(time_point start)
+    : nowNs_(toNs(start)), participants_(0), sleepingParticipants_(0) {
+}
+
+Clock::time_point VirtualClock::now() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return time_point(std::chrono::duration_cast<duration>(std::chrono::nanoseconds(nowNs_)));
+}
+
+void VirtualClock::sleepUntil(time_point deadline) {
+    const int64_t target = toNs(deadline);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (target <= nowNs_) {
+        return;
+    }
+
+    const bool attached = findAttachment(this) != t_attachments.end();
+    sleepers_.emplace(target, attached);
+    if (attached) {
+        sleepingParticipants_++;
+    }
+    stepLocked();
+    wake_.wait(lock, [this, target] { return nowNs_ >= target; });
+}
+
+void VirtualClock::attach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = findAttachment(this);
+    if (it != t_attachments.end()) {
+        it->depth++;
+        return;
+    }
+    t_attachments.push_back({this, 1});
+    participants_++;
+}
+
+void VirtualClock::detach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = findAttachment(this);
+    if (it == t_attachments.end() || --it->depth > 0) {
+        return;
+    }
+    t_attachments.erase(it);
+    participants_--;
+    // The remaining participants may all be asleep already
+    stepLocked();
+}
+
+void VirtualClock::advance(duration interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    releaseLocked(nowNs_ + std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+}
+
+size_t VirtualClock::participants() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return participants_;
+}
+
+size_t VirtualClock::sleepers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sleepers_.size();
+}
+
+void VirtualClock::stepLocked() {
+    if (sleepers_.empty() || sleepingParticipants_ < participants_) {
+        return;
+    }
+    releaseLocked(sleepers_.begin()->first);
+}
+
+void VirtualClock::releaseLocked(int64_t nowNs) {
+    if (nowNs > nowNs_) {
+        nowNs_ = nowNs;
+    }
+    // Released sleepers stop counting as asleep now, not when they get the
+    // CPU back, so time cannot run ahead of threads that are about to wake
+    const auto end = sleepers_.upper_bound(nowNs_);
+    for (auto it = sleepers_.begin(); it != end; ++it) {
+        if (it->second) {
+            sleepingParticipants_--;
+        }
+    }
+    sleepers_.erase(sleepers_.begin(), end);
+    wake_.notify_all();
+}
@@ -0,0 +1,157 @@
+#include "digital_input_bank.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+// ============================================================================
+// DigitalInputMask
+// ============================================================================
+
+DigitalInputMask::DigitalInputMask(std::initializer_list<size_t> inputs) {
+    for (size_t input : inputs) {
+        add(input);
+    }
+}
+
+DigitalInputMask& DigitalInputMask::add(size_t input) {
+    const size_t w = input / DigitalInputBank::WordBits;
+    const uint64_t bit = uint64_t{1} << (input % DigitalInputBank::WordBits);
+    auto it = std::lower_bound(words_.begin(), words_.end(), w,
+        [](const std::pair<size_t, uint64_t>& entry, size_t word) { return entry.first < word; });
+    if (it != words_.end() && it->first == w) {
+        it->second |= bit;
+    } else {
+        words_.insert(it, {w, bit});
+    }
+    return *this;
+}
+
+// ============================================================================
+// DigitalInputBank
+// ============================================================================
+
+DigitalInputBank::DigitalInputBank(size_t inputs, size_t eventCapacity)
+    : inputs_(inputs),
+      words_((inputs + WordBits - 1) / WordBits),
+      bits_(new std::atomic<uint64_t>[words_]),
+      versions_(new std::atomic<uint32_t>[words_]),
+      eventMask_(roundUpPow2(std::max<size_t>(eventCapacity, 1)) - 1),
+      events_(new EventSlot[eventMask_ + 1]),
+      head_(0) {
+    if (inputs == 0) {
+        throw std::invalid_argument("DigitalInputBank needs at least one input");
+    }
+    for (size_t w = 0; w < words_; ++w) {
+        bits_[w].store(0, std::memory_order_relaxed);
+        versions_[w].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool DigitalInputBank::set(size_t input, bool value, uint64_t timestampNs) {
+    if (input >= inputs_) {
+        return false;
+    }
+    const size_t w = input / WordBits;
+    const uint64_t bit = uint64_t{1} << (input % WordBits);
+
+    const uint64_t previous = value ? bits_[w].fetch_or(bit) : bits_[w].fetch_and(~bit);
+    if (((previous & bit) != 0) == value) {
+        return false;
+    }
+
+    versions_[w].fetch_add(1);
+    pushEvent(static_cast<uint32_t>(input), value, timestampNs);
+    return true;
+}
+
+void DigitalInputBank::clear() {
+    const uint64_t now = nowNs();
+    for (size_t w = 0; w < words_; ++w) {
+        const uint64_t previous = bits_[w].exchange(0);
+        if (previous == 0) {
+            continue;
+        }
+        versions_[w].fetch_add(1);
+        for (size_t b = 0; b < WordBits; ++b) {
+            if ((previous >> b) & 1u) {
+                pushEvent(static_cast<uint32_t>(w * WordBits + b), false, now);
+            }
+        }
+    }
+}
+
+bool DigitalInputBank::any(const DigitalInputMask& mask) const {
+    for (const auto& entry : mask.words()) {
+        if (entry.first < words_ && (bits_[entry.first].load(std::memory_order_acquire) & entry.second) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DigitalInputBank::all(const DigitalInputMask& mask) const {
+    for (const auto& entry : mask.words()) {
+        if (entry.first >= words_ ||
+            (bits_[entry.first].load(std::memory_order_acquire) & entry.second) != entry.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DigitalInputBank::pushEvent(uint32_t input, bool value, uint64_t timestampNs) {
+    const uint64_t ticket = head_.fetch_add(1, std::memory_order_acq_rel);
+    EventSlot& slot = events_[ticket & eventMask_];
+    slot.seq.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestampNs.store(timestampNs, std::memory_order_relaxed);
+    slot.index.store(input, std::memory_order_relaxed);
+    slot.value.store(value ? 1 : 0, std::memory_order_relaxed);
+    slot.seq.store(2 * ticket + 2, std::memory_order_release);
+}
+
+size_t DigitalInputBank::readEvents(uint64_t& cursor, DigitalInputEvent* out, size_t max, uint64_t* lost) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t capacity = eventMask_ + 1;
+    uint64_t skipped = 0;
+    if (head > capacity && cursor < head - capacity) {
+        skipped += head - capacity - cursor;
+        cursor = head - capacity;
+    }
+
+    size_t count = 0;
+    while (cursor < head && count < max) {
+        const EventSlot& slot = events_[cursor & eventMask_];
+        const uint64_t expected = 2 * cursor + 2;
+        const uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before < expected) {
+            break;  // Ticket taken but not written yet
+        }
+        DigitalInputEvent event;
+        event.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+        event.index = slot.index.load(std::memory_order_relaxed);
+        event.value = slot.value.load(std::memory_order_relaxed) != 0;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (before != expected || slot.seq.load(std::memory_order_relaxed) != expected) {
+            ++skipped;  // Overwritten by a later lap
+        } else {
+            out[count++] = event;
+        }
+        ++cursor;
+    }
+
+    if (lost != nullptr) {
+        *lost += skipped;
+    }
+    return count;
+}
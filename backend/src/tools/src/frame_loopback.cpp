@@ -0,0 +1,14 @@
+#include "frame_loopback.hpp"
+
+void FrameLoopback::attach(Receiver receiver) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    receivers_.push_back(std::move(receiver));
+}
+
+void FrameLoopback::send(const uint8_t* frame, size_t length) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    for (const Receiver& receiver : receivers_) {
+        receiver(frame, length);
+    }
+    framesSent_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,397 @@
+#include "impairment_stage.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <time.h>
+
+namespace {
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+uint64_t realtimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// BER length at p (short form, 0x81, 0x82); returns header bytes consumed, 0 if invalid
+size_t berLength(const uint8_t* p, size_t available, size_t& length) {
+    if (available < 1) return 0;
+    if (p[0] < 0x80) {
+        length = p[0];
+        return 1;
+    }
+    if (p[0] == 0x81 && available >= 2) {
+        length = p[1];
+        return 2;
+    }
+    if (p[0] == 0x82 && available >= 3) {
+        length = static_cast<size_t>(p[1]) << 8 | p[2];
+        return 3;
+    }
+    return 0;
+}
+
+bool inUnit(double p) {
+    return p >= 0.0 && p <= 1.0;
+}
+
+} // namespace
+
+std::string ImpairmentProfile::validate() const {
+    if (!inUnit(lossProbability) || !inUnit(duplicateProbability) ||
+        !inUnit(reorderProbability) || !inUnit(smpCntJumpProbability)) {
+        return "probabilities must be in [0, 1]";
+    }
+    if (lossBurst < 1 || lossBurst > 100000) {
+        return "lossBurst must be 1..100000";
+    }
+    const uint64_t reorder = reorderProbability > 0.0 ? reorderDelayNs : 0;
+    if (delayNs > Impairment_MaxDelayNs || jitterNs > Impairment_MaxDelayNs || reorder > Impairment_MaxDelayNs ||
+        delayNs + jitterNs + reorder > Impairment_MaxDelayNs) {
+        return "delay + jitter + reorder delay must not exceed " + std::to_string(Impairment_MaxDelayNs / 1000000) + " ms";
+    }
+    if (reorderProbability > 0.0 && reorderDelayNs == 0) {
+        return "reorderDelay must be positive";
+    }
+    return std::string();
+}
+
+const char* impairmentEventName(ImpairmentEventType type) {
+    switch (type) {
+        case ImpairmentEventType::Profile:    return "profile";
+        case ImpairmentEventType::Drop:       return "drop";
+        case ImpairmentEventType::Duplicate:  return "duplicate";
+        case ImpairmentEventType::Reorder:    return "reorder";
+        case ImpairmentEventType::SmpCntJump: return "smpCntJump";
+        case ImpairmentEventType::Overflow:   return "overflow";
+    }
+    return "unknown";
+}
+
+ImpairmentStage::ImpairmentStage(size_t poolFrames, size_t eventCapacity)
+    : reader_(profile_),
+      active_(false),
+      rng_(1),
+      burstLeft_(0),
+      pool_(std::max<size_t>(poolFrames, 1) * Impairment_MaxFrameSize),
+      entries_(std::max<size_t>(poolFrames, 1)),
+      free_(0),
+      wheel_(Impairment_WheelSlots, -1),
+      scanTick_(0),
+      pending_(0),
+      scratch_(Impairment_MaxFrameSize),
+      submitted_(0), sent_(0), dropped_(0), duplicated_(0), reordered_(0),
+      delayed_(0), smpCntJumps_(0), overflows_(0), pendingCount_(0),
+      eventMask_(roundUpPow2(std::max<size_t>(eventCapacity, 1)) - 1),
+      events_(new EventSlot[eventMask_ + 1]),
+      head_(0) {
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        entries_[i].next = i + 1 < entries_.size() ? static_cast<int32_t>(i + 1) : -1;
+    }
+    smpCntOffsets_.reserve(8);
+}
+
+bool ImpairmentStage::setProfile(const ImpairmentProfile& profile, std::string& error) {
+    error = profile.validate();
+    if (!error.empty()) {
+        return false;
+    }
+    const uint64_t version = profile_.publish(std::make_shared<const ImpairmentProfile>(profile));
+    LOG_INFO("IMPAIR", "Profile %llu: loss %.4f x%u, dup %.4f, reorder %.4f, delay %llu+%llu ns, smpCnt %.4f",
+             static_cast<unsigned long long>(version), profile.lossProbability, profile.lossBurst,
+             profile.duplicateProbability, profile.reorderProbability,
+             static_cast<unsigned long long>(profile.delayNs), static_cast<unsigned long long>(profile.jitterNs),
+             profile.smpCntJumpProbability);
+    return true;
+}
+
+const ImpairmentProfile& ImpairmentStage::refresh() {
+    const uint64_t seen = reader_.version();
+    const ImpairmentProfile& profile = reader_.get();
+    if (reader_.version() != seen) {
+        // New profile: restart its random sequence so runs are repeatable
+        active_ = profile.active() || pending_ > 0;
+        rng_ = profile.seed;
+        burstLeft_ = 0;
+        pushEvent(ImpairmentEventType::Profile, submitted_.load(std::memory_order_relaxed), -1,
+                  static_cast<int64_t>(reader_.version()));
+    } else if (active_ && pending_ == 0 && !profile.active()) {
+        active_ = false;  // Delay queue drained after the profile was cleared
+    }
+    return profile;
+}
+
+uint64_t ImpairmentStage::nextRandom() {
+    // splitmix64
+    uint64_t z = (rng_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+size_t ImpairmentStage::findSmpCnt(const uint8_t* frame, size_t length, std::vector<size_t>* offsets) {
+    size_t pos = 12;
+    while (pos + 4 <= length && ((frame[pos] == 0x81 && frame[pos + 1] == 0x00) ||
+                                 (frame[pos] == 0x88 && frame[pos + 1] == 0xA8))) {
+        pos += 4;
+    }
+    if (pos + 10 > length || frame[pos] != 0x88 || frame[pos + 1] != 0xBA) {
+        return 0;
+    }
+    pos += 10;  // EtherType, APPID, Length, Reserved 1/2
+
+    size_t len = 0;
+    size_t hdr;
+    if (pos >= length || frame[pos] != 0x60 || (hdr = berLength(frame + pos + 1, length - pos - 1, len)) == 0) {
+        return 0;
+    }
+    pos += 1 + hdr;
+    const size_t pduEnd = std::min(length, pos + len);
+
+    // noASDU, optional security, then the SEQUENCE OF ASDU
+    while (pos + 2 <= pduEnd && frame[pos] != 0xA2) {
+        if ((hdr = berLength(frame + pos + 1, pduEnd - pos - 1, len)) == 0) return 0;
+        pos += 1 + hdr + len;
+    }
+    if (pos + 2 > pduEnd || (hdr = berLength(frame + pos + 1, pduEnd - pos - 1, len)) == 0) {
+        return 0;
+    }
+    pos += 1 + hdr;
+
+    size_t first = 0;
+    while (pos + 2 <= pduEnd && frame[pos] == 0x30) {
+        if ((hdr = berLength(frame + pos + 1, pduEnd - pos - 1, len)) == 0) break;
+        size_t field = pos + 1 + hdr;
+        const size_t asduEnd = std::min(pduEnd, field + len);
+        while (field + 2 <= asduEnd) {
+            size_t fieldLen = 0;
+            const size_t fieldHdr = berLength(frame + field + 1, asduEnd - field - 1, fieldLen);
+            if (fieldHdr == 0) break;
+            if (frame[field] == 0x82 && fieldLen == 2 && field + 1 + fieldHdr + 2 <= asduEnd) {
+                const size_t value = field + 1 + fieldHdr;
+                if (first == 0) first = value;
+                if (offsets != nullptr) offsets->push_back(value);
+                break;
+            }
+            field += 1 + fieldHdr + fieldLen;
+        }
+        pos = asduEnd;
+    }
+    return first;
+}
+
+ImpairmentStage::Verdict ImpairmentStage::impair(const ImpairmentProfile& profile, const uint8_t* frame,
+                                                 size_t length, uint64_t nowNs) {
+    const uint64_t number = submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    // Every frame draws the same number of values, so one impairment does not
+    // shift the pattern applied to the frames after it
+    const double lossDraw = uniform();
+    const double jumpDraw = uniform();
+    const double reorderDraw = uniform();
+    const double duplicateDraw = uniform();
+    const double jitterDraw = uniform();
+
+    int32_t smpCnt = -1;
+    smpCntOffsets_.clear();
+    const size_t smpCntPos = length <= Impairment_MaxFrameSize ? findSmpCnt(frame, length, &smpCntOffsets_) : 0;
+    if (smpCntPos != 0) {
+        smpCnt = frame[smpCntPos] << 8 | frame[smpCntPos + 1];
+    }
+
+    if (burstLeft_ > 0 || lossDraw < profile.lossProbability) {
+        burstLeft_ = burstLeft_ > 0 ? burstLeft_ - 1 : profile.lossBurst - 1;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        pushEvent(ImpairmentEventType::Drop, number, smpCnt, burstLeft_);
+        return {frame, 0};
+    }
+
+    const uint8_t* data = frame;
+    if (smpCntPos != 0 && jumpDraw < profile.smpCntJumpProbability) {
+        std::memcpy(scratch_.data(), frame, length);
+        for (size_t offset : smpCntOffsets_) {
+            const uint16_t shifted = static_cast<uint16_t>((scratch_[offset] << 8 | scratch_[offset + 1]) + profile.smpCntJump);
+            scratch_[offset] = static_cast<uint8_t>(shifted >> 8);
+            scratch_[offset + 1] = static_cast<uint8_t>(shifted & 0xFF);
+        }
+        data = scratch_.data();
+        smpCntJumps_.fetch_add(1, std::memory_order_relaxed);
+        pushEvent(ImpairmentEventType::SmpCntJump, number, smpCnt, profile.smpCntJump);
+    }
+
+    uint64_t delay = profile.delayNs;
+    if (profile.jitterNs > 0) {
+        delay += static_cast<uint64_t>(jitterDraw * static_cast<double>(profile.jitterNs + 1));
+    }
+    if (reorderDraw < profile.reorderProbability) {
+        delay += profile.reorderDelayNs;
+        reordered_.fetch_add(1, std::memory_order_relaxed);
+        pushEvent(ImpairmentEventType::Reorder, number, smpCnt, static_cast<int64_t>(profile.reorderDelayNs));
+    }
+
+    uint32_t copies = 1;
+    if (duplicateDraw < profile.duplicateProbability) {
+        copies = 2;
+        duplicated_.fetch_add(1, std::memory_order_relaxed);
+        pushEvent(ImpairmentEventType::Duplicate, number, smpCnt, 0);
+    }
+
+    if (delay == 0) {
+        sent_.fetch_add(copies, std::memory_order_relaxed);
+        return {data, copies};
+    }
+
+    delayed_.fetch_add(1, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < copies; ++i) {
+        if (!schedule(data, length, nowNs + delay)) {
+            overflows_.fetch_add(1, std::memory_order_relaxed);
+            pushEvent(ImpairmentEventType::Overflow, number, smpCnt, 0);
+        }
+    }
+    return {frame, 0};
+}
+
+bool ImpairmentStage::schedule(const uint8_t* frame, size_t length, uint64_t deadlineNs) {
+    if (free_ < 0 || length > Impairment_MaxFrameSize) {
+        return false;
+    }
+    const int32_t entry = free_;
+    Entry& e = entries_[static_cast<size_t>(entry)];
+    free_ = e.next;
+    std::memcpy(entryData(entry), frame, length);
+    e.length = length;
+    e.deadlineNs = deadlineNs;
+
+    const uint64_t tick = deadlineNs / Impairment_WheelTickNs;
+    if (pending_ == 0) {
+        scanTick_ = tick;
+    }
+    scanTick_ = std::min(scanTick_, tick);
+
+    // Keep the slot sorted by deadline; equal deadlines stay in submit order
+    int32_t* link = &wheel_[tick % wheel_.size()];
+    while (*link >= 0 && entries_[static_cast<size_t>(*link)].deadlineNs <= deadlineNs) {
+        link = &entries_[static_cast<size_t>(*link)].next;
+    }
+    e.next = *link;
+    *link = entry;
+
+    pending_++;
+    pendingCount_.store(pending_, std::memory_order_relaxed);
+    return true;
+}
+
+int32_t ImpairmentStage::popDue(uint64_t nowNs) {
+    if (pending_ == 0) {
+        return -1;
+    }
+    const uint64_t nowTick = nowNs / Impairment_WheelTickNs;
+    if (nowTick > scanTick_ + wheel_.size()) {
+        scanTick_ = nowTick - wheel_.size();  // Every slot is within one rotation of now
+    }
+    while (scanTick_ <= nowTick) {
+        int32_t& head = wheel_[scanTick_ % wheel_.size()];
+        if (head >= 0 && entries_[static_cast<size_t>(head)].deadlineNs <= nowNs) {
+            const int32_t entry = head;
+            head = entries_[static_cast<size_t>(entry)].next;
+            return entry;
+        }
+        if (scanTick_ == nowTick) {
+            break;
+        }
+        scanTick_++;
+    }
+    return -1;
+}
+
+void ImpairmentStage::release(int32_t entry) {
+    entries_[static_cast<size_t>(entry)].next = free_;
+    free_ = entry;
+    pending_--;
+    pendingCount_.store(pending_, std::memory_order_relaxed);
+    sent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t ImpairmentStage::nextDeadline() const {
+    uint64_t earliest = std::numeric_limits<uint64_t>::max();
+    if (pending_ == 0) {
+        return earliest;
+    }
+    for (int32_t head : wheel_) {
+        if (head >= 0) {
+            earliest = std::min(earliest, entries_[static_cast<size_t>(head)].deadlineNs);
+        }
+    }
+    return earliest;
+}
+
+ImpairmentCounters ImpairmentStage::counters() const {
+    ImpairmentCounters c;
+    c.submitted = submitted_.load(std::memory_order_relaxed);
+    c.sent = sent_.load(std::memory_order_relaxed);
+    c.dropped = dropped_.load(std::memory_order_relaxed);
+    c.duplicated = duplicated_.load(std::memory_order_relaxed);
+    c.reordered = reordered_.load(std::memory_order_relaxed);
+    c.delayed = delayed_.load(std::memory_order_relaxed);
+    c.smpCntJumps = smpCntJumps_.load(std::memory_order_relaxed);
+    c.overflows = overflows_.load(std::memory_order_relaxed);
+    c.pending = pendingCount_.load(std::memory_order_relaxed);
+    return c;
+}
+
+void ImpairmentStage::pushEvent(ImpairmentEventType type, uint64_t frame, int32_t smpCnt, int64_t value) {
+    // Single writer (the publishing thread)
+    const uint64_t ticket = head_.load(std::memory_order_relaxed);
+    EventSlot& slot = events_[ticket & eventMask_];
+    slot.seq.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestampNs.store(realtimeNs(), std::memory_order_relaxed);
+    slot.frame.store(frame, std::memory_order_relaxed);
+    slot.smpCnt.store(smpCnt, std::memory_order_relaxed);
+    slot.type.store(static_cast<uint8_t>(type), std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.seq.store(2 * ticket + 2, std::memory_order_release);
+    head_.store(ticket + 1, std::memory_order_release);
+}
+
+size_t ImpairmentStage::readEvents(uint64_t& cursor, ImpairmentEvent* out, size_t max, uint64_t* lost) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t capacity = eventMask_ + 1;
+    uint64_t skipped = 0;
+    if (head > capacity && cursor < head - capacity) {
+        skipped += head - capacity - cursor;
+        cursor = head - capacity;
+    }
+
+    size_t count = 0;
+    while (cursor < head && count < max) {
+        const EventSlot& slot = events_[cursor & eventMask_];
+        const uint64_t expected = 2 * cursor + 2;
+        const uint64_t before = slot.seq.load(std::memory_order_acquire);
+        ImpairmentEvent event;
+        event.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+        event.frame = slot.frame.load(std::memory_order_relaxed);
+        event.smpCnt = slot.smpCnt.load(std::memory_order_relaxed);
+        event.type = static_cast<ImpairmentEventType>(slot.type.load(std::memory_order_relaxed));
+        event.value = slot.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (before != expected || slot.seq.load(std::memory_order_relaxed) != expected) {
+            ++skipped;  // Overwritten by a later lap
+        } else {
+            out[count++] = event;
+        }
+        ++cursor;
+    }
+
+    if (lost != nullptr) {
+        *lost += skipped;
+    }
+    return count;
+}
@@ -0,0 +1,253 @@
+#include "rt_selftest.hpp"
+#include "clock.hpp"
+#include "rt_utils.hpp"
+#include "timers.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <limits>
+#include <thread>
+#include <time.h>
+
+namespace {
+
+constexpr uint64_t NsPerSecond = 1000000000ULL;
+constexpr uint64_t StartDelayNs = 20000000;        // Threads set up before the first wakeup
+
+// Rates reported on; rateVerdict() takes any
+constexpr uint32_t ReportedRates[] = {4000, 4800, 12800, 14400, 15360};
+
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NsPerSecond + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t toNs(const struct timespec& ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * NsPerSecond + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+struct timespec toTimespec(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / NsPerSecond);
+    ts.tv_nsec = static_cast<long>(ns % NsPerSecond);
+    return ts;
+}
+
+void measure(RtSelfTestThread& result, int priority, uint64_t startNs, uint64_t endNs) {
+    if (result.cpu >= 0) {
+        result.pinned = rt_set_affinity({result.cpu});
+    }
+    result.realtime = rt_set_realtime(priority);
+
+    Timer timer;
+    timer.start_period(toTimespec(startNs));
+    for (;;) {
+        const uint64_t target = toNs(timer.next_period);
+        if (target >= endNs) {
+            break;
+        }
+        timer.wait_period(static_cast<long>(result.periodNs));
+        const int64_t late = static_cast<int64_t>(monotonicNs() - target);
+        result.latency.record(late);
+        if (late >= static_cast<int64_t>(result.periodNs)) {
+            ++result.overruns;
+        }
+    }
+}
+
+// The SV tick loop's wait: a relative sleep from whenever the tick's work
+// ended, so a late wakeup pushes every later tick back with it
+void measureTicks(RtSelfTestThread& result, int priority, uint64_t startNs, uint64_t endNs) {
+    if (result.cpu >= 0) {
+        result.pinned = rt_set_affinity({result.cpu});
+    }
+    result.realtime = rt_set_realtime(priority);
+
+    Clock& clock = *systemClock();
+    uint64_t now = monotonicNs();
+    if (now < startNs) {
+        clock.sleepFor(std::chrono::nanoseconds(startNs - now));
+        now = monotonicNs();
+    }
+    do {
+        const uint64_t target = now + result.periodNs;
+        clock.sleepFor(std::chrono::nanoseconds(result.periodNs));
+        now = monotonicNs();
+        const int64_t late = std::max<int64_t>(0, static_cast<int64_t>(now - target));
+        result.latency.record(late);
+        if (late >= static_cast<int64_t>(result.periodNs)) {
+            ++result.overruns;
+        }
+    } while (now < endNs);
+}
+
+void addThreads(std::vector<RtSelfTestThread>& threads, const std::string& role, const std::vector<int>& cpus,
+                uint64_t periodNs) {
+    if (cpus.empty()) {
+        RtSelfTestThread t;
+        t.role = role;
+        t.periodNs = periodNs;
+        threads.push_back(std::move(t));
+        return;
+    }
+    for (int cpu : cpus) {
+        RtSelfTestThread t;
+        t.role = role;
+        t.cpu = cpu;
+        t.periodNs = periodNs;
+        threads.push_back(std::move(t));
+    }
+}
+
+bool parseCpu(const std::string& text, int& cpu) {
+    if (text.empty() || text.size() > 4 ||
+        !std::all_of(text.begin(), text.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+        return false;
+    }
+    cpu = std::stoi(text);
+    return true;
+}
+
+} // namespace
+
+RtSelfTestReport runRtSelfTest(const RtSelfTestConfig& config) {
+    RtSelfTestReport report;
+    report.tickNs = config.tickNs > 0 ? config.tickNs : SV_TickPeriodNs;
+    report.periodNs = config.periodNs > 0 ? config.periodNs : RtSelfTest_PeriodNs;
+    report.durationNs = std::min(config.durationNs, RtSelfTest_MaxDurationNs);
+    addThreads(report.threads, "publisher", config.publisherCpus, report.tickNs);
+    addThreads(report.threads, "sniffer", config.snifferCpus, report.periodNs);
+
+    // One start and end for all threads, so their wakeups overlap as in service
+    const uint64_t startNs = monotonicNs() + StartDelayNs;
+    const uint64_t endNs = startNs + report.durationNs;
+    std::vector<std::thread> workers;
+    workers.reserve(report.threads.size());
+    for (RtSelfTestThread& t : report.threads) {
+        if (t.role == "sniffer") {
+            workers.emplace_back(measure, std::ref(t), Sniffer_ThreadPriority, startNs, endNs);
+        } else {
+            workers.emplace_back(measureTicks, std::ref(t), SV_TickThreadPriority, startNs, endNs);
+        }
+    }
+    for (std::thread& w : workers) {
+        w.join();
+    }
+
+    report.finishedAt = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return report;
+}
+
+int64_t RtSelfTestReport::worstNs(const std::string& role) const {
+    const bool any = std::any_of(threads.begin(), threads.end(),
+                                 [&role](const RtSelfTestThread& t) { return t.role == role; });
+    int64_t worst = 0;
+    for (const RtSelfTestThread& t : threads) {
+        if (!any || t.role == role) {
+            worst = std::max(worst, t.latency.max());
+        }
+    }
+    return worst;
+}
+
+RateVerdict RtSelfTestReport::verdict(uint32_t sampleRate) const {
+    return rateVerdict(worstNs("publisher"), sampleRate, tickNs > 0 ? tickNs : SV_TickPeriodNs);
+}
+
+RateVerdict rateVerdict(int64_t worstNs, uint32_t sampleRate, uint64_t tickNs) {
+    if (sampleRate == 0 || worstNs < ThreadHealth_LateNs) {
+        return RateVerdict::Ok;
+    }
+    // Samples pending at the late wakeup against the publisher's realign
+    // threshold (SVPublisherInstance::sendDueSamples)
+    const uint64_t gapNs = tickNs + static_cast<uint64_t>(worstNs);
+    const uint64_t backlog = gapNs * sampleRate / NsPerSecond;
+    const uint64_t maxLag = std::max<uint64_t>(1, static_cast<uint64_t>(sampleRate) * SV_MaxCatchUpMs / 1000);
+    return backlog <= maxLag ? RateVerdict::Marginal : RateVerdict::Unsustainable;
+}
+
+std::string rateVerdictToString(RateVerdict verdict) {
+    switch (verdict) {
+        case RateVerdict::Ok: return "OK";
+        case RateVerdict::Marginal: return "MARGINAL";
+        case RateVerdict::Unsustainable: return "UNSUSTAINABLE";
+    }
+    return "UNKNOWN";
+}
+
+nlohmann::json RtSelfTestReport::toJson() const {
+    nlohmann::json threadData = nlohmann::json::array();
+    for (const RtSelfTestThread& t : threads) {
+        nlohmann::json histogram = nlohmann::json::array();
+        for (size_t i = 0; i < t.latency.bucketCount(); ++i) {
+            if (t.latency.bucket(i) > 0) {
+                histogram.push_back({t.latency.bucketLowerNs(i), t.latency.bucket(i)});
+            }
+        }
+        threadData.push_back({
+            {"role", t.role},
+            {"cpu", t.cpu},
+            {"pinned", t.pinned},
+            {"realtime", t.realtime},
+            {"periodNs", t.periodNs},
+            {"wakeups", t.latency.count()},
+            {"overruns", t.overruns},
+            {"minNs", t.latency.min()},
+            {"meanNs", t.latency.mean()},
+            {"p99Ns", t.latency.percentile(0.99)},
+            {"p999Ns", t.latency.percentile(0.999)},
+            {"maxNs", t.latency.max()},
+            {"histogram", histogram}
+        });
+    }
+
+    const int64_t worst = worstNs("publisher");
+    nlohmann::json rates = nlohmann::json::array();
+    for (uint32_t rate : ReportedRates) {
+        rates.push_back({
+            {"sampleRate", rate},
+            {"periodNs", NsPerSecond / rate},
+            {"verdict", rateVerdictToString(rateVerdict(worst, rate))}
+        });
+    }
+
+    return {
+        {"tickNs", tickNs},
+        {"periodNs", periodNs},
+        {"durationNs", durationNs},
+        {"finishedAt", finishedAt},
+        {"histogramBucketNs", RtSelfTest_HistogramResolutionNs},
+        {"publisherWorstNs", worst},
+        {"threads", threadData},
+        {"rates", rates}
+    };
+}
+
+bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    std::vector<int> parsed;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        const size_t comma = std::min(text.find(',', pos), text.size());
+        const std::string item = text.substr(pos, comma - pos);
+        const size_t dash = item.find('-');
+        int first;
+        int last;
+        if (dash == std::string::npos) {
+            if (!parseCpu(item, first)) {
+                return false;
+            }
+            last = first;
+        } else if (!parseCpu(item.substr(0, dash), first) || !parseCpu(item.substr(dash + 1), last) || last < first) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            parsed.push_back(cpu);
+        }
+        pos = comma + 1;
+    }
+    cpus = std::move(parsed);
+    return true;
+}
@@ -0,0 +1,420 @@
+#include "thread_health.hpp"
+#include "compat.hpp"
+#include "general_definition.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef VTS_PLATFORM_LINUX
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct Interval {
+    double at = 0.0;                    // Unix seconds, end of the interval
+    uint64_t misses = 0;
+    int64_t maxLatenessNs = 0;
+    ThreadCounters delta;
+};
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+double unixNow() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int currentTid() {
+#ifdef VTS_PLATFORM_LINUX
+    return static_cast<int>(syscall(SYS_gettid));
+#else
+    return 0;
+#endif
+}
+
+void atomicMax(std::atomic<int64_t>& target, int64_t value) {
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+#ifdef VTS_PLATFORM_LINUX
+// Whole small /proc file into buf, NUL-terminated; no allocation
+bool readProcFile(int tid, const char* file, char* buf, size_t size) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/self/task/%d/%s", tid, file);
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    size_t used = 0;
+    while (used + 1 < size) {
+        const ssize_t n = read(fd, buf + used, size - 1 - used);
+        if (n <= 0) {
+            break;
+        }
+        used += static_cast<size_t>(n);
+    }
+    close(fd);
+    buf[used] = '\0';
+    return used > 0;
+}
+
+uint64_t statusField(const char* status, const char* key) {
+    const char* at = std::strstr(status, key);
+    return at ? std::strtoull(at + std::strlen(key), nullptr, 10) : 0;
+}
+#endif
+
+ThreadCounters difference(const ThreadCounters& now, const ThreadCounters& before) {
+    ThreadCounters d;
+    d.runNs = now.runNs - before.runNs;
+    d.runqueueWaitNs = now.runqueueWaitNs - before.runqueueWaitNs;
+    d.timeslices = now.timeslices - before.timeslices;
+    d.voluntarySwitches = now.voluntarySwitches - before.voluntarySwitches;
+    d.involuntarySwitches = now.involuntarySwitches - before.involuntarySwitches;
+    d.minorFaults = now.minorFaults - before.minorFaults;
+    d.majorFaults = now.majorFaults - before.majorFaults;
+    d.cpu = now.cpu;
+    return d;
+}
+
+nlohmann::json countersJson(const ThreadCounters& c) {
+    return {
+        {"runNs", c.runNs},
+        {"runqueueWaitNs", c.runqueueWaitNs},
+        {"timeslices", c.timeslices},
+        {"voluntarySwitches", c.voluntarySwitches},
+        {"involuntarySwitches", c.involuntarySwitches},
+        {"minorFaults", c.minorFaults},
+        {"majorFaults", c.majorFaults}
+    };
+}
+
+nlohmann::json intervalJson(const Interval& interval) {
+    nlohmann::json j = countersJson(interval.delta);
+    j["at"] = interval.at;
+    j["deadlineMisses"] = interval.misses;
+    j["maxLatenessNs"] = interval.maxLatenessNs;
+    return j;
+}
+
+} // namespace
+
+bool readThreadCounters(int tid, ThreadCounters& counters) {
+#ifdef VTS_PLATFORM_LINUX
+    char buf[4096];
+    ThreadCounters c;
+
+    if (!readProcFile(tid, "schedstat", buf, sizeof(buf))) {
+        return false;
+    }
+    char* end = buf;
+    c.runNs = std::strtoull(end, &end, 10);
+    c.runqueueWaitNs = std::strtoull(end, &end, 10);
+    c.timeslices = std::strtoull(end, &end, 10);
+
+    // Fields after "(comm)", which may itself hold spaces or parentheses:
+    // state is field 3, minflt 10, majflt 12, processor 39
+    if (!readProcFile(tid, "stat", buf, sizeof(buf))) {
+        return false;
+    }
+    const char* fields = std::strrchr(buf, ')');
+    if (!fields) {
+        return false;
+    }
+    ++fields;
+    for (int field = 3; field <= 39 && *fields; ++field) {
+        while (*fields == ' ') {
+            ++fields;
+        }
+        if (field == 10) {
+            c.minorFaults = std::strtoull(fields, nullptr, 10);
+        } else if (field == 12) {
+            c.majorFaults = std::strtoull(fields, nullptr, 10);
+        } else if (field == 39) {
+            c.cpu = std::atoi(fields);
+        }
+        while (*fields && *fields != ' ') {
+            ++fields;
+        }
+    }
+
+    if (!readProcFile(tid, "status", buf, sizeof(buf))) {
+        return false;
+    }
+    c.voluntarySwitches = statusField(buf, "\nvoluntary_ctxt_switches:");
+    c.involuntarySwitches = statusField(buf, "\nnonvoluntary_ctxt_switches:");
+
+    counters = c;
+    return true;
+#else
+    (void)tid;
+    (void)counters;
+    return false;
+#endif
+}
+
+struct ThreadHealth::Entry {
+    std::string name;
+    int tid = 0;
+    std::atomic<bool> active{true};
+
+    // Written by the thread itself
+    std::atomic<uint64_t> misses{0};
+    std::atomic<int64_t> maxLatenessNs{0};
+    std::atomic<int64_t> intervalMaxLatenessNs{0};
+
+    // Sampler state, under Registry::sampleMutex
+    ThreadCounters first;
+    ThreadCounters last;
+    bool readable = false;
+    uint64_t sampledMisses = 0;
+    Interval lastInterval;
+    uint64_t missIntervals = 0;
+    uint64_t withPreemption = 0;
+    uint64_t withMajorFaults = 0;
+    uint64_t withMinorFaults = 0;
+    uint64_t withRunqueueWait = 0;
+    uint64_t unexplained = 0;
+    std::deque<Interval> recentMisses;
+};
+
+namespace {
+
+thread_local ThreadHealth::Entry* t_entry = nullptr;
+
+struct Registry {
+    std::mutex mutex;                   // entries
+    std::vector<std::shared_ptr<ThreadHealth::Entry>> entries;
+
+    std::mutex sampleMutex;             // Sampler state of every entry, and the totals below
+    uint64_t samples = 0;
+    uint64_t samplingNs = 0;
+    const uint64_t createdNs = steadyNowNs();
+
+    std::mutex threadMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread thread;
+
+    ~Registry() {
+        stopThread();
+    }
+
+    void stopThread() {
+        {
+            std::lock_guard<std::mutex> lock(threadMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    std::vector<std::shared_ptr<ThreadHealth::Entry>> snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries;
+    }
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// Caller holds sampleMutex
+void sampleEntry(ThreadHealth::Entry& e) {
+    ThreadCounters now;
+    if (!readThreadCounters(e.tid, now)) {
+        return;
+    }
+    if (!e.readable) {
+        e.first = now;
+        e.last = now;
+        e.readable = true;
+    }
+
+    Interval interval;
+    interval.at = unixNow();
+    interval.delta = difference(now, e.last);
+    const uint64_t misses = e.misses.load(std::memory_order_relaxed);
+    interval.misses = misses - e.sampledMisses;
+    interval.maxLatenessNs = e.intervalMaxLatenessNs.exchange(0, std::memory_order_relaxed);
+    e.sampledMisses = misses;
+    e.last = now;
+    e.lastInterval = interval;
+
+    if (interval.misses == 0) {
+        return;
+    }
+    // What else happened to the thread in the interval it missed deadlines
+    e.missIntervals++;
+    bool explained = false;
+    if (interval.delta.involuntarySwitches > 0) {
+        e.withPreemption++;
+        explained = true;
+    }
+    if (interval.delta.majorFaults > 0) {
+        e.withMajorFaults++;
+        explained = true;
+    }
+    if (interval.delta.minorFaults > 0) {
+        e.withMinorFaults++;
+        explained = true;
+    }
+    if (interval.delta.runqueueWaitNs >= ThreadHealth_RunqueueWaitNs) {
+        e.withRunqueueWait++;
+        explained = true;
+    }
+    if (!explained) {
+        e.unexplained++;
+    }
+    e.recentMisses.push_back(interval);
+    if (e.recentMisses.size() > ThreadHealth_History) {
+        e.recentMisses.pop_front();
+    }
+}
+
+} // namespace
+
+ThreadHealth::Scope::Scope(const std::string& name)
+    : entry_(std::make_shared<Entry>()) {
+    entry_->name = name;
+    entry_->tid = currentTid();
+    Registry& r = registry();
+    {
+        // Baseline, so totals count from registration
+        std::lock_guard<std::mutex> lock(r.sampleMutex);
+        sampleEntry(*entry_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto& entries = r.entries;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if ((*it)->name == name && !(*it)->active.load(std::memory_order_relaxed)) {
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        entries.push_back(entry_);
+    }
+    t_entry = entry_.get();
+}
+
+ThreadHealth::Scope::~Scope() {
+    t_entry = nullptr;
+    {
+        // Last look while the thread still exists
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.sampleMutex);
+        sampleEntry(*entry_);
+    }
+    entry_->active.store(false, std::memory_order_relaxed);
+}
+
+void ThreadHealth::recordMiss(int64_t latenessNs) {
+    Entry* e = t_entry;
+    if (!e) {
+        return;
+    }
+    e->misses.fetch_add(1, std::memory_order_relaxed);
+    atomicMax(e->maxLatenessNs, latenessNs);
+    atomicMax(e->intervalMaxLatenessNs, latenessNs);
+}
+
+void ThreadHealth::start() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.threadMutex);
+    if (r.thread.joinable()) {
+        return;
+    }
+    r.stopping = false;
+    r.thread = std::thread([&r] {
+        std::unique_lock<std::mutex> idle(r.threadMutex);
+        while (!r.wake.wait_for(idle, std::chrono::nanoseconds(ThreadHealth_PeriodNs),
+                                [&r] { return r.stopping; })) {
+            idle.unlock();
+            sample();
+            idle.lock();
+        }
+    });
+}
+
+void ThreadHealth::stop() {
+    registry().stopThread();
+}
+
+void ThreadHealth::sample() {
+    Registry& r = registry();
+    const auto entries = r.snapshot();
+    std::lock_guard<std::mutex> lock(r.sampleMutex);
+    const uint64_t begin = steadyNowNs();
+    for (const auto& entry : entries) {
+        if (entry->active.load(std::memory_order_relaxed)) {
+            sampleEntry(*entry);
+        }
+    }
+    r.samples++;
+    r.samplingNs += steadyNowNs() - begin;
+}
+
+nlohmann::json ThreadHealth::toJson() {
+    Registry& r = registry();
+    const auto entries = r.snapshot();
+    std::lock_guard<std::mutex> lock(r.sampleMutex);
+
+    nlohmann::json threads = nlohmann::json::array();
+    for (const auto& entry : entries) {
+        const Entry& e = *entry;
+        nlohmann::json totals = countersJson(difference(e.last, e.first));
+        totals["deadlineMisses"] = e.misses.load(std::memory_order_relaxed);
+        totals["maxLatenessNs"] = e.maxLatenessNs.load(std::memory_order_relaxed);
+
+        nlohmann::json recent = nlohmann::json::array();
+        for (const Interval& interval : e.recentMisses) {
+            recent.push_back(intervalJson(interval));
+        }
+        threads.push_back({
+            {"name", e.name},
+            {"tid", e.tid},
+            {"active", e.active.load(std::memory_order_relaxed)},
+            {"readable", e.readable},
+            {"cpu", e.last.cpu},
+            {"totals", totals},
+            {"lastInterval", intervalJson(e.lastInterval)},
+            {"missIntervals", e.missIntervals},
+            {"missCorrelation", {
+                {"preemption", e.withPreemption},
+                {"majorFaults", e.withMajorFaults},
+                {"minorFaults", e.withMinorFaults},
+                {"runqueueWait", e.withRunqueueWait},
+                {"unexplained", e.unexplained}
+            }},
+            {"recentMisses", recent}
+        });
+    }
+
+    const uint64_t elapsed = steadyNowNs() - r.createdNs;
+    return {
+        {"periodNs", ThreadHealth_PeriodNs},
+        {"samples", r.samples},
+        {"overheadPercent", elapsed > 0 ? 100.0 * static_cast<double>(r.samplingNs) / static_cast<double>(elapsed) : 0.0},
+        {"threads", threads}
+    };
+}
@@ -0,0 +1,306 @@
+#include "time_source.hpp"
+#include "compat.hpp"
+#include "general_definition.hpp"
+#include "logger.hpp"
+#include "rt_utils.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#ifdef VTS_PLATFORM_LINUX
+#include <sys/timex.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int64_t NsPerSecond = 1000000000;
+
+uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#ifdef VTS_PLATFORM_LINUX
+// Dynamic POSIX clock of a PHC descriptor (FD_TO_CLOCKID in the kernel docs)
+clockid_t phcClockId(int fd) {
+    return static_cast<clockid_t>((~static_cast<unsigned int>(fd) << 3) | 3u);
+}
+
+bool readClock(clockid_t id, int64_t& ns) {
+    struct timespec ts;
+    if (clock_gettime(id, &ts) != 0) {
+        return false;
+    }
+    ns = static_cast<int64_t>(ts.tv_sec) * NsPerSecond + ts.tv_nsec;
+    return true;
+}
+#endif
+
+std::mutex g_systemMutex;
+std::shared_ptr<TimeSource> g_system;
+
+} // namespace
+
+TimeSource::TimeSource()
+    : TimeSource(Kind::None, -1, "none") {
+}
+
+TimeSource::TimeSource(Kind kind, int fd, std::string name)
+    : kind_(kind), fd_(fd), name_(std::move(name)), lastRefreshNs_(0),
+      steps_(0), refreshes_(0), failures_(0) {
+    update();
+}
+
+TimeSource::~TimeSource() {
+#ifdef VTS_PLATFORM_LINUX
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+#endif
+}
+
+std::shared_ptr<TimeSource> TimeSource::openPhc(const std::string& device, std::string& error) {
+#ifdef VTS_PLATFORM_LINUX
+    const int fd = rt_open_phc(device.c_str());
+    if (fd < 0) {
+        error = "cannot open " + device + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    int64_t ns;
+    if (!readClock(phcClockId(fd), ns)) {
+        error = "cannot read " + device + ": " + std::strerror(errno);
+        close(fd);
+        return nullptr;
+    }
+    return std::shared_ptr<TimeSource>(new TimeSource(Kind::Phc, fd, "phc:" + device));
+#else
+    error = "PTP hardware clocks are only supported on Linux (" + device + ")";
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<TimeSource> TimeSource::systemTai() {
+#ifdef VTS_PLATFORM_LINUX
+    return std::shared_ptr<TimeSource>(new TimeSource(Kind::Tai, -1, "CLOCK_TAI"));
+#else
+    return std::shared_ptr<TimeSource>(new TimeSource(Kind::Tai, -1, "system_clock"));
+#endif
+}
+
+bool TimeSource::refresh(uint64_t monotonicNs) {
+    if (monotonicNs - lastRefreshNs_.load(std::memory_order_relaxed) < TimeSource_RefreshNs) {
+        return false;
+    }
+    // Never wait on another thread's cross-timestamp: it covers this one
+    std::unique_lock<std::mutex> lock(updateMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    updateLocked();
+    return true;
+}
+
+void TimeSource::update() {
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    updateLocked();
+}
+
+// Caller holds updateMutex_
+void TimeSource::updateLocked() {
+    uint64_t mono;
+    int64_t ref;
+    int64_t bracket;
+    if (!crossTimestamp(mono, ref, bracket)) {
+        ++failures_;
+        phcLock_.reset();
+        lastRefreshNs_.store(steadyNowNs(), std::memory_order_relaxed);
+        mapping_.update([](Mapping& m) { m.state = SyncState::None; });
+        return;
+    }
+
+    const Mapping previous = *mapping_.load();
+    Mapping next = previous;
+    next.bracketNs = bracket;
+    int64_t residual = std::numeric_limits<int64_t>::max();
+    if (refreshes_ > 0 && mono > previous.monoAnchor) {
+        const int64_t error = ref - project(previous, mono);
+        if (std::llabs(error) > TimeSource_StepNs) {
+            ++steps_;
+            next.settleUntil = mono + TimeSource_SettleNs;
+            phcLock_.reset();
+            LOG_WARN("TIME", "%s stepped by %lld ns", name_.c_str(), static_cast<long long>(error));
+        } else {
+            residual = error;
+            // What is left after the rate correction so far is rate error
+            next.rate += TimeSource_RateGain * static_cast<double>(error) /
+                         static_cast<double>(mono - previous.monoAnchor);
+        }
+    }
+    next.monoAnchor = mono;
+    next.refAnchor = ref;
+    const SyncState state = referenceState(residual);
+    next.state = mono < next.settleUntil ? SyncState::None : state;
+    mapping_.publish(std::make_shared<const Mapping>(next));
+    ++refreshes_;
+    lastRefreshNs_.store(mono, std::memory_order_relaxed);
+}
+
+bool TimeSource::crossTimestamp(uint64_t& monotonicNs, int64_t& referenceNs, int64_t& bracketNs) const {
+    if (kind_ == Kind::None) {
+        monotonicNs = steadyNowNs();
+        referenceNs = static_cast<int64_t>(monotonicNs);
+        bracketNs = 0;
+        return true;
+    }
+
+    bracketNs = std::numeric_limits<int64_t>::max();
+    for (int i = 0; i < TimeSource_CrossSamples; ++i) {
+        const uint64_t before = steadyNowNs();
+        int64_t ref;
+#ifdef VTS_PLATFORM_LINUX
+        if (!readClock(kind_ == Kind::Phc ? phcClockId(fd_) : CLOCK_TAI, ref)) {
+            return false;
+        }
+#else
+        ref = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+        const uint64_t after = steadyNowNs();
+        const int64_t width = static_cast<int64_t>(after - before);
+        if (width < bracketNs) {
+            bracketNs = width;
+            monotonicNs = before + (after - before) / 2;
+            referenceNs = ref;
+        }
+    }
+    return true;
+}
+
+// Caller holds updateMutex_
+SyncState TimeSource::referenceState(int64_t residualNs) {
+    switch (kind_) {
+        case Kind::Phc: {
+#ifdef VTS_PLATFORM_LINUX
+            // Read-only query of the frequency adjustment the servo steers
+            struct timex tx;
+            std::memset(&tx, 0, sizeof(tx));
+            if (clock_adjtime(phcClockId(fd_), &tx) < 0) {
+                phcLock_.reset();
+                return SyncState::None;
+            }
+            return phcLock_.update(tx.freq, residualNs);
+#else
+            return SyncState::None;
+#endif
+        }
+        case Kind::Tai: {
+#ifdef VTS_PLATFORM_LINUX
+            // Read-only query; TIME_ERROR while the host clock is unsynchronized
+            struct timex tx;
+            std::memset(&tx, 0, sizeof(tx));
+            return adjtimex(&tx) == TIME_ERROR ? SyncState::None : SyncState::Local;
+#else
+            return SyncState::None;
+#endif
+        }
+        case Kind::None:
+            break;
+    }
+    return SyncState::None;
+}
+
+SyncState PhcLockDetector::update(long frequency, int64_t residualNs) {
+    if (haveFrequency_ && frequency != frequency_) {
+        sinceAdjust_ = 0;
+    } else if (sinceAdjust_ < TimeSource_ServoIdleRefreshes) {
+        ++sinceAdjust_;
+    }
+    haveFrequency_ = true;
+    frequency_ = frequency;
+
+    if (residualNs != std::numeric_limits<int64_t>::max() && std::llabs(residualNs) <= TimeSource_LockNs) {
+        stable_ = std::min(stable_ + 1, TimeSource_LockRefreshes);
+    } else {
+        stable_ = 0;
+    }
+    return locked() ? SyncState::Global : SyncState::None;
+}
+
+void PhcLockDetector::reset() {
+    *this = PhcLockDetector();
+}
+
+bool PhcLockDetector::locked() const {
+    return sinceAdjust_ < TimeSource_ServoIdleRefreshes && stable_ >= TimeSource_LockRefreshes;
+}
+
+int64_t TimeSource::project(const Mapping& m, uint64_t monotonicNs) {
+    const int64_t delta = static_cast<int64_t>(monotonicNs - m.monoAnchor);
+    return m.refAnchor + delta + std::llround(static_cast<double>(delta) * m.rate);
+}
+
+int64_t TimeSource::toReference(uint64_t monotonicNs) const {
+    return project(*mapping_.load(), monotonicNs);
+}
+
+uint64_t TimeSource::toMonotonic(int64_t referenceNs) const {
+    const std::shared_ptr<const Mapping> m = mapping_.load();
+    const double delta = static_cast<double>(referenceNs - m->refAnchor) / (1.0 + m->rate);
+    return m->monoAnchor + static_cast<uint64_t>(std::llround(delta));
+}
+
+uint64_t TimeSource::nextSecond(uint64_t monotonicNs, uint64_t minLeadNs) const {
+    const int64_t earliest = toReference(monotonicNs + minLeadNs);
+    int64_t second = earliest / NsPerSecond * NsPerSecond;
+    if (second < earliest) {
+        second += NsPerSecond;
+    }
+    return toMonotonic(second);
+}
+
+SyncState TimeSource::state() const {
+    return mapping_.load()->state;
+}
+
+TimeSourceStatus TimeSource::status() const {
+    const std::shared_ptr<const Mapping> m = mapping_.load();
+    TimeSourceStatus s;
+    s.reference = name_;
+    s.state = m->state;
+    s.offsetNs = m->refAnchor - static_cast<int64_t>(m->monoAnchor);
+    s.driftPpm = m->rate * 1e6;
+    s.bracketNs = m->bracketNs;
+    std::lock_guard<std::mutex> lock(updateMutex_);
+    s.refreshes = refreshes_;
+    s.steps = steps_;
+    s.failures = failures_;
+    return s;
+}
+
+std::string TimeSource::stateToString(SyncState state) {
+    switch (state) {
+        case SyncState::None: return "NONE";
+        case SyncState::Local: return "LOCAL";
+        case SyncState::Global: return "GLOBAL";
+    }
+    return "UNKNOWN";
+}
+
+std::shared_ptr<TimeSource> systemTimeSource() {
+    std::lock_guard<std::mutex> lock(g_systemMutex);
+    if (!g_system) {
+        g_system = TimeSource::systemTai();
+    }
+    return g_system;
+}
+
+void setSystemTimeSource(std::shared_ptr<TimeSource> source) {
+    std::lock_guard<std::mutex> lock(g_systemMutex);
+    g_system = std::move(source);
+}
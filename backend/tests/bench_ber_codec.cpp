@@ -0,0 +1,86 @@
+/**
+ * @file bench_ber_codec.cpp
+ * @brief Microbenchmark: span-based BER encoding vs. nested-vector encoding
+ *
+ * Encodes a 9-2LE style SV APDU (8 channels, 1 and 8 ASDUs) repeatedly with
+ *  - legacyEncode(): the previous approach (a std::vector per TLV, lengths
+ *    from encodeBERLength(), concatenated bottom-up)
+ *  - SampledValue::encodeTo(): two-pass sizing into a caller buffer
+ * and prints ns/frame for each. Not registered with ctest; run manually:
+ *
+ *   ./tests/vts_bench_ber [iterations]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "BER_Encoding.hpp"
+#include "SampledValue.hpp"
+
+namespace {
+
+void appendTLV(std::vector<uint8_t>& out, uint8_t tag, const std::vector<uint8_t>& value) {
+    out.push_back(tag);
+    auto len = encodeBERLength(value.size());
+    out.insert(out.end(), len.begin(), len.end());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+std::vector<uint8_t> legacyEncode(const std::string& svID, uint8_t noAsdu, uint8_t noChannel, uint16_t smpCnt) {
+    std::vector<uint8_t> seqAsdu;
+    for (uint8_t asdu = 0; asdu < noAsdu; asdu++) {
+        std::vector<uint8_t> content;
+        appendTLV(content, 0x80, std::vector<uint8_t>(svID.begin(), svID.end()));
+        appendTLV(content, 0x82, {static_cast<uint8_t>(smpCnt >> 8), static_cast<uint8_t>(smpCnt & 0xFF)});
+        appendTLV(content, 0x83, {0, 0, 0, 1});
+        appendTLV(content, 0x85, {1});
+        appendTLV(content, 0x87, std::vector<uint8_t>(static_cast<size_t>(noChannel) * 8, 0));
+        appendTLV(seqAsdu, 0x30, content);
+    }
+    std::vector<uint8_t> savPdu;
+    appendTLV(savPdu, 0x80, {noAsdu});
+    appendTLV(savPdu, 0xA2, seqAsdu);
+
+    std::vector<uint8_t> frame = {0x88, 0xBA, 0x40, 0x00, 0, 0, 0, 0, 0, 0};
+    appendTLV(frame, 0x60, savPdu);
+    return frame;
+}
+
+template <typename F>
+double nsPerCall(long iterations, F&& fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) /
+           static_cast<double>(iterations);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 1000000;
+    volatile size_t sink = 0;
+
+    for (uint8_t noAsdu : {uint8_t(1), uint8_t(8)}) {
+        SampledValue sv(0x4000, noAsdu, "MU01_SV", 0, 1, 1, 0);
+        std::vector<uint8_t> buffer(sv.encodedSize(8));
+
+        double legacy = nsPerCall(iterations, [&](long i) {
+            auto frame = legacyEncode("MU01_SV", noAsdu, 8, static_cast<uint16_t>(i));
+            sink = sink + frame.size();
+        });
+        double span = nsPerCall(iterations, [&](long i) {
+            sv.smpCnt = static_cast<uint16_t>(i);
+            sink = sink + sv.encodeTo(buffer.data(), buffer.size(), 8);
+        });
+
+        std::printf("noAsdu=%u frame=%zu bytes: legacy %.1f ns/frame, span %.1f ns/frame (%.1fx)\n",
+                    noAsdu, buffer.size(), legacy, span, legacy / span);
+    }
+    return sink == 0;
+}
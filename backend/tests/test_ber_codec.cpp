@@ -0,0 +1,192 @@
+/**
+ * @file test_ber_codec.cpp
+ * @brief Unit tests for the span-based BER writer/reader and the encoders built on it
+ *
+ * Tests cover:
+ * - Length sizing and writing (short form, 0x81, 0x82, 0x83)
+ * - Writer overflow detection
+ * - Reader bounds checks on truncated input
+ * - SampledValue two-pass encoding, value offsets and decode round trip
+ * - GOOSE allData >255 bytes
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdint>
+#include "BER_Codec.hpp"
+#include "BER_Encoding.hpp"
+#include "SampledValue.hpp"
+#include "Goose.hpp"
+
+class BERCodecTest : public ::testing::Test {
+protected:
+    std::vector<uint8_t> writeLength(size_t length) {
+        std::vector<uint8_t> buf(8);
+        BERWriter w(buf.data(), buf.size());
+        w.putLength(length);
+        buf.resize(w.size());
+        return buf;
+    }
+};
+
+TEST_F(BERCodecTest, LengthSizes) {
+    EXPECT_EQ(berLengthSize(0), 1u);
+    EXPECT_EQ(berLengthSize(127), 1u);
+    EXPECT_EQ(berLengthSize(128), 2u);
+    EXPECT_EQ(berLengthSize(255), 2u);
+    EXPECT_EQ(berLengthSize(256), 3u);
+    EXPECT_EQ(berLengthSize(65535), 3u);
+    EXPECT_EQ(berLengthSize(65536), 4u);
+    EXPECT_EQ(berTLVSize(64), 66u);
+    EXPECT_EQ(berTLVSize(200), 203u);
+}
+
+TEST_F(BERCodecTest, WriteLengthForms) {
+    EXPECT_EQ(writeLength(127), (std::vector<uint8_t>{0x7F}));
+    EXPECT_EQ(writeLength(128), (std::vector<uint8_t>{0x81, 0x80}));
+    EXPECT_EQ(writeLength(900), (std::vector<uint8_t>{0x82, 0x03, 0x84}));
+    EXPECT_EQ(writeLength(70000), (std::vector<uint8_t>{0x83, 0x01, 0x11, 0x70}));
+}
+
+TEST_F(BERCodecTest, MatchesLegacyEncodeBERLength) {
+    for (size_t len : {0u, 1u, 127u, 128u, 255u, 256u, 1000u, 65535u}) {
+        EXPECT_EQ(writeLength(len), encodeBERLength(len)) << "length=" << len;
+    }
+}
+
+TEST_F(BERCodecTest, WriterOverflowStopsWriting) {
+    uint8_t buf[4] = {0, 0, 0, 0};
+    BERWriter w(buf, 3);
+    w.putU16TLV(0x82, 0x1234);  // needs 4 bytes
+    EXPECT_FALSE(w.ok());
+    EXPECT_EQ(buf[3], 0);
+}
+
+TEST_F(BERCodecTest, ReaderNestedTLV) {
+    const uint8_t data[] = {0x30, 0x06, 0x80, 0x01, 0x05, 0x82, 0x01, 0xAA};
+    BERReader r(data, sizeof(data));
+    uint8_t tag;
+    BERReader seq, field;
+    ASSERT_TRUE(r.readTLV(tag, seq));
+    EXPECT_EQ(tag, 0x30);
+    EXPECT_TRUE(r.empty());
+
+    ASSERT_TRUE(seq.readTLV(tag, field));
+    uint32_t value;
+    ASSERT_TRUE(field.readUnsigned(value));
+    EXPECT_EQ(value, 5u);
+
+    ASSERT_TRUE(seq.readTLV(tag, field));
+    EXPECT_EQ(tag, 0x82);
+    EXPECT_FALSE(seq.readTLV(tag, field));
+}
+
+TEST_F(BERCodecTest, ReaderRejectsTruncatedInput) {
+    const uint8_t shortContent[] = {0x87, 0x10, 0x00, 0x01};
+    const uint8_t shortLength[] = {0x60, 0x82, 0x01};
+    const uint8_t indefinite[] = {0x30, 0x80, 0x00, 0x00};
+    uint8_t tag;
+    BERReader value;
+
+    BERReader a(shortContent, sizeof(shortContent));
+    EXPECT_FALSE(a.readTLV(tag, value));
+    EXPECT_EQ(a.offset(), 0u);
+
+    BERReader b(shortLength, sizeof(shortLength));
+    EXPECT_FALSE(b.readTLV(tag, value));
+
+    BERReader c(indefinite, sizeof(indefinite));
+    EXPECT_FALSE(c.readTLV(tag, value));
+}
+
+TEST_F(BERCodecTest, SampledValueEncodeToMatchesGetEncoded) {
+    SampledValue sv(0x4000, 8, "MU01_SV", 0, 1, 1, 0);
+    auto encoded = sv.getEncoded(8);
+    ASSERT_EQ(encoded.size(), sv.encodedSize(8));
+
+    std::vector<uint8_t> buf(encoded.size());
+    EXPECT_EQ(sv.encodeTo(buf.data(), buf.size(), 8), encoded.size());
+    EXPECT_EQ(buf, encoded);
+
+    EXPECT_EQ(sv.encodeTo(buf.data(), buf.size() - 1, 8), 0u);
+}
+
+TEST_F(BERCodecTest, SampledValueOffsetsPointAtValues) {
+    SampledValue sv(0x4000, 2, "MU01_SV", 0x1234, 1, 1, 0);
+    auto encoded = sv.getEncoded(8);
+
+    for (int asdu = 0; asdu < 2; ++asdu) {
+        int smpCnt = sv.getParamPos(asdu, "smpCnt");
+        int seqData = sv.getParamPos(asdu, "seqData");
+        ASSERT_GE(smpCnt, 2);
+        ASSERT_GE(seqData, 2);
+        EXPECT_EQ(encoded[static_cast<size_t>(smpCnt) - 2], 0x82);
+        EXPECT_EQ(encoded[static_cast<size_t>(smpCnt)], 0x12);
+        EXPECT_EQ(encoded[static_cast<size_t>(smpCnt) + 1], 0x34);
+        EXPECT_EQ(encoded[static_cast<size_t>(seqData) - 2], 0x87);
+        EXPECT_EQ(encoded[static_cast<size_t>(seqData) - 1], 64);
+    }
+}
+
+TEST_F(BERCodecTest, SampledValueRoundTrip) {
+    SampledValue sv(0x4000, 8, "MU01_SV", 0, 1, 1, 0);
+    auto encoded = sv.getEncoded(8);
+
+    // Header: EtherType, APPID, Length covers APPID..end
+    EXPECT_EQ(encoded[0], 0x88);
+    EXPECT_EQ(encoded[1], 0xBA);
+    EXPECT_EQ((encoded[4] << 8 | encoded[5]), static_cast<int>(encoded.size() - 2));
+
+    BERReader r(encoded.data() + 10, encoded.size() - 10);
+    uint8_t tag;
+    BERReader savPdu, field, seqAsdu, asdu;
+    ASSERT_TRUE(r.readTLV(tag, savPdu));
+    EXPECT_EQ(tag, 0x60);
+    EXPECT_TRUE(r.empty());
+
+    uint32_t noAsdu = 0;
+    ASSERT_TRUE(savPdu.readTLV(tag, field));
+    ASSERT_TRUE(field.readUnsigned(noAsdu));
+    EXPECT_EQ(noAsdu, 8u);
+
+    ASSERT_TRUE(savPdu.readTLV(tag, seqAsdu));
+    EXPECT_EQ(tag, 0xA2);
+
+    int asduCount = 0;
+    while (seqAsdu.readTLV(tag, asdu)) {
+        EXPECT_EQ(tag, 0x30);
+        bool seqDataFound = false;
+        while (asdu.readTLV(tag, field)) {
+            if (tag == 0x87) {
+                seqDataFound = true;
+                EXPECT_EQ(field.remaining(), 64u);
+            }
+        }
+        EXPECT_TRUE(seqDataFound);
+        ++asduCount;
+    }
+    EXPECT_EQ(asduCount, 8);
+}
+
+TEST_F(BERCodecTest, GooseAllDataLongForm) {
+    std::vector<Data> allData;
+    for (int i = 0; i < 300; ++i) {
+        Data d(Data::Type::Boolean);
+        d.boolean = (i % 2) == 0;
+        allData.push_back(d);
+    }
+    Goose goose("", "", 0x0001, 0, "IED1LD0/LLN0$GO$gcb01", 2000, "IED1LD0/LLN0$DS01", "",
+                UtcTime(0, 0), 1, 0, false, 1, false, 300, allData);
+
+    auto encoded = goose.getEncoded();
+    ASSERT_EQ(encoded.size(), goose.encodedSize());
+
+    int pos = goose.getParamPos("allData");
+    ASSERT_GE(pos, 4);
+    // 300 booleans * 3 bytes = 900 = 0x0384
+    EXPECT_EQ(encoded[static_cast<size_t>(pos) - 4], 0xAB);
+    EXPECT_EQ(encoded[static_cast<size_t>(pos) - 3], 0x82);
+    EXPECT_EQ(encoded[static_cast<size_t>(pos) - 2], 0x03);
+    EXPECT_EQ(encoded[static_cast<size_t>(pos) - 1], 0x84);
+    EXPECT_EQ(encoded.size() - static_cast<size_t>(pos), 900u);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file test_bulk_update.cpp
+ * @brief Unit tests for atomic multi-stream bulk phasor/harmonic updates
+ *
+ * Tests cover:
+ * - Parsing of full phasor sets, per-channel changes, frequency and harmonics
+ * - Up-front rejection of bad entries (duplicates, unknown channels, NaN)
+ * - Channel changes and control deltas limited to the stream's channels
+ * - All-or-nothing apply with one snapshot version across streams
+ */
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "sv_publisher_manager.hpp"
+
+using json = nlohmann::json;
+
+class BulkUpdateTest : public ::testing::Test {};
+
+TEST_F(BulkUpdateTest, ParsesEveryKindOfEntry) {
+    const BulkUpdate update = SVPublisherManager::parseBulkUpdate(json::parse(R"({"streams": [
+        {"id": "bay1", "phasors": [{"magnitude": 100, "angle": 0}, {"magnitude": 100, "angle": -120}]},
+        {"id": "bay2", "channels": {"V-A": {"mag": 57.7, "angleDeg": 10}}, "freq": 49.9, "rocof": 0.2},
+        {"id": "bay3", "harmonics": [{"order": 5, "magnitude": 0.04}]}
+    ]})"));
+    ASSERT_EQ(update.streams.size(), 3u);
+
+    const StreamBulkUpdate& bay1 = update.streams[0];
+    EXPECT_TRUE(bay1.hasPhasors);
+    ASSERT_EQ(bay1.phasors.size(), 2u);
+    EXPECT_DOUBLE_EQ(bay1.phasors[1].angle, -120.0);
+    EXPECT_GE(bay1.phasors.capacity(), Control_MaxChannels);    // Merge room reserved
+
+    const StreamBulkUpdate& bay2 = update.streams[1];
+    EXPECT_FALSE(bay2.hasPhasors);
+    ASSERT_EQ(bay2.channels.size(), 1u);
+    EXPECT_EQ(bay2.channels[0].channel, 4);
+    EXPECT_DOUBLE_EQ(bay2.channels[0].magnitude, 57.7);
+    EXPECT_TRUE(bay2.hasFrequency);
+    EXPECT_DOUBLE_EQ(bay2.frequency, 49.9);
+    EXPECT_DOUBLE_EQ(bay2.rocof, 0.2);
+
+    const StreamBulkUpdate& bay3 = update.streams[2];
+    EXPECT_TRUE(bay3.hasHarmonics);
+    EXPECT_FALSE(bay3.hasFrequency);
+    EXPECT_EQ(bay3.harmonics[0]["order"], 5);
+}
+
+TEST_F(BulkUpdateTest, RejectsBadEntriesUpFront) {
+    const char* const bad[] = {
+        R"({})",
+        R"({"streams": []})",
+        R"({"streams": [{"phasors": []}]})",
+        R"({"streams": [{"id": "a", "freq": 50}, {"id": "a", "freq": 51}]})",
+        R"({"streams": [{"id": "a", "channels": {"X-Y": {"mag": 1}}}]})",
+        R"({"streams": [{"id": "a", "phasors": [{"magnitude": -1}]}]})",
+        R"({"streams": [{"id": "a", "phasors": [{"magnitude": "big"}]}]})",
+        R"({"streams": [{"id": "a", "freq": 0}]})",
+        R"({"streams": [{"id": "a", "harmonics": 3}]})",
+        R"({"streams": [{"id": "a"}]})",
+    };
+    for (const char* body : bad) {
+        EXPECT_THROW(SVPublisherManager::parseBulkUpdate(json::parse(body)), std::invalid_argument) << body;
+    }
+}
+
+TEST_F(BulkUpdateTest, AppliesAllStreamsOrNone) {
+    SVPublisherManager manager;
+    std::string a, b;
+    try {
+        a = manager.createStream({{"nominalFreq", 50.0}});
+        b = manager.createStream({{"nominalFreq", 50.0}});
+    } catch (const std::runtime_error& e) {
+        GTEST_SKIP() << "Publisher needs a raw socket: " << e.what();
+    }
+
+    // One unknown id: nothing changes
+    BulkUpdate rejected = SVPublisherManager::parseBulkUpdate(json{{"streams", {
+        {{"id", a}, {"freq", 51.0}},
+        {{"id", "missing"}, {"freq", 51.0}}}}});
+    EXPECT_THROW(manager.applyBulk(rejected), std::runtime_error);
+    EXPECT_DOUBLE_EQ(manager.getInstance(a)->getFrequency(), 50.0);
+    EXPECT_EQ(manager.getInstance(a)->getSnapshotVersion(), 0u);
+
+    BulkUpdate update = SVPublisherManager::parseBulkUpdate(json{{"streams", {
+        {{"id", a}, {"channels", {{"I-B", {{"mag", 5.0}, {"angleDeg", -120.0}}}}}},
+        {{"id", b}, {"phasors", {{{"magnitude", 1.0}, {"angle", 30.0}}}}, {"freq", 49.5},
+         {"harmonics", json::array({{{"order", 3}}})}}}}});
+    const uint64_t version = manager.applyBulk(update);
+    EXPECT_EQ(version, 1u);
+
+    auto sa = manager.getInstance(a);
+    auto sb = manager.getInstance(b);
+    EXPECT_EQ(sa->getSnapshotVersion(), version);
+    EXPECT_EQ(sb->getSnapshotVersion(), version);
+    ASSERT_EQ(sa->getPhasors().size(), 8u);                     // Merged into the live set
+    EXPECT_DOUBLE_EQ(sa->getPhasors()[1].magnitude, 5.0);
+    EXPECT_DOUBLE_EQ(sa->getPhasors()[1].angle, -120.0);
+    ASSERT_EQ(sb->getPhasors().size(), 1u);                     // Replaced
+    EXPECT_DOUBLE_EQ(sb->getFrequency(), 49.5);
+    EXPECT_EQ(sb->getHarmonics()[0]["order"], 3);
+    EXPECT_EQ(update.streams[0].appliedSmpCnt, 0u);
+}
+
+TEST_F(BulkUpdateTest, DeltasStayWithinTheStreamsChannels) {
+    SVPublisherManager manager;
+    std::string a, b;
+    try {
+        a = manager.createStream({{"nominalFreq", 50.0}});
+        b = manager.createStream({{"nominalFreq", 50.0}});
+    } catch (const std::runtime_error& e) {
+        GTEST_SKIP() << "Publisher needs a raw socket: " << e.what();
+    }
+    BulkUpdate narrow = SVPublisherManager::parseBulkUpdate(json{{"streams", {
+        {{"id", b}, {"phasors", {{{"magnitude", 1.0}, {"angle", 0.0}}}}}}}});
+    manager.applyBulk(narrow);
+
+    // Bulk: a named channel the stream does not have fails the whole update
+    BulkUpdate wide = SVPublisherManager::parseBulkUpdate(json{{"streams", {
+        {{"id", a}, {"freq", 51.0}},
+        {{"id", b}, {"channels", {{"V-A", {{"mag", 57.7}}}}}}}}});
+    EXPECT_THROW(manager.applyBulk(wide), std::invalid_argument);
+    EXPECT_DOUBLE_EQ(manager.getInstance(a)->getFrequency(), 50.0);
+    EXPECT_EQ(manager.getInstance(b)->getPhasors().size(), 1u);
+
+    // Control channel: the stray update is refused, the others still post
+    ControlBatch batch;
+    StreamControlUpdate& good = batch.add();
+    good.streamId = a;
+    good.deltas.push_back({2, PhasorDelta::Magnitude, 5.0, 0.0});
+    StreamControlUpdate& stray = batch.add();
+    stray.streamId = a;
+    stray.deltas.push_back({3, PhasorDelta::Magnitude, 1.0, 0.0});
+    stray.deltas.push_back({12, PhasorDelta::Magnitude, 1.0, 0.0});
+    std::vector<std::string> unknown;
+    std::vector<std::string> errors;
+    EXPECT_EQ(manager.postControl(batch, 1, &unknown, &errors), 1u);
+    EXPECT_TRUE(unknown.empty());
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_NE(errors[0].find("channel 12"), std::string::npos) << errors[0];
+
+    auto sa = manager.getInstance(a);
+    sa->tick();                                                 // Applies posted control
+    ASSERT_EQ(sa->getPhasors().size(), 8u);
+    EXPECT_DOUBLE_EQ(sa->getPhasors()[2].magnitude, 5.0);
+    EXPECT_DOUBLE_EQ(sa->getPhasors()[3].magnitude, 0.0);       // Nothing of the stray update
+}
@@ -0,0 +1,87 @@
+/**
+ * @file test_byte_order.cpp
+ * @brief Unit tests for big-endian store helpers and seqData packing
+ *
+ * Tests cover:
+ * - store_be16 / store_be32 / load_be32 round trip
+ * - pack_seqdata_be32 writes values in 8-byte slots
+ * - Quality words are left untouched
+ * - Odd channel counts (vector body + scalar tail)
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+#include "byte_order.hpp"
+
+class ByteOrderTest : public ::testing::Test {
+protected:
+    // Reference encoding: same per-byte shifts as updatePkt
+    static void referencePack(uint8_t* dst, const std::vector<int32_t>& values) {
+        for (size_t i = 0; i < values.size(); ++i) {
+            dst[i * 8]     = static_cast<uint8_t>((values[i] >> 24) & 0xFF);
+            dst[i * 8 + 1] = static_cast<uint8_t>((values[i] >> 16) & 0xFF);
+            dst[i * 8 + 2] = static_cast<uint8_t>((values[i] >> 8) & 0xFF);
+            dst[i * 8 + 3] = static_cast<uint8_t>(values[i] & 0xFF);
+        }
+    }
+};
+
+TEST_F(ByteOrderTest, StoreBE16) {
+    uint8_t buf[2] = {0, 0};
+    store_be16(buf, 0x1234);
+    EXPECT_EQ(buf[0], 0x12);
+    EXPECT_EQ(buf[1], 0x34);
+}
+
+TEST_F(ByteOrderTest, StoreLoadBE32RoundTrip) {
+    uint8_t buf[4];
+    store_be32(buf, 0xA1B2C3D4u);
+    EXPECT_EQ(buf[0], 0xA1);
+    EXPECT_EQ(buf[1], 0xB2);
+    EXPECT_EQ(buf[2], 0xC3);
+    EXPECT_EQ(buf[3], 0xD4);
+    EXPECT_EQ(load_be32(buf), 0xA1B2C3D4u);
+}
+
+TEST_F(ByteOrderTest, PackMatchesShiftEncoding) {
+    std::vector<int32_t> values = {1, -1, 0x7FFFFFFF, INT32_MIN, 123456, -98765, 0, 42};
+    std::vector<uint8_t> packed(values.size() * 8, 0);
+    std::vector<uint8_t> expected(values.size() * 8, 0);
+
+    pack_seqdata_be32(packed.data(), values.data(), values.size());
+    referencePack(expected.data(), values);
+
+    EXPECT_EQ(packed, expected);
+}
+
+TEST_F(ByteOrderTest, QualityWordsUntouched) {
+    std::vector<int32_t> values = {10, 20, 30, 40, 50};
+    std::vector<uint8_t> packed(values.size() * 8, 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+        store_be32(packed.data() + i * 8 + 4, 0x00002000u + static_cast<uint32_t>(i));
+    }
+
+    pack_seqdata_be32(packed.data(), values.data(), values.size());
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(load_be32(packed.data() + i * 8), static_cast<uint32_t>(values[i]));
+        EXPECT_EQ(load_be32(packed.data() + i * 8 + 4), 0x00002000u + i);
+    }
+}
+
+TEST_F(ByteOrderTest, OddChannelCounts) {
+    for (size_t n = 0; n <= 13; ++n) {
+        std::vector<int32_t> values(n);
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = static_cast<int32_t>(i * 1000003u) - 5000;
+        }
+        std::vector<uint8_t> packed(n * 8 + 1, 0xEE);
+        std::vector<uint8_t> expected(n * 8 + 1, 0xEE);
+
+        pack_seqdata_be32(packed.data(), values.data(), n);
+        referencePack(expected.data(), values);
+
+        EXPECT_EQ(packed, expected) << "channels=" << n;
+    }
+}
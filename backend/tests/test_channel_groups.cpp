@@ -0,0 +1,152 @@
+/**
+ * @file test_channel_groups.cpp
+ * @brief Unit tests for the analyzer's three-phase channel group quantities
+ *
+ * Tests cover:
+ * - Sequence components and power of balanced and unbalanced sets
+ * - Apparent impedance per loop, with residual compensation
+ * - Differential/restraint currents, batching, groups with missing channels
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "channel_groups.hpp"
+
+using vts::analyzer::ChannelGroup;
+using vts::analyzer::GroupCalculator;
+using vts::analyzer::GroupQuantities;
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+std::complex<double> phasor(double magnitude, double degrees) {
+    return std::polar(magnitude, degrees * Pi / 180.0);
+}
+
+ChannelGroup makeGroup(const std::string& prefix, bool differential = false) {
+    ChannelGroup group;
+    group.name = prefix;
+    group.voltage = {prefix + "VA", prefix + "VB", prefix + "VC"};
+    group.current = {prefix + "IA", prefix + "IB", prefix + "IC"};
+    if (differential) {
+        group.remoteCurrent = {prefix + "RA", prefix + "RB", prefix + "RC"};
+    }
+    return group;
+}
+
+// Balanced set, currents lagging by `lag` degrees
+void addBalanced(std::map<std::string, std::complex<double>>& phasors, const std::string& prefix,
+                 double v, double i, double lag) {
+    const char* phases[] = {"A", "B", "C"};
+    for (int k = 0; k < 3; ++k) {
+        phasors[prefix + "V" + phases[k]] = phasor(v, -120.0 * k);
+        phasors[prefix + "I" + phases[k]] = phasor(i, -120.0 * k - lag);
+    }
+}
+
+void expectNear(std::complex<double> actual, std::complex<double> expected, double tolerance) {
+    EXPECT_NEAR(actual.real(), expected.real(), tolerance);
+    EXPECT_NEAR(actual.imag(), expected.imag(), tolerance);
+}
+
+} // namespace
+
+class ChannelGroupsTest : public ::testing::Test {
+protected:
+    GroupCalculator calculator;
+    std::map<std::string, std::complex<double>> phasors;
+    std::vector<GroupQuantities> out;
+};
+
+TEST_F(ChannelGroupsTest, BalancedSet) {
+    calculator.setGroups({makeGroup("")});
+    addBalanced(phasors, "", 63.5, 2.0, 30.0);
+    calculator.compute(phasors, out);
+    ASSERT_EQ(out.size(), 1u);
+    const GroupQuantities& q = out[0];
+
+    expectNear(q.voltageSequence[1], phasor(63.5, 0.0), 1e-9);
+    expectNear(q.voltageSequence[0], 0.0, 1e-9);
+    expectNear(q.voltageSequence[2], 0.0, 1e-9);
+    expectNear(q.currentSequence[1], phasor(2.0, -30.0), 1e-9);
+
+    // S = V I* per phase, lagging current gives positive Q
+    for (int k = 0; k < 3; ++k) {
+        expectNear(q.phasePower[k], phasor(127.0, 30.0), 1e-9);
+    }
+    expectNear(q.totalPower, phasor(381.0, 30.0), 1e-9);
+    EXPECT_NEAR(q.powerFactor, std::cos(Pi / 6.0), 1e-12);
+
+    // Every loop sees the per-phase load impedance
+    for (int loop = 0; loop < 6; ++loop) {
+        expectNear(q.impedance[loop], phasor(31.75, 30.0), 1e-9);
+    }
+    EXPECT_EQ(q.differential[0], 0.0);
+}
+
+TEST_F(ChannelGroupsTest, NegativeSequenceOnly) {
+    calculator.setGroups({makeGroup("")});
+    // Swapped B and C: pure negative sequence
+    phasors["VA"] = phasor(10.0, 0.0);
+    phasors["VB"] = phasor(10.0, 120.0);
+    phasors["VC"] = phasor(10.0, -120.0);
+    phasors["IA"] = phasors["IB"] = phasors["IC"] = phasor(1.0, 0.0);
+    calculator.compute(phasors, out);
+    ASSERT_EQ(out.size(), 1u);
+    expectNear(out[0].voltageSequence[2], phasor(10.0, 0.0), 1e-9);
+    expectNear(out[0].voltageSequence[1], 0.0, 1e-9);
+    expectNear(out[0].currentSequence[0], phasor(1.0, 0.0), 1e-9);
+
+    // Equal currents: no phase-to-phase loop current
+    EXPECT_TRUE(std::isnan(out[0].impedance[3].real()));
+}
+
+TEST_F(ChannelGroupsTest, GroundLoopUsesResidualCompensation) {
+    ChannelGroup group = makeGroup("");
+    group.k0 = {0.5, 0.0};
+    calculator.setGroups({group});
+
+    // A-G fault: only phase A carries current, so Ia + k0 * 3I0 = 1.5 Ia
+    phasors["VA"] = phasor(15.0, 0.0);
+    phasors["VB"] = phasor(63.5, -120.0);
+    phasors["VC"] = phasor(63.5, 120.0);
+    phasors["IA"] = phasor(2.0, -80.0);
+    phasors["IB"] = phasors["IC"] = 0.0;
+    calculator.compute(phasors, out);
+    ASSERT_EQ(out.size(), 1u);
+    expectNear(out[0].impedance[0], phasor(5.0, 80.0), 1e-9);
+    // Healthy phases still see the residual term
+    expectNear(out[0].impedance[1], phasor(63.5, -40.0), 1e-9);
+}
+
+TEST_F(ChannelGroupsTest, DifferentialBatchingAndMissingChannels) {
+    calculator.setGroups({makeGroup("x", true), makeGroup("y"), makeGroup("z")});
+    addBalanced(phasors, "x", 63.5, 2.0, 10.0);
+    addBalanced(phasors, "y", 100.0, 5.0, 0.0);
+    addBalanced(phasors, "z", 1.0, 1.0, 0.0);
+    phasors.erase("zVC");
+
+    // Through current on A and B, internal fault current on C
+    phasors["xRA"] = -phasors["xIA"];
+    phasors["xRB"] = -phasors["xIB"];
+    phasors["xRC"] = phasors["xIC"];
+    calculator.compute(phasors, out);
+
+    ASSERT_EQ(out.size(), 2u);                          // z is missing VC
+    EXPECT_EQ(out[0].name, "x");
+    EXPECT_NEAR(out[0].differential[0], 0.0, 1e-12);
+    EXPECT_NEAR(out[0].restraint[0], 2.0, 1e-12);
+    EXPECT_NEAR(out[0].differential[2], 4.0, 1e-12);
+
+    // Batched result matches a lone computation of the same group
+    EXPECT_EQ(out[1].name, "y");
+    expectNear(out[1].totalPower, 1500.0, 1e-9);
+    GroupCalculator lone;
+    std::vector<GroupQuantities> single;
+    lone.setGroups({makeGroup("y")});
+    lone.compute(phasors, single);
+    ASSERT_EQ(single.size(), 1u);
+    expectNear(single[0].impedance[4], out[1].impedance[4], 1e-12);
+    EXPECT_EQ(out[1].differential[0], 0.0);             // No remote currents configured
+}
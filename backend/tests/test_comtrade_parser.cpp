@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "comtrade_parser.hpp"
+#include "comtrade_writer.hpp"
 #include <fstream>
 #include <cstdio>
 #include <cmath>
@@ -365,3 +366,63 @@ TEST_F(ComtradeParserTest, GetSampleRate) {
     EXPECT_DOUBLE_EQ(parser.getSampleRate(50), 4800.0);
     EXPECT_DOUBLE_EQ(parser.getSampleRate(99), 4800.0);
 }
+
+// Test that ComtradeWriter output reads back through the parser
+TEST_F(ComtradeParserTest, WriterRoundTrip) {
+    ComtradeConfig config;
+    config.stationName = "RT_STATION";
+    config.recDeviceId = "VTS";
+    for (const char* name : {"IA", "VA"}) {
+        AnalogChannel channel{};
+        channel.name = name;
+        channel.units = name[0] == 'I' ? "A" : "V";
+        config.analogChannels.push_back(channel);
+    }
+    for (const char* name : {"TRIP", "52A"}) {
+        DigitalChannel channel{};
+        channel.name = name;
+        config.digitalChannels.push_back(channel);
+    }
+    config.lineFreq = 50.0;
+    config.sampleRates.push_back({4000.0, 0});
+    ComtradeWriter::formatTimestamp(1735689600.25, config.startDate, config.startTime);
+    config.triggerDate = config.startDate;
+    config.triggerTime = config.startTime;
+    EXPECT_EQ(config.startDate, "01/01/2025");
+    EXPECT_EQ(config.startTime, "00:00:00.250000");
+
+    const int rows = 200;
+    std::vector<double> analog;
+    std::vector<uint64_t> digital;
+    for (int r = 0; r < rows; r++) {
+        analog.push_back(1500.0 * std::sin(2.0 * M_PI * 50.0 * r / 4000.0));
+        analog.push_back(-63.5 + 0.01 * r);
+        digital.push_back(r >= 100 ? 0x1u : 0x2u);
+    }
+
+    ComtradeWriter writer;
+    ASSERT_TRUE(writer.write(testDir_ + "rt", config, analog, digital)) << writer.getLastError();
+
+    ComtradeParser parser;
+    ASSERT_TRUE(parser.load(testDir_ + "rt.cfg")) << parser.getLastError();
+    const ComtradeConfig& read = parser.getConfig();
+    EXPECT_EQ(read.stationName, "RT_STATION");
+    EXPECT_EQ(read.dataFormat, DataFormat::BINARY);
+    EXPECT_EQ(read.numAnalogChannels, 2);
+    EXPECT_EQ(read.numDigitalChannels, 2);
+    EXPECT_EQ(read.analogChannels[1].units, "V");
+    EXPECT_DOUBLE_EQ(read.lineFreq, 50.0);
+    EXPECT_DOUBLE_EQ(read.sampleRates[0].rate, 4000.0);
+    ASSERT_EQ(parser.getTotalSamples(), rows);
+
+    for (int r = 0; r < rows; r += 17) {
+        ComtradeSample sample;
+        ASSERT_TRUE(parser.getSample(r, sample));
+        EXPECT_EQ(sample.timestamp, static_cast<uint64_t>(r * 250));
+        // 16-bit quantisation of each channel's peak
+        EXPECT_NEAR(sample.analogValues[0], analog[2 * r], 1500.0 / 32767.0);
+        EXPECT_NEAR(sample.analogValues[1], analog[2 * r + 1], 63.5 / 32767.0);
+        EXPECT_EQ(sample.digitalValues[0], r >= 100);
+        EXPECT_EQ(sample.digitalValues[1], r < 100);
+    }
+}
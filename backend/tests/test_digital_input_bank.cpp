@@ -0,0 +1,118 @@
+/**
+ * @file test_digital_input_bank.cpp
+ * @brief Unit tests for the packed binary input bank
+ *
+ * Tests cover:
+ * - Set/get across word boundaries, per-word version counters
+ * - Mask any/all tests
+ * - Change event ring ordering, timestamps and overrun accounting
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "digital_input_bank.hpp"
+
+class DigitalInputBankTest : public ::testing::Test {
+protected:
+    DigitalInputBank bank{4096, 16};
+
+    std::vector<DigitalInputEvent> drain(uint64_t& cursor, uint64_t* lost = nullptr) {
+        std::vector<DigitalInputEvent> out(64);
+        out.resize(bank.readEvents(cursor, out.data(), out.size(), lost));
+        return out;
+    }
+};
+
+TEST_F(DigitalInputBankTest, SetGetAcrossWords) {
+    EXPECT_EQ(bank.size(), 4096u);
+    EXPECT_EQ(bank.wordCount(), 64u);
+
+    EXPECT_TRUE(bank.set(0, true));
+    EXPECT_TRUE(bank.set(63, true));
+    EXPECT_TRUE(bank.set(64, true));
+    EXPECT_TRUE(bank.set(4095, true));
+    EXPECT_TRUE(bank.get(0));
+    EXPECT_TRUE(bank.get(63));
+    EXPECT_TRUE(bank.get(64));
+    EXPECT_TRUE(bank.get(4095));
+    EXPECT_FALSE(bank.get(1));
+    EXPECT_EQ(bank.word(0), 0x8000000000000001ull);
+    EXPECT_EQ(bank.word(1), 1ull);
+
+    EXPECT_FALSE(bank.set(4096, true));  // Out of range
+}
+
+TEST_F(DigitalInputBankTest, VersionCountsChangesOnly) {
+    EXPECT_EQ(bank.wordVersion(2), 0u);
+    EXPECT_TRUE(bank.set(130, true));
+    EXPECT_FALSE(bank.set(130, true));   // Same value: no change
+    EXPECT_EQ(bank.wordVersion(2), 1u);
+    EXPECT_TRUE(bank.set(130, false));
+    EXPECT_EQ(bank.wordVersion(2), 2u);
+    EXPECT_EQ(bank.wordVersion(3), 0u);
+}
+
+TEST_F(DigitalInputBankTest, MaskAnyAll) {
+    DigitalInputMask mask{5, 70, 1000};
+    EXPECT_EQ(mask.words().size(), 3u);
+    EXPECT_FALSE(bank.any(mask));
+
+    bank.set(70, true);
+    EXPECT_TRUE(bank.any(mask));
+    EXPECT_FALSE(bank.all(mask));
+
+    bank.set(5, true);
+    bank.set(1000, true);
+    EXPECT_TRUE(bank.all(mask));
+
+    mask.add(6);
+    EXPECT_EQ(mask.words().size(), 3u);  // Same word as input 5
+    EXPECT_FALSE(bank.all(mask));
+}
+
+TEST_F(DigitalInputBankTest, EventsInOrderWithTimestamps) {
+    uint64_t cursor = bank.eventHead();
+    bank.set(3, true, 100);
+    bank.set(3, true, 150);   // No change, no event
+    bank.set(200, true, 200);
+    bank.set(3, false, 300);
+
+    auto events = drain(cursor);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].index, 3u);
+    EXPECT_TRUE(events[0].value);
+    EXPECT_EQ(events[0].timestampNs, 100u);
+    EXPECT_EQ(events[1].index, 200u);
+    EXPECT_EQ(events[2].index, 3u);
+    EXPECT_FALSE(events[2].value);
+    EXPECT_EQ(events[2].timestampNs, 300u);
+
+    EXPECT_TRUE(drain(cursor).empty());
+}
+
+TEST_F(DigitalInputBankTest, EventOverrunIsCounted) {
+    uint64_t cursor = bank.eventHead();
+    for (uint64_t i = 0; i < 20; ++i) {
+        bank.set(static_cast<size_t>(i), true, i);
+    }
+    uint64_t lost = 0;
+    auto events = drain(cursor, &lost);
+    EXPECT_EQ(lost, 4u);
+    ASSERT_EQ(events.size(), 16u);
+    EXPECT_EQ(events.front().index, 4u);
+    EXPECT_EQ(events.back().index, 19u);
+}
+
+TEST_F(DigitalInputBankTest, ClearRecordsFallingEdges) {
+    bank.set(1, true);
+    bank.set(500, true);
+    uint64_t cursor = bank.eventHead();
+    bank.clear();
+    EXPECT_FALSE(bank.get(1));
+    EXPECT_FALSE(bank.get(500));
+
+    auto events = drain(cursor);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_FALSE(events[0].value);
+    EXPECT_FALSE(events[1].value);
+}
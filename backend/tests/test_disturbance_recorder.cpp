@@ -0,0 +1,228 @@
+/**
+ * @file test_disturbance_recorder.cpp
+ * @brief Unit tests for the analyzer's triggered COMTRADE recorder
+ *
+ * Tests cover:
+ * - Over-current trigger with pre/post-trigger windows read back as COMTRADE
+ * - Retriggers extending a record up to maxLength, then starting the next
+ * - GOOSE trip and dV/dt edges, digital channels in the output
+ * - Bursts beyond the queue are dropped, never blocking; config validation
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include "comtrade_parser.hpp"
+#include "digital_input_bank.hpp"
+#include "disturbance_recorder.hpp"
+
+using vts::analyzer::DisturbanceRecorder;
+using vts::analyzer::RecorderConfig;
+using vts::analyzer::RecorderStatus;
+using vts::analyzer::RecorderTrigger;
+using vts::io::ComtradeParser;
+using vts::io::ComtradeSample;
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr double SampleRate = 4800.0;
+
+} // namespace
+
+class DisturbanceRecorderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = (std::filesystem::temp_directory_path() / "vts_recorder_test").string();
+        std::filesystem::remove_all(directory_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    RecorderConfig makeConfig() {
+        RecorderConfig config;
+        config.enabled = true;
+        config.directory = directory_;
+        config.channels = {"IA", "IB", "VA"};
+        return config;
+    }
+
+    // One row per call: IA with the given amplitude, IB and VA fixed
+    void feed(DisturbanceRecorder& recorder, double seconds, double amplitude) {
+        const int n = static_cast<int>(seconds * SampleRate);
+        for (int i = 0; i < n; ++i) {
+            const double phase = 2.0 * Pi * 60.0 * static_cast<double>(row_) / SampleRate;
+            recorder.sample(0, amplitude * std::cos(phase));
+            recorder.sample(1, std::cos(phase - 2.0 * Pi / 3.0));
+            recorder.sample(2, 100.0 * std::cos(phase));
+            row_++;
+        }
+    }
+
+    std::string directory_;
+    long row_ = 0;
+};
+
+TEST_F(DisturbanceRecorderTest, OverCurrentWithPreAndPostTrigger) {
+    RecorderConfig config = makeConfig();
+    config.preTrigger = 0.1;
+    config.postTrigger = 0.2;
+    config.triggers.push_back({RecorderTrigger::Type::OverCurrent, "IA", 0, 5.0});
+
+    DisturbanceRecorder recorder(config, SampleRate, 60.0);
+    feed(recorder, 1.0, 1.0);
+    feed(recorder, 0.5, 10.0);
+    feed(recorder, 0.5, 1.0);
+    recorder.close();
+
+    const RecorderStatus status = recorder.status();
+    EXPECT_EQ(status.triggers, 1u);
+    EXPECT_EQ(status.dropped, 0u);
+    ASSERT_EQ(status.records, 1u);
+    ASSERT_EQ(status.recentFiles.size(), 1u);
+
+    ComtradeParser parser;
+    ASSERT_TRUE(parser.load(status.recentFiles[0])) << parser.getLastError();
+    EXPECT_EQ(parser.getConfig().stationName, "VTS");
+    EXPECT_EQ(parser.getConfig().numAnalogChannels, 3);
+    EXPECT_DOUBLE_EQ(parser.getConfig().sampleRates[0].rate, SampleRate);
+    EXPECT_EQ(parser.getTotalSamples(), 480 + 1 + 960);
+
+    // Pre-trigger history is healthy, the tail is all fault
+    const std::vector<ComtradeSample> samples = parser.getAllSamples();
+    double early = 0.0;
+    double late = 0.0;
+    double voltage = 0.0;
+    for (int i = 0; i < 80; ++i) {
+        early = std::max(early, std::abs(samples[static_cast<size_t>(i)].analogValues[0]));
+        late = std::max(late, std::abs(samples[samples.size() - 1 - static_cast<size_t>(i)].analogValues[0]));
+        voltage = std::max(voltage, std::abs(samples[static_cast<size_t>(i)].analogValues[2]));
+    }
+    EXPECT_NEAR(early, 1.0, 0.01);
+    EXPECT_NEAR(late, 10.0, 0.01);
+    EXPECT_NEAR(voltage, 100.0, 0.01);
+}
+
+TEST_F(DisturbanceRecorderTest, RetriggersExtendThenSplit) {
+    DigitalInputBank inputs(64, 64);
+    RecorderConfig config = makeConfig();
+    config.preTrigger = 0.05;
+    config.postTrigger = 0.2;
+    config.maxLength = 0.6;
+    config.digitalInputs = {3};
+    config.triggers.push_back({RecorderTrigger::Type::DigitalChange, "", 7, 0.0});
+
+    DisturbanceRecorder recorder(config, SampleRate, 60.0, &inputs);
+    EXPECT_EQ(recorder.config().digitalInputs, (std::vector<size_t>{3, 7}));
+    feed(recorder, 0.5, 1.0);
+    inputs.set(3, true);
+    for (int toggle = 0; toggle < 5; ++toggle) {
+        inputs.set(7, toggle % 2 == 0);
+        feed(recorder, 0.15, 1.0);
+    }
+    // Real-time input gives the writer ~1.7 s to copy the first record out of the ring
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    feed(recorder, 1.0, 1.0);
+    recorder.close();
+
+    // Edges at +0, +.15 and +.30 s fit in 0.6 s with the .05 s pre-trigger;
+    // +.45 starts a second record, which absorbs +.60
+    const RecorderStatus status = recorder.status();
+    EXPECT_EQ(status.triggers, 5u);
+    ASSERT_EQ(status.records, 2u) << status.dropped << " " << status.writeErrors << " " << status.lastError;
+
+    ComtradeParser first;
+    ASSERT_TRUE(first.load(status.recentFiles[0]));
+    EXPECT_EQ(first.getTotalSamples(), 240 + 2 * 720 + 1 + 960);
+    EXPECT_EQ(first.getConfig().digitalChannels[1].name, "IN7");
+    ComtradeSample sample;
+    ASSERT_TRUE(first.getSample(0, sample));
+    EXPECT_FALSE(sample.digitalValues[0]);
+    EXPECT_FALSE(sample.digitalValues[1]);
+    ASSERT_TRUE(first.getSample(240 + 1, sample));
+    EXPECT_TRUE(sample.digitalValues[0]);
+    EXPECT_TRUE(sample.digitalValues[1]);
+
+    ComtradeParser second;
+    ASSERT_TRUE(second.load(status.recentFiles[1]));
+    EXPECT_EQ(second.getTotalSamples(), 240 + 720 + 1 + 960);
+}
+
+TEST_F(DisturbanceRecorderTest, GooseTripAndRateOfChange) {
+    std::atomic<bool> trip{false};
+    RecorderConfig config = makeConfig();
+    config.preTrigger = 0.02;
+    config.postTrigger = 0.05;
+    config.triggers.push_back({RecorderTrigger::Type::GooseTrip, "", 0, 0.0});
+    // 1 unit at 60 Hz changes at most ~377 units/s; a step is far steeper
+    config.triggers.push_back({RecorderTrigger::Type::RateOfChange, "IB", 0, 1000.0});
+
+    DisturbanceRecorder recorder(config, SampleRate, 60.0, nullptr, &trip);
+    feed(recorder, 0.5, 1.0);
+    trip = true;
+    feed(recorder, 0.5, 1.0);
+    trip = false;
+    feed(recorder, 0.2, 1.0);
+    recorder.sample(0, 0.0);
+    recorder.sample(1, 50.0);                 // Step on IB
+    recorder.sample(2, 0.0);
+    feed(recorder, 0.5, 1.0);
+    recorder.close();
+
+    const RecorderStatus status = recorder.status();
+    EXPECT_EQ(status.triggers, 2u);           // The step back down is the same edge
+    EXPECT_EQ(status.records, 2u);
+}
+
+TEST_F(DisturbanceRecorderTest, BurstsDropInsteadOfBlocking) {
+    DigitalInputBank inputs(64, 64);
+    RecorderConfig config = makeConfig();
+    config.preTrigger = 0.0;
+    config.postTrigger = 0.001;
+    config.maxLength = 0.001;
+    config.triggers.push_back({RecorderTrigger::Type::DigitalChange, "", 0, 0.0});
+
+    DisturbanceRecorder recorder(config, SampleRate, 60.0, &inputs);
+    feed(recorder, 0.01, 1.0);
+    for (int i = 0; i < 100; ++i) {
+        inputs.set(0, i % 2 == 0);
+        for (int r = 0; r < 10; ++r) {
+            recorder.sample(0, 0.0);
+        }
+    }
+    recorder.close();
+
+    const RecorderStatus status = recorder.status();
+    EXPECT_EQ(status.triggers, 100u);
+    EXPECT_EQ(status.records + status.dropped, 100u);
+    EXPECT_EQ(status.writeErrors, 0u);
+}
+
+TEST_F(DisturbanceRecorderTest, RejectsInvalidConfig) {
+    RecorderConfig config = makeConfig();
+    config.triggers.push_back({RecorderTrigger::Type::OverCurrent, "IC", 0, 5.0});
+    EXPECT_THROW(DisturbanceRecorder::validate(config, SampleRate, 0), std::invalid_argument);
+
+    config = makeConfig();
+    config.maxLength = 0.3;
+    EXPECT_THROW(DisturbanceRecorder::validate(config, SampleRate, 0), std::invalid_argument);
+
+    config = makeConfig();
+    config.stationName = "A,B";
+    EXPECT_THROW(DisturbanceRecorder::validate(config, SampleRate, 0), std::invalid_argument);
+
+    config = makeConfig();
+    config.digitalInputs = {4096};
+    EXPECT_THROW(DisturbanceRecorder::validate(config, SampleRate, 4096), std::invalid_argument);
+
+    config = makeConfig();
+    config.channels.clear();                 // Defaults to Ch0-Ch7
+    config.triggers.push_back({RecorderTrigger::Type::RateOfChange, "Ch7", 0, 1.0});
+    EXPECT_NO_THROW(DisturbanceRecorder::validate(config, SampleRate, 0));
+}
@@ -0,0 +1,333 @@
+/**
+ * @file test_fault_transient.cpp
+ * @brief Unit tests for time-domain fault transient synthesis
+ *
+ * Tests cover:
+ * - Current continuity at inception and DC offset decay with the loop X/R
+ * - Steady state against the ImpedanceCalculator phasors, block/streaming agreement
+ * - Streamed samples in secondary units through the CT/VT ratios
+ * - A 20 kA fault published with the 9-2LE scaling, unclipped
+ * - CT saturation and CVT subsidence transients, config validation
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "fault_transient.hpp"
+#include "frame_loopback.hpp"
+
+using namespace vts::testers;
+
+namespace {
+
+constexpr size_t Ch = FaultTransientGenerator::Channels;
+
+FaultTransientConfig boltedAg() {
+    FaultTransientConfig config;
+    config.faultType = FaultType::AG;
+    config.frequency = 60.0;
+    config.sampleRate = 4800.0;
+    config.prefaultDuration = 0.05;
+    config.faultDuration = 0.5;
+    config.ctRatio = 1.0;                           // next() in primary units
+    config.vtRatio = 1.0;
+    return config;
+}
+
+// sqrt(2) |p| sin(theta + arg p)
+double instantaneous(std::complex<double> p, double theta) {
+    return std::sqrt(2.0) * std::abs(p) * std::sin(theta + std::arg(p));
+}
+
+// Average over the last whole cycle ending at sample `end` (the DC component)
+double cycleMean(const std::vector<double>& wave, size_t end, size_t channel, size_t perCycle) {
+    double sum = 0.0;
+    for (size_t k = end - perCycle; k < end; ++k) {
+        sum += wave[k * Ch + channel];
+    }
+    return sum / static_cast<double>(perCycle);
+}
+
+} // namespace
+
+class FaultTransientTest : public ::testing::Test {};
+
+TEST_F(FaultTransientTest, CurrentIsContinuousAtInception) {
+    FaultTransientConfig config = boltedAg();
+    config.loadCurrent = std::polar(400.0, -0.3);
+    FaultTransientGenerator generator(config);
+    const std::vector<double> wave = generator.render();
+    ASSERT_EQ(wave.size(), generator.totalSamples() * Ch);
+
+    // The fault current is ~20x the load, yet the first fault sample only
+    // moves by one sample's worth of the pre-fault slope plus the DC decay
+    const size_t n = static_cast<size_t>(generator.inceptionSample());
+    const double pre = wave[(n - 1) * Ch];
+    const double at = wave[n * Ch];
+    const double peak = std::sqrt(2.0) * std::abs(generator.faultState().current.A);
+    EXPECT_LT(std::fabs(at - pre), 0.1 * peak);
+    EXPECT_NEAR(at, instantaneous(config.loadCurrent, 0.0), 1e-6 * peak);
+
+    // Pre-fault current is the load, neutral is the residual
+    EXPECT_NEAR(wave[(n - 1) * Ch + 3], wave[(n - 1) * Ch] + wave[(n - 1) * Ch + 1] + wave[(n - 1) * Ch + 2], 1e-9);
+}
+
+TEST_F(FaultTransientTest, DcOffsetDependsOnInceptionAngleAndDecays) {
+    FaultTransientConfig config = boltedAg();
+    config.xOverR = 10.0;
+    const size_t perCycle = 80;
+
+    config.inceptionAngle = 0.0;                    // Voltage zero: worst offset
+    FaultTransientGenerator zero(config);
+    config.inceptionAngle = 90.0;                   // Voltage peak: little offset
+    FaultTransientGenerator peak(config);
+    EXPECT_NEAR(zero.timeConstant(), 10.0 / (2.0 * M_PI * 60.0), 1e-12);
+
+    const std::vector<double> a = zero.render();
+    const std::vector<double> b = peak.render();
+    const size_t n = static_cast<size_t>(zero.inceptionSample());
+    const double amplitude = std::sqrt(2.0) * std::abs(zero.faultState().current.A);
+
+    const double dcZero = std::fabs(cycleMean(a, n + perCycle, 0, perCycle));
+    const double dcPeak = std::fabs(cycleMean(b, n + perCycle, 0, perCycle));
+    EXPECT_GT(dcZero, 0.5 * amplitude);
+    EXPECT_GT(dcZero, 4.0 * dcPeak);
+
+    // One cycle later the offset has shrunk by exp(-T / tau)
+    const double later = std::fabs(cycleMean(a, n + 2 * perCycle, 0, perCycle));
+    const double expectedRatio = std::exp(-(1.0 / 60.0) / zero.timeConstant());
+    EXPECT_NEAR(later / dcZero, expectedRatio, 0.01);
+}
+
+TEST_F(FaultTransientTest, SettlesToCalculatorPhasors) {
+    FaultTransientConfig config = boltedAg();
+    config.faultType = FaultType::BC;
+    config.faultZ = {0.5, 2.0};
+    config.inceptionAngle = 17.0;
+    FaultTransientGenerator generator(config);
+    const std::vector<double> wave = generator.render();
+
+    ImpedanceCalculator calculator;
+    const PhasorState expected = calculator.calculateFault(config.faultType, config.faultZ, config.source);
+    const std::complex<double> phasors[8] = {
+        expected.current.A, expected.current.B, expected.current.C, 0.0,
+        expected.voltage.A, expected.voltage.B, expected.voltage.C, 0.0};
+
+    // Well past 10 tau: sample k after inception is at angle inception + w k dt
+    const double omega = 2.0 * M_PI * config.frequency;
+    const size_t n = static_cast<size_t>(generator.inceptionSample());
+    ASSERT_LT(20.0 * generator.timeConstant(), config.faultDuration);
+    for (size_t k = wave.size() / Ch - 10; k < wave.size() / Ch; ++k) {
+        const double theta = config.inceptionAngle * M_PI / 180.0 +
+                             omega * static_cast<double>(k - n) / config.sampleRate;
+        for (size_t c : {0u, 1u, 2u, 4u, 5u, 6u}) {
+            const double scale = std::sqrt(2.0) * std::max(std::abs(phasors[c]), 1.0);
+            EXPECT_NEAR(wave[k * Ch + c], instantaneous(phasors[c], theta), 1e-6 * scale)
+                << "sample " << k << " channel " << c;
+        }
+    }
+}
+
+TEST_F(FaultTransientTest, StreamingMatchesRender) {
+    FaultTransientConfig config = boltedAg();
+    config.cvt.enabled = true;
+    config.ct.enabled = true;
+    config.ct.kneeVoltage = 50.0;
+    FaultTransientGenerator generator(config);
+    const std::vector<double> wave = generator.render();
+
+    // next() crosses block boundaries and pads extra channels with zeros
+    generator.reset();
+    double frame[10];
+    size_t count = 0;
+    while (generator.next(frame, 10)) {
+        ASSERT_LT(count, wave.size() / Ch);
+        for (size_t c = 0; c < Ch; ++c) {
+            ASSERT_DOUBLE_EQ(frame[c], wave[count * Ch + c]) << "sample " << count;
+        }
+        EXPECT_EQ(frame[8], 0.0);
+        EXPECT_EQ(frame[9], 0.0);
+        count++;
+    }
+    EXPECT_EQ(count, generator.totalSamples());
+    EXPECT_EQ(generator.position(), generator.totalSamples());
+
+    // Unbounded sources keep going
+    config.faultDuration = 0.0;
+    FaultTransientGenerator open(config);
+    EXPECT_TRUE(open.render().empty());
+    for (int k = 0; k < 2000; ++k) {
+        ASSERT_TRUE(open.next(frame, 8));
+    }
+}
+
+TEST_F(FaultTransientTest, StreamingIsInSecondaryUnits) {
+    FaultTransientConfig config = boltedAg();
+    config.ctRatio = 240.0;
+    config.vtRatio = 1000.0;
+    FaultTransientGenerator generator(config);
+    const std::vector<double> wave = generator.render();
+
+    generator.reset();
+    double frame[Ch];
+    for (size_t k = 0; k < wave.size() / Ch; ++k) {
+        ASSERT_TRUE(generator.next(frame, Ch));
+        for (size_t c = 0; c < Ch; ++c) {
+            const double ratio = c < 4 ? 240.0 : 1000.0;
+            ASSERT_NEAR(frame[c], wave[k * Ch + c] / ratio, 1e-12 * std::fabs(wave[k * Ch + c]))
+                << "sample " << k << " channel " << c;
+        }
+    }
+}
+
+TEST_F(FaultTransientTest, CtSaturationClipsSecondaryCurrent) {
+    FaultTransientConfig config = boltedAg();
+    config.xOverR = 20.0;
+    config.ct.enabled = true;
+    config.ct.kneeVoltage = 1e6;                    // Never saturates
+    FaultTransientGenerator linear(config);
+    config.ct.kneeVoltage = 40.0;
+    FaultTransientGenerator saturating(config);
+    config.ct.enabled = false;
+    FaultTransientGenerator ideal(config);
+
+    const std::vector<double> l = linear.render();
+    const std::vector<double> s = saturating.render();
+    const std::vector<double> i = ideal.render();
+
+    // Unsaturated CT: secondary (in primary amperes) tracks the primary
+    double worstLinear = 0.0, worstSaturated = 0.0, peakIdeal = 0.0;
+    for (size_t k = 0; k < i.size() / Ch; ++k) {
+        worstLinear = std::max(worstLinear, std::fabs(l[k * Ch] - i[k * Ch]));
+        worstSaturated = std::max(worstSaturated, std::fabs(s[k * Ch] - i[k * Ch]));
+        peakIdeal = std::max(peakIdeal, std::fabs(i[k * Ch]));
+    }
+    EXPECT_LT(worstLinear, 0.01 * peakIdeal);
+    EXPECT_GT(worstSaturated, 0.3 * peakIdeal);
+
+    // Saturation only loses current, and the neutral is still the residual
+    const size_t n = static_cast<size_t>(saturating.inceptionSample());
+    double energyIdeal = 0.0, energySaturated = 0.0;
+    for (size_t k = n; k < n + 160; ++k) {
+        energyIdeal += i[k * Ch] * i[k * Ch];
+        energySaturated += s[k * Ch] * s[k * Ch];
+        EXPECT_NEAR(s[k * Ch + 3], s[k * Ch] + s[k * Ch + 1] + s[k * Ch + 2], 1e-6 * peakIdeal);
+    }
+    EXPECT_LT(energySaturated, energyIdeal);
+}
+
+TEST_F(FaultTransientTest, CvtTransientDecaysToSteadyState) {
+    FaultTransientConfig config = boltedAg();
+    config.inceptionAngle = 90.0;                   // Largest voltage step
+    FaultTransientGenerator ideal(config);
+    config.cvt.enabled = true;
+    config.cvt.decayMs = 10.0;
+    config.cvt.ringHz = 30.0;
+    FaultTransientGenerator cvt(config);
+
+    const std::vector<double> i = ideal.render();
+    const std::vector<double> c = cvt.render();
+    const size_t n = static_cast<size_t>(cvt.inceptionSample());
+    const size_t va = 4;
+
+    // Identical before inception; continuous through it
+    for (size_t k = 0; k < n; ++k) {
+        ASSERT_DOUBLE_EQ(c[k * Ch + va], i[k * Ch + va]);
+    }
+    EXPECT_NEAR(c[n * Ch + va], c[(n - 1) * Ch + va], 0.1 * std::sqrt(2.0) * config.source.Vprefault);
+    EXPECT_GT(std::fabs(c[n * Ch + va] - i[n * Ch + va]), 0.1 * config.source.Vprefault);
+
+    // After ~15 time constants the CVT output is the ideal fault voltage
+    const size_t settled = n + static_cast<size_t>(0.15 * config.sampleRate);
+    for (size_t k = settled; k < settled + 80; ++k) {
+        EXPECT_NEAR(c[k * Ch + va], i[k * Ch + va], 1e-3 * config.source.Vprefault);
+    }
+}
+
+TEST_F(FaultTransientTest, RejectsInvalidConfig) {
+    FaultTransientConfig config = boltedAg();
+    config.sampleRate = 0.0;
+    EXPECT_THROW(FaultTransientGenerator{config}, std::invalid_argument);
+
+    config = boltedAg();
+    config.faultDuration = -1.0;
+    EXPECT_THROW(FaultTransientGenerator{config}, std::invalid_argument);
+
+    config = boltedAg();
+    config.ct.enabled = true;
+    config.ct.kneeCurrent = 0.0;
+    EXPECT_THROW(FaultTransientGenerator{config}, std::invalid_argument);
+
+    config = boltedAg();
+    config.cvt.enabled = true;
+    config.cvt.decayMs = 0.0;
+    EXPECT_THROW(FaultTransientGenerator{config}, std::invalid_argument);
+
+    config = boltedAg();
+    config.vtRatio = 0.0;
+    EXPECT_THROW(FaultTransientGenerator{config}, std::invalid_argument);
+
+    // No default ratios: an unset one is an error, not primary units
+    config = FaultTransientConfig{};
+    config.ctRatio = 240.0;
+    EXPECT_THROW(FaultTransientGenerator{config}, std::invalid_argument);
+}
+
+TEST_F(FaultTransientTest, PublishedFaultIsNotClipped) {
+    // ~20 kA bolted fault behind a stiff source, 1200:5 CT and 115 kV:115 V VT
+    FaultTransientConfig config = boltedAg();
+    config.source = {0.19, 1.9, 0.57, 5.7, 66395.0};
+    config.prefaultDuration = 0.02;
+    config.faultDuration = 0.1;
+    config.ctRatio = 240.0;
+    config.vtRatio = 1000.0;
+    FaultTransientGenerator reference(config);
+    ASSERT_GT(std::abs(reference.faultState().current.A), 20000.0);
+    const std::vector<double> wave = reference.render();
+
+    SVConfig sv;
+    sv.appId = "4000";
+    sv.macDst = "01:0c:cd:04:00:01";
+    sv.macSrc = "02:00:00:00:00:01";
+    sv.vlanId = 0;
+    sv.vlanPrio = 4;
+    sv.svId = "FaultSV";
+    sv.nominalFreq = 60.0;
+    sv.sampleRate = 4800;
+    sv.dataSource = DataSource::MANUAL;
+
+    auto loopback = std::make_shared<FrameLoopback>();
+    std::vector<std::vector<int32_t>> frames;
+    loopback->attach([&frames](const uint8_t* frame, size_t length) {
+        // seqData is the frame's tail: INT32 value + quality per channel
+        const size_t seqData = length - Ch * 8;
+        ASSERT_EQ(frame[seqData - 2], 0x87);
+        std::vector<int32_t> values(Ch);
+        for (size_t c = 0; c < Ch; ++c) {
+            const uint8_t* v = frame + seqData + c * 8;
+            values[c] = static_cast<int32_t>((uint32_t(v[0]) << 24) | (uint32_t(v[1]) << 16) |
+                                             (uint32_t(v[2]) << 8) | uint32_t(v[3]));
+        }
+        frames.push_back(values);
+    });
+    SVPublisherInstance publisher("sv1", sv, loopback);
+    publisher.setSampleSource(std::make_shared<FaultTransientGenerator>(config));
+    publisher.start();
+    for (uint64_t k = 0; k < reference.totalSamples(); ++k) {
+        publisher.tick();
+    }
+    ASSERT_EQ(frames.size(), reference.totalSamples());
+
+    // 1 mA / 10 mV per LSB, DC offset included: well past the old ±10 unit clamp
+    int32_t peakCurrent = 0;
+    for (size_t k = 0; k < frames.size(); ++k) {
+        for (size_t c = 0; c < Ch; ++c) {
+            const double expected = wave[k * Ch + c] / (c < 4 ? 240.0 : 1000.0) * (c < 4 ? 1000.0 : 100.0);
+            ASSERT_NEAR(frames[k][c], expected, 1.0) << "sample " << k << " channel " << c;
+        }
+        peakCurrent = std::max(peakCurrent, std::abs(frames[k][0]));
+    }
+    EXPECT_GT(peakCurrent, 20000 * 1000 / 240);
+}
@@ -0,0 +1,296 @@
+/**
+ * @file test_impairment_stage.cpp
+ * @brief Unit tests for the publisher-side network impairment stage
+ *
+ * Tests cover:
+ * - Pass-through with no profile and seeded, repeatable impairment patterns
+ * - Loss bursts, duplication, delay/reorder release through poll()
+ * - smpCnt shifts on single- and multi-ASDU SV frames, event log contents
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "impairment_stage.hpp"
+#include "load_generator.hpp"
+
+namespace {
+
+std::vector<uint8_t> numbered(uint32_t n) {
+    std::vector<uint8_t> frame(64, 0);
+    frame[12] = 0x08;                               // Not SV
+    frame[20] = static_cast<uint8_t>(n >> 8);
+    frame[21] = static_cast<uint8_t>(n);
+    return frame;
+}
+
+uint32_t numberOf(const std::vector<uint8_t>& frame) {
+    return static_cast<uint32_t>(frame[20] << 8 | frame[21]);
+}
+
+} // namespace
+
+class ImpairmentStageTest : public ::testing::Test {
+protected:
+    ImpairmentStage stage{64, 256};
+    std::vector<std::vector<uint8_t>> sent;
+    std::string error;
+
+    void submit(const std::vector<uint8_t>& frame, uint64_t nowNs) {
+        stage.submit(frame.data(), frame.size(), nowNs, [this](const uint8_t* data, size_t length) {
+            sent.emplace_back(data, data + length);
+        });
+    }
+
+    void poll(uint64_t nowNs) {
+        stage.poll(nowNs, [this](const uint8_t* data, size_t length) {
+            sent.emplace_back(data, data + length);
+        });
+    }
+
+    std::vector<uint32_t> run(const ImpairmentProfile& profile, uint32_t frames) {
+        EXPECT_TRUE(stage.setProfile(profile, error)) << error;
+        sent.clear();
+        for (uint32_t i = 0; i < frames; ++i) {
+            submit(numbered(i), 1000000 + uint64_t(i) * 250000);
+            poll(1000000 + uint64_t(i) * 250000);
+        }
+        poll(UINT64_MAX / 2);
+        std::vector<uint32_t> order;
+        for (const auto& f : sent) order.push_back(numberOf(f));
+        return order;
+    }
+};
+
+TEST_F(ImpairmentStageTest, PassesThroughWithoutProfile) {
+    for (uint32_t i = 0; i < 10; ++i) {
+        submit(numbered(i), i);
+    }
+    ASSERT_EQ(sent.size(), 10u);
+    for (uint32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(numberOf(sent[i]), i);
+    }
+    // Idle: straight to send, not counted
+    EXPECT_TRUE(stage.idle());
+    const ImpairmentCounters c = stage.counters();
+    EXPECT_EQ(c.submitted, 0u);
+    EXPECT_EQ(c.sent, 0u);
+    EXPECT_EQ(c.dropped, 0u);
+    EXPECT_EQ(stage.nextDeadline(), UINT64_MAX);
+}
+
+TEST_F(ImpairmentStageTest, IdleUntilAProfileOrPendingFrames) {
+    ImpairmentProfile profile;
+    profile.delayNs = 1000000;
+    ASSERT_TRUE(stage.setProfile(profile, error)) << error;
+    EXPECT_FALSE(stage.idle());                 // Switch waiting for the next submit
+
+    submit(numbered(0), 1000);
+    ASSERT_TRUE(stage.setProfile(ImpairmentProfile(), error)) << error;
+    submit(numbered(1), 2000);                  // Cleared, but frame 0 is still held
+    EXPECT_FALSE(stage.idle());
+    EXPECT_EQ(stage.counters().submitted, 2u);
+
+    poll(1001000);
+    submit(numbered(2), 1002000);               // Drained: back to idle
+    EXPECT_TRUE(stage.idle());
+    submit(numbered(3), 1003000);
+    ASSERT_EQ(sent.size(), 4u);
+    EXPECT_EQ(numberOf(sent[0]), 1u);
+    EXPECT_EQ(numberOf(sent[1]), 0u);
+    EXPECT_EQ(stage.counters().submitted, 2u);
+}
+
+TEST_F(ImpairmentStageTest, SameSeedSamePattern) {
+    ImpairmentProfile profile;
+    profile.lossProbability = 0.1;
+    profile.duplicateProbability = 0.1;
+    profile.reorderProbability = 0.1;
+    profile.jitterNs = 100000;
+    profile.seed = 42;
+
+    const std::vector<uint32_t> first = run(profile, 500);
+    const std::vector<uint32_t> second = run(profile, 500);    // Republishing reseeds
+    EXPECT_EQ(first, second);
+
+    profile.seed = 43;
+    EXPECT_NE(run(profile, 500), first);
+}
+
+TEST_F(ImpairmentStageTest, DropsWholeBursts) {
+    ImpairmentProfile profile;
+    profile.lossProbability = 0.05;
+    profile.lossBurst = 4;
+    const std::vector<uint32_t> order = run(profile, 2000);
+
+    const ImpairmentCounters c = stage.counters();
+    EXPECT_GT(c.dropped, 0u);
+    EXPECT_EQ(c.dropped + order.size(), 2000u);
+    // Every gap is a multiple of the burst length (bursts may chain)
+    uint32_t expected = 0;
+    for (uint32_t n : order) {
+        EXPECT_EQ((n - expected) % 4, 0u) << "at frame " << n;
+        expected = n + 1;
+    }
+}
+
+TEST_F(ImpairmentStageTest, DuplicatesFrames) {
+    ImpairmentProfile profile;
+    profile.duplicateProbability = 1.0;
+    const std::vector<uint32_t> order = run(profile, 5);
+    EXPECT_EQ(order, (std::vector<uint32_t>{0, 0, 1, 1, 2, 2, 3, 3, 4, 4}));
+    EXPECT_EQ(stage.counters().duplicated, 5u);
+}
+
+TEST_F(ImpairmentStageTest, DelayedFramesWaitForPoll) {
+    ImpairmentProfile profile;
+    profile.delayNs = 2000000;
+    ASSERT_TRUE(stage.setProfile(profile, error)) << error;
+
+    submit(numbered(7), 10000000);
+    EXPECT_TRUE(sent.empty());
+    EXPECT_EQ(stage.nextDeadline(), 12000000u);
+    EXPECT_EQ(stage.counters().pending, 1u);
+
+    poll(11999999);
+    EXPECT_TRUE(sent.empty());
+    poll(12000000);
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_EQ(numberOf(sent[0]), 7u);
+    EXPECT_EQ(stage.counters().pending, 0u);
+
+    // Delays longer than one wheel rotation still come out on time
+    profile.delayNs = 50000000;
+    ASSERT_TRUE(stage.setProfile(profile, error)) << error;
+    submit(numbered(8), 20000000);
+    submit(numbered(9), 20010000);
+    poll(69999999);
+    EXPECT_EQ(sent.size(), 1u);
+    poll(70010000);
+    ASSERT_EQ(sent.size(), 3u);
+    EXPECT_EQ(numberOf(sent[1]), 8u);
+    EXPECT_EQ(numberOf(sent[2]), 9u);
+}
+
+TEST_F(ImpairmentStageTest, ReorderedFramesArriveLate) {
+    ImpairmentProfile profile;
+    profile.reorderProbability = 0.2;
+    profile.reorderDelayNs = 600000;              // Behind the next two frames
+    const std::vector<uint32_t> order = run(profile, 200);
+
+    ASSERT_EQ(order.size(), 200u);
+    const uint64_t reordered = stage.counters().reordered;
+    EXPECT_GT(reordered, 0u);
+    size_t late = 0;
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (order[i] < order[i - 1]) late++;
+    }
+    EXPECT_GT(late, 0u);
+    EXPECT_LE(late, reordered);
+}
+
+TEST_F(ImpairmentStageTest, ShiftsSmpCntInEveryAsdu) {
+    LoadGenerator generator;
+    LoadGenConfig config;
+    LoadGenSvGroup group;
+    group.sampleRate = 15360;
+    group.noAsdu = 8;
+    config.sv.push_back(group);
+    ASSERT_TRUE(generator.prepare(config, error)) << error;
+    size_t length = 0;
+    const uint8_t* rendered = generator.renderFrame(0, 3, length);
+    const std::vector<uint8_t> frame(rendered, rendered + length);
+
+    std::vector<size_t> offsets;
+    const size_t first = ImpairmentStage::findSmpCnt(frame.data(), frame.size(), &offsets);
+    ASSERT_EQ(offsets.size(), 8u);
+    EXPECT_EQ(first, offsets[0]);
+    EXPECT_EQ((frame[first] << 8 | frame[first + 1]), 24);
+    EXPECT_EQ(ImpairmentStage::findSmpCnt(numbered(1).data(), 64), 0u);
+
+    ImpairmentProfile profile;
+    profile.smpCntJumpProbability = 1.0;
+    profile.smpCntJump = -30;                     // Wraps below zero
+    ASSERT_TRUE(stage.setProfile(profile, error)) << error;
+    submit(frame, 0);
+    ASSERT_EQ(sent.size(), 1u);
+    for (size_t a = 0; a < offsets.size(); ++a) {
+        const uint16_t smpCnt = static_cast<uint16_t>(sent[0][offsets[a]] << 8 | sent[0][offsets[a] + 1]);
+        EXPECT_EQ(smpCnt, static_cast<uint16_t>(24 + a - 30));
+    }
+    sent[0][offsets[0]] = frame[offsets[0]];
+    sent[0][offsets[0] + 1] = frame[offsets[0] + 1];
+    EXPECT_NE(sent[0], frame);                    // Only smpCnt bytes differ
+    EXPECT_EQ(std::vector<uint8_t>(sent[0].begin(), sent[0].begin() + static_cast<long>(offsets[1])),
+              std::vector<uint8_t>(frame.begin(), frame.begin() + static_cast<long>(offsets[1])));
+
+    // The event names the frame and its original smpCnt
+    uint64_t cursor = 0;
+    ImpairmentEvent events[8];
+    const size_t n = stage.readEvents(cursor, events, 8);
+    ASSERT_EQ(n, 2u);
+    EXPECT_EQ(events[0].type, ImpairmentEventType::Profile);
+    EXPECT_EQ(events[1].type, ImpairmentEventType::SmpCntJump);
+    EXPECT_EQ(events[1].smpCnt, 24);
+    EXPECT_EQ(events[1].value, -30);
+    EXPECT_GT(events[1].timestampNs, 0u);
+}
+
+TEST_F(ImpairmentStageTest, EventLogReportsLoss) {
+    ImpairmentProfile profile;
+    profile.lossProbability = 1.0;
+    ASSERT_TRUE(stage.setProfile(profile, error)) << error;
+    for (uint32_t i = 0; i < 300; ++i) {
+        submit(numbered(i), i);
+    }
+    EXPECT_TRUE(sent.empty());
+
+    // 301 events in a 256-slot ring: the oldest are reported lost
+    uint64_t cursor = 0;
+    uint64_t lost = 0;
+    std::vector<ImpairmentEvent> events(512);
+    const size_t n = stage.readEvents(cursor, events.data(), events.size(), &lost);
+    EXPECT_EQ(n, 256u);
+    EXPECT_EQ(lost, 45u);
+    EXPECT_EQ(cursor, stage.eventHead());
+    EXPECT_EQ(events[n - 1].type, ImpairmentEventType::Drop);
+    EXPECT_EQ(events[n - 1].frame, 299u);
+    EXPECT_EQ(events[n - 1].smpCnt, -1);
+}
+
+TEST_F(ImpairmentStageTest, FullPoolCountsOverflow) {
+    ImpairmentProfile profile;
+    profile.delayNs = 1000000;
+    ASSERT_TRUE(stage.setProfile(profile, error)) << error;
+    for (uint32_t i = 0; i < 70; ++i) {
+        submit(numbered(i), 1000);
+    }
+    ImpairmentCounters c = stage.counters();
+    EXPECT_EQ(c.pending, 64u);
+    EXPECT_EQ(c.overflows, 6u);
+
+    poll(1001000);
+    EXPECT_EQ(sent.size(), 64u);
+    EXPECT_EQ(numberOf(sent.back()), 63u);
+    c = stage.counters();
+    EXPECT_EQ(c.sent, 64u);
+    EXPECT_EQ(c.pending, 0u);
+}
+
+TEST_F(ImpairmentStageTest, RejectsInvalidProfiles) {
+    ImpairmentProfile profile;
+    profile.lossProbability = 1.5;
+    EXPECT_FALSE(stage.setProfile(profile, error));
+    EXPECT_FALSE(error.empty());
+
+    profile = ImpairmentProfile();
+    profile.lossBurst = 0;
+    EXPECT_FALSE(stage.setProfile(profile, error));
+
+    profile = ImpairmentProfile();
+    profile.delayNs = Impairment_MaxDelayNs;
+    profile.jitterNs = 1;
+    EXPECT_FALSE(stage.setProfile(profile, error));
+
+    EXPECT_EQ(stage.profileVersion(), 1u);
+    EXPECT_FALSE(stage.profile().active());
+}
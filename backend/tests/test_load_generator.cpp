@@ -0,0 +1,187 @@
+/**
+ * @file test_load_generator.cpp
+ * @brief Unit tests for the process-bus load generator's stream building
+ *
+ * Tests cover:
+ * - Per-stream addressing (APPID, destination MAC, svID) from a group spec
+ * - SV smpCnt/sample patching for 1 and 8 ASDUs per frame
+ * - GOOSE retransmission vs state-change numbering
+ * - Drift-free frame offsets and spec validation
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "load_generator.hpp"
+
+namespace {
+
+size_t find(const uint8_t* frame, size_t length, std::initializer_list<uint8_t> pattern, size_t from = 0) {
+    const std::vector<uint8_t> p(pattern);
+    for (size_t i = from; i + p.size() <= length; ++i) {
+        if (std::equal(p.begin(), p.end(), frame + i)) return i;
+    }
+    return length;
+}
+
+uint32_t be32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+           static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+} // namespace
+
+class LoadGeneratorTest : public ::testing::Test {
+protected:
+    LoadGenerator generator;
+    std::string error;
+};
+
+TEST_F(LoadGeneratorTest, BuildsAddressedSvStreams) {
+    LoadGenConfig config;
+    LoadGenSvGroup group;
+    group.count = 3;
+    group.baseAppId = 0x4010;
+    group.baseDstMac = {0x01, 0x0C, 0xCD, 0x04, 0x00, 0xFF};
+    config.sv.push_back(group);
+    config.vlanId = 7;
+    config.vlanPriority = 5;
+    ASSERT_TRUE(generator.prepare(config, error)) << error;
+    ASSERT_EQ(generator.streamCount(), 3u);
+
+    size_t length = 0;
+    const uint8_t* frame = generator.renderFrame(2, 0, length);
+    EXPECT_EQ(frame[4], 0x01);                      // 0x00FF + 2 carries into byte 4
+    EXPECT_EQ(frame[5], 0x01);
+    EXPECT_EQ(frame[12], 0x81);
+    EXPECT_EQ((frame[14] << 8 | frame[15]), 0xA007);
+    EXPECT_EQ(frame[16], 0x88);
+    EXPECT_EQ(frame[17], 0xBA);
+    EXPECT_EQ((frame[18] << 8 | frame[19]), 0x4012);
+    EXPECT_NE(find(frame, length, {'L', 'o', 'a', 'd', 'S', 'V', '2'}), length);
+
+    // Templates are cache-line aligned and do not overlap
+    size_t l0 = 0, l1 = 0;
+    const uint8_t* f0 = generator.renderFrame(0, 0, l0);
+    const uint8_t* f1 = generator.renderFrame(1, 0, l1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(f0) % 64, 0u);
+    EXPECT_GE(static_cast<size_t>(f1 - f0), l0);
+}
+
+TEST_F(LoadGeneratorTest, PatchesSmpCntAndSamples) {
+    LoadGenConfig config;
+    LoadGenSvGroup group;
+    group.sampleRate = 4800;
+    group.nominalFreq = 60.0;
+    group.voltageV = 100.0;
+    config.sv.push_back(group);
+    ASSERT_TRUE(generator.prepare(config, error)) << error;
+
+    // Frame 20 is a quarter cycle in (80 samples per cycle): Va at its peak
+    size_t length = 0;
+    const uint8_t* frame = generator.renderFrame(0, 20, length);
+    const size_t smpCnt = find(frame, length, {'S', 'V', '0', 0x82, 0x02}, 20) + 5;
+    ASSERT_LT(smpCnt, length);
+    EXPECT_EQ((frame[smpCnt] << 8 | frame[smpCnt + 1]), 20);
+
+    const size_t seqData = find(frame, length, {0x87, 0x40}, smpCnt) + 2;
+    ASSERT_LT(seqData + 64, length + 1);
+    const int32_t va = static_cast<int32_t>(be32(frame + seqData + 4 * 8));
+    EXPECT_NEAR(va, 100.0 * std::sqrt(2.0) * 100.0, 1.0);
+    EXPECT_EQ(be32(frame + seqData + 4 * 8 + 4), 0u);   // Quality good
+
+    // smpCnt wraps at the sample rate
+    frame = generator.renderFrame(0, 4800 + 3, length);
+    EXPECT_EQ((frame[smpCnt] << 8 | frame[smpCnt + 1]), 3);
+}
+
+TEST_F(LoadGeneratorTest, EightAsduFramesCarryConsecutiveSamples) {
+    LoadGenConfig config;
+    LoadGenSvGroup group;
+    group.sampleRate = 15360;
+    group.noAsdu = 8;
+    group.nominalFreq = 60.0;
+    config.sv.push_back(group);
+    ASSERT_TRUE(generator.prepare(config, error)) << error;
+
+    size_t length = 0;
+    const uint8_t* frame = generator.renderFrame(0, 2, length);
+    size_t pos = 20;
+    for (int a = 0; a < 8; ++a) {
+        // svID "LoadSV0" is followed by smpCnt in every ASDU
+        pos = find(frame, length, {'S', 'V', '0', 0x82, 0x02}, pos) + 5;
+        ASSERT_LT(pos, length);
+        EXPECT_EQ((frame[pos] << 8 | frame[pos + 1]), 16 + a);
+    }
+}
+
+TEST_F(LoadGeneratorTest, GooseRetransmissionAndStateChange) {
+    LoadGenConfig config;
+    LoadGenGooseGroup repeat;
+    repeat.baseAppId = 0x0100;
+    LoadGenGooseGroup storm;
+    storm.stateChange = true;
+    storm.baseAppId = 0x0200;
+    config.goose = {repeat, storm};
+    ASSERT_TRUE(generator.prepare(config, error)) << error;
+    ASSERT_EQ(generator.streamCount(), 2u);
+
+    size_t length = 0;
+    const uint8_t* frame = generator.renderFrame(0, 5, length);
+    EXPECT_EQ(frame[17], 0xB8);
+    EXPECT_EQ((frame[18] << 8 | frame[19]), 0x0100);
+    size_t t = find(frame, length, {0x84, 0x08}, 20);
+    size_t st = find(frame, length, {0x85, 0x04}, t + 10) + 2;
+    size_t sq = find(frame, length, {0x86, 0x04}, st) + 2;
+    ASSERT_LT(sq, length);
+    EXPECT_EQ(be32(frame + st), 1u);
+    EXPECT_EQ(be32(frame + sq), 5u);
+
+    frame = generator.renderFrame(1, 5, length);
+    t = find(frame, length, {0x84, 0x08}, 20);
+    EXPECT_NE(be32(frame + t + 2), 0u);             // Timestamped at the state change
+    st = find(frame, length, {0x85, 0x04}, t + 10) + 2;
+    sq = find(frame, length, {0x86, 0x04}, st) + 2;
+    EXPECT_EQ(be32(frame + st), 6u);
+    EXPECT_EQ(be32(frame + sq), 0u);
+    const size_t data = find(frame, length, {0xAB}, sq);
+    ASSERT_LT(data + 4, length);
+    EXPECT_EQ(frame[data + 4], 0xFF);               // ab LL 83 01 <first boolean>
+}
+
+TEST_F(LoadGeneratorTest, FrameOffsetsDoNotDrift) {
+    // 14400 frames/s: period 69444.4 ns, exact after any number of frames
+    EXPECT_EQ(LoadGenerator::frameOffsetNs(1, 1, 14400), 69444u);
+    EXPECT_EQ(LoadGenerator::frameOffsetNs(14400, 1, 14400), 1000000000u);
+    EXPECT_EQ(LoadGenerator::frameOffsetNs(14400ull * 86400ull, 1, 14400), 86400ull * 1000000000ull);
+    // 8 ASDUs at 15360 samples/s = 1920 frames/s
+    EXPECT_EQ(LoadGenerator::frameOffsetNs(1920, 8, 15360), 1000000000u);
+    // GOOSE at 333.333 Hz in milliHertz
+    EXPECT_EQ(LoadGenerator::frameOffsetNs(333333, 1000, 333333), 1000ull * 1000000000ull);
+}
+
+TEST_F(LoadGeneratorTest, RejectsInvalidSpecs) {
+    LoadGenConfig empty;
+    EXPECT_FALSE(generator.prepare(empty, error));
+
+    LoadGenConfig tooMany;
+    LoadGenSvGroup big;
+    big.count = static_cast<uint32_t>(LoadGen_MaxStreams) + 1;
+    tooMany.sv.push_back(big);
+    EXPECT_FALSE(generator.prepare(tooMany, error));
+
+    LoadGenConfig badAsdu;
+    LoadGenSvGroup group;
+    group.noAsdu = 3;
+    group.sampleRate = 4000;
+    badAsdu.sv.push_back(group);
+    EXPECT_FALSE(generator.prepare(badAsdu, error));
+
+    LoadGenConfig badRate;
+    LoadGenGooseGroup goose;
+    goose.rateHz = 0.0;
+    badRate.goose.push_back(goose);
+    EXPECT_FALSE(generator.prepare(badRate, error));
+
+    EXPECT_FALSE(generator.getStats().running);
+}
@@ -0,0 +1,224 @@
+/**
+ * @file test_pcap_reader.cpp
+ * @brief Unit tests for the memory-mapped pcap/pcapng reader
+ *
+ * Tests cover:
+ * - Classic pcap, little/big endian, micro- and nanosecond timestamps
+ * - pcapng with if_tsresol, enhanced and simple packet blocks, skipped blocks
+ * - Rewind, truncated records, non-capture files
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "pcap_reader.hpp"
+
+using namespace vts::io;
+
+namespace {
+
+void put16(std::vector<uint8_t>& out, uint16_t v, bool be) {
+    if (be) { out.push_back(static_cast<uint8_t>(v >> 8)); out.push_back(static_cast<uint8_t>(v)); }
+    else    { out.push_back(static_cast<uint8_t>(v)); out.push_back(static_cast<uint8_t>(v >> 8)); }
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t v, bool be) {
+    for (int i = 0; i < 4; ++i) {
+        int shift = be ? (3 - i) * 8 : i * 8;
+        out.push_back(static_cast<uint8_t>(v >> shift));
+    }
+}
+
+std::vector<uint8_t> frame(uint8_t tag, size_t length) {
+    std::vector<uint8_t> f(length, tag);
+    f[12] = 0x88;
+    f[13] = 0xBA;
+    return f;
+}
+
+std::vector<uint8_t> classicPcap(bool be, bool nano, const std::vector<std::pair<uint64_t, std::vector<uint8_t>>>& pkts) {
+    std::vector<uint8_t> out;
+    put32(out, nano ? 0xA1B23C4D : 0xA1B2C3D4, be);
+    put16(out, 2, be);
+    put16(out, 4, be);
+    put32(out, 0, be);
+    put32(out, 0, be);
+    put32(out, 65535, be);
+    put32(out, 1, be);
+    for (const auto& p : pkts) {
+        put32(out, static_cast<uint32_t>(p.first / 1000000000ull), be);
+        const uint64_t frac = p.first % 1000000000ull;
+        put32(out, static_cast<uint32_t>(nano ? frac : frac / 1000), be);
+        put32(out, static_cast<uint32_t>(p.second.size()), be);
+        put32(out, static_cast<uint32_t>(p.second.size()), be);
+        out.insert(out.end(), p.second.begin(), p.second.end());
+    }
+    return out;
+}
+
+void pcapngBlock(std::vector<uint8_t>& out, uint32_t type, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> padded = body;
+    while (padded.size() % 4) padded.push_back(0);
+    const uint32_t length = static_cast<uint32_t>(padded.size() + 12);
+    put32(out, type, false);
+    put32(out, length, false);
+    out.insert(out.end(), padded.begin(), padded.end());
+    put32(out, length, false);
+}
+
+} // namespace
+
+class PcapReaderTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        path = ::testing::TempDir() + "pcap_reader_test_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".pcap";
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    void write(const std::vector<uint8_t>& bytes) {
+        std::ofstream f(path, std::ios::binary);
+        f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    PcapReader reader;
+};
+
+TEST_F(PcapReaderTest, ClassicLittleEndianMicroseconds) {
+    write(classicPcap(false, false, {{1000000001000ull, frame(1, 60)}, {1000000251000ull, frame(2, 90)}}));
+    ASSERT_TRUE(reader.open(path)) << reader.getLastError();
+    EXPECT_EQ(reader.format(), PcapReader::Format::PCAP);
+
+    PcapPacket pkt;
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_EQ(pkt.timestampNs, 1000000001000ull);
+    EXPECT_EQ(pkt.capturedLength, 60u);
+    EXPECT_EQ(pkt.linkType, PcapReader::LinkTypeEthernet);
+    EXPECT_EQ(pkt.data[0], 1);
+
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_EQ(pkt.timestampNs, 1000000251000ull);
+    EXPECT_EQ(pkt.capturedLength, 90u);
+
+    EXPECT_FALSE(reader.next(pkt));
+    EXPECT_TRUE(reader.getLastError().empty());
+}
+
+TEST_F(PcapReaderTest, ClassicBigEndianNanoseconds) {
+    write(classicPcap(true, true, {{5000000123ull, frame(7, 64)}}));
+    ASSERT_TRUE(reader.open(path)) << reader.getLastError();
+
+    PcapPacket pkt;
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_EQ(pkt.timestampNs, 5000000123ull);
+    EXPECT_EQ(pkt.capturedLength, 64u);
+    EXPECT_EQ(pkt.data[0], 7);
+}
+
+TEST_F(PcapReaderTest, RewindRestartsAtFirstPacket) {
+    write(classicPcap(false, false, {{1000, frame(1, 60)}, {2000, frame(2, 60)}}));
+    ASSERT_TRUE(reader.open(path));
+    PcapPacket pkt;
+    ASSERT_TRUE(reader.next(pkt));
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_FALSE(reader.next(pkt));
+
+    reader.rewind();
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_EQ(pkt.data[0], 1);
+}
+
+TEST_F(PcapReaderTest, TruncatedRecordReportsError) {
+    auto bytes = classicPcap(false, false, {{1000, frame(1, 60)}, {2000, frame(2, 60)}});
+    bytes.resize(bytes.size() - 10);
+    write(bytes);
+    ASSERT_TRUE(reader.open(path));
+    PcapPacket pkt;
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_FALSE(reader.next(pkt));
+    EXPECT_FALSE(reader.getLastError().empty());
+}
+
+TEST_F(PcapReaderTest, RejectsNonCaptureFile) {
+    write({'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd', '!'});
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.isOpen());
+    EXPECT_FALSE(reader.open(path + ".missing"));
+}
+
+TEST_F(PcapReaderTest, PcapNgEnhancedAndSimpleBlocks) {
+    std::vector<uint8_t> out;
+
+    // Section header: magic, version 1.0, section length -1
+    std::vector<uint8_t> shb;
+    put32(shb, 0x1A2B3C4D, false);
+    put16(shb, 1, false);
+    put16(shb, 0, false);
+    put32(shb, 0xFFFFFFFF, false);
+    put32(shb, 0xFFFFFFFF, false);
+    pcapngBlock(out, 0x0A0D0D0A, shb);
+
+    // Interface: Ethernet, if_tsresol = 9 (nanoseconds)
+    std::vector<uint8_t> idb;
+    put16(idb, 1, false);
+    put16(idb, 0, false);
+    put32(idb, 65535, false);
+    put16(idb, 9, false);
+    put16(idb, 1, false);
+    idb.insert(idb.end(), {9, 0, 0, 0});
+    put16(idb, 0, false);
+    put16(idb, 0, false);
+    pcapngBlock(out, 1, idb);
+
+    // Name resolution block, skipped
+    pcapngBlock(out, 4, {0, 0, 0, 0});
+
+    // Enhanced packet at 7.000000042 s
+    const auto f1 = frame(3, 62);
+    const uint64_t ts = 7000000042ull;
+    std::vector<uint8_t> epb;
+    put32(epb, 0, false);
+    put32(epb, static_cast<uint32_t>(ts >> 32), false);
+    put32(epb, static_cast<uint32_t>(ts & 0xFFFFFFFF), false);
+    put32(epb, static_cast<uint32_t>(f1.size()), false);
+    put32(epb, static_cast<uint32_t>(f1.size()), false);
+    epb.insert(epb.end(), f1.begin(), f1.end());
+    pcapngBlock(out, 6, epb);
+
+    // Simple packet, inherits the previous timestamp
+    const auto f2 = frame(4, 61);
+    std::vector<uint8_t> spb;
+    put32(spb, static_cast<uint32_t>(f2.size()), false);
+    spb.insert(spb.end(), f2.begin(), f2.end());
+    pcapngBlock(out, 3, spb);
+
+    write(out);
+    ASSERT_TRUE(reader.open(path)) << reader.getLastError();
+    EXPECT_EQ(reader.format(), PcapReader::Format::PCAPNG);
+
+    PcapPacket pkt;
+    ASSERT_TRUE(reader.next(pkt)) << reader.getLastError();
+    EXPECT_EQ(pkt.timestampNs, ts);
+    EXPECT_EQ(pkt.capturedLength, 62u);
+    EXPECT_EQ(pkt.data[0], 3);
+    EXPECT_EQ(pkt.linkType, PcapReader::LinkTypeEthernet);
+
+    ASSERT_TRUE(reader.next(pkt)) << reader.getLastError();
+    EXPECT_EQ(pkt.capturedLength, 61u);
+    EXPECT_EQ(pkt.timestampNs, ts);
+    EXPECT_EQ(pkt.data[0], 4);
+
+    EXPECT_FALSE(reader.next(pkt));
+    EXPECT_TRUE(reader.getLastError().empty());
+
+    reader.rewind();
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_EQ(pkt.data[0], 3);
+}
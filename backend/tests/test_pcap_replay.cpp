@@ -0,0 +1,143 @@
+/**
+ * @file test_pcap_replay.cpp
+ * @brief Unit tests for pcap replay frame rewriting, scheduling and timing stats
+ *
+ * Tests cover:
+ * - MAC, APPID and VLAN rewrites (set, insert, strip, priority)
+ * - Deadline offsets under speed multipliers
+ * - LatencyHistogram percentiles, clamping and exact extremes
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "pcap_replay.hpp"
+#include "latency_histogram.hpp"
+
+namespace {
+
+// dst 01:0C:CD:04:00:01, src 00:11:22:33:44:55, optional VLAN, SV APPID 0x4000
+std::vector<uint8_t> svFrame(bool tagged, uint16_t tci = 0xA005) {
+    std::vector<uint8_t> f = {0x01, 0x0C, 0xCD, 0x04, 0x00, 0x01, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55};
+    if (tagged) {
+        f.insert(f.end(), {0x81, 0x00, static_cast<uint8_t>(tci >> 8), static_cast<uint8_t>(tci & 0xFF)});
+    }
+    f.insert(f.end(), {0x88, 0xBA, 0x40, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00});
+    f.resize(f.size() + 40, 0xEE);
+    return f;
+}
+
+} // namespace
+
+class PcapReplayTest : public ::testing::Test {
+protected:
+    PcapReplayConfig config;
+    std::vector<uint8_t> out = std::vector<uint8_t>(PcapReplay_MaxFrameSize);
+
+    std::vector<uint8_t> rewrite(const std::vector<uint8_t>& in) {
+        size_t n = PcapReplay::rewriteFrame(config, in.data(), in.size(), out.data());
+        return std::vector<uint8_t>(out.begin(), out.begin() + static_cast<long>(n));
+    }
+};
+
+TEST_F(PcapReplayTest, NoRewriteCopiesFrame) {
+    auto in = svFrame(true);
+    EXPECT_FALSE(config.rewrites());
+    EXPECT_EQ(rewrite(in), in);
+}
+
+TEST_F(PcapReplayTest, RewritesMacsAndAppId) {
+    config.rewriteDstMac = true;
+    config.dstMac = {0x01, 0x0C, 0xCD, 0x04, 0x00, 0x09};
+    config.rewriteSrcMac = true;
+    config.srcMac = {0x02, 0, 0, 0, 0, 0x01};
+    config.appId = 0x4123;
+    ASSERT_TRUE(config.rewrites());
+
+    auto result = rewrite(svFrame(true));
+    EXPECT_EQ(result[5], 0x09);
+    EXPECT_EQ(result[6], 0x02);
+    EXPECT_EQ(result[11], 0x01);
+    // Tagged: APPID follows the EtherType at 16
+    EXPECT_EQ(result[18], 0x41);
+    EXPECT_EQ(result[19], 0x23);
+    EXPECT_EQ(result[20], 0x00);  // Length untouched
+}
+
+TEST_F(PcapReplayTest, AppIdOnlyForIec61850EtherTypes) {
+    config.appId = 0x1234;
+    auto in = svFrame(false);
+    in[12] = 0x08;
+    in[13] = 0x00;  // IPv4
+    EXPECT_EQ(rewrite(in), in);
+}
+
+TEST_F(PcapReplayTest, SetsVlanOnTaggedFrame) {
+    config.vlanId = 100;
+    auto result = rewrite(svFrame(true, 0xA005));  // Priority 5, VID 5
+    ASSERT_EQ(result.size(), svFrame(true).size());
+    EXPECT_EQ((result[14] << 8 | result[15]), 0xA064);  // Priority kept, VID 100
+
+    config.vlanPriority = 4;
+    result = rewrite(svFrame(true, 0xA005));
+    EXPECT_EQ((result[14] << 8 | result[15]), 0x8064);
+}
+
+TEST_F(PcapReplayTest, InsertsVlanTag) {
+    config.vlanId = 10;
+    config.vlanPriority = 6;
+    config.appId = 0x4001;
+    auto in = svFrame(false);
+    auto result = rewrite(in);
+    ASSERT_EQ(result.size(), in.size() + 4);
+    EXPECT_EQ(result[12], 0x81);
+    EXPECT_EQ(result[13], 0x00);
+    EXPECT_EQ((result[14] << 8 | result[15]), 0xC00A);
+    EXPECT_EQ(result[16], 0x88);
+    EXPECT_EQ(result[17], 0xBA);
+    EXPECT_EQ(result[19], 0x01);
+}
+
+TEST_F(PcapReplayTest, StripsVlanTag) {
+    config.stripVlan = true;
+    auto result = rewrite(svFrame(true));
+    EXPECT_EQ(result, svFrame(false));
+}
+
+TEST_F(PcapReplayTest, RejectsRuntFrame) {
+    std::vector<uint8_t> runt(10, 0);
+    EXPECT_EQ(PcapReplay::rewriteFrame(config, runt.data(), runt.size(), out.data()), 0u);
+}
+
+TEST_F(PcapReplayTest, ScheduleOffsetScalesWithSpeed) {
+    EXPECT_EQ(PcapReplay::scheduleOffset(250000, 1.0), 250000u);
+    EXPECT_EQ(PcapReplay::scheduleOffset(250000, 2.0), 125000u);
+    EXPECT_EQ(PcapReplay::scheduleOffset(250000, 0.5), 500000u);
+}
+
+TEST_F(PcapReplayTest, HistogramPercentiles) {
+    LatencyHistogram h(-10000, 100000, 1000);
+    for (int i = 1; i <= 100; ++i) {
+        h.record(i * 1000);  // 1..100 us
+    }
+    EXPECT_EQ(h.count(), 100u);
+    EXPECT_EQ(h.min(), 1000);
+    EXPECT_EQ(h.max(), 100000);
+    EXPECT_NEAR(static_cast<double>(h.percentile(0.5)), 51000.0, 1000.0);
+    EXPECT_NEAR(static_cast<double>(h.percentile(0.99)), 100000.0, 1000.0);
+    EXPECT_NEAR(h.mean(), 50500.0, 1e-9);
+}
+
+TEST_F(PcapReplayTest, HistogramClampsButKeepsExtremes) {
+    LatencyHistogram h(-1000, 10000, 1000);
+    h.record(-50000);
+    h.record(500);
+    h.record(2000000);
+    EXPECT_EQ(h.min(), -50000);
+    EXPECT_EQ(h.max(), 2000000);
+    EXPECT_EQ(h.percentile(1.0), 2000000);
+    EXPECT_EQ(h.percentile(0.0), 0);  // Upper edge of the first bucket
+
+    h.reset();
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.percentile(0.5), 0);
+}
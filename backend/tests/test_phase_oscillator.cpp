@@ -0,0 +1,106 @@
+/**
+ * @file test_phase_oscillator.cpp
+ * @brief Unit tests for the phase-continuous sample oscillator
+ *
+ * Tests cover:
+ * - Agreement with sin() at constant frequency
+ * - Exact fixed-point phase over long runs
+ * - Phase continuity across frequency steps, ROCOF ramps and phase shifts
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "phase_oscillator.hpp"
+
+namespace {
+
+constexpr double TwoPi = 2.0 * M_PI;
+
+// Wrapped difference of two angles, (-pi, pi]
+double angleDiff(double a, double b) {
+    double d = std::fmod(a - b, TwoPi);
+    if (d > M_PI) d -= TwoPi;
+    if (d <= -M_PI) d += TwoPi;
+    return d;
+}
+
+} // namespace
+
+class PhaseOscillatorTest : public ::testing::Test {};
+
+TEST_F(PhaseOscillatorTest, MatchesSineAtConstantFrequency) {
+    PhaseOscillator osc(4800.0, 60.0, 0.5);
+    double worst = 0.0;
+    for (int n = 0; n < 48000; ++n) {
+        const double expected = std::sin(TwoPi * 60.0 * n / 4800.0 + 0.5);
+        worst = std::max(worst, std::fabs(osc.sine() - expected));
+        osc.advance();
+    }
+    EXPECT_LT(worst, 1e-11);                      // Mostly the reference's own rounding
+    EXPECT_DOUBLE_EQ(osc.frequency(), 60.0);
+}
+
+TEST_F(PhaseOscillatorTest, FixedPhaseIsExactOverLongRuns) {
+    // 50 Hz at 4000 Hz: 1/80 turn per sample, so every 80 samples the phase
+    // is back at zero; a t-based sin() would have lost ~1e-7 rad by now
+    PhaseOscillator osc(4000.0, 50.0, 0.0);
+    for (int n = 0; n < 80 * 100000; ++n) {
+        osc.advance();
+    }
+    EXPECT_LT(std::fabs(angleDiff(osc.phase(), 0.0)), 1e-9);
+    EXPECT_NEAR(osc.sine(), 0.0, 1e-9);
+    EXPECT_NEAR(osc.cosine(), 1.0, 1e-9);
+    // Rotor stays on the unit circle
+    EXPECT_NEAR(osc.sine() * osc.sine() + osc.cosine() * osc.cosine(), 1.0, 1e-12);
+}
+
+TEST_F(PhaseOscillatorTest, FrequencyStepIsPhaseContinuous) {
+    PhaseOscillator osc(4800.0, 50.0, 0.0);
+    for (int n = 0; n < 1000; ++n) osc.advance();
+    const double before = osc.phase();
+
+    osc.setFrequency(51.0);
+    EXPECT_DOUBLE_EQ(osc.phase(), before);
+    osc.advance();
+    EXPECT_NEAR(angleDiff(osc.phase(), before), TwoPi * 51.0 / 4800.0, 1e-12);
+    EXPECT_NEAR(osc.sine(), std::sin(osc.phase()), 1e-12);
+}
+
+TEST_F(PhaseOscillatorTest, RocofRampIntegratesFrequency) {
+    const double fs = 4800.0;
+    PhaseOscillator osc(fs, 50.0, 0.0);
+    osc.rampTo(49.0, 2.0);                        // 0.5 s to reach 49 Hz
+    EXPECT_TRUE(osc.ramping());
+
+    // Reference: phase is the running sum of the per-sample frequency
+    long double phase = 0.0L;
+    long double f = 50.0L;
+    double worst = 0.0;
+    for (int n = 0; n < 4800; ++n) {
+        worst = std::max(worst, std::fabs(osc.sine() - std::sin(static_cast<double>(phase))));
+        osc.advance();
+        phase += 2.0L * static_cast<long double>(M_PI) * f / fs;
+        f = std::max(49.0L, f - 2.0L / fs);
+    }
+    EXPECT_LT(worst, 1e-9);
+    EXPECT_FALSE(osc.ramping());
+    EXPECT_DOUBLE_EQ(osc.frequency(), 49.0);
+}
+
+TEST_F(PhaseOscillatorTest, ShiftAndResetPhase) {
+    PhaseOscillator osc(4800.0, 60.0, 0.0);
+    for (int n = 0; n < 37; ++n) osc.advance();
+    const double before = osc.phase();
+    osc.shiftPhase(-M_PI / 2);
+    EXPECT_NEAR(angleDiff(osc.phase(), before), -M_PI / 2, 1e-12);
+    EXPECT_NEAR(osc.cosine(), std::cos(before - M_PI / 2), 1e-12);
+
+    osc.setPhase(1.0);
+    EXPECT_NEAR(osc.phase(), 1.0, 1e-12);
+    EXPECT_DOUBLE_EQ(osc.frequency(), 60.0);
+
+    // A new sample rate keeps frequency and phase
+    osc.setSampleRate(14400.0);
+    EXPECT_NEAR(osc.frequency(), 60.0, 1e-12);
+    EXPECT_NEAR(osc.phase(), 1.0, 1e-12);
+}
@@ -0,0 +1,175 @@
+/**
+ * @file test_phasor_control.cpp
+ * @brief Unit tests for the WebSocket control channel message codec
+ *
+ * Tests cover:
+ * - Binary encode/decode round trip for several streams per message
+ * - JSON messages with channel indices and 9-2LE names
+ * - Rejection of truncated, out-of-range and non-finite input, batch reuse
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include "phasor_control.hpp"
+#include "general_definition.hpp"
+
+namespace {
+
+StreamControlUpdate makeUpdate(const std::string& id, size_t deltas, bool frequency) {
+    StreamControlUpdate update;
+    update.streamId = id;
+    for (size_t i = 0; i < deltas; ++i) {
+        PhasorDelta delta;
+        delta.channel = static_cast<uint16_t>(i);
+        delta.fields = PhasorDelta::Magnitude | PhasorDelta::Angle;
+        delta.magnitude = 100.0 + static_cast<double>(i);
+        delta.angle = -120.0 * static_cast<double>(i);
+        update.deltas.push_back(delta);
+    }
+    update.hasFrequency = frequency;
+    update.frequency = 59.95;
+    update.rocof = 0.5;
+    return update;
+}
+
+} // namespace
+
+class PhasorControlTest : public ::testing::Test {
+protected:
+    ControlBatch batch;
+    std::string error;
+};
+
+TEST_F(PhasorControlTest, BinaryRoundTrip) {
+    const StreamControlUpdate updates[] = {
+        makeUpdate("a1b2c3d4-0000-4000-8000-000000000001", 8, true),
+        makeUpdate("sv2", 1, false),
+        makeUpdate("sv3", 0, true)};
+    const std::vector<uint8_t> wire = encodeControlBinary(updates, 3, true);
+    // Header 6, per stream 1 + id + 3, frequency 16, 10 per delta
+    EXPECT_EQ(wire.size(), 6u + (4 + 36 + 16 + 80) + (4 + 3 + 10) + (4 + 3 + 16));
+
+    ASSERT_TRUE(decodeControlBinary(wire.data(), wire.size(), batch, error)) << error;
+    EXPECT_TRUE(batch.ack);
+    ASSERT_EQ(batch.count, 3u);
+    for (size_t s = 0; s < 3; ++s) {
+        const StreamControlUpdate& got = batch.updates[s];
+        EXPECT_EQ(got.streamId, updates[s].streamId);
+        EXPECT_EQ(got.hasFrequency, updates[s].hasFrequency);
+        if (got.hasFrequency) {
+            EXPECT_DOUBLE_EQ(got.frequency, 59.95);         // f64 on the wire
+            EXPECT_DOUBLE_EQ(got.rocof, 0.5);
+        }
+        ASSERT_EQ(got.deltas.size(), updates[s].deltas.size());
+        for (size_t d = 0; d < got.deltas.size(); ++d) {
+            EXPECT_EQ(got.deltas[d].channel, updates[s].deltas[d].channel);
+            EXPECT_EQ(got.deltas[d].fields, updates[s].deltas[d].fields);
+            EXPECT_FLOAT_EQ(static_cast<float>(got.deltas[d].magnitude),
+                            static_cast<float>(updates[s].deltas[d].magnitude));
+            EXPECT_FLOAT_EQ(static_cast<float>(got.deltas[d].angle),
+                            static_cast<float>(updates[s].deltas[d].angle));
+        }
+    }
+}
+
+TEST_F(PhasorControlTest, DecodesJson) {
+    const nlohmann::json message = nlohmann::json::parse(R"({
+        "type": "control",
+        "streams": [
+            {"id": "sv1", "freq": 50.5, "rocof": 2.0,
+             "phasors": [{"ch": 0, "mag": 10.5}, {"name": "V-B", "angle": -120}]},
+            {"id": "sv2", "phasors": [{"ch": 3, "mag": 1, "angle": 45}]}
+        ]})");
+    ASSERT_TRUE(decodeControlJson(message, batch, error)) << error;
+    EXPECT_FALSE(batch.ack);
+    ASSERT_EQ(batch.count, 2u);
+
+    const StreamControlUpdate& first = batch.updates[0];
+    EXPECT_EQ(first.streamId, "sv1");
+    EXPECT_TRUE(first.hasFrequency);
+    EXPECT_DOUBLE_EQ(first.frequency, 50.5);
+    EXPECT_DOUBLE_EQ(first.rocof, 2.0);
+    ASSERT_EQ(first.deltas.size(), 2u);
+    EXPECT_EQ(first.deltas[0].channel, 0);
+    EXPECT_EQ(first.deltas[0].fields, PhasorDelta::Magnitude);
+    EXPECT_DOUBLE_EQ(first.deltas[0].magnitude, 10.5);
+    EXPECT_EQ(first.deltas[1].channel, 5);                  // V-B
+    EXPECT_EQ(first.deltas[1].fields, PhasorDelta::Angle);
+
+    const StreamControlUpdate& second = batch.updates[1];
+    EXPECT_FALSE(second.hasFrequency);
+    ASSERT_EQ(second.deltas.size(), 1u);
+    EXPECT_EQ(second.deltas[0].fields, PhasorDelta::Magnitude | PhasorDelta::Angle);
+
+    EXPECT_EQ(channelIndexByName("I-A"), 0);
+    EXPECT_EQ(channelIndexByName("V-N"), 7);
+    EXPECT_EQ(channelIndexByName("X"), -1);
+}
+
+TEST_F(PhasorControlTest, RejectsMalformedBinary) {
+    const StreamControlUpdate update = makeUpdate("sv1", 4, true);
+    const std::vector<uint8_t> wire = encodeControlBinary(&update, 1);
+
+    // Every truncation fails, as does a trailing byte
+    for (size_t n = 0; n < wire.size(); ++n) {
+        EXPECT_FALSE(decodeControlBinary(wire.data(), n, batch, error)) << "length " << n;
+    }
+    std::vector<uint8_t> longer = wire;
+    longer.push_back(0);
+    EXPECT_FALSE(decodeControlBinary(longer.data(), longer.size(), batch, error));
+
+    std::vector<uint8_t> bad = wire;
+    bad[0] = 'X';
+    EXPECT_FALSE(decodeControlBinary(bad.data(), bad.size(), batch, error));
+    bad = wire;
+    bad[2] = 2;                                             // Version
+    EXPECT_FALSE(decodeControlBinary(bad.data(), bad.size(), batch, error));
+
+    // Channel beyond the limit
+    StreamControlUpdate wide = makeUpdate("sv1", 1, false);
+    wide.deltas[0].channel = static_cast<uint16_t>(Control_MaxChannels);
+    const std::vector<uint8_t> wideWire = encodeControlBinary(&wide, 1);
+    EXPECT_FALSE(decodeControlBinary(wideWire.data(), wideWire.size(), batch, error));
+    EXPECT_NE(error.find("out of range"), std::string::npos);
+
+    // NaN angle
+    StreamControlUpdate nan = makeUpdate("sv1", 1, false);
+    nan.deltas[0].angle = std::numeric_limits<double>::quiet_NaN();
+    const std::vector<uint8_t> nanWire = encodeControlBinary(&nan, 1);
+    EXPECT_FALSE(decodeControlBinary(nanWire.data(), nanWire.size(), batch, error));
+
+    EXPECT_TRUE(decodeControlBinary(wire.data(), wire.size(), batch, error)) << error;
+}
+
+TEST_F(PhasorControlTest, RejectsMalformedJson) {
+    EXPECT_FALSE(decodeControlJson(nlohmann::json::parse(R"({"type": "control"})"), batch, error));
+    EXPECT_FALSE(decodeControlJson(nlohmann::json::parse(
+        R"({"streams": [{"phasors": [{"ch": 0, "mag": 1}]}]})"), batch, error));
+    EXPECT_FALSE(decodeControlJson(nlohmann::json::parse(
+        R"({"streams": [{"id": "a", "phasors": [{"ch": 999, "mag": 1}]}]})"), batch, error));
+    EXPECT_FALSE(decodeControlJson(nlohmann::json::parse(
+        R"({"streams": [{"id": "a", "phasors": [{"name": "Q-Z", "mag": 1}]}]})"), batch, error));
+    EXPECT_FALSE(decodeControlJson(nlohmann::json::parse(
+        R"({"streams": [{"id": "a", "phasors": [{"ch": 1}]}]})"), batch, error));
+    EXPECT_FALSE(decodeControlJson(nlohmann::json::parse(
+        R"({"streams": [{"id": "a", "freq": -5}]})"), batch, error));
+}
+
+TEST_F(PhasorControlTest, BatchIsReusedAcrossMessages) {
+    const StreamControlUpdate big = makeUpdate("sv1", 8, true);
+    const std::vector<uint8_t> first = encodeControlBinary(&big, 1, true);
+    ASSERT_TRUE(decodeControlBinary(first.data(), first.size(), batch, error));
+    const PhasorDelta* storage = batch.updates[0].deltas.data();
+
+    // A smaller message reuses the slot and its delta storage, stale fields cleared
+    const StreamControlUpdate small = makeUpdate("sv2", 2, false);
+    const std::vector<uint8_t> second = encodeControlBinary(&small, 1);
+    ASSERT_TRUE(decodeControlBinary(second.data(), second.size(), batch, error));
+    EXPECT_FALSE(batch.ack);
+    ASSERT_EQ(batch.count, 1u);
+    EXPECT_EQ(batch.updates[0].streamId, "sv2");
+    EXPECT_FALSE(batch.updates[0].hasFrequency);
+    EXPECT_EQ(batch.updates[0].deltas.size(), 2u);
+    EXPECT_EQ(batch.updates[0].deltas.data(), storage);
+}
@@ -0,0 +1,166 @@
+/**
+ * @file test_power_quality.cpp
+ * @brief Unit tests for IEC 61000-4-30 style power-quality aggregation
+ *
+ * Tests cover:
+ * - Harmonic/interharmonic subgroups to the 50th order off nominal frequency
+ * - 150/180-cycle blocks and their resynchronisation at the 10 min tick
+ * - Dip and swell detection on Urms(1/2), flagging of aggregates
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include "power_quality.hpp"
+
+using vts::analyzer::FrequencyTracker;
+using vts::analyzer::FrequencyTrackerConfig;
+using vts::analyzer::PowerQualityChannel;
+using vts::analyzer::PowerQualityConfig;
+using vts::analyzer::PqEvent;
+using vts::analyzer::PqInterval;
+using vts::analyzer::PqRecord;
+
+namespace {
+
+constexpr double Pi = 3.14159265358979323846;
+
+struct Rig {
+    double sampleRate;
+    FrequencyTracker tracker;
+    PowerQualityChannel pq;
+    std::vector<PqRecord> records;
+    std::vector<PqEvent> events;
+    double phase = 0.0;
+    double time = 0.0;
+
+    static FrequencyTrackerConfig trackerConfig(double sampleRate, double nominal, int points) {
+        FrequencyTrackerConfig config;
+        config.sampleRate = sampleRate;
+        config.nominalFrequency = nominal;
+        config.pointsPerCycle = points;
+        config.interpolatorTaps = 32;
+        return config;
+    }
+
+    Rig(double rate, const PowerQualityConfig& config, int points = 128)
+        : sampleRate(rate),
+          tracker(trackerConfig(rate, config.nominalFrequency, points)),
+          pq("V-A", config, rate, points) {}
+
+    // Run `seconds` of signal(phase, time)
+    void run(double seconds, double frequency, const std::function<double(double, double)>& signal) {
+        const int n = static_cast<int>(seconds * sampleRate);
+        for (int i = 0; i < n; ++i) {
+            if (tracker.push(signal(phase, time))) {
+                pq.onCycle(tracker, records, events);
+            }
+            phase += 2.0 * Pi * frequency / sampleRate;
+            time += 1.0 / sampleRate;
+        }
+    }
+
+    std::vector<PqRecord> of(PqInterval interval) const {
+        std::vector<PqRecord> out;
+        for (const auto& r : records) {
+            if (r.interval == interval) {
+                out.push_back(r);
+            }
+        }
+        return out;
+    }
+};
+
+} // namespace
+
+class PowerQualityTest : public ::testing::Test {};
+
+TEST_F(PowerQualityTest, SubgroupsToTheFiftiethOrder) {
+    PowerQualityConfig config;
+    config.nominalFrequency = 50.0;
+    config.emitWindows = true;
+    Rig rig(12800.0, config, 256);
+    ASSERT_EQ(rig.pq.maxOrder(), 50);
+    ASSERT_EQ(rig.pq.windowCycles(), 10);
+
+    rig.run(2.0, 49.8, [](double p, double) {
+        return 100.0 * std::cos(p) + 3.0 * std::cos(7.0 * p + 1.0) +
+               0.5 * std::cos(47.0 * p) + 1.0 * std::cos(3.5 * p);
+    });
+    const std::vector<PqRecord> windows = rig.of(PqInterval::Window);
+    ASSERT_GE(windows.size(), 8u);
+    const PqRecord& w = windows.back();
+    EXPECT_NEAR(w.frequency, 49.8, 1e-3);
+    EXPECT_NEAR(w.harmonics[1], 100.0 / std::sqrt(2.0), 1e-2);
+    EXPECT_NEAR(w.harmonics[7], 3.0 / std::sqrt(2.0), 1e-3);
+    EXPECT_NEAR(w.harmonics[47], 0.5 / std::sqrt(2.0), 1e-3);
+    EXPECT_NEAR(w.interharmonics[3], 1.0 / std::sqrt(2.0), 1e-3);
+    EXPECT_NEAR(w.harmonics[5], 0.0, 1e-3);
+    EXPECT_NEAR(w.interharmonics[20], 0.0, 1e-3);
+    EXPECT_NEAR(w.thd, 100.0 * std::sqrt(9.0 + 0.25) / 100.0, 1e-2);
+    EXPECT_FALSE(w.flagged);
+}
+
+TEST_F(PowerQualityTest, LimitsOrdersToTheFlatBand) {
+    PowerQualityConfig config;
+    Rig rig(4800.0, config);
+    EXPECT_EQ(rig.pq.maxOrder(), 34);          // 0.44 * 4800 / 60 - 0.5
+    EXPECT_EQ(rig.pq.windowCycles(), 12);
+    EXPECT_THROW(PowerQualityChannel("x", config, 4800.0, 100), std::invalid_argument);
+}
+
+TEST_F(PowerQualityTest, ShortBlocksResyncAtTenMinuteTick) {
+    PowerQualityConfig config;
+    config.startTime = 596.0;                  // 10 min tick 4 s in
+    Rig rig(4800.0, config);
+    rig.run(8.0, 60.0, [](double p, double) { return 100.0 * std::cos(p); });
+
+    const std::vector<PqRecord> blocks = rig.of(PqInterval::Short);
+    const std::vector<PqRecord> tenMinute = rig.of(PqInterval::TenMinute);
+    ASSERT_EQ(tenMinute.size(), 1u);
+    EXPECT_LT(tenMinute[0].startTime, 600.0);
+    EXPECT_LE(tenMinute[0].endTime, 600.0 + 0.2);
+    EXPECT_EQ(tenMinute[0].values, 20u);       // 4 s of 200 ms windows
+    EXPECT_NEAR(tenMinute[0].rms, 100.0 / std::sqrt(2.0), 1e-2);
+
+    // One full 180-cycle block, one cut short at the tick, then a realigned one
+    ASSERT_GE(blocks.size(), 3u);
+    EXPECT_EQ(blocks[0].values, 15u);
+    EXPECT_EQ(blocks[1].values, 5u);
+    EXPECT_EQ(blocks[2].values, 15u);
+    EXPECT_GE(blocks[2].startTime, 600.0);
+    EXPECT_NEAR(blocks[2].startTime, 600.0, 0.2);
+    EXPECT_NEAR(blocks[0].endTime - blocks[0].startTime, 3.0, 0.02);
+}
+
+TEST_F(PowerQualityTest, DipsAndSwellsFlagAggregates) {
+    PowerQualityConfig config;
+    config.declaredValue = 100.0 / std::sqrt(2.0);
+    Rig rig(4800.0, config);
+    rig.run(7.0, 60.0, [](double p, double t) {
+        double amplitude = 100.0;
+        if (t >= 1.0 && t < 1.5) amplitude = 40.0;         // Dip to 40 %
+        if (t >= 4.0 && t < 4.25) amplitude = 125.0;       // Swell to 125 %
+        return amplitude * std::cos(p);
+    });
+
+    ASSERT_EQ(rig.events.size(), 2u);
+    const PqEvent& dip = rig.events[0];
+    EXPECT_EQ(dip.type, PqEvent::Type::Dip);
+    EXPECT_NEAR(dip.startTime, 1.0, 0.02);
+    EXPECT_NEAR(dip.duration, 0.5, 0.02);
+    EXPECT_NEAR(dip.extreme, 40.0 / std::sqrt(2.0), 0.1);
+
+    const PqEvent& swell = rig.events[1];
+    EXPECT_EQ(swell.type, PqEvent::Type::Swell);
+    EXPECT_NEAR(swell.startTime, 4.0, 0.02);
+    EXPECT_NEAR(swell.duration, 0.25, 0.02);
+    EXPECT_NEAR(swell.extreme, 125.0 / std::sqrt(2.0), 0.1);
+
+    // The first two 3 s blocks each contain an event
+    const std::vector<PqRecord> blocks = rig.of(PqInterval::Short);
+    ASSERT_GE(blocks.size(), 2u);
+    EXPECT_TRUE(blocks[0].flagged);
+    EXPECT_TRUE(blocks[1].flagged);
+}
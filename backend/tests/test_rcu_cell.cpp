@@ -0,0 +1,145 @@
+/**
+ * @file test_rcu_cell.cpp
+ * @brief Unit tests for RcuCell configuration snapshots
+ *
+ * Tests cover:
+ * - Publish/update versioning and copy-modify semantics
+ * - Reader caching and refresh on version change
+ * - Deferred reclamation of snapshots still held by a reader
+ * - Readers never observing a half-applied update while writers run
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rcu_cell.hpp"
+
+namespace {
+
+struct TestConfig {
+    int a = 0;
+    int b = 0;                  // Always equal to a in a published snapshot
+    std::vector<int> payload;
+};
+
+} // namespace
+
+class RcuCellTest : public ::testing::Test {
+protected:
+    RcuCell<TestConfig> cell;
+};
+
+TEST_F(RcuCellTest, InitialSnapshot) {
+    auto snapshot = cell.load();
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->a, 0);
+    EXPECT_EQ(cell.version(), 1u);
+}
+
+TEST_F(RcuCellTest, UpdateCopiesAndPublishes) {
+    auto before = cell.load();
+    EXPECT_EQ(cell.update([](TestConfig& cfg) { cfg.a = 5; }), 2u);
+    EXPECT_EQ(cell.update([](TestConfig& cfg) { cfg.b = 7; }), 3u);
+
+    auto after = cell.load();
+    EXPECT_EQ(after->a, 5);
+    EXPECT_EQ(after->b, 7);
+    // The old snapshot is immutable
+    EXPECT_EQ(before->a, 0);
+    EXPECT_EQ(before->b, 0);
+}
+
+TEST_F(RcuCellTest, PublishReplacesSnapshot) {
+    auto next = std::make_shared<TestConfig>();
+    next->a = 42;
+    EXPECT_EQ(cell.publish(next), 2u);
+    EXPECT_EQ(cell.load().get(), next.get());
+}
+
+TEST_F(RcuCellTest, ReaderRefreshesOnVersionChange) {
+    RcuCell<TestConfig>::Reader reader(cell);
+    const TestConfig* first = &reader.get();
+    EXPECT_EQ(&reader.get(), first);
+    EXPECT_EQ(reader.version(), 1u);
+
+    cell.update([](TestConfig& cfg) { cfg.a = 1; });
+    EXPECT_EQ(reader.get().a, 1);
+    EXPECT_EQ(reader.version(), 2u);
+    EXPECT_NE(&reader.get(), first);
+}
+
+TEST_F(RcuCellTest, RetiredSnapshotFreedAfterReaderMovesOn) {
+    RcuCell<TestConfig>::Reader reader(cell);
+    std::weak_ptr<const TestConfig> old = cell.load();
+    reader.get();
+
+    cell.update([](TestConfig& cfg) { cfg.a = 1; });
+    // The reader still holds version 1, so it stays alive
+    EXPECT_FALSE(old.expired());
+    EXPECT_EQ(cell.reclaim(), 1u);
+
+    reader.get();
+    EXPECT_FALSE(old.expired());  // Retired list keeps it until reclaim
+    EXPECT_EQ(cell.reclaim(), 0u);
+    EXPECT_TRUE(old.expired());
+}
+
+TEST_F(RcuCellTest, UnheldSnapshotFreedOnPublish) {
+    std::weak_ptr<const TestConfig> old = cell.load();
+    cell.update([](TestConfig& cfg) { cfg.a = 1; });
+    EXPECT_TRUE(old.expired());
+}
+
+TEST_F(RcuCellTest, ConcurrentReadersSeeWholeSnapshots) {
+    constexpr int Updates = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<long> refreshes{0};
+
+    auto readerFn = [&]() {
+        RcuCell<TestConfig>::Reader reader(cell);
+        uint64_t lastVersion = 0;
+        int lastA = -1;
+        while (!done.load(std::memory_order_acquire)) {
+            const TestConfig& cfg = reader.get();
+            if (cfg.a != cfg.b || cfg.payload.size() != static_cast<size_t>(cfg.a % 16)) {
+                torn.fetch_add(1);
+            }
+            if (cfg.a < lastA) {
+                torn.fetch_add(1);  // Versions only move forward
+            }
+            if (reader.version() != lastVersion) {
+                lastVersion = reader.version();
+                refreshes.fetch_add(1);
+            }
+            lastA = cfg.a;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back(readerFn);
+    }
+    std::thread writer([&]() {
+        for (int i = 1; i <= Updates; ++i) {
+            cell.update([i](TestConfig& cfg) {
+                cfg.a = i;
+                cfg.payload.assign(static_cast<size_t>(i % 16), i);
+                cfg.b = i;
+            });
+        }
+    });
+
+    writer.join();
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_GT(refreshes.load(), 0);
+    EXPECT_EQ(cell.load()->a, Updates);
+    EXPECT_EQ(cell.reclaim(), 0u);
+}
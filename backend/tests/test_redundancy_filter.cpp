@@ -0,0 +1,157 @@
+/**
+ * @file test_redundancy_filter.cpp
+ * @brief Unit tests for PRP/HSR tag parsing and duplicate discard
+ *
+ * Tests cover:
+ * - PRP trailer (RCT) and HSR tag detection, VLAN handling
+ * - Untagged frames ending in 0x88FB are not treated as PRP
+ * - Second copy from the other LAN is dropped, per-LAN counters
+ * - Window advance, late frames, sequence wrap and sender restart
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+#include "redundancy_filter.hpp"
+
+using namespace vts::sniffer;
+
+class RedundancyFilterTest : public ::testing::Test {
+protected:
+    const uint8_t srcA[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55};
+    const uint8_t srcB[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x66};
+
+    // Dst/src MAC, optional VLAN, SV EtherType and `payload` bytes
+    static std::vector<uint8_t> baseFrame(bool vlan, size_t payload) {
+        std::vector<uint8_t> f = {0x01, 0x0C, 0xCD, 0x04, 0x00, 0x01,
+                                  0x00, 0x11, 0x22, 0x33, 0x44, 0x55};
+        if (vlan) {
+            f.insert(f.end(), {0x81, 0x00, 0x80, 0x00});
+        }
+        f.insert(f.end(), {0x88, 0xBA});
+        f.insert(f.end(), payload, 0xAA);
+        return f;
+    }
+
+    static void appendRCT(std::vector<uint8_t>& f, uint16_t seqNr, uint8_t lanId, size_t vlanLen) {
+        size_t lsdu = f.size() + 6 - 12 - vlanLen;
+        f.insert(f.end(), {static_cast<uint8_t>(seqNr >> 8), static_cast<uint8_t>(seqNr & 0xFF),
+                           static_cast<uint8_t>((lanId << 4) | ((lsdu >> 8) & 0x0F)),
+                           static_cast<uint8_t>(lsdu & 0xFF), 0x88, 0xFB});
+    }
+};
+
+TEST_F(RedundancyFilterTest, ParsesPRPTrailer) {
+    for (bool vlan : {false, true}) {
+        auto f = baseFrame(vlan, 40);
+        appendRCT(f, 0x1234, 0xB, vlan ? 4 : 0);
+        RedundancyTag tag;
+        ASSERT_TRUE(parseRedundancyTag(f.data(), f.size(), tag));
+        EXPECT_EQ(tag.kind, RedundancyTag::Kind::PRP);
+        EXPECT_EQ(tag.seqNr, 0x1234);
+        EXPECT_EQ(tag.lan, 1);
+        EXPECT_EQ(tag.etherTypeOffset, vlan ? 16u : 12u);
+        EXPECT_EQ(tag.payloadEnd, f.size() - 6);
+    }
+}
+
+TEST_F(RedundancyFilterTest, RejectsInconsistentTrailer) {
+    auto f = baseFrame(false, 40);
+    appendRCT(f, 7, 0xA, 0);
+    f[f.size() - 3] ^= 0x01;  // LSDU size off by one
+    RedundancyTag tag;
+    ASSERT_TRUE(parseRedundancyTag(f.data(), f.size(), tag));
+    EXPECT_EQ(tag.kind, RedundancyTag::Kind::None);
+    EXPECT_EQ(tag.payloadEnd, f.size());
+}
+
+TEST_F(RedundancyFilterTest, ParsesHSRTag) {
+    std::vector<uint8_t> f = {0x01, 0x0C, 0xCD, 0x04, 0x00, 0x01,
+                              0x00, 0x11, 0x22, 0x33, 0x44, 0x55,
+                              0x89, 0x2F, 0x10, 0x30, 0x00, 0x2A, 0x88, 0xBA};
+    f.insert(f.end(), 40, 0);
+    RedundancyTag tag;
+    ASSERT_TRUE(parseRedundancyTag(f.data(), f.size(), tag));
+    EXPECT_EQ(tag.kind, RedundancyTag::Kind::HSR);
+    EXPECT_EQ(tag.seqNr, 42);
+    EXPECT_EQ(tag.lan, 1);
+    EXPECT_EQ(tag.etherTypeOffset, 18u);
+}
+
+TEST_F(RedundancyFilterTest, ShortFrameRejected) {
+    uint8_t f[10] = {};
+    RedundancyTag tag;
+    EXPECT_FALSE(parseRedundancyTag(f, sizeof(f), tag));
+}
+
+TEST_F(RedundancyFilterTest, DropsSecondCopy) {
+    DuplicateFilter filter;
+    for (uint16_t seq = 0; seq < 100; ++seq) {
+        EXPECT_TRUE(filter.accept(srcA, seq, 0));
+        EXPECT_FALSE(filter.accept(srcA, seq, 1));
+    }
+    // Other source has its own sequence space
+    EXPECT_TRUE(filter.accept(srcB, 5, 1));
+
+    EXPECT_EQ(filter.lanStats(0).received, 100u);
+    EXPECT_EQ(filter.lanStats(0).duplicates, 0u);
+    EXPECT_EQ(filter.lanStats(1).received, 101u);
+    EXPECT_EQ(filter.lanStats(1).duplicates, 100u);
+    EXPECT_EQ(filter.sourceCount(), 2u);
+}
+
+TEST_F(RedundancyFilterTest, LateAndReorderedFrames) {
+    DuplicateFilter filter;
+    EXPECT_TRUE(filter.accept(srcA, 10, 0));
+    EXPECT_TRUE(filter.accept(srcA, 20, 0));
+    // LAN B lags: 11..20 arrive late, only 11..19 are new
+    for (uint16_t seq = 11; seq < 20; ++seq) {
+        EXPECT_TRUE(filter.accept(srcA, seq, 1));
+    }
+    EXPECT_FALSE(filter.accept(srcA, 20, 1));
+    EXPECT_FALSE(filter.accept(srcA, 15, 0));
+}
+
+TEST_F(RedundancyFilterTest, WindowAdvanceClearsOldBits) {
+    DuplicateFilter filter;
+    const uint16_t w = static_cast<uint16_t>(DuplicateFilter::Window);
+    EXPECT_TRUE(filter.accept(srcA, 0, 0));
+    EXPECT_TRUE(filter.accept(srcA, w, 0));      // same bit as 0
+    EXPECT_FALSE(filter.accept(srcA, w, 1));
+    EXPECT_TRUE(filter.accept(srcA, w + 1, 0));  // bit of 1 was never set
+}
+
+TEST_F(RedundancyFilterTest, SequenceWrap) {
+    DuplicateFilter filter;
+    EXPECT_TRUE(filter.accept(srcA, 0xFFFE, 0));
+    EXPECT_TRUE(filter.accept(srcA, 0xFFFF, 0));
+    EXPECT_TRUE(filter.accept(srcA, 0x0000, 0));
+    EXPECT_FALSE(filter.accept(srcA, 0xFFFF, 1));
+    EXPECT_FALSE(filter.accept(srcA, 0x0000, 1));
+    EXPECT_EQ(filter.lanStats(0).resets, 0u);
+}
+
+TEST_F(RedundancyFilterTest, SenderRestart) {
+    DuplicateFilter filter;
+    EXPECT_TRUE(filter.accept(srcA, 30000, 0));
+    EXPECT_TRUE(filter.accept(srcA, 0, 0));       // far behind: restart
+    EXPECT_EQ(filter.lanStats(0).resets, 1u);
+    EXPECT_FALSE(filter.accept(srcA, 0, 1));
+    EXPECT_TRUE(filter.accept(srcA, 1, 0));
+}
+
+TEST_F(RedundancyFilterTest, FullTablePassesThrough) {
+    DuplicateFilter filter;
+    uint8_t mac[6] = {0x02, 0, 0, 0, 0, 0};
+    for (size_t n = 0; n < DuplicateFilter::MaxSources; ++n) {
+        mac[5] = static_cast<uint8_t>(n);
+        EXPECT_TRUE(filter.accept(mac, 1, 0));
+    }
+    EXPECT_TRUE(filter.accept(srcA, 1, 0));
+    EXPECT_TRUE(filter.accept(srcA, 1, 1));
+    EXPECT_EQ(filter.untracked(), 2u);
+
+    filter.reset();
+    EXPECT_EQ(filter.sourceCount(), 0u);
+    EXPECT_EQ(filter.lanStats(0).received, 0u);
+}
@@ -0,0 +1,435 @@
+/**
+ * @file test_relay_emulator.cpp
+ * @brief Unit tests for the in-process relay emulator
+ *
+ * Tests cover:
+ * - 51 operate time on the IDMT curve, reset GOOSE once the fault clears
+ * - Mho/quadrilateral zones and zone timers
+ * - 87 through-fault stability and internal trips across smpCnt-aligned streams
+ * - Output delay on the clock, many relays at once, config validation
+ * - Closed loop on SVPublisherInstance output through the loopback
+ */
+
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+#include "relay_emulator.hpp"
+#include "BER_Codec.hpp"
+#include "sv_publisher_instance.hpp"
+
+namespace {
+
+using Complex = std::complex<double>;
+constexpr double Rate = 4800.0;
+constexpr double Frequency = 60.0;
+constexpr double Pi = 3.14159265358979323846;
+
+Complex polarDeg(double magnitude, double degrees) {
+    return std::polar(magnitude, degrees * Pi / 180.0);
+}
+
+// Balanced set starting at phase A's angle
+std::array<Complex, 3> balanced(double magnitude, double angle = 0.0) {
+    return {polarDeg(magnitude, angle), polarDeg(magnitude, angle - 120.0), polarDeg(magnitude, angle + 120.0)};
+}
+
+struct Quantities {
+    std::array<Complex, 3> current = balanced(0.5);
+    std::array<Complex, 3> voltage = balanced(63.5);
+};
+
+// One-ASDU 9-2LE frame: Ia Ib Ic In Va Vb Vc Vn at 1 mA / 10 mV per LSB
+std::vector<uint8_t> svFrame(const std::array<uint8_t, 6>& dst, uint16_t appId, uint64_t sample,
+                             const Quantities& q) {
+    std::array<int32_t, 8> values{};
+    const double t = static_cast<double>(sample) / Rate;
+    for (size_t k = 0; k < 3; ++k) {
+        const double wt = 2.0 * Pi * Frequency * t;
+        values[k] = static_cast<int32_t>(std::lround(std::sqrt(2.0) * std::abs(q.current[k]) *
+                                                     std::cos(wt + std::arg(q.current[k])) * SV92LE_CountsPerAmp));
+        values[4 + k] = static_cast<int32_t>(std::lround(std::sqrt(2.0) * std::abs(q.voltage[k]) *
+                                                         std::cos(wt + std::arg(q.voltage[k])) * SV92LE_CountsPerVolt));
+    }
+
+    const std::string svId = "RelaySV";
+    const size_t asduSize = berTLVSize(svId.size()) + berTLVSize(2) + berTLVSize(4) + berTLVSize(1) + berTLVSize(64);
+    const size_t seqAsduSize = berTLVSize(asduSize);
+    const size_t savPduSize = berTLVSize(1) + berTLVSize(seqAsduSize);
+
+    std::vector<uint8_t> frame(128, 0);
+    BERWriter w(frame.data(), frame.size());
+    w.putBytes(dst.data(), 6);
+    const uint8_t src[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    w.putBytes(src, 6);
+    w.putU16(0x8100);
+    w.putU16(0x8000);
+    w.putU16(0x88BA);
+    w.putU16(appId);
+    w.putU16(static_cast<uint16_t>(8 + berTLVSize(savPduSize)));
+    w.putU16(0);
+    w.putU16(0);
+    w.putHeader(0x60, savPduSize);
+    w.putU8TLV(0x80, 1);
+    w.putHeader(0xA2, seqAsduSize);
+    w.putHeader(0x30, asduSize);
+    w.putTLV(0x80, svId.data(), svId.size());
+    w.putU16TLV(0x82, static_cast<uint16_t>(sample % static_cast<uint64_t>(Rate)));
+    w.putU32TLV(0x83, 1);
+    w.putU8TLV(0x85, 1);
+    w.putHeader(0x87, 64);
+    for (int32_t value : values) {
+        w.putU32(static_cast<uint32_t>(value));
+        w.putU32(0);
+    }
+    frame.resize(w.size());
+    return frame;
+}
+
+const std::array<uint8_t, 6> LocalMac{{0x01, 0x0C, 0xCD, 0x04, 0x00, 0x01}};
+const std::array<uint8_t, 6> RemoteMac{{0x01, 0x0C, 0xCD, 0x04, 0x00, 0x02}};
+
+struct GooseEvent {
+    uint64_t sample;                        // Sample being fed when it arrived
+    std::array<bool, 4> data;               // Trip, 50/51, 21, 87
+    uint32_t stNum;
+};
+
+} // namespace
+
+class RelayEmulatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        loopback = std::make_shared<FrameLoopback>();
+        clock = std::make_shared<VirtualClock>();
+        emulator = std::make_unique<RelayEmulator>(clock);
+        emulator->setLoopback(loopback);
+        loopback->attach([this](const uint8_t* frame, size_t length) {
+            if (length < 30 || frame[16] != 0x88 || frame[17] != 0xB8) return;
+            // allData is the last field: four "83 01 vv" BOOLEANs
+            GooseEvent event;
+            event.sample = sample;
+            for (size_t k = 0; k < 4; ++k) {
+                event.data[k] = frame[length - 12 + 3 * k + 2] != 0;
+            }
+            // goosePdu after the 18-byte header and APPID/length/reserved
+            BERReader reader(frame + 26, length - 26);
+            BERReader pdu;
+            BERReader field;
+            uint8_t tag = 0;
+            event.stNum = 0;
+            if (reader.readTLV(tag, pdu) && tag == 0x61) {
+                while (pdu.readTLV(tag, field)) {
+                    if (tag == 0x85) {
+                        field.readUnsigned(event.stNum);
+                        break;
+                    }
+                }
+            }
+            events.push_back(event);
+        });
+    }
+
+    static RelayConfig overcurrentRelay(const std::string& name) {
+        RelayConfig config;
+        config.name = name;
+        config.overcurrent.enabled = true;
+        config.overcurrent.settings = {1.0, 0.1, vts::testers::OCCurve::STANDARD_INVERSE};
+        config.outputDelay = 0.0;
+        return config;
+    }
+
+    // Feed `seconds` of the local (and optionally remote) stream
+    void feed(double seconds, const Quantities& local, const Quantities* remote = nullptr,
+              uint64_t remoteFrom = 0) {
+        const uint64_t end = sample + static_cast<uint64_t>(std::llround(seconds * Rate));
+        for (; sample < end; ++sample) {
+            const std::vector<uint8_t> frame = svFrame(LocalMac, 0x4000, sample, local);
+            loopback->send(frame.data(), frame.size());
+            if (remote && sample >= remoteFrom) {
+                const std::vector<uint8_t> other = svFrame(RemoteMac, 0x4001, sample, *remote);
+                loopback->send(other.data(), other.size());
+            }
+            clock->advance(std::chrono::nanoseconds(static_cast<int64_t>(1e9 / Rate)));
+        }
+    }
+
+    std::shared_ptr<FrameLoopback> loopback;
+    std::shared_ptr<VirtualClock> clock;
+    std::unique_ptr<RelayEmulator> emulator;
+    std::vector<GooseEvent> events;
+    uint64_t sample = 0;
+    std::string error;
+};
+
+TEST_F(RelayEmulatorTest, OvercurrentFollowsTheCurveAndResets) {
+    ASSERT_TRUE(emulator->start({overcurrentRelay("R1")}, error)) << error;
+
+    Quantities fault;
+    fault.current = balanced(5.0, -80.0);
+    feed(0.2, Quantities());
+    EXPECT_TRUE(events.empty());
+    const uint64_t inception = sample;
+    feed(1.0, fault);
+
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_TRUE(events[0].data[0]);
+    EXPECT_TRUE(events[0].data[1]);
+    EXPECT_FALSE(events[0].data[2]);
+    EXPECT_FALSE(events[0].data[3]);
+
+    // Curve time plus at most the cycle that sees the fault and one evaluation step
+    const double expected = vts::testers::OvercurrentTester::calculateTripTime({1.0, 0.1, vts::testers::OCCurve::STANDARD_INVERSE}, 5.0);
+    const double measured = static_cast<double>(events[0].sample - inception) / Rate;
+    EXPECT_GE(measured, expected);
+    EXPECT_LE(measured, expected + 2.0 / Frequency + 1e-3);
+
+    feed(0.1, Quantities());
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_FALSE(events[1].data[0]);
+    EXPECT_EQ(events[1].stNum, events[0].stNum + 1);
+
+    const RelayEmulatorStats stats = emulator->getStats();
+    ASSERT_EQ(stats.relays.size(), 1u);
+    EXPECT_EQ(stats.relays[0].trips, 1u);
+    EXPECT_EQ(stats.relays[0].gooseSent, 2u);
+    EXPECT_NEAR(stats.relays[0].lastOperateTime, expected, 1.0 / Frequency + 1e-3);
+    EXPECT_NEAR(stats.relays[0].frequency, Frequency, 0.01);
+    EXPECT_EQ(stats.framesProcessed, sample);
+    EXPECT_EQ(stats.sampleGaps, 0u);
+}
+
+TEST_F(RelayEmulatorTest, DistanceZonesAndTimers) {
+    RelayConfig config;
+    config.name = "R21";
+    config.outputDelay = 0.0;
+    config.distance.enabled = true;
+    RelayDistanceZone zone1;
+    zone1.reach = 10.0;
+    zone1.angle = 75.0;
+    RelayDistanceZone zone2 = zone1;
+    zone2.reach = 20.0;
+    zone2.delay = 0.3;
+    config.distance.zones = {zone1, zone2};
+    ASSERT_TRUE(emulator->start({config}, error)) << error;
+
+    // Phase A to ground fault; k0 = 0 so the AG loop sees Va / Ia
+    auto fault = [](Complex z) {
+        Quantities q;
+        q.current[0] = polarDeg(5.0, -75.0);
+        q.voltage[0] = z * q.current[0];
+        return q;
+    };
+
+    feed(0.2, Quantities());
+    uint64_t inception = sample;
+    feed(0.1, fault(polarDeg(5.0, 75.0)));
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_TRUE(events[0].data[2]);
+    // Two cycles inside, after the one straddling inception
+    EXPECT_LE(static_cast<double>(events[0].sample - inception) / Rate, 3.0 / Frequency + 1e-3);
+
+    feed(0.2, Quantities());
+    ASSERT_EQ(events.size(), 2u);
+    inception = sample;
+    feed(0.6, fault(polarDeg(15.0, 75.0)));
+    ASSERT_EQ(events.size(), 3u);
+    const double zone2Time = static_cast<double>(events[2].sample - inception) / Rate;
+    EXPECT_GE(zone2Time, 0.3);
+    EXPECT_LE(zone2Time, 0.3 + 2.0 / Frequency + 1e-3);
+
+    feed(0.2, Quantities());
+    ASSERT_EQ(events.size(), 4u);
+    feed(0.6, fault(polarDeg(25.0, 75.0)));
+    EXPECT_EQ(events.size(), 4u);           // Beyond both zones
+}
+
+TEST_F(RelayEmulatorTest, QuadrilateralResistiveReach) {
+    RelayConfig config;
+    config.name = "Quad";
+    config.outputDelay = 0.0;
+    config.distance.enabled = true;
+    RelayDistanceZone zone;
+    zone.shape = RelayDistanceZone::Shape::Quadrilateral;
+    zone.reach = 10.0;
+    zone.angle = 75.0;
+    zone.resistiveReach = 5.0;
+    config.distance.zones = {zone};
+    ASSERT_TRUE(emulator->start({config}, error)) << error;
+
+    // Phase-to-phase (BC) fault: Vb - Vc = Z (Ib - Ic) around a common
+    // midpoint, which keeps the BG and CG loops outside the zone
+    auto fault = [](Complex z) {
+        Quantities q;
+        q.current[1] = polarDeg(4.0, -90.0);
+        q.current[2] = -q.current[1];
+        const Complex midpoint(-40.0, 0.0);
+        q.voltage[1] = midpoint + z * q.current[1];
+        q.voltage[2] = midpoint + z * q.current[2];
+        return q;
+    };
+
+    feed(0.2, Quantities());
+    feed(0.2, fault({6.0, 2.0}));           // R - X / tan(75) = 5.46: outside
+    EXPECT_TRUE(events.empty());
+    feed(0.2, fault({4.0, 2.0}));           // 3.46: inside
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_TRUE(events[0].data[2]);
+}
+
+TEST_F(RelayEmulatorTest, DifferentialAlignsStreamsBySmpCnt) {
+    RelayConfig config;
+    config.name = "R87";
+    config.outputDelay = 0.0;
+    config.differential.enabled = true;
+    config.differential.remoteDstMac = RemoteMac;
+    config.differential.remoteAppId = 0x4001;
+    ASSERT_TRUE(emulator->start({config}, error)) << error;
+
+    // Through fault: the remote end sees the same current flowing out.
+    // The remote stream starts 37 samples later; smpCnt lines the two up
+    // and 87 stays blocked until its first cycle is in.
+    Quantities local;
+    local.current = balanced(4.0, -80.0);
+    Quantities through;
+    through.current = balanced(4.0, 100.0);
+    feed(0.5, local, &through, 37);
+    EXPECT_TRUE(events.empty());
+
+    // Internal fault: both ends feed in
+    Quantities internal = local;
+    const uint64_t inception = sample;
+    feed(0.1, local, &internal);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_TRUE(events[0].data[3]);
+    EXPECT_FALSE(events[0].data[1]);
+    EXPECT_LE(static_cast<double>(events[0].sample - inception) / Rate, 2.0 / Frequency + 1e-3);
+}
+
+TEST_F(RelayEmulatorTest, OutputDelayRunsOnTheClock) {
+    RelayConfig delayed = overcurrentRelay("Delayed");
+    delayed.overcurrent.settings.curve = vts::testers::OCCurve::INSTANTANEOUS;
+    delayed.outputDelay = 0.010;
+    delayed.gooseAppId = 2;
+    RelayConfig direct = overcurrentRelay("Direct");
+    direct.overcurrent.settings.curve = vts::testers::OCCurve::INSTANTANEOUS;
+    ASSERT_TRUE(emulator->start({delayed, direct}, error)) << error;
+
+    Quantities fault;
+    fault.current = balanced(3.0);
+    feed(0.2, Quantities());
+    feed(0.1, fault);
+    ASSERT_EQ(events.size(), 2u);
+    const double gap = static_cast<double>(events[1].sample - events[0].sample) / Rate;
+    EXPECT_NEAR(gap, 0.010, 1.0 / Rate + 1e-9);
+
+    const RelayEmulatorStats stats = emulator->getStats();
+    ASSERT_EQ(stats.relays.size(), 2u);
+    EXPECT_GE(stats.relays[0].outputMaxNs, 10000000);
+    EXPECT_LE(stats.relays[0].outputMaxNs, 10000000 + static_cast<int64_t>(1e9 / Rate) + 1);
+    EXPECT_EQ(stats.relays[1].outputMaxNs, 0);
+}
+
+TEST_F(RelayEmulatorTest, ManyRelaysShareTrackedChannels) {
+    std::vector<RelayConfig> relays;
+    for (int i = 0; i < 32; ++i) {
+        RelayConfig config = overcurrentRelay("R" + std::to_string(i));
+        config.overcurrent.settings.pickupCurrent = 1.0 + 0.1 * i;
+        config.gooseAppId = static_cast<uint16_t>(0x100 + i);
+        relays.push_back(config);
+    }
+    ASSERT_TRUE(emulator->start(relays, error)) << error;
+
+    Quantities fault;
+    fault.current = balanced(10.0);
+    feed(0.1, Quantities());
+    feed(1.0, fault);
+    EXPECT_EQ(events.size(), 32u);
+
+    const RelayEmulatorStats stats = emulator->getStats();
+    EXPECT_EQ(stats.relays.size(), 32u);
+    EXPECT_EQ(stats.framesProcessed, sample);
+    EXPECT_GT(stats.processingP50Ns, 0);
+    for (const RelayStats& relay : stats.relays) {
+        EXPECT_TRUE(relay.tripped);
+        EXPECT_EQ(relay.frames, sample);
+    }
+}
+
+TEST_F(RelayEmulatorTest, ClosesTheLoopOnOurOwnPublisher) {
+    // 12.7 ohm at 80 deg: inside a 15 ohm mho zone, and only if both sides
+    // agree on the current and voltage scaling
+    RelayConfig inside;
+    inside.name = "Z15";
+    inside.outputDelay = 0.0;
+    inside.distance.enabled = true;
+    RelayDistanceZone zone;
+    zone.reach = 15.0;
+    zone.angle = 80.0;
+    inside.distance.zones = {zone};
+    RelayConfig outside = inside;
+    outside.name = "Z10";
+    outside.gooseAppId = 0x0002;
+    outside.distance.zones[0].reach = 10.0;
+    ASSERT_TRUE(emulator->start({inside, outside}, error)) << error;
+
+    SVConfig sv;
+    sv.appId = "4000";
+    sv.macDst = "01:0c:cd:04:00:01";
+    sv.macSrc = "02:00:00:00:00:01";
+    sv.vlanId = 0;
+    sv.vlanPrio = 4;
+    sv.svId = "LoopSV";
+    sv.nominalFreq = Frequency;
+    sv.sampleRate = static_cast<uint32_t>(Rate);
+    sv.dataSource = DataSource::MANUAL;
+    SVPublisherInstance publisher("sv1", sv, loopback, clock);
+    publisher.setPhasors({{5.0, -80.0}, {5.0, -200.0}, {5.0, 40.0}, {0.0, 0.0},
+                          {63.5, 0.0}, {63.5, -120.0}, {63.5, 120.0}, {0.0, 0.0}});
+    publisher.start();
+    for (; sample < static_cast<uint64_t>(0.3 * Rate); ++sample) {
+        publisher.tick();
+        clock->advance(std::chrono::nanoseconds(static_cast<int64_t>(1e9 / Rate)));
+    }
+
+    const RelayEmulatorStats stats = emulator->getStats();
+    ASSERT_EQ(stats.relays.size(), 2u);
+    EXPECT_GT(stats.framesProcessed, 0u);
+    for (size_t k = 0; k < 3; ++k) {
+        EXPECT_NEAR(stats.relays[0].current[k], 5.0, 0.05);
+    }
+    EXPECT_TRUE(stats.relays[0].tripped);
+    EXPECT_TRUE(stats.relays[0].distance);
+    EXPECT_FALSE(stats.relays[1].tripped);
+}
+
+TEST_F(RelayEmulatorTest, ValidateRejectsBadSettings) {
+    RelayConfig config = overcurrentRelay("Bad");
+    EXPECT_TRUE(RelayEmulator::validate(config, error)) << error;
+
+    RelayConfig none = config;
+    none.overcurrent.enabled = false;
+    EXPECT_FALSE(RelayEmulator::validate(none, error));
+
+    RelayConfig zones = config;
+    zones.distance.enabled = true;
+    EXPECT_FALSE(RelayEmulator::validate(zones, error));
+    zones.distance.zones.push_back(RelayDistanceZone());
+    zones.distance.zones[0].angle = 95.0;
+    EXPECT_FALSE(RelayEmulator::validate(zones, error));
+
+    RelayConfig self = config;
+    self.differential.enabled = true;
+    self.differential.remoteDstMac = self.svDstMac;
+    self.differential.remoteAppId = self.svAppId;
+    EXPECT_FALSE(RelayEmulator::validate(self, error));
+
+    RelayConfig mismatch = config;
+    mismatch.name = "Other";
+    mismatch.sampleRate = 4000.0;
+    EXPECT_FALSE(emulator->start({config, mismatch}, error));
+    EXPECT_FALSE(emulator->isRunning());
+}
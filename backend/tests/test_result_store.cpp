@@ -0,0 +1,348 @@
+/**
+ * @file test_result_store.cpp
+ * @brief Unit tests for the relay test result store
+ *
+ * Tests cover:
+ * - Queries by relay, kind, pass/fail and time range, newest first
+ * - Tester results mapped onto records
+ * - Trip-time aggregates and histograms
+ * - Results read back after reopening, torn and corrupt tails cut off
+ */
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "result_store.hpp"
+#include "overcurrent_tester.hpp"
+#include "ramping_tester.hpp"
+
+using namespace vts::testers;
+
+namespace {
+
+constexpr int64_t Second = 1000000000;
+
+ResultRecord makeRecord(const std::string& relay, ResultKind kind, int64_t timeNs, bool passed,
+                        double tripTime, bool tripped = true) {
+    ResultRecord record;
+    record.relay = relay;
+    record.kind = kind;
+    record.timeNs = timeNs;
+    record.passed = passed;
+    record.tripped = tripped;
+    record.tripTime = tripTime;
+    return record;
+}
+
+uint64_t fileSize(const std::string& path) {
+    return static_cast<uint64_t>(std::filesystem::file_size(path));
+}
+
+} // namespace
+
+class ResultStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = (std::filesystem::temp_directory_path() / "vts_result_store_test").string();
+        std::filesystem::remove_all(directory_);
+        path_ = (std::filesystem::path(directory_) / "results.vtr").string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    // Relays R1/R2, distance and overcurrent, one second apart
+    void fill(ResultStore& store) {
+        std::vector<ResultRecord> records;
+        for (int i = 0; i < 20; ++i) {
+            records.push_back(makeRecord(i % 2 ? "R2" : "R1", i % 4 < 2 ? ResultKind::DISTANCE : ResultKind::OVERCURRENT,
+                                         (100 + i) * Second, i % 5 != 0, 0.02 + 0.001 * i));
+        }
+        store.append(records);
+    }
+
+    std::string directory_;
+    std::string path_;
+};
+
+TEST_F(ResultStoreTest, QueryReturnsNewestFirst) {
+    ResultStore store("");
+    fill(store);
+
+    ResultQuery query;
+    uint64_t total = 0;
+    std::vector<ResultRecord> records = store.query(query, total);
+    EXPECT_EQ(total, 20u);
+    ASSERT_EQ(records.size(), 20u);
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].seq, 19 - i);
+        EXPECT_EQ(records[i].timeNs, static_cast<int64_t>(119 - i) * Second);
+    }
+
+    query.limit = 3;
+    records = store.query(query, total);
+    EXPECT_EQ(total, 20u);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[2].seq, 17u);
+    EXPECT_EQ(store.status().path, "");
+    EXPECT_EQ(store.status().pending, 0u);
+}
+
+TEST_F(ResultStoreTest, FiltersByRelayKindPassedAndTime) {
+    ResultStore store("");
+    fill(store);
+
+    ResultQuery query;
+    query.relay = "R1";
+    query.kind = static_cast<int>(ResultKind::DISTANCE);
+    uint64_t total = 0;
+    std::vector<ResultRecord> records = store.query(query, total);
+    EXPECT_EQ(total, 5u);                               // i = 0, 4, 8, 12, 16
+    for (const ResultRecord& record : records) {
+        EXPECT_EQ(record.relay, "R1");
+        EXPECT_EQ(record.kind, ResultKind::DISTANCE);
+    }
+
+    query.passed = 0;                                   // i = 0
+    records = store.query(query, total);
+    ASSERT_EQ(total, 1u);
+    EXPECT_EQ(records[0].seq, 0u);
+
+    query = ResultQuery();
+    query.fromNs = 105 * Second;
+    query.toNs = 110 * Second;                          // i = 5..9
+    records = store.query(query, total);
+    ASSERT_EQ(total, 5u);
+    EXPECT_EQ(records.front().seq, 9u);
+    EXPECT_EQ(records.back().seq, 5u);
+
+    query = ResultQuery();
+    query.relay = "R9";
+    store.query(query, total);
+    EXPECT_EQ(total, 0u);
+}
+
+TEST_F(ResultStoreTest, TesterResultsBecomeRecords) {
+    ResultStore store("");
+    OCResult oc{2.0, 200.0, true, 1.25, 1.2, true, ""};
+    OCResult slow{5.0, 500.0, false, 0.0, 0.5, false, "No trip"};
+    store.append("Feeder 7", 42, std::vector<OCResult>{oc, slow});
+
+    RampResult ramp{};
+    ramp.completed = true;
+    ramp.pickupValue = 104.5;
+    ramp.dropoffValue = 99.0;
+    ramp.pickupTime = 3.2;
+    store.append("Feeder 7", 43, ramp);
+
+    ResultQuery query;
+    uint64_t total = 0;
+    std::vector<ResultRecord> records = store.query(query, total);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].kind, ResultKind::RAMP);
+    EXPECT_EQ(records[0].jobId, 43u);
+    EXPECT_TRUE(records[0].passed);
+    EXPECT_TRUE(records[0].tripped);
+    EXPECT_DOUBLE_EQ(records[0].tripTime, 3.2);
+    EXPECT_DOUBLE_EQ(records[0].x, 104.5);
+
+    EXPECT_EQ(records[1].kind, ResultKind::OVERCURRENT);
+    EXPECT_FALSE(records[1].tripped);
+    EXPECT_FALSE(records[1].passed);
+    EXPECT_DOUBLE_EQ(records[2].tripTime, 1.25);
+    EXPECT_DOUBLE_EQ(records[2].expectedTime, 1.2);
+    EXPECT_DOUBLE_EQ(records[2].x, 2.0);
+    EXPECT_DOUBLE_EQ(records[2].y, 200.0);
+
+    const nlohmann::json j = records[2].toJson();
+    EXPECT_EQ(j["relay"], "Feeder 7");
+    EXPECT_EQ(j["kind"], "overcurrent");
+    EXPECT_EQ(j["currentMultiple"], 2.0);
+    EXPECT_EQ(j["jobId"], 42u);
+}
+
+TEST_F(ResultStoreTest, TimeNeverGoesBackwards) {
+    ResultStore store("");
+    store.append({makeRecord("R1", ResultKind::DISTANCE, 0, true, 0.1)});
+    store.append({makeRecord("R1", ResultKind::DISTANCE, 5 * Second, true, 0.1)});
+
+    ResultQuery query;
+    uint64_t total = 0;
+    std::vector<ResultRecord> records = store.query(query, total);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_GT(records[1].timeNs, 1600000000 * Second);  // Stamped now
+    EXPECT_EQ(records[0].timeNs, records[1].timeNs);    // Clamped, not before it
+}
+
+TEST_F(ResultStoreTest, AggregatesTripTimesPerRelayAndKind) {
+    ResultStore store("");
+    std::vector<ResultRecord> records;
+    for (int i = 0; i < 100; ++i) {
+        records.push_back(makeRecord("R1", ResultKind::OVERCURRENT, (1000 + i) * Second, i < 90, 1.0 + 0.125 * i));
+    }
+    records.push_back(makeRecord("R1", ResultKind::OVERCURRENT, 1100 * Second, false, 0.0, false));
+    records.push_back(makeRecord("R1", ResultKind::DISTANCE, 1101 * Second, true, 0.03));
+    records.push_back(makeRecord("R2", ResultKind::OVERCURRENT, 1102 * Second, true, 0.5));
+    store.append(records);
+
+    ResultQuery query;
+    query.relay = "R1";
+    query.kind = static_cast<int>(ResultKind::OVERCURRENT);
+    std::vector<ResultAggregate> groups = store.aggregate(query, 1.25);
+    ASSERT_EQ(groups.size(), 1u);
+    const ResultAggregate& g = groups[0];
+    EXPECT_EQ(g.runs, 101u);
+    EXPECT_EQ(g.passed, 90u);
+    EXPECT_EQ(g.tripped, 100u);
+    EXPECT_DOUBLE_EQ(g.minTripTime, 1.0);
+    EXPECT_DOUBLE_EQ(g.maxTripTime, 13.375);
+    EXPECT_DOUBLE_EQ(g.meanTripTime, 7.1875);
+    EXPECT_DOUBLE_EQ(g.p50TripTime, 7.125);
+    EXPECT_DOUBLE_EQ(g.p90TripTime, 12.125);
+    EXPECT_DOUBLE_EQ(g.p99TripTime, 13.25);
+    ASSERT_EQ(g.histogram.size(), 10u);
+    for (uint64_t count : g.histogram) {
+        EXPECT_EQ(count, 10u);
+    }
+
+    // Only the last 10 runs
+    query.fromNs = 1090 * Second;
+    groups = store.aggregate(query, 1.25);
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].runs, 11u);
+    EXPECT_EQ(groups[0].tripped, 10u);
+    EXPECT_DOUBLE_EQ(groups[0].minTripTime, 12.25);
+
+    // Every relay and kind
+    groups = store.aggregate(ResultQuery(), 1.25);
+    ASSERT_EQ(groups.size(), 3u);
+    EXPECT_EQ(groups[0].relay, "R1");
+    EXPECT_EQ(groups[0].kind, ResultKind::DISTANCE);
+    EXPECT_EQ(groups[1].kind, ResultKind::OVERCURRENT);
+    EXPECT_EQ(groups[2].relay, "R2");
+    EXPECT_EQ(groups[2].toJson()["tripTime"]["histogram"], nlohmann::json::array({1}));
+}
+
+TEST_F(ResultStoreTest, HistogramBinsAreCapped) {
+    ResultStore store("");
+    store.append({makeRecord("R1", ResultKind::DISTANCE, Second, true, 0.0),
+                  makeRecord("R1", ResultKind::DISTANCE, Second, true, 10.0)});
+    std::vector<ResultAggregate> groups = store.aggregate(ResultQuery(), 1e-9);
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_LE(groups[0].histogram.size(), ResultStore_MaxHistogramBins);
+    EXPECT_EQ(groups[0].histogram.front(), 1u);
+    EXPECT_EQ(groups[0].histogram.back(), 1u);
+}
+
+TEST_F(ResultStoreTest, ResultsSurviveReopening) {
+    {
+        ResultStore store(directory_);
+        fill(store);
+        store.append({makeRecord("R3", ResultKind::TRANSIENT, 200 * Second, true, 0.045)});
+        store.flush();
+        const ResultStoreStatus status = store.status();
+        EXPECT_EQ(status.path, path_);
+        EXPECT_EQ(status.pending, 0u);
+        EXPECT_GE(status.blocksWritten, 1u);
+        EXPECT_EQ(status.bytesWritten + 8, fileSize(path_));
+    }
+
+    ResultStore store(directory_);
+    ResultQuery query;
+    uint64_t total = 0;
+    std::vector<ResultRecord> records = store.query(query, total);
+    ASSERT_EQ(total, 21u);
+    EXPECT_EQ(records[0].relay, "R3");
+    EXPECT_EQ(records[0].kind, ResultKind::TRANSIENT);
+    EXPECT_DOUBLE_EQ(records[0].tripTime, 0.045);
+    EXPECT_EQ(store.status().relays, 3u);
+
+    query.relay = "R2";
+    query.passed = 0;
+    records = store.query(query, total);
+    ASSERT_EQ(total, 2u);                               // i = 5, 15
+    EXPECT_EQ(records[0].timeNs, 115 * Second);
+}
+
+TEST_F(ResultStoreTest, DestructionWritesPendingResults) {
+    {
+        ResultStore store(directory_);
+        for (int i = 0; i < 200; ++i) {
+            store.append({makeRecord("R" + std::to_string(i % 7), ResultKind::DIFFERENTIAL, (i + 1) * Second, true, 0.03)});
+        }
+    }
+    ResultStore store(directory_);
+    EXPECT_EQ(store.status().records, 200u);
+    EXPECT_EQ(store.status().relays, 7u);
+}
+
+TEST_F(ResultStoreTest, TornTailIsCutOff) {
+    {
+        ResultStore store(directory_);
+        fill(store);
+    }
+    const uint64_t intact = fileSize(path_);
+    {
+        std::ofstream file(path_, std::ios::binary | std::ios::app);
+        file << "RBLK partial block";
+    }
+
+    {
+        ResultStore store(directory_);
+        EXPECT_EQ(store.status().records, 20u);
+        EXPECT_EQ(store.status().recoveredBytes, 18u);
+        EXPECT_EQ(fileSize(path_), intact);
+        store.append({makeRecord("R1", ResultKind::DISTANCE, 300 * Second, true, 0.02)});
+    }
+    ResultStore store(directory_);
+    EXPECT_EQ(store.status().records, 21u);
+    EXPECT_EQ(store.status().recoveredBytes, 0u);
+}
+
+TEST_F(ResultStoreTest, CorruptBlockEndsTheLog) {
+    uint64_t firstBlockEnd = 0;
+    {
+        ResultStore store(directory_);
+        fill(store);
+        store.flush();
+        firstBlockEnd = fileSize(path_);
+        store.append({makeRecord("R1", ResultKind::DISTANCE, 300 * Second, true, 0.02)});
+    }
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(fileSize(path_) - 3));
+        file.put('\x5a');
+    }
+
+    ResultStore store(directory_);
+    EXPECT_EQ(store.status().records, 20u);
+    EXPECT_EQ(fileSize(path_), firstBlockEnd);
+}
+
+TEST_F(ResultStoreTest, ForeignFileIsLeftAlone) {
+    std::filesystem::create_directories(directory_);
+    {
+        std::ofstream file(path_);
+        file << "not a result store";
+    }
+
+    ResultStore store(directory_);
+    store.append({makeRecord("R1", ResultKind::DISTANCE, Second, true, 0.02)});
+    const ResultStoreStatus status = store.status();
+    EXPECT_EQ(status.path, "");
+    EXPECT_EQ(status.records, 1u);
+    EXPECT_FALSE(status.lastError.empty());
+    EXPECT_EQ(fileSize(path_), 18u);
+}
+
+TEST_F(ResultStoreTest, KindNames) {
+    ResultKind kind;
+    for (size_t k = 0; k < ResultKindCount; ++k) {
+        ASSERT_TRUE(ResultStore::parseKind(ResultStore::kindToString(static_cast<ResultKind>(k)), kind));
+        EXPECT_EQ(kind, static_cast<ResultKind>(k));
+    }
+    EXPECT_FALSE(ResultStore::parseKind("impedance", kind));
+}
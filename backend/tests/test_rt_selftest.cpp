@@ -0,0 +1,173 @@
+/**
+ * @file test_rt_selftest.cpp
+ * @brief Unit tests for the built-in RT latency self-test
+ *
+ * Tests cover:
+ * - Core list parsing (--publisher-cpus / --sniffer-cpus)
+ * - Sample rate verdicts from the worst wakeup latency
+ * - A short measured run: threads per role, wakeup count, report JSON
+ * - SV publisher manager warning about or refusing unsustainable rates
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "rt_selftest.hpp"
+#include "sv_publisher_manager.hpp"
+
+namespace {
+
+std::shared_ptr<const RtSelfTestReport> reportWithWorst(int64_t publisherNs, int64_t snifferNs) {
+    auto report = std::make_shared<RtSelfTestReport>();
+    report->tickNs = SV_TickPeriodNs;
+    report->periodNs = RtSelfTest_PeriodNs;
+    report->threads.resize(2);
+    report->threads[0].role = "publisher";
+    report->threads[0].latency.record(publisherNs / 2);
+    report->threads[0].latency.record(publisherNs);
+    report->threads[1].role = "sniffer";
+    report->threads[1].latency.record(snifferNs);
+    return report;
+}
+
+} // namespace
+
+TEST(RtSelfTestTest, ParsesCoreLists) {
+    std::vector<int> cpus;
+    ASSERT_TRUE(parseCpuList("2,3", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{2, 3}));
+    ASSERT_TRUE(parseCpuList("2-4,8", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{2, 3, 4, 8}));
+    ASSERT_TRUE(parseCpuList("5", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{5}));
+}
+
+TEST(RtSelfTestTest, RejectsMalformedCoreLists) {
+    std::vector<int> cpus = {7};
+    for (const char* bad : {"", "a", "3-1", "2,,3", "2,", "-1", "1-", "12345"}) {
+        EXPECT_FALSE(parseCpuList(bad, cpus)) << bad;
+        EXPECT_EQ(cpus, (std::vector<int>{7})) << bad;
+    }
+}
+
+TEST(RtSelfTestTest, VerdictFollowsTheTickAndCatchUpBudget) {
+    // Under ThreadHealth_LateNs past the tick: no deadline misses at any rate
+    EXPECT_EQ(rateVerdict(30000, 4800), RateVerdict::Ok);
+    EXPECT_EQ(rateVerdict(90000, 14400), RateVerdict::Ok);      // Longer than a 69 us sample period
+    // Late samples, caught up within SV_MaxCatchUpMs
+    EXPECT_EQ(rateVerdict(150000, 14400), RateVerdict::Marginal);
+    EXPECT_EQ(rateVerdict(19000000, 4800), RateVerdict::Marginal);
+    // Backlog past the catch-up budget: the stream realigns
+    EXPECT_EQ(rateVerdict(25000000, 4800), RateVerdict::Unsustainable);
+    EXPECT_EQ(rateVerdict(25000000, 14400), RateVerdict::Unsustainable);
+    // A one-sample budget at low rates: 25 ms is a quarter of a 10 Hz sample
+    EXPECT_EQ(rateVerdict(25000000, 10), RateVerdict::Marginal);
+    // A longer tick leaves less of the budget
+    EXPECT_EQ(rateVerdict(19000000, 4800, 2000000), RateVerdict::Unsustainable);
+    EXPECT_EQ(rateVerdictToString(RateVerdict::Marginal), "MARGINAL");
+}
+
+TEST(RtSelfTestTest, VerdictUsesThePublisherThreads) {
+    auto report = reportWithWorst(80000, 30000000);
+    EXPECT_EQ(report->worstNs("publisher"), 80000);
+    EXPECT_EQ(report->worstNs("sniffer"), 30000000);
+    EXPECT_EQ(report->verdict(4800), RateVerdict::Ok);
+    EXPECT_EQ(report->verdict(14400), RateVerdict::Ok);
+    EXPECT_EQ(reportWithWorst(30000000, 0)->verdict(14400), RateVerdict::Unsustainable);
+
+    RtSelfTestReport snifferOnly;
+    snifferOnly.threads.resize(1);
+    snifferOnly.threads[0].role = "sniffer";
+    snifferOnly.threads[0].latency.record(120000);
+    EXPECT_EQ(snifferOnly.worstNs("publisher"), 120000);    // No publisher thread: all of them
+}
+
+TEST(RtSelfTestTest, ShortRunMeasuresEveryRole) {
+    RtSelfTestConfig config;
+    config.durationNs = 50000000;                // 50 ms
+    config.tickNs = 1000000;                     // 1 ms
+    config.periodNs = 1000000;
+    config.snifferCpus = {0};
+    const RtSelfTestReport report = runRtSelfTest(config);
+
+    ASSERT_EQ(report.threads.size(), 2u);
+    EXPECT_EQ(report.threads[0].role, "publisher");
+    EXPECT_EQ(report.threads[0].cpu, -1);
+    EXPECT_FALSE(report.threads[0].pinned);
+    EXPECT_EQ(report.threads[1].role, "sniffer");
+    EXPECT_EQ(report.threads[1].cpu, 0);
+    for (const RtSelfTestThread& t : report.threads) {
+        EXPECT_EQ(t.periodNs, 1000000u) << t.role;
+        EXPECT_GE(t.latency.min(), 0) << t.role;
+        EXPECT_GE(t.latency.max(), t.latency.min()) << t.role;
+    }
+    // Absolute deadlines keep the sniffer's count; relative ticks drift later
+    // with every oversleep, so the publisher fits at most as many
+    EXPECT_EQ(report.threads[1].latency.count(), 50u);
+    EXPECT_GE(report.threads[0].latency.count(), 10u);
+    EXPECT_LE(report.threads[0].latency.count(), 51u);
+
+    const nlohmann::json j = report.toJson();
+    EXPECT_EQ(j["tickNs"], 1000000u);
+    EXPECT_EQ(j["periodNs"], 1000000u);
+    EXPECT_EQ(j["durationNs"], 50000000u);
+    ASSERT_EQ(j["threads"].size(), 2u);
+    uint64_t counted = 0;
+    for (const auto& bucket : j["threads"][1]["histogram"]) {
+        counted += bucket[1].get<uint64_t>();
+    }
+    EXPECT_EQ(counted, 50u);
+    EXPECT_EQ(j["rates"].size(), 5u);
+    EXPECT_EQ(j["rates"][1]["sampleRate"], 4800);
+}
+
+TEST(RtSelfTestTest, RunShorterThanAPeriodWakesOnce) {
+    RtSelfTestConfig config;
+    config.durationNs = 1;
+    config.tickNs = 1000000;
+    config.periodNs = 1000000;
+    const RtSelfTestReport report = runRtSelfTest(config);
+    EXPECT_EQ(report.threads[0].latency.count(), 1u);
+    EXPECT_EQ(report.threads[1].latency.count(), 1u);
+}
+
+TEST(RtSelfTestTest, ManagerRefusesUnsustainableRatesWhenEnforced) {
+    SVPublisherManager manager;
+    const nlohmann::json stream4800 = {{"svId", "RtSV"}, {"sampleRate", 4800}};
+    const nlohmann::json stream14400 = {{"svId", "RtSV"}, {"sampleRate", 14400}};
+
+    manager.setRtEnforce(true);
+    EXPECT_NO_THROW(manager.createStream(stream14400));    // No report, no check
+
+    // Wakeups later than a 14.4 kHz sample period are caught up, not refused
+    manager.setRtReport(reportWithWorst(250000, 0));
+    const std::string id = manager.createStream(stream4800);
+    EXPECT_NO_THROW(manager.updateStream(id, stream14400));
+
+    manager.setRtReport(reportWithWorst(25000000, 0));
+    EXPECT_THROW(manager.createStream(stream4800), std::invalid_argument);
+    EXPECT_THROW(manager.updateStream(id, stream4800), std::invalid_argument);
+    EXPECT_EQ(manager.getStream(id)["sampleRate"], 14400);
+
+    manager.setRtEnforce(false);                           // Warned about only
+    EXPECT_NO_THROW(manager.createStream(stream4800));
+    EXPECT_NO_THROW(manager.updateStream(id, stream4800));
+    EXPECT_EQ(manager.getRtReport()->worstNs("publisher"), 25000000);
+}
+
+TEST(RtSelfTestTest, ManagerCountsRunningStreams) {
+    SVPublisherManager manager;
+    const std::string a = manager.createStream({{"svId", "RtA"}});
+    const std::string b = manager.createStream({{"svId", "RtB"}});
+    EXPECT_EQ(manager.runningStreams(), 0u);
+
+    manager.startStream(a);
+    EXPECT_EQ(manager.runningStreams(), 1u);
+    manager.startAll();
+    EXPECT_EQ(manager.runningStreams(), 2u);
+    manager.stopStream(b);
+    EXPECT_EQ(manager.runningStreams(), 1u);
+    manager.stopAll();
+    EXPECT_EQ(manager.runningStreams(), 0u);
+}
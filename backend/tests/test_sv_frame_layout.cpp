@@ -0,0 +1,91 @@
+/**
+ * @file test_sv_frame_layout.cpp
+ * @brief Unit tests for the compile-time 9-2LE SV frame layouts
+ *
+ * Tests cover:
+ * - constexpr offsets agree with the positions SampledValue records
+ * - Frames with optional ASDU fields are rejected
+ * - writeAsdu patches smpCnt and data channels, keeps empty channels
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+#include "SampledValue.hpp"
+#include "SV_FrameLayout.hpp"
+
+class SVFrameLayoutTest : public ::testing::Test {
+protected:
+    struct Positions {
+        std::vector<uint8_t> frame;
+        std::vector<uint32_t> smpCnt;
+        std::vector<uint32_t> data;
+    };
+
+    static Positions encode(SampledValue& sv) {
+        Positions p;
+        p.frame = sv.getEncoded(8);
+        for (int num = 0; num < sv.noAsdu; ++num) {
+            p.smpCnt.push_back(static_cast<uint32_t>(sv.getParamPos(num, "smpCnt")));
+            p.data.push_back(static_cast<uint32_t>(sv.getParamPos(num, "seqData")));
+        }
+        return p;
+    }
+};
+
+TEST_F(SVFrameLayoutTest, ConstexprOffsets) {
+    static_assert(SvLayout_92LE_80::smpCntToSeqData == 13, "smpCnt -> seqData distance");
+    static_assert(SvLayout_92LE_80::seqDataSize == 64, "8 channels");
+    static_assert(SvLayout_92LE_256::channelOffset(7) == 13 + 56, "last channel");
+    SUCCEED();
+}
+
+TEST_F(SVFrameLayoutTest, MatchesSingleAsduEncoding) {
+    SampledValue sv(0x4000, 1, "MU01_SV", 0, 1, 1, 0);
+    Positions p = encode(sv);
+    uint32_t stride = 99;
+    EXPECT_TRUE(SvLayout_92LE_80::matches(p.smpCnt.data(), p.data.data(), 1, p.frame.size(), stride));
+    EXPECT_EQ(stride, 0u);
+}
+
+TEST_F(SVFrameLayoutTest, MatchesEightAsduEncoding) {
+    for (const char* svID : {"A", "MU01_SV", "IED_LONG_SAMPLED_VALUE_IDENTIFIER"}) {
+        SampledValue sv(0x4000, 8, svID, 0, 1, 1, 0);
+        Positions p = encode(sv);
+        uint32_t stride = 0;
+        ASSERT_TRUE(SvLayout_92LE_256::matches(p.smpCnt.data(), p.data.data(), 8, p.frame.size(), stride))
+            << "svID=" << svID;
+        EXPECT_EQ(p.smpCnt[7], p.smpCnt[0] + 7 * stride);
+        EXPECT_FALSE(SvLayout_92LE_80::matches(p.smpCnt.data(), p.data.data(), 8, p.frame.size(), stride));
+    }
+}
+
+TEST_F(SVFrameLayoutTest, RejectsOptionalFields) {
+    SampledValue sv(0x4000, 8, "MU01_SV", 0, 1, 1, 0);
+    sv.smpRate = 4800;  // [6] between smpSynch and seqData
+    Positions p = encode(sv);
+    uint32_t stride = 0;
+    EXPECT_FALSE(SvLayout_92LE_256::matches(p.smpCnt.data(), p.data.data(), 8, p.frame.size(), stride));
+}
+
+TEST_F(SVFrameLayoutTest, WriteAsduPatchesFields) {
+    SampledValue sv(0x4000, 1, "MU01_SV", 0, 1, 1, 0);
+    Positions p = encode(sv);
+    // Template value in channel 1 must survive
+    p.frame[p.data[0] + 8] = 0xAB;
+
+    std::vector<int32_t> ch0 = {0, 0x01020304};
+    std::vector<int32_t> ch7 = {0, -2};
+    const int32_t* channels[8] = {ch0.data(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, ch7.data()};
+
+    SvLayout_92LE_80::writeAsdu(p.frame.data() + p.smpCnt[0], 0x1234, channels, 1);
+
+    EXPECT_EQ(p.frame[p.smpCnt[0]], 0x12);
+    EXPECT_EQ(p.frame[p.smpCnt[0] + 1], 0x34);
+    const uint8_t* seq = p.frame.data() + p.data[0];
+    EXPECT_EQ(seq[0], 0x01);
+    EXPECT_EQ(seq[3], 0x04);
+    EXPECT_EQ(seq[8], 0xAB);
+    EXPECT_EQ(seq[56], 0xFF);
+    EXPECT_EQ(seq[59], 0xFE);
+}
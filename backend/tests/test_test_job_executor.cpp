@@ -0,0 +1,348 @@
+/**
+ * @file test_test_job_executor.cpp
+ * @brief Unit tests for the relay test job executor
+ *
+ * Tests cover:
+ * - submit() returning before the job runs, jobs serialized in order
+ * - Progress and state changes reaching the listener
+ * - Cancelling queued and running jobs (a ramp test stopped mid-run)
+ * - Failed jobs, the queue limit and retirement of finished jobs
+ * - StreamPhasorWriter posting tester values on a stream's control channel
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "clock.hpp"
+#include "frame_loopback.hpp"
+#include "ramping_tester.hpp"
+#include "sv_publisher_instance.hpp"
+#include "sv_publisher_manager.hpp"
+#include "test_job_executor.hpp"
+
+using vts::testers::TestJobContext;
+using vts::testers::TestJobExecutor;
+using vts::testers::TestJobInfo;
+using vts::testers::TestJobState;
+using json = nlohmann::json;
+
+namespace {
+
+// Blocks the job it is captured by until open()
+class Gate {
+public:
+    void open() { open_.store(true); }
+    void pass() const {
+        while (!open_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+private:
+    std::atomic<bool> open_{false};
+};
+
+void waitForState(TestJobExecutor& executor, uint64_t id, TestJobState state) {
+    TestJobInfo info;
+    for (int i = 0; i < 5000; ++i) {
+        if (executor.get(id, info) && info.state == state) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    FAIL() << "job " << id << " never reached " << TestJobExecutor::stateToString(state);
+}
+
+} // namespace
+
+TEST(TestJobExecutorTest, SubmitReturnsBeforeTheJobRuns) {
+    TestJobExecutor executor;
+    auto gate = std::make_shared<Gate>();
+    std::string error;
+
+    const uint64_t id = executor.submit("ramp", [gate](TestJobContext&) -> json {
+        gate->pass();
+        return {{"pickupValue", 52.5}};
+    }, error);
+    ASSERT_NE(id, 0u) << error;
+
+    TestJobInfo info;
+    ASSERT_TRUE(executor.get(id, info));
+    EXPECT_FALSE(info.finished());
+    EXPECT_EQ(info.kind, "ramp");
+
+    gate->open();
+    ASSERT_TRUE(executor.wait(id, info));
+    EXPECT_EQ(info.state, TestJobState::COMPLETED);
+    EXPECT_DOUBLE_EQ(info.progress, 1.0);
+    EXPECT_DOUBLE_EQ(info.result["pickupValue"].get<double>(), 52.5);
+    EXPECT_GE(info.finishedAt, info.startedAt);
+    EXPECT_GT(info.startedAt, 0.0);
+
+    const json summary = info.toJson(false);
+    EXPECT_EQ(summary["state"], "COMPLETED");
+    EXPECT_FALSE(summary.contains("result"));
+    EXPECT_TRUE(info.toJson().contains("result"));
+}
+
+TEST(TestJobExecutorTest, JobsRunOneAtATimeInSubmissionOrder) {
+    TestJobExecutor executor;
+    std::mutex mutex;
+    std::vector<int> order;
+    std::atomic<int> active{0};
+    std::atomic<int> maxActive{0};
+    std::string error;
+
+    std::vector<uint64_t> ids;
+    for (int n = 0; n < 5; ++n) {
+        ids.push_back(executor.submit("distance", [&, n](TestJobContext&) -> json {
+            maxActive.store(std::max(maxActive.load(), ++active));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(n);
+            }
+            --active;
+            return json::object();
+        }, error));
+        ASSERT_NE(ids.back(), 0u) << error;
+    }
+
+    TestJobInfo info;
+    ASSERT_TRUE(executor.wait(ids.back(), info));
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(maxActive.load(), 1);
+    EXPECT_EQ(executor.queued(), 0u);
+    EXPECT_EQ(executor.list().size(), 5u);
+}
+
+TEST(TestJobExecutorTest, ListenerSeesProgressAndStateChanges) {
+    TestJobExecutor executor;
+    std::mutex mutex;
+    std::vector<TestJobInfo> updates;
+    executor.setListener([&](const TestJobInfo& info) {
+        std::lock_guard<std::mutex> lock(mutex);
+        updates.push_back(info);
+    });
+
+    std::string error;
+    const uint64_t id = executor.submit("overcurrent", [](TestJobContext& job) -> json {
+        job.progress(0.25, "Point 1/4");
+        job.progress(0.5, "Point 2/4");
+        job.progress(7.0);                  // Clamped
+        return json::object();
+    }, error);
+    TestJobInfo info;
+    ASSERT_TRUE(executor.wait(id, info));
+    // The listener hears of the end after waiters are woken
+    for (int i = 0; i < 1000; ++i) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (updates.size() == 6) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(updates.size(), 6u);
+    EXPECT_EQ(updates[0].state, TestJobState::QUEUED);
+    EXPECT_EQ(updates[1].state, TestJobState::RUNNING);
+    EXPECT_DOUBLE_EQ(updates[2].progress, 0.25);
+    EXPECT_EQ(updates[2].message, "Point 1/4");
+    EXPECT_DOUBLE_EQ(updates[3].progress, 0.5);
+    EXPECT_DOUBLE_EQ(updates[4].progress, 1.0);
+    EXPECT_EQ(updates[5].state, TestJobState::COMPLETED);
+}
+
+TEST(TestJobExecutorTest, CancelledQueuedJobNeverRuns) {
+    TestJobExecutor executor;
+    auto gate = std::make_shared<Gate>();
+    std::atomic<bool> ran{false};
+    std::string error;
+
+    const uint64_t first = executor.submit("ramp", [gate](TestJobContext&) -> json {
+        gate->pass();
+        return json::object();
+    }, error);
+    const uint64_t second = executor.submit("ramp", [&ran](TestJobContext&) -> json {
+        ran = true;
+        return json::object();
+    }, error);
+
+    EXPECT_TRUE(executor.cancel(second));
+    EXPECT_FALSE(executor.cancel(second));  // Already finished
+    EXPECT_FALSE(executor.cancel(12345));
+
+    gate->open();
+    TestJobInfo info;
+    ASSERT_TRUE(executor.wait(first, info));
+    EXPECT_EQ(info.state, TestJobState::COMPLETED);
+    ASSERT_TRUE(executor.wait(second, info));
+    EXPECT_EQ(info.state, TestJobState::CANCELLED);
+    EXPECT_FALSE(ran.load());
+}
+
+TEST(TestJobExecutorTest, CancelStopsARunningRampTest) {
+    TestJobExecutor executor;
+    auto tester = std::make_shared<vts::testers::RampingTester>();
+    tester->setTripFlagGetter([]() { return false; });
+    tester->setValueSetter([](vts::testers::RampVariable, double) {});
+
+    vts::testers::RampConfig config;
+    config.variable = vts::testers::RampVariable::CURRENT_3PH;
+    config.startValue = 0.0;
+    config.endValue = 100.0;
+    config.stepSize = 1.0;
+    config.stepDuration = 0.1;              // 10 s if left to run
+    config.monitorTrip = false;
+
+    std::string error;
+    const uint64_t id = executor.submit("ramp", [tester, config](TestJobContext& job) -> json {
+        auto result = tester->run(config, [&job, tester](double, double progress, bool) {
+            if (job.cancelled()) {
+                tester->stop();
+            }
+            job.progress(progress / 100.0);
+        });
+        return {{"completed", result.completed}};
+    }, error, [tester]() { tester->stop(); });
+
+    waitForState(executor, id, TestJobState::RUNNING);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(executor.cancel(id));
+
+    TestJobInfo info;
+    ASSERT_TRUE(executor.wait(id, info));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    EXPECT_EQ(info.state, TestJobState::CANCELLED);
+    EXPECT_FALSE(info.result["completed"].get<bool>());
+    EXPECT_LT(info.progress, 1.0);
+}
+
+TEST(TestJobExecutorTest, ExceptionFailsTheJobAndTheNextOneRuns) {
+    TestJobExecutor executor;
+    std::string error;
+
+    const uint64_t bad = executor.submit("distance", [](TestJobContext&) -> json {
+        throw std::runtime_error("phasor setter failed");
+    }, error);
+    const uint64_t good = executor.submit("distance", [](TestJobContext&) -> json {
+        return {{"passed", true}};
+    }, error);
+
+    TestJobInfo info;
+    ASSERT_TRUE(executor.wait(bad, info));
+    EXPECT_EQ(info.state, TestJobState::FAILED);
+    EXPECT_EQ(info.error, "phasor setter failed");
+    ASSERT_TRUE(executor.wait(good, info));
+    EXPECT_EQ(info.state, TestJobState::COMPLETED);
+}
+
+TEST(TestJobExecutorTest, FullQueueRefusesSubmits) {
+    TestJobExecutor executor;
+    auto gate = std::make_shared<Gate>();
+    std::string error;
+    auto blocked = [gate](TestJobContext&) -> json {
+        gate->pass();
+        return json::object();
+    };
+
+    const uint64_t running = executor.submit("ramp", blocked, error);
+    waitForState(executor, running, TestJobState::RUNNING);
+    for (size_t i = 0; i < TestJobs_MaxQueued; ++i) {
+        ASSERT_NE(executor.submit("ramp", blocked, error), 0u) << error;
+    }
+    EXPECT_EQ(executor.submit("ramp", blocked, error), 0u);
+    EXPECT_NE(error.find("full"), std::string::npos);
+    EXPECT_EQ(executor.submit("ramp", nullptr, error), 0u);
+
+    gate->open();
+}
+
+TEST(TestJobExecutorTest, OldestFinishedJobsAreRetired) {
+    TestJobExecutor executor;
+    std::string error;
+    const size_t total = TestJobs_MaxRetained + 4;
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < total; ++i) {
+        ids.push_back(executor.submit("ramp", [](TestJobContext&) -> json { return json::object(); }, error));
+        TestJobInfo info;
+        ASSERT_TRUE(executor.wait(ids.back(), info));
+    }
+
+    TestJobInfo info;
+    EXPECT_FALSE(executor.get(ids.front(), info));
+    EXPECT_TRUE(executor.get(ids.back(), info));
+    EXPECT_EQ(executor.list().size(), TestJobs_MaxRetained);
+}
+
+TEST(TestJobExecutorTest, ShutdownCancelsQueuedJobs) {
+    auto executor = std::make_unique<TestJobExecutor>();
+    std::mutex mutex;
+    std::vector<uint64_t> cancelled;
+    executor->setListener([&](const TestJobInfo& info) {
+        if (info.state == TestJobState::CANCELLED) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled.push_back(info.id);
+        }
+    });
+    std::string error;
+    const uint64_t running = executor->submit("ramp", [](TestJobContext& job) -> json {
+        while (!job.cancelled()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return json::object();
+    }, error);
+    waitForState(*executor, running, TestJobState::RUNNING);
+    const uint64_t queued = executor->submit("ramp", [](TestJobContext&) -> json { return json::object(); }, error);
+
+    executor->shutdown();
+    EXPECT_EQ(executor->submit("ramp", [](TestJobContext&) -> json { return json::object(); }, error), 0u);
+    std::sort(cancelled.begin(), cancelled.end());
+    EXPECT_EQ(cancelled, (std::vector<uint64_t>{running, queued}));
+}
+
+TEST(TestJobExecutorTest, PhasorWriterPostsOnTheControlChannel) {
+    SVConfig config;
+    config.appId = "4000";
+    config.macDst = "01:0c:cd:04:00:01";
+    config.macSrc = "02:00:00:00:00:01";
+    config.vlanId = 0;
+    config.vlanPrio = 4;
+    config.svId = "WriterSV";
+    config.nominalFreq = 60.0;
+    config.sampleRate = 4800;
+    config.dataSource = DataSource::MANUAL;
+
+    auto loopback = std::make_shared<FrameLoopback>();
+    auto publisher = std::make_shared<SVPublisherInstance>("sv1", config, loopback, std::make_shared<VirtualClock>());
+    publisher->start();
+
+    StreamPhasorWriter writer(publisher);
+    ASSERT_TRUE(writer.bound());
+    writer.setMagnitude(StreamPhasorWriter::CurrentA + 1, 5.0);
+    writer.setPhasor(StreamPhasorWriter::VoltageA, 57.7, -30.0);
+    writer.setFrequency(59.5);
+
+    // Nothing is applied before commit()
+    publisher->tick();
+    EXPECT_NE(publisher->getPhasors()[StreamPhasorWriter::CurrentA + 1].magnitude, 5.0);
+
+    writer.commit();
+    publisher->tick();
+    EXPECT_DOUBLE_EQ(publisher->getPhasors()[StreamPhasorWriter::CurrentA + 1].magnitude, 5.0);
+    EXPECT_DOUBLE_EQ(publisher->getPhasors()[StreamPhasorWriter::VoltageA].magnitude, 57.7);
+    EXPECT_DOUBLE_EQ(publisher->getPhasors()[StreamPhasorWriter::VoltageA].angle, -30.0);
+    EXPECT_NEAR(publisher->getFrequency(), 59.5, 1e-9);
+
+    // An unbound writer (test without a stream) ignores everything
+    StreamPhasorWriter unbound;
+    EXPECT_FALSE(unbound.bound());
+    unbound.setMagnitude(0, 1.0);
+    unbound.commit();
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_thread_health.cpp
+ * @brief Unit tests for the RT thread health monitor
+ *
+ * Tests cover:
+ * - /proc/self/task counters of a live thread
+ * - Deadline misses recorded per registered thread, ignored elsewhere
+ * - Misses set against the page faults of the same interval
+ * - One row per thread name across restarts
+ * - Misses reported by Timer and by a publisher catching up
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "clock.hpp"
+#include "frame_loopback.hpp"
+#include "sv_publisher_instance.hpp"
+#include "thread_health.hpp"
+#include "time_source.hpp"
+#include "timers.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+int tid() {
+    return static_cast<int>(syscall(SYS_gettid));
+}
+
+// Fresh pages, so the calling thread takes minor faults
+void touchMemory(size_t bytes) {
+    std::unique_ptr<char[]> block(new char[bytes]);
+    std::memset(block.get(), 1, bytes);
+    volatile char sink = block[bytes - 1];
+    (void)sink;
+}
+
+std::vector<nlohmann::json> entries(const std::string& name) {
+    const nlohmann::json health = ThreadHealth::toJson();
+    std::vector<nlohmann::json> found;
+    for (const auto& thread : health["threads"]) {
+        if (thread["name"] == name) {
+            found.push_back(thread);
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+TEST(ThreadHealthTest, ReadsOwnCounters) {
+    ThreadCounters before;
+    ASSERT_TRUE(readThreadCounters(tid(), before));
+
+    const auto end = std::chrono::steady_clock::now() + 20ms;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+    touchMemory(16 << 20);
+
+    ThreadCounters after;
+    ASSERT_TRUE(readThreadCounters(tid(), after));
+    EXPECT_GT(after.runNs, before.runNs + 10000000);
+    EXPECT_GT(after.timeslices, 0u);
+    EXPECT_GT(after.minorFaults, before.minorFaults);
+    EXPECT_GE(after.majorFaults, before.majorFaults);
+    EXPECT_GE(after.cpu, 0);
+}
+
+TEST(ThreadHealthTest, UnknownThreadIsUnreadable) {
+    ThreadCounters counters;
+    EXPECT_FALSE(readThreadCounters(-1, counters));
+}
+
+TEST(ThreadHealthTest, MissesOnUnregisteredThreadsAreIgnored) {
+    std::thread([] { ThreadHealth::recordMiss(1000000); }).join();
+    const nlohmann::json health = ThreadHealth::toJson();
+    for (const auto& thread : health["threads"]) {
+        EXPECT_NE(thread["tid"], tid());
+    }
+}
+
+TEST(ThreadHealthTest, MissesAreSetAgainstTheSameInterval) {
+    std::thread([] {
+        ThreadHealth::Scope health("health-a");
+        ThreadHealth::sample();
+
+        ThreadHealth::recordMiss(250000);
+        ThreadHealth::recordMiss(120000);
+        touchMemory(8 << 20);
+        ThreadHealth::sample();
+
+        auto found = entries("health-a");
+        ASSERT_EQ(found.size(), 1u);
+        const nlohmann::json& e = found[0];
+        EXPECT_TRUE(e["active"].get<bool>());
+        EXPECT_TRUE(e["readable"].get<bool>());
+        EXPECT_EQ(e["tid"], tid());
+        EXPECT_EQ(e["totals"]["deadlineMisses"], 2u);
+        EXPECT_EQ(e["totals"]["maxLatenessNs"], 250000);
+        EXPECT_EQ(e["lastInterval"]["deadlineMisses"], 2u);
+        EXPECT_EQ(e["missIntervals"], 1u);
+        EXPECT_EQ(e["missCorrelation"]["minorFaults"], 1u);
+        EXPECT_EQ(e["missCorrelation"]["unexplained"], 0u);
+        ASSERT_EQ(e["recentMisses"].size(), 1u);
+        EXPECT_EQ(e["recentMisses"][0]["maxLatenessNs"], 250000);
+        EXPECT_GT(e["recentMisses"][0]["minorFaults"].get<uint64_t>(), 0u);
+
+        ThreadHealth::sample();                 // A clean interval
+        found = entries("health-a");
+        EXPECT_EQ(found[0]["lastInterval"]["deadlineMisses"], 0u);
+        EXPECT_EQ(found[0]["lastInterval"]["maxLatenessNs"], 0);
+        EXPECT_EQ(found[0]["missIntervals"], 1u);
+    }).join();
+
+    auto found = entries("health-a");
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_FALSE(found[0]["active"].get<bool>());
+    EXPECT_EQ(found[0]["totals"]["deadlineMisses"], 2u);
+}
+
+TEST(ThreadHealthTest, RestartedThreadKeepsOneRow) {
+    for (int i = 0; i < 3; ++i) {
+        std::thread([] { ThreadHealth::Scope health("health-b"); }).join();
+    }
+    EXPECT_EQ(entries("health-b").size(), 1u);
+
+    // Two running at once are two threads
+    ThreadHealth::Scope first("health-c");
+    std::thread([] { ThreadHealth::Scope second("health-c"); EXPECT_EQ(entries("health-c").size(), 2u); }).join();
+}
+
+TEST(ThreadHealthTest, TimerReportsMissedPeriods) {
+    std::thread([] {
+        ThreadHealth::Scope health("health-timer");
+        Timer timer;
+        timer.start_period(1000000);
+        std::this_thread::sleep_for(3ms);       // The next wakeup is two periods late
+        timer.wait_period(1000000);
+
+        auto found = entries("health-timer");
+        ASSERT_EQ(found.size(), 1u);
+        EXPECT_GE(found[0]["totals"]["deadlineMisses"].get<uint64_t>(), 1u);
+        EXPECT_GE(found[0]["totals"]["maxLatenessNs"].get<int64_t>(), 1000000);
+    }).join();
+}
+
+TEST(ThreadHealthTest, PublisherCatchingUpIsAMiss) {
+    std::thread([] {
+        ThreadHealth::Scope health("health-publisher");
+        SVConfig config;
+        config.appId = "4000";
+        config.macDst = "01:0c:cd:04:00:01";
+        config.macSrc = "02:00:00:00:00:01";
+        config.svId = "HealthSV";
+        config.nominalFreq = 60.0;
+        config.sampleRate = 4800;
+        auto clock = std::make_shared<VirtualClock>(Clock::time_point(5s));
+        SVPublisherInstance publisher("sv1", config, std::make_shared<FrameLoopback>(), clock,
+                                      std::make_shared<TimeSource>());
+        publisher.start();
+        publisher.tick();
+        clock->advance(std::chrono::microseconds(100));
+        publisher.tick();                       // Next sample not yet due
+        EXPECT_EQ(entries("health-publisher")[0]["totals"]["deadlineMisses"], 0u);
+
+        clock->advance(std::chrono::microseconds(250));
+        publisher.tick();                       // 142 us late: within a tick period
+        EXPECT_EQ(entries("health-publisher")[0]["totals"]["deadlineMisses"], 0u);
+
+        clock->advance(2ms);
+        publisher.tick();                       // Catching up 10 samples
+        auto found = entries("health-publisher");
+        EXPECT_EQ(found[0]["totals"]["deadlineMisses"], 1u);
+        EXPECT_GE(found[0]["totals"]["maxLatenessNs"].get<int64_t>(), 1800000);
+    }).join();
+}
+
+TEST(ThreadHealthTest, SamplerStartsAndStops) {
+    ThreadHealth::start();
+    ThreadHealth::start();                      // Already running
+    const auto begin = std::chrono::steady_clock::now();
+    ThreadHealth::stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, 500ms);
+
+    const nlohmann::json j = ThreadHealth::toJson();
+    EXPECT_EQ(j["periodNs"], ThreadHealth_PeriodNs);
+    EXPECT_LT(j["overheadPercent"].get<double>(), 100.0);
+}
@@ -0,0 +1,294 @@
+/**
+ * @file test_time_source.cpp
+ * @brief Unit tests for reference time and SV sample alignment
+ *
+ * Tests cover:
+ * - TimeSource: monotonic stand-in, CLOCK_TAI mapping, refresh period,
+ *   next reference second, PHC lock evidence
+ * - SV publisher on a time source: smpCnt 0 on the reference second,
+ *   catch-up and realignment, smpSynch, phase-aligned streams
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <time.h>
+#include "clock.hpp"
+#include "frame_loopback.hpp"
+#include "general_definition.hpp"
+#include "sv_publisher_instance.hpp"
+#include "time_source.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int64_t NsPerSecond = 1000000000;
+
+uint64_t steadyNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct SvFields {
+    uint16_t smpCnt;
+    uint8_t smpSynch;
+    std::vector<uint8_t> seqData;
+};
+
+// Fields after the svID TLV: 82 02 smpCnt, 83 04 confRev, 85 01 smpSynch, 87 LL seqData
+SvFields parse(const std::vector<uint8_t>& frame, const std::string& svId) {
+    SvFields f{};
+    for (size_t i = 0; i + svId.size() + 16 < frame.size(); ++i) {
+        if (frame[i] == 0x80 && frame[i + 1] == svId.size() &&
+            std::memcmp(&frame[i + 2], svId.data(), svId.size()) == 0) {
+            size_t p = i + 2 + svId.size();
+            EXPECT_EQ(frame[p], 0x82);
+            f.smpCnt = static_cast<uint16_t>((frame[p + 2] << 8) | frame[p + 3]);
+            EXPECT_EQ(frame[p + 10], 0x85);
+            f.smpSynch = frame[p + 12];
+            EXPECT_EQ(frame[p + 13], 0x87);
+            f.seqData.assign(frame.begin() + static_cast<long>(p + 15), frame.end());
+            return f;
+        }
+    }
+    ADD_FAILURE() << "svID not found";
+    return f;
+}
+
+SVConfig svConfig(const std::string& svId) {
+    SVConfig config;
+    config.appId = "4000";
+    config.macDst = "01:0c:cd:04:00:01";
+    config.macSrc = "02:00:00:00:00:01";
+    config.vlanId = 0;
+    config.vlanPrio = 4;
+    config.svId = svId;
+    config.nominalFreq = 60.0;
+    config.sampleRate = 4800;
+    config.dataSource = DataSource::MANUAL;
+    return config;
+}
+
+// Publisher on a virtual clock; the monotonic stand-in makes its reference
+// time the virtual time itself
+struct AlignedPublisher {
+    std::shared_ptr<VirtualClock> clock;
+    std::shared_ptr<FrameLoopback> loopback = std::make_shared<FrameLoopback>();
+    std::vector<SvFields> frames;
+    std::unique_ptr<SVPublisherInstance> publisher;
+
+    AlignedPublisher(const std::string& svId, Clock::duration start) {
+        clock = std::make_shared<VirtualClock>(Clock::time_point(start));
+        loopback->attach([this, svId](const uint8_t* frame, size_t length) {
+            frames.push_back(parse(std::vector<uint8_t>(frame, frame + length), svId));
+        });
+        publisher.reset(new SVPublisherInstance(svId, svConfig(svId), loopback, clock,
+                                                std::make_shared<TimeSource>()));
+        publisher->setPhasors({{1.0, 0.0}, {1.0, -120.0}, {1.0, 120.0}, {0.0, 0.0},
+                               {60.0, 0.0}, {60.0, -120.0}, {60.0, 120.0}, {0.0, 0.0}});
+        publisher->start();
+    }
+};
+
+} // namespace
+
+TEST(TimeSourceTest, MonotonicStandInIsNeverSynchronized) {
+    TimeSource source;
+    const uint64_t now = steadyNs();
+    EXPECT_EQ(source.toReference(now), static_cast<int64_t>(now));
+    EXPECT_EQ(source.toMonotonic(static_cast<int64_t>(now)), now);
+    EXPECT_EQ(source.state(), SyncState::None);
+    EXPECT_EQ(source.smpSynch(), 0);
+    EXPECT_EQ(source.status().reference, "none");
+}
+
+TEST(TimeSourceTest, TaiIsMappedOntoTheMonotonicClock) {
+    auto source = TimeSource::systemTai();
+    ASSERT_NE(source, nullptr);
+
+    struct timespec tai;
+    const uint64_t before = steadyNs();
+    clock_gettime(CLOCK_TAI, &tai);
+    const uint64_t after = steadyNs();
+    const int64_t taiNs = static_cast<int64_t>(tai.tv_sec) * NsPerSecond + tai.tv_nsec;
+
+    EXPECT_NEAR(static_cast<double>(source->toReference(before + (after - before) / 2)),
+                static_cast<double>(taiNs), 1e6);
+    const uint64_t now = steadyNs();
+    EXPECT_NEAR(static_cast<double>(source->toMonotonic(source->toReference(now))),
+                static_cast<double>(now), 2.0);
+
+    const TimeSourceStatus status = source->status();
+    EXPECT_EQ(status.refreshes, 1u);
+    EXPECT_EQ(status.failures, 0u);
+    EXPECT_GE(status.bracketNs, 0);
+    EXPECT_NE(status.state, SyncState::Global);
+}
+
+TEST(TimeSourceTest, RefreshCrossTimestampsOncePerPeriod) {
+    auto source = TimeSource::systemTai();
+    const uint64_t now = steadyNs();
+    EXPECT_FALSE(source->refresh(now));
+    EXPECT_TRUE(source->refresh(now + TimeSource_RefreshNs));
+    EXPECT_FALSE(source->refresh(now + TimeSource_RefreshNs));
+    EXPECT_EQ(source->status().refreshes, 2u);
+    EXPECT_EQ(source->status().steps, 0u);
+}
+
+TEST(TimeSourceTest, NextSecondIsAWholeReferenceSecond) {
+    auto source = TimeSource::systemTai();
+    const uint64_t now = steadyNs();
+    const uint64_t at = source->nextSecond(now, Transient_StartLeadNs);
+
+    EXPECT_GE(at + 2, now + Transient_StartLeadNs);
+    EXPECT_LE(at, now + Transient_StartLeadNs + static_cast<uint64_t>(NsPerSecond));
+    const int64_t reference = source->toReference(at);
+    const int64_t intoSecond = reference % NsPerSecond;
+    EXPECT_TRUE(intoSecond <= 2 || intoSecond >= NsPerSecond - 2) << intoSecond;
+}
+
+TEST(TimeSourceTest, PhcOpenFailsCleanly) {
+    std::string error;
+    EXPECT_EQ(TimeSource::openPhc("/dev/does-not-exist", error), nullptr);
+    EXPECT_FALSE(error.empty());
+}
+
+TEST(TimeSourceTest, FreeRunningPhcIsNotLocked) {
+    // Readable, rate-stable, but nothing steers its frequency
+    PhcLockDetector lock;
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(lock.update(0, 200), SyncState::None) << i;
+    }
+    EXPECT_FALSE(lock.locked());
+
+    // A servo that left its last adjustment behind looks the same
+    PhcLockDetector stale;
+    for (int i = 0; i < 20; ++i) {
+        stale.update(123456, 200);
+    }
+    EXPECT_FALSE(stale.locked());
+}
+
+TEST(TimeSourceTest, SteeredPhcLocksOnceItsOffsetIsStable) {
+    PhcLockDetector lock;
+    EXPECT_EQ(lock.update(1000, std::numeric_limits<int64_t>::max()), SyncState::None);
+    EXPECT_EQ(lock.update(1100, 80000), SyncState::None);        // Rate estimate converging
+    for (int i = 1; i < TimeSource_LockRefreshes; ++i) {
+        EXPECT_EQ(lock.update(1100 + i, 500), SyncState::None) << i;
+    }
+    EXPECT_EQ(lock.update(1200, -500), SyncState::Global);
+
+    // One wandering offset drops the lock until it is stable again
+    EXPECT_EQ(lock.update(1300, 50000), SyncState::None);
+    for (int i = 1; i < TimeSource_LockRefreshes; ++i) {
+        lock.update(1300 + i, 100);
+    }
+    EXPECT_EQ(lock.update(1400, 100), SyncState::Global);
+}
+
+TEST(TimeSourceTest, PhcLosesLockWhenTheServoStops) {
+    PhcLockDetector lock;
+    for (int i = 0; i <= TimeSource_LockRefreshes; ++i) {
+        lock.update(2000 + i, 100);
+    }
+    ASSERT_TRUE(lock.locked());
+
+    const long last = 2000 + TimeSource_LockRefreshes;
+    for (int i = 1; i < TimeSource_ServoIdleRefreshes; ++i) {
+        EXPECT_EQ(lock.update(last, 100), SyncState::Global) << i;   // Servo between updates
+    }
+    EXPECT_EQ(lock.update(last, 100), SyncState::None);
+
+    lock.reset();
+    EXPECT_EQ(lock.update(last + 1, 100), SyncState::None);
+}
+
+TEST(TimeSourceTest, SmpCntZeroLandsOnTheReferenceSecond) {
+    AlignedPublisher p("AlignSV", 10s - 1ms);
+
+    p.publisher->tick();                        // 9.999 s: sample 4795 of second 9
+    ASSERT_EQ(p.frames.size(), 1u);
+    EXPECT_EQ(p.frames[0].smpCnt, 4795);
+    EXPECT_EQ(p.frames[0].smpSynch, 0);         // The stand-in is not synchronized
+
+    p.clock->advance(1ms);                      // 10.000 s: catches up to sample 0
+    p.publisher->tick();
+    ASSERT_EQ(p.frames.size(), 6u);
+    EXPECT_EQ(p.frames[1].smpCnt, 4796);
+    EXPECT_EQ(p.frames[4].smpCnt, 4799);
+    EXPECT_EQ(p.frames[5].smpCnt, 0);
+
+    p.publisher->tick();                        // Nothing more is due yet
+    EXPECT_EQ(p.frames.size(), 6u);
+    EXPECT_EQ(p.publisher->getSampleCounter(), 1u);
+    EXPECT_EQ(p.publisher->getRealignments(), 0u);
+}
+
+TEST(TimeSourceTest, LongStallRealignsInsteadOfCatchingUp) {
+    AlignedPublisher p("StallSV", 5s);
+
+    p.publisher->tick();
+    ASSERT_EQ(p.frames.size(), 1u);
+    EXPECT_EQ(p.frames[0].smpCnt, 0);
+
+    p.clock->advance(500ms + 10ms);             // Far beyond SV_MaxCatchUpMs
+    p.publisher->tick();
+    ASSERT_EQ(p.frames.size(), 2u);
+    EXPECT_EQ(p.frames[1].smpCnt, 2448);        // 0.51 s * 4800
+    EXPECT_EQ(p.publisher->getRealignments(), 1u);
+
+    p.clock->advance(std::chrono::milliseconds(SV_MaxCatchUpMs / 2));
+    p.publisher->tick();                        // Short gaps are caught up
+    EXPECT_EQ(p.frames.size(), 2u + 48u);
+    EXPECT_EQ(p.publisher->getRealignments(), 1u);
+}
+
+TEST(TimeSourceTest, StreamsStartedApartAreInPhase) {
+    AlignedPublisher early("SV_A", 20s - 300ms);
+    AlignedPublisher late("SV_B", 20s - 70ms);
+
+    // Both run into second 20, each in 1 ms steps from its own start
+    for (int i = 0; i < 400 && (early.frames.empty() || early.frames.back().smpCnt != 10); ++i) {
+        early.publisher->tick();
+        early.clock->advance(1ms);
+    }
+    for (int i = 0; i < 400 && (late.frames.empty() || late.frames.back().smpCnt != 10); ++i) {
+        late.publisher->tick();
+        late.clock->advance(1ms);
+    }
+
+    auto find = [](const std::vector<SvFields>& frames, int smpCnt) {
+        for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+            if (it->smpCnt == smpCnt) {
+                return it->seqData;
+            }
+        }
+        return std::vector<uint8_t>();
+    };
+    for (int smpCnt : {4790, 0, 1, 7}) {
+        const std::vector<uint8_t> a = find(early.frames, smpCnt);
+        ASSERT_FALSE(a.empty()) << smpCnt;
+        EXPECT_EQ(a, find(late.frames, smpCnt)) << "smpCnt " << smpCnt;
+    }
+}
+
+TEST(TimeSourceTest, WithoutATimeSourceEveryWallClockTickSendsOneSample) {
+    auto loopback = std::make_shared<FrameLoopback>();
+    std::vector<SvFields> frames;
+    loopback->attach([&frames](const uint8_t* frame, size_t length) {
+        frames.push_back(parse(std::vector<uint8_t>(frame, frame + length), "FreeSV"));
+    });
+    SVPublisherInstance publisher("sv1", svConfig("FreeSV"), loopback);
+    publisher.start();
+    for (int i = 0; i < 3; ++i) {
+        publisher.tick();
+    }
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(frames[2].smpCnt, 2);
+    EXPECT_EQ(frames[2].smpSynch, 0);
+}
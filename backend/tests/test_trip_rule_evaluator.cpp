@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "trip_rule_evaluator.hpp"
+#include "trip_rule_json.hpp"
+#include "sniffer.hpp"
+#include "global_flags.hpp"
+#include "Goose.hpp"
 
 using namespace vts::sniffer;
 
@@ -348,3 +352,83 @@ TEST_F(TripRuleEvaluatorTest, ComplexNestedExpression) {
     TripRuleResult evalResult = evaluator.evaluate();
     EXPECT_TRUE(evalResult.triggered);
 }
+
+// Test 31: Shared rule set evaluated against external data points
+TEST_F(TripRuleEvaluatorTest, ConstEvaluateExternalDataPoints) {
+    ASSERT_TRUE(evaluator.addRule("shared", "RelayA/LLN0.Ind1.stVal == true"));
+    const TripRuleEvaluator& rules = evaluator;
+    
+    TripRuleEvaluator points;
+    points.updateDataPoint("RelayA/LLN0.Ind1.stVal", false);
+    EXPECT_FALSE(rules.evaluate(points.getDataPoints()).triggered);
+    
+    points.updateDataPoint("RelayA/LLN0.Ind1.stVal", true);
+    TripRuleResult evalResult = rules.evaluate(points.getDataPoints());
+    EXPECT_TRUE(evalResult.triggered);
+    EXPECT_EQ(evalResult.ruleName, "shared");
+    
+    // The rule set's own data points are untouched
+    EXPECT_TRUE(evaluator.getDataPoints().empty());
+}
+
+// Test 32: Rule sets from the GOOSE config JSON
+TEST_F(TripRuleEvaluatorTest, RulesFromJson) {
+    auto rules = tripRulesFromJson(nlohmann::json::parse(R"([
+        {"name": "trip", "expression": "R1/LLN0$GO$Trip/data0 == true"},
+        {"name": "spare", "expression": "R1/LLN0$GO$Trip/data1 == true", "enabled": false}
+    ])"));
+    ASSERT_NE(rules, nullptr);
+    EXPECT_EQ(rules->getRuleNames().size(), 2u);
+    EXPECT_TRUE(rules->isRuleEnabled("trip"));
+    EXPECT_FALSE(rules->isRuleEnabled("spare"));
+    
+    // An empty array disables evaluation
+    EXPECT_EQ(tripRulesFromJson(nlohmann::json::array()), nullptr);
+    
+    EXPECT_THROW(tripRulesFromJson(nlohmann::json::parse(R"([{"name": "bad", "expression": "== true"}])")),
+                 std::invalid_argument);
+    EXPECT_THROW(tripRulesFromJson(nlohmann::json::parse(R"([{"expression": "A == true"}])")),
+                 nlohmann::json::exception);
+    EXPECT_THROW(tripRulesFromJson(nlohmann::json::object()), std::invalid_argument);
+}
+
+// Test 33: Configured rules trip on a subscribed GOOSE frame
+TEST_F(TripRuleEvaluatorTest, ConfiguredRulesTripOnGoose) {
+    const std::string gocbRef = "R1/LLN0$GO$Trip";
+    const std::vector<uint8_t> dstMac = {0x01, 0x0C, 0xCD, 0x01, 0x00, 0x01};
+    
+    auto gooseFrame = [&](bool trip) {
+        std::vector<Data> dataset(4, Data(Data::Type::Boolean));
+        dataset[0].boolean = trip;
+        Goose goose("", "", 0x3001, 0, gocbRef, 2000, "R1/LLN0$Trip", gocbRef, UtcTime(0, 0), 1, 0,
+                    false, 1, false, 0, dataset);
+        std::vector<uint8_t> frame(dstMac);
+        frame.insert(frame.end(), {0x02, 0x00, 0x00, 0x00, 0x01, 0x01});
+        const std::vector<uint8_t> encoded = goose.getEncoded();
+        frame.insert(frame.end(), encoded.begin(), encoded.end());
+        return frame;
+    };
+    
+    SnifferClass sniffer;
+    sniffer.injectOnly = true;
+    sniffer.startThread({Goose_info{gocbRef, dstMac, {}}});
+    const auto body = nlohmann::json::parse(R"({"tripRules": [
+        {"name": "trip", "expression": "R1/LLN0$GO$Trip/data0 == true"}
+    ]})");
+    sniffer.setTripRules(tripRulesFromJson(body["tripRules"]));
+    vts::clearTripFlag();
+    
+    std::vector<uint8_t> frame = gooseFrame(false);
+    sniffer.injectFrame(frame.data(), frame.size());
+    EXPECT_FALSE(vts::isTripFlagSet());
+    
+    frame = gooseFrame(true);
+    sniffer.injectFrame(frame.data(), frame.size());
+    EXPECT_TRUE(vts::isTripFlagSet());
+    
+    // Publishing an empty rule set stops evaluation
+    vts::clearTripFlag();
+    sniffer.setTripRules(tripRulesFromJson(nlohmann::json::array()));
+    sniffer.injectFrame(frame.data(), frame.size());
+    EXPECT_FALSE(vts::isTripFlagSet());
+}
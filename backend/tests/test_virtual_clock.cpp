@@ -0,0 +1,278 @@
+/**
+ * @file test_virtual_clock.cpp
+ * @brief Unit tests for the virtual-time mode
+ *
+ * Tests cover:
+ * - VirtualClock: unattached sleeps, lockstep of attached threads, advance()
+ * - Timer periods on an injected clock
+ * - Sequence and overcurrent runs taking virtual, not wall-clock, time
+ * - Publisher frames delivered through the in-process loopback, paced on
+ *   the virtual clock at the stream's sample rate
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "clock.hpp"
+#include "frame_loopback.hpp"
+#include "global_flags.hpp"
+#include "overcurrent_tester.hpp"
+#include "sequence_engine.hpp"
+#include "sv_publisher_instance.hpp"
+#include "timers.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+double wallSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+Clock::time_point at(Clock::duration offset) {
+    return Clock::time_point(offset);
+}
+
+} // namespace
+
+TEST(VirtualClockTest, UnattachedSleepDoesNotWait) {
+    VirtualClock clock;
+    const auto wall = std::chrono::steady_clock::now();
+    clock.sleepFor(1h);
+    EXPECT_EQ(clock.now(), at(1h));
+    EXPECT_LT(wallSeconds(wall), 1.0);
+}
+
+TEST(VirtualClockTest, AttachedThreadsRunInLockstep) {
+    VirtualClock clock;
+    std::vector<Clock::time_point> fast;
+    std::vector<Clock::time_point> slow;
+    std::atomic<bool> slowHeldTime{true};
+    std::atomic<int> attached{0};
+    auto attachBoth = [&attached] {
+        attached++;
+        while (attached < 2) {
+            std::this_thread::yield();
+        }
+    };
+
+    std::thread a([&] {
+        ClockParticipant participant(clock);
+        attachBoth();
+        for (int i = 0; i < 100; ++i) {
+            clock.sleepFor(3ms);
+            fast.push_back(clock.now());
+        }
+    });
+    std::thread b([&] {
+        ClockParticipant participant(clock);
+        attachBoth();
+        for (int i = 0; i < 50; ++i) {
+            clock.sleepFor(7ms);
+            const Clock::time_point woke = clock.now();
+            std::this_thread::sleep_for(100us);     // Slow work does not let time run on
+            if (clock.now() != woke) {
+                slowHeldTime = false;
+            }
+            slow.push_back(woke);
+        }
+    });
+    a.join();
+    b.join();
+
+    ASSERT_EQ(fast.size(), 100u);
+    ASSERT_EQ(slow.size(), 50u);
+    for (size_t i = 0; i < fast.size(); ++i) {
+        EXPECT_EQ(fast[i], at(3ms * static_cast<int>(i + 1)));
+    }
+    for (size_t i = 0; i < slow.size(); ++i) {
+        EXPECT_EQ(slow[i], at(7ms * static_cast<int>(i + 1)));
+    }
+    EXPECT_TRUE(slowHeldTime);
+    EXPECT_EQ(clock.now(), at(350ms));
+    EXPECT_EQ(clock.participants(), 0u);
+}
+
+TEST(VirtualClockTest, AdvanceReleasesDueSleepers) {
+    VirtualClock clock;
+    ClockParticipant holder(clock);             // Awake participant: only advance() moves time
+    std::atomic<bool> woke{false};
+    std::thread sleeper([&] {
+        clock.sleepFor(10ms);
+        woke = true;
+    });
+    while (clock.sleepers() == 0) {
+        std::this_thread::yield();
+    }
+
+    clock.advance(5ms);
+    std::this_thread::sleep_for(10ms);
+    EXPECT_FALSE(woke);
+    clock.advance(5ms);
+    sleeper.join();
+    EXPECT_TRUE(woke);
+    EXPECT_EQ(clock.now(), at(10ms));
+}
+
+TEST(VirtualClockTest, TimerPeriodsFollowTheClock) {
+    VirtualClock clock;
+    ClockParticipant participant(clock);
+    Timer timer;
+    timer.clock = &clock;
+    timer.start_period(1000000);
+    for (int i = 0; i < 1000; ++i) {
+        timer.wait_period(1000000);
+    }
+    EXPECT_EQ(clock.now(), at(1s));
+}
+
+TEST(VirtualClockTest, SequenceRunsInVirtualTime) {
+    using namespace vts::sequence;
+    vts::clearTripFlag();
+    auto clock = std::make_shared<VirtualClock>();
+    SequenceEngine engine;
+    engine.setClock(clock);
+
+    std::vector<Clock::time_point> applied;
+    engine.setPhasorUpdateCallback([&](const std::string&, const StreamPhasorState&) {
+        applied.push_back(clock->now());
+    });
+
+    Sequence sequence;
+    sequence.activeStreams = {"sv1"};
+    for (double duration : {10.0, 20.0, 0.125}) {
+        SequenceState state;
+        state.name = "S" + std::to_string(sequence.states.size());
+        state.durationSec = duration;
+        state.phasors["sv1"] = StreamPhasorState();
+        sequence.states.push_back(state);
+    }
+
+    const auto wall = std::chrono::steady_clock::now();
+    ASSERT_TRUE(engine.start(sequence));
+    while (engine.getStatus() == SequenceStatus::RUNNING) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(engine.getStatus(), SequenceStatus::COMPLETED);
+    EXPECT_LT(wallSeconds(wall), 5.0);
+
+    // States end exactly on their durations, not on the 50 ms poll grid
+    ASSERT_EQ(applied.size(), 3u);
+    EXPECT_EQ(applied[0], at(0s));
+    EXPECT_EQ(applied[1], at(10s));
+    EXPECT_EQ(applied[2], at(30s));
+    EXPECT_EQ(clock->now(), at(30125ms));
+    engine.stop();
+}
+
+TEST(VirtualClockTest, OvercurrentTesterTimesASimulatedRelay) {
+    using namespace vts::testers;
+    auto clock = std::make_shared<VirtualClock>();
+    OvercurrentTester tester;
+    tester.setClock(clock);
+
+    OCSettings settings{1.0, 0.1, OCCurve::STANDARD_INVERSE};
+    double current = 0.0;
+    Clock::time_point changed;
+    tester.setCurrentSetter([&](double amps) {
+        current = amps;
+        changed = clock->now();
+    });
+    // Relay model: trips once the curve time has elapsed at the present current
+    tester.setTripFlagGetter([&] {
+        const double elapsed = std::chrono::duration<double>(clock->now() - changed).count();
+        return elapsed >= OvercurrentTester::calculateTripTime(settings, current / settings.pickupCurrent);
+    });
+
+    OCTestConfig config;
+    config.settings = settings;
+    for (double multiple : {2.0, 5.0, 10.0}) {
+        config.points.push_back({multiple, OvercurrentTester::calculateTripTime(settings, multiple), ""});
+    }
+    config.timeTolerance = 0.002;
+    config.toleranceIsPercent = false;
+    config.maxTestDuration = 5.0;
+    config.stopOnFirstFailure = false;
+
+    const auto wall = std::chrono::steady_clock::now();
+    const std::vector<OCResult> results = tester.run(config);
+    EXPECT_LT(wallSeconds(wall), 5.0);
+
+    ASSERT_EQ(results.size(), 3u);
+    for (const OCResult& result : results) {
+        EXPECT_TRUE(result.tripped);
+        EXPECT_TRUE(result.passed) << result.error;
+        // Polled every virtual millisecond
+        EXPECT_GE(result.measuredTime, result.expectedTime);
+        EXPECT_LE(result.measuredTime, result.expectedTime + 0.001 + 1e-9);
+    }
+}
+
+TEST(VirtualClockTest, PublisherFramesGoToTheLoopback) {
+    auto loopback = std::make_shared<FrameLoopback>();
+    std::vector<std::vector<uint8_t>> frames;
+    loopback->attach([&](const uint8_t* frame, size_t length) {
+        frames.emplace_back(frame, frame + length);
+    });
+
+    SVConfig config;
+    config.appId = "4000";
+    config.macDst = "01:0c:cd:04:00:01";
+    config.macSrc = "02:00:00:00:00:01";
+    config.vlanId = 0;
+    config.vlanPrio = 4;
+    config.svId = "LoopSV";
+    config.nominalFreq = 60.0;
+    config.sampleRate = 4000;
+    config.dataSource = DataSource::MANUAL;
+
+    // No raw socket is opened, so this runs without privileges
+    auto clock = std::make_shared<VirtualClock>();
+    SVPublisherInstance publisher("sv1", config, loopback, clock);
+    publisher.start();
+    for (int i = 0; i < 10; ++i) {
+        publisher.tick();
+        clock->advance(250us);                  // One sample period
+    }
+
+    ASSERT_EQ(frames.size(), 10u);
+    EXPECT_EQ(loopback->framesSent(), 10u);
+    ASSERT_GT(frames[0].size(), 18u);
+    EXPECT_EQ(frames[0][0], 0x01);
+    EXPECT_EQ(frames[0][16], 0x88);             // SV EtherType after the VLAN tag
+    EXPECT_EQ(frames[0][17], 0xBA);
+}
+
+TEST(VirtualClockTest, PublisherSendsSampleRateFramesPerVirtualSecond) {
+    for (uint32_t rate : {4000u, 4800u, 14400u}) {
+        auto loopback = std::make_shared<FrameLoopback>();
+        SVConfig config;
+        config.appId = "4000";
+        config.macDst = "01:0c:cd:04:00:01";
+        config.macSrc = "02:00:00:00:00:01";
+        config.vlanId = 0;
+        config.vlanPrio = 4;
+        config.svId = "RateSV";
+        config.nominalFreq = 60.0;
+        config.sampleRate = rate;
+        config.dataSource = DataSource::MANUAL;
+
+        // The main loop's 100 us tick, unrelated to any sample period
+        auto clock = std::make_shared<VirtualClock>();
+        SVPublisherInstance publisher("sv1", config, loopback, clock);
+        publisher.start();
+        uint64_t atOneSecond = 0;
+        for (int tick = 0; tick <= 20000; ++tick) {
+            publisher.tick();
+            if (tick == 10000) {
+                atOneSecond = loopback->framesSent();
+                EXPECT_EQ(publisher.getSampleCounter(), 1u) << rate << " Hz";   // Sample 0 of second 1 sent
+            }
+            clock->advance(100us);
+        }
+        EXPECT_EQ(loopback->framesSent() - atOneSecond, rate) << rate << " Hz";
+        EXPECT_EQ(publisher.getSmpSynch(), 0);
+    }
+}